@@ -1,4 +1,4 @@
-from cxx_type import CxxNumericType
+from cxx_type import CxxType, CxxNumericType
 from utils import CTypeInfo
 
 import ctypes
@@ -48,7 +48,12 @@ f64 = CxxNumericType('double'
                      , headers=set()
                      , namespace='')
 
-__all__ = ('u8', 'u16', 'u32', 'u64', 'i8', 'i16', 'i32', 'i64', 'f32', 'f64')
+string_ref = CxxType('StringRef'
+                     , namespace='IO::DBC::DataStructures'
+                     , headers={'IO/DBC/DataStructures.hpp'})
+""" Offset into the string block of a client table (WDBC / WDB2). """
+
+__all__ = ('u8', 'u16', 'u32', 'u64', 'i8', 'i16', 'i32', 'i64', 'f32', 'f64', 'string_ref')
 
 # test
 if __name__ == '__main__':
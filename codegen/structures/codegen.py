@@ -8,8 +8,18 @@ def generate_file(structs: Tuple[CxxStruct]) -> str:
            "This file is autogenerated by codegen script. Do not edit manually, changes will be overriden.\n" \
            "Structures are defined in Python files under \"/codegen/structures/definitions/\".\n" \
            "*/\n" \
+           "#pragma once\n" \
            "#include <IO/Common.hpp>\n" \
-           "#include <Utils/Meta/Reflection.hpp>\n\n"
+           "#include <Utils/Meta/Reflection.hpp>\n"
+
+    headers = set()
+    for struct in structs:
+        headers |= struct.type_headers
+
+    for header in sorted(headers):
+        code += f"#include <{header}>\n"
+
+    code += "\n"
 
     cur_namespace = None
     for struct in sorted(structs, key=lambda x: x.__cxx_namespace__):
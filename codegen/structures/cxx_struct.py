@@ -272,7 +272,7 @@ class CxxStruct(CxxType):
         for entry in self.__cxx_fields__:
             if isinstance(entry, Field):
                 if isinstance(entry.value_type, CxxType):
-                    headers += entry.value_type.headers
+                    headers |= entry.value_type.headers
             else:
                 for version in ClientVersions:
                     if not self.is_version_enabled(version):
@@ -280,8 +280,8 @@ class CxxStruct(CxxType):
 
                     for field in entry.get_fields(version):
                         if isinstance(field, Field):
-                            headers += field.value_type.headers
+                            headers |= field.value_type.headers
 
-        headers += super().headers
+        headers |= self.headers
         return headers
 
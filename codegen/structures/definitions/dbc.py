@@ -0,0 +1,18 @@
+from cxx_struct import CxxStruct, Field
+from builtin_types import *
+
+
+class LightSkyboxRec(CxxStruct):
+    __cxx_version_range__ = None
+    __cxx_namespace__ = "IO::DBC::DataStructures"
+    __cxx__docstring__ = "Record of LightSkybox.dbc (WotLK - MoP).\n" \
+                         "View rows with IO::DBC::DBCTable::Record<LightSkyboxRec>(row) or Find<LightSkyboxRec>(id)."
+
+    __cxx_fields__ = (
+        Field(u32, "id", default=0, comment="Record ID."),
+        Field(string_ref, "name", default=("0",), comment="Path to skybox model, empty string by default."),
+        Field(u32, "flags", default=0, comment="Skybox flags."),
+    )
+
+
+STRUCTS = (LightSkyboxRec(),)
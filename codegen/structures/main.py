@@ -1,3 +1,22 @@
-from builtin_types import *
+from codegen import generate_file
 
-print(u8.full_typename)
\ No newline at end of file
+import importlib
+import os
+import sys
+
+SOURCE_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', 'src')
+
+DEFINITIONS = \
+    {
+      'dbc': 'IO/DBC/Records.hpp'
+    }
+""" Definitions modules and headers they are generated into, relative to the source directory. """
+
+if __name__ == '__main__':
+    sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), 'definitions'))
+
+    for module_name, header in DEFINITIONS.items():
+        module = importlib.import_module(module_name)
+
+        with open(os.path.join(SOURCE_DIR, header), 'w', newline='\n') as f:
+            f.write(generate_file(module.STRUCTS))
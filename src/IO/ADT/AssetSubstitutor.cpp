@@ -0,0 +1,635 @@
+#include <IO/ADT/AssetSubstitutor.hpp>
+#include <IO/Common.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <Utils/PathUtils.hpp>
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+
+using namespace IO::ADT;
+using namespace IO::Common;
+
+namespace
+{
+  using IO::ADT::DataStructures::MDDF;
+  using IO::ADT::DataStructures::MODF;
+  using IO::ADT::DataStructures::SMLayer;
+  using IO::Common::DataStructures::TileIndex;
+
+  constexpr std::uint32_t INDEX_MAGIC = IO::Common::FourCC<"AIDX">;
+  constexpr std::uint32_t INDEX_VERSION = 1;
+
+  constexpr std::uint8_t ScopeOf(AssetKind kind)
+  {
+    return kind == AssetKind::TEXTURE ? AssetSubstitutor::SCOPE_TEXTURES : AssetSubstitutor::SCOPE_PLACEMENTS;
+  }
+
+  std::uint32_t FindOrAppend(std::vector<AssetReference>& table, AssetReference const& asset)
+  {
+    auto it = std::find(table.begin(), table.end(), asset);
+
+    if (it == table.end())
+      it = table.insert(table.end(), asset);
+
+    return static_cast<std::uint32_t>(it - table.begin());
+  }
+
+  template<typename Placement>
+  AssetReference ReferenceOf(Placement const& placement, std::vector<AssetReference> const& table)
+  {
+    if (placement.flags.use_filedata_id)
+      return AssetReference{{}, placement.name_id};
+
+    EnsureF(CCodeZones::FILE_IO, placement.name_id < table.size(), "Placement references non-existing file.");
+    return table[placement.name_id];
+  }
+
+  /**
+   * Points placements of substituted files to their replacements and rebuilds the file table from the files
+   * still referenced. Substituted placements reference files known by path through the table and others
+   * by FileDataID, the rest keep the way they reference files.
+   * @return Number of placements substituted.
+   */
+  template<typename Placement, typename Find>
+  std::size_t SubstitutePlacementsOf(std::vector<Placement>& placements
+                                     , std::vector<AssetReference>& table
+                                     , Find&& find
+                                     , std::size_t& n_removed_entries)
+  {
+    std::vector<AssetSubstitution const*> substitutions(placements.size());
+    std::size_t n_substituted = 0;
+
+    for (std::size_t i = 0; i < placements.size(); ++i)
+    {
+      substitutions[i] = find(ReferenceOf(placements[i], table));
+      n_substituted += substitutions[i] != nullptr;
+    }
+
+    if (!n_substituted)
+      return 0;
+
+    std::vector<AssetReference> new_table;
+
+    for (std::size_t i = 0; i < placements.size(); ++i)
+    {
+      Placement& placement = placements[i];
+
+      if (substitutions[i])
+      {
+        AssetReference const& asset = substitutions[i]->to;
+        placement.flags.use_filedata_id = asset.path.empty();
+        placement.name_id = asset.path.empty() ? asset.file_data_id : FindOrAppend(new_table, asset);
+      }
+      else if (!placement.flags.use_filedata_id)
+      {
+        placement.name_id = FindOrAppend(new_table, table[placement.name_id]);
+      }
+    }
+
+    n_removed_entries += std::count_if(table.begin(), table.end(), [&](AssetReference const& asset)
+    {
+      return std::find(new_table.begin(), new_table.end(), asset) == new_table.end();
+    });
+
+    table = std::move(new_table);
+
+    return n_substituted;
+  }
+
+  /**
+   * Realigns per-texture data (MHID, MTXP) with the rebuilt texture table. Duplicates collapsed into one texture
+   * keep the data of the first of them. Data not loaded stays empty.
+   */
+  template<typename T>
+  void RemapPerTexture(std::vector<T>& values, std::vector<std::uint32_t> const& texture_remap, std::size_t n_textures)
+  {
+    if (values.empty())
+      return;
+
+    EnsureF(CCodeZones::FILE_IO, values.size() == texture_remap.size()
+            , "Per-texture data does not match the texture table.");
+
+    std::vector<T> remapped(n_textures);
+    std::vector<bool> assigned(n_textures);
+
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+      std::uint32_t const texture = texture_remap[i];
+
+      if (texture != AssetSubstitutor::REMOVED_TEXTURE && !assigned[texture])
+      {
+        remapped[texture] = values[i];
+        assigned[texture] = true;
+      }
+    }
+
+    values = std::move(remapped);
+  }
+
+  /**
+   * Merges layers of a chunk referencing the same texture after remapping texture indices.
+   * @return Number of layers merged.
+   */
+  std::size_t RemapChunkLayers(ChunkTexturing& chunk, std::vector<std::uint32_t> const& texture_remap)
+  {
+    EnsureF(CCodeZones::FILE_IO, chunk.alphamaps.size() + 1 >= chunk.layers.size(), "Malformed chunk texturing.");
+
+    std::vector<SMLayer> layers;
+    std::vector<Alphamap> alphamaps;
+    std::size_t n_merged = 0;
+
+    for (std::size_t i = 0; i < chunk.layers.size(); ++i)
+    {
+      SMLayer layer = chunk.layers[i];
+
+      EnsureF(CCodeZones::FILE_IO, layer.textureId < texture_remap.size()
+                                   && texture_remap[layer.textureId] != AssetSubstitutor::REMOVED_TEXTURE
+              , "Texture layer references non-existing texture.");
+
+      layer.textureId = texture_remap[layer.textureId];
+
+      auto it = std::find_if(layers.begin(), layers.end()
+                             , [&](SMLayer const& other) { return other.textureId == layer.textureId; });
+
+      if (it == layers.end())
+      {
+        layers.push_back(layer);
+
+        if (i)
+          alphamaps.push_back(chunk.alphamaps[i - 1]);
+
+        continue;
+      }
+
+      ++n_merged;
+
+      // base layer weight is what remains of the others, so merging into it only drops the layer
+      if (auto const target = it - layers.begin(); target)
+      {
+        Alphamap& merged = alphamaps[target - 1];
+        Alphamap const& alpha = chunk.alphamaps[i - 1];
+
+        for (std::size_t pixel = 0; pixel < merged.size(); ++pixel)
+          merged[pixel] = static_cast<std::uint8_t>(std::min(merged[pixel] + alpha[pixel], 255));
+      }
+    }
+
+    if (n_merged)
+    {
+      for (SMLayer& layer : layers)
+        layer.offsetInMCAL = 0;
+    }
+
+    chunk.layers = std::move(layers);
+    chunk.alphamaps = std::move(alphamaps);
+
+    return n_merged;
+  }
+
+  template<typename T>
+  void AppendBytes(std::vector<char>& out, T const& value)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    char const* bytes = reinterpret_cast<char const*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+  }
+
+  void AppendTiles(std::vector<char>& out, AssetIndex::TileSet const& tiles)
+  {
+    AppendBytes(out, static_cast<std::uint16_t>(tiles.count()));
+
+    for (std::size_t i = 0; i < tiles.size(); ++i)
+    {
+      if (tiles[i])
+        AppendBytes(out, static_cast<std::uint16_t>(i));
+    }
+  }
+
+  AssetIndex::TileSet ReadTiles(ByteBuffer const& buf)
+  {
+    AssetIndex::TileSet tiles;
+    auto const n_tiles = buf.Read<std::uint16_t>();
+
+    for (std::uint16_t i = 0; i < n_tiles; ++i)
+    {
+      auto const tile = buf.Read<std::uint16_t>();
+      EnsureF(CCodeZones::FILE_IO, tile < tiles.size(), "Malformed asset index.");
+      tiles.set(tile);
+    }
+
+    return tiles;
+  }
+}
+
+TileAssets TileAssets::Collect(TileTexturing const& texturing, TilePlacements const& placements)
+{
+  TileAssets assets {texturing.textures, placements.models, placements.map_objects};
+
+  auto const collect_file_data_ids = [](auto const& tile_placements, std::vector<AssetReference>& references)
+  {
+    for (auto const& placement : tile_placements)
+    {
+      if (placement.flags.use_filedata_id)
+        FindOrAppend(references, AssetReference{{}, placement.name_id});
+    }
+  };
+
+  collect_file_data_ids(placements.model_placements, assets.models);
+  collect_file_data_ids(placements.map_object_placements, assets.map_objects);
+
+  return assets;
+}
+
+AssetIndex AssetIndex::Build(TileSet const& tiles, TileScanner const& scanner, unsigned n_threads)
+{
+  LogDebugF(LCodeZones::FILE_IO, "Building asset index of %d tiles.", tiles.count());
+
+  std::vector<std::size_t> tile_list;
+
+  for (std::size_t i = 0; i < tiles.size(); ++i)
+  {
+    if (tiles[i])
+      tile_list.push_back(i);
+  }
+
+  std::vector<TileAssets> tile_assets(tile_list.size());
+
+  Utils::Misc::ParallelFor(tile_list.size(), [&](std::size_t i)
+  {
+    TileIndex const tile_index {static_cast<std::uint16_t>(tile_list[i] % 64), static_cast<std::uint16_t>(tile_list[i] / 64)};
+
+    if (!scanner(tile_index, tile_assets[i]))
+      tile_assets[i] = {};
+  }, n_threads);
+
+  AssetIndex index;
+
+  for (std::size_t i = 0; i < tile_list.size(); ++i)
+  {
+    index.Insert(tile_list[i], AssetKind::TEXTURE, tile_assets[i].textures);
+    index.Insert(tile_list[i], AssetKind::MODEL, tile_assets[i].models);
+    index.Insert(tile_list[i], AssetKind::MAP_OBJECT, tile_assets[i].map_objects);
+  }
+
+  return index;
+}
+
+void AssetIndex::Insert(std::size_t tile, AssetKind kind, std::span<AssetReference const> references)
+{
+  KindIndex& index = _kinds[static_cast<std::size_t>(kind)];
+
+  for (AssetReference const& asset : references)
+  {
+    if (!asset.path.empty())
+      index.paths[Utils::PathUtils::NormalizeFilepathGame(asset.path)].set(tile);
+
+    if (asset.file_data_id)
+      index.file_data_ids[asset.file_data_id].set(tile);
+  }
+}
+
+void AssetIndex::Update(TileIndex tile_index, AssetKind kind, std::span<AssetReference const> references)
+{
+  RequireF(CCodeZones::FILE_IO, tile_index.x < 64 && tile_index.y < 64, "Tile index is out of map bounds.");
+
+  std::size_t const tile = tile_index.y * 64 + tile_index.x;
+  KindIndex& index = _kinds[static_cast<std::size_t>(kind)];
+
+  auto const remove_tile = [tile](auto& files)
+  {
+    for (auto it = files.begin(); it != files.end();)
+      it = it->second.reset(tile).any() ? std::next(it) : files.erase(it);
+  };
+
+  remove_tile(index.paths);
+  remove_tile(index.file_data_ids);
+
+  Insert(tile, kind, references);
+}
+
+AssetIndex::TileSet AssetIndex::Tiles(AssetKind kind, AssetReference const& asset) const
+{
+  KindIndex const& index = _kinds[static_cast<std::size_t>(kind)];
+  TileSet tiles;
+
+  if (!asset.path.empty())
+  {
+    if (auto it = index.paths.find(Utils::PathUtils::NormalizeFilepathGame(asset.path)); it != index.paths.end())
+      tiles |= it->second;
+  }
+
+  if (asset.file_data_id)
+  {
+    if (auto it = index.file_data_ids.find(asset.file_data_id); it != index.file_data_ids.end())
+      tiles |= it->second;
+  }
+
+  return tiles;
+}
+
+void AssetIndex::Read(ByteBuffer const& buf)
+{
+  EnsureF(CCodeZones::FILE_IO, buf.Read<std::uint32_t>() == INDEX_MAGIC, "Not an asset index.");
+  EnsureF(CCodeZones::FILE_IO, buf.Read<std::uint32_t>() == INDEX_VERSION, "Unsupported asset index version.");
+
+  for (KindIndex& index : _kinds)
+  {
+    index.paths.clear();
+    index.file_data_ids.clear();
+
+    auto const n_paths = buf.Read<std::uint32_t>();
+
+    for (std::uint32_t i = 0; i < n_paths; ++i)
+    {
+      std::string path {buf.ReadString()};
+      index.paths[std::move(path)] = ReadTiles(buf);
+    }
+
+    auto const n_file_data_ids = buf.Read<std::uint32_t>();
+
+    for (std::uint32_t i = 0; i < n_file_data_ids; ++i)
+    {
+      auto const file_data_id = buf.Read<std::uint32_t>();
+      index.file_data_ids[file_data_id] = ReadTiles(buf);
+    }
+  }
+}
+
+void AssetIndex::Write(ByteBuffer& buf) const
+{
+  // assembled in memory first, as buffer grows on every write
+  std::vector<char> out;
+
+  AppendBytes(out, INDEX_MAGIC);
+  AppendBytes(out, INDEX_VERSION);
+
+  for (KindIndex const& index : _kinds)
+  {
+    // sorted, so that the same index is always written the same way
+    std::vector<std::string const*> paths;
+    paths.reserve(index.paths.size());
+
+    for (auto const& [path, tiles] : index.paths)
+      paths.push_back(&path);
+
+    std::sort(paths.begin(), paths.end(), [](std::string const* lhs, std::string const* rhs) { return *lhs < *rhs; });
+
+    AppendBytes(out, static_cast<std::uint32_t>(paths.size()));
+
+    for (std::string const* path : paths)
+    {
+      out.insert(out.end(), path->begin(), path->end());
+      out.push_back('\0');
+      AppendTiles(out, index.paths.at(*path));
+    }
+
+    std::vector<std::uint32_t> file_data_ids;
+    file_data_ids.reserve(index.file_data_ids.size());
+
+    for (auto const& [file_data_id, tiles] : index.file_data_ids)
+      file_data_ids.push_back(file_data_id);
+
+    std::sort(file_data_ids.begin(), file_data_ids.end());
+
+    AppendBytes(out, static_cast<std::uint32_t>(file_data_ids.size()));
+
+    for (std::uint32_t file_data_id : file_data_ids)
+    {
+      AppendBytes(out, file_data_id);
+      AppendTiles(out, index.file_data_ids.at(file_data_id));
+    }
+  }
+
+  buf.Write(out.begin(), out.end());
+}
+
+AssetSubstitutor::AssetSubstitutor(std::vector<AssetSubstitution> substitutions)
+: _substitutions(std::move(substitutions))
+{
+  for (std::size_t i = 0; i < _substitutions.size(); ++i)
+  {
+    AssetSubstitution const& substitution = _substitutions[i];
+    KindLookup& lookup = _lookup[static_cast<std::size_t>(substitution.kind)];
+
+    RequireF(CCodeZones::FILE_IO, !substitution.from.path.empty() || substitution.from.file_data_id
+             , "Substituted file has neither path nor FileDataID.");
+    RequireF(CCodeZones::FILE_IO, !substitution.to.path.empty() || substitution.to.file_data_id
+             , "Replacement file has neither path nor FileDataID.");
+
+    bool unique = true;
+
+    if (!substitution.from.path.empty())
+      unique &= lookup.paths.emplace(Utils::PathUtils::NormalizeFilepathGame(substitution.from.path), i).second;
+
+    if (substitution.from.file_data_id)
+      unique &= lookup.file_data_ids.emplace(substitution.from.file_data_id, i).second;
+
+    RequireF(CCodeZones::FILE_IO, unique, "File is substituted more than once.");
+  }
+}
+
+AssetSubstitution const* AssetSubstitutor::Find(AssetKind kind, AssetReference const& asset) const
+{
+  KindLookup const& lookup = _lookup[static_cast<std::size_t>(kind)];
+
+  if (!asset.path.empty())
+  {
+    if (auto it = lookup.paths.find(Utils::PathUtils::NormalizeFilepathGame(asset.path)); it != lookup.paths.end())
+      return &_substitutions[it->second];
+  }
+
+  if (asset.file_data_id)
+  {
+    if (auto it = lookup.file_data_ids.find(asset.file_data_id); it != lookup.file_data_ids.end())
+      return &_substitutions[it->second];
+  }
+
+  return nullptr;
+}
+
+std::uint8_t AssetSubstitutor::SubstituteTile(std::uint8_t scope
+                                              , TileTexturing& texturing
+                                              , TilePlacements& placements
+                                              , std::vector<std::uint32_t>& texture_remap
+                                              , SubstitutionStats& stats) const
+{
+  std::uint8_t modified = 0;
+
+  if (scope & SCOPE_TEXTURES)
+    modified |= SubstituteTextures(texturing, texture_remap, stats);
+
+  if (scope & SCOPE_PLACEMENTS)
+    modified |= SubstitutePlacements(placements, stats);
+
+  return modified;
+}
+
+std::uint8_t AssetSubstitutor::SubstituteTextures(TileTexturing& texturing
+                                                  , std::vector<std::uint32_t>& texture_remap
+                                                  , SubstitutionStats& stats) const
+{
+  std::vector<AssetReference> substituted = texturing.textures;
+  std::size_t n_substituted = 0;
+
+  for (std::size_t i = 0; i < substituted.size(); ++i)
+  {
+    if (AssetSubstitution const* substitution = Find(AssetKind::TEXTURE, substituted[i]))
+    {
+      substituted[i] = substitution->to;
+      ++n_substituted;
+
+      // height texture belongs to the replaced diffuse texture
+      if (i < texturing.height_textures.size())
+        texturing.height_textures[i] = 0;
+    }
+  }
+
+  if (!n_substituted)
+    return 0;
+
+  stats.n_textures += n_substituted;
+
+  // textures keep their order, duplicates collapse into the first one and unused ones are dropped
+  std::vector<bool> used(substituted.size());
+
+  for (ChunkTexturing const& chunk : texturing.chunks)
+  {
+    for (SMLayer const& layer : chunk.layers)
+    {
+      EnsureF(CCodeZones::FILE_IO, layer.textureId < used.size(), "Texture layer references non-existing texture.");
+      used[layer.textureId] = true;
+    }
+  }
+
+  std::vector<AssetReference> textures;
+  texture_remap.assign(substituted.size(), REMOVED_TEXTURE);
+
+  for (std::size_t i = 0; i < substituted.size(); ++i)
+  {
+    if (used[i])
+      texture_remap[i] = FindOrAppend(textures, substituted[i]);
+  }
+
+  stats.n_removed_entries += substituted.size() - textures.size();
+  RemapPerTexture(texturing.height_textures, texture_remap, textures.size());
+  RemapPerTexture(texturing.texture_params, texture_remap, textures.size());
+  texturing.textures = std::move(textures);
+
+  for (ChunkTexturing& chunk : texturing.chunks)
+    stats.n_merged_layers += RemapChunkLayers(chunk, texture_remap);
+
+  return SCOPE_TEXTURES;
+}
+
+std::uint8_t AssetSubstitutor::SubstitutePlacements(TilePlacements& placements, SubstitutionStats& stats) const
+{
+  std::size_t const n_models = SubstitutePlacementsOf(placements.model_placements, placements.models
+                                                      , [this](AssetReference const& asset)
+                                                        { return Find(AssetKind::MODEL, asset); }
+                                                      , stats.n_removed_entries);
+
+  std::size_t const n_map_objects = SubstitutePlacementsOf(placements.map_object_placements, placements.map_objects
+                                                           , [this](AssetReference const& asset)
+                                                             { return Find(AssetKind::MAP_OBJECT, asset); }
+                                                           , stats.n_removed_entries);
+
+  stats.n_model_placements += n_models;
+  stats.n_map_object_placements += n_map_objects;
+
+  return n_models || n_map_objects ? SCOPE_PLACEMENTS : 0;
+}
+
+SubstitutionStats AssetSubstitutor::Substitute(AssetIndex& index
+                                               , TileLoader const& loader
+                                               , TileConsumer const& consumer
+                                               , unsigned n_threads) const
+{
+  std::array<std::uint8_t, WorldConstants::MAX_TILES_PER_MAP> scopes {};
+
+  for (AssetSubstitution const& substitution : _substitutions)
+  {
+    AssetIndex::TileSet const tiles = index.Tiles(substitution.kind, substitution.from);
+
+    for (std::size_t i = 0; i < tiles.size(); ++i)
+      scopes[i] |= tiles[i] ? ScopeOf(substitution.kind) : 0;
+  }
+
+  std::vector<std::size_t> tile_list;
+
+  for (std::size_t i = 0; i < scopes.size(); ++i)
+  {
+    if (scopes[i])
+      tile_list.push_back(i);
+  }
+
+  LogDebugF(LCodeZones::FILE_IO, "Substituting %d files in %d tiles.", _substitutions.size(), tile_list.size());
+
+  struct TileResult
+  {
+    bool exists = false;
+    std::uint8_t modified = 0;
+    SubstitutionStats stats;
+    TileAssets assets;
+  };
+
+  std::vector<TileResult> results(tile_list.size());
+
+  Utils::Misc::ParallelFor(tile_list.size(), [&](std::size_t i)
+  {
+    TileIndex const tile_index {static_cast<std::uint16_t>(tile_list[i] % 64), static_cast<std::uint16_t>(tile_list[i] / 64)};
+    std::uint8_t const scope = scopes[tile_list[i]];
+
+    auto texturing = std::make_unique<TileTexturing>();
+    auto placements = std::make_unique<TilePlacements>();
+
+    TileResult& result = results[i];
+    result.exists = loader(tile_index, scope, *texturing, *placements);
+
+    if (!result.exists)
+      return;
+
+    std::vector<std::uint32_t> texture_remap;
+    result.modified = SubstituteTile(scope, *texturing, *placements, texture_remap, result.stats);
+
+    if (result.modified)
+      consumer(tile_index, result.modified, *texturing, *placements, texture_remap);
+
+    result.assets = TileAssets::Collect(*texturing, *placements);
+  }, n_threads);
+
+  SubstitutionStats stats;
+
+  // the index is updated for every tile visited, which also drops stale entries of tiles no longer referencing
+  // substituted files or no longer existing
+  for (std::size_t i = 0; i < tile_list.size(); ++i)
+  {
+    TileIndex const tile_index {static_cast<std::uint16_t>(tile_list[i] % 64), static_cast<std::uint16_t>(tile_list[i] / 64)};
+    std::uint8_t const scope = scopes[tile_list[i]];
+    TileResult const& result = results[i];
+
+    if (scope & SCOPE_TEXTURES)
+      index.Update(tile_index, AssetKind::TEXTURE, result.assets.textures);
+
+    if (scope & SCOPE_PLACEMENTS)
+    {
+      index.Update(tile_index, AssetKind::MODEL, result.assets.models);
+      index.Update(tile_index, AssetKind::MAP_OBJECT, result.assets.map_objects);
+    }
+
+    stats.n_tiles += result.modified != 0;
+    stats.n_textures += result.stats.n_textures;
+    stats.n_model_placements += result.stats.n_model_placements;
+    stats.n_map_object_placements += result.stats.n_map_object_placements;
+    stats.n_merged_layers += result.stats.n_merged_layers;
+    stats.n_removed_entries += result.stats.n_removed_entries;
+  }
+
+  LogDebugF(LCodeZones::FILE_IO, "Substituted files in %d tiles, merged %d layers."
+            , stats.n_tiles, stats.n_merged_layers);
+
+  return stats;
+}
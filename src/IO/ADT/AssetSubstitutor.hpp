@@ -0,0 +1,249 @@
+#pragma once
+#include <IO/ByteBuffer.hpp>
+#include <IO/CommonDataStructures.hpp>
+#include <IO/WorldConstants.hpp>
+#include <IO/ADT/TileData.hpp>
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace IO::ADT
+{
+  enum class AssetKind : std::uint8_t
+  {
+    TEXTURE = 0, ///> Terrain texture (MTEX / MDID).
+    MODEL = 1, ///> M2 placed by MDDF (MMDX / MMID, or FileDataID).
+    MAP_OBJECT = 2 ///> WMO placed by MODF (MWMO / MWID, or FileDataID).
+  };
+
+  /**
+   * Files referenced by one map tile, grouped by kind.
+   */
+  struct TileAssets
+  {
+    std::vector<AssetReference> textures;
+    std::vector<AssetReference> models;
+    std::vector<AssetReference> map_objects;
+
+    /**
+     * Collects references of a tile. Placements referencing files by FileDataID are included.
+     * @param texturing Texturing of the tile.
+     * @param placements Placements of the tile.
+     * @return References of the tile.
+     */
+    [[nodiscard]]
+    static TileAssets Collect(TileTexturing const& texturing, TilePlacements const& placements);
+  };
+
+  /**
+   * Inverted index of a map, from referenced files to the tiles referencing them. Files are keyed by normalized
+   * path and by FileDataID, a reference known by both is found by either.
+   *
+   * Building the index needs a scan of all tiles, so it is meant to be built once, stored with Write()
+   * and kept current with Update() as tiles change. One index covers one map.
+   */
+  class AssetIndex
+  {
+  public:
+    using TileSet = std::bitset<Common::WorldConstants::MAX_TILES_PER_MAP>;
+
+    /**
+     * Reads references of a tile. Invoked concurrently from worker threads, must be thread-safe.
+     * Must match signature: bool(Common::DataStructures::TileIndex tile_index, TileAssets& assets).
+     * Returns false if tile does not exist.
+     */
+    using TileScanner = std::function<bool(Common::DataStructures::TileIndex, TileAssets&)>;
+
+    AssetIndex() = default;
+
+    /**
+     * Builds the index by scanning tiles in parallel.
+     * @param tiles Tiles of the map, bit (y * 64 + x).
+     * @param scanner Tile scanner callback.
+     * @param n_threads Number of worker threads. 0 means hardware concurrency.
+     * @return Index of the map.
+     */
+    [[nodiscard]]
+    static AssetIndex Build(TileSet const& tiles, TileScanner const& scanner, unsigned n_threads = 0);
+
+    /**
+     * Replaces references of one kind held by a tile.
+     * @param tile_index Tile.
+     * @param kind Kind of references.
+     * @param references New references of the tile, empty to remove the tile.
+     */
+    void Update(Common::DataStructures::TileIndex tile_index
+                , AssetKind kind
+                , std::span<AssetReference const> references);
+
+    /**
+     * @param kind Kind of the file.
+     * @param asset File, by path, FileDataID or both.
+     * @return Tiles referencing the file, bit (y * 64 + x).
+     */
+    [[nodiscard]]
+    TileSet Tiles(AssetKind kind, AssetReference const& asset) const;
+
+    /**
+     * Reads index previously written with Write().
+     * @param buf Buffer to read from.
+     */
+    void Read(Common::ByteBuffer const& buf);
+
+    /**
+     * Writes index in a compact binary form.
+     * @param buf Buffer to write to.
+     */
+    void Write(Common::ByteBuffer& buf) const;
+
+  private:
+    void Insert(std::size_t tile, AssetKind kind, std::span<AssetReference const> references);
+
+    struct KindIndex
+    {
+      std::unordered_map<std::string, TileSet> paths; ///> Keyed by Utils::PathUtils::NormalizeFilepathGame().
+      std::unordered_map<std::uint32_t, TileSet> file_data_ids;
+    };
+
+    std::array<KindIndex, 3> _kinds;
+  };
+
+  /**
+   * Replacement of one file by another.
+   */
+  struct AssetSubstitution
+  {
+    AssetKind kind;
+    AssetReference from; ///> Matched by normalized path and by FileDataID, whichever is known.
+    AssetReference to;
+  };
+
+  struct SubstitutionStats
+  {
+    std::size_t n_tiles = 0; ///> Tiles modified.
+    std::size_t n_textures = 0; ///> Texture table entries substituted.
+    std::size_t n_model_placements = 0; ///> MDDF entries pointed to another file.
+    std::size_t n_map_object_placements = 0; ///> MODF entries pointed to another file.
+    std::size_t n_merged_layers = 0; ///> MCLY layers merged into another layer of the same texture.
+    std::size_t n_removed_entries = 0; ///> Duplicate or unreferenced texture, model and map object table entries.
+  };
+
+  /**
+   * Replaces textures, models and map objects across a map, driven by a table of substitutions.
+   *
+   * Only tiles the AssetIndex lists as referencing a substituted file are loaded, and only the files affected
+   * (texture or object ADT) are requested and handed back. Tiles are processed in parallel.
+   *
+   * Substituting textures can leave a chunk with several layers of the same texture. Those are merged into
+   * the first of them: weights of merged layers are added up, merging into the base layer drops the layer,
+   * as base weight is what remains of the others. Tables of modified tiles are rebuilt, without duplicates
+   * and unreferenced entries. Height textures (MHID) and texture parameters (MTXP) are compacted along with
+   * the texture table, substituted textures lose their height texture as it belonged to the replaced file.
+   * Substitutions are applied once, a file substituted to another substituted file is not substituted again.
+   */
+  class AssetSubstitutor
+  {
+  public:
+    /**
+     * Data of a tile to load and store, combination of flags.
+     */
+    enum SubstitutionScope : std::uint8_t
+    {
+      SCOPE_TEXTURES = 0x1, ///> TileTexturing, texture ADT.
+      SCOPE_PLACEMENTS = 0x2 ///> TilePlacements, object ADT.
+    };
+
+    /**
+     * Marks texture table entries removed from a tile in texture remap.
+     */
+    static constexpr std::uint32_t REMOVED_TEXTURE = 0xFFFFFFFF;
+
+    /**
+     * Loads a tile. Invoked concurrently from worker threads, must be thread-safe.
+     * Must match signature: bool(Common::DataStructures::TileIndex tile_index, std::uint8_t scope
+     *                            , TileTexturing& texturing, TilePlacements& placements).
+     * Only data selected by scope (SubstitutionScope flags) needs to be loaded.
+     * Returns false if tile does not exist.
+     */
+    using TileLoader = std::function<bool(Common::DataStructures::TileIndex, std::uint8_t
+                                          , TileTexturing&, TilePlacements&)>;
+
+    /**
+     * Receives a modified tile. Invoked concurrently from worker threads for distinct tiles.
+     * Must match signature: void(Common::DataStructures::TileIndex tile_index, std::uint8_t scope
+     *                            , TileTexturing const& texturing, TilePlacements const& placements
+     *                            , std::span<std::uint32_t const> texture_remap).
+     * Scope holds data actually modified, only that needs to be stored. Texture remap maps old texture table
+     * indices to new ones (or REMOVED_TEXTURE), so that per-texture data kept by the caller outside of
+     * TileTexturing (e.g. MTXF) can be realigned. It is empty if textures were not modified.
+     */
+    using TileConsumer = std::function<void(Common::DataStructures::TileIndex, std::uint8_t
+                                            , TileTexturing const&, TilePlacements const&
+                                            , std::span<std::uint32_t const>)>;
+
+    /**
+     * @param substitutions Substitutions to apply. Each file may only be substituted once.
+     */
+    explicit AssetSubstitutor(std::vector<AssetSubstitution> substitutions);
+
+    /**
+     * Applies substitutions to all affected tiles of a map, and updates the index with new references
+     * of modified tiles.
+     * @param index Index of the map.
+     * @param loader Tile loader callback.
+     * @param consumer Modified tile consumer callback.
+     * @param n_threads Number of worker threads. 0 means hardware concurrency.
+     * @return Substitution stats.
+     */
+    SubstitutionStats Substitute(AssetIndex& index
+                                 , TileLoader const& loader
+                                 , TileConsumer const& consumer
+                                 , unsigned n_threads = 0) const;
+
+    /**
+     * Applies substitutions to one tile.
+     * @param scope Data of the tile to process, SubstitutionScope flags.
+     * @param texturing Texturing of the tile.
+     * @param placements Placements of the tile.
+     * @param texture_remap Receives mapping of old texture indices to new ones if textures were modified.
+     * @param stats Stats to add to.
+     * @return Data modified, SubstitutionScope flags.
+     */
+    std::uint8_t SubstituteTile(std::uint8_t scope
+                                , TileTexturing& texturing
+                                , TilePlacements& placements
+                                , std::vector<std::uint32_t>& texture_remap
+                                , SubstitutionStats& stats) const;
+
+    [[nodiscard]]
+    std::vector<AssetSubstitution> const& Substitutions() const { return _substitutions; };
+
+  private:
+    /**
+     * @return Substitution matching the file, or nullptr.
+     */
+    [[nodiscard]]
+    AssetSubstitution const* Find(AssetKind kind, AssetReference const& asset) const;
+
+    std::uint8_t SubstituteTextures(TileTexturing& texturing
+                                    , std::vector<std::uint32_t>& texture_remap
+                                    , SubstitutionStats& stats) const;
+
+    std::uint8_t SubstitutePlacements(TilePlacements& placements, SubstitutionStats& stats) const;
+
+    struct KindLookup
+    {
+      std::unordered_map<std::string, std::size_t> paths;
+      std::unordered_map<std::uint32_t, std::size_t> file_data_ids;
+    };
+
+    std::vector<AssetSubstitution> _substitutions;
+    std::array<KindLookup, 3> _lookup;
+  };
+}
@@ -0,0 +1,423 @@
+#include <IO/ADT/ChangeFeed.hpp>
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+using namespace IO::ADT;
+using namespace IO::Common;
+
+namespace
+{
+  using IO::Common::DataStructures::TileIndex;
+
+  constexpr unsigned N_QUADS_CHUNK = 64;
+  constexpr unsigned N_QUADS_CHUNK_ROW = 8;
+  constexpr unsigned N_LIQUID_VERTICES_ROW = N_QUADS_CHUNK_ROW + 1;
+
+  template<typename T>
+  bool SameBytes(T const& lhs, T const& rhs)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    return !std::memcmp(&lhs, &rhs, sizeof(T));
+  }
+
+  /**
+   * Collects changes of one tile before they are handed to the feed at once.
+   */
+  struct TileDiff
+  {
+    TileIndex tile;
+    std::vector<ChangeRecord> changes;
+
+    /**
+     * Records runs of consecutive changed indices in range [0, n).
+     * Changed must match signature: bool(std::uint32_t index).
+     */
+    template<typename Changed>
+    void Runs(std::uint16_t chunk, ChangeField field, std::uint32_t n, Changed&& changed)
+    {
+      std::uint32_t begin = 0;
+
+      while (begin < n)
+      {
+        if (!changed(begin))
+        {
+          ++begin;
+          continue;
+        }
+
+        std::uint32_t end = begin + 1;
+
+        while (end < n && changed(end))
+          ++end;
+
+        changes.push_back(ChangeRecord{tile, chunk, field, begin, end});
+        begin = end;
+      }
+    }
+
+    /**
+     * Records changed elements of two arrays, elements present in only one of them count as changed.
+     */
+    template<typename Array, typename Equal>
+    void Elements(std::uint16_t chunk, ChangeField field, Array const& before, Array const& after, Equal&& equal)
+    {
+      auto const n = static_cast<std::uint32_t>(std::max(before.size(), after.size()));
+
+      Runs(chunk, field, n, [&](std::uint32_t i)
+      {
+        return i >= before.size() || i >= after.size() || !equal(before[i], after[i]);
+      });
+    }
+
+    template<typename Array>
+    void Elements(std::uint16_t chunk, ChangeField field, Array const& before, Array const& after)
+    {
+      Elements(chunk, field, before, after, [](auto const& lhs, auto const& rhs) { return SameBytes(lhs, rhs); });
+    }
+  };
+
+  /**
+   * Liquid of a quad across all layers covering it, compared as a whole.
+   */
+  struct QuadLiquidState
+  {
+    std::uint16_t liquid_type;
+    std::array<float, 4> heights;
+    std::array<char, 4> depths;
+
+    bool operator==(QuadLiquidState const& other) const = default;
+  };
+
+  /**
+   * Tiles loaded through tracked callbacks and not consumed yet, shared by the loader and the consumer.
+   */
+  template<typename Tile>
+  struct LoadedTiles
+  {
+    std::mutex mutex;
+    std::map<std::uint16_t, Tile> tiles; ///> By tile y * 64 + x.
+
+    void Keep(TileIndex tile_index, Tile const& tile)
+    {
+      std::lock_guard const lock {mutex};
+      tiles.try_emplace(static_cast<std::uint16_t>(tile_index.y * 64 + tile_index.x), tile);
+    }
+
+    [[nodiscard]]
+    Tile Release(TileIndex tile_index)
+    {
+      std::lock_guard const lock {mutex};
+      auto node = tiles.extract(static_cast<std::uint16_t>(tile_index.y * 64 + tile_index.x));
+      RequireF(CCodeZones::FILE_IO, !node.empty(), "Consumed tile was not loaded through the tracked loader.");
+
+      return std::move(node.mapped());
+    }
+  };
+
+  std::array<std::vector<QuadLiquidState>, N_QUADS_CHUNK> ChunkLiquidStates(LiquidChunk const& chunk)
+  {
+    std::array<std::vector<QuadLiquidState>, N_QUADS_CHUNK> states;
+
+    for (LiquidLayer const& layer : chunk.Layers())
+    {
+      LiquidVertexValues const values = LiquidFiller::LayerValues(layer);
+
+      for (unsigned quad = 0; quad < N_QUADS_CHUNK; ++quad)
+      {
+        if (!layer.exists_map[quad])
+          continue;
+
+        QuadLiquidState state {layer.liquid_type, {}, {}};
+
+        for (unsigned corner = 0; corner < 4; ++corner)
+        {
+          unsigned const vertex = (quad / N_QUADS_CHUNK_ROW + corner / 2) * N_LIQUID_VERTICES_ROW
+            + quad % N_QUADS_CHUNK_ROW + corner % 2;
+
+          state.heights[corner] = values.heights[vertex];
+          state.depths[corner] = values.depths[vertex];
+        }
+
+        states[quad].push_back(state);
+      }
+    }
+
+    return states;
+  }
+}
+
+ChangeFeed::ChangeFeed(std::uint32_t coalesce_gap)
+: _coalesce_gap(coalesce_gap)
+{
+}
+
+std::size_t ChangeFeed::Subscribe(Subscriber subscriber)
+{
+  std::lock_guard const lock {_subscribers_mutex};
+
+  std::size_t const handle = _next_handle++;
+  _subscribers.emplace(handle, std::move(subscriber));
+
+  return handle;
+}
+
+void ChangeFeed::Unsubscribe(std::size_t handle)
+{
+  std::lock_guard const lock {_subscribers_mutex};
+
+  [[maybe_unused]] std::size_t const n_erased = _subscribers.erase(handle);
+  RequireF(CCodeZones::FILE_IO, n_erased, "Unknown change feed subscription.");
+}
+
+void ChangeFeed::Record(TileIndex tile, std::uint16_t chunk, ChangeField field, std::uint32_t begin, std::uint32_t end)
+{
+  ChangeRecord const change {tile, chunk, field, begin, end};
+  RecordAll({&change, 1});
+}
+
+void ChangeFeed::RecordAll(std::span<ChangeRecord const> changes)
+{
+  std::lock_guard const lock {_pending_mutex};
+
+  for (ChangeRecord const& change : changes)
+  {
+    RequireF(CCodeZones::FILE_IO, change.tile.x < 64 && change.tile.y < 64, "Tile index out of bounds.");
+    RequireF(CCodeZones::FILE_IO, change.chunk < Common::WorldConstants::CHUNKS_PER_TILE
+                                  || change.chunk == TILE_LEVEL_CHANGE, "Chunk index out of bounds.");
+
+    if (change.begin >= change.end)
+      continue;
+
+    _pending[RecordKey{change.tile.y, change.tile.x, change.chunk, change.field}]
+      .push_back(IndexRange{change.begin, change.end});
+  }
+}
+
+std::vector<ChangeRecord> ChangeFeed::Flush()
+{
+  decltype(_pending) pending;
+
+  {
+    std::lock_guard const lock {_pending_mutex};
+    pending.swap(_pending);
+  }
+
+  std::vector<ChangeRecord> changes;
+
+  for (auto& [key, ranges] : pending)
+  {
+    auto const& [tile_y, tile_x, chunk, field] = key;
+
+    std::sort(ranges.begin(), ranges.end()
+              , [](IndexRange const& lhs, IndexRange const& rhs) { return lhs.begin < rhs.begin; });
+
+    std::size_t const first = changes.size();
+
+    for (IndexRange const& range : ranges)
+    {
+      if (changes.size() > first && std::uint64_t{range.begin} <= std::uint64_t{changes.back().end} + _coalesce_gap)
+      {
+        changes.back().end = std::max(changes.back().end, range.end);
+        continue;
+      }
+
+      changes.push_back(ChangeRecord{TileIndex{tile_x, tile_y}, chunk, field, range.begin, range.end});
+    }
+  }
+
+  if (changes.empty())
+    return changes;
+
+  LogDebugF(LCodeZones::FILE_IO, "Delivering %d coalesced changes.", changes.size());
+
+  // subscribers are invoked without holding the lock, so that they may (un)subscribe
+  std::vector<Subscriber> subscribers;
+
+  {
+    std::lock_guard const lock {_subscribers_mutex};
+
+    for (auto const& [handle, subscriber] : _subscribers)
+      subscribers.push_back(subscriber);
+  }
+
+  for (Subscriber const& subscriber : subscribers)
+    subscriber(changes);
+
+  return changes;
+}
+
+void ChangeFeed::Discard()
+{
+  std::lock_guard const lock {_pending_mutex};
+  _pending.clear();
+}
+
+void ChangeFeed::DiffTerrain(TileIndex tile, TileTerrain const& before, TileTerrain const& after)
+{
+  TileDiff diff {tile, {}};
+
+  for (std::uint16_t i = 0; i < Common::WorldConstants::CHUNKS_PER_TILE; ++i)
+  {
+    ChunkTerrain const& lhs = before[i];
+    ChunkTerrain const& rhs = after[i];
+
+    if (!SameBytes(lhs.header, rhs.header))
+      diff.changes.push_back(ChangeRecord{tile, i, ChangeField::CHUNK_HEADER, 0, 1});
+
+    diff.Elements(i, ChangeField::HEIGHTS, lhs.heightmap, rhs.heightmap);
+    diff.Elements(i, ChangeField::NORMALS, lhs.normals, rhs.normals);
+    diff.Elements(i, ChangeField::VERTEX_COLORS, lhs.vertex_colors, rhs.vertex_colors);
+
+    std::uint64_t const holes = ChunkHoleMask(lhs.header) ^ ChunkHoleMask(rhs.header);
+    diff.Runs(i, ChangeField::HOLES, N_QUADS_CHUNK, [&](std::uint32_t quad) { return (holes >> quad) & 1; });
+  }
+
+  RecordAll(diff.changes);
+}
+
+void ChangeFeed::DiffTexturing(TileIndex tile, TileTexturing const& before, TileTexturing const& after)
+{
+  TileDiff diff {tile, {}};
+
+  diff.Elements(TILE_LEVEL_CHANGE, ChangeField::TEXTURES, before.textures, after.textures, std::equal_to<>{});
+
+  for (std::uint16_t i = 0; i < Common::WorldConstants::CHUNKS_PER_TILE; ++i)
+  {
+    ChunkTexturing const& lhs = before.chunks[i];
+    ChunkTexturing const& rhs = after.chunks[i];
+
+    diff.Elements(i, ChangeField::TEXTURE_LAYERS, lhs.layers, rhs.layers);
+
+    std::size_t const n_alphamaps = std::max(lhs.alphamaps.size(), rhs.alphamaps.size());
+
+    diff.Runs(i, ChangeField::ALPHAMAPS, Common::WorldConstants::ALPHAMAP_DIM, [&](std::uint32_t row)
+    {
+      for (std::size_t layer = 0; layer < n_alphamaps; ++layer)
+      {
+        if (layer >= lhs.alphamaps.size() || layer >= rhs.alphamaps.size())
+          return true;
+
+        auto const lhs_row = lhs.alphamaps[layer].begin() + row * Common::WorldConstants::ALPHAMAP_DIM;
+        auto const rhs_row = rhs.alphamaps[layer].begin() + row * Common::WorldConstants::ALPHAMAP_DIM;
+
+        if (!std::equal(lhs_row, lhs_row + Common::WorldConstants::ALPHAMAP_DIM, rhs_row))
+          return true;
+      }
+
+      return false;
+    });
+
+    // whole rows are compared at once
+    auto const shadow_changes = lhs.shadowmap ^ rhs.shadowmap;
+
+    if (shadow_changes.any())
+    {
+      diff.Runs(i, ChangeField::SHADOWS, Common::WorldConstants::SHADOWMAP_DIM, [&](std::uint32_t row)
+      {
+        for (unsigned x = 0; x < Common::WorldConstants::SHADOWMAP_DIM; ++x)
+        {
+          if (shadow_changes[row * Common::WorldConstants::SHADOWMAP_DIM + x])
+            return true;
+        }
+
+        return false;
+      });
+    }
+  }
+
+  RecordAll(diff.changes);
+}
+
+void ChangeFeed::DiffLiquids(TileIndex tile, MH2O const& before, MH2O const& after)
+{
+  TileDiff diff {tile, {}};
+
+  for (std::uint16_t i = 0; i < Common::WorldConstants::CHUNKS_PER_TILE; ++i)
+  {
+    LiquidChunk const& lhs = before.chunks()[i];
+    LiquidChunk const& rhs = after.chunks()[i];
+
+    if (lhs.Layers().empty() && rhs.Layers().empty())
+      continue;
+
+    auto const lhs_states = ChunkLiquidStates(lhs);
+    auto const rhs_states = ChunkLiquidStates(rhs);
+
+    diff.Runs(i, ChangeField::LIQUIDS, N_QUADS_CHUNK, [&](std::uint32_t quad)
+    {
+      return lhs_states[quad] != rhs_states[quad];
+    });
+  }
+
+  RecordAll(diff.changes);
+}
+
+void ChangeFeed::DiffPlacements(TileIndex tile, TilePlacements const& before, TilePlacements const& after)
+{
+  TileDiff diff {tile, {}};
+
+  diff.Elements(TILE_LEVEL_CHANGE, ChangeField::MODELS, before.models, after.models, std::equal_to<>{});
+  diff.Elements(TILE_LEVEL_CHANGE, ChangeField::MAP_OBJECTS, before.map_objects, after.map_objects, std::equal_to<>{});
+  diff.Elements(TILE_LEVEL_CHANGE, ChangeField::MODEL_PLACEMENTS, before.model_placements, after.model_placements);
+  diff.Elements(TILE_LEVEL_CHANGE, ChangeField::MAP_OBJECT_PLACEMENTS
+                , before.map_object_placements, after.map_object_placements);
+
+  RecordAll(diff.changes);
+}
+
+void ChangeFeed::DiffTile(TileIndex tile, RegionTile const& before, RegionTile const& after)
+{
+  DiffTerrain(tile, before.terrain, after.terrain);
+  DiffTexturing(tile, before.texturing, after.texturing);
+  DiffLiquids(tile, before.liquids, after.liquids);
+  DiffPlacements(tile, before.placements, after.placements);
+}
+
+ChangeFeed::TrackedTiles ChangeFeed::TrackTiles(RegionClipboard::TileLoader loader
+                                                , RegionClipboard::TileConsumer consumer)
+{
+  auto loaded = std::make_shared<LoadedTiles<RegionTile>>();
+
+  return TrackedTiles
+  {
+    [loaded, loader = std::move(loader)](TileIndex tile_index, RegionTile& tile)
+    {
+      if (!loader(tile_index, tile))
+        return false;
+
+      loaded->Keep(tile_index, tile);
+      return true;
+    },
+    [this, loaded, consumer = std::move(consumer)](TileIndex tile_index, RegionTile const& tile)
+    {
+      consumer(tile_index, tile);
+      DiffTile(tile_index, loaded->Release(tile_index), tile);
+    }
+  };
+}
+
+ChangeFeed::TrackedLiquids ChangeFeed::TrackLiquids(LiquidFiller::LiquidLoader loader
+                                                    , LiquidFiller::LiquidConsumer consumer)
+{
+  auto loaded = std::make_shared<LoadedTiles<MH2O>>();
+
+  return TrackedLiquids
+  {
+    [loaded, loader = std::move(loader)](TileIndex tile_index, MH2O& liquids)
+    {
+      loader(tile_index, liquids);
+      loaded->Keep(tile_index, liquids);
+    },
+    [this, loaded, consumer = std::move(consumer)](TileIndex tile_index, MH2O const& liquids)
+    {
+      consumer(tile_index, liquids);
+      DiffLiquids(tile_index, loaded->Release(tile_index), liquids);
+    }
+  };
+}
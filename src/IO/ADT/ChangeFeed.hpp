@@ -0,0 +1,229 @@
+#pragma once
+#include <IO/CommonDataStructures.hpp>
+#include <IO/ADT/TileData.hpp>
+#include <IO/ADT/RegionClipboard.hpp>
+#include <IO/ADT/Root/LiquidFiller.hpp>
+#include <IO/ADT/Root/MH2O.hpp>
+#include <IO/ADT/Root/TileTerrain.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <span>
+#include <tuple>
+#include <vector>
+
+namespace IO::ADT
+{
+  /**
+   * Kind of data a change applies to. Determines what indices of a ChangeRecord refer to.
+   */
+  enum class ChangeField : std::uint8_t
+  {
+    CHUNK_HEADER = 0, ///> MCNK header, index 0.
+    HEIGHTS = 1, ///> MCVT, vertex indices.
+    NORMALS = 2, ///> MCNR, vertex indices.
+    VERTEX_COLORS = 3, ///> MCCV, vertex indices.
+    HOLES = 4, ///> Quad indices (y * 8 + x).
+    TEXTURE_LAYERS = 5, ///> MCLY, layer indices.
+    ALPHAMAPS = 6, ///> MCAL, pixel rows of all layers.
+    SHADOWS = 7, ///> MCSH, pixel rows.
+    LIQUIDS = 8, ///> MH2O, quad indices (y * 8 + x).
+    TEXTURES = 9, ///> Tile texture table, entry indices.
+    MODELS = 10, ///> Tile model file table, entry indices.
+    MAP_OBJECTS = 11, ///> Tile map object file table, entry indices.
+    MODEL_PLACEMENTS = 12, ///> MDDF, row indices.
+    MAP_OBJECT_PLACEMENTS = 13 ///> MODF, row indices.
+  };
+
+  /**
+   * Chunk value of changes that apply to a whole tile rather than to one of its chunks.
+   */
+  constexpr std::uint16_t TILE_LEVEL_CHANGE = 0xFFFF;
+
+  /**
+   * Changed range of indices [begin, end) of one field of one chunk or tile.
+   */
+  struct ChangeRecord
+  {
+    Common::DataStructures::TileIndex tile;
+    std::uint16_t chunk; ///> Row-major chunk index, or TILE_LEVEL_CHANGE.
+    ChangeField field;
+    std::uint32_t begin;
+    std::uint32_t end;
+  };
+
+  /**
+   * Collects changes made to tiles and delivers them to subscribers in coalesced batches, so that consumers
+   * such as renderers, navigation builders or spatial indices rebuild only what changed.
+   *
+   * Changes are either recorded explicitly by editing code, or derived by diffing detached tile data
+   * (TileTerrain, TileTexturing, MH2O, TilePlacements) before and after an edit. ADT files and MH2O do not
+   * report their own mutations, so diffing needs a copy of each tile as it was before the edit. TrackTiles()
+   * and TrackLiquids() keep that copy for the tools editing through loader and consumer callbacks
+   * (RegionClipboard, LiquidFiller), from loading a tile until it is consumed. Editing code that knows what
+   * it changed should call Record() instead and avoid the copy.
+   *
+   * Recording is thread-safe, so tiles processed in parallel can report into one feed. Nothing is delivered
+   * until Flush(), which merges overlapping and nearby ranges of the same chunk and field, and sorts records
+   * by tile, chunk and field.
+   */
+  class ChangeFeed
+  {
+  public:
+    /**
+     * Receives a batch of changes. Invoked on the thread calling Flush().
+     * Must match signature: void(std::span<ChangeRecord const> changes).
+     */
+    using Subscriber = std::function<void(std::span<ChangeRecord const>)>;
+
+    /**
+     * Callbacks of RegionClipboard::Paste() that record changes of consumed tiles, see TrackTiles().
+     */
+    struct TrackedTiles
+    {
+      RegionClipboard::TileLoader loader;
+      RegionClipboard::TileConsumer consumer;
+    };
+
+    /**
+     * Callbacks of LiquidFiller::FillRegion() that record changes of consumed liquids, see TrackLiquids().
+     */
+    struct TrackedLiquids
+    {
+      LiquidFiller::LiquidLoader loader;
+      LiquidFiller::LiquidConsumer consumer;
+    };
+
+    /**
+     * @param coalesce_gap Ranges separated by at most this many indices are merged, trading precision
+     * for a more compact feed.
+     */
+    explicit ChangeFeed(std::uint32_t coalesce_gap = 0);
+
+    /**
+     * Registers a subscriber.
+     * @param subscriber Subscriber callback.
+     * @return Subscription handle for Unsubscribe().
+     */
+    std::size_t Subscribe(Subscriber subscriber);
+
+    /**
+     * Removes a subscriber.
+     * @param handle Handle returned by Subscribe().
+     */
+    void Unsubscribe(std::size_t handle);
+
+    /**
+     * Records a changed range. Empty ranges are ignored.
+     * @param tile Tile coordinates on WDT grid.
+     * @param chunk Row-major chunk index, or TILE_LEVEL_CHANGE.
+     * @param field Changed field.
+     * @param begin First changed index.
+     * @param end One past the last changed index.
+     */
+    void Record(Common::DataStructures::TileIndex tile
+                , std::uint16_t chunk
+                , ChangeField field
+                , std::uint32_t begin
+                , std::uint32_t end);
+
+    /**
+     * Coalesces pending changes and delivers them to all subscribers, then clears them.
+     * @return Delivered changes.
+     */
+    std::vector<ChangeRecord> Flush();
+
+    /**
+     * Drops pending changes without delivering them.
+     */
+    void Discard();
+
+    /**
+     * Records changes of terrain (headers, heights, normals, vertex colors, holes).
+     * @param tile Tile coordinates on WDT grid.
+     * @param before Terrain before the edit.
+     * @param after Terrain after the edit.
+     */
+    void DiffTerrain(Common::DataStructures::TileIndex tile, TileTerrain const& before, TileTerrain const& after);
+
+    /**
+     * Records changes of texturing (texture table, layers, alpha maps, shadows).
+     * @param tile Tile coordinates on WDT grid.
+     * @param before Texturing before the edit.
+     * @param after Texturing after the edit.
+     */
+    void DiffTexturing(Common::DataStructures::TileIndex tile, TileTexturing const& before, TileTexturing const& after);
+
+    /**
+     * Records quads whose liquid coverage, type or vertex values changed.
+     * @param tile Tile coordinates on WDT grid.
+     * @param before Liquids before the edit.
+     * @param after Liquids after the edit.
+     */
+    void DiffLiquids(Common::DataStructures::TileIndex tile, MH2O const& before, MH2O const& after);
+
+    /**
+     * Records changes of placements and their file tables. Rows past the first inserted or removed one
+     * are reported as changed.
+     * @param tile Tile coordinates on WDT grid.
+     * @param before Placements before the edit.
+     * @param after Placements after the edit.
+     */
+    void DiffPlacements(Common::DataStructures::TileIndex tile, TilePlacements const& before, TilePlacements const& after);
+
+    /**
+     * Records all changes of a tile edited through RegionClipboard-style loaders and consumers.
+     * @param tile Tile coordinates on WDT grid.
+     * @param before Tile before the edit.
+     * @param after Tile after the edit.
+     */
+    void DiffTile(Common::DataStructures::TileIndex tile, RegionTile const& before, RegionTile const& after);
+
+    /**
+     * Wraps the callbacks of a tool editing whole tiles so that every consumed tile is diffed against its
+     * loaded state with DiffTile(). Each tile is copied when loaded and released when consumed, tiles loaded
+     * but never consumed are released with the returned callbacks. The feed must outlive them.
+     * @param loader Tile loader callback.
+     * @param consumer Callback receiving modified tiles.
+     * @return Callbacks to hand to the tool instead.
+     */
+    [[nodiscard]]
+    TrackedTiles TrackTiles(RegionClipboard::TileLoader loader, RegionClipboard::TileConsumer consumer);
+
+    /**
+     * Wraps the callbacks of a tool editing liquids so that every consumed tile is diffed against its
+     * loaded liquids with DiffLiquids(). Copies are kept as in TrackTiles().
+     * @param loader Liquid loader callback.
+     * @param consumer Callback receiving modified liquids.
+     * @return Callbacks to hand to the tool instead.
+     */
+    [[nodiscard]]
+    TrackedLiquids TrackLiquids(LiquidFiller::LiquidLoader loader, LiquidFiller::LiquidConsumer consumer);
+
+  private:
+    /**
+     * Records a set of changes under a single lock.
+     */
+    void RecordAll(std::span<ChangeRecord const> changes);
+
+    struct IndexRange
+    {
+      std::uint32_t begin;
+      std::uint32_t end;
+    };
+
+    // tile y, tile x, chunk, field: the order records are delivered in
+    using RecordKey = std::tuple<std::uint16_t, std::uint16_t, std::uint16_t, ChangeField>;
+
+    std::uint32_t _coalesce_gap;
+
+    std::mutex _pending_mutex;
+    std::map<RecordKey, std::vector<IndexRange>> _pending;
+
+    std::mutex _subscribers_mutex;
+    std::map<std::size_t, Subscriber> _subscribers;
+    std::size_t _next_handle = 0;
+  };
+}
@@ -0,0 +1,672 @@
+#include <IO/ADT/DoodadScatterer.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <Utils/PathUtils.hpp>
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <numbers>
+#include <span>
+
+using namespace IO::ADT;
+using namespace IO::Common;
+
+namespace
+{
+  using IO::ADT::DataStructures::MDDF;
+  using IO::ADT::DataStructures::MODF;
+  using IO::Common::DataStructures::TileIndex;
+
+  constexpr unsigned N_CHUNKS_TILE_ROW = 16;
+  constexpr unsigned N_QUADS_CHUNK_ROW = 8;
+  constexpr float QUAD_SIZE = WorldConstants::CHUNK_SIZE / N_QUADS_CHUNK_ROW;
+
+  // MCVT and MCNR rows alternate 9 outer and 8 inner vertices
+  constexpr unsigned MCVT_ROW_STRIDE = WorldConstants::N_VERTS_CHUNK_ROW_OUTER + WorldConstants::N_VERTS_CHUNK_ROW_INNER;
+
+  constexpr unsigned OuterVertex(unsigned x, unsigned y) { return y * MCVT_ROW_STRIDE + x; }
+  constexpr unsigned InnerVertex(unsigned x, unsigned y) { return y * MCVT_ROW_STRIDE + WorldConstants::N_VERTS_CHUNK_ROW_OUTER + x; }
+
+  // cells of candidates conflicting with one another are at most this many cells apart along each axis
+  constexpr int CONFLICT_REACH = 2;
+
+  // SplitMix64 finalizer
+  constexpr std::uint64_t Mix(std::uint64_t value)
+  {
+    value += 0x9E3779B97F4A7C15ull;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+  }
+
+  // uniform in [0, 1)
+  constexpr float Unit(std::uint64_t hash)
+  {
+    return static_cast<float>(hash >> 40) * (1.f / 16777216.f);
+  }
+
+  /**
+   * Candidate of one cell of the map-wide Poisson-disk grid of a rule.
+   */
+  struct Candidate
+  {
+    float x;
+    float z;
+    std::uint64_t hash;
+  };
+
+  class CandidateGrid
+  {
+  public:
+    CandidateGrid(std::uint64_t rule_seed, float min_distance)
+    : _rule_seed(rule_seed)
+    , _cell_size(min_distance / std::numbers::sqrt2_v<float>)
+    , _min_distance_sq(min_distance * min_distance)
+    {
+    }
+
+    [[nodiscard]]
+    float CellSize() const { return _cell_size; };
+
+    [[nodiscard]]
+    Candidate At(std::int64_t x, std::int64_t z) const
+    {
+      std::uint64_t const hash = Mix(_rule_seed ^ Mix(static_cast<std::uint64_t>(x) ^ Mix(static_cast<std::uint64_t>(z))));
+
+      return {(static_cast<float>(x) + Unit(Mix(hash ^ 0x1))) * _cell_size
+              , (static_cast<float>(z) + Unit(Mix(hash ^ 0x2))) * _cell_size
+              , hash};
+    }
+
+    /**
+     * @return True if no candidate closer than min_distance has a higher priority. Ties are broken by cell.
+     */
+    [[nodiscard]]
+    bool Survives(std::int64_t x, std::int64_t z, Candidate const& candidate) const
+    {
+      for (int dz = -CONFLICT_REACH; dz <= CONFLICT_REACH; ++dz)
+      {
+        for (int dx = -CONFLICT_REACH; dx <= CONFLICT_REACH; ++dx)
+        {
+          if (!dx && !dz)
+            continue;
+
+          Candidate const other = At(x + dx, z + dz);
+          float const distance_x = other.x - candidate.x;
+          float const distance_z = other.z - candidate.z;
+
+          if (distance_x * distance_x + distance_z * distance_z >= _min_distance_sq)
+            continue;
+
+          if (other.hash > candidate.hash || (other.hash == candidate.hash && (dz > 0 || (dz == 0 && dx > 0))))
+            return false;
+        }
+      }
+
+      return true;
+    }
+
+  private:
+    std::uint64_t _rule_seed;
+    float _cell_size;
+    float _min_distance_sq;
+  };
+
+  /**
+   * Existing placement new ones keep clear of: a model position, or a map object box.
+   */
+  struct Obstacle
+  {
+    float min_x;
+    float min_z;
+    float max_x;
+    float max_z;
+    bool is_box;
+
+    [[nodiscard]]
+    bool Blocks(float x, float z, float clearance) const
+    {
+      if (is_box)
+        return x > min_x - clearance && x < max_x + clearance && z > min_z - clearance && z < max_z + clearance;
+
+      float const distance_x = x - min_x;
+      float const distance_z = z - min_z;
+      return distance_x * distance_x + distance_z * distance_z < clearance * clearance;
+    }
+  };
+
+  Obstacle ModelObstacle(MDDF const& placement)
+  {
+    return {placement.position.x, placement.position.z, placement.position.x, placement.position.z, false};
+  }
+
+  Obstacle MapObjectObstacle(MODF const& placement)
+  {
+    return {placement.extents.min.x, placement.extents.min.z, placement.extents.max.x, placement.extents.max.z, true};
+  }
+
+  /**
+   * Drops placements that can't block candidates outside of their own tile, and the file tables.
+   */
+  void KeepBorderPlacements(TileIndex tile_index, float max_clearance, TilePlacements& placements)
+  {
+    float const min_x = tile_index.x * WorldConstants::TILE_SIZE + max_clearance;
+    float const min_z = tile_index.y * WorldConstants::TILE_SIZE + max_clearance;
+    float const max_x = (tile_index.x + 1) * WorldConstants::TILE_SIZE - max_clearance;
+    float const max_z = (tile_index.y + 1) * WorldConstants::TILE_SIZE - max_clearance;
+
+    auto const inner = [&](Obstacle const& obstacle)
+    {
+      return obstacle.min_x > min_x && obstacle.min_z > min_z && obstacle.max_x < max_x && obstacle.max_z < max_z;
+    };
+
+    std::erase_if(placements.model_placements, [&](MDDF const& placement) { return inner(ModelObstacle(placement)); });
+    std::erase_if(placements.map_object_placements
+                  , [&](MODF const& placement) { return inner(MapObjectObstacle(placement)); });
+
+    placements.models.clear();
+    placements.map_objects.clear();
+  }
+
+  float MaxClearance(ScatterParams const& params)
+  {
+    float max_clearance = 0.f;
+
+    for (ScatterRule const& rule : params.rules)
+      max_clearance = std::max(max_clearance, rule.bounding_radius * rule.max_scale);
+
+    return max_clearance;
+  }
+
+  /**
+   * Existing placements bucketed by the chunks they may block, so that each candidate only tests nearby ones.
+   */
+  class ObstacleGrid
+  {
+  public:
+    /**
+     * Placements of neighbouring tiles are bucketed the same way, those out of reach of the tile end up in no chunk.
+     */
+    ObstacleGrid(TileIndex tile_index
+                 , TilePlacements const& placements
+                 , std::span<TilePlacements const* const> neighbour_placements
+                 , float max_clearance)
+    : _origin_x(tile_index.x * WorldConstants::TILE_SIZE)
+    , _origin_z(tile_index.y * WorldConstants::TILE_SIZE)
+    {
+      AddPlacements(placements, max_clearance);
+
+      for (TilePlacements const* neighbour : neighbour_placements)
+        AddPlacements(*neighbour, max_clearance);
+    }
+
+    [[nodiscard]]
+    bool Blocks(unsigned chunk, float x, float z, float clearance) const
+    {
+      return std::any_of(_chunks[chunk].begin(), _chunks[chunk].end()
+                         , [&](Obstacle const& obstacle) { return obstacle.Blocks(x, z, clearance); });
+    }
+
+  private:
+    void AddPlacements(TilePlacements const& placements, float max_clearance)
+    {
+      for (MDDF const& placement : placements.model_placements)
+        Add(ModelObstacle(placement), max_clearance);
+
+      for (MODF const& placement : placements.map_object_placements)
+        Add(MapObjectObstacle(placement), max_clearance);
+    }
+
+    void Add(Obstacle const& obstacle, float max_clearance)
+    {
+      auto const chunk_range = [](float min, float max, float origin)
+      {
+        auto const chunk = [origin](float coordinate)
+        {
+          float const index = std::floor((coordinate - origin) / WorldConstants::CHUNK_SIZE);
+          return static_cast<int>(std::clamp(index, -1.f, static_cast<float>(N_CHUNKS_TILE_ROW)));
+        };
+
+        return std::pair{std::max(chunk(min), 0), std::min(chunk(max), static_cast<int>(N_CHUNKS_TILE_ROW) - 1)};
+      };
+
+      auto const [x_begin, x_end] = chunk_range(obstacle.min_x - max_clearance, obstacle.max_x + max_clearance, _origin_x);
+      auto const [z_begin, z_end] = chunk_range(obstacle.min_z - max_clearance, obstacle.max_z + max_clearance, _origin_z);
+
+      for (int z = z_begin; z <= z_end; ++z)
+      {
+        for (int x = x_begin; x <= x_end; ++x)
+          _chunks[z * N_CHUNKS_TILE_ROW + x].push_back(obstacle);
+      }
+    }
+
+    float _origin_x;
+    float _origin_z;
+    std::array<std::vector<Obstacle>, WorldConstants::CHUNKS_PER_TILE> _chunks;
+  };
+
+  bool IsSameAsset(AssetReference const& lhs, AssetReference const& rhs)
+  {
+    if (lhs.file_data_id && lhs.file_data_id == rhs.file_data_id)
+      return true;
+
+    return !lhs.path.empty() && !rhs.path.empty()
+      && Utils::PathUtils::NormalizeFilepathGame(lhs.path) == Utils::PathUtils::NormalizeFilepathGame(rhs.path);
+  }
+
+  std::uint32_t FindOrAppend(std::vector<AssetReference>& table, AssetReference const& asset)
+  {
+    auto it = std::find(table.begin(), table.end(), asset);
+
+    if (it == table.end())
+      it = table.insert(table.end(), asset);
+
+    return static_cast<std::uint32_t>(it - table.begin());
+  }
+
+  /**
+   * Terrain height and the up component of its unit normal at a point of a chunk.
+   */
+  struct SurfaceSample
+  {
+    float height;
+    float up;
+  };
+
+  /**
+   * Interpolates within the one of four triangles of a quad, which meet at its inner vertex, containing the point.
+   * @param local_x Coordinate relative to the chunk origin, [0, CHUNK_SIZE).
+   * @param local_z Coordinate relative to the chunk origin, [0, CHUNK_SIZE).
+   */
+  SurfaceSample SampleSurface(ChunkTerrain const& terrain, float local_x, float local_z)
+  {
+    unsigned const quad_x = std::min(static_cast<unsigned>(local_x / QUAD_SIZE), N_QUADS_CHUNK_ROW - 1);
+    unsigned const quad_z = std::min(static_cast<unsigned>(local_z / QUAD_SIZE), N_QUADS_CHUNK_ROW - 1);
+    float const fx = local_x / QUAD_SIZE - static_cast<float>(quad_x);
+    float const fz = local_z / QUAD_SIZE - static_cast<float>(quad_z);
+
+    struct Corner
+    {
+      float x;
+      float z;
+      unsigned vertex;
+    };
+
+    Corner const c00 {0.f, 0.f, OuterVertex(quad_x, quad_z)};
+    Corner const c10 {1.f, 0.f, OuterVertex(quad_x + 1, quad_z)};
+    Corner const c01 {0.f, 1.f, OuterVertex(quad_x, quad_z + 1)};
+    Corner const c11 {1.f, 1.f, OuterVertex(quad_x + 1, quad_z + 1)};
+    Corner const center {0.5f, 0.5f, InnerVertex(quad_x, quad_z)};
+
+    float const dx = fx - 0.5f;
+    float const dz = fz - 0.5f;
+
+    auto const [a, b] = dz <= -std::abs(dx) ? std::pair{c00, c10}
+      : dz >= std::abs(dx) ? std::pair{c01, c11}
+      : dx < 0.f ? std::pair{c00, c01}
+      : std::pair{c10, c11};
+
+    float const det = (b.z - center.z) * (a.x - center.x) + (center.x - b.x) * (a.z - center.z);
+    float const weight_a = ((b.z - center.z) * (fx - center.x) + (center.x - b.x) * (fz - center.z)) / det;
+    float const weight_b = ((center.z - a.z) * (fx - center.x) + (a.x - center.x) * (fz - center.z)) / det;
+    float const weight_center = 1.f - weight_a - weight_b;
+
+    float const height = terrain.header.position.z + weight_a * terrain.heightmap[a.vertex]
+      + weight_b * terrain.heightmap[b.vertex] + weight_center * terrain.heightmap[center.vertex];
+
+    // MCNR stores (x, z, y) with z up, see TerrainMesh
+    std::array<float, 3> normal {};
+
+    for (auto const& [weight, vertex] : {std::pair{weight_a, a.vertex}, {weight_b, b.vertex}
+                                         , {weight_center, center.vertex}})
+    {
+      for (unsigned i = 0; i < 3; ++i)
+        normal[i] += weight * static_cast<float>(terrain.normals[vertex].normal[i]);
+    }
+
+    float const length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+    return {height, length > 0.f ? normal[2] / length : 1.f};
+  }
+
+  /**
+   * Weight of layers of a chunk matching a texture, [0, 1].
+   */
+  float TextureWeight(ChunkTexturing const& texturing, std::vector<bool> const& matches, unsigned pixel)
+  {
+    unsigned weight = 0;
+    unsigned other_weight = 0;
+
+    for (std::size_t layer = 1; layer < texturing.layers.size(); ++layer)
+    {
+      unsigned const alpha = texturing.alphamaps[layer - 1][pixel];
+      other_weight += alpha;
+      weight += matches[texturing.layers[layer].textureId] ? alpha : 0;
+    }
+
+    // base layer weight is what remains of the others
+    if (!texturing.layers.empty() && matches[texturing.layers[0].textureId])
+      weight += 255 - std::min(other_weight, 255u);
+
+    return static_cast<float>(std::min(weight, 255u)) / 255.f;
+  }
+}
+
+void DoodadScatterer::ScatterTile(TileIndex tile_index
+                                  , ScatterParams const& params
+                                  , DoodadTile& tile
+                                  , ScatterStats& stats
+                                  , std::span<TilePlacements const* const> neighbour_placements)
+{
+  RequireF(CCodeZones::FILE_IO, tile_index.x < 64 && tile_index.y < 64, "Tile index is out of map bounds.");
+  RequireF(CCodeZones::FILE_IO, params.first_unique_id != ScatterParams::NO_UNIQUE_ID
+           , "First unique ID of scattered placements is not set.");
+
+  float const origin_x = tile_index.x * WorldConstants::TILE_SIZE;
+  float const origin_z = tile_index.y * WorldConstants::TILE_SIZE;
+
+  ObstacleGrid const obstacles {tile_index, tile.placements, neighbour_placements, MaxClearance(params)};
+
+  std::array<std::uint64_t, WorldConstants::CHUNKS_PER_TILE> blocked_quads {};
+
+  for (unsigned i = 0; i < WorldConstants::CHUNKS_PER_TILE; ++i)
+  {
+    blocked_quads[i] = ChunkHoleMask(tile.terrain[i].header);
+
+    for (LiquidLayer const& layer : tile.liquids.chunks()[i].Layers())
+      blocked_quads[i] |= layer.exists_map.to_ullong();
+
+    ChunkTexturing const& texturing = tile.texturing.chunks[i];
+
+    EnsureF(CCodeZones::FILE_IO, texturing.alphamaps.size() + 1 >= texturing.layers.size()
+                                 && std::all_of(texturing.layers.begin(), texturing.layers.end()
+                                                , [&](DataStructures::SMLayer const& layer)
+                                                  { return layer.textureId < tile.texturing.textures.size(); })
+            , "Malformed chunk texturing.");
+  }
+
+  // the range of the last tile may end right past the largest 32-bit ID
+  std::uint64_t const first_unique_id = std::uint64_t{params.first_unique_id}
+    + std::uint64_t{tile_index.y * 64u + tile_index.x} * params.max_placements_per_tile;
+  std::uint64_t const end_unique_id = first_unique_id + params.max_placements_per_tile;
+
+  // IDs of the range already taken, e.g. by an earlier run over the same tile, are skipped
+  std::vector<std::uint32_t> used_unique_ids;
+
+  auto const collect_used = [&](std::uint32_t unique_id)
+  {
+    if (unique_id >= first_unique_id && unique_id < end_unique_id)
+      used_unique_ids.push_back(unique_id);
+  };
+
+  for (MDDF const& placement : tile.placements.model_placements)
+    collect_used(placement.unique_id);
+
+  for (MODF const& placement : tile.placements.map_object_placements)
+    collect_used(placement.unique_id);
+
+  std::sort(used_unique_ids.begin(), used_unique_ids.end());
+  std::uint64_t next_unique_id = first_unique_id;
+
+  std::size_t const first_placement = tile.placements.model_placements.size();
+  std::vector<float> radii;
+
+  for (std::size_t rule_index = 0; rule_index < params.rules.size(); ++rule_index)
+  {
+    ScatterRule const& rule = params.rules[rule_index];
+
+    std::vector<bool> matches(tile.texturing.textures.size());
+
+    for (std::size_t i = 0; i < matches.size(); ++i)
+      matches[i] = IsSameAsset(tile.texturing.textures[i], rule.texture);
+
+    if (std::none_of(matches.begin(), matches.end(), [](bool match) { return match; }))
+      continue;
+
+    CandidateGrid const grid {Mix(params.seed ^ Mix(rule_index)), rule.min_distance};
+    float const min_up = std::cos(rule.max_slope * std::numbers::pi_v<float> / 180.f);
+
+    for (unsigned chunk = 0; chunk < WorldConstants::CHUNKS_PER_TILE; ++chunk)
+    {
+      float const chunk_x = origin_x + static_cast<float>(chunk % N_CHUNKS_TILE_ROW) * WorldConstants::CHUNK_SIZE;
+      float const chunk_z = origin_z + static_cast<float>(chunk / N_CHUNKS_TILE_ROW) * WorldConstants::CHUNK_SIZE;
+      float const chunk_x_end = chunk_x + WorldConstants::CHUNK_SIZE;
+      float const chunk_z_end = chunk_z + WorldConstants::CHUNK_SIZE;
+
+      auto const cell_x_begin = static_cast<std::int64_t>(std::floor(chunk_x / grid.CellSize()));
+      auto const cell_z_begin = static_cast<std::int64_t>(std::floor(chunk_z / grid.CellSize()));
+      auto const cell_x_end = static_cast<std::int64_t>(std::floor(chunk_x_end / grid.CellSize()));
+      auto const cell_z_end = static_cast<std::int64_t>(std::floor(chunk_z_end / grid.CellSize()));
+
+      ChunkTerrain const& terrain = tile.terrain[chunk];
+      ChunkTexturing const& texturing = tile.texturing.chunks[chunk];
+
+      for (std::int64_t cell_z = cell_z_begin; cell_z <= cell_z_end; ++cell_z)
+      {
+        for (std::int64_t cell_x = cell_x_begin; cell_x <= cell_x_end; ++cell_x)
+        {
+          Candidate const candidate = grid.At(cell_x, cell_z);
+
+          // every candidate belongs to exactly one chunk of the map
+          if (candidate.x < chunk_x || candidate.x >= chunk_x_end || candidate.z < chunk_z || candidate.z >= chunk_z_end)
+            continue;
+
+          float const local_x = candidate.x - chunk_x;
+          float const local_z = candidate.z - chunk_z;
+
+          unsigned const quad_x = std::min(static_cast<unsigned>(local_x / QUAD_SIZE), N_QUADS_CHUNK_ROW - 1);
+          unsigned const quad_z = std::min(static_cast<unsigned>(local_z / QUAD_SIZE), N_QUADS_CHUNK_ROW - 1);
+
+          if ((blocked_quads[chunk] >> (quad_z * N_QUADS_CHUNK_ROW + quad_x)) & 1)
+            continue;
+
+          unsigned const pixel_x = std::min(static_cast<unsigned>(local_x / WorldConstants::ALPHAMAP_PIXEL_SIZE)
+                                            , WorldConstants::ALPHAMAP_DIM - 1);
+          unsigned const pixel_z = std::min(static_cast<unsigned>(local_z / WorldConstants::ALPHAMAP_PIXEL_SIZE)
+                                            , WorldConstants::ALPHAMAP_DIM - 1);
+
+          float const weight = TextureWeight(texturing, matches, pixel_z * WorldConstants::ALPHAMAP_DIM + pixel_x);
+
+          if (weight <= 0.f || weight < rule.min_weight || Unit(Mix(candidate.hash ^ 0x3)) >= weight * rule.density)
+            continue;
+
+          SurfaceSample const surface = SampleSurface(terrain, local_x, local_z);
+
+          if (surface.up < min_up || surface.height < rule.min_height || surface.height > rule.max_height)
+            continue;
+
+          float const scale = rule.min_scale + Unit(Mix(candidate.hash ^ 0x4)) * (rule.max_scale - rule.min_scale);
+
+          if (obstacles.Blocks(chunk, candidate.x, candidate.z, rule.bounding_radius * scale))
+            continue;
+
+          // the neighbourhood test is the most expensive one, so it goes last
+          if (!grid.Survives(cell_x, cell_z, candidate))
+            continue;
+
+          while (next_unique_id < end_unique_id
+                 && std::binary_search(used_unique_ids.begin(), used_unique_ids.end(), next_unique_id))
+          {
+            ++next_unique_id;
+          }
+
+          if (next_unique_id == end_unique_id)
+          {
+            ++stats.n_dropped;
+            continue;
+          }
+
+          MDDF placement {};
+          placement.unique_id = static_cast<std::uint32_t>(next_unique_id++);
+          placement.position = {candidate.x, surface.height, candidate.z};
+          placement.rotation = {0.f, Unit(Mix(candidate.hash ^ 0x5)) * 360.f, 0.f};
+          placement.scale = static_cast<std::uint16_t>(std::clamp(std::lround(scale * 1024.f), 1l, 65535l));
+
+          // files known by path go to the tile's table, the others are referenced by FileDataID directly
+          placement.flags.use_filedata_id = rule.model.path.empty();
+          placement.name_id = rule.model.path.empty() ? rule.model.file_data_id
+            : FindOrAppend(tile.placements.models, rule.model);
+
+          tile.placements.model_placements.push_back(placement);
+          radii.push_back(rule.bounding_radius);
+        }
+      }
+    }
+  }
+
+  std::size_t const n_added = tile.placements.model_placements.size() - first_placement;
+
+  if (!n_added)
+    return;
+
+  // new placements follow existing ones in MDDF, so appending their indices keeps MCRD sorted
+  TilePlacementExtents extents;
+  extents.models.reserve(n_added);
+
+  for (std::size_t i = 0; i < n_added; ++i)
+  {
+    extents.models.push_back(ChunkReferenceBuilder::ModelPlacementExtents(
+      tile.placements.model_placements[first_placement + i], radii[i]));
+  }
+
+  ChunkReferences added;
+  ChunkReferenceBuilder::Build(tile_index, extents, added);
+
+  for (unsigned chunk = 0; chunk < WorldConstants::CHUNKS_PER_TILE; ++chunk)
+  {
+    for (std::uint32_t index : added.model_references[chunk])
+      tile.references.model_references[chunk].push_back(static_cast<std::uint32_t>(first_placement + index));
+  }
+
+  ++stats.n_tiles;
+  stats.n_placements += n_added;
+}
+
+ScatterStats DoodadScatterer::Scatter(std::bitset<WorldConstants::MAX_TILES_PER_MAP> const& tiles
+                                      , ScatterParams const& params
+                                      , TileLoader const& loader
+                                      , TileConsumer const& consumer
+                                      , PlacementLoader const& placement_loader
+                                      , unsigned n_threads)
+{
+  RequireF(CCodeZones::FILE_IO, params.first_unique_id != ScatterParams::NO_UNIQUE_ID
+           , "First unique ID of scattered placements is not set.");
+  RequireF(CCodeZones::FILE_IO, params.max_placements_per_tile
+                                && std::uint64_t{params.first_unique_id}
+                                   + std::uint64_t{params.max_placements_per_tile} * WorldConstants::MAX_TILES_PER_MAP
+                                   <= std::uint64_t{0xFFFFFFFF} + 1
+           , "Unique IDs of scattered placements do not fit into 32 bits.");
+
+  RequireF(CCodeZones::FILE_IO, std::all_of(params.rules.begin(), params.rules.end(), [](ScatterRule const& rule)
+                                {
+                                  return rule.min_distance > 0.f && rule.min_scale > 0.f
+                                    && rule.min_scale <= rule.max_scale;
+                                })
+           , "Invalid scatter rule.");
+
+  std::vector<TileIndex> tile_list;
+
+  for (std::size_t i = 0; i < tiles.size(); ++i)
+  {
+    if (tiles[i])
+      tile_list.push_back({static_cast<std::uint16_t>(i % 64), static_cast<std::uint16_t>(i / 64)});
+  }
+
+  LogDebugF(LCodeZones::FILE_IO, "Scattering %d rules over %d tiles.", params.rules.size(), tile_list.size());
+
+  // placements of neighbouring tiles, trimmed to those that can block candidates across a border
+  std::vector<TilePlacements> border_placements;
+  std::bitset<WorldConstants::MAX_TILES_PER_MAP> has_border_placements;
+
+  if (placement_loader)
+  {
+    std::bitset<WorldConstants::MAX_TILES_PER_MAP> neighbourhood;
+
+    for (TileIndex tile : tile_list)
+    {
+      for (unsigned y = tile.y ? tile.y - 1u : 0u; y <= std::min(tile.y + 1u, 63u); ++y)
+      {
+        for (unsigned x = tile.x ? tile.x - 1u : 0u; x <= std::min(tile.x + 1u, 63u); ++x)
+        {
+          if (x != tile.x || y != tile.y)
+            neighbourhood.set(y * 64 + x);
+        }
+      }
+    }
+
+    float const max_clearance = MaxClearance(params);
+    border_placements.resize(WorldConstants::MAX_TILES_PER_MAP);
+
+    std::vector<std::size_t> neighbourhood_list;
+
+    for (std::size_t i = 0; i < neighbourhood.size(); ++i)
+    {
+      if (neighbourhood[i])
+        neighbourhood_list.push_back(i);
+    }
+
+    std::vector<std::uint8_t> loaded(neighbourhood_list.size());
+
+    Utils::Misc::ParallelFor(neighbourhood_list.size(), [&](std::size_t i)
+    {
+      std::size_t const index = neighbourhood_list[i];
+      TileIndex const tile {static_cast<std::uint16_t>(index % 64), static_cast<std::uint16_t>(index / 64)};
+
+      if (!placement_loader(tile, border_placements[index]))
+        return;
+
+      KeepBorderPlacements(tile, max_clearance, border_placements[index]);
+      loaded[i] = 1;
+    }, n_threads);
+
+    for (std::size_t i = 0; i < neighbourhood_list.size(); ++i)
+      has_border_placements[neighbourhood_list[i]] = loaded[i];
+  }
+
+  std::vector<ScatterStats> tile_stats(tile_list.size());
+
+  Utils::Misc::ParallelFor(tile_list.size(), [&](std::size_t i)
+  {
+    // tile data is too large to be kept on the stack of a worker thread
+    auto tile = std::make_unique<DoodadTile>();
+
+    if (!loader(tile_list[i], *tile))
+      return;
+
+    std::vector<TilePlacements const*> neighbours;
+
+    for (int dy = -1; dy <= 1; ++dy)
+    {
+      for (int dx = -1; dx <= 1; ++dx)
+      {
+        int const x = tile_list[i].x + dx;
+        int const y = tile_list[i].y + dy;
+
+        if ((dx || dy) && x >= 0 && y >= 0 && x < 64 && y < 64 && has_border_placements[y * 64 + x])
+          neighbours.push_back(&border_placements[y * 64 + x]);
+      }
+    }
+
+    ScatterTile(tile_list[i], params, *tile, tile_stats[i], neighbours);
+
+    if (tile_stats[i].n_placements)
+      consumer(tile_list[i], *tile);
+  }, n_threads);
+
+  ScatterStats stats;
+
+  for (ScatterStats const& tile_stat : tile_stats)
+  {
+    stats.n_tiles += tile_stat.n_tiles;
+    stats.n_placements += tile_stat.n_placements;
+    stats.n_dropped += tile_stat.n_dropped;
+  }
+
+  LogDebugF(LCodeZones::FILE_IO, "Scattered %d placements over %d tiles.", stats.n_placements, stats.n_tiles);
+
+  return stats;
+}
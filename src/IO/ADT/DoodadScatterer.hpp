@@ -0,0 +1,143 @@
+#pragma once
+#include <IO/CommonDataStructures.hpp>
+#include <IO/WorldConstants.hpp>
+#include <IO/ADT/DataStructures.hpp>
+#include <IO/ADT/TileData.hpp>
+#include <IO/ADT/Obj/ChunkReferenceBuilder.hpp>
+#include <IO/ADT/Root/MH2O.hpp>
+#include <IO/ADT/Root/TileTerrain.hpp>
+
+#include <bitset>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace IO::ADT
+{
+  /**
+   * Places one model where one texture is painted.
+   */
+  struct ScatterRule
+  {
+    AssetReference texture; ///> Texture driving density, matched by normalized path or FileDataID.
+    AssetReference model; ///> Model to place. Referenced through the tile's model table if its path is known.
+    float min_distance = 4.f; ///> Minimum distance between placements of this rule, in yards.
+    float density = 1.f; ///> Share of candidates kept at full texture weight, [0, 1].
+    float min_weight = 0.f; ///> Texture weight below which nothing is placed, [0, 1].
+    float max_slope = 30.f; ///> Steepest terrain placed on, in degrees.
+    float min_height = -std::numeric_limits<float>::max(); ///> Lowest terrain height placed on.
+    float max_height = std::numeric_limits<float>::max(); ///> Highest terrain height placed on.
+    float min_scale = 1.f;
+    float max_scale = 1.f;
+    float bounding_radius = 1.f; ///> Radius of the model at scale 1.0. Used for MCRD and clearance to existing placements.
+  };
+
+  struct ScatterParams
+  {
+    std::vector<ScatterRule> rules;
+    std::uint64_t seed = 0; ///> Same seed, rules and terrain always produce the same placements.
+
+    /**
+     * Required. Unique IDs of tile (x, y) are taken from [first_unique_id + (y * 64 + x) * max_placements_per_tile,
+     * + max_placements_per_tile). Must lie above every unique ID used by the map, as only IDs of the range taken
+     * by the tile itself are skipped.
+     */
+    std::uint32_t first_unique_id = NO_UNIQUE_ID;
+    std::uint32_t max_placements_per_tile = 16384; ///> Placements beyond are dropped.
+
+    static constexpr std::uint32_t NO_UNIQUE_ID = std::numeric_limits<std::uint32_t>::max();
+  };
+
+  struct ScatterStats
+  {
+    std::size_t n_tiles = 0; ///> Tiles that received placements.
+    std::size_t n_placements = 0; ///> Placements added.
+    std::size_t n_dropped = 0; ///> Placements dropped for exceeding ScatterParams::max_placements_per_tile.
+  };
+
+  /**
+   * Everything DoodadScatterer reads from and writes to one map tile.
+   */
+  struct DoodadTile
+  {
+    TileTerrain terrain; ///> Heights and normals, holes of chunk headers.
+    TileTexturing texturing; ///> Layers and alpha maps driving density.
+    MH2O liquids; ///> Quads covered by liquid are skipped.
+    TilePlacements placements; ///> Existing placements are kept clear of, new MDDF entries are appended.
+    ChunkReferences references; ///> New placements are appended to MCRD.
+  };
+
+  /**
+   * Scatters models procedurally over terrain, by density rules tied to texture layers.
+   *
+   * Candidates come from a Poisson-disk sampling of the whole map: each cell of a map-wide grid of cell size
+   * min_distance / sqrt(2) holds one candidate, positioned and prioritized by a hash of the seed, the rule and
+   * the cell. A candidate survives if no other candidate within min_distance has a higher priority. Survivors
+   * are then thinned by texture weight (MCLY, MCAL), slope (MCNR), height (MCVT), holes, liquids (MH2O) and
+   * clearance to existing placements. As every decision depends on global cell coordinates only, tiles are
+   * processed independently and in parallel, and results agree across chunk and tile borders.
+   *
+   * Rules are sampled independently of each other. Existing placements of neighbouring tiles are only kept clear
+   * of if they are provided, see PlacementLoader. Placements whose bounds cross into a neighbouring tile are
+   * only referenced by their own tile, see ChunkReferenceBuilder::FindBorderCrossings().
+   */
+  class DoodadScatterer
+  {
+  public:
+    /**
+     * Loads a tile. Invoked concurrently from worker threads, must be thread-safe.
+     * Must match signature: bool(Common::DataStructures::TileIndex tile_index, DoodadTile& tile).
+     * Returns false if tile does not exist.
+     */
+    using TileLoader = std::function<bool(Common::DataStructures::TileIndex, DoodadTile&)>;
+
+    /**
+     * Receives a tile that placements were added to. Invoked concurrently from worker threads for distinct tiles.
+     * Must match signature: void(Common::DataStructures::TileIndex tile_index, DoodadTile const& tile).
+     */
+    using TileConsumer = std::function<void(Common::DataStructures::TileIndex, DoodadTile const&)>;
+
+    /**
+     * Loads existing placements of a tile, scattered or neighbouring one, so that candidates keep clear of
+     * placements across tile borders. Only MDDF and MODF entries are used. Invoked concurrently from worker
+     * threads, must be thread-safe.
+     * Must match signature: bool(Common::DataStructures::TileIndex tile_index, TilePlacements& placements).
+     * Returns false if tile does not exist.
+     */
+    using PlacementLoader = std::function<bool(Common::DataStructures::TileIndex, TilePlacements&)>;
+
+    /**
+     * Scatters models over a set of tiles in parallel.
+     * @param tiles Tiles to scatter over, bit (y * 64 + x).
+     * @param params Rules and seed.
+     * @param loader Tile loader callback.
+     * @param consumer Modified tile consumer callback.
+     * @param placement_loader Placement loader callback. If empty, placements of neighbouring tiles are ignored
+     *                         and candidates next to a tile border may be placed into them.
+     * @param n_threads Number of worker threads. 0 means hardware concurrency.
+     * @return Scatter stats.
+     */
+    static ScatterStats Scatter(std::bitset<Common::WorldConstants::MAX_TILES_PER_MAP> const& tiles
+                                , ScatterParams const& params
+                                , TileLoader const& loader
+                                , TileConsumer const& consumer
+                                , PlacementLoader const& placement_loader
+                                , unsigned n_threads = 0);
+
+    /**
+     * Scatters models over one tile. Appends MDDF entries, model table entries and MCRD references.
+     * @param tile_index Tile coordinates on WDT grid.
+     * @param params Rules and seed.
+     * @param tile Tile to scatter over.
+     * @param stats Stats to add to.
+     * @param neighbour_placements Existing placements of neighbouring tiles to keep clear of.
+     */
+    static void ScatterTile(Common::DataStructures::TileIndex tile_index
+                            , ScatterParams const& params
+                            , DoodadTile& tile
+                            , ScatterStats& stats
+                            , std::span<TilePlacements const* const> neighbour_placements = {});
+  };
+}
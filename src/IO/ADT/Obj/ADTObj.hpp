@@ -8,6 +8,7 @@
 #include <IO/ADT/Obj/ADTObjMCNK.hpp>
 #include <IO/WorldConstants.hpp>
 #include <Utils/Meta/Templates.hpp>
+#include <Utils/Misc/ForceInline.hpp>
 
 #include <cstdint>
 #include <array>
@@ -178,6 +179,14 @@ namespace IO::ADT
   public:
     AdtObj0SpecificData();
 
+    // getters
+    [[nodiscard]] FORCEINLINE auto& ModelPlacements() { return _model_placements; };
+    [[nodiscard]] FORCEINLINE auto const& ModelPlacements() const { return _model_placements; };
+    [[nodiscard]] FORCEINLINE auto& MapObjectPlacements() { return _map_object_placements; };
+    [[nodiscard]] FORCEINLINE auto const& MapObjectPlacements() const { return _map_object_placements; };
+    [[nodiscard]] FORCEINLINE auto& Chunks() { return _chunks; };
+    [[nodiscard]] FORCEINLINE auto const& Chunks() const { return _chunks; };
+
   protected:
     Common::DataArrayChunk<DataStructures::MDDF, ChunkIdentifiers::ADTObj0Chunks::MDDF> _model_placements;
     Common::DataArrayChunk<DataStructures::MODF, ChunkIdentifiers::ADTObj0Chunks::MODF> _map_object_placements;
@@ -223,6 +232,18 @@ namespace IO::ADT
   public:
     AdtObj1SpecificData();
 
+    // getters
+    [[nodiscard]] FORCEINLINE auto& LodModelPlacements() { return _lod_model_placements; };
+    [[nodiscard]] FORCEINLINE auto const& LodModelPlacements() const { return _lod_model_placements; };
+    [[nodiscard]] FORCEINLINE auto& LodModelExtents() { return _lod_model_extents; };
+    [[nodiscard]] FORCEINLINE auto const& LodModelExtents() const { return _lod_model_extents; };
+    [[nodiscard]] FORCEINLINE auto& LodMapping() { return _lod_mapping; };
+    [[nodiscard]] FORCEINLINE auto const& LodMapping() const { return _lod_mapping; };
+    [[nodiscard]] FORCEINLINE auto& LodMapObjectPlacements() { return _lod_map_object_placements; };
+    [[nodiscard]] FORCEINLINE auto const& LodMapObjectPlacements() const { return _lod_map_object_placements; };
+    [[nodiscard]] FORCEINLINE auto& LodMapObjectExtents() { return _lod_map_object_extents; };
+    [[nodiscard]] FORCEINLINE auto const& LodMapObjectExtents() const { return _lod_map_object_extents; };
+
     template<Common::ClientVersion client_v>
     void GenerateLod(ADTObj<client_v, ADTObjLodLevel::NORMAL> const& tile_obj);
 
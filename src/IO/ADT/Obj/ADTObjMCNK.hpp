@@ -2,6 +2,7 @@
 #include <IO/Common.hpp>
 #include <IO/CommonTraits.hpp>
 #include <IO/ADT/ChunkIdentifiers.hpp>
+#include <Utils/Misc/ForceInline.hpp>
 
 #include <cstdint>
 
@@ -15,6 +16,13 @@ namespace IO::ADT
                            , Common::Traits::TraitType::Chunk
                          >
   {
+  public:
+    // getters
+    [[nodiscard]] FORCEINLINE auto& ModelReferences() { return _model_references; };
+    [[nodiscard]] FORCEINLINE auto const& ModelReferences() const { return _model_references; };
+    [[nodiscard]] FORCEINLINE auto& MapObjectReferences() { return _map_object_references; };
+    [[nodiscard]] FORCEINLINE auto const& MapObjectReferences() const { return _map_object_references; };
+
   private:
     Common::DataArrayChunk<std::uint32_t, ChunkIdentifiers::ADTObj0MCNKSubchunks::MCRD> _model_references;
     Common::DataArrayChunk<std::uint32_t, ChunkIdentifiers::ADTObj0MCNKSubchunks::MCRW> _map_object_references;
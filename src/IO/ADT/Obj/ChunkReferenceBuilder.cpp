@@ -0,0 +1,179 @@
+#include <IO/ADT/Obj/ChunkReferenceBuilder.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+using namespace IO::ADT;
+using namespace IO::Common;
+
+namespace
+{
+  /**
+   * Inclusive range of grid cells covered by a bounding box.
+   */
+  struct CellRange
+  {
+    unsigned x_min;
+    unsigned x_max;
+    unsigned y_min;
+    unsigned y_max;
+  };
+
+  /**
+   * Computes the range of grid cells overlapped by the horizontal projection of a box.
+   * Boxes touching a cell border are considered to overlap both cells.
+   * @param box Bounding box in placement coordinates.
+   * @param origin_x Coordinate of the grid origin along x.
+   * @param origin_z Coordinate of the grid origin along z.
+   * @param cell_size Size of a grid cell.
+   * @param n_cells Number of cells per grid row.
+   * @param range Range to write the result to.
+   * @return False if the box does not overlap the grid or is invalid.
+   */
+  bool BoxCellRange(IO::Common::DataStructures::CAaBox const& box
+                    , float origin_x
+                    , float origin_z
+                    , float cell_size
+                    , unsigned n_cells
+                    , CellRange& range)
+  {
+    // negated comparison also rejects NaN
+    if (!(box.min.x <= box.max.x && box.min.z <= box.max.z))
+      return false;
+
+    float const x_min = std::floor((box.min.x - origin_x) / cell_size);
+    float const x_max = std::floor((box.max.x - origin_x) / cell_size);
+    float const y_min = std::floor((box.min.z - origin_z) / cell_size);
+    float const y_max = std::floor((box.max.z - origin_z) / cell_size);
+
+    float const last_cell = static_cast<float>(n_cells - 1);
+
+    // a box ending exactly on the far border of the grid still touches the last cell
+    if (x_max < 0.f || y_max < 0.f || x_min > static_cast<float>(n_cells) || y_min > static_cast<float>(n_cells))
+      return false;
+
+    range.x_min = static_cast<unsigned>(std::clamp(x_min, 0.f, last_cell));
+    range.x_max = static_cast<unsigned>(std::clamp(x_max, 0.f, last_cell));
+    range.y_min = static_cast<unsigned>(std::clamp(y_min, 0.f, last_cell));
+    range.y_max = static_cast<unsigned>(std::clamp(y_max, 0.f, last_cell));
+
+    return true;
+  }
+
+  /**
+   * Rasterizes placement boxes onto the chunk grid of a tile. Placements are visited in index order,
+   * so every produced list is sorted.
+   */
+  void BinPlacements(std::vector<IO::Common::DataStructures::CAaBox> const& extents
+                     , float origin_x
+                     , float origin_z
+                     , std::array<std::vector<std::uint32_t>, WorldConstants::CHUNKS_PER_TILE>& references)
+  {
+    for (auto& chunk_references : references)
+      chunk_references.clear();
+
+    for (std::uint32_t i = 0; i < extents.size(); ++i)
+    {
+      CellRange range {};
+
+      if (!BoxCellRange(extents[i], origin_x, origin_z, WorldConstants::CHUNK_SIZE, 16, range))
+        continue;
+
+      for (unsigned y = range.y_min; y <= range.y_max; ++y)
+      {
+        for (unsigned x = range.x_min; x <= range.x_max; ++x)
+          references[y * 16 + x].push_back(i);
+      }
+    }
+  }
+
+  void FindPlacementBorderCrossings(IO::Common::DataStructures::TileIndex tile_index
+                                    , std::vector<IO::Common::DataStructures::CAaBox> const& extents
+                                    , bool is_map_object
+                                    , std::vector<BorderCrossing>& crossings)
+  {
+    for (std::uint32_t i = 0; i < extents.size(); ++i)
+    {
+      CellRange range {};
+
+      if (!BoxCellRange(extents[i], 0.f, 0.f, WorldConstants::TILE_SIZE, 64, range))
+        continue;
+
+      for (unsigned y = range.y_min; y <= range.y_max; ++y)
+      {
+        for (unsigned x = range.x_min; x <= range.x_max; ++x)
+        {
+          if (x == tile_index.x && y == tile_index.y)
+            continue;
+
+          crossings.push_back({{static_cast<std::uint16_t>(x), static_cast<std::uint16_t>(y)}, i, is_map_object});
+        }
+      }
+    }
+  }
+}
+
+void ChunkReferenceBuilder::Build(Common::DataStructures::TileIndex tile_index
+                                  , TilePlacementExtents const& extents
+                                  , ChunkReferences& references)
+{
+  RequireF(CCodeZones::FILE_IO, tile_index.x < 64 && tile_index.y < 64, "Tile index out of bounds.");
+
+  float const origin_x = static_cast<float>(tile_index.x) * WorldConstants::TILE_SIZE;
+  float const origin_z = static_cast<float>(tile_index.y) * WorldConstants::TILE_SIZE;
+
+  BinPlacements(extents.models, origin_x, origin_z, references.model_references);
+  BinPlacements(extents.map_objects, origin_x, origin_z, references.map_object_references);
+}
+
+std::size_t ChunkReferenceBuilder::BuildTiles(std::vector<Common::DataStructures::TileIndex> const& tiles
+                                              , PlacementLoader const& loader
+                                              , ReferenceConsumer const& consumer
+                                              , unsigned n_threads)
+{
+  LogDebugF(LCodeZones::FILE_IO, "Rebuilding chunk references of %d tiles.", tiles.size());
+
+  std::atomic<std::size_t> n_built = 0;
+
+  Utils::Misc::ParallelFor(tiles.size(), [&](std::size_t i)
+  {
+    TilePlacementExtents extents;
+
+    if (!loader(tiles[i], extents))
+      return;
+
+    ChunkReferences references;
+    Build(tiles[i], extents, references);
+    consumer(tiles[i], references);
+
+    ++n_built;
+  }, n_threads);
+
+  return n_built;
+}
+
+std::vector<BorderCrossing> ChunkReferenceBuilder::FindBorderCrossings(Common::DataStructures::TileIndex tile_index
+                                                                       , TilePlacementExtents const& extents)
+{
+  RequireF(CCodeZones::FILE_IO, tile_index.x < 64 && tile_index.y < 64, "Tile index out of bounds.");
+
+  std::vector<BorderCrossing> crossings;
+  FindPlacementBorderCrossings(tile_index, extents.models, false, crossings);
+  FindPlacementBorderCrossings(tile_index, extents.map_objects, true, crossings);
+
+  return crossings;
+}
+
+IO::Common::DataStructures::CAaBox ChunkReferenceBuilder::ModelPlacementExtents(DataStructures::MDDF const& placement
+                                                                                , float model_bounding_radius)
+{
+  float const radius = model_bounding_radius * static_cast<float>(placement.scale) / 1024.f;
+  auto const& pos = placement.position;
+
+  return {{pos.x - radius, pos.y - radius, pos.z - radius}, {pos.x + radius, pos.y + radius, pos.z + radius}};
+}
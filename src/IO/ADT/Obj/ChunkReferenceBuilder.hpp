@@ -0,0 +1,134 @@
+#pragma once
+#include <IO/Common.hpp>
+#include <IO/CommonDataStructures.hpp>
+#include <IO/WorldConstants.hpp>
+#include <IO/ADT/DataStructures.hpp>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace IO::ADT
+{
+  /**
+   * Per-chunk placement references of a tile (MCRD, MCRW), row-major.
+   * Each list contains indices into MDDF (models) or MODF (map objects) of the same tile, sorted ascending.
+   */
+  struct ChunkReferences
+  {
+    std::array<std::vector<std::uint32_t>, Common::WorldConstants::CHUNKS_PER_TILE> model_references; ///> MCRD.
+    std::array<std::vector<std::uint32_t>, Common::WorldConstants::CHUNKS_PER_TILE> map_object_references; ///> MCRW.
+  };
+
+  /**
+   * World space bounding boxes of placements of a tile, indexed the same way as MDDF and MODF of that tile.
+   * Boxes are in placement coordinates (x and z are horizontal, relative to the map corner).
+   */
+  struct TilePlacementExtents
+  {
+    std::vector<Common::DataStructures::CAaBox> models;
+    std::vector<Common::DataStructures::CAaBox> map_objects;
+  };
+
+  /**
+   * Placement whose bounding box extends into another tile. The client only culls objects by
+   * references of the tile being rendered, so such placements must also be present in the other tile.
+   */
+  struct BorderCrossing
+  {
+    Common::DataStructures::TileIndex tile; ///> Tile overlapped by the placement.
+    std::uint32_t index; ///> Index of placement in MDDF or MODF of its own tile.
+    bool is_map_object; ///> True if placement is a MODF entry, false if MDDF.
+  };
+
+  /**
+   * Rebuilds MCRD / MCRW chunk references of ADTs from placement bounding boxes.
+   * Each box is rasterized onto the 16x16 chunk grid directly, so the cost is proportional to the number
+   * of chunks a placement covers rather than to placements times chunks.
+   */
+  class ChunkReferenceBuilder
+  {
+  public:
+    /**
+     * Loads placement extents of a tile. Invoked concurrently from worker threads, must be thread-safe.
+     * Must match signature: bool(Common::DataStructures::TileIndex tile_index, TilePlacementExtents& extents).
+     * Returns false if tile does not exist, in which case it is skipped.
+     */
+    using PlacementLoader = std::function<bool(Common::DataStructures::TileIndex, TilePlacementExtents&)>;
+
+    /**
+     * Receives rebuilt references of a tile. Invoked concurrently from worker threads for distinct tiles.
+     * Must match signature: void(Common::DataStructures::TileIndex tile_index, ChunkReferences const& references).
+     */
+    using ReferenceConsumer = std::function<void(Common::DataStructures::TileIndex, ChunkReferences const&)>;
+
+    /**
+     * Rebuilds references of a tile.
+     * Parts of bounding boxes outside of the tile are ignored, see FindBorderCrossings().
+     * @param tile_index Tile coordinates on WDT grid.
+     * @param extents Placement extents of the tile.
+     * @param references References to write the result to. Previous content is discarded.
+     */
+    static void Build(Common::DataStructures::TileIndex tile_index
+                      , TilePlacementExtents const& extents
+                      , ChunkReferences& references);
+
+    /**
+     * Rebuilds references of a set of tiles in parallel.
+     * @param tiles Tiles to process.
+     * @param loader Placement loader callback.
+     * @param consumer Callback receiving the result for each present tile.
+     * @param n_threads Number of worker threads. 0 means hardware concurrency.
+     * @return Number of tiles processed (present tiles only).
+     */
+    static std::size_t BuildTiles(std::vector<Common::DataStructures::TileIndex> const& tiles
+                                  , PlacementLoader const& loader
+                                  , ReferenceConsumer const& consumer
+                                  , unsigned n_threads = 0);
+
+    /**
+     * Finds placements of a tile that extend into neighbouring tiles.
+     * @param tile_index Tile coordinates on WDT grid.
+     * @param extents Placement extents of the tile.
+     * @return Overlapped tiles, ordered by placement type, placement index and tile.
+     */
+    [[nodiscard]]
+    static std::vector<BorderCrossing> FindBorderCrossings(Common::DataStructures::TileIndex tile_index
+                                                           , TilePlacementExtents const& extents);
+
+    /**
+     * Computes a conservative bounding box of a model placement.
+     * MDDF does not store extents, so the bounding radius of the model is required.
+     * @param placement Model placement.
+     * @param model_bounding_radius Bounding radius of the model (M2) at scale 1.0.
+     * @return Axis-aligned box enclosing the placement regardless of its rotation.
+     */
+    [[nodiscard]]
+    static Common::DataStructures::CAaBox ModelPlacementExtents(DataStructures::MDDF const& placement
+                                                                , float model_bounding_radius);
+
+    /**
+     * Collects placement extents of an obj0 ADT. Intended to be used within PlacementLoader callbacks.
+     * @tparam ADTObj0 ADTObj<client_version, ADTObjLodLevel::NORMAL>.
+     * @param adt obj0 ADT of a tile.
+     * @param model_bounding_radius Callback returning model bounding radius, float(DataStructures::MDDF const&).
+     * @param extents Extents to fill.
+     */
+    template<typename ADTObj0, typename ModelRadiusCallback>
+    static void ExtractPlacementExtents(ADTObj0 const& adt
+                                        , ModelRadiusCallback&& model_bounding_radius
+                                        , TilePlacementExtents& extents);
+
+    /**
+     * Writes rebuilt references to MCNK subchunks of an obj0 ADT.
+     * @tparam ADTObj0 ADTObj<client_version, ADTObjLodLevel::NORMAL>.
+     * @param adt obj0 ADT of a tile.
+     * @param references References of the tile.
+     */
+    template<typename ADTObj0>
+    static void ApplyReferences(ADTObj0& adt, ChunkReferences const& references);
+  };
+}
+
+#include <IO/ADT/Obj/ChunkReferenceBuilder.inl>
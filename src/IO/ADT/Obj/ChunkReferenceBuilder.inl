@@ -0,0 +1,34 @@
+#pragma once
+#include <IO/ADT/Obj/ChunkReferenceBuilder.hpp>
+#include <Utils/Meta/Future.hpp>
+
+namespace IO::ADT
+{
+  template<typename ADTObj0, typename ModelRadiusCallback>
+  void ChunkReferenceBuilder::ExtractPlacementExtents(ADTObj0 const& adt
+                                                      , ModelRadiusCallback&& model_bounding_radius
+                                                      , TilePlacementExtents& extents)
+  {
+    extents.models.clear();
+    extents.map_objects.clear();
+
+    extents.models.reserve(adt.ModelPlacements().Size());
+    extents.map_objects.reserve(adt.MapObjectPlacements().Size());
+
+    for (auto& placement : adt.ModelPlacements())
+      extents.models.push_back(ModelPlacementExtents(placement, model_bounding_radius(placement)));
+
+    for (auto& placement : adt.MapObjectPlacements())
+      extents.map_objects.push_back(placement.extents);
+  }
+
+  template<typename ADTObj0>
+  void ChunkReferenceBuilder::ApplyReferences(ADTObj0& adt, ChunkReferences const& references)
+  {
+    for (auto&& [i, chunk] : future::enumerate(adt.Chunks()))
+    {
+      chunk.ModelReferences().Initialize(references.model_references[i]);
+      chunk.MapObjectReferences().Initialize(references.map_object_references[i]);
+    }
+  }
+}
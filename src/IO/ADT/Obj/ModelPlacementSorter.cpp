@@ -0,0 +1,29 @@
+#include <IO/ADT/Obj/ModelPlacementSorter.hpp>
+
+#include <algorithm>
+#include <numeric>
+
+using namespace IO::ADT;
+
+std::vector<std::uint32_t> ModelPlacementSorter::SortOrder(std::vector<float> const& scaled_bounding_radii)
+{
+  std::vector<std::uint32_t> order(scaled_bounding_radii.size());
+  std::iota(order.begin(), order.end(), 0);
+
+  std::stable_sort(order.begin(), order.end(), [&](std::uint32_t lhs, std::uint32_t rhs)
+  {
+    return scaled_bounding_radii[lhs] > scaled_bounding_radii[rhs];
+  });
+
+  return order;
+}
+
+std::vector<std::uint32_t> ModelPlacementSorter::InvertOrder(std::vector<std::uint32_t> const& order)
+{
+  std::vector<std::uint32_t> inverse(order.size());
+
+  for (std::uint32_t i = 0; i < order.size(); ++i)
+    inverse[order[i]] = i;
+
+  return inverse;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <IO/Common.hpp>
+#include <IO/ADT/DataStructures.hpp>
+#include <IO/WDT/WDTRoot.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace IO::ADT
+{
+  /**
+   * Reorders model placements (MDDF) by size category, largest models first, which allows to enable
+   * MapHeaderFlags::ModelsSortedBySizeCategory (WotLK+) in WDT.
+   *
+   * Placements are ordered by bounding radius times placement scale, descending. Size categories grow with
+   * that radius, so the order holds for whatever radius thresholds the client buckets models by, and none
+   * have to be assumed here.
+   *
+   * To produce a sorted map, call SortTile() on every obj0 ADT (and SortLodTile() on every obj1 ADT) before
+   * writing it, then MarkMapSorted() on the WDT. Tiles are independent of each other, so sorting of a map
+   * can be distributed with Utils::Misc::ParallelFor.
+   */
+  class ModelPlacementSorter
+  {
+  public:
+    /**
+     * Computes placement order by scaled bounding radius, largest first. Order of equal radii is preserved.
+     * @param scaled_bounding_radii Bounding radius of the model multiplied by placement scale, per placement.
+     * @return Previous index of each placement at its new position.
+     */
+    [[nodiscard]]
+    static std::vector<std::uint32_t> SortOrder(std::vector<float> const& scaled_bounding_radii);
+
+    /**
+     * Inverts a permutation produced by SortOrder().
+     * @param order Previous index of each element at its new position.
+     * @return New index of each element at its previous position.
+     */
+    [[nodiscard]]
+    static std::vector<std::uint32_t> InvertOrder(std::vector<std::uint32_t> const& order);
+
+    /**
+     * Sorts model placements of an obj0 ADT and remaps MCRD references of its chunks.
+     * @tparam ADTObj0 ADTObj<client_version, ADTObjLodLevel::NORMAL>.
+     * @param adt obj0 ADT of a tile.
+     * @param model_bounding_radius Callback returning model bounding radius, float(DataStructures::MDDF const&).
+     * @return True if placement order has changed.
+     */
+    template<typename ADTObj0, typename ModelRadiusCallback>
+    static bool SortTile(ADTObj0& adt, ModelRadiusCallback&& model_bounding_radius);
+
+    /**
+     * Sorts LOD model placements (MLDD) and their extents (MLDX) of an obj1 ADT by size category
+     * within each LOD band referenced by MLFD. Bands keep their offsets and lengths.
+     * @tparam ADTObj1 ADTObj<client_version, ADTObjLodLevel::LOD>.
+     * @param adt obj1 ADT of a tile.
+     * @return True if placement order has changed.
+     */
+    template<typename ADTObj1>
+    static bool SortLodTile(ADTObj1& adt);
+
+    /**
+     * Marks the map as having model placements sorted by size category.
+     * Must only be called after all tiles of the map were sorted.
+     * @tparam client_version Version of the client.
+     * @param wdt WDT root of the map.
+     */
+    template<Common::ClientVersion client_version>
+    requires (client_version >= Common::ClientVersion::WOTLK)
+    static void MarkMapSorted(WDT::WDTRoot<client_version>& wdt);
+
+  private:
+    template<typename Array>
+    static void Reorder(Array& array, std::vector<std::uint32_t> const& order, std::size_t offset = 0);
+  };
+}
+
+#include <IO/ADT/Obj/ModelPlacementSorter.inl>
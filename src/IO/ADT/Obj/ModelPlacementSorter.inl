@@ -0,0 +1,111 @@
+#pragma once
+#include <IO/ADT/Obj/ModelPlacementSorter.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+
+namespace IO::ADT
+{
+  template<typename Array>
+  void ModelPlacementSorter::Reorder(Array& array, std::vector<std::uint32_t> const& order, std::size_t offset)
+  {
+    std::vector<std::decay_t<decltype(*array.begin())>> elements (array.begin(), array.end());
+
+    for (std::size_t i = 0; i < order.size(); ++i)
+      array[offset + i] = elements[offset + order[i]];
+  }
+
+  template<typename ADTObj0, typename ModelRadiusCallback>
+  bool ModelPlacementSorter::SortTile(ADTObj0& adt, ModelRadiusCallback&& model_bounding_radius)
+  {
+    auto& placements = adt.ModelPlacements();
+
+    std::vector<float> radii;
+    radii.reserve(placements.Size());
+
+    for (auto& placement : placements)
+    {
+      float const scale = static_cast<float>(placement.scale) / 1024.f;
+      radii.push_back(model_bounding_radius(placement) * scale);
+    }
+
+    std::vector<std::uint32_t> const order = SortOrder(radii);
+
+    if (std::is_sorted(order.begin(), order.end()))
+      return false;
+
+    Reorder(placements, order);
+
+    std::vector<std::uint32_t> const new_indices = InvertOrder(order);
+
+    for (auto& chunk : adt.Chunks())
+    {
+      auto& references = chunk.ModelReferences();
+
+      for (auto& reference : references)
+      {
+        RequireF(CCodeZones::FILE_IO, reference < new_indices.size(), "MCRD references non-existing placement.");
+        reference = new_indices[reference];
+      }
+
+      std::sort(references.begin(), references.end());
+    }
+
+    return true;
+  }
+
+  template<typename ADTObj1>
+  bool ModelPlacementSorter::SortLodTile(ADTObj1& adt)
+  {
+    auto& placements = adt.LodModelPlacements();
+    auto& extents = adt.LodModelExtents();
+
+    RequireF(CCodeZones::FILE_IO, placements.Size() == extents.Size(), "MLDD and MLDX must match in size.");
+
+    bool changed = false;
+
+    for (auto& lod_mapping : adt.LodMapping())
+    {
+      for (std::size_t lod = 0; lod < std::size(lod_mapping.m2LodOffset); ++lod)
+      {
+        std::uint32_t const offset = lod_mapping.m2LodOffset[lod];
+        std::uint32_t const length = lod_mapping.m2LodLength[lod];
+
+        RequireF(CCodeZones::FILE_IO, offset + length <= placements.Size(), "MLFD references non-existing MLDD range.");
+
+        std::vector<float> radii;
+        radii.reserve(length);
+
+        // MLDX radius already includes placement scale
+        for (std::uint32_t i = offset; i < offset + length; ++i)
+          radii.push_back(extents[i].radius);
+
+        std::vector<std::uint32_t> const order = SortOrder(radii);
+
+        if (std::is_sorted(order.begin(), order.end()))
+          continue;
+
+        Reorder(placements, order, offset);
+        Reorder(extents, order, offset);
+        changed = true;
+      }
+    }
+
+    return changed;
+  }
+
+  template<Common::ClientVersion client_version>
+  requires (client_version >= Common::ClientVersion::WOTLK)
+  void ModelPlacementSorter::MarkMapSorted(WDT::WDTRoot<client_version>& wdt)
+  {
+    auto& header = wdt.MapHeader();
+
+    if (!header.IsInitialized())
+      header.Initialize(WDT::DataStructures::MapHeader<client_version>{});
+
+    header.data.flags.SetFlag(WDT::DataStructures::MapHeaderFlags<client_version>::ModelsSortedBySizeCategory, true);
+  }
+}
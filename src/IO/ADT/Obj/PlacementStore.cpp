@@ -0,0 +1,428 @@
+#include <IO/ADT/Obj/PlacementStore.hpp>
+#include <IO/WorldConstants.hpp>
+#include <IO/CommonGeometry.hpp>
+#include <IO/Collision/TileCollision.hpp>
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <numbers>
+
+using namespace IO::ADT;
+using namespace IO::Common;
+
+namespace
+{
+  using IO::Common::DataStructures::C3Vector;
+  using IO::Common::DataStructures::CAaBox;
+  using IO::Common::DataStructures::TileIndex;
+
+  constexpr float SCALE_ONE = 1024.f;
+  constexpr std::uint16_t MODF_HAS_SCALE = IO::ADT::DataStructures::MODFFlags::modf_unk_has_scale;
+
+  /**
+   * Placement scale as a factor, map objects are only scaled if flagged.
+   */
+  float ScaleFactor(PlacementColumns const& columns, bool is_map_object, std::uint32_t row)
+  {
+    if (is_map_object && !(columns.flags[row] & MODF_HAS_SCALE))
+      return 1.f;
+
+    return static_cast<float>(columns.scale[row]) / SCALE_ONE;
+  }
+
+  bool IsOwnedBy(PlacementColumns const& columns, std::size_t row, TileIndex tile_index)
+  {
+    return columns.tile_x[row] == tile_index.x && columns.tile_y[row] == tile_index.y;
+  }
+
+  std::uint32_t FindOrAppend(std::vector<AssetReference>& table, AssetReference const& asset)
+  {
+    auto it = std::find(table.begin(), table.end(), asset);
+
+    if (it == table.end())
+      it = table.insert(table.end(), asset);
+
+    return static_cast<std::uint32_t>(it - table.begin());
+  }
+
+  /**
+   * Appends a row with fields shared by both placement kinds. Extents are left for the caller to fill.
+   */
+  template<typename Placement>
+  void AppendRow(PlacementColumns& columns
+                 , TileIndex tile_index
+                 , Placement const& placement
+                 , AssetReference const& asset
+                 , CAaBox const& local_bounds)
+  {
+    columns.asset.push_back(asset);
+    columns.unique_id.push_back(placement.unique_id);
+    columns.position_x.push_back(placement.position.x);
+    columns.position_y.push_back(placement.position.y);
+    columns.position_z.push_back(placement.position.z);
+    columns.rotation_x.push_back(placement.rotation.x);
+    columns.rotation_y.push_back(placement.rotation.y);
+    columns.rotation_z.push_back(placement.rotation.z);
+    columns.flags.push_back(std::bit_cast<std::uint16_t>(placement.flags));
+    columns.local_bounds.push_back(local_bounds);
+    columns.tile_x.push_back(tile_index.x);
+    columns.tile_y.push_back(tile_index.y);
+  }
+
+  void AppendExtents(PlacementColumns& columns, CAaBox const& extents)
+  {
+    columns.extents_min_x.push_back(extents.min.x);
+    columns.extents_min_y.push_back(extents.min.y);
+    columns.extents_min_z.push_back(extents.min.z);
+    columns.extents_max_x.push_back(extents.max.x);
+    columns.extents_max_y.push_back(extents.max.y);
+    columns.extents_max_z.push_back(extents.max.z);
+  }
+
+  /**
+   * Fills fields shared by both placement kinds from a row. Files known by path go to the table of the tile,
+   * the others are referenced by FileDataID directly.
+   */
+  template<typename Placement>
+  void ReadRow(PlacementColumns const& columns, std::size_t row, std::vector<AssetReference>& table, Placement& placement)
+  {
+    AssetReference const& asset = columns.asset[row];
+
+    placement.unique_id = columns.unique_id[row];
+    placement.position = {columns.position_x[row], columns.position_y[row], columns.position_z[row]};
+    placement.rotation = {columns.rotation_x[row], columns.rotation_y[row], columns.rotation_z[row]};
+    placement.scale = columns.scale[row];
+    placement.flags = std::bit_cast<decltype(placement.flags)>(columns.flags[row]);
+    placement.flags.use_filedata_id = asset.path.empty();
+    placement.name_id = asset.path.empty() ? asset.file_data_id : FindOrAppend(table, asset);
+  }
+
+  /**
+   * Bounds of a placement in placement coordinates, from bounds of its file.
+   */
+  CAaBox PlacementExtents(PlacementColumns const& columns, bool is_map_object, std::uint32_t row)
+  {
+    IO::Collision::Transform const transform = IO::Collision::TileCollision::PlacementTransform(
+      {columns.position_x[row], columns.position_y[row], columns.position_z[row]}
+      , {columns.rotation_x[row], columns.rotation_y[row], columns.rotation_z[row]}
+      , ScaleFactor(columns, is_map_object, row));
+
+    CAaBox const& box = columns.local_bounds[row];
+
+    // center and half size, the half size is transformed by the absolute matrix
+    C3Vector const center = transform.TransformPoint({(box.min.x + box.max.x) * 0.5f
+                                                      , (box.min.y + box.max.y) * 0.5f
+                                                      , (box.min.z + box.max.z) * 0.5f});
+    C3Vector const half {(box.max.x - box.min.x) * 0.5f, (box.max.y - box.min.y) * 0.5f, (box.max.z - box.min.z) * 0.5f};
+    auto const& m = transform.matrix;
+
+    C3Vector const extent {std::abs(m[0]) * half.x + std::abs(m[1]) * half.y + std::abs(m[2]) * half.z
+                           , std::abs(m[4]) * half.x + std::abs(m[5]) * half.y + std::abs(m[6]) * half.z
+                           , std::abs(m[8]) * half.x + std::abs(m[9]) * half.y + std::abs(m[10]) * half.z};
+
+    return {{center.x - extent.x, center.y - extent.y, center.z - extent.z}
+            , {center.x + extent.x, center.y + extent.y, center.z + extent.z}};
+  }
+
+  /**
+   * Transforms positions of rows as p' = matrix * (p - origin), in one batch. The translation of the matrix is
+   * expected to add the origin back, so that rotation and scaling happen on small relative coordinates.
+   */
+  void TransformRows(PlacementColumns& columns
+                     , std::span<std::uint32_t const> rows
+                     , C3Vector const& origin
+                     , Geometry::Matrix34 const& matrix)
+  {
+    // rows are scattered across the columns, only the arithmetic runs on contiguous data
+    std::vector<C3Vector> positions(rows.size());
+
+    for (std::size_t i = 0; i < rows.size(); ++i)
+    {
+      std::uint32_t const row = rows[i];
+      positions[i] = {columns.position_x[row] - origin.x
+                      , columns.position_y[row] - origin.y
+                      , columns.position_z[row] - origin.z};
+    }
+
+    Geometry::TransformPoints(matrix, positions, positions);
+
+    for (std::size_t i = 0; i < rows.size(); ++i)
+    {
+      std::uint32_t const row = rows[i];
+      columns.position_x[row] = positions[i].x;
+      columns.position_y[row] = positions[i].y;
+      columns.position_z[row] = positions[i].z;
+    }
+  }
+
+  void TranslateRows(PlacementColumns& columns, std::span<std::uint32_t const> rows, C3Vector const& offset)
+  {
+    TransformRows(columns, rows, {}, {1.f, 0.f, 0.f, offset.x
+                                      , 0.f, 1.f, 0.f, offset.y
+                                      , 0.f, 0.f, 1.f, offset.z});
+  }
+
+  void RotateRows(PlacementColumns& columns, std::span<std::uint32_t const> rows, C3Vector const& pivot, float degrees)
+  {
+    // same rotation around the vertical axis as applied to yaw by the client, see TileCollision::PlacementTransform()
+    float const radians = degrees * std::numbers::pi_v<float> / 180.f;
+    float const c = std::cos(radians);
+    float const s = std::sin(radians);
+
+    // heights are kept absolute, so that they pass through unchanged
+    TransformRows(columns, rows, {pivot.x, 0.f, pivot.z}, {c, 0.f, s, pivot.x
+                                                           , 0.f, 1.f, 0.f, 0.f
+                                                           , -s, 0.f, c, pivot.z});
+
+    for (std::uint32_t row : rows)
+      columns.rotation_y[row] = std::remainder(columns.rotation_y[row] + degrees, 360.f);
+  }
+
+  void ScaleRows(PlacementColumns& columns
+                 , bool is_map_object
+                 , std::span<std::uint32_t const> rows
+                 , C3Vector const& pivot
+                 , float factor)
+  {
+    constexpr float max_scale = std::numeric_limits<std::uint16_t>::max();
+
+    TransformRows(columns, rows, pivot, {factor, 0.f, 0.f, pivot.x
+                                         , 0.f, factor, 0.f, pivot.y
+                                         , 0.f, 0.f, factor, pivot.z});
+
+    for (std::uint32_t row : rows)
+    {
+      float const scale = ScaleFactor(columns, is_map_object, row) * factor * SCALE_ONE;
+      columns.scale[row] = static_cast<std::uint16_t>(std::clamp(std::round(scale), 1.f, max_scale));
+    }
+
+    if (!is_map_object)
+      return;
+
+    for (std::uint32_t row : rows)
+      columns.flags[row] |= MODF_HAS_SCALE;
+  }
+
+  /**
+   * Sorts rows and removes duplicates, so that every placement is transformed once.
+   */
+  std::vector<std::uint32_t> UniqueRows(std::span<std::uint32_t const> rows)
+  {
+    std::vector<std::uint32_t> unique_rows(rows.begin(), rows.end());
+    std::sort(unique_rows.begin(), unique_rows.end());
+    unique_rows.erase(std::unique(unique_rows.begin(), unique_rows.end()), unique_rows.end());
+    return unique_rows;
+  }
+
+  /**
+   * @return Selection with unique rows in ascending order, validated against the columns.
+   */
+  PlacementSelection UniqueSelection(PlacementSelection const& selection
+                                     , PlacementColumns const& models
+                                     , PlacementColumns const& map_objects)
+  {
+    PlacementSelection unique {UniqueRows(selection.models), UniqueRows(selection.map_objects)};
+
+    RequireF(CCodeZones::FILE_IO, (unique.models.empty() || unique.models.back() < models.Size())
+                                  && (unique.map_objects.empty() || unique.map_objects.back() < map_objects.Size())
+             , "Selection references non-existing placements.");
+
+    return unique;
+  }
+}
+
+PlacementStore::PlacementStore(BoundsProvider bounds_provider)
+: _bounds_provider(std::move(bounds_provider))
+{
+}
+
+void PlacementStore::AddTile(TileIndex tile_index, TilePlacements const& placements)
+{
+  auto const& models = placements.model_placements;
+  auto const& map_objects = placements.map_object_placements;
+
+  RequireF(CCodeZones::FILE_IO, tile_index.x < 64 && tile_index.y < 64, "Tile index out of bounds.");
+
+  for (std::size_t i = 0; i < _models.Size(); ++i)
+    RequireF(CCodeZones::FILE_IO, !IsOwnedBy(_models, i, tile_index), "Tile is already loaded.");
+
+  for (std::size_t i = 0; i < _map_objects.Size(); ++i)
+    RequireF(CCodeZones::FILE_IO, !IsOwnedBy(_map_objects, i, tile_index), "Tile is already loaded.");
+
+  _models.ForEachColumn([&](auto& column) { column.reserve(column.size() + models.size()); });
+  _map_objects.ForEachColumn([&](auto& column) { column.reserve(column.size() + map_objects.size()); });
+
+  for (auto const& placement : models)
+  {
+    AssetReference const asset = placements.ModelAsset(placement);
+    AppendRow(_models, tile_index, placement, asset, _bounds_provider(false, asset));
+    _models.scale.push_back(placement.scale);
+    _models.doodad_set.push_back(0);
+    _models.name_set.push_back(0);
+
+    // models do not store extents
+    AppendExtents(_models, PlacementExtents(_models, false, static_cast<std::uint32_t>(_models.Size() - 1)));
+  }
+
+  for (auto const& placement : map_objects)
+  {
+    AssetReference const asset = placements.MapObjectAsset(placement);
+    AppendRow(_map_objects, tile_index, placement, asset, _bounds_provider(true, asset));
+    _map_objects.scale.push_back(placement.scale);
+    _map_objects.doodad_set.push_back(placement.doodadSet);
+    _map_objects.name_set.push_back(placement.nameSet);
+    AppendExtents(_map_objects, placement.extents);
+  }
+
+  LogDebugF(LCodeZones::FILE_IO, "Placement store: added tile (%d, %d), %d models, %d map objects."
+            , tile_index.x, tile_index.y, models.size(), map_objects.size());
+}
+
+void PlacementStore::ExtractTile(TileIndex tile_index, TilePlacements& placements) const
+{
+  auto& models = placements.model_placements;
+  auto& map_objects = placements.map_object_placements;
+  models.clear();
+  map_objects.clear();
+
+  for (std::size_t row = 0; row < _models.Size(); ++row)
+  {
+    if (!IsOwnedBy(_models, row, tile_index))
+      continue;
+
+    DataStructures::MDDF& placement = models.emplace_back();
+    ReadRow(_models, row, placements.models, placement);
+  }
+
+  for (std::size_t row = 0; row < _map_objects.Size(); ++row)
+  {
+    if (!IsOwnedBy(_map_objects, row, tile_index))
+      continue;
+
+    DataStructures::MODF& placement = map_objects.emplace_back();
+    ReadRow(_map_objects, row, placements.map_objects, placement);
+    placement.doodadSet = _map_objects.doodad_set[row];
+    placement.nameSet = _map_objects.name_set[row];
+    placement.extents = {{_map_objects.extents_min_x[row], _map_objects.extents_min_y[row], _map_objects.extents_min_z[row]}
+                         , {_map_objects.extents_max_x[row], _map_objects.extents_max_y[row], _map_objects.extents_max_z[row]}};
+  }
+}
+
+void PlacementStore::RemoveTile(TileIndex tile_index)
+{
+  for (PlacementColumns* columns : {&_models, &_map_objects})
+  {
+    // rows to keep, computed before any column is compacted
+    std::vector<bool> keep(columns->Size());
+
+    for (std::size_t row = 0; row < columns->Size(); ++row)
+      keep[row] = !IsOwnedBy(*columns, row, tile_index);
+
+    columns->ForEachColumn([&](auto& column)
+    {
+      std::size_t n_kept = 0;
+
+      for (std::size_t row = 0; row < column.size(); ++row)
+      {
+        if (keep[row])
+          column[n_kept++] = column[row];
+      }
+
+      column.resize(n_kept);
+    });
+  }
+}
+
+std::vector<TileIndex> PlacementStore::Translate(PlacementSelection const& selection, C3Vector const& offset)
+{
+  PlacementSelection const rows = UniqueSelection(selection, _models, _map_objects);
+
+  TranslateRows(_models, rows.models, offset);
+  TranslateRows(_map_objects, rows.map_objects, offset);
+
+  return FinishUpdate(rows);
+}
+
+std::vector<TileIndex> PlacementStore::Rotate(PlacementSelection const& selection, C3Vector const& pivot, float degrees)
+{
+  PlacementSelection const rows = UniqueSelection(selection, _models, _map_objects);
+
+  RotateRows(_models, rows.models, pivot, degrees);
+  RotateRows(_map_objects, rows.map_objects, pivot, degrees);
+
+  return FinishUpdate(rows);
+}
+
+std::vector<TileIndex> PlacementStore::Scale(PlacementSelection const& selection, C3Vector const& pivot, float factor)
+{
+  RequireF(CCodeZones::FILE_IO, factor > 0.f, "Scale factor must be positive.");
+  PlacementSelection const rows = UniqueSelection(selection, _models, _map_objects);
+
+  ScaleRows(_models, false, rows.models, pivot, factor);
+  ScaleRows(_map_objects, true, rows.map_objects, pivot, factor);
+
+  return FinishUpdate(rows);
+}
+
+void PlacementStore::UpdateRows(PlacementColumns& columns
+                                , bool is_map_object
+                                , std::span<std::uint32_t const> rows
+                                , std::vector<TileIndex>& changed_tiles)
+{
+  for (std::uint32_t row : rows)
+  {
+    CAaBox const extents = PlacementExtents(columns, is_map_object, row);
+
+    columns.extents_min_x[row] = extents.min.x;
+    columns.extents_min_y[row] = extents.min.y;
+    columns.extents_min_z[row] = extents.min.z;
+    columns.extents_max_x[row] = extents.max.x;
+    columns.extents_max_y[row] = extents.max.y;
+    columns.extents_max_z[row] = extents.max.z;
+  }
+
+  // owners are the tiles containing the positions, looked up in one batch
+  std::vector<C3Vector> positions(rows.size());
+  std::vector<TileIndex> owners(rows.size());
+
+  for (std::size_t i = 0; i < rows.size(); ++i)
+    positions[i] = {columns.position_x[rows[i]], columns.position_y[rows[i]], columns.position_z[rows[i]]};
+
+  Geometry::TileIndicesAt(positions, owners);
+
+  for (std::size_t i = 0; i < rows.size(); ++i)
+  {
+    std::uint32_t const row = rows[i];
+    changed_tiles.push_back({columns.tile_x[row], columns.tile_y[row]});
+
+    columns.tile_x[row] = owners[i].x;
+    columns.tile_y[row] = owners[i].y;
+
+    changed_tiles.push_back(owners[i]);
+  }
+}
+
+std::vector<TileIndex> PlacementStore::FinishUpdate(PlacementSelection const& selection)
+{
+  std::vector<TileIndex> changed_tiles;
+  changed_tiles.reserve((selection.models.size() + selection.map_objects.size()) * 2);
+
+  UpdateRows(_models, false, selection.models, changed_tiles);
+  UpdateRows(_map_objects, true, selection.map_objects, changed_tiles);
+
+  auto const tile_key = [](TileIndex tile) { return tile.y * 64 + tile.x; };
+
+  std::sort(changed_tiles.begin(), changed_tiles.end()
+            , [&](TileIndex lhs, TileIndex rhs) { return tile_key(lhs) < tile_key(rhs); });
+
+  changed_tiles.erase(std::unique(changed_tiles.begin(), changed_tiles.end()
+                                  , [&](TileIndex lhs, TileIndex rhs) { return tile_key(lhs) == tile_key(rhs); })
+                      , changed_tiles.end());
+
+  return changed_tiles;
+}
@@ -0,0 +1,200 @@
+#pragma once
+#include <IO/Common.hpp>
+#include <IO/CommonDataStructures.hpp>
+#include <IO/ADT/DataStructures.hpp>
+#include <IO/ADT/TileData.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace IO::ADT
+{
+  /**
+   * Placements of one kind (MDDF or MODF) stored as a structure of arrays, one column per field.
+   * Row order within each tile follows the order placements were loaded in.
+   * Files are kept as references rather than name_id, which is only meaningful within the tables of one tile.
+   */
+  struct PlacementColumns
+  {
+    std::vector<AssetReference> asset; ///> File of the placement, by path or by FileDataID.
+    std::vector<std::uint32_t> unique_id;
+
+    std::vector<float> position_x;
+    std::vector<float> position_y;
+    std::vector<float> position_z;
+
+    std::vector<float> rotation_x; ///> Degrees.
+    std::vector<float> rotation_y; ///> Degrees, yaw around the vertical axis.
+    std::vector<float> rotation_z; ///> Degrees.
+
+    std::vector<std::uint16_t> scale; ///> 1024 means 1.0.
+    std::vector<std::uint16_t> flags; ///> Raw MDDF / MODF flags.
+    std::vector<std::uint16_t> doodad_set; ///> MODF only, 0 for models.
+    std::vector<std::uint16_t> name_set; ///> MODF only, 0 for models.
+
+    std::vector<float> extents_min_x; ///> Placement coordinates.
+    std::vector<float> extents_min_y;
+    std::vector<float> extents_min_z;
+    std::vector<float> extents_max_x;
+    std::vector<float> extents_max_y;
+    std::vector<float> extents_max_z;
+
+    std::vector<Common::DataStructures::CAaBox> local_bounds; ///> Bounds of the file in its own space.
+
+    std::vector<std::uint16_t> tile_x; ///> Tile owning the placement.
+    std::vector<std::uint16_t> tile_y;
+
+    [[nodiscard]]
+    std::size_t Size() const { return unique_id.size(); };
+
+    /**
+     * Invokes callback for every column.
+     * Callback must match signature: void(std::vector<T>& column), for each column type T.
+     */
+    template<typename Callback>
+    void ForEachColumn(Callback&& callback);
+  };
+
+  /**
+   * Rows of placements an operation applies to, in any order. Rows listed more than once are affected once.
+   */
+  struct PlacementSelection
+  {
+    std::vector<std::uint32_t> models; ///> Rows of PlacementStore::Models().
+    std::vector<std::uint32_t> map_objects; ///> Rows of PlacementStore::MapObjects().
+  };
+
+  /**
+   * Map-wide store of model (MDDF) and map object (MODF) placements of all loaded tiles.
+   *
+   * Fields are kept in columns. Batch operations gather the positions of selected rows and transform them with
+   * the geometry batch kernels, other fields are updated column by column. Every operation recomputes extents
+   * of the affected placements from bounds of their files and re-evaluates which tile owns them (the tile
+   * containing the position).
+   *
+   * Placements not touched by any operation are written back exactly as they were read, including MODF extents.
+   * Extents of models are not stored in ADTs and are kept for ownership and culling purposes only.
+   */
+  class PlacementStore
+  {
+  public:
+    /**
+     * Provides bounds of a model or map object file in its own space (z-up), as stored in M2 / WMO headers.
+     * Must match signature: Common::DataStructures::CAaBox(bool is_map_object, AssetReference const& asset).
+     * asset is the file of the placement, resolved through the tile's tables or by FileDataID, as flagged by it.
+     */
+    using BoundsProvider = std::function<Common::DataStructures::CAaBox(bool, AssetReference const&)>;
+
+    explicit PlacementStore(BoundsProvider bounds_provider);
+
+    /**
+     * Adds placements of a tile. The tile must not be loaded already.
+     * Extents of models are computed, extents of map objects are taken as stored.
+     * @param tile_index Tile coordinates on WDT grid.
+     * @param placements Placements (MDDF, MODF) and file tables of the tile.
+     */
+    void AddTile(Common::DataStructures::TileIndex tile_index, TilePlacements const& placements);
+
+    /**
+     * Collects placements currently owned by a tile, in row order. Placements that moved in from other tiles
+     * are remapped into the file tables of this one: entries already in the tables are kept and reused,
+     * missing ones are appended. Files known by FileDataID only are referenced directly.
+     * @param tile_index Tile coordinates on WDT grid.
+     * @param placements Receives placements. Previous placements are discarded, tables are extended.
+     */
+    void ExtractTile(Common::DataStructures::TileIndex tile_index, TilePlacements& placements) const;
+
+    /**
+     * Removes placements owned by a tile. Rows of other placements are shifted, invalidating selections.
+     * @param tile_index Tile coordinates on WDT grid.
+     */
+    void RemoveTile(Common::DataStructures::TileIndex tile_index);
+
+    /**
+     * Loads placements from an obj0 ADT.
+     * @tparam ADTObj0 ADTObj<client_version, ADTObjLodLevel::NORMAL>.
+     * @param tile_index Tile coordinates on WDT grid.
+     * @param adt obj0 ADT of the tile.
+     * @param models Model files of the tile (MMDX / MMID).
+     * @param map_objects Map object files of the tile (MWMO / MWID).
+     */
+    template<typename ADTObj0>
+    void LoadTile(Common::DataStructures::TileIndex tile_index
+                  , ADTObj0 const& adt
+                  , std::vector<AssetReference> const& models
+                  , std::vector<AssetReference> const& map_objects);
+
+    /**
+     * Writes placements owned by a tile into its obj0 ADT. Chunk references (MCRD, MCRW) need to be rebuilt
+     * afterwards with ChunkReferenceBuilder if any placement moved.
+     * @tparam ADTObj0 ADTObj<client_version, ADTObjLodLevel::NORMAL>.
+     * @param tile_index Tile coordinates on WDT grid.
+     * @param adt obj0 ADT of the tile.
+     * @param models Model files of the tile, extended by files of placements that moved in. Written by the caller.
+     * @param map_objects Map object files of the tile, likewise.
+     */
+    template<typename ADTObj0>
+    void StoreTile(Common::DataStructures::TileIndex tile_index
+                   , ADTObj0& adt
+                   , std::vector<AssetReference>& models
+                   , std::vector<AssetReference>& map_objects) const;
+
+    /**
+     * Moves placements.
+     * @param selection Placements to move.
+     * @param offset Offset in placement coordinates.
+     * @return Tiles whose placements changed (previous and new owners), sorted.
+     */
+    std::vector<Common::DataStructures::TileIndex> Translate(PlacementSelection const& selection
+                                                             , Common::DataStructures::C3Vector const& offset);
+
+    /**
+     * Rotates placements as a group around a vertical axis. Positions are rotated around the pivot
+     * and yaw of each placement is changed by the same angle.
+     * @param selection Placements to rotate.
+     * @param pivot Point the vertical axis goes through.
+     * @param degrees Angle of rotation.
+     * @return Tiles whose placements changed (previous and new owners), sorted.
+     */
+    std::vector<Common::DataStructures::TileIndex> Rotate(PlacementSelection const& selection
+                                                          , Common::DataStructures::C3Vector const& pivot
+                                                          , float degrees);
+
+    /**
+     * Scales placements as a group. Positions are scaled relatively to the pivot, and so is scale of each placement.
+     * Scale is clamped to the range representable in ADTs. Map objects get scale flagged as used.
+     * @param selection Placements to scale.
+     * @param pivot Point scaling is relative to.
+     * @param factor Scale factor.
+     * @return Tiles whose placements changed (previous and new owners), sorted.
+     */
+    std::vector<Common::DataStructures::TileIndex> Scale(PlacementSelection const& selection
+                                                         , Common::DataStructures::C3Vector const& pivot
+                                                         , float factor);
+
+    [[nodiscard]]
+    PlacementColumns const& Models() const { return _models; };
+
+    [[nodiscard]]
+    PlacementColumns const& MapObjects() const { return _map_objects; };
+
+  private:
+    /**
+     * Recomputes extents and owners of rows after their transform changed, collecting affected tiles.
+     */
+    void UpdateRows(PlacementColumns& columns
+                    , bool is_map_object
+                    , std::span<std::uint32_t const> rows
+                    , std::vector<Common::DataStructures::TileIndex>& changed_tiles);
+
+    std::vector<Common::DataStructures::TileIndex> FinishUpdate(PlacementSelection const& selection);
+
+    BoundsProvider _bounds_provider;
+    PlacementColumns _models;
+    PlacementColumns _map_objects;
+  };
+}
+
+#include <IO/ADT/Obj/PlacementStore.inl>
@@ -0,0 +1,63 @@
+#pragma once
+#include <IO/ADT/Obj/PlacementStore.hpp>
+
+namespace IO::ADT
+{
+  template<typename Callback>
+  void PlacementColumns::ForEachColumn(Callback&& callback)
+  {
+    callback(asset);
+    callback(unique_id);
+    callback(position_x);
+    callback(position_y);
+    callback(position_z);
+    callback(rotation_x);
+    callback(rotation_y);
+    callback(rotation_z);
+    callback(scale);
+    callback(flags);
+    callback(doodad_set);
+    callback(name_set);
+    callback(extents_min_x);
+    callback(extents_min_y);
+    callback(extents_min_z);
+    callback(extents_max_x);
+    callback(extents_max_y);
+    callback(extents_max_z);
+    callback(local_bounds);
+    callback(tile_x);
+    callback(tile_y);
+  }
+
+  template<typename ADTObj0>
+  void PlacementStore::LoadTile(Common::DataStructures::TileIndex tile_index
+                                , ADTObj0 const& adt
+                                , std::vector<AssetReference> const& models
+                                , std::vector<AssetReference> const& map_objects)
+  {
+    TilePlacements placements;
+    placements.models = models;
+    placements.map_objects = map_objects;
+    placements.model_placements.assign(adt.ModelPlacements().begin(), adt.ModelPlacements().end());
+    placements.map_object_placements.assign(adt.MapObjectPlacements().begin(), adt.MapObjectPlacements().end());
+
+    AddTile(tile_index, placements);
+  }
+
+  template<typename ADTObj0>
+  void PlacementStore::StoreTile(Common::DataStructures::TileIndex tile_index
+                                 , ADTObj0& adt
+                                 , std::vector<AssetReference>& models
+                                 , std::vector<AssetReference>& map_objects) const
+  {
+    TilePlacements placements;
+    placements.models = std::move(models);
+    placements.map_objects = std::move(map_objects);
+    ExtractTile(tile_index, placements);
+
+    adt.ModelPlacements().Initialize(placements.model_placements);
+    adt.MapObjectPlacements().Initialize(placements.map_object_placements);
+    models = std::move(placements.models);
+    map_objects = std::move(placements.map_objects);
+  }
+}
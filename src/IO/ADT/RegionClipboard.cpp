@@ -0,0 +1,1166 @@
+#include <IO/ADT/RegionClipboard.hpp>
+#include <IO/Common.hpp>
+#include <IO/ADT/Root/LiquidFiller.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <memory>
+#include <numeric>
+#include <type_traits>
+#include <unordered_set>
+
+using namespace IO::ADT;
+using namespace IO::Common;
+
+namespace
+{
+  using IO::ADT::DataStructures::MDDF;
+  using IO::ADT::DataStructures::MODF;
+  using IO::ADT::DataStructures::SMLayer;
+  using IO::Common::DataStructures::TileIndex;
+
+  constexpr std::uint32_t CLIPBOARD_MAGIC = IO::Common::FourCC<"RCLP">;
+  constexpr std::uint32_t CLIPBOARD_VERSION = 1;
+
+  constexpr unsigned N_QUADS_CHUNK_ROW = 8;
+  constexpr unsigned N_QUADS_TILE_ROW = N_QUADS_CHUNK_ROW * 16;
+  constexpr unsigned N_QUADS_MAP_ROW = N_QUADS_TILE_ROW * 64;
+  constexpr unsigned N_LIQUID_VERTICES_ROW = N_QUADS_CHUNK_ROW + 1;
+  constexpr float QUAD_SIZE = WorldConstants::CHUNK_SIZE / N_QUADS_CHUNK_ROW;
+
+  // MCVT and MCNR rows alternate 9 outer and 8 inner vertices
+  constexpr unsigned MCVT_ROW_STRIDE = WorldConstants::N_VERTS_CHUNK_ROW_OUTER + WorldConstants::N_VERTS_CHUNK_ROW_INNER;
+
+  // alpha and shadow pixels covered by a quad along each axis
+  constexpr unsigned N_PIXELS_QUAD_ROW = WorldConstants::ALPHAMAP_DIM / N_QUADS_CHUNK_ROW;
+
+  constexpr unsigned MAX_LAYERS = 4;
+
+  constexpr unsigned OuterVertex(unsigned x, unsigned y) { return y * MCVT_ROW_STRIDE + x; }
+  constexpr unsigned InnerVertex(unsigned x, unsigned y) { return y * MCVT_ROW_STRIDE + WorldConstants::N_VERTS_CHUNK_ROW_OUTER + x; }
+
+  // alpha map pixel (x, y) of quad (quad_x, quad_y)
+  constexpr unsigned ChunkPixel(unsigned quad_x, unsigned quad_y, unsigned x, unsigned y)
+  {
+    return (quad_y * N_PIXELS_QUAD_ROW + y) * WorldConstants::ALPHAMAP_DIM + quad_x * N_PIXELS_QUAD_ROW + x;
+  }
+
+  /**
+   * Writes heights + add - subtract for a row of vertices. Both operations round, in this order.
+   */
+  void ShiftHeights(float const* heights, float* shifted, std::size_t n, float add, float subtract)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      shifted[i] = heights[i] + add - subtract;
+  }
+
+  /**
+   * Tiles overlapping a range of quad columns and rows, end exclusive, row-major.
+   */
+  struct TileRange
+  {
+    std::uint32_t x_begin;
+    std::uint32_t y_begin;
+    std::uint32_t x_end;
+    std::uint32_t y_end;
+
+    TileRange(std::uint32_t quad_x_begin, std::uint32_t quad_y_begin, std::uint32_t quad_x_end, std::uint32_t quad_y_end)
+    : x_begin(quad_x_begin / N_QUADS_TILE_ROW)
+    , y_begin(quad_y_begin / N_QUADS_TILE_ROW)
+    , x_end(std::min((quad_x_end - 1) / N_QUADS_TILE_ROW + 1, 64u))
+    , y_end(std::min((quad_y_end - 1) / N_QUADS_TILE_ROW + 1, 64u))
+    {
+    }
+
+    [[nodiscard]]
+    std::size_t Size() const { return (x_end - x_begin) * (y_end - y_begin); };
+
+    [[nodiscard]]
+    TileIndex operator[](std::size_t i) const
+    {
+      return TileIndex{static_cast<std::uint16_t>(x_begin + i % (x_end - x_begin))
+                       , static_cast<std::uint16_t>(y_begin + i / (x_end - x_begin))};
+    }
+
+    [[nodiscard]]
+    std::size_t Slot(float x, float z) const
+    {
+      auto const tile = [](float coord, std::uint32_t begin, std::uint32_t end)
+      {
+        auto const index = static_cast<std::int64_t>(std::floor(coord / WorldConstants::TILE_SIZE));
+        return static_cast<std::size_t>(std::clamp<std::int64_t>(index, begin, end - 1) - begin);
+      };
+
+      return tile(z, y_begin, y_end) * (x_end - x_begin) + tile(x, x_begin, x_end);
+    }
+  };
+
+  /**
+   * Converts 8x8 quad holes to 4x4 holes of 2x2 quad cells, inverse of ChunkHoleMask() for aligned holes.
+   * @param any A cell becomes a hole if any of its quads is one, otherwise only if all of them are.
+   */
+  std::uint16_t HighResToLowResHoles(std::uint64_t holes, bool any)
+  {
+    std::uint16_t low_res = 0;
+
+    for (unsigned y = 0; y < 4; ++y)
+    {
+      for (unsigned x = 0; x < 4; ++x)
+      {
+        // quads (2x, 2y), (2x + 1, 2y) and the two below them
+        std::uint64_t const cell = std::uint64_t{0x303} << (y * 16 + x * 2);
+        bool const is_hole = any ? (holes & cell) != 0 : (holes & cell) == cell;
+        low_res |= static_cast<std::uint16_t>(is_hole) << (y * 4 + x);
+      }
+    }
+
+    return low_res;
+  }
+
+  std::uint32_t FindOrAppend(std::vector<AssetReference>& table, AssetReference const& asset)
+  {
+    auto it = std::find(table.begin(), table.end(), asset);
+
+    if (it == table.end())
+      it = table.insert(table.end(), asset);
+
+    return static_cast<std::uint32_t>(it - table.begin());
+  }
+
+  /**
+   * Maps entries of a tile-local table to a clipboard-wide one.
+   */
+  std::vector<std::uint32_t> MergeTable(std::vector<AssetReference>& table, std::vector<AssetReference> const& local)
+  {
+    std::vector<std::uint32_t> mapping;
+    mapping.reserve(local.size());
+
+    for (AssetReference const& asset : local)
+      mapping.push_back(FindOrAppend(table, asset));
+
+    return mapping;
+  }
+
+  /**
+   * Texture competing for one of the four layers of a chunk.
+   */
+  struct TextureCandidate
+  {
+    AssetReference asset;
+    SMLayer layer;
+    std::uint64_t weight = 0;
+  };
+
+  /**
+   * Texture weights of one alpha pixel, base layer first.
+   */
+  struct PixelWeights
+  {
+    std::array<std::uint32_t, MAX_LAYERS> candidates;
+    std::array<std::uint32_t, MAX_LAYERS> weights;
+    unsigned n_layers = 0;
+  };
+
+  template<typename WeightOf>
+  void FillPixelWeights(PixelWeights& pixel, std::span<std::uint32_t const> candidates, WeightOf&& weight_of)
+  {
+    pixel.n_layers = static_cast<unsigned>(candidates.size());
+
+    if (candidates.empty())
+      return;
+
+    std::uint32_t base = 255;
+
+    for (unsigned layer = 1; layer < candidates.size(); ++layer)
+    {
+      pixel.candidates[layer] = candidates[layer];
+      pixel.weights[layer] = weight_of(layer);
+      base -= std::min(base, pixel.weights[layer]);
+    }
+
+    pixel.candidates[0] = candidates[0];
+    pixel.weights[0] = base;
+  }
+
+  /**
+   * Merges pasted quads into texturing of a chunk. Existing layers keep their order, new textures are appended,
+   * and if more than four textures remain, those with least total weight over the chunk are dropped.
+   */
+  void PasteChunkTexturing(ChunkTexturing& chunk
+                           , std::vector<AssetReference>& tile_textures
+                           , std::vector<AssetReference> const& clipboard_textures
+                           , std::array<RegionClipboard::QuadTexturing const*, 64> const& pasted)
+  {
+    EnsureF(CCodeZones::FILE_IO, chunk.layers.size() <= MAX_LAYERS && chunk.alphamaps.size() + 1 >= chunk.layers.size()
+            , "Malformed chunk texturing.");
+
+    std::vector<TextureCandidate> candidates;
+
+    auto const candidate_of = [&](AssetReference const& asset, SMLayer const& layer)
+    {
+      auto it = std::find_if(candidates.begin(), candidates.end()
+                             , [&](TextureCandidate const& candidate) { return candidate.asset == asset; });
+
+      if (it == candidates.end())
+        it = candidates.insert(candidates.end(), TextureCandidate{asset, layer});
+
+      return static_cast<std::uint32_t>(it - candidates.begin());
+    };
+
+    std::vector<std::uint32_t> existing;
+
+    for (SMLayer const& layer : chunk.layers)
+    {
+      EnsureF(CCodeZones::FILE_IO, layer.textureId < tile_textures.size(), "Texture layer references non-existing texture.");
+      existing.push_back(candidate_of(tile_textures[layer.textureId], layer));
+    }
+
+    std::array<std::array<std::uint32_t, MAX_LAYERS>, 64> quad_candidates {};
+
+    for (unsigned quad = 0; quad < 64; ++quad)
+    {
+      if (!pasted[quad])
+        continue;
+
+      for (unsigned layer = 0; layer < pasted[quad]->n_layers; ++layer)
+      {
+        SMLayer const& source = pasted[quad]->layers[layer];
+        quad_candidates[quad][layer] = candidate_of(clipboard_textures[source.textureId], source);
+      }
+    }
+
+    auto const pixel_weights = [&](unsigned pixel, PixelWeights& weights)
+    {
+      unsigned const quad = (pixel / WorldConstants::ALPHAMAP_DIM / N_PIXELS_QUAD_ROW) * N_QUADS_CHUNK_ROW
+        + (pixel % WorldConstants::ALPHAMAP_DIM) / N_PIXELS_QUAD_ROW;
+
+      if (auto const* source = pasted[quad])
+      {
+        unsigned const quad_pixel = (pixel / WorldConstants::ALPHAMAP_DIM % N_PIXELS_QUAD_ROW) * N_PIXELS_QUAD_ROW
+          + pixel % N_PIXELS_QUAD_ROW;
+
+        FillPixelWeights(weights, {quad_candidates[quad].data(), source->n_layers}
+                         , [&](unsigned layer) { return source->weights[layer - 1][quad_pixel]; });
+      }
+      else
+      {
+        FillPixelWeights(weights, existing
+                         , [&](unsigned layer) { return chunk.alphamaps[layer - 1][pixel]; });
+      }
+    };
+
+    PixelWeights weights;
+
+    for (unsigned pixel = 0; pixel < WorldConstants::N_PIXELS_PER_ALPHAMAP; ++pixel)
+    {
+      pixel_weights(pixel, weights);
+
+      for (unsigned layer = 0; layer < weights.n_layers; ++layer)
+        candidates[weights.candidates[layer]].weight += weights.weights[layer];
+    }
+
+    // heaviest textures win, ties resolved in favor of existing layers
+    std::vector<std::uint32_t> order(candidates.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end()
+                     , [&](std::uint32_t lhs, std::uint32_t rhs) { return candidates[lhs].weight > candidates[rhs].weight; });
+
+    std::erase_if(order, [&](std::uint32_t candidate) { return !candidates[candidate].weight; });
+
+    if (order.size() > MAX_LAYERS)
+      order.resize(MAX_LAYERS);
+
+    std::sort(order.begin(), order.end());
+
+    std::vector<int> layer_of(candidates.size(), -1);
+    std::vector<SMLayer> layers;
+
+    for (std::uint32_t candidate : order)
+    {
+      layer_of[candidate] = static_cast<int>(layers.size());
+
+      SMLayer layer = candidates[candidate].layer;
+      layer.textureId = FindOrAppend(tile_textures, candidates[candidate].asset);
+      layer.offsetInMCAL = 0;
+      layer.flags.use_alpha_map = !layers.empty();
+
+      if (layers.empty())
+        layer.flags.alpha_map_compressed = 0;
+
+      layers.push_back(layer);
+    }
+
+    std::vector<Alphamap> alphamaps(layers.empty() ? 0 : layers.size() - 1);
+
+    for (unsigned pixel = 0; pixel < WorldConstants::N_PIXELS_PER_ALPHAMAP; ++pixel)
+    {
+      pixel_weights(pixel, weights);
+
+      std::array<std::uint32_t, MAX_LAYERS> kept {};
+      std::uint32_t total = 0;
+
+      for (unsigned layer = 0; layer < weights.n_layers; ++layer)
+      {
+        if (int const target = layer_of[weights.candidates[layer]]; target >= 0)
+        {
+          kept[target] += weights.weights[layer];
+          total += weights.weights[layer];
+        }
+      }
+
+      // all textures of the pixel were dropped, it falls back to the base layer
+      if (!total)
+        continue;
+
+      // rounding cumulative sums keeps the weights summing up to 255 exactly
+      std::uint32_t cumulative = 0;
+      std::uint32_t previous = 0;
+
+      for (unsigned layer = 0; layer < layers.size(); ++layer)
+      {
+        cumulative += kept[layer];
+        std::uint32_t const rounded = (cumulative * 255 + total / 2) / total;
+
+        if (layer)
+          alphamaps[layer - 1][pixel] = static_cast<std::uint8_t>(rounded - previous);
+
+        previous = rounded;
+      }
+    }
+
+    chunk.layers = std::move(layers);
+    chunk.alphamaps = std::move(alphamaps);
+
+    for (unsigned quad = 0; quad < 64; ++quad)
+    {
+      if (!pasted[quad])
+        continue;
+
+      for (unsigned y = 0; y < N_PIXELS_QUAD_ROW; ++y)
+      {
+        for (unsigned x = 0; x < N_PIXELS_QUAD_ROW; ++x)
+        {
+          chunk.shadowmap[ChunkPixel(quad % 8, quad / 8, x, y)]
+            = (pasted[quad]->shadow >> (y * N_PIXELS_QUAD_ROW + x)) & 1;
+        }
+      }
+    }
+  }
+
+  template<typename T>
+  void AppendBytes(std::vector<char>& out, T const& value)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    char const* bytes = reinterpret_cast<char const*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+  }
+
+  template<typename T>
+  void AppendArray(std::vector<char>& out, std::vector<T> const& values)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    char const* bytes = reinterpret_cast<char const*>(values.data());
+    out.insert(out.end(), bytes, bytes + values.size() * sizeof(T));
+  }
+
+  void AppendTable(std::vector<char>& out, std::vector<AssetReference> const& table)
+  {
+    AppendBytes(out, static_cast<std::uint32_t>(table.size()));
+
+    for (AssetReference const& asset : table)
+    {
+      out.insert(out.end(), asset.path.begin(), asset.path.end());
+      out.push_back('\0');
+      AppendBytes(out, asset.file_data_id);
+    }
+  }
+
+  void ReadTable(ByteBuffer const& buf, std::vector<AssetReference>& table)
+  {
+    table.resize(buf.Read<std::uint32_t>());
+
+    for (AssetReference& asset : table)
+    {
+      asset.path = buf.ReadString();
+      asset.file_data_id = buf.Read<std::uint32_t>();
+    }
+  }
+
+  template<typename T>
+  void ReadArray(ByteBuffer const& buf, std::vector<T>& values)
+  {
+    values.resize(buf.Read<std::uint32_t>());
+    buf.Read(values.begin(), values.end());
+  }
+}
+
+RegionClipboard RegionClipboard::Copy(QuadRegion const& region, TileLoader const& loader, unsigned n_threads)
+{
+  RequireF(CCodeZones::FILE_IO, region.width && region.height, "Region is empty.");
+  RequireF(CCodeZones::FILE_IO, region.x < N_QUADS_MAP_ROW && region.width <= N_QUADS_MAP_ROW - region.x
+                                && region.y < N_QUADS_MAP_ROW && region.height <= N_QUADS_MAP_ROW - region.y
+           , "Region out of map bounds.");
+
+  LogDebugF(LCodeZones::FILE_IO, "Copying region of %dx%d quads.", region.width, region.height);
+
+  RegionClipboard clipboard;
+  clipboard._region = region;
+
+  std::size_t const n_quads = std::size_t{region.width} * region.height;
+  std::size_t const n_outer = std::size_t{region.width + 1} * (region.height + 1);
+
+  clipboard._outer_heights.resize(n_outer);
+  clipboard._outer_normals.resize(n_outer);
+  clipboard._outer_colors.resize(n_outer);
+  clipboard._inner_heights.resize(n_quads);
+  clipboard._inner_normals.resize(n_quads);
+  clipboard._inner_colors.resize(n_quads);
+  clipboard._quad_flags.resize(n_quads);
+  clipboard._quad_texturing.resize(n_quads);
+  clipboard._quad_liquids.resize(n_quads);
+
+  TileRange const tiles {region.x, region.y, region.x + region.width, region.y + region.height};
+
+  std::vector<TilePlacements> tile_placements(tiles.Size());
+  std::vector<std::vector<AssetReference>> tile_textures(tiles.Size());
+
+  Utils::Misc::ParallelFor(tiles.Size(), [&](std::size_t i)
+  {
+    auto tile = std::make_unique<RegionTile>();
+
+    if (!loader(tiles[i], *tile))
+      return;
+
+    clipboard.CopyTile(tiles[i], *tile, tile_placements[i]);
+    tile_textures[i] = std::move(tile->texturing.textures);
+  }, n_threads);
+
+  // tile-local references are merged in tile order, so that the result does not depend on scheduling
+  std::unordered_set<std::uint32_t> model_ids;
+  std::unordered_set<std::uint32_t> map_object_ids;
+
+  for (std::size_t i = 0; i < tiles.Size(); ++i)
+  {
+    auto const texture_mapping = MergeTable(clipboard._textures, tile_textures[i]);
+
+    std::uint32_t const x_begin = std::max<std::uint32_t>(tiles[i].x * N_QUADS_TILE_ROW, region.x);
+    std::uint32_t const y_begin = std::max<std::uint32_t>(tiles[i].y * N_QUADS_TILE_ROW, region.y);
+    std::uint32_t const x_end = std::min<std::uint32_t>((tiles[i].x + 1) * N_QUADS_TILE_ROW, region.x + region.width);
+    std::uint32_t const y_end = std::min<std::uint32_t>((tiles[i].y + 1) * N_QUADS_TILE_ROW, region.y + region.height);
+
+    for (std::uint32_t y = y_begin; y < y_end; ++y)
+    {
+      for (std::uint32_t x = x_begin; x < x_end; ++x)
+      {
+        QuadTexturing& quad = clipboard._quad_texturing[(y - region.y) * region.width + x - region.x];
+
+        for (unsigned layer = 0; layer < quad.n_layers; ++layer)
+        {
+          EnsureF(CCodeZones::FILE_IO, quad.layers[layer].textureId < texture_mapping.size()
+                  , "Texture layer references non-existing texture.");
+          quad.layers[layer].textureId = texture_mapping[quad.layers[layer].textureId];
+        }
+      }
+    }
+
+    // placements crossing tile borders are referenced by every tile they overlap
+    TilePlacements& placements = tile_placements[i];
+    auto const model_mapping = MergeTable(clipboard._models, placements.models);
+    auto const map_object_mapping = MergeTable(clipboard._map_objects, placements.map_objects);
+
+    for (MDDF placement : placements.model_placements)
+    {
+      if (!model_ids.insert(placement.unique_id).second)
+        continue;
+
+      placement.name_id = model_mapping[placement.name_id];
+      clipboard._model_placements.push_back(placement);
+    }
+
+    for (MODF placement : placements.map_object_placements)
+    {
+      if (!map_object_ids.insert(placement.unique_id).second)
+        continue;
+
+      placement.name_id = map_object_mapping[placement.name_id];
+      clipboard._map_object_placements.push_back(placement);
+    }
+  }
+
+  LogDebugF(LCodeZones::FILE_IO, "Copied %d textures, %d models, %d map objects."
+            , clipboard._textures.size(), clipboard._model_placements.size(), clipboard._map_object_placements.size());
+
+  return clipboard;
+}
+
+void RegionClipboard::CopyTile(TileIndex tile_index, RegionTile const& tile, TilePlacements& placements)
+{
+  std::uint32_t const region_x_end = _region.x + _region.width;
+  std::uint32_t const region_y_end = _region.y + _region.height;
+
+  for (unsigned i = 0; i < WorldConstants::CHUNKS_PER_TILE; ++i)
+  {
+    std::uint32_t const chunk_x = tile_index.x * N_QUADS_TILE_ROW + (i % 16) * N_QUADS_CHUNK_ROW;
+    std::uint32_t const chunk_y = tile_index.y * N_QUADS_TILE_ROW + (i / 16) * N_QUADS_CHUNK_ROW;
+
+    std::uint32_t const x_begin = std::max(chunk_x, _region.x);
+    std::uint32_t const y_begin = std::max(chunk_y, _region.y);
+    std::uint32_t const x_end = std::min(chunk_x + N_QUADS_CHUNK_ROW, region_x_end);
+    std::uint32_t const y_end = std::min(chunk_y + N_QUADS_CHUNK_ROW, region_y_end);
+
+    if (x_begin >= x_end || y_begin >= y_end)
+      continue;
+
+    ChunkTerrain const& terrain = tile.terrain[i];
+    ChunkTexturing const& texturing = tile.texturing.chunks[i];
+    auto const& liquid_layers = tile.liquids.chunks()[i].Layers();
+
+    EnsureF(CCodeZones::FILE_IO, texturing.layers.size() <= MAX_LAYERS
+                                 && texturing.alphamaps.size() + 1 >= texturing.layers.size()
+            , "Malformed chunk texturing.");
+
+    float const base_height = terrain.header.position.z;
+    std::uint64_t const holes = ChunkHoleMask(terrain.header);
+    std::uint8_t const hole_format = terrain.header.flags.high_res_holes ? 0 : QUAD_LOW_RES_HOLES;
+
+    std::vector<LiquidVertexValues> liquid_values;
+    liquid_values.reserve(liquid_layers.size());
+
+    for (LiquidLayer const& layer : liquid_layers)
+      liquid_values.push_back(LiquidFiller::LayerValues(layer));
+
+    for (std::uint32_t y = y_begin; y < y_end; ++y)
+    {
+      ShiftHeights(terrain.heightmap.data() + InnerVertex(x_begin - chunk_x, y - chunk_y)
+                   , _inner_heights.data() + std::size_t{y - _region.y} * _region.width + x_begin - _region.x
+                   , x_end - x_begin, base_height, 0.f);
+
+      for (std::uint32_t x = x_begin; x < x_end; ++x)
+      {
+        unsigned const quad_x = x - chunk_x;
+        unsigned const quad_y = y - chunk_y;
+        unsigned const quad_bit = quad_y * N_QUADS_CHUNK_ROW + quad_x;
+        std::size_t const quad = std::size_t{y - _region.y} * _region.width + x - _region.x;
+
+        _quad_flags[quad] = QUAD_PRESENT | hole_format | ((holes >> quad_bit) & 1 ? QUAD_HOLE : 0);
+
+        unsigned const inner = InnerVertex(quad_x, quad_y);
+        _inner_normals[quad] = terrain.normals[inner];
+        _inner_colors[quad] = terrain.vertex_colors[inner];
+
+        QuadTexturing& quad_texturing = _quad_texturing[quad];
+        quad_texturing.n_layers = static_cast<std::uint8_t>(texturing.layers.size());
+        std::copy(texturing.layers.begin(), texturing.layers.end(), quad_texturing.layers.begin());
+
+        for (unsigned layer = 1; layer < texturing.layers.size(); ++layer)
+        {
+          for (unsigned pixel_y = 0; pixel_y < N_PIXELS_QUAD_ROW; ++pixel_y)
+          {
+            auto const row = texturing.alphamaps[layer - 1].begin() + ChunkPixel(quad_x, quad_y, 0, pixel_y);
+            std::copy(row, row + N_PIXELS_QUAD_ROW
+                      , quad_texturing.weights[layer - 1].begin() + pixel_y * N_PIXELS_QUAD_ROW);
+          }
+        }
+
+        quad_texturing.shadow = 0;
+
+        for (unsigned pixel_y = 0; pixel_y < N_PIXELS_QUAD_ROW; ++pixel_y)
+        {
+          for (unsigned pixel_x = 0; pixel_x < N_PIXELS_QUAD_ROW; ++pixel_x)
+          {
+            if (texturing.shadowmap[ChunkPixel(quad_x, quad_y, pixel_x, pixel_y)])
+              quad_texturing.shadow |= std::uint64_t{1} << (pixel_y * N_PIXELS_QUAD_ROW + pixel_x);
+          }
+        }
+
+        QuadLiquid& quad_liquid = _quad_liquids[quad];
+        quad_liquid = QuadLiquid{};
+
+        for (std::size_t layer = 0; layer < liquid_layers.size(); ++layer)
+        {
+          if (!liquid_layers[layer].exists_map[quad_bit])
+            continue;
+
+          quad_liquid.liquid_type = liquid_layers[layer].liquid_type;
+
+          for (unsigned corner = 0; corner < 4; ++corner)
+          {
+            unsigned const vertex = (quad_y + corner / 2) * N_LIQUID_VERTICES_ROW + quad_x + corner % 2;
+            quad_liquid.heights[corner] = liquid_values[layer].heights[vertex];
+            quad_liquid.depths[corner] = static_cast<std::uint8_t>(liquid_values[layer].depths[vertex]);
+          }
+
+          break;
+        }
+      }
+    }
+
+    // a vertex is copied from the chunk owning the quad it is the top-left corner of,
+    // the last row and column of the region from the chunk owning the last quad
+    std::uint32_t const x_last = x_end == region_x_end ? x_end : x_end - 1;
+    std::uint32_t const y_last = y_end == region_y_end ? y_end : y_end - 1;
+
+    for (std::uint32_t y = y_begin; y <= y_last; ++y)
+    {
+      ShiftHeights(terrain.heightmap.data() + OuterVertex(x_begin - chunk_x, y - chunk_y)
+                   , _outer_heights.data() + std::size_t{y - _region.y} * (_region.width + 1) + x_begin - _region.x
+                   , x_last - x_begin + 1, base_height, 0.f);
+
+      for (std::uint32_t x = x_begin; x <= x_last; ++x)
+      {
+        std::size_t const vertex = std::size_t{y - _region.y} * (_region.width + 1) + x - _region.x;
+        unsigned const outer = OuterVertex(x - chunk_x, y - chunk_y);
+
+        _outer_normals[vertex] = terrain.normals[outer];
+        _outer_colors[vertex] = terrain.vertex_colors[outer];
+      }
+    }
+  }
+
+  // placements inside the region, stored relative to its origin with tile-local name IDs
+  float const origin_x = static_cast<float>(_region.x) * QUAD_SIZE;
+  float const origin_z = static_cast<float>(_region.y) * QUAD_SIZE;
+  float const end_x = static_cast<float>(region_x_end) * QUAD_SIZE;
+  float const end_z = static_cast<float>(region_y_end) * QUAD_SIZE;
+
+  auto const is_inside = [&](Common::DataStructures::C3Vector const& position)
+  {
+    return position.x >= origin_x && position.x < end_x && position.z >= origin_z && position.z < end_z;
+  };
+
+  auto const localize = [&](Common::DataStructures::C3Vector& position)
+  {
+    position.x -= origin_x;
+    position.z -= origin_z;
+  };
+
+  placements.models = tile.placements.models;
+  placements.map_objects = tile.placements.map_objects;
+
+  for (MDDF placement : tile.placements.model_placements)
+  {
+    if (!is_inside(placement.position))
+      continue;
+
+    if (placement.flags.use_filedata_id)
+    {
+      placement.name_id = FindOrAppend(placements.models, AssetReference{{}, placement.name_id});
+      placement.flags.use_filedata_id = 0;
+    }
+
+    EnsureF(CCodeZones::FILE_IO, placement.name_id < placements.models.size(), "Model placement references non-existing file.");
+
+    localize(placement.position);
+    placements.model_placements.push_back(placement);
+  }
+
+  for (MODF placement : tile.placements.map_object_placements)
+  {
+    if (!is_inside(placement.position))
+      continue;
+
+    if (placement.flags.use_filedata_id)
+    {
+      placement.name_id = FindOrAppend(placements.map_objects, AssetReference{{}, placement.name_id});
+      placement.flags.use_filedata_id = 0;
+    }
+
+    EnsureF(CCodeZones::FILE_IO, placement.name_id < placements.map_objects.size()
+            , "Map object placement references non-existing file.");
+
+    localize(placement.position);
+    localize(placement.extents.min);
+    localize(placement.extents.max);
+    placements.map_object_placements.push_back(placement);
+  }
+}
+
+std::size_t RegionClipboard::Paste(PasteParams const& params
+                                   , TileLoader const& loader
+                                   , TileConsumer const& consumer
+                                   , unsigned n_threads) const
+{
+  RequireF(CCodeZones::FILE_IO, _region.width && _region.height, "Clipboard is empty.");
+  RequireF(CCodeZones::FILE_IO, params.x < N_QUADS_MAP_ROW && _region.width <= N_QUADS_MAP_ROW - params.x
+                                && params.y < N_QUADS_MAP_ROW && _region.height <= N_QUADS_MAP_ROW - params.y
+           , "Paste destination out of map bounds.");
+  RequireF(CCodeZones::FILE_IO, !params.placements || params.first_unique_id != PasteParams::NO_UNIQUE_ID
+           , "First unique ID of pasted placements is not set.");
+  RequireF(CCodeZones::FILE_IO, !params.placements
+                                || (params.max_placements_per_tile
+                                    && std::uint64_t{params.first_unique_id}
+                                       + std::uint64_t{params.max_placements_per_tile} * WorldConstants::MAX_TILES_PER_MAP
+                                       <= std::uint64_t{0xFFFFFFFF} + 1)
+           , "Unique IDs of pasted placements do not fit into 32 bits.");
+
+  LogDebugF(LCodeZones::FILE_IO, "Pasting region of %dx%d quads.", _region.width, _region.height);
+
+  // border vertices of the region are shared with chunks past its last row and column
+  TileRange const tiles {params.x, params.y, params.x + _region.width + 1, params.y + _region.height + 1};
+
+  std::vector<std::vector<std::uint32_t>> model_rows(tiles.Size());
+  std::vector<std::vector<std::uint32_t>> map_object_rows(tiles.Size());
+
+  if (params.placements)
+  {
+    float const origin_x = static_cast<float>(params.x) * QUAD_SIZE;
+    float const origin_z = static_cast<float>(params.y) * QUAD_SIZE;
+
+    for (std::uint32_t row = 0; row < _model_placements.size(); ++row)
+    {
+      auto const& position = _model_placements[row].position;
+      model_rows[tiles.Slot(origin_x + position.x, origin_z + position.z)].push_back(row);
+    }
+
+    for (std::uint32_t row = 0; row < _map_object_placements.size(); ++row)
+    {
+      auto const& position = _map_object_placements[row].position;
+      map_object_rows[tiles.Slot(origin_x + position.x, origin_z + position.z)].push_back(row);
+    }
+  }
+
+  std::atomic<std::size_t> n_tiles = 0;
+  std::atomic<std::size_t> n_dropped = 0;
+
+  Utils::Misc::ParallelFor(tiles.Size(), [&](std::size_t i)
+  {
+    auto tile = std::make_unique<RegionTile>();
+
+    if (!loader(tiles[i], *tile))
+      return;
+
+    n_dropped += PasteTile(tiles[i], params, model_rows[i], map_object_rows[i], *tile);
+    consumer(tiles[i], *tile);
+    ++n_tiles;
+  }, n_threads);
+
+  LogDebugF(LCodeZones::FILE_IO, "Pasted region into %d tiles, dropped %d placements."
+            , n_tiles.load(), n_dropped.load());
+
+  return n_tiles;
+}
+
+std::size_t RegionClipboard::PasteTile(TileIndex tile_index
+                                       , PasteParams const& params
+                                       , std::span<std::uint32_t const> model_rows
+                                       , std::span<std::uint32_t const> map_object_rows
+                                       , RegionTile& tile) const
+{
+  std::uint32_t const region_x_end = params.x + _region.width;
+  std::uint32_t const region_y_end = params.y + _region.height;
+
+  for (unsigned i = 0; i < WorldConstants::CHUNKS_PER_TILE; ++i)
+  {
+    std::uint32_t const chunk_x = tile_index.x * N_QUADS_TILE_ROW + (i % 16) * N_QUADS_CHUNK_ROW;
+    std::uint32_t const chunk_y = tile_index.y * N_QUADS_TILE_ROW + (i / 16) * N_QUADS_CHUNK_ROW;
+
+    // vertices are inclusive of the region end, quads are not
+    std::uint32_t const x_begin = std::max(chunk_x, params.x);
+    std::uint32_t const y_begin = std::max(chunk_y, params.y);
+    std::uint32_t const x_last = std::min(chunk_x + N_QUADS_CHUNK_ROW, region_x_end);
+    std::uint32_t const y_last = std::min(chunk_y + N_QUADS_CHUNK_ROW, region_y_end);
+
+    if (x_begin > x_last || y_begin > y_last)
+      continue;
+
+    // pasted quads of the chunk, by quad bit
+    std::array<std::size_t, 64> sources;
+    std::uint64_t pasted = 0;
+
+    for (std::uint32_t y = y_begin; y < y_last; ++y)
+    {
+      for (std::uint32_t x = x_begin; x < x_last; ++x)
+      {
+        std::size_t const source = std::size_t{y - params.y} * _region.width + x - params.x;
+
+        if (!(_quad_flags[source] & QUAD_PRESENT))
+          continue;
+
+        unsigned const quad_bit = (y - chunk_y) * N_QUADS_CHUNK_ROW + x - chunk_x;
+        sources[quad_bit] = source;
+        pasted |= std::uint64_t{1} << quad_bit;
+      }
+    }
+
+    if (params.terrain)
+    {
+      ChunkTerrain& terrain = tile.terrain[i];
+      float const base_height = terrain.header.position.z;
+
+      for (std::uint32_t y = y_begin; y <= y_last; ++y)
+      {
+        std::array<float, WorldConstants::N_VERTS_CHUNK_ROW_OUTER> heights;
+        ShiftHeights(_outer_heights.data() + std::size_t{y - params.y} * (_region.width + 1) + x_begin - params.x
+                     , heights.data(), x_last - x_begin + 1, params.height_offset, base_height);
+
+        for (std::uint32_t x = x_begin; x <= x_last; ++x)
+        {
+          std::uint32_t const source_x = x - params.x;
+          std::uint32_t const source_y = y - params.y;
+
+          // vertices take presence from the quad they were copied from
+          std::size_t const owner = std::size_t{std::min(source_y, _region.height - 1)} * _region.width
+            + std::min(source_x, _region.width - 1);
+
+          if (!(_quad_flags[owner] & QUAD_PRESENT))
+            continue;
+
+          std::size_t const source = std::size_t{source_y} * (_region.width + 1) + source_x;
+          unsigned const outer = OuterVertex(x - chunk_x, y - chunk_y);
+
+          terrain.heightmap[outer] = heights[x - x_begin];
+          terrain.normals[outer] = _outer_normals[source];
+          terrain.vertex_colors[outer] = _outer_colors[source];
+        }
+      }
+
+      if (pasted)
+      {
+        // inner heights of the chunk, by quad bit
+        std::array<float, 64> heights;
+
+        for (std::uint32_t y = y_begin; y < y_last; ++y)
+        {
+          ShiftHeights(_inner_heights.data() + std::size_t{y - params.y} * _region.width + x_begin - params.x
+                       , heights.data() + (y - chunk_y) * N_QUADS_CHUNK_ROW + x_begin - chunk_x
+                       , x_last - x_begin, params.height_offset, base_height);
+        }
+
+        std::uint64_t holes = ChunkHoleMask(terrain.header);
+        bool low_res_sources = !terrain.header.flags.high_res_holes;
+
+        for (unsigned quad_bit = 0; quad_bit < 64; ++quad_bit)
+        {
+          if (!((pasted >> quad_bit) & 1))
+            continue;
+
+          std::size_t const source = sources[quad_bit];
+          unsigned const inner = InnerVertex(quad_bit % N_QUADS_CHUNK_ROW, quad_bit / N_QUADS_CHUNK_ROW);
+
+          terrain.heightmap[inner] = heights[quad_bit];
+          terrain.normals[inner] = _inner_normals[source];
+          terrain.vertex_colors[inner] = _inner_colors[source];
+
+          holes &= ~(std::uint64_t{1} << quad_bit);
+          low_res_sources &= (_quad_flags[source] & QUAD_LOW_RES_HOLES) != 0;
+
+          if (_quad_flags[source] & QUAD_HOLE)
+            holes |= std::uint64_t{1} << quad_bit;
+        }
+
+        // low resolution holes are kept where clients need them or sources used them, see Paste()
+        if (params.client_version < Common::ClientVersion::MOP
+            || (low_res_sources && HighResToLowResHoles(holes, true) == HighResToLowResHoles(holes, false)))
+        {
+          terrain.header.flags.high_res_holes = 0;
+          terrain.header.holes_low_res = HighResToLowResHoles(holes, true);
+        }
+        else
+        {
+          terrain.header.flags.high_res_holes = 1;
+          terrain.header.holes_high_res = holes;
+        }
+      }
+    }
+
+    if (!pasted)
+      continue;
+
+    if (params.texturing)
+    {
+      std::array<QuadTexturing const*, 64> quads {};
+
+      for (unsigned quad_bit = 0; quad_bit < 64; ++quad_bit)
+      {
+        if ((pasted >> quad_bit) & 1)
+          quads[quad_bit] = &_quad_texturing[sources[quad_bit]];
+      }
+
+      PasteChunkTexturing(tile.texturing.chunks[i], tile.texturing.textures, _textures, quads);
+    }
+
+    if (params.liquids)
+    {
+      LiquidChunk& chunk = tile.liquids.chunks()[i];
+      LiquidFiller::RemoveQuads(chunk, pasted);
+
+      // pasted quads grouped by liquid type
+      std::uint64_t remaining = pasted;
+
+      while (remaining)
+      {
+        std::uint16_t const liquid_type = _quad_liquids[sources[std::countr_zero(remaining)]].liquid_type;
+        std::uint64_t quads = 0;
+        LiquidVertexValues values;
+
+        for (unsigned quad_bit = 0; quad_bit < 64; ++quad_bit)
+        {
+          if (!((remaining >> quad_bit) & 1))
+            continue;
+
+          QuadLiquid const& liquid = _quad_liquids[sources[quad_bit]];
+
+          if (liquid.liquid_type != liquid_type)
+            continue;
+
+          quads |= std::uint64_t{1} << quad_bit;
+
+          for (unsigned corner = 0; corner < 4; ++corner)
+          {
+            unsigned const vertex = (quad_bit / N_QUADS_CHUNK_ROW + corner / 2) * N_LIQUID_VERTICES_ROW
+              + quad_bit % N_QUADS_CHUNK_ROW + corner % 2;
+
+            values.heights[vertex] = liquid.heights[corner] + params.height_offset;
+            values.depths[vertex] = static_cast<char>(liquid.depths[corner]);
+          }
+        }
+
+        remaining &= ~quads;
+
+        if (liquid_type)
+          LiquidFiller::MergeQuads(chunk, liquid_type, quads, values, false);
+      }
+    }
+  }
+
+  if (params.liquids
+      && std::any_of(tile.liquids.chunks().begin(), tile.liquids.chunks().end()
+                     , [](LiquidChunk const& chunk) { return !chunk.Layers().empty(); }))
+  {
+    tile.liquids.Initialize();
+  }
+
+  // textures appended to the table have neither height texture nor parameters, only loaded ones are kept aligned
+  if (!tile.texturing.height_textures.empty())
+    tile.texturing.height_textures.resize(tile.texturing.textures.size(), 0);
+
+  if (!tile.texturing.texture_params.empty())
+    tile.texturing.texture_params.resize(tile.texturing.textures.size(), {{}, 0.f, 1.f, 0});
+
+  float const origin_x = static_cast<float>(params.x) * QUAD_SIZE;
+  float const origin_z = static_cast<float>(params.y) * QUAD_SIZE;
+
+  auto const globalize = [&](Common::DataStructures::C3Vector& position)
+  {
+    position.x += origin_x;
+    position.y += params.height_offset;
+    position.z += origin_z;
+  };
+
+  // files known by path go to the tile's tables, the others are referenced by FileDataID directly
+  auto const resolve = [](auto& placement, AssetReference const& asset, std::vector<AssetReference>& table)
+  {
+    placement.flags.use_filedata_id = asset.path.empty();
+    placement.name_id = asset.path.empty() ? asset.file_data_id : FindOrAppend(table, asset);
+  };
+
+  if (model_rows.empty() && map_object_rows.empty())
+    return 0;
+
+  // the range of the last tile may end right past the largest 32-bit ID
+  std::uint64_t const first_unique_id = std::uint64_t{params.first_unique_id}
+    + std::uint64_t{tile_index.y * 64u + tile_index.x} * params.max_placements_per_tile;
+  std::uint64_t const end_unique_id = first_unique_id + params.max_placements_per_tile;
+
+  // IDs of the range already taken, e.g. by an earlier paste into the same tile, are skipped
+  std::vector<std::uint32_t> used_unique_ids;
+
+  auto const collect_used = [&](std::uint32_t unique_id)
+  {
+    if (unique_id >= first_unique_id && unique_id < end_unique_id)
+      used_unique_ids.push_back(unique_id);
+  };
+
+  for (MDDF const& placement : tile.placements.model_placements)
+    collect_used(placement.unique_id);
+
+  for (MODF const& placement : tile.placements.map_object_placements)
+    collect_used(placement.unique_id);
+
+  std::sort(used_unique_ids.begin(), used_unique_ids.end());
+  std::uint64_t next_unique_id = first_unique_id;
+  std::size_t n_dropped = 0;
+
+  auto const assign_unique_id = [&](auto& placement)
+  {
+    while (next_unique_id < end_unique_id
+           && std::binary_search(used_unique_ids.begin(), used_unique_ids.end(), next_unique_id))
+    {
+      ++next_unique_id;
+    }
+
+    if (next_unique_id == end_unique_id)
+    {
+      ++n_dropped;
+      return false;
+    }
+
+    placement.unique_id = static_cast<std::uint32_t>(next_unique_id++);
+    return true;
+  };
+
+  for (std::uint32_t row : model_rows)
+  {
+    MDDF placement = _model_placements[row];
+
+    if (!assign_unique_id(placement))
+      continue;
+
+    resolve(placement, _models[placement.name_id], tile.placements.models);
+    globalize(placement.position);
+    tile.placements.model_placements.push_back(placement);
+  }
+
+  for (std::uint32_t row : map_object_rows)
+  {
+    MODF placement = _map_object_placements[row];
+
+    if (!assign_unique_id(placement))
+      continue;
+
+    resolve(placement, _map_objects[placement.name_id], tile.placements.map_objects);
+    globalize(placement.position);
+    globalize(placement.extents.min);
+    globalize(placement.extents.max);
+    tile.placements.map_object_placements.push_back(placement);
+  }
+
+  return n_dropped;
+}
+
+void RegionClipboard::Read(ByteBuffer const& buf)
+{
+  EnsureF(CCodeZones::FILE_IO, buf.Read<std::uint32_t>() == CLIPBOARD_MAGIC, "Not a region clipboard.");
+  EnsureF(CCodeZones::FILE_IO, buf.Read<std::uint32_t>() == CLIPBOARD_VERSION, "Unsupported region clipboard version.");
+
+  buf.Read(_region);
+
+  EnsureF(CCodeZones::FILE_IO, _region.width && _region.height
+                               && _region.width <= N_QUADS_MAP_ROW && _region.height <= N_QUADS_MAP_ROW
+          , "Malformed region clipboard.");
+
+  std::size_t const n_quads = std::size_t{_region.width} * _region.height;
+  std::size_t const n_outer = std::size_t{_region.width + 1} * (_region.height + 1);
+
+  ReadTable(buf, _textures);
+  ReadTable(buf, _models);
+  ReadTable(buf, _map_objects);
+
+  _outer_heights.resize(n_outer);
+  _outer_normals.resize(n_outer);
+  _outer_colors.resize(n_outer);
+  _inner_heights.resize(n_quads);
+  _inner_normals.resize(n_quads);
+  _inner_colors.resize(n_quads);
+  _quad_flags.resize(n_quads);
+
+  buf.Read(_outer_heights.begin(), _outer_heights.end());
+  buf.Read(_outer_normals.begin(), _outer_normals.end());
+  buf.Read(_outer_colors.begin(), _outer_colors.end());
+  buf.Read(_inner_heights.begin(), _inner_heights.end());
+  buf.Read(_inner_normals.begin(), _inner_normals.end());
+  buf.Read(_inner_colors.begin(), _inner_colors.end());
+  buf.Read(_quad_flags.begin(), _quad_flags.end());
+
+  // only layers and weights in use are stored
+  _quad_texturing.assign(n_quads, QuadTexturing{});
+
+  for (QuadTexturing& quad : _quad_texturing)
+  {
+    quad.n_layers = buf.Read<std::uint8_t>();
+    EnsureF(CCodeZones::FILE_IO, quad.n_layers <= MAX_LAYERS, "Malformed region clipboard.");
+
+    buf.Read(quad.layers.begin(), quad.layers.begin() + quad.n_layers);
+
+    for (unsigned layer = 1; layer < quad.n_layers; ++layer)
+      buf.Read(quad.weights[layer - 1]);
+
+    buf.Read(quad.shadow);
+
+    EnsureF(CCodeZones::FILE_IO, std::all_of(quad.layers.begin(), quad.layers.begin() + quad.n_layers
+                                             , [this](SMLayer const& layer) { return layer.textureId < _textures.size(); })
+            , "Quad texturing references non-existing texture.");
+  }
+
+  _quad_liquids.assign(n_quads, QuadLiquid{});
+
+  for (QuadLiquid& quad : _quad_liquids)
+  {
+    quad.liquid_type = buf.Read<std::uint16_t>();
+
+    if (!quad.liquid_type)
+      continue;
+
+    buf.Read(quad.heights);
+    buf.Read(quad.depths);
+  }
+
+  ReadArray(buf, _model_placements);
+  ReadArray(buf, _map_object_placements);
+
+  EnsureF(CCodeZones::FILE_IO, std::all_of(_model_placements.begin(), _model_placements.end()
+                                           , [this](MDDF const& placement) { return placement.name_id < _models.size(); })
+                               && std::all_of(_map_object_placements.begin(), _map_object_placements.end()
+                                              , [this](MODF const& placement)
+                                                { return placement.name_id < _map_objects.size(); })
+          , "Placement references non-existing file.");
+}
+
+void RegionClipboard::Write(ByteBuffer& buf) const
+{
+  // assembled in memory first, as buffer grows on every write
+  std::vector<char> out;
+
+  AppendBytes(out, CLIPBOARD_MAGIC);
+  AppendBytes(out, CLIPBOARD_VERSION);
+  AppendBytes(out, _region);
+
+  AppendTable(out, _textures);
+  AppendTable(out, _models);
+  AppendTable(out, _map_objects);
+
+  AppendArray(out, _outer_heights);
+  AppendArray(out, _outer_normals);
+  AppendArray(out, _outer_colors);
+  AppendArray(out, _inner_heights);
+  AppendArray(out, _inner_normals);
+  AppendArray(out, _inner_colors);
+  AppendArray(out, _quad_flags);
+
+  for (QuadTexturing const& quad : _quad_texturing)
+  {
+    AppendBytes(out, quad.n_layers);
+
+    for (unsigned layer = 0; layer < quad.n_layers; ++layer)
+      AppendBytes(out, quad.layers[layer]);
+
+    for (unsigned layer = 1; layer < quad.n_layers; ++layer)
+      AppendBytes(out, quad.weights[layer - 1]);
+
+    AppendBytes(out, quad.shadow);
+  }
+
+  for (QuadLiquid const& quad : _quad_liquids)
+  {
+    AppendBytes(out, quad.liquid_type);
+
+    if (!quad.liquid_type)
+      continue;
+
+    AppendBytes(out, quad.heights);
+    AppendBytes(out, quad.depths);
+  }
+
+  AppendBytes(out, static_cast<std::uint32_t>(_model_placements.size()));
+  AppendArray(out, _model_placements);
+  AppendBytes(out, static_cast<std::uint32_t>(_map_object_placements.size()));
+  AppendArray(out, _map_object_placements);
+
+  buf.Write(out.begin(), out.end());
+}
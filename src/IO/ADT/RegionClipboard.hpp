@@ -0,0 +1,236 @@
+#pragma once
+#include <IO/ByteBuffer.hpp>
+#include <IO/Common.hpp>
+#include <IO/CommonDataStructures.hpp>
+#include <IO/WorldConstants.hpp>
+#include <IO/ADT/DataStructures.hpp>
+#include <IO/ADT/TileData.hpp>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace IO::ADT
+{
+  /**
+   * Rectangle of the map-wide quad grid. Each chunk has 8x8 quads, so a map row has 64 * 16 * 8 quads.
+   * Columns advance along placement x, rows along placement z.
+   */
+  struct QuadRegion
+  {
+    std::uint32_t x; ///> First column.
+    std::uint32_t y; ///> First row.
+    std::uint32_t width; ///> Number of columns.
+    std::uint32_t height; ///> Number of rows.
+  };
+
+  /**
+   * Controls where and what RegionClipboard::Paste() writes.
+   */
+  struct PasteParams
+  {
+    std::uint32_t x; ///> Column of the map-wide quad grid the region origin is pasted to.
+    std::uint32_t y; ///> Row of the map-wide quad grid the region origin is pasted to.
+    float height_offset = 0.f; ///> Added to terrain heights, liquid heights and placement positions.
+
+    /**
+     * Required if placements are pasted. Placements pasted into tile (x, y) get unique IDs from
+     * [first_unique_id + (y * 64 + x) * max_placements_per_tile, + max_placements_per_tile), skipping IDs the
+     * destination tile already uses. Must lie above every unique ID used by the map, as only IDs of the range
+     * taken by the tile itself are skipped.
+     */
+    std::uint32_t first_unique_id = NO_UNIQUE_ID;
+    std::uint32_t max_placements_per_tile = 16384; ///> Placements beyond are dropped.
+
+    bool terrain = true; ///> Heights, normals, vertex colors and holes.
+    bool texturing = true; ///> Texture layers, alpha maps and shadows.
+    bool liquids = true; ///> MH2O instances.
+    bool placements = true; ///> Models and map objects positioned inside the region.
+
+    /**
+     * Client the destination tiles are written for. Clients before MoP only know 4x4 low resolution holes.
+     */
+    Common::ClientVersion client_version = Common::ClientVersion::ANY;
+
+    static constexpr std::uint32_t NO_UNIQUE_ID = std::numeric_limits<std::uint32_t>::max();
+  };
+
+  /**
+   * Copies a rectangular region of a map, crossing chunk and tile borders, and pastes it elsewhere on the same
+   * or another map.
+   *
+   * The region is aligned to the quad grid all per-vertex and per-pixel data of chunks share: terrain vertices,
+   * liquid vertices, 8x8 alpha and shadow pixels and hole bits of each quad map one-to-one to the destination,
+   * so pasting only rebuckets quads into destination chunks and never interpolates.
+   *
+   * Terrain heights are stored absolute. Border vertices of the region are written to every chunk sharing them,
+   * which keeps pasted terrain continuous with its new surroundings. Texture layers are merged per destination
+   * chunk: when more than four textures compete, the ones with least total weight are dropped and alpha
+   * renormalized. Each quad keeps a single liquid instance (the first layer covering it), without texture
+   * coordinates. Placements are stored relative to the region origin, file references are remapped into the
+   * destination tiles' tables and unique IDs are reassigned.
+   *
+   * Tiles are loaded, processed and stored in parallel; only the tiles overlapping the region are touched.
+   */
+  class RegionClipboard
+  {
+  public:
+    /**
+     * Loads a tile. Invoked concurrently from worker threads, must be thread-safe.
+     * Must match signature: bool(Common::DataStructures::TileIndex tile_index, RegionTile& tile).
+     * Returns false if tile does not exist. Quads of missing tiles are neither copied nor pasted.
+     */
+    using TileLoader = std::function<bool(Common::DataStructures::TileIndex, RegionTile&)>;
+
+    /**
+     * Receives a tile after pasting. Invoked concurrently from worker threads for distinct tiles.
+     * Must match signature: void(Common::DataStructures::TileIndex tile_index, RegionTile const& tile).
+     */
+    using TileConsumer = std::function<void(Common::DataStructures::TileIndex, RegionTile const&)>;
+
+    /**
+     * Quad state flags.
+     */
+    enum QuadFlags : std::uint8_t
+    {
+      QUAD_PRESENT = 0x1, ///> Quad belongs to an existing tile.
+      QUAD_HOLE = 0x2, ///> Quad is a terrain hole.
+      QUAD_LOW_RES_HOLES = 0x4 ///> Holes of the source chunk were stored as 4x4 low resolution holes.
+    };
+
+    /**
+     * Texturing of one quad: up to four layers and the 8x8 alpha and shadow pixels it covers.
+     */
+    struct QuadTexturing
+    {
+      std::array<DataStructures::SMLayer, 4> layers; ///> textureId indexes Textures(). offsetInMCAL is unused.
+      std::array<std::array<std::uint8_t, 64>, 3> weights; ///> Highres weights of layers 1..3, pixel (y * 8 + x).
+      std::uint64_t shadow; ///> Bit (y * 8 + x) set for shadowed pixels.
+      std::uint8_t n_layers;
+    };
+
+    /**
+     * Liquid of one quad. Corners are ordered (0, 0), (1, 0), (0, 1), (1, 1).
+     */
+    struct QuadLiquid
+    {
+      std::uint16_t liquid_type; ///> LiquidType.db2 record, 0 if the quad has no liquid.
+      std::array<float, 4> heights; ///> Absolute heights of corners.
+      std::array<std::uint8_t, 4> depths; ///> Depth of corners.
+    };
+
+    RegionClipboard() = default;
+
+    /**
+     * Copies a region of a map.
+     * @param region Region to copy.
+     * @param loader Tile loader callback.
+     * @param n_threads Number of worker threads. 0 means hardware concurrency.
+     * @return Clipboard holding the region.
+     */
+    [[nodiscard]]
+    static RegionClipboard Copy(QuadRegion const& region, TileLoader const& loader, unsigned n_threads = 0);
+
+    /**
+     * Pastes the region, overwriting data of destination quads. Placements are added to existing ones.
+     *
+     * Holes keep the 4x4 low resolution format if the client predates MoP, or if the destination chunk and all
+     * quads pasted into it use it and the pasted holes align to its 2x2 quad cells. Otherwise the chunk switches
+     * to 8x8 high resolution holes. Clients before MoP cannot store unaligned holes, so a cell becomes a hole
+     * if any of its quads is one.
+     *
+     * Chunk references of placements (MCRD, MCRW) are not part of RegionTile and are not updated. When storing
+     * obj0 ADTs of modified tiles, rebuild them with ChunkReferenceBuilder::BuildTiles().
+     * @param params Destination and data to paste.
+     * @param loader Tile loader callback providing destination tiles.
+     * @param consumer Callback receiving modified tiles.
+     * @param n_threads Number of worker threads. 0 means hardware concurrency.
+     * @return Number of tiles modified.
+     */
+    std::size_t Paste(PasteParams const& params
+                      , TileLoader const& loader
+                      , TileConsumer const& consumer
+                      , unsigned n_threads = 0) const;
+
+    /**
+     * Reads clipboard contents previously written with Write().
+     * @param buf Buffer to read from.
+     */
+    void Read(Common::ByteBuffer const& buf);
+
+    /**
+     * Writes clipboard contents in a compact binary form, suitable for storing on disk or exchanging between
+     * processes.
+     * @param buf Buffer to write to.
+     */
+    void Write(Common::ByteBuffer& buf) const;
+
+    [[nodiscard]]
+    QuadRegion const& Region() const { return _region; };
+
+    [[nodiscard]]
+    std::vector<AssetReference> const& Textures() const { return _textures; };
+
+    [[nodiscard]]
+    std::vector<AssetReference> const& Models() const { return _models; };
+
+    [[nodiscard]]
+    std::vector<AssetReference> const& MapObjects() const { return _map_objects; };
+
+    /**
+     * Model placements with name_id indexing Models() and position relative to the region origin.
+     */
+    [[nodiscard]]
+    std::vector<DataStructures::MDDF> const& ModelPlacements() const { return _model_placements; };
+
+    /**
+     * Map object placements with name_id indexing MapObjects() and position and extents relative
+     * to the region origin.
+     */
+    [[nodiscard]]
+    std::vector<DataStructures::MODF> const& MapObjectPlacements() const { return _map_object_placements; };
+
+  private:
+    /**
+     * Copies the part of the region covered by a tile. Quads get tile-local texture indices, placements
+     * tile-local name IDs, both remapped by Copy() once all tiles are done.
+     */
+    void CopyTile(Common::DataStructures::TileIndex tile_index
+                  , RegionTile const& tile
+                  , TilePlacements& placements);
+
+    /**
+     * Pastes the part of the region covered by a tile, along with the placements it owns.
+     * @return Number of placements dropped for exceeding PasteParams::max_placements_per_tile.
+     */
+    std::size_t PasteTile(Common::DataStructures::TileIndex tile_index
+                          , PasteParams const& params
+                          , std::span<std::uint32_t const> model_rows
+                          , std::span<std::uint32_t const> map_object_rows
+                          , RegionTile& tile) const;
+
+    QuadRegion _region {};
+
+    // (width + 1) * (height + 1) outer vertices and width * height inner vertices, row-major
+    std::vector<float> _outer_heights;
+    std::vector<float> _inner_heights;
+    std::vector<DataStructures::MCNREntry> _outer_normals;
+    std::vector<DataStructures::MCNREntry> _inner_normals;
+    std::vector<DataStructures::MCCVEntry> _outer_colors;
+    std::vector<DataStructures::MCCVEntry> _inner_colors;
+
+    // width * height quads, row-major
+    std::vector<std::uint8_t> _quad_flags;
+    std::vector<QuadTexturing> _quad_texturing;
+    std::vector<QuadLiquid> _quad_liquids;
+
+    std::vector<AssetReference> _textures;
+    std::vector<AssetReference> _models;
+    std::vector<AssetReference> _map_objects;
+    std::vector<DataStructures::MDDF> _model_placements;
+    std::vector<DataStructures::MODF> _map_object_placements;
+  };
+}
@@ -5,6 +5,7 @@
 #include <IO/ADT/DataStructures.hpp>
 #include <IO/ADT/Root/ADTRootMCNK.hpp>
 #include <IO/ADT/Root/MH2O.hpp>
+#include <Utils/Misc/ForceInline.hpp>
 
 #include <array>
 #include <cstdint>
@@ -32,6 +33,15 @@ namespace IO::ADT
     Common::DataArrayChunk<DataStructures::MBNV, ChunkIdentifiers::ADTRootChunks::MBNV> _blend_mesh_vertices;
     Common::DataArrayChunk<std::uint16_t, ChunkIdentifiers::ADTRootChunks::MBMI> _blend_mesh_indices;
 
+  // getters
+  public:
+    [[nodiscard]] FORCEINLINE auto& BlendMeshHeaders() { return _blend_mesh_headers; };
+    [[nodiscard]] FORCEINLINE auto const& BlendMeshHeaders() const { return _blend_mesh_headers; };
+    [[nodiscard]] FORCEINLINE auto& BlendMeshBoundingBoxes() { return _blend_mesh_bounding_boxes; };
+    [[nodiscard]] FORCEINLINE auto const& BlendMeshBoundingBoxes() const { return _blend_mesh_bounding_boxes; };
+    [[nodiscard]] FORCEINLINE auto& BlendMeshVertices() { return _blend_mesh_vertices; };
+    [[nodiscard]] FORCEINLINE auto const& BlendMeshVertices() const { return _blend_mesh_vertices; };
+
   private:
 
     static constexpr
@@ -197,6 +207,10 @@ namespace IO::ADT
       , details::ADTRootWriteContext
    > _auto_trait {};
 
+  // getters
+  public:
+    [[nodiscard]] FORCEINLINE auto& Chunks() { return _chunks; };
+    [[nodiscard]] FORCEINLINE auto const& Chunks() const { return _chunks; };
   };
 
 }
@@ -6,6 +6,7 @@
 #include <IO/WorldConstants.hpp>
 #include <IO/Common.hpp>
 #include <IO/CommonTraits.hpp>
+#include <Utils/Misc/ForceInline.hpp>
 
 #include <concepts>
 
@@ -135,6 +136,22 @@ namespace IO::ADT
       , WriteContext
     > _auto_trait{};
 
+  // getters
+  public:
+    [[nodiscard]] FORCEINLINE auto& Header() { return _header; };
+    [[nodiscard]] FORCEINLINE auto const& Header() const { return _header; };
+
+    [[nodiscard]] FORCEINLINE auto& Heightmap() { return _heightmap; };
+    [[nodiscard]] FORCEINLINE auto const& Heightmap() const { return _heightmap; };
+
+    [[nodiscard]] FORCEINLINE auto& Normals() { return _normals; };
+    [[nodiscard]] FORCEINLINE auto const& Normals() const { return _normals; };
+
+    [[nodiscard]] FORCEINLINE auto& VertexColors() { return _vertex_color; };
+    [[nodiscard]] FORCEINLINE auto const& VertexColors() const { return _vertex_color; };
+
+    [[nodiscard]] FORCEINLINE auto& SoundEmitters() { return _sound_emitters; };
+    [[nodiscard]] FORCEINLINE auto const& SoundEmitters() const { return _sound_emitters; };
   };
 }
 
@@ -0,0 +1,445 @@
+#include <IO/ADT/Root/LiquidFiller.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <memory>
+
+using namespace IO::ADT;
+using namespace IO::Common;
+
+namespace
+{
+  using IO::Common::DataStructures::C3Vector;
+  using IO::Common::DataStructures::TileIndex;
+
+  constexpr unsigned N_QUADS_CHUNK_ROW = 8;
+  constexpr unsigned N_LIQUID_VERTICES_ROW = N_QUADS_CHUNK_ROW + 1;
+  constexpr unsigned N_LIQUID_VERTICES = N_LIQUID_VERTICES_ROW * N_LIQUID_VERTICES_ROW;
+
+  // MCVT rows alternate 9 outer and 8 inner vertices
+  constexpr unsigned MCVT_ROW_STRIDE = WorldConstants::N_VERTS_CHUNK_ROW_OUTER + WorldConstants::N_VERTS_CHUNK_ROW_INNER;
+
+  constexpr unsigned N_QUADS_TILE_ROW = N_QUADS_CHUNK_ROW * 16;
+  constexpr unsigned N_QUADS_MAP_ROW = N_QUADS_TILE_ROW * 64;
+  constexpr float QUAD_SIZE = WorldConstants::CHUNK_SIZE / N_QUADS_CHUNK_ROW;
+
+  // depth is stored in yards, saturating
+  constexpr float MAX_DEPTH = 255.f;
+
+  /**
+   * Vertices used by a set of quads, bit (y * 9 + x) for vertex (x, y).
+   */
+  std::bitset<N_LIQUID_VERTICES> QuadVertices(std::uint64_t quads)
+  {
+    std::bitset<N_LIQUID_VERTICES> vertices;
+
+    for (; quads; quads &= quads - 1)
+    {
+      unsigned const quad = static_cast<unsigned>(std::countr_zero(quads));
+      unsigned const vertex = (quad / N_QUADS_CHUNK_ROW) * N_LIQUID_VERTICES_ROW + quad % N_QUADS_CHUNK_ROW;
+
+      vertices.set(vertex);
+      vertices.set(vertex + 1);
+      vertices.set(vertex + N_LIQUID_VERTICES_ROW);
+      vertices.set(vertex + N_LIQUID_VERTICES_ROW + 1);
+    }
+
+    return vertices;
+  }
+
+  /**
+   * Zeroes vertices not used by quads of the layer, so that output does not depend on stale data,
+   * and sets the height range of the layer from the used ones.
+   */
+  void TrimVertices(LiquidVertexValues& vertices, LiquidLayer& layer)
+  {
+    auto const used_vertices = QuadVertices(layer.exists_map.to_ullong());
+    float min_height = std::numeric_limits<float>::max();
+    float max_height = std::numeric_limits<float>::lowest();
+
+    for (unsigned vertex = 0; vertex < N_LIQUID_VERTICES; ++vertex)
+    {
+      if (!used_vertices[vertex])
+      {
+        vertices.heights[vertex] = 0.f;
+        vertices.depths[vertex] = 0;
+        vertices.uvs[vertex] = {};
+        continue;
+      }
+
+      min_height = std::min(min_height, vertices.heights[vertex]);
+      max_height = std::max(max_height, vertices.heights[vertex]);
+    }
+
+    layer.min_height_level = min_height;
+    layer.max_height_level = max_height;
+  }
+
+  void StoreVertices(LiquidVertexValues const& vertices, LiquidLayer& layer)
+  {
+    switch (layer.liquid_vertex_format)
+    {
+      case LiquidLayer::LiquidVertexFormat::HEIGHT_DEPTH:
+        layer.vertex_data = IO::ADT::DataStructures::MH2OHeightDepth{vertices.heights, vertices.depths};
+        break;
+      case LiquidLayer::LiquidVertexFormat::HEIGHT_TEXCOORD:
+        layer.vertex_data = IO::ADT::DataStructures::MH2OHeightTexCoord{vertices.heights, vertices.uvs};
+        break;
+      case LiquidLayer::LiquidVertexFormat::DEPTH:
+        layer.vertex_data = IO::ADT::DataStructures::MH2ODepth{vertices.depths};
+        break;
+      case LiquidLayer::LiquidVertexFormat::HEIGHT_DEPTH_TEXCOORD:
+        layer.vertex_data = IO::ADT::DataStructures::MH2OHeightDepthTexCoord{vertices.heights, vertices.uvs
+                                                                              , vertices.depths};
+        break;
+    }
+
+    layer.has_vertex_data = true;
+  }
+
+  /**
+   * Global liquid quad grid of the map, used to flood across tiles.
+   */
+  struct RegionGrid
+  {
+    std::array<std::int32_t, 64 * 64> slots; ///> Index into region tiles, -1 if tile is not part of region.
+    std::vector<TileLiquidMask> const& submerged;
+    std::vector<TileLiquidMask>& fill;
+
+    /**
+     * Marks a quad filled if it is submerged and not yet filled.
+     * @return True if quad was filled.
+     */
+    bool TryFill(unsigned x, unsigned y)
+    {
+      std::int32_t const slot = slots[(y / N_QUADS_TILE_ROW) * 64 + x / N_QUADS_TILE_ROW];
+
+      if (slot < 0)
+        return false;
+
+      unsigned const chunk = ((y % N_QUADS_TILE_ROW) / N_QUADS_CHUNK_ROW) * 16 + (x % N_QUADS_TILE_ROW) / N_QUADS_CHUNK_ROW;
+      std::uint64_t const bit = std::uint64_t{1} << ((y % N_QUADS_CHUNK_ROW) * N_QUADS_CHUNK_ROW + x % N_QUADS_CHUNK_ROW);
+
+      std::uint64_t& fill_mask = fill[slot][chunk];
+
+      if (!(submerged[slot][chunk] & bit) || (fill_mask & bit))
+        return false;
+
+      fill_mask |= bit;
+      return true;
+    }
+  };
+
+  void FloodFill(RegionGrid& grid, std::vector<C3Vector> const& seeds)
+  {
+    std::vector<std::uint32_t> stack;
+
+    auto const visit = [&](unsigned x, unsigned y)
+    {
+      if (grid.TryFill(x, y))
+        stack.push_back(y * N_QUADS_MAP_ROW + x);
+    };
+
+    for (C3Vector const& seed : seeds)
+    {
+      float const x = std::floor(seed.x / QUAD_SIZE);
+      float const y = std::floor(seed.z / QUAD_SIZE);
+
+      if (x < 0.f || y < 0.f || x >= N_QUADS_MAP_ROW || y >= N_QUADS_MAP_ROW)
+        continue;
+
+      visit(static_cast<unsigned>(x), static_cast<unsigned>(y));
+    }
+
+    while (!stack.empty())
+    {
+      unsigned const x = stack.back() % N_QUADS_MAP_ROW;
+      unsigned const y = stack.back() / N_QUADS_MAP_ROW;
+      stack.pop_back();
+
+      if (x > 0)
+        visit(x - 1, y);
+      if (x + 1 < N_QUADS_MAP_ROW)
+        visit(x + 1, y);
+      if (y > 0)
+        visit(x, y - 1);
+      if (y + 1 < N_QUADS_MAP_ROW)
+        visit(x, y + 1);
+    }
+  }
+}
+
+TileLiquidMask LiquidFiller::SubmergedQuads(TileTerrain const& terrain, float level)
+{
+  TileLiquidMask submerged {};
+
+  for (std::size_t i = 0; i < terrain.size(); ++i)
+  {
+    ChunkTerrain const& chunk = terrain[i];
+    float const relative_level = level - chunk.header.position.z;
+
+    std::array<std::uint8_t, WorldConstants::CHUNK_BUF_SIZE> below;
+
+    for (std::size_t j = 0; j < below.size(); ++j)
+      below[j] = chunk.heightmap[j] < relative_level;
+
+    std::uint64_t mask = 0;
+
+    for (unsigned y = 0; y < N_QUADS_CHUNK_ROW; ++y)
+    {
+      for (unsigned x = 0; x < N_QUADS_CHUNK_ROW; ++x)
+      {
+        unsigned const outer = y * MCVT_ROW_STRIDE + x;
+        unsigned const inner = outer + WorldConstants::N_VERTS_CHUNK_ROW_OUTER;
+
+        std::uint64_t const is_submerged = below[outer] | below[outer + 1] | below[inner]
+          | below[outer + MCVT_ROW_STRIDE] | below[outer + MCVT_ROW_STRIDE + 1];
+
+        mask |= is_submerged << (y * N_QUADS_CHUNK_ROW + x);
+      }
+    }
+
+    submerged[i] = mask;
+  }
+
+  return submerged;
+}
+
+void LiquidFiller::ApplyFill(TileIndex tile_index
+                             , TileTerrain const& terrain
+                             , TileLiquidMask const& fill
+                             , LiquidFillParams const& params
+                             , MH2O& liquids)
+{
+  for (std::size_t i = 0; i < fill.size(); ++i)
+  {
+    if (!fill[i])
+      continue;
+
+    ChunkTerrain const& chunk = terrain[i];
+    unsigned const chunk_x = static_cast<unsigned>(i % 16);
+    unsigned const chunk_y = static_cast<unsigned>(i / 16);
+    auto const filled_vertices = QuadVertices(fill[i]);
+
+    LiquidVertexValues values;
+
+    for (unsigned y = 0; y < N_LIQUID_VERTICES_ROW; ++y)
+    {
+      for (unsigned x = 0; x < N_LIQUID_VERTICES_ROW; ++x)
+      {
+        unsigned const vertex = y * N_LIQUID_VERTICES_ROW + x;
+
+        if (!filled_vertices[vertex])
+          continue;
+
+        float const terrain_height = chunk.header.position.z + chunk.heightmap[y * MCVT_ROW_STRIDE + x];
+        float const depth = std::clamp(std::round(params.level - terrain_height), 0.f, MAX_DEPTH);
+
+        // texture coordinates continue across chunks and tiles at 8 per quad, which spans the map in 16 bits,
+        // only the far edge of the last tile row and column wraps to 0
+        unsigned const global_x = tile_index.x * N_QUADS_TILE_ROW + chunk_x * N_QUADS_CHUNK_ROW + x;
+        unsigned const global_y = tile_index.y * N_QUADS_TILE_ROW + chunk_y * N_QUADS_CHUNK_ROW + y;
+
+        values.heights[vertex] = params.level;
+        values.depths[vertex] = static_cast<char>(static_cast<std::uint8_t>(depth));
+        values.uvs[vertex] = {static_cast<std::uint16_t>(global_x * 8), static_cast<std::uint16_t>(global_y * 8)};
+      }
+    }
+
+    MergeQuads(liquids.chunks()[i], params.liquid_type, fill[i], values, params.use_texcoords);
+  }
+
+  liquids.Initialize();
+}
+
+LiquidVertexValues LiquidFiller::LayerValues(LiquidLayer const& layer)
+{
+  LiquidVertexValues vertices;
+  vertices.heights.fill(layer.min_height_level);
+
+  if (!layer.has_vertex_data)
+    return vertices;
+
+  std::visit([&](auto const& data)
+  {
+    if constexpr (requires { data.heightmap; })
+    {
+      vertices.heights = data.heightmap;
+    }
+
+    if constexpr (requires { data.depthmap; })
+    {
+      vertices.depths = data.depthmap;
+      vertices.has_depth = true;
+    }
+
+    if constexpr (requires { data.uvmap; })
+    {
+      vertices.uvs = data.uvmap;
+      vertices.has_uvs = true;
+    }
+  }, layer.vertex_data);
+
+  return vertices;
+}
+
+void LiquidFiller::MergeQuads(LiquidChunk& chunk
+                              , std::uint16_t liquid_type
+                              , std::uint64_t quads
+                              , LiquidVertexValues const& values
+                              , bool use_texcoords)
+{
+  if (!quads)
+    return;
+
+  auto& layers = chunk.Layers();
+
+  auto it = std::find_if(layers.begin(), layers.end()
+                         , [&](LiquidLayer const& layer) { return layer.liquid_type == liquid_type; });
+
+  if (it == layers.end())
+  {
+    it = layers.insert(layers.end(), LiquidLayer{});
+    it->liquid_type = liquid_type;
+  }
+
+  LiquidLayer& layer = *it;
+  LiquidVertexValues vertices = LayerValues(layer);
+
+  // merged vertices override values shared with existing quads
+  auto const merged_vertices = QuadVertices(quads);
+
+  for (unsigned vertex = 0; vertex < N_LIQUID_VERTICES; ++vertex)
+  {
+    if (!merged_vertices[vertex])
+      continue;
+
+    vertices.heights[vertex] = values.heights[vertex];
+    vertices.depths[vertex] = values.depths[vertex];
+    vertices.uvs[vertex] = values.uvs[vertex];
+  }
+
+  layer.exists_map |= std::bitset<64>(quads);
+  TrimVertices(vertices, layer);
+
+  // smallest format representing the layer, DEPTH implies height 0 on recent clients
+  if (use_texcoords || vertices.has_uvs)
+  {
+    layer.liquid_vertex_format = vertices.has_depth && vertices.has_uvs
+      ? LiquidLayer::LiquidVertexFormat::HEIGHT_DEPTH_TEXCOORD
+      : LiquidLayer::LiquidVertexFormat::HEIGHT_TEXCOORD;
+  }
+  else if (layer.min_height_level == 0.f && layer.max_height_level == 0.f)
+  {
+    layer.liquid_vertex_format = LiquidLayer::LiquidVertexFormat::DEPTH;
+  }
+  else
+  {
+    layer.liquid_vertex_format = LiquidLayer::LiquidVertexFormat::HEIGHT_DEPTH;
+  }
+
+  StoreVertices(vertices, layer);
+}
+
+void LiquidFiller::RemoveQuads(LiquidChunk& chunk, std::uint64_t quads)
+{
+  auto& layers = chunk.Layers();
+
+  for (LiquidLayer& layer : layers)
+  {
+    if (!(layer.exists_map.to_ullong() & quads))
+      continue;
+
+    layer.exists_map &= ~std::bitset<64>(quads);
+
+    // the height range of layers without vertex data is their height, it does not depend on quads
+    if (layer.exists_map.none() || !layer.has_vertex_data)
+      continue;
+
+    LiquidVertexValues vertices = LayerValues(layer);
+    TrimVertices(vertices, layer);
+    StoreVertices(vertices, layer);
+  }
+
+  std::erase_if(layers, [](LiquidLayer const& layer) { return layer.exists_map.none(); });
+}
+
+std::size_t LiquidFiller::FillRegion(std::vector<TileIndex> const& tiles
+                                     , std::vector<C3Vector> const& seeds
+                                     , LiquidFillParams const& params
+                                     , TerrainLoader const& terrain_loader
+                                     , LiquidLoader const& liquid_loader
+                                     , LiquidConsumer const& consumer
+                                     , unsigned n_threads)
+{
+  LogDebugF(LCodeZones::FILE_IO, "Filling liquid over %d tiles.", tiles.size());
+
+  std::array<std::int32_t, 64 * 64> slots;
+  slots.fill(-1);
+
+  for (std::size_t i = 0; i < tiles.size(); ++i)
+  {
+    RequireF(CCodeZones::FILE_IO, tiles[i].x < 64 && tiles[i].y < 64, "Tile index out of bounds.");
+
+    std::int32_t& slot = slots[tiles[i].y * 64 + tiles[i].x];
+    RequireF(CCodeZones::FILE_IO, slot < 0, "Duplicate tile in region.");
+    slot = static_cast<std::int32_t>(i);
+  }
+
+  // submerged quads of every tile, missing tiles stay empty
+  std::vector<TileLiquidMask> submerged(tiles.size(), TileLiquidMask{});
+
+  Utils::Misc::ParallelFor(tiles.size(), [&](std::size_t i)
+  {
+    auto terrain = std::make_unique<TileTerrain>();
+
+    if (terrain_loader(tiles[i], *terrain))
+      submerged[i] = SubmergedQuads(*terrain, params.level);
+  }, n_threads);
+
+  std::vector<TileLiquidMask> fill(tiles.size(), TileLiquidMask{});
+
+  if (seeds.empty())
+  {
+    fill = submerged;
+  }
+  else
+  {
+    RegionGrid grid {slots, submerged, fill};
+    FloodFill(grid, seeds);
+  }
+
+  std::size_t n_filled = 0;
+
+  for (TileLiquidMask const& tile_fill : fill)
+  {
+    for (std::uint64_t chunk_fill : tile_fill)
+      n_filled += static_cast<std::size_t>(std::popcount(chunk_fill));
+  }
+
+  Utils::Misc::ParallelFor(tiles.size(), [&](std::size_t i)
+  {
+    if (std::all_of(fill[i].begin(), fill[i].end(), [](std::uint64_t chunk_fill) { return !chunk_fill; }))
+      return;
+
+    auto terrain = std::make_unique<TileTerrain>();
+    [[maybe_unused]] bool const has_terrain = terrain_loader(tiles[i], *terrain);
+    EnsureF(CCodeZones::FILE_IO, has_terrain, "Tile disappeared while filling liquid.");
+
+    auto liquids = std::make_unique<MH2O>();
+    liquid_loader(tiles[i], *liquids);
+
+    ApplyFill(tiles[i], *terrain, fill[i], params, *liquids);
+    consumer(tiles[i], *liquids);
+  }, n_threads);
+
+  LogDebugF(LCodeZones::FILE_IO, "Filled %d liquid quads.", n_filled);
+
+  return n_filled;
+}
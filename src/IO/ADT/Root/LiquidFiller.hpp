@@ -0,0 +1,150 @@
+#pragma once
+#include <IO/CommonDataStructures.hpp>
+#include <IO/WorldConstants.hpp>
+#include <IO/ADT/Root/MH2O.hpp>
+#include <IO/ADT/Root/TileTerrain.hpp>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace IO::ADT
+{
+  /**
+   * Liquid quads of a tile. Bit (y * 8 + x) of each chunk is quad (x, y) of its 8x8 liquid grid, chunks row-major.
+   */
+  using TileLiquidMask = std::array<std::uint64_t, Common::WorldConstants::CHUNKS_PER_TILE>;
+
+  /**
+   * Liquid to fill with.
+   */
+  struct LiquidFillParams
+  {
+    std::uint16_t liquid_type; ///> LiquidType.db2 record.
+    float level; ///> Height of the liquid surface (placement y).
+    bool use_texcoords = false; ///> Store texture coordinates, required by flowing liquids such as magma.
+  };
+
+  /**
+   * Values of the 9x9 liquid vertices of a chunk, regardless of the vertex format they are stored in.
+   */
+  struct LiquidVertexValues
+  {
+    std::array<float, 81> heights {};
+    std::array<char, 81> depths {};
+    std::array<DataStructures::MH20UVMapEntry, 81> uvs {};
+    bool has_depth = false; ///> Depth is stored by the source layer.
+    bool has_uvs = false; ///> Texture coordinates are stored by the source layer.
+  };
+
+  /**
+   * Authors MH2O liquids by flooding terrain up to a level.
+   *
+   * A liquid quad is submerged if any terrain vertex of it (four outer corners or the inner center) lies below
+   * the level. Starting from seed points, the fill spreads across submerged quads, crossing chunk and tile borders
+   * within the region. Each chunk gets a single instance per liquid type, merged into an existing layer of the same
+   * type if there is one, stored with the smallest vertex format able to represent it:
+   * DEPTH for flat liquid at level 0, HEIGHT_DEPTH otherwise, HEIGHT_TEXCOORD if texture coordinates are needed.
+   * MH2O::Write() stores only the bounding rectangle of existing quads.
+   */
+  class LiquidFiller
+  {
+  public:
+    /**
+     * Loads terrain of a tile. Invoked concurrently from worker threads, must be thread-safe.
+     * Must match signature: bool(Common::DataStructures::TileIndex tile_index, TileTerrain& terrain).
+     * Returns false if tile does not exist, in which case it is excluded from the region.
+     */
+    using TerrainLoader = std::function<bool(Common::DataStructures::TileIndex, TileTerrain&)>;
+
+    /**
+     * Loads existing liquids of a tile. Invoked concurrently from worker threads, must be thread-safe.
+     * Must match signature: void(Common::DataStructures::TileIndex tile_index, MH2O& liquids).
+     * Liquids are left as is if the tile has none.
+     */
+    using LiquidLoader = std::function<void(Common::DataStructures::TileIndex, MH2O&)>;
+
+    /**
+     * Receives liquids of a tile after the fill. Invoked concurrently from worker threads for distinct tiles,
+     * only for tiles reached by the fill.
+     * Must match signature: void(Common::DataStructures::TileIndex tile_index, MH2O const& liquids).
+     */
+    using LiquidConsumer = std::function<void(Common::DataStructures::TileIndex, MH2O const&)>;
+
+    /**
+     * Finds liquid quads of a tile with terrain below a level.
+     * @param terrain Terrain of the tile.
+     * @param level Height of the liquid surface.
+     * @return Submerged quads.
+     */
+    [[nodiscard]]
+    static TileLiquidMask SubmergedQuads(TileTerrain const& terrain, float level);
+
+    /**
+     * Adds liquid to quads of a tile, merging with existing layers of the same liquid type.
+     * @param tile_index Tile coordinates on WDT grid, used for continuous texture coordinates.
+     * @param terrain Terrain of the tile, used for depth.
+     * @param fill Quads to fill.
+     * @param params Liquid to fill with.
+     * @param liquids Liquids of the tile to modify.
+     */
+    static void ApplyFill(Common::DataStructures::TileIndex tile_index
+                          , TileTerrain const& terrain
+                          , TileLiquidMask const& fill
+                          , LiquidFillParams const& params
+                          , MH2O& liquids);
+
+    /**
+     * Expands vertex data of a liquid layer. Layers without vertex data yield their minimum height level.
+     * @param layer Liquid layer.
+     * @return Vertex values.
+     */
+    [[nodiscard]]
+    static LiquidVertexValues LayerValues(LiquidLayer const& layer);
+
+    /**
+     * Adds quads to the layer of a liquid type in a chunk, creating it if needed. Vertices of added quads take
+     * values from the provided ones, other vertices keep the values of the layer.
+     * @param chunk Liquid chunk to modify.
+     * @param liquid_type LiquidType.db2 record.
+     * @param quads Quads to add, bit (y * 8 + x).
+     * @param values Vertex values of added quads.
+     * @param use_texcoords Store texture coordinates.
+     */
+    static void MergeQuads(LiquidChunk& chunk
+                           , std::uint16_t liquid_type
+                           , std::uint64_t quads
+                           , LiquidVertexValues const& values
+                           , bool use_texcoords);
+
+    /**
+     * Removes quads from all layers of a chunk, dropping layers left without quads. Height ranges of the
+     * remaining layers shrink to their remaining vertices.
+     * @param chunk Liquid chunk to modify.
+     * @param quads Quads to remove, bit (y * 8 + x).
+     */
+    static void RemoveQuads(LiquidChunk& chunk, std::uint64_t quads);
+
+    /**
+     * Flood-fills liquid over a region of tiles. Terrain is evaluated and liquids are written in parallel per tile,
+     * loading each tile's terrain twice instead of keeping the region in memory.
+     * @param tiles Tiles the fill may spread over.
+     * @param seeds Points (placement coordinates) to start from. Seeds on dry terrain or outside of the region
+     * are ignored. If empty, every submerged quad of the region is filled.
+     * @param params Liquid to fill with.
+     * @param terrain_loader Terrain loader callback.
+     * @param liquid_loader Liquid loader callback.
+     * @param consumer Callback receiving modified liquids.
+     * @param n_threads Number of worker threads. 0 means hardware concurrency.
+     * @return Number of quads filled.
+     */
+    static std::size_t FillRegion(std::vector<Common::DataStructures::TileIndex> const& tiles
+                                  , std::vector<Common::DataStructures::C3Vector> const& seeds
+                                  , LiquidFillParams const& params
+                                  , TerrainLoader const& terrain_loader
+                                  , LiquidLoader const& liquid_loader
+                                  , LiquidConsumer const& consumer
+                                  , unsigned n_threads = 0);
+  };
+}
@@ -7,12 +7,80 @@
 #include <cstdint>
 #include <cassert>
 #include <algorithm>
+#include <limits>
 
 using namespace IO::ADT;
 using namespace IO::ADT::ChunkIdentifiers;
 using namespace IO::Common;
 
 
+namespace
+{
+  /**
+   * Rectangle of liquid quads covered by an instance, in the 8x8 quad grid of a chunk.
+   */
+  struct LiquidRect
+  {
+    std::uint8_t x;
+    std::uint8_t y;
+    std::uint8_t width;
+    std::uint8_t height;
+  };
+
+  constexpr std::uint8_t N_QUADS_ROW = 8;
+  constexpr std::uint8_t N_VERTICES_ROW = N_QUADS_ROW + 1;
+
+  /**
+   * Reads vertex values of a rectangle, stored row by row, into the full 9x9 vertex grid.
+   */
+  template<typename T>
+  void ReadVertexRect(ByteBuffer const& buf, LiquidRect const& rect, std::array<T, 81>& dst)
+  {
+    for (std::uint8_t row = 0; row <= rect.height; ++row)
+    {
+      auto const begin = dst.begin() + (rect.y + row) * N_VERTICES_ROW + rect.x;
+      buf.Read(begin, begin + rect.width + 1);
+    }
+  }
+
+  /**
+   * Writes vertex values of a rectangle of the full 9x9 vertex grid, row by row.
+   */
+  template<typename T>
+  void WriteVertexRect(ByteBuffer& buf, LiquidRect const& rect, std::array<T, 81> const& src)
+  {
+    for (std::uint8_t row = 0; row <= rect.height; ++row)
+    {
+      auto const begin = src.begin() + (rect.y + row) * N_VERTICES_ROW + rect.x;
+      buf.Write(begin, begin + rect.width + 1);
+    }
+  }
+
+  /**
+   * Smallest rectangle containing all existing quads of a layer.
+   */
+  LiquidRect BoundingRect(std::bitset<64> const& exists_map)
+  {
+    std::uint8_t min_x = N_QUADS_ROW, min_y = N_QUADS_ROW, max_x = 0, max_y = 0;
+
+    for (std::uint8_t i = 0; i < 64; ++i)
+    {
+      if (!exists_map[i])
+        continue;
+
+      std::uint8_t const x = i % N_QUADS_ROW;
+      std::uint8_t const y = i / N_QUADS_ROW;
+
+      min_x = std::min(min_x, x);
+      min_y = std::min(min_y, y);
+      max_x = std::max(max_x, x);
+      max_y = std::max(max_y, y);
+    }
+
+    return {min_x, min_y, static_cast<std::uint8_t>(max_x - min_x + 1), static_cast<std::uint8_t>(max_y - min_y + 1)};
+  }
+}
+
 void MH2O::Read(Common::ByteBuffer const& buf, std::size_t size)
 {
   LogDebugF(LCodeZones::FILE_IO, "Loading ADT root chunk MH2O.");
@@ -25,6 +93,7 @@ void MH2O::Read(Common::ByteBuffer const& buf, std::size_t size)
   
   for (auto&& [header_chunk, chunk] : boost::combine(header_chunks, _chunks))
   {
+    chunk = LiquidChunk{};
 
     if (!header_chunk.layer_count) [[unlikely]]
     {
@@ -61,34 +130,28 @@ void MH2O::Read(Common::ByteBuffer const& buf, std::size_t size)
       layer.liquid_type = instance.liquid_type;
       layer.SetLiquidObjectOrLiquidVertexFormat(instance.liquid_object_or_lvf);
 
-      // handle exists map, we un-compress it to a 64-bit full bitset for convenience
-      std::uint8_t offset_index = instance.y_offset * 8 + instance.x_offset;
-      std::uint8_t n_used_bits = instance.width * instance.height;
+      LiquidRect const rect {instance.x_offset, instance.y_offset, instance.width, instance.height};
+      EnsureF(CCodeZones::FILE_IO, rect.width && rect.height
+                                   && rect.x + rect.width <= N_QUADS_ROW && rect.y + rect.height <= N_QUADS_ROW
+              , "MH2O: bad liquid instance extents.");
 
-      layer.exists_map = std::bitset<64>(0);
+      // handle exists map, we un-compress it to a 64-bit full bitset for convenience.
+      // bitmap covers the instance rectangle row by row, no bitmap means the whole rectangle exists.
+      std::uint64_t exists_bitmap = std::numeric_limits<std::uint64_t>::max();
 
       if (instance.offset_exists_bitmap)
       {
         buf.Seek(data_pos + instance.offset_exists_bitmap);
 
-        std::uint8_t n_bytes_to_read = (instance.width * instance.height + 7) / 8;
-        EnsureF(CCodeZones::FILE_IO, n_bytes_to_read <= 8, "MH2O: bad exists bitmap");
+        exists_bitmap = 0;
+        buf.Read(reinterpret_cast<char*>(&exists_bitmap), (rect.width * rect.height + 7) / 8);
+      }
 
-        std::uint64_t exists_bitmap = 0;
-        buf.Read(reinterpret_cast<char*>(&exists_bitmap), n_bytes_to_read);
+      layer.exists_map = std::bitset<64>(0);
 
-        if (!offset_index)
-        {
-          layer.exists_map = std::bitset<64>(exists_bitmap);
-        }
-        else
-        {
-          auto bitmap_no_offset = std::bitset<64>(exists_bitmap);
-          for (int i = 0; i < n_used_bits; ++i)
-          {
-            layer.exists_map[offset_index + i] = bitmap_no_offset[i];
-          }
-        }
+      for (std::uint8_t i = 0; i < rect.width * rect.height; ++i)
+      {
+        layer.exists_map[(rect.y + i / rect.width) * N_QUADS_ROW + rect.x + i % rect.width] = (exists_bitmap >> i) & 1;
       }
 
       // handle vertex data
@@ -98,37 +161,36 @@ void MH2O::Read(Common::ByteBuffer const& buf, std::size_t size)
         layer.has_vertex_data = true;
         buf.Seek(data_pos + instance.offset_vertex_data);
 
-        std::uint8_t offset = instance.y_offset * 8 + instance.x_offset;
-        std::uint8_t end_offset = offset + (instance.width + 1) * (instance.height + 1);
-
         switch (layer.liquid_vertex_format)
         {
           case LiquidLayer::LiquidVertexFormat::HEIGHT_DEPTH:
           {
             auto& layer_data = layer.vertex_data.emplace<DataStructures::MH2OHeightDepth>();
-            buf.Read(layer_data.heightmap.begin() + offset, layer_data.heightmap.begin() + end_offset);
-            buf.Read(layer_data.depthmap.begin() + offset, layer_data.depthmap.begin() + end_offset);
+            ReadVertexRect(buf, rect, layer_data.heightmap);
+            ReadVertexRect(buf, rect, layer_data.depthmap);
             break;
           }
           case LiquidLayer::LiquidVertexFormat::HEIGHT_TEXCOORD:
           {
             auto& layer_data = layer.vertex_data.emplace<DataStructures::MH2OHeightTexCoord>();
-            buf.Read(layer_data.heightmap.begin() + offset, layer_data.heightmap.begin() + end_offset);
-            buf.Read(layer_data.uvmap.begin() + offset, layer_data.uvmap.begin() + end_offset);
+            ReadVertexRect(buf, rect, layer_data.heightmap);
+            ReadVertexRect(buf, rect, layer_data.uvmap);
             break;
           }
           case LiquidLayer::LiquidVertexFormat::DEPTH:
           {
             auto& layer_data = layer.vertex_data.emplace<DataStructures::MH2ODepth>();
-            buf.Read(layer_data.depthmap.begin() + offset, layer_data.depthmap.begin() + end_offset);
+            ReadVertexRect(buf, rect, layer_data.depthmap);
             break;
           }
           case LiquidLayer::LiquidVertexFormat::HEIGHT_DEPTH_TEXCOORD:
           {
             auto& layer_data = layer.vertex_data.emplace<DataStructures::MH2OHeightDepthTexCoord>();
-            buf.Read(layer_data.heightmap.begin() + offset, layer_data.heightmap.begin() + end_offset);
-            buf.Read(layer_data.depthmap.begin() + offset, layer_data.depthmap.begin() + end_offset);
-            buf.Read(layer_data.uvmap.begin() + offset, layer_data.uvmap.begin() + end_offset);
+
+            // despite the name, LVF 3 stores texture coordinates before depths, as laid out by the client
+            ReadVertexRect(buf, rect, layer_data.heightmap);
+            ReadVertexRect(buf, rect, layer_data.uvmap);
+            ReadVertexRect(buf, rect, layer_data.depthmap);
             break;
           }
 
@@ -137,14 +199,17 @@ void MH2O::Read(Common::ByteBuffer const& buf, std::size_t size)
 
     }
 
-    buf.Seek(data_pos + size);
-
   }
 
+  buf.Seek(data_pos + size);
+  _is_initialized = true;
 }
 
 void MH2O::Write(Common::ByteBuffer& buf) const
 {
+  if (!_is_initialized) [[unlikely]]
+    return;
+
   LogDebugF(LCodeZones::FILE_IO, "Writing chunk: MH20.");
 
   std::size_t pos = buf.Tell();
@@ -156,7 +221,7 @@ void MH2O::Write(Common::ByteBuffer& buf) const
   std::size_t data_pos = buf.Tell();
 
   std::array<DataStructures::SMLiquidChunk, 16 * 16> header_chunks{};
-  buf.Reserve(16 * 16 * sizeof(DataStructures::SMLiquidChunk));
+  buf.WriteFill(DataStructures::SMLiquidChunk{}, header_chunks.size());
 
   for (auto&& [header_chunk, chunk] : boost::range::combine(header_chunks, _chunks))
   {
@@ -171,81 +236,42 @@ void MH2O::Write(Common::ByteBuffer& buf) const
       liquid_instances.resize(header_chunk.layer_count);
 
       // allocate space for all layers
-      buf.Reserve(header_chunk.layer_count * sizeof(DataStructures::SMLiquidInstance));
+      buf.WriteFill(DataStructures::SMLiquidInstance{}, header_chunk.layer_count);
 
       // fill layers
       for (auto&& [layer, instance] : boost::combine(chunk.Layers(), liquid_instances))
       {
         instance.liquid_object_or_lvf = layer.GetLiquidObjectOrLVF();
         instance.liquid_type = layer.liquid_type;
+        instance.min_height_level = layer.min_height_level;
+        instance.max_height_level = layer.max_height_level;
 
         EnsureF(CCodeZones::FILE_IO, layer.exists_map.to_ullong(), "Attempted to write unused liquid layer. Editor code should clean those up.");
 
-        bool all_exist = true;
-        for (std::uint8_t i = 0; i < 64; ++i)
+        // only the smallest rectangle containing existing quads is stored
+        LiquidRect const rect = BoundingRect(layer.exists_map);
+
+        instance.x_offset = rect.x;
+        instance.y_offset = rect.y;
+        instance.width = rect.width;
+        instance.height = rect.height;
+
+        std::uint64_t exists_bitmap = 0;
+
+        for (std::uint8_t i = 0; i < rect.width * rect.height; ++i)
         {
-          if (!layer.exists_map[i])
-          {
-            all_exist = false;
-            break;
-          }
+          exists_bitmap |= std::uint64_t{layer.exists_map[(rect.y + i / rect.width) * N_QUADS_ROW + rect.x + i % rect.width]} << i;
         }
 
-        if (all_exist)
+        // bitmap is omitted if the whole rectangle exists
+        if (exists_bitmap == (std::numeric_limits<std::uint64_t>::max() >> (64 - rect.width * rect.height)))
         {
-          instance.x_offset = 0;
-          instance.y_offset = 0;
-          instance.width = 8;
-          instance.height = 8;
           instance.offset_exists_bitmap = 0;
         }
         else
         {
-
-          // identify the used rectangle
-          std::uint8_t begin = 0;
-          std::uint8_t end = 0;
-
-          for (std::uint8_t i = 0; i < 64; ++i)
-          {
-            if (layer.exists_map[i])
-            {
-              begin = i;
-              break;
-            }
-          }
-
-          for (std::int8_t i = 63; i >= 0; --i)
-          {
-            if (layer.exists_map[i])
-            {
-              end = i;
-              break;
-            }
-          }
-
-          instance.x_offset = begin % 8;
-          instance.y_offset = begin / 8;
-
-          instance.width = (end % 8) - (begin % 8) + 1;
-          instance.height = (end / 8) - (begin / 8) + 1;
-
-          // identify the number of bytes required to store
-
-          std::uint8_t n_exists_bitmap_bytes = (instance.width * instance.height + 7) / 8;
-
-          std::bitset<64> bitmap_temp{0};
-          std::uint8_t counter = 0;
-          for (std::uint8_t i = begin; i <= end; ++i)
-          {
-            bitmap_temp[counter] = layer.exists_map[i];
-            counter++;
-          }
-
-          std::uint64_t exists_bitmap = bitmap_temp.to_ullong();
-
           instance.offset_exists_bitmap = static_cast<std::uint32_t>(buf.Tell() - data_pos);
-          buf.Write(reinterpret_cast<char*>(&exists_bitmap), n_exists_bitmap_bytes);
+          buf.Write(reinterpret_cast<char const*>(&exists_bitmap), (rect.width * rect.height + 7) / 8);
         }
 
         // write vertex data
@@ -256,37 +282,37 @@ void MH2O::Write(Common::ByteBuffer& buf) const
           EnsureF(CCodeZones::FILE_IO, layer.vertex_data.index() == static_cast<unsigned>(layer.liquid_vertex_format),
                   "MH2O layer: wrong vertex format, expected %d, got %d.", static_cast<unsigned>(layer.liquid_vertex_format), layer.vertex_data.index());
 
-          std::uint8_t begin_offset = instance.y_offset * 8 + instance.x_offset;
-          std::uint8_t end_offset = begin_offset + (instance.width + 1) * (instance.height + 1);
           switch (layer.liquid_vertex_format)
           {
             case LiquidLayer::LiquidVertexFormat::HEIGHT_DEPTH:
             {
               auto& layer_data = std::get<DataStructures::MH2OHeightDepth>(layer.vertex_data);
 
-              buf.Write(layer_data.heightmap.begin() + begin_offset, layer_data.heightmap.begin() + end_offset);
-              buf.Write(layer_data.depthmap.begin() + begin_offset, layer_data.depthmap.begin() + end_offset);
+              WriteVertexRect(buf, rect, layer_data.heightmap);
+              WriteVertexRect(buf, rect, layer_data.depthmap);
               break;
             }
             case LiquidLayer::LiquidVertexFormat::HEIGHT_TEXCOORD:
             {
               auto& layer_data = std::get<DataStructures::MH2OHeightTexCoord>(layer.vertex_data);
-              buf.Write(layer_data.heightmap.begin() + begin_offset, layer_data.heightmap.begin() + end_offset);
-              buf.Write(layer_data.uvmap.begin() + begin_offset, layer_data.uvmap.begin() + end_offset);
+              WriteVertexRect(buf, rect, layer_data.heightmap);
+              WriteVertexRect(buf, rect, layer_data.uvmap);
               break;
             }
             case LiquidLayer::LiquidVertexFormat::DEPTH:
             {
               auto& layer_data = std::get<DataStructures::MH2ODepth>(layer.vertex_data);
-              buf.Write(layer_data.depthmap.begin() + begin_offset, layer_data.depthmap.begin() + end_offset);
+              WriteVertexRect(buf, rect, layer_data.depthmap);
               break;
             }
             case LiquidLayer::LiquidVertexFormat::HEIGHT_DEPTH_TEXCOORD:
             {
               auto& layer_data = std::get<DataStructures::MH2OHeightDepthTexCoord>(layer.vertex_data);
-              buf.Write(layer_data.heightmap.begin() + begin_offset, layer_data.heightmap.begin() + end_offset);
-              buf.Write(layer_data.depthmap.begin() + begin_offset, layer_data.depthmap.begin() + end_offset);
-              buf.Write(layer_data.uvmap.begin() + begin_offset, layer_data.uvmap.begin() + end_offset);
+
+              // heights, texture coordinates, depths, see Read()
+              WriteVertexRect(buf, rect, layer_data.heightmap);
+              WriteVertexRect(buf, rect, layer_data.uvmap);
+              WriteVertexRect(buf, rect, layer_data.depthmap);
               break;
             }
           }
@@ -297,13 +323,9 @@ void MH2O::Write(Common::ByteBuffer& buf) const
         }
       }
 
-      std::size_t end_pos = buf.Tell();
-
       // actually write instance data
-      buf.Seek(instances_pos);
-      buf.Write(liquid_instances.begin(), liquid_instances.end());
-
-      buf.Seek(end_pos);
+      buf.Write(reinterpret_cast<char const*>(liquid_instances.data())
+                , liquid_instances.size() * sizeof(DataStructures::SMLiquidInstance), instances_pos);
 
       // handle attributes
       if (chunk.Attributes().has_value())
@@ -326,10 +348,11 @@ void MH2O::Write(Common::ByteBuffer& buf) const
   }
 
   // go back and write relevant header data
-  std::size_t end_pos = buf.Tell();
-  buf.Seek(pos);
-  buf.Write(header_chunks.begin(), header_chunks.end());
-  buf.Seek(end_pos);
+  chunk_header.fourcc = ChunkIdentifiers::ADTRootChunks::MH2O;
+  chunk_header.size = static_cast<std::uint32_t>(buf.Tell() - data_pos);
+  buf.Write(chunk_header, pos);
+  buf.Write(reinterpret_cast<char const*>(header_chunks.data())
+            , header_chunks.size() * sizeof(DataStructures::SMLiquidChunk), data_pos);
 }
 
 void LiquidLayer::SetLiquidObjectOrLiquidVertexFormat(std::uint16_t liquid_object_or_lvf)
@@ -86,9 +86,14 @@ namespace IO::ADT
     [[nodiscard]]
     bool IsInitialized() const { return _is_initialized; }
 
+    void Initialize() { _is_initialized = true; }
+
     [[nodiscard]]
     std::array<LiquidChunk, 16 * 16>& chunks() { return _chunks; }
 
+    [[nodiscard]]
+    std::array<LiquidChunk, 16 * 16> const& chunks() const { return _chunks; }
+
   private:
     std::array<LiquidChunk, 16 * 16> _chunks;
     bool _is_initialized = false;
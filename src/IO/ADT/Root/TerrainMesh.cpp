@@ -0,0 +1,583 @@
+#include <IO/ADT/Root/TerrainMesh.hpp>
+#include <IO/WorldConstants.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace IO::ADT;
+using namespace IO::Common;
+
+namespace
+{
+  using IO::Common::DataStructures::C3Vector;
+  using IO::Common::DataStructures::TileIndex;
+
+  /*
+   * Outer and inner vertices of a tile form a lattice of 257x257 points with half-quad spacing,
+   * in which a point exists if both of its coordinates are even (outer vertex) or odd (inner vertex).
+   */
+  constexpr unsigned LATTICE_MAX = 16 * 16;
+  constexpr unsigned LATTICE_SIZE = LATTICE_MAX + 1;
+  constexpr float LATTICE_SPACING = WorldConstants::TILE_SIZE / static_cast<float>(LATTICE_MAX);
+
+  constexpr std::uint32_t NO_VERTEX = std::numeric_limits<std::uint32_t>::max();
+
+  /**
+   * Identifies a lattice point on the lattice spanning the whole map, shared by points on borders of two tiles.
+   */
+  std::uint64_t GlobalLatticeKey(TileIndex tile_index, unsigned x, unsigned y)
+  {
+    std::uint64_t const global_x = tile_index.x * LATTICE_MAX + x;
+    std::uint64_t const global_y = tile_index.y * LATTICE_MAX + y;
+    return global_y * (64 * LATTICE_MAX + 1) + global_x;
+  }
+
+  /**
+   * Invokes callback with every lattice point on tile borders, i.e. the outer vertices of border chunks.
+   * Must match signature: void(unsigned x, unsigned y).
+   */
+  template<typename Callback>
+  void ForEachBorderPoint(Callback&& callback)
+  {
+    for (unsigned i = 0; i <= LATTICE_MAX; i += 2)
+    {
+      callback(i, 0u);
+      callback(i, LATTICE_MAX);
+
+      if (i > 0 && i < LATTICE_MAX)
+      {
+        callback(0u, i);
+        callback(LATTICE_MAX, i);
+      }
+    }
+  }
+
+  /**
+   * Right triangle of the lattice. a and b are ends of the hypotenuse, c is the right angle.
+   */
+  struct LatticeTriangle
+  {
+    std::uint16_t ax, ay;
+    std::uint16_t bx, by;
+    std::uint16_t cx, cy;
+  };
+
+  /**
+   * Lattice point halfway between two points.
+   */
+  unsigned Midpoint(unsigned a, unsigned b) { return (a + b) / 2; }
+
+  /**
+   * Hypotenuse midpoint of a triangle exists in the lattice for all triangles coarser than quad fans.
+   */
+  bool IsSplittable(LatticeTriangle const& triangle)
+  {
+    return (Midpoint(triangle.ax, triangle.bx) + Midpoint(triangle.ay, triangle.by)) % 2 == 0;
+  }
+
+  std::array<LatticeTriangle, 2> Split(LatticeTriangle const& triangle)
+  {
+    std::uint16_t const mx = static_cast<std::uint16_t>(Midpoint(triangle.ax, triangle.bx));
+    std::uint16_t const my = static_cast<std::uint16_t>(Midpoint(triangle.ay, triangle.by));
+
+    return {LatticeTriangle{triangle.cx, triangle.cy, triangle.ax, triangle.ay, mx, my}
+            , LatticeTriangle{triangle.bx, triangle.by, triangle.cx, triangle.cy, mx, my}};
+  }
+
+  constexpr std::array<LatticeTriangle, 2> ROOT_TRIANGLES
+  {
+    LatticeTriangle{0, 0, LATTICE_MAX, LATTICE_MAX, LATTICE_MAX, 0}
+    , LatticeTriangle{LATTICE_MAX, LATTICE_MAX, 0, 0, 0, LATTICE_MAX}
+  };
+
+  /**
+   * Triangles of the hierarchy grouped by level, coarsest first. Identical for every tile.
+   */
+  std::vector<std::vector<LatticeTriangle>> const& TriangleLevels()
+  {
+    static std::vector<std::vector<LatticeTriangle>> const levels = []
+    {
+      std::vector<std::vector<LatticeTriangle>> result {{ROOT_TRIANGLES.begin(), ROOT_TRIANGLES.end()}};
+
+      while (IsSplittable(result.back().front()))
+      {
+        std::vector<LatticeTriangle> next;
+        next.reserve(result.back().size() * 2);
+
+        for (LatticeTriangle const& triangle : result.back())
+        {
+          auto const children = Split(triangle);
+          next.insert(next.end(), children.begin(), children.end());
+        }
+
+        result.push_back(std::move(next));
+      }
+
+      return result;
+    }();
+
+    return levels;
+  }
+
+  /**
+   * Source data of a tile sampled on the lattice.
+   */
+  struct TileLattice
+  {
+    std::vector<float> heights; ///> Source heights.
+    std::vector<float> mesh_heights; ///> Heights used by the mesh, differ from source on tile borders only.
+    std::vector<float> errors; ///> Error of the coarsest triangles split at each point.
+    std::vector<IO::ADT::DataStructures::MCNREntry const*> normals; ///> Source normal of each point.
+
+    [[nodiscard]]
+    static std::size_t Index(unsigned x, unsigned y) { return y * LATTICE_SIZE + x; };
+  };
+
+  void SampleLattice(TileTerrain const& terrain, TileLattice& lattice)
+  {
+    lattice.heights.assign(LATTICE_SIZE * LATTICE_SIZE, 0.f);
+    lattice.normals.assign(LATTICE_SIZE * LATTICE_SIZE, nullptr);
+
+    for (unsigned y = 0; y <= LATTICE_MAX; ++y)
+    {
+      for (unsigned x = y % 2; x <= LATTICE_MAX; x += 2)
+      {
+        unsigned chunk_x, chunk_y, vertex;
+
+        if (x % 2 == 0)
+        {
+          // last vertex of a row is owned by the last chunk
+          unsigned const outer_x = x / 2;
+          unsigned const outer_y = y / 2;
+          chunk_x = std::min(outer_x / 8, 15u);
+          chunk_y = std::min(outer_y / 8, 15u);
+          vertex = (outer_y - chunk_y * 8) * 17 + (outer_x - chunk_x * 8);
+        }
+        else
+        {
+          unsigned const quad_x = x / 2;
+          unsigned const quad_y = y / 2;
+          chunk_x = quad_x / 8;
+          chunk_y = quad_y / 8;
+          vertex = (quad_y % 8) * 17 + 9 + quad_x % 8;
+        }
+
+        ChunkTerrain const& chunk = terrain[chunk_y * 16 + chunk_x];
+        lattice.heights[TileLattice::Index(x, y)] = chunk.header.position.z + chunk.heightmap[vertex];
+        lattice.normals[TileLattice::Index(x, y)] = &chunk.normals[vertex];
+      }
+    }
+
+    lattice.mesh_heights = lattice.heights;
+  }
+
+  /**
+   * Simplifies one tile border as a 1D hierarchy of segments, using its heights only.
+   * Kept border points are forced into the mesh, other border points are moved onto the simplified border.
+   */
+  void SimplifyBorder(TileLattice& lattice, float max_error, unsigned fixed, bool is_fixed_y)
+  {
+    constexpr unsigned N_POINTS = LATTICE_MAX / 2 + 1;
+
+    auto index = [&](unsigned i) -> std::size_t
+    {
+      return is_fixed_y ? TileLattice::Index(i * 2, fixed) : TileLattice::Index(fixed, i * 2);
+    };
+
+    std::array<float, N_POINTS> errors {};
+
+    for (unsigned half = 1; half < N_POINTS - 1; half *= 2)
+    {
+      for (unsigned mid = half; mid < N_POINTS - 1; mid += half * 2)
+      {
+        float const from = lattice.heights[index(mid - half)];
+        float const to = lattice.heights[index(mid + half)];
+
+        float error = 0.f;
+
+        for (unsigned i = mid - half + 1; i < mid + half; ++i)
+        {
+          float const t = static_cast<float>(i - (mid - half)) / static_cast<float>(half * 2);
+          error = std::max(error, std::abs(lattice.heights[index(i)] - (from + (to - from) * t)));
+        }
+
+        // a segment is only kept if its parent is
+        if (half > 1)
+          error = std::max({error, errors[mid - half / 2], errors[mid + half / 2]});
+
+        errors[mid] = error;
+      }
+    }
+
+    std::array<bool, N_POINTS> kept {};
+    kept.front() = true;
+    kept.back() = true;
+
+    for (unsigned i = 1; i < N_POINTS - 1; ++i)
+      kept[i] = errors[i] > max_error;
+
+    for (unsigned from = 0; from < N_POINTS - 1;)
+    {
+      unsigned to = from + 1;
+
+      while (!kept[to])
+        ++to;
+
+      for (unsigned i = from + 1; i < to; ++i)
+      {
+        float const t = static_cast<float>(i - from) / static_cast<float>(to - from);
+        lattice.mesh_heights[index(i)] = lattice.heights[index(from)]
+          + (lattice.heights[index(to)] - lattice.heights[index(from)]) * t;
+      }
+
+      if (to < N_POINTS - 1)
+        lattice.errors[index(to)] = std::numeric_limits<float>::infinity();
+
+      from = to;
+    }
+  }
+
+  /**
+   * Computes the largest vertical distance between a triangle and source heights of lattice points it covers.
+   */
+  float TriangleError(TileLattice const& lattice, LatticeTriangle const& triangle)
+  {
+    int const ax = triangle.ax, ay = triangle.ay;
+    int const bx = triangle.bx, by = triangle.by;
+    int const cx = triangle.cx, cy = triangle.cy;
+
+    float const ha = lattice.mesh_heights[TileLattice::Index(ax, ay)];
+    float const hb = lattice.mesh_heights[TileLattice::Index(bx, by)];
+    float const hc = lattice.mesh_heights[TileLattice::Index(cx, cy)];
+
+    int const area = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+    float const inv_area = 1.f / static_cast<float>(area);
+
+    float error = 0.f;
+
+    for (int y = std::min({ay, by, cy}); y <= std::max({ay, by, cy}); ++y)
+    {
+      int const x_min = std::min({ax, bx, cx});
+
+      for (int x = x_min + ((x_min + y) % 2); x <= std::max({ax, bx, cx}); x += 2)
+      {
+        // barycentric weights scaled by area, all share the sign of area inside the triangle
+        int const wb = (x - ax) * (cy - ay) - (y - ay) * (cx - ax);
+        int const wc = (bx - ax) * (y - ay) - (by - ay) * (x - ax);
+        int const wa = area - wb - wc;
+
+        if ((area > 0) ? (wa < 0 || wb < 0 || wc < 0) : (wa > 0 || wb > 0 || wc > 0))
+          continue;
+
+        float const height = (ha * static_cast<float>(wa) + hb * static_cast<float>(wb) + hc * static_cast<float>(wc))
+          * inv_area;
+
+        error = std::max(error, std::abs(height - lattice.heights[TileLattice::Index(x, y)]));
+      }
+    }
+
+    return error;
+  }
+
+  void ComputeErrors(TileLattice& lattice)
+  {
+    auto const& levels = TriangleLevels();
+
+    // quad fans (last level) are never split
+    for (std::size_t level = levels.size() - 1; level-- > 0;)
+    {
+      bool const has_split_children = level + 2 < levels.size();
+
+      for (LatticeTriangle const& triangle : levels[level])
+      {
+        unsigned const mx = Midpoint(triangle.ax, triangle.bx);
+        unsigned const my = Midpoint(triangle.ay, triangle.by);
+        float& error = lattice.errors[TileLattice::Index(mx, my)];
+
+        error = std::max(error, TriangleError(lattice, triangle));
+
+        // children are only reachable through their parent, so the parent must be split whenever they are
+        if (has_split_children)
+        {
+          error = std::max({error
+                            , lattice.errors[TileLattice::Index(Midpoint(triangle.cx, triangle.ax)
+                                                                , Midpoint(triangle.cy, triangle.ay))]
+                            , lattice.errors[TileLattice::Index(Midpoint(triangle.bx, triangle.cx)
+                                                                , Midpoint(triangle.by, triangle.cy))]});
+        }
+      }
+    }
+  }
+
+  struct TileMeshBuilder
+  {
+    TileIndex tile_index;
+    TileTerrain const& terrain;
+    TileLattice const& lattice;
+    float max_error;
+    TerrainMesh& mesh;
+    std::vector<std::uint32_t>& lattice_indices; ///> Lattice point of each mesh vertex.
+    std::vector<std::uint32_t> vertex_indices = std::vector<std::uint32_t>(LATTICE_SIZE * LATTICE_SIZE, NO_VERTEX);
+
+    std::uint32_t Vertex(unsigned x, unsigned y)
+    {
+      std::size_t const index = TileLattice::Index(x, y);
+
+      if (vertex_indices[index] != NO_VERTEX)
+        return vertex_indices[index];
+
+      // global lattice position keeps coordinates of shared border vertices bit-identical across tiles
+      float const global_x = static_cast<float>(tile_index.x * LATTICE_MAX + x) * LATTICE_SPACING;
+      float const global_z = static_cast<float>(tile_index.y * LATTICE_MAX + y) * LATTICE_SPACING;
+      mesh.vertices.push_back({global_x, lattice.mesh_heights[index], global_z});
+
+      // MCNR stores world space (x, y, z up), placement space axes are (-y, z, -x)
+      std::int8_t const* normal = lattice.normals[index]->normal;
+      C3Vector n {-static_cast<float>(normal[1]), static_cast<float>(normal[2]), -static_cast<float>(normal[0])};
+      float const length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+      mesh.normals.push_back(length > 0.f ? C3Vector{n.x / length, n.y / length, n.z / length} : C3Vector{0.f, 1.f, 0.f});
+
+      lattice_indices.push_back(static_cast<std::uint32_t>(index));
+      vertex_indices[index] = static_cast<std::uint32_t>(mesh.vertices.size() - 1);
+
+      return vertex_indices[index];
+    }
+
+    void Emit(LatticeTriangle const& triangle)
+    {
+      if (!IsSplittable(triangle))
+      {
+        // quad fans have their right angle at the quad center
+        unsigned const quad_x = triangle.cx / 2;
+        unsigned const quad_y = triangle.cy / 2;
+        ChunkTerrain const& chunk = terrain[(quad_y / 8) * 16 + quad_x / 8];
+
+        if (ChunkHoleMask(chunk.header) & (std::uint64_t{1} << ((quad_y % 8) * 8 + quad_x % 8)))
+          return;
+      }
+      else if (lattice.errors[TileLattice::Index(Midpoint(triangle.ax, triangle.bx)
+                                                 , Midpoint(triangle.ay, triangle.by))] > max_error)
+      {
+        for (LatticeTriangle const& child : Split(triangle))
+          Emit(child);
+
+        return;
+      }
+
+      std::uint32_t const a = Vertex(triangle.ax, triangle.ay);
+      std::uint32_t const b = Vertex(triangle.bx, triangle.by);
+      std::uint32_t const c = Vertex(triangle.cx, triangle.cy);
+
+      // counter-clockwise from above means (b - a) x (c - a) points up (+y)
+      int const orientation = (triangle.by - triangle.ay) * (triangle.cx - triangle.ax)
+        - (triangle.bx - triangle.ax) * (triangle.cy - triangle.ay);
+
+      if (orientation > 0)
+        mesh.indices.insert(mesh.indices.end(), {a, b, c});
+      else
+        mesh.indices.insert(mesh.indices.end(), {a, c, b});
+    }
+  };
+
+  /**
+   * @param forced Lattice points on tile borders that must become vertices, as a neighbouring tile uses them.
+   */
+  void BuildTileMesh(TileIndex tile_index
+                     , TileTerrain const& terrain
+                     , float max_error
+                     , std::span<std::uint32_t const> forced
+                     , TerrainMesh& mesh
+                     , std::vector<std::uint32_t>& lattice_indices)
+  {
+    RequireF(CCodeZones::FILE_IO, tile_index.x < 64 && tile_index.y < 64, "Tile index out of bounds.");
+    RequireF(CCodeZones::FILE_IO, max_error >= 0.f, "Error bound must not be negative.");
+
+    TileLattice lattice;
+    SampleLattice(terrain, lattice);
+    lattice.errors.assign(LATTICE_SIZE * LATTICE_SIZE, 0.f);
+
+    SimplifyBorder(lattice, max_error, 0, true);
+    SimplifyBorder(lattice, max_error, LATTICE_MAX, true);
+    SimplifyBorder(lattice, max_error, 0, false);
+    SimplifyBorder(lattice, max_error, LATTICE_MAX, false);
+
+    for (std::uint32_t index : forced)
+      lattice.errors[index] = std::numeric_limits<float>::infinity();
+
+    // holes are cut out at quad resolution, which requires quads around them to be fully split
+    for (unsigned i = 0; i < WorldConstants::CHUNKS_PER_TILE; ++i)
+    {
+      std::uint64_t const holes = ChunkHoleMask(terrain[i].header);
+
+      for (unsigned quad = 0; quad < 64; ++quad)
+      {
+        if (!(holes & (std::uint64_t{1} << quad)))
+          continue;
+
+        unsigned const quad_x = (i % 16) * 8 + quad % 8;
+        unsigned const quad_y = (i / 16) * 8 + quad / 8;
+        lattice.errors[TileLattice::Index(quad_x * 2 + 1, quad_y * 2 + 1)] = std::numeric_limits<float>::infinity();
+      }
+    }
+
+    ComputeErrors(lattice);
+
+    mesh.vertices.clear();
+    mesh.normals.clear();
+    mesh.indices.clear();
+    lattice_indices.clear();
+
+    TileMeshBuilder builder {tile_index, terrain, lattice, max_error, mesh, lattice_indices};
+
+    for (LatticeTriangle const& root : ROOT_TRIANGLES)
+      builder.Emit(root);
+  }
+}
+
+void TerrainMeshBuilder::BuildTile(TileIndex tile_index, TileTerrain const& terrain, float max_error, TerrainMesh& mesh)
+{
+  std::vector<std::uint32_t> lattice_indices;
+  BuildTileMesh(tile_index, terrain, max_error, {}, mesh, lattice_indices);
+}
+
+TerrainMesh TerrainMeshBuilder::BuildRegion(std::vector<TileIndex> const& tiles
+                                            , TerrainLoader const& loader
+                                            , float max_error
+                                            , unsigned n_threads)
+{
+  LogDebugF(LCodeZones::FILE_IO, "Building terrain mesh of %d tiles.", tiles.size());
+
+  struct TileResult
+  {
+    TerrainMesh mesh;
+    std::vector<std::uint32_t> lattice_indices;
+  };
+
+  std::vector<std::optional<TileResult>> results (tiles.size());
+  std::vector<std::vector<std::uint32_t>> forced (tiles.size());
+
+  std::vector<std::size_t> pending (tiles.size());
+  std::iota(pending.begin(), pending.end(), 0);
+
+  // Border vertices one tile needs are forced into its neighbours, which are built again, until every shared edge
+  // is split alike. Forced points only add splits, so each round grows the border vertex sets and this terminates.
+  while (!pending.empty())
+  {
+    Utils::Misc::ParallelFor(pending.size(), [&](std::size_t i)
+    {
+      std::size_t const tile = pending[i];
+      auto terrain = std::make_unique<TileTerrain>();
+
+      if (!loader(tiles[tile], *terrain))
+        return;
+
+      TileResult result;
+      BuildTileMesh(tiles[tile], *terrain, max_error, forced[tile], result.mesh, result.lattice_indices);
+      results[tile] = std::move(result);
+    }, n_threads);
+
+    std::unordered_set<std::uint64_t> border_points;
+
+    for (std::size_t i = 0; i < tiles.size(); ++i)
+    {
+      if (!results[i])
+        continue;
+
+      for (std::uint32_t index : results[i]->lattice_indices)
+      {
+        unsigned const x = index % LATTICE_SIZE;
+        unsigned const y = index / LATTICE_SIZE;
+
+        if (x == 0 || y == 0 || x == LATTICE_MAX || y == LATTICE_MAX)
+          border_points.insert(GlobalLatticeKey(tiles[i], x, y));
+      }
+    }
+
+    pending.clear();
+    std::vector<bool> present;
+
+    for (std::size_t i = 0; i < tiles.size(); ++i)
+    {
+      if (!results[i])
+        continue;
+
+      present.assign(LATTICE_SIZE * LATTICE_SIZE, false);
+
+      for (std::uint32_t index : results[i]->lattice_indices)
+        present[index] = true;
+
+      std::size_t const n_forced = forced[i].size();
+
+      ForEachBorderPoint([&](unsigned x, unsigned y)
+      {
+        std::size_t const index = TileLattice::Index(x, y);
+
+        if (!present[index] && border_points.contains(GlobalLatticeKey(tiles[i], x, y)))
+          forced[i].push_back(static_cast<std::uint32_t>(index));
+      });
+
+      if (forced[i].size() > n_forced)
+        pending.push_back(i);
+    }
+
+    if (!pending.empty())
+      LogDebugF(LCodeZones::FILE_IO, "Rebuilding %d tiles to match border vertices of their neighbours.", pending.size());
+  }
+
+  TerrainMesh region;
+
+  // border vertices are identified by their position on the lattice spanning the whole map
+  std::unordered_map<std::uint64_t, std::uint32_t> border_vertices;
+  std::vector<std::uint32_t> remap;
+
+  for (std::size_t i = 0; i < tiles.size(); ++i)
+  {
+    if (!results[i])
+      continue;
+
+    TerrainMesh const& mesh = results[i]->mesh;
+    remap.resize(mesh.vertices.size());
+
+    for (std::size_t vertex = 0; vertex < mesh.vertices.size(); ++vertex)
+    {
+      unsigned const x = results[i]->lattice_indices[vertex] % LATTICE_SIZE;
+      unsigned const y = results[i]->lattice_indices[vertex] / LATTICE_SIZE;
+
+      std::uint32_t const next_index = static_cast<std::uint32_t>(region.vertices.size());
+
+      if (x == 0 || y == 0 || x == LATTICE_MAX || y == LATTICE_MAX)
+      {
+        auto const [it, is_new] = border_vertices.emplace(GlobalLatticeKey(tiles[i], x, y), next_index);
+
+        if (!is_new)
+        {
+          remap[vertex] = it->second;
+          continue;
+        }
+      }
+
+      remap[vertex] = next_index;
+      region.vertices.push_back(mesh.vertices[vertex]);
+      region.normals.push_back(mesh.normals[vertex]);
+    }
+
+    region.indices.reserve(region.indices.size() + mesh.indices.size());
+
+    for (std::uint32_t index : mesh.indices)
+      region.indices.push_back(remap[index]);
+  }
+
+  return region;
+}
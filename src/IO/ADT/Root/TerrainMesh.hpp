@@ -0,0 +1,75 @@
+#pragma once
+#include <IO/CommonDataStructures.hpp>
+#include <IO/ADT/Root/TileTerrain.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace IO::ADT
+{
+  /**
+   * Indexed triangle mesh of terrain in placement coordinates (x and z are horizontal, relative to the map corner,
+   * y is up). Triangles are counter-clockwise when viewed from above.
+   */
+  struct TerrainMesh
+  {
+    std::vector<Common::DataStructures::C3Vector> vertices;
+    std::vector<Common::DataStructures::C3Vector> normals; ///> Unit normal of each vertex, from MCNR.
+    std::vector<std::uint32_t> indices; ///> Three indices per triangle.
+  };
+
+  /**
+   * Builds simplified terrain meshes from MCVT / MCNR with holes removed.
+   *
+   * Both vertex grids of a tile (outer and inner) form one lattice, which is triangulated as a right-triangulated
+   * irregular network: a triangle is split at the midpoint of its hypotenuse until it is within the error bound,
+   * down to the four triangles per quad used by the client. Triangles sharing a hypotenuse are split together,
+   * so the mesh of a tile has no cracks, including chunk borders.
+   *
+   * Vertices on tile borders are first decided from border heights alone, so neighbouring tiles mostly agree
+   * on them, and border vertices lie on the simplified border either tile would use. Where the interior of a tile
+   * still needs more border vertices, BuildRegion() builds its neighbour again with those forced in, so that shared
+   * edges are split alike and the region mesh has no T-junctions. BuildTile() alone cannot know its neighbours.
+   */
+  class TerrainMeshBuilder
+  {
+  public:
+    /**
+     * Loads terrain of a tile. Invoked concurrently from worker threads, must be thread-safe.
+     * Must match signature: bool(Common::DataStructures::TileIndex tile_index, TileTerrain& terrain).
+     * ExtractTileTerrain() fills terrain from a root ADT.
+     * Returns false if tile does not exist, in which case it is skipped.
+     */
+    using TerrainLoader = std::function<bool(Common::DataStructures::TileIndex, TileTerrain&)>;
+
+    /**
+     * Builds the mesh of a tile.
+     * @param tile_index Tile coordinates on WDT grid.
+     * @param terrain Terrain of the tile.
+     * @param max_error Maximal vertical distance between the mesh and any source vertex, in yards.
+     * 0 keeps every source vertex except those in planar areas.
+     * @param mesh Mesh to write the result to. Previous content is discarded.
+     */
+    static void BuildTile(Common::DataStructures::TileIndex tile_index
+                          , TileTerrain const& terrain
+                          , float max_error
+                          , TerrainMesh& mesh);
+
+    /**
+     * Builds meshes of a set of tiles in parallel and merges them into one mesh.
+     * Vertices on borders shared by two tiles are merged. Tiles whose borders have to match a neighbour are
+     * loaded and built again.
+     * @param tiles Tiles to process.
+     * @param loader Terrain loader callback.
+     * @param max_error Maximal vertical distance between the mesh and any source vertex, in yards.
+     * @param n_threads Number of worker threads. 0 means hardware concurrency.
+     * @return Mesh of all present tiles, in order of tiles.
+     */
+    [[nodiscard]]
+    static TerrainMesh BuildRegion(std::vector<Common::DataStructures::TileIndex> const& tiles
+                                   , TerrainLoader const& loader
+                                   , float max_error
+                                   , unsigned n_threads = 0);
+  };
+}
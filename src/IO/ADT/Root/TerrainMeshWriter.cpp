@@ -0,0 +1,165 @@
+#include <IO/ADT/Root/TerrainMeshWriter.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+using namespace IO::ADT;
+using namespace IO::Common;
+
+namespace
+{
+  using IO::Common::DataStructures::C3Vector;
+
+  // glTF constants, see the glTF 2.0 specification
+  constexpr std::uint32_t GLB_MAGIC = 0x46546C67; // "glTF"
+  constexpr std::uint32_t GLB_VERSION = 2;
+  constexpr std::uint32_t GLB_CHUNK_JSON = 0x4E4F534A; // "JSON"
+  constexpr std::uint32_t GLB_CHUNK_BIN = 0x004E4942; // "BIN\0"
+
+  void AppendFloat(std::string& out, float value)
+  {
+    std::array<char, 32> chars;
+    auto const result = std::to_chars(chars.data(), chars.data() + chars.size(), value);
+    out.append(chars.data(), result.ptr);
+  }
+
+  void AppendVector(std::string& out, C3Vector const& vec, char separator)
+  {
+    AppendFloat(out, vec.x);
+    out += separator;
+    AppendFloat(out, vec.y);
+    out += separator;
+    AppendFloat(out, vec.z);
+  }
+
+  void ValidateMesh(TerrainMesh const& mesh)
+  {
+    RequireF(CCodeZones::FILE_IO, mesh.normals.size() == mesh.vertices.size(), "Mesh must have a normal per vertex.");
+    RequireF(CCodeZones::FILE_IO, mesh.indices.size() % 3 == 0, "Mesh must consist of triangles.");
+    RequireF(CCodeZones::FILE_IO, std::all_of(mesh.indices.begin(), mesh.indices.end()
+                                              , [&](std::uint32_t index) { return index < mesh.vertices.size(); })
+             , "Mesh references non-existing vertices.");
+  }
+}
+
+void TerrainMeshWriter::WriteOBJ(TerrainMesh const& mesh, ByteBuffer& buf)
+{
+  ValidateMesh(mesh);
+
+  std::string text;
+  text.reserve(mesh.vertices.size() * 64 + mesh.indices.size() * 8);
+
+  for (C3Vector const& vertex : mesh.vertices)
+  {
+    text += "v ";
+    AppendVector(text, vertex, ' ');
+    text += '\n';
+  }
+
+  for (C3Vector const& normal : mesh.normals)
+  {
+    text += "vn ";
+    AppendVector(text, normal, ' ');
+    text += '\n';
+  }
+
+  // OBJ indices are 1-based, normals share indices with positions
+  for (std::size_t i = 0; i < mesh.indices.size(); i += 3)
+  {
+    text += 'f';
+
+    for (std::size_t j = i; j < i + 3; ++j)
+    {
+      std::string const index = std::to_string(mesh.indices[j] + 1);
+      text += ' ';
+      text += index;
+      text += "//";
+      text += index;
+    }
+
+    text += '\n';
+  }
+
+  buf.Write(text.begin(), text.end());
+}
+
+void TerrainMeshWriter::WriteGLB(TerrainMesh const& mesh, ByteBuffer& buf)
+{
+  ValidateMesh(mesh);
+
+  std::string json = R"({"asset":{"version":"2.0","generator":"WoWLib"},"scene":0)";
+
+  std::size_t const positions_size = mesh.vertices.size() * sizeof(C3Vector);
+  std::size_t const normals_size = mesh.normals.size() * sizeof(C3Vector);
+  std::size_t const indices_size = mesh.indices.size() * sizeof(std::uint32_t);
+  std::size_t const bin_size = positions_size + normals_size + indices_size;
+
+  RequireF(CCodeZones::FILE_IO, bin_size < std::numeric_limits<std::uint32_t>::max() / 2, "Mesh is too large for GLB.");
+
+  if (mesh.indices.empty())
+  {
+    // accessors and scene node lists must not be empty, so a mesh without triangles is written as a scene
+    // without nodes
+    json += R"(,"scenes":[{}]})";
+  }
+  else
+  {
+    C3Vector min = mesh.vertices.front();
+    C3Vector max = mesh.vertices.front();
+
+    for (C3Vector const& vertex : mesh.vertices)
+    {
+      min = {std::min(min.x, vertex.x), std::min(min.y, vertex.y), std::min(min.z, vertex.z)};
+      max = {std::max(max.x, vertex.x), std::max(max.y, vertex.y), std::max(max.z, vertex.z)};
+    }
+
+    std::string const n_vertices = std::to_string(mesh.vertices.size());
+
+    json += R"(,"scenes":[{"nodes":[0]}],"nodes":[{"mesh":0}])";
+    json += R"(,"meshes":[{"primitives":[{"attributes":{"POSITION":0,"NORMAL":1},"indices":2,"mode":4}]}])";
+    json += R"(,"accessors":[{"bufferView":0,"componentType":5126,"count":)" + n_vertices + R"(,"type":"VEC3","min":[)";
+    AppendVector(json, min, ',');
+    json += R"(],"max":[)";
+    AppendVector(json, max, ',');
+    json += R"(]},{"bufferView":1,"componentType":5126,"count":)" + n_vertices + R"(,"type":"VEC3"})";
+    json += R"(,{"bufferView":2,"componentType":5125,"count":)" + std::to_string(mesh.indices.size())
+      + R"(,"type":"SCALAR"}])";
+    json += R"(,"bufferViews":[{"buffer":0,"byteOffset":0,"byteLength":)" + std::to_string(positions_size)
+      + R"(,"target":34962},{"buffer":0,"byteOffset":)" + std::to_string(positions_size)
+      + R"(,"byteLength":)" + std::to_string(normals_size)
+      + R"(,"target":34962},{"buffer":0,"byteOffset":)" + std::to_string(positions_size + normals_size)
+      + R"(,"byteLength":)" + std::to_string(indices_size) + R"(,"target":34963}])";
+    json += R"(,"buffers":[{"byteLength":)" + std::to_string(bin_size) + "}]}";
+  }
+
+  // chunks are 4-byte aligned, JSON is padded with spaces
+  json.append((4 - json.size() % 4) % 4, ' ');
+  std::size_t const bin_padding = (4 - bin_size % 4) % 4;
+
+  bool const has_bin = !mesh.indices.empty();
+  std::size_t const total_size = 12 + 8 + json.size() + (has_bin ? 8 + bin_size + bin_padding : 0);
+
+  buf.Write(GLB_MAGIC);
+  buf.Write(GLB_VERSION);
+  buf.Write(static_cast<std::uint32_t>(total_size));
+
+  buf.Write(static_cast<std::uint32_t>(json.size()));
+  buf.Write(GLB_CHUNK_JSON);
+  buf.Write(json.begin(), json.end());
+
+  if (!has_bin)
+    return;
+
+  buf.Write(static_cast<std::uint32_t>(bin_size + bin_padding));
+  buf.Write(GLB_CHUNK_BIN);
+  buf.Write(mesh.vertices.begin(), mesh.vertices.end());
+  buf.Write(mesh.normals.begin(), mesh.normals.end());
+  buf.Write(mesh.indices.begin(), mesh.indices.end());
+  buf.WriteFill(std::uint8_t{0}, bin_padding);
+}
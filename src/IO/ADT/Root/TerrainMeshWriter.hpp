@@ -0,0 +1,28 @@
+#pragma once
+#include <IO/ByteBuffer.hpp>
+#include <IO/ADT/Root/TerrainMesh.hpp>
+
+namespace IO::ADT
+{
+  /**
+   * Writes terrain meshes into interchange formats. Coordinates are written as is (placement coordinates, y is up),
+   * which matches the conventions of both formats.
+   */
+  class TerrainMeshWriter
+  {
+  public:
+    /**
+     * Writes a mesh as Wavefront OBJ text with positions, normals and faces.
+     * @param mesh Mesh to write.
+     * @param buf Buffer to write to, at its current position.
+     */
+    static void WriteOBJ(TerrainMesh const& mesh, Common::ByteBuffer& buf);
+
+    /**
+     * Writes a mesh as binary glTF 2.0 (.glb) with a single node and primitive.
+     * @param mesh Mesh to write.
+     * @param buf Buffer to write to, at its current position.
+     */
+    static void WriteGLB(TerrainMesh const& mesh, Common::ByteBuffer& buf);
+  };
+}
@@ -0,0 +1,538 @@
+#include <IO/ADT/Root/TerrainRaycaster.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <Utils/Misc/SIMD.hpp>
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+using namespace IO::ADT;
+using namespace IO::Common;
+
+namespace
+{
+  using IO::Common::DataStructures::C3Vector;
+
+  constexpr unsigned N_QUADS_CHUNK_ROW = WorldConstants::N_VERTS_CHUNK_ROW_INNER;
+  constexpr unsigned N_CHUNKS_TILE_ROW = 16;
+  constexpr unsigned N_CHUNKS_MAP_ROW = N_CHUNKS_TILE_ROW * 64;
+  constexpr unsigned VERTEX_ROW_STRIDE = WorldConstants::N_VERTS_CHUNK_ROW_OUTER + WorldConstants::N_VERTS_CHUNK_ROW_INNER;
+  constexpr float QUAD_SIZE = WorldConstants::CHUNK_SIZE / N_QUADS_CHUNK_ROW;
+  constexpr float MAP_SIZE = WorldConstants::TILE_SIZE * 64;
+
+  // number of queries claimed by a worker at once
+  constexpr std::size_t QUERY_BATCH_SIZE = 64;
+
+  constexpr float INF = std::numeric_limits<float>::infinity();
+
+  /**
+   * Walks the cells of a square grid crossed by the horizontal projection of a segment, in order (2D DDA).
+   * Callback must match signature bool(unsigned x, unsigned z, float t_in, float t_out). Returning true stops the walk.
+   * @return True if the walk was stopped by callback.
+   */
+  template<typename Callback>
+  bool TraverseGrid(C3Vector const& from
+                    , C3Vector const& delta
+                    , float t_begin
+                    , float t_end
+                    , float origin_x
+                    , float origin_z
+                    , float cell_size
+                    , int n_cells
+                    , Callback&& callback)
+  {
+    float const pos_x = from.x + delta.x * t_begin - origin_x;
+    float const pos_z = from.z + delta.z * t_begin - origin_z;
+
+    int x = std::clamp(static_cast<int>(std::floor(pos_x / cell_size)), 0, n_cells - 1);
+    int z = std::clamp(static_cast<int>(std::floor(pos_z / cell_size)), 0, n_cells - 1);
+
+    int const step_x = delta.x > 0.f ? 1 : -1;
+    int const step_z = delta.z > 0.f ? 1 : -1;
+
+    float const t_delta_x = delta.x != 0.f ? cell_size / std::abs(delta.x) : INF;
+    float const t_delta_z = delta.z != 0.f ? cell_size / std::abs(delta.z) : INF;
+
+    float t_next_x = delta.x != 0.f
+      ? t_begin + (static_cast<float>(x + (delta.x > 0.f)) * cell_size - pos_x) / delta.x : INF;
+    float t_next_z = delta.z != 0.f
+      ? t_begin + (static_cast<float>(z + (delta.z > 0.f)) * cell_size - pos_z) / delta.z : INF;
+
+    float t = t_begin;
+
+    while (true)
+    {
+      float const t_out = std::min({t_next_x, t_next_z, t_end});
+
+      if (callback(static_cast<unsigned>(x), static_cast<unsigned>(z), t, t_out))
+        return true;
+
+      if (t_out >= t_end)
+        return false;
+
+      if (t_next_x < t_next_z)
+      {
+        x += step_x;
+        t = t_next_x;
+        t_next_x += t_delta_x;
+      }
+      else
+      {
+        z += step_z;
+        t = t_next_z;
+        t_next_z += t_delta_z;
+      }
+
+      if (x < 0 || x >= n_cells || z < 0 || z >= n_cells)
+        return false;
+    }
+  }
+
+  using Corners = std::array<C3Vector, 4>;
+
+  /**
+   * Intersects a segment with the triangle fan of a quad, given in coordinates local to its top-left corner.
+   * Must match signature: float(C3Vector const& center, Corners const& corners, C3Vector const& origin
+   *                             , C3Vector const& delta, float t_begin, float t_end).
+   * Returns the first parameter within [t_begin, t_end] at which the segment hits one of the triangles, else +inf.
+   */
+  using FanHitFunction = float (*)(C3Vector const&, Corners const&, C3Vector const&, C3Vector const&, float, float);
+
+  float FanHit(C3Vector const& center
+               , Corners const& corners
+               , C3Vector const& origin
+               , C3Vector const& delta
+               , float t_begin
+               , float t_end)
+  {
+    // all four triangles are tested without early exit, which keeps the loop free of data-dependent branches
+    std::array<float, 4> t_hits {};
+
+    for (unsigned i = 0; i < 4; ++i)
+    {
+      C3Vector const& v1 = corners[i];
+      C3Vector const& v2 = corners[(i + 1) % 4];
+
+      C3Vector const e1 {v1.x - center.x, v1.y - center.y, v1.z - center.z};
+      C3Vector const e2 {v2.x - center.x, v2.y - center.y, v2.z - center.z};
+
+      // Moller-Trumbore
+      C3Vector const p {delta.y * e2.z - delta.z * e2.y, delta.z * e2.x - delta.x * e2.z, delta.x * e2.y - delta.y * e2.x};
+      float const det = e1.x * p.x + e1.y * p.y + e1.z * p.z;
+      float const inv_det = det != 0.f ? 1.f / det : 0.f;
+
+      C3Vector const s {origin.x - center.x, origin.y - center.y, origin.z - center.z};
+      float const u = (s.x * p.x + s.y * p.y + s.z * p.z) * inv_det;
+
+      C3Vector const q {s.y * e1.z - s.z * e1.y, s.z * e1.x - s.x * e1.z, s.x * e1.y - s.y * e1.x};
+      float const v = (delta.x * q.x + delta.y * q.y + delta.z * q.z) * inv_det;
+      float const t = (e2.x * q.x + e2.y * q.y + e2.z * q.z) * inv_det;
+
+      bool const is_hit = det != 0.f && u >= 0.f && v >= 0.f && u + v <= 1.f && t >= t_begin && t <= t_end;
+      t_hits[i] = is_hit ? t : INF;
+    }
+
+    return *std::min_element(t_hits.begin(), t_hits.end());
+  }
+
+#if defined(UTILS_SIMD)
+  /**
+   * Same as FanHit(), bit for bit, with one triangle per lane. Products are summed in the same order and never fused,
+   * and the closest hit is picked from the stored lanes like the scalar path does.
+   */
+  float FanHitSIMD(C3Vector const& center
+                   , Corners const& corners
+                   , C3Vector const& origin
+                   , C3Vector const& delta
+                   , float t_begin
+                   , float t_end)
+  {
+    alignas(16) std::array<float, 4> t_hits;
+
+#if defined(UTILS_SIMD_SSE2)
+    __m128 const center_x = _mm_set1_ps(center.x);
+    __m128 const center_y = _mm_set1_ps(center.y);
+    __m128 const center_z = _mm_set1_ps(center.z);
+
+    // lane i holds edges of triangle i: first corner i, second corner i + 1
+    __m128 const e1_x = _mm_sub_ps(_mm_setr_ps(corners[0].x, corners[1].x, corners[2].x, corners[3].x), center_x);
+    __m128 const e1_y = _mm_sub_ps(_mm_setr_ps(corners[0].y, corners[1].y, corners[2].y, corners[3].y), center_y);
+    __m128 const e1_z = _mm_sub_ps(_mm_setr_ps(corners[0].z, corners[1].z, corners[2].z, corners[3].z), center_z);
+    __m128 const e2_x = _mm_shuffle_ps(e1_x, e1_x, _MM_SHUFFLE(0, 3, 2, 1));
+    __m128 const e2_y = _mm_shuffle_ps(e1_y, e1_y, _MM_SHUFFLE(0, 3, 2, 1));
+    __m128 const e2_z = _mm_shuffle_ps(e1_z, e1_z, _MM_SHUFFLE(0, 3, 2, 1));
+
+    __m128 const d_x = _mm_set1_ps(delta.x);
+    __m128 const d_y = _mm_set1_ps(delta.y);
+    __m128 const d_z = _mm_set1_ps(delta.z);
+
+    __m128 const p_x = _mm_sub_ps(_mm_mul_ps(d_y, e2_z), _mm_mul_ps(d_z, e2_y));
+    __m128 const p_y = _mm_sub_ps(_mm_mul_ps(d_z, e2_x), _mm_mul_ps(d_x, e2_z));
+    __m128 const p_z = _mm_sub_ps(_mm_mul_ps(d_x, e2_y), _mm_mul_ps(d_y, e2_x));
+
+    __m128 const det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1_x, p_x), _mm_mul_ps(e1_y, p_y)), _mm_mul_ps(e1_z, p_z));
+    __m128 const is_det = _mm_cmpneq_ps(det, _mm_setzero_ps());
+    __m128 const inv_det = _mm_and_ps(is_det, _mm_div_ps(_mm_set1_ps(1.f), det));
+
+    __m128 const s_x = _mm_set1_ps(origin.x - center.x);
+    __m128 const s_y = _mm_set1_ps(origin.y - center.y);
+    __m128 const s_z = _mm_set1_ps(origin.z - center.z);
+
+    __m128 const u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(s_x, p_x), _mm_mul_ps(s_y, p_y)), _mm_mul_ps(s_z, p_z))
+                                , inv_det);
+
+    __m128 const q_x = _mm_sub_ps(_mm_mul_ps(s_y, e1_z), _mm_mul_ps(s_z, e1_y));
+    __m128 const q_y = _mm_sub_ps(_mm_mul_ps(s_z, e1_x), _mm_mul_ps(s_x, e1_z));
+    __m128 const q_z = _mm_sub_ps(_mm_mul_ps(s_x, e1_y), _mm_mul_ps(s_y, e1_x));
+
+    __m128 const v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(d_x, q_x), _mm_mul_ps(d_y, q_y)), _mm_mul_ps(d_z, q_z))
+                                , inv_det);
+    __m128 const t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2_x, q_x), _mm_mul_ps(e2_y, q_y)), _mm_mul_ps(e2_z, q_z))
+                                , inv_det);
+
+    __m128 const zero = _mm_setzero_ps();
+    __m128 is_hit = _mm_and_ps(is_det, _mm_cmpge_ps(u, zero));
+    is_hit = _mm_and_ps(is_hit, _mm_cmpge_ps(v, zero));
+    is_hit = _mm_and_ps(is_hit, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.f)));
+    is_hit = _mm_and_ps(is_hit, _mm_cmpge_ps(t, _mm_set1_ps(t_begin)));
+    is_hit = _mm_and_ps(is_hit, _mm_cmple_ps(t, _mm_set1_ps(t_end)));
+
+    _mm_store_ps(t_hits.data(), _mm_or_ps(_mm_and_ps(is_hit, t), _mm_andnot_ps(is_hit, _mm_set1_ps(INF))));
+#else
+    float32x4_t const center_x = vdupq_n_f32(center.x);
+    float32x4_t const center_y = vdupq_n_f32(center.y);
+    float32x4_t const center_z = vdupq_n_f32(center.z);
+
+    alignas(16) std::array<float, 4> const corners_x {corners[0].x, corners[1].x, corners[2].x, corners[3].x};
+    alignas(16) std::array<float, 4> const corners_y {corners[0].y, corners[1].y, corners[2].y, corners[3].y};
+    alignas(16) std::array<float, 4> const corners_z {corners[0].z, corners[1].z, corners[2].z, corners[3].z};
+
+    // lane i holds edges of triangle i: first corner i, second corner i + 1
+    float32x4_t const e1_x = vsubq_f32(vld1q_f32(corners_x.data()), center_x);
+    float32x4_t const e1_y = vsubq_f32(vld1q_f32(corners_y.data()), center_y);
+    float32x4_t const e1_z = vsubq_f32(vld1q_f32(corners_z.data()), center_z);
+    float32x4_t const e2_x = vextq_f32(e1_x, e1_x, 1);
+    float32x4_t const e2_y = vextq_f32(e1_y, e1_y, 1);
+    float32x4_t const e2_z = vextq_f32(e1_z, e1_z, 1);
+
+    float32x4_t const d_x = vdupq_n_f32(delta.x);
+    float32x4_t const d_y = vdupq_n_f32(delta.y);
+    float32x4_t const d_z = vdupq_n_f32(delta.z);
+
+    float32x4_t const p_x = vsubq_f32(vmulq_f32(d_y, e2_z), vmulq_f32(d_z, e2_y));
+    float32x4_t const p_y = vsubq_f32(vmulq_f32(d_z, e2_x), vmulq_f32(d_x, e2_z));
+    float32x4_t const p_z = vsubq_f32(vmulq_f32(d_x, e2_y), vmulq_f32(d_y, e2_x));
+
+    float32x4_t const det = vaddq_f32(vaddq_f32(vmulq_f32(e1_x, p_x), vmulq_f32(e1_y, p_y)), vmulq_f32(e1_z, p_z));
+    uint32x4_t const is_det = vmvnq_u32(vceqq_f32(det, vdupq_n_f32(0.f)));
+    float32x4_t const inv_det = vreinterpretq_f32_u32(vandq_u32(is_det
+                                                                , vreinterpretq_u32_f32(vdivq_f32(vdupq_n_f32(1.f), det))));
+
+    float32x4_t const s_x = vdupq_n_f32(origin.x - center.x);
+    float32x4_t const s_y = vdupq_n_f32(origin.y - center.y);
+    float32x4_t const s_z = vdupq_n_f32(origin.z - center.z);
+
+    float32x4_t const u = vmulq_f32(vaddq_f32(vaddq_f32(vmulq_f32(s_x, p_x), vmulq_f32(s_y, p_y)), vmulq_f32(s_z, p_z))
+                                    , inv_det);
+
+    float32x4_t const q_x = vsubq_f32(vmulq_f32(s_y, e1_z), vmulq_f32(s_z, e1_y));
+    float32x4_t const q_y = vsubq_f32(vmulq_f32(s_z, e1_x), vmulq_f32(s_x, e1_z));
+    float32x4_t const q_z = vsubq_f32(vmulq_f32(s_x, e1_y), vmulq_f32(s_y, e1_x));
+
+    float32x4_t const v = vmulq_f32(vaddq_f32(vaddq_f32(vmulq_f32(d_x, q_x), vmulq_f32(d_y, q_y)), vmulq_f32(d_z, q_z))
+                                    , inv_det);
+    float32x4_t const t = vmulq_f32(vaddq_f32(vaddq_f32(vmulq_f32(e2_x, q_x), vmulq_f32(e2_y, q_y)), vmulq_f32(e2_z, q_z))
+                                    , inv_det);
+
+    float32x4_t const zero = vdupq_n_f32(0.f);
+    uint32x4_t is_hit = vandq_u32(is_det, vcgeq_f32(u, zero));
+    is_hit = vandq_u32(is_hit, vcgeq_f32(v, zero));
+    is_hit = vandq_u32(is_hit, vcleq_f32(vaddq_f32(u, v), vdupq_n_f32(1.f)));
+    is_hit = vandq_u32(is_hit, vcgeq_f32(t, vdupq_n_f32(t_begin)));
+    is_hit = vandq_u32(is_hit, vcleq_f32(t, vdupq_n_f32(t_end)));
+
+    vst1q_f32(t_hits.data(), vbslq_f32(is_hit, t, vdupq_n_f32(INF)));
+#endif
+
+    return *std::min_element(t_hits.begin(), t_hits.end());
+  }
+#endif
+
+  /**
+   * Clips parameter range of a segment to the horizontal bounds of the map.
+   * @return False if segment does not cross the map.
+   */
+  bool ClipToMap(C3Vector const& from, C3Vector const& delta, float& t_begin, float& t_end)
+  {
+    auto clip_axis = [&](float origin, float direction) -> bool
+    {
+      if (direction == 0.f)
+        return origin >= 0.f && origin <= MAP_SIZE;
+
+      float t0 = (0.f - origin) / direction;
+      float t1 = (MAP_SIZE - origin) / direction;
+
+      if (t0 > t1)
+        std::swap(t0, t1);
+
+      t_begin = std::max(t_begin, t0);
+      t_end = std::min(t_end, t1);
+      return t_begin <= t_end;
+    };
+
+    return clip_axis(from.x, delta.x) && clip_axis(from.z, delta.z);
+  }
+}
+
+struct TerrainRaycaster::ChunkBounds
+{
+  std::array<float, WorldConstants::CHUNK_BUF_SIZE> heights; ///> Absolute vertex heights.
+  std::array<float, N_QUADS_CHUNK_ROW * N_QUADS_CHUNK_ROW> quad_min;
+  std::array<float, N_QUADS_CHUNK_ROW * N_QUADS_CHUNK_ROW> quad_max;
+  float min; ///> Minimum height of non-hole quads. +inf if chunk is fully hole.
+  float max; ///> Maximum height of non-hole quads. -inf if chunk is fully hole.
+  std::uint64_t holes; ///> Per-quad hole mask, see ChunkHoleMask().
+};
+
+struct TerrainRaycaster::TileBounds
+{
+  std::array<ChunkBounds, WorldConstants::CHUNKS_PER_TILE> chunks;
+};
+
+TerrainRaycaster::TerrainRaycaster(TerrainLoader loader)
+: _loader(std::move(loader))
+, _tiles(std::make_unique<std::array<TileSlot, WorldConstants::MAX_TILES_PER_MAP>>())
+{
+}
+
+TerrainRaycaster::~TerrainRaycaster() = default;
+
+std::vector<TerrainHit> TerrainRaycaster::Raycast(std::vector<TerrainSegment> const& segments, unsigned n_threads)
+{
+  std::vector<TerrainHit> hits(segments.size());
+
+  Utils::Misc::ParallelFor((segments.size() + QUERY_BATCH_SIZE - 1) / QUERY_BATCH_SIZE, [&](std::size_t batch)
+  {
+    std::size_t const end = std::min(segments.size(), (batch + 1) * QUERY_BATCH_SIZE);
+
+    for (std::size_t i = batch * QUERY_BATCH_SIZE; i < end; ++i)
+      hits[i] = Query(segments[i]);
+  }, n_threads);
+
+  return hits;
+}
+
+std::vector<bool> TerrainRaycaster::LineOfSight(std::vector<TerrainSegment> const& segments, unsigned n_threads)
+{
+  // std::vector<bool> is not safe for concurrent writes of distinct elements
+  std::vector<std::uint8_t> visible(segments.size());
+
+  Utils::Misc::ParallelFor((segments.size() + QUERY_BATCH_SIZE - 1) / QUERY_BATCH_SIZE, [&](std::size_t batch)
+  {
+    std::size_t const end = std::min(segments.size(), (batch + 1) * QUERY_BATCH_SIZE);
+
+    for (std::size_t i = batch * QUERY_BATCH_SIZE; i < end; ++i)
+      visible[i] = !Query(segments[i]).hit;
+  }, n_threads);
+
+  return {visible.begin(), visible.end()};
+}
+
+void TerrainRaycaster::InvalidateTile(Common::DataStructures::TileIndex tile_index)
+{
+  RequireF(CCodeZones::FILE_IO, tile_index.x < 64 && tile_index.y < 64, "Tile index out of bounds.");
+
+  TileSlot& slot = (*_tiles)[tile_index.y * 64 + tile_index.x];
+  std::lock_guard lock {slot.mutex};
+  slot.is_loaded = false;
+  slot.bounds.reset();
+}
+
+void TerrainRaycaster::InvalidateAllTiles()
+{
+  for (TileSlot& slot : *_tiles)
+  {
+    std::lock_guard lock {slot.mutex};
+    slot.is_loaded = false;
+    slot.bounds.reset();
+  }
+}
+
+std::shared_ptr<TerrainRaycaster::TileBounds const> TerrainRaycaster::AcquireTile(std::uint32_t tile_id)
+{
+  TileSlot& slot = (*_tiles)[tile_id];
+
+  // other threads requesting the same tile wait for it to be built instead of building it again
+  std::lock_guard lock {slot.mutex};
+
+  if (slot.is_loaded)
+    return slot.bounds;
+
+  Common::DataStructures::TileIndex const tile_index {static_cast<std::uint16_t>(tile_id % 64)
+                                                      , static_cast<std::uint16_t>(tile_id / 64)};
+
+  // terrain is too large to be kept on the stack of a worker thread
+  auto terrain = std::make_unique<TileTerrain>();
+
+  // a throwing loader leaves the tile unloaded, so it is retried on next access
+  bool const exists = _loader(tile_index, *terrain);
+  slot.is_loaded = true;
+
+  if (!exists)
+    return nullptr;
+
+  LogDebugF(LCodeZones::FILE_IO, "Building raycast bounds of tile (%d, %d).", tile_index.x, tile_index.y);
+
+  auto bounds = std::make_shared<TileBounds>();
+
+  for (std::size_t i = 0; i < WorldConstants::CHUNKS_PER_TILE; ++i)
+  {
+    ChunkTerrain const& chunk_terrain = (*terrain)[i];
+    ChunkBounds& chunk = bounds->chunks[i];
+
+    std::transform(chunk_terrain.heightmap.begin(), chunk_terrain.heightmap.end(), chunk.heights.begin()
+                   , [base = chunk_terrain.header.position.z](float height) { return base + height; });
+
+    chunk.holes = ChunkHoleMask(chunk_terrain.header);
+    chunk.min = INF;
+    chunk.max = -INF;
+
+    for (unsigned y = 0; y < N_QUADS_CHUNK_ROW; ++y)
+    {
+      for (unsigned x = 0; x < N_QUADS_CHUNK_ROW; ++x)
+      {
+        unsigned const top_left = y * VERTEX_ROW_STRIDE + x;
+        unsigned const bottom_left = top_left + VERTEX_ROW_STRIDE;
+
+        auto const [quad_min, quad_max] = std::minmax({chunk.heights[top_left]
+                                                       , chunk.heights[top_left + 1]
+                                                       , chunk.heights[top_left + WorldConstants::N_VERTS_CHUNK_ROW_OUTER]
+                                                       , chunk.heights[bottom_left]
+                                                       , chunk.heights[bottom_left + 1]});
+
+        unsigned const quad = y * N_QUADS_CHUNK_ROW + x;
+        chunk.quad_min[quad] = quad_min;
+        chunk.quad_max[quad] = quad_max;
+
+        if (chunk.holes & (std::uint64_t{1} << quad))
+          continue;
+
+        chunk.min = std::min(chunk.min, quad_min);
+        chunk.max = std::max(chunk.max, quad_max);
+      }
+    }
+  }
+
+  slot.bounds = std::move(bounds);
+  return slot.bounds;
+}
+
+TerrainHit TerrainRaycaster::Query(TerrainSegment const& segment)
+{
+  C3Vector const& from = segment.from;
+  C3Vector const delta {segment.to.x - from.x, segment.to.y - from.y, segment.to.z - from.z};
+
+  TerrainHit result {};
+  float t_begin = 0.f;
+  float t_end = 1.f;
+
+  if (!ClipToMap(from, delta, t_begin, t_end))
+    return result;
+
+  auto height_range = [&](float t_in, float t_out) -> std::pair<float, float>
+  {
+    return std::minmax(from.y + delta.y * t_in, from.y + delta.y * t_out);
+  };
+
+  FanHitFunction fan_hit = &FanHit;
+
+#if defined(UTILS_SIMD)
+  if (Utils::Misc::SIMD::IsEnabled())
+    fan_hit = &FanHitSIMD;
+#endif
+
+  // queries tend to stay within one tile
+  std::uint32_t cached_tile_id = std::numeric_limits<std::uint32_t>::max();
+  std::shared_ptr<TileBounds const> cached_tile;
+
+  auto visit_chunk = [&](unsigned chunk_x, unsigned chunk_z, float t_in, float t_out) -> bool
+  {
+    std::uint32_t const tile_id = (chunk_z / N_CHUNKS_TILE_ROW) * 64 + chunk_x / N_CHUNKS_TILE_ROW;
+
+    if (tile_id != cached_tile_id)
+    {
+      cached_tile = AcquireTile(tile_id);
+      cached_tile_id = tile_id;
+    }
+
+    if (!cached_tile)
+      return false;
+
+    ChunkBounds const& chunk = cached_tile->chunks[(chunk_z % N_CHUNKS_TILE_ROW) * N_CHUNKS_TILE_ROW
+                                                   + chunk_x % N_CHUNKS_TILE_ROW];
+
+    auto const [y_min, y_max] = height_range(t_in, t_out);
+
+    if (y_max < chunk.min || y_min > chunk.max)
+      return false;
+
+    float const chunk_origin_x = static_cast<float>(chunk_x) * WorldConstants::CHUNK_SIZE;
+    float const chunk_origin_z = static_cast<float>(chunk_z) * WorldConstants::CHUNK_SIZE;
+
+    auto visit_quad = [&](unsigned quad_x, unsigned quad_z, float quad_t_in, float quad_t_out) -> bool
+    {
+      unsigned const quad = quad_z * N_QUADS_CHUNK_ROW + quad_x;
+
+      if (chunk.holes & (std::uint64_t{1} << quad))
+        return false;
+
+      auto const [quad_y_min, quad_y_max] = height_range(quad_t_in, quad_t_out);
+
+      if (quad_y_max < chunk.quad_min[quad] || quad_y_min > chunk.quad_max[quad])
+        return false;
+
+      // triangle fan around the inner vertex, in coordinates local to the top-left corner of the quad
+      unsigned const top_left = quad_z * VERTEX_ROW_STRIDE + quad_x;
+      unsigned const bottom_left = top_left + VERTEX_ROW_STRIDE;
+
+      C3Vector const origin {from.x - (chunk_origin_x + static_cast<float>(quad_x) * QUAD_SIZE)
+                             , from.y
+                             , from.z - (chunk_origin_z + static_cast<float>(quad_z) * QUAD_SIZE)};
+
+      C3Vector const center {QUAD_SIZE / 2.f, chunk.heights[top_left + WorldConstants::N_VERTS_CHUNK_ROW_OUTER]
+                             , QUAD_SIZE / 2.f};
+
+      Corners const corners
+      {
+        C3Vector{0.f, chunk.heights[top_left], 0.f}
+        , C3Vector{QUAD_SIZE, chunk.heights[top_left + 1], 0.f}
+        , C3Vector{QUAD_SIZE, chunk.heights[bottom_left + 1], QUAD_SIZE}
+        , C3Vector{0.f, chunk.heights[bottom_left], QUAD_SIZE}
+      };
+
+      float const t_hit = fan_hit(center, corners, origin, delta, t_begin, t_end);
+
+      if (t_hit == INF)
+        return false;
+
+      // quads are visited in segment order, so the first hit found is the closest one
+      result.hit = true;
+      result.t = t_hit;
+      return true;
+    };
+
+    return TraverseGrid(from, delta, t_in, t_out, chunk_origin_x, chunk_origin_z
+                        , QUAD_SIZE, N_QUADS_CHUNK_ROW, visit_quad);
+  };
+
+  TraverseGrid(from, delta, t_begin, t_end, 0.f, 0.f, WorldConstants::CHUNK_SIZE, N_CHUNKS_MAP_ROW, visit_chunk);
+
+  if (result.hit)
+    result.position = {from.x + delta.x * result.t, from.y + delta.y * result.t, from.z + delta.z * result.t};
+
+  return result;
+}
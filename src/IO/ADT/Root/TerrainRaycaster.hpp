@@ -0,0 +1,103 @@
+#pragma once
+#include <IO/Common.hpp>
+#include <IO/CommonDataStructures.hpp>
+#include <IO/WorldConstants.hpp>
+#include <IO/ADT/Root/TileTerrain.hpp>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace IO::ADT
+{
+  /**
+   * Line segment in placement coordinates (x and z are horizontal, relative to the map corner, y is up).
+   */
+  struct TerrainSegment
+  {
+    Common::DataStructures::C3Vector from;
+    Common::DataStructures::C3Vector to;
+  };
+
+  /**
+   * Result of a segment query against terrain.
+   */
+  struct TerrainHit
+  {
+    bool hit = false; ///> Segment intersects terrain.
+    float t = 1.f; ///> Position of the first intersection along the segment, [0, 1].
+    Common::DataStructures::C3Vector position {}; ///> Point of the first intersection.
+  };
+
+  /**
+   * Answers batches of segment queries (raycasts, line of sight) against map terrain.
+   * Segments are traversed over the chunk grid, and then over the quad grid of each chunk, skipping cells whose
+   * height bounds the segment does not reach. Only the triangles of the remaining quads are tested. Holes are respected.
+   * Acceleration data of a tile is built on first access and kept until the tile is invalidated.
+   */
+  class TerrainRaycaster
+  {
+  public:
+    /**
+     * Loads terrain of a tile. Invoked concurrently from worker threads, must be thread-safe.
+     * Must match signature: bool(Common::DataStructures::TileIndex tile_index, TileTerrain& terrain).
+     * Returns false if tile does not exist, in which case it has no terrain to collide with.
+     */
+    using TerrainLoader = std::function<bool(Common::DataStructures::TileIndex, TileTerrain&)>;
+
+    explicit TerrainRaycaster(TerrainLoader loader);
+    ~TerrainRaycaster();
+
+    /**
+     * Finds the first intersection of each segment with terrain.
+     * @param segments Segments to test.
+     * @param n_threads Number of worker threads. 0 means hardware concurrency.
+     * @return Hit for each segment, in the same order.
+     */
+    [[nodiscard]]
+    std::vector<TerrainHit> Raycast(std::vector<TerrainSegment> const& segments, unsigned n_threads = 0);
+
+    /**
+     * Tests whether end points of each segment see each other over terrain.
+     * @param segments Segments to test.
+     * @param n_threads Number of worker threads. 0 means hardware concurrency.
+     * @return True for each segment not obstructed by terrain, in the same order.
+     */
+    [[nodiscard]]
+    std::vector<bool> LineOfSight(std::vector<TerrainSegment> const& segments, unsigned n_threads = 0);
+
+    /**
+     * Drops acceleration data of a tile, e.g. after its terrain was edited. It is rebuilt on next access.
+     * Must not be called concurrently with queries.
+     * @param tile_index Tile coordinates on WDT grid.
+     */
+    void InvalidateTile(Common::DataStructures::TileIndex tile_index);
+
+    /**
+     * Drops acceleration data of all tiles. Must not be called concurrently with queries.
+     */
+    void InvalidateAllTiles();
+
+  private:
+    struct ChunkBounds;
+    struct TileBounds;
+
+    struct TileSlot
+    {
+      std::mutex mutex;
+      bool is_loaded = false;
+      std::shared_ptr<TileBounds const> bounds;
+    };
+
+    [[nodiscard]]
+    std::shared_ptr<TileBounds const> AcquireTile(std::uint32_t tile_id);
+
+    TerrainHit Query(TerrainSegment const& segment);
+
+    TerrainLoader _loader;
+    std::unique_ptr<std::array<TileSlot, Common::WorldConstants::MAX_TILES_PER_MAP>> _tiles;
+  };
+}
@@ -0,0 +1,21 @@
+#include <IO/ADT/Root/TileTerrain.hpp>
+
+std::uint64_t IO::ADT::ChunkHoleMask(DataStructures::SMChunk const& header)
+{
+  if (header.flags.high_res_holes)
+    return header.holes_high_res;
+
+  // each low resolution hole covers 2x2 quads
+  std::uint64_t mask = 0;
+
+  for (unsigned y = 0; y < 8; ++y)
+  {
+    for (unsigned x = 0; x < 8; ++x)
+    {
+      if (header.holes_low_res & (1u << ((y / 2) * 4 + x / 2)))
+        mask |= std::uint64_t{1} << (y * 8 + x);
+    }
+  }
+
+  return mask;
+}
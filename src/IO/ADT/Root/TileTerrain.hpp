@@ -0,0 +1,48 @@
+#pragma once
+#include <IO/Common.hpp>
+#include <IO/WorldConstants.hpp>
+#include <IO/ADT/DataStructures.hpp>
+
+#include <array>
+#include <cstdint>
+
+namespace IO::ADT
+{
+  template<Common::ClientVersion client_version>
+  class ADTRoot;
+
+  /**
+   * Terrain geometry of one map chunk (MCNK), detached from the ADT it was read from.
+   */
+  struct ChunkTerrain
+  {
+    DataStructures::SMChunk header; ///> Chunk header, provides base height and holes.
+    std::array<float, Common::WorldConstants::CHUNK_BUF_SIZE> heightmap; ///> MCVT, relative to base height.
+    std::array<DataStructures::MCNREntry, Common::WorldConstants::CHUNK_BUF_SIZE> normals; ///> MCNR.
+    std::array<DataStructures::MCCVEntry, Common::WorldConstants::CHUNK_BUF_SIZE> vertex_colors; ///> MCCV, 0x7F if absent.
+  };
+
+  /**
+   * Terrain of all chunks of one map tile, row-major.
+   */
+  using TileTerrain = std::array<ChunkTerrain, Common::WorldConstants::CHUNKS_PER_TILE>;
+
+  /**
+   * Converts holes of a chunk into per-quad form regardless of the hole resolution used by the chunk.
+   * @param header Chunk header.
+   * @return Bit (y * 8 + x) is set if quad (x, y) of 8x8 chunk grid is a hole.
+   */
+  [[nodiscard]]
+  std::uint64_t ChunkHoleMask(DataStructures::SMChunk const& header);
+
+  /**
+   * Fills terrain data from a root ADT.
+   * @tparam client_version Version of the client.
+   * @param adt Root ADT of a tile.
+   * @param terrain Terrain to fill.
+   */
+  template<Common::ClientVersion client_version>
+  void ExtractTileTerrain(ADTRoot<client_version> const& adt, TileTerrain& terrain);
+}
+
+#include <IO/ADT/Root/TileTerrain.inl>
@@ -0,0 +1,24 @@
+#pragma once
+#include <IO/ADT/Root/TileTerrain.hpp>
+#include <Utils/Meta/Future.hpp>
+
+#include <algorithm>
+
+namespace IO::ADT
+{
+  template<Common::ClientVersion client_version>
+  void ExtractTileTerrain(ADTRoot<client_version> const& adt, TileTerrain& terrain)
+  {
+    for (auto&& [i, chunk] : future::enumerate(adt.Chunks()))
+    {
+      terrain[i].header = chunk.Header();
+      std::copy(chunk.Heightmap().begin(), chunk.Heightmap().end(), terrain[i].heightmap.begin());
+      std::copy(chunk.Normals().begin(), chunk.Normals().end(), terrain[i].normals.begin());
+
+      if (chunk.VertexColors().IsInitialized())
+        std::copy(chunk.VertexColors().begin(), chunk.VertexColors().end(), terrain[i].vertex_colors.begin());
+      else
+        terrain[i].vertex_colors.fill({0x7F, 0x7F, 0x7F, 0x7F});
+    }
+  }
+}
@@ -0,0 +1,882 @@
+#include <IO/ADT/SeamStitcher.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <Utils/Misc/SIMD.hpp>
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <memory>
+
+using namespace IO::ADT;
+using namespace IO::Common;
+using IO::Common::DataStructures::C3Vector;
+using IO::Common::DataStructures::TileIndex;
+
+namespace
+{
+  constexpr unsigned N_TILES = 64;
+  constexpr unsigned N_CHUNKS = 16;
+  constexpr unsigned N_QUADS = 8;
+  constexpr unsigned QUADS_PER_TILE = N_CHUNKS * N_QUADS;
+  constexpr unsigned MAP_CHUNKS = N_TILES * N_CHUNKS;
+  constexpr unsigned MAP_QUADS = MAP_CHUNKS * N_QUADS;
+  constexpr unsigned ROW_STRIDE = WorldConstants::N_VERTS_CHUNK_ROW_OUTER + WorldConstants::N_VERTS_CHUNK_ROW_INNER;
+  constexpr unsigned ALPHA_DIM = WorldConstants::ALPHAMAP_DIM;
+  constexpr float QUAD_SIZE = WorldConstants::CHUNK_SIZE / N_QUADS;
+
+  /**
+   * Tile held in memory while its seams and the seams of its neighbours are processed.
+   */
+  struct ResidentTile
+  {
+    unsigned index; ///> Tile index (y * 64 + x).
+    IO::ADT::TileTerrain terrain;
+    IO::ADT::TileTexturing texturing;
+    std::vector<std::uint8_t> dirty_normals; ///> Per chunk vertex (chunk * CHUNK_BUF_SIZE + vertex).
+    std::atomic<bool> has_dirty_normals = false; ///> Set by workers of neighbouring columns too.
+    std::atomic<bool> modified = false;
+
+    void MarkNormalDirty(unsigned chunk, unsigned vertex)
+    {
+      dirty_normals[chunk * WorldConstants::CHUNK_BUF_SIZE + vertex] = 1;
+      has_dirty_normals = true;
+    }
+  };
+
+  /**
+   * Copy of a map-wide outer vertex in one chunk.
+   */
+  struct VertexCopy
+  {
+    ResidentTile* tile;
+    unsigned chunk;
+    unsigned vertex;
+
+    [[nodiscard]]
+    IO::ADT::ChunkTerrain& Chunk() const { return tile->terrain[chunk]; };
+
+    [[nodiscard]]
+    float Height() const { return Chunk().header.position.z + Chunk().heightmap[vertex]; };
+  };
+
+  // an outer vertex is shared by up to 4 chunks at a chunk corner
+  using VertexCopies = std::array<VertexCopy, 4>;
+
+  /**
+   * Result of processing one tile column of a row, merged on the calling thread.
+   */
+  struct ColumnResult
+  {
+    IO::ADT::SeamReport report;
+    std::vector<std::pair<unsigned, unsigned>> changed_heights; ///> Map-wide outer vertex coordinates.
+  };
+
+  class TileWindow
+  {
+  public:
+    [[nodiscard]]
+    ResidentTile* Tile(unsigned x, unsigned y) const
+    {
+      return x < N_TILES && y < N_TILES ? _tiles[y * N_TILES + x].get() : nullptr;
+    };
+
+    [[nodiscard]]
+    std::unique_ptr<ResidentTile>& Slot(unsigned x, unsigned y) { return _tiles[y * N_TILES + x]; };
+
+    /**
+     * Collects copies of map-wide outer vertex (x, y), in [0, MAP_QUADS], held by resident tiles.
+     * @return Number of copies.
+     */
+    unsigned OuterVertexCopies(unsigned x, unsigned y, VertexCopies& copies) const
+    {
+      unsigned const chunk_x_first = x % N_QUADS == 0 && x ? x / N_QUADS - 1 : x / N_QUADS;
+      unsigned const chunk_y_first = y % N_QUADS == 0 && y ? y / N_QUADS - 1 : y / N_QUADS;
+      unsigned const chunk_x_last = std::min(x / N_QUADS, MAP_CHUNKS - 1);
+      unsigned const chunk_y_last = std::min(y / N_QUADS, MAP_CHUNKS - 1);
+
+      unsigned n_copies = 0;
+
+      for (unsigned chunk_y = chunk_y_first; chunk_y <= chunk_y_last; ++chunk_y)
+      {
+        for (unsigned chunk_x = chunk_x_first; chunk_x <= chunk_x_last; ++chunk_x)
+        {
+          ResidentTile* tile = Tile(chunk_x / N_CHUNKS, chunk_y / N_CHUNKS);
+
+          if (!tile)
+            continue;
+
+          copies[n_copies++] = {tile
+                                , (chunk_y % N_CHUNKS) * N_CHUNKS + chunk_x % N_CHUNKS
+                                , (y - chunk_y * N_QUADS) * ROW_STRIDE + (x - chunk_x * N_QUADS)};
+        }
+      }
+
+      return n_copies;
+    }
+
+    /**
+     * Height of map-wide outer vertex (x, y), signed to allow probing past the map border.
+     * @return False if the vertex is outside of the map or its tiles are not resident.
+     */
+    bool HeightAt(int x, int y, float& height) const
+    {
+      if (x < 0 || y < 0 || x > static_cast<int>(MAP_QUADS) || y > static_cast<int>(MAP_QUADS))
+        return false;
+
+      VertexCopies copies;
+
+      if (!OuterVertexCopies(static_cast<unsigned>(x), static_cast<unsigned>(y), copies))
+        return false;
+
+      height = copies[0].Height();
+      return true;
+    }
+
+  private:
+    std::array<std::unique_ptr<ResidentTile>, N_TILES * N_TILES> _tiles;
+  };
+
+  bool IsAuthoritative(IO::ADT::SeamSettings const& settings, ResidentTile const* tile)
+  {
+    return settings.policy == IO::ADT::SeamRepairPolicy::AUTHORITATIVE && settings.authoritative_tiles[tile->index];
+  }
+
+  /**
+   * Value copies are repaired to: average of authoritative copies if there are any, else of all copies.
+   */
+  template<std::size_t N>
+  float RepairTarget(std::array<float, N> const& values, std::array<bool, N> const& authoritative, unsigned n)
+  {
+    float sum = 0.f, authoritative_sum = 0.f;
+    unsigned n_authoritative = 0;
+
+    for (unsigned i = 0; i < n; ++i)
+    {
+      sum += values[i];
+      authoritative_sum += authoritative[i] ? values[i] : 0.f;
+      n_authoritative += authoritative[i];
+    }
+
+    return n_authoritative ? authoritative_sum / n_authoritative : sum / n;
+  }
+
+  using AlphaEdge = std::array<std::uint8_t, ALPHA_DIM>;
+
+  /**
+   * Flags pixels of an alpha edge differing from the facing pixels of the neighbour by more than the tolerance.
+   * Flags of previous layers are kept.
+   */
+  void MismatchingPixels(std::uint8_t const* edge, std::uint8_t const* neighbour_edge, int tolerance
+                         , AlphaEdge& mismatching)
+  {
+    for (unsigned i = 0; i < ALPHA_DIM; ++i)
+      mismatching[i] |= std::abs(edge[i] - neighbour_edge[i]) > tolerance;
+  }
+
+#if defined(UTILS_SIMD)
+  /**
+   * Same result as MismatchingPixels(), 16 pixels at a time. Absolute differences of bytes are at most 255,
+   * so tolerances outside of [0, 255) flag either every pixel or none.
+   */
+  void MismatchingPixelsSIMD(std::uint8_t const* edge, std::uint8_t const* neighbour_edge, int tolerance
+                             , AlphaEdge& mismatching)
+  {
+    if (tolerance < 0)
+    {
+      mismatching.fill(1);
+      return;
+    }
+
+    if (tolerance >= 255)
+      return;
+
+    auto const threshold = static_cast<std::uint8_t>(tolerance);
+
+    for (unsigned i = 0; i < ALPHA_DIM; i += 16)
+    {
+#if defined(UTILS_SIMD_SSE2)
+      __m128i const lhs = _mm_loadu_si128(reinterpret_cast<__m128i const*>(edge + i));
+      __m128i const rhs = _mm_loadu_si128(reinterpret_cast<__m128i const*>(neighbour_edge + i));
+      __m128i const difference = _mm_or_si128(_mm_subs_epu8(lhs, rhs), _mm_subs_epu8(rhs, lhs));
+
+      // there is no unsigned byte comparison, a difference above the tolerance does not saturate to zero
+      __m128i const excess = _mm_subs_epu8(difference, _mm_set1_epi8(static_cast<char>(threshold)));
+      __m128i const flags = _mm_andnot_si128(_mm_cmpeq_epi8(excess, _mm_setzero_si128()), _mm_set1_epi8(1));
+
+      __m128i* out = reinterpret_cast<__m128i*>(mismatching.data() + i);
+      _mm_storeu_si128(out, _mm_or_si128(_mm_loadu_si128(out), flags));
+#else
+      uint8x16_t const difference = vabdq_u8(vld1q_u8(edge + i), vld1q_u8(neighbour_edge + i));
+      uint8x16_t const flags = vandq_u8(vcgtq_u8(difference, vdupq_n_u8(threshold)), vdupq_n_u8(1));
+      vst1q_u8(mismatching.data() + i, vorrq_u8(vld1q_u8(mismatching.data() + i), flags));
+#endif
+    }
+  }
+#endif
+
+  std::uint8_t RoundChannel(float value)
+  {
+    return static_cast<std::uint8_t>(std::clamp(std::lround(value), 0l, 255l));
+  }
+
+  class Stitcher
+  {
+  public:
+    Stitcher(IO::ADT::SeamSettings const& settings, TileWindow& window)
+    : _settings(settings)
+    , _window(window)
+    , _repair(settings.policy != IO::ADT::SeamRepairPolicy::VALIDATE_ONLY)
+    {
+#if defined(UTILS_SIMD)
+      if (Utils::Misc::SIMD::IsEnabled())
+        _mismatching_pixels = &MismatchingPixelsSIMD;
+#endif
+    }
+
+    /**
+     * Compares and repairs heights, vertex colors and normals of shared outer vertices
+     * of a tile column, rows (row * 128, row * 128 + 128], and row 0 for the first row.
+     */
+    void StitchVertices(unsigned tile_x, unsigned tile_y, ColumnResult& result) const
+    {
+      unsigned const x_first = tile_x ? tile_x * QUADS_PER_TILE + 1 : 0;
+      unsigned const y_first = tile_y ? tile_y * QUADS_PER_TILE + 1 : 0;
+      unsigned const x_last = (tile_x + 1) * QUADS_PER_TILE;
+      unsigned const y_last = (tile_y + 1) * QUADS_PER_TILE;
+
+      for (unsigned y = y_first; y <= y_last; ++y)
+      {
+        // off chunk border rows, only vertices on vertical chunk borders are shared
+        unsigned const x_step = y % N_QUADS ? N_QUADS : 1;
+        unsigned const x_start = x_step == 1 ? x_first : (x_first + N_QUADS - 1) / N_QUADS * N_QUADS;
+
+        for (unsigned x = x_start; x <= x_last; x += x_step)
+        {
+          VertexCopies copies;
+          unsigned const n_copies = _window.OuterVertexCopies(x, y, copies);
+
+          if (n_copies < 2)
+            continue;
+
+          if (StitchVertex(copies, n_copies, result.report))
+            result.changed_heights.emplace_back(x, y);
+        }
+      }
+    }
+
+    /**
+     * Recomputes dirty normals of outer vertices of a tile column in the same rows as StitchVertices(),
+     * and of inner vertices of the tile.
+     */
+    void RecomputeNormals(unsigned tile_x, unsigned tile_y, std::size_t& n_recomputed) const
+    {
+      unsigned const x_first = tile_x ? tile_x * QUADS_PER_TILE + 1 : 0;
+      unsigned const y_first = tile_y ? tile_y * QUADS_PER_TILE + 1 : 0;
+      unsigned const x_last = (tile_x + 1) * QUADS_PER_TILE;
+      unsigned const y_last = (tile_y + 1) * QUADS_PER_TILE;
+
+      // outer vertices of the column are held by this tile and its right and lower neighbours
+      bool has_dirty = false;
+
+      for (unsigned i = 0; i < 4; ++i)
+      {
+        ResidentTile const* tile = _window.Tile(tile_x + i % 2, tile_y + i / 2);
+        has_dirty |= tile && tile->has_dirty_normals;
+      }
+
+      for (unsigned y = y_first; has_dirty && y <= y_last; ++y)
+      {
+        for (unsigned x = x_first; x <= x_last; ++x)
+        {
+          VertexCopies copies;
+          unsigned const n_copies = _window.OuterVertexCopies(x, y, copies);
+
+          bool dirty = false;
+
+          for (unsigned i = 0; i < n_copies; ++i)
+            dirty |= IsDirty(copies[i]);
+
+          if (!dirty)
+            continue;
+
+          IO::ADT::DataStructures::MCNREntry const normal = OuterNormal(x, y);
+
+          for (unsigned i = 0; i < n_copies; ++i)
+          {
+            copies[i].Chunk().normals[copies[i].vertex] = normal;
+            copies[i].tile->dirty_normals[copies[i].chunk * WorldConstants::CHUNK_BUF_SIZE + copies[i].vertex] = 0;
+            copies[i].tile->modified = true;
+          }
+
+          ++n_recomputed;
+        }
+      }
+
+      ResidentTile* tile = _window.Tile(tile_x, tile_y);
+
+      if (!tile)
+        return;
+
+      for (unsigned chunk = 0; chunk < WorldConstants::CHUNKS_PER_TILE; ++chunk)
+      {
+        for (unsigned quad = 0; quad < N_QUADS * N_QUADS; ++quad)
+        {
+          unsigned const vertex = (quad / N_QUADS) * ROW_STRIDE + WorldConstants::N_VERTS_CHUNK_ROW_OUTER + quad % N_QUADS;
+          std::uint8_t& dirty = tile->dirty_normals[chunk * WorldConstants::CHUNK_BUF_SIZE + vertex];
+
+          if (!dirty)
+            continue;
+
+          IO::ADT::ChunkTerrain& terrain = tile->terrain[chunk];
+          unsigned const corner = (quad / N_QUADS) * ROW_STRIDE + quad % N_QUADS;
+
+          float const h00 = terrain.heightmap[corner];
+          float const h10 = terrain.heightmap[corner + 1];
+          float const h01 = terrain.heightmap[corner + ROW_STRIDE];
+          float const h11 = terrain.heightmap[corner + ROW_STRIDE + 1];
+
+          terrain.normals[vertex] = Normal((h00 + h01) - (h10 + h11), 2.f * QUAD_SIZE, (h00 + h10) - (h01 + h11));
+          tile->modified = true;
+          dirty = 0;
+
+          ++n_recomputed;
+        }
+      }
+    }
+
+    /**
+     * Compares and repairs alpha of pixels facing each other across vertical chunk borders (horizontal = false),
+     * or horizontal ones, of chunks of a tile and their right or lower neighbours.
+     */
+    void StitchAlpha(unsigned tile_x, unsigned tile_y, bool horizontal, IO::ADT::SeamReport& report) const
+    {
+      ResidentTile* tile = _window.Tile(tile_x, tile_y);
+
+      if (!tile)
+        return;
+
+      for (unsigned chunk = 0; chunk < WorldConstants::CHUNKS_PER_TILE; ++chunk)
+      {
+        unsigned const chunk_x = chunk % N_CHUNKS;
+        unsigned const chunk_y = chunk / N_CHUNKS;
+
+        ResidentTile* neighbour;
+        unsigned neighbour_chunk;
+
+        if (!horizontal)
+        {
+          neighbour = chunk_x + 1 < N_CHUNKS ? tile : _window.Tile(tile_x + 1, tile_y);
+          neighbour_chunk = chunk_y * N_CHUNKS + (chunk_x + 1) % N_CHUNKS;
+        }
+        else
+        {
+          neighbour = chunk_y + 1 < N_CHUNKS ? tile : _window.Tile(tile_x, tile_y + 1);
+          neighbour_chunk = ((chunk_y + 1) % N_CHUNKS) * N_CHUNKS + chunk_x;
+        }
+
+        if (!neighbour)
+          continue;
+
+        StitchAlphaEdge(*tile, chunk, *neighbour, neighbour_chunk, horizontal, report);
+      }
+    }
+
+  private:
+    bool StitchVertex(VertexCopies const& copies, unsigned n_copies, IO::ADT::SeamReport& report) const
+    {
+      std::array<float, 4> heights {};
+      std::array<bool, 4> authoritative {};
+
+      for (unsigned i = 0; i < n_copies; ++i)
+      {
+        heights[i] = copies[i].Height();
+        authoritative[i] = IsAuthoritative(_settings, copies[i].tile);
+      }
+
+      bool height_changed = false;
+
+      auto const [min_height, max_height] = std::minmax_element(heights.begin(), heights.begin() + n_copies);
+      float const height_error = *max_height - *min_height;
+
+      if (height_error > _settings.height_tolerance)
+      {
+        ++report.n_height_mismatches;
+        report.max_height_error = std::max(report.max_height_error, height_error);
+
+        if (_repair)
+        {
+          float const target = RepairTarget(heights, authoritative, n_copies);
+
+          for (unsigned i = 0; i < n_copies; ++i)
+          {
+            if (heights[i] == target)
+              continue;
+
+            copies[i].Chunk().heightmap[copies[i].vertex] = target - copies[i].Chunk().header.position.z;
+            copies[i].tile->modified = true;
+            height_changed = true;
+          }
+        }
+      }
+
+      StitchColors(copies, n_copies, authoritative, report);
+      StitchNormals(copies, n_copies, authoritative, report);
+
+      return height_changed;
+    }
+
+    void StitchColors(VertexCopies const& copies
+                      , unsigned n_copies
+                      , std::array<bool, 4> const& authoritative
+                      , IO::ADT::SeamReport& report) const
+    {
+      // channels as separate rows, compared in fixed-length loops
+      std::array<std::array<float, 4>, 4> channels {};
+
+      for (unsigned i = 0; i < n_copies; ++i)
+      {
+        auto const& color = copies[i].Chunk().vertex_colors[copies[i].vertex];
+        channels[0][i] = color.blue;
+        channels[1][i] = color.green;
+        channels[2][i] = color.red;
+        channels[3][i] = color.alpha;
+      }
+
+      float max_difference = 0.f;
+
+      for (auto const& channel : channels)
+      {
+        auto const [min, max] = std::minmax_element(channel.begin(), channel.begin() + n_copies);
+        max_difference = std::max(max_difference, *max - *min);
+      }
+
+      if (max_difference <= static_cast<float>(_settings.color_tolerance))
+        return;
+
+      ++report.n_color_mismatches;
+
+      if (!_repair)
+        return;
+
+      IO::ADT::DataStructures::MCCVEntry const target {RoundChannel(RepairTarget(channels[0], authoritative, n_copies))
+                                              , RoundChannel(RepairTarget(channels[1], authoritative, n_copies))
+                                              , RoundChannel(RepairTarget(channels[2], authoritative, n_copies))
+                                              , RoundChannel(RepairTarget(channels[3], authoritative, n_copies))};
+
+      for (unsigned i = 0; i < n_copies; ++i)
+      {
+        copies[i].Chunk().vertex_colors[copies[i].vertex] = target;
+        copies[i].Chunk().header.flags.has_mccv = 1;
+        copies[i].tile->modified = true;
+      }
+    }
+
+    void StitchNormals(VertexCopies const& copies
+                       , unsigned n_copies
+                       , std::array<bool, 4> const& authoritative
+                       , IO::ADT::SeamReport& report) const
+    {
+      std::array<std::array<float, 4>, 3> components {};
+
+      for (unsigned i = 0; i < n_copies; ++i)
+      {
+        for (unsigned c = 0; c < 3; ++c)
+          components[c][i] = copies[i].Chunk().normals[copies[i].vertex].normal[c];
+      }
+
+      float max_difference = 0.f;
+
+      for (auto const& component : components)
+      {
+        auto const [min, max] = std::minmax_element(component.begin(), component.begin() + n_copies);
+        max_difference = std::max(max_difference, *max - *min);
+      }
+
+      if (max_difference <= static_cast<float>(_settings.normal_tolerance))
+        return;
+
+      ++report.n_normal_mismatches;
+
+      if (!_repair)
+        return;
+
+      // recomputed normals are written to all copies, see RecomputeNormals()
+      if (_settings.recompute_normals)
+      {
+        for (unsigned i = 0; i < n_copies; ++i)
+          copies[i].tile->MarkNormalDirty(copies[i].chunk, copies[i].vertex);
+
+        return;
+      }
+
+      IO::ADT::DataStructures::MCNREntry target {};
+
+      for (unsigned c = 0; c < 3; ++c)
+        target.normal[c] = static_cast<std::int8_t>(std::lround(RepairTarget(components[c], authoritative, n_copies)));
+
+      for (unsigned i = 0; i < n_copies; ++i)
+      {
+        copies[i].Chunk().normals[copies[i].vertex] = target;
+        copies[i].tile->modified = true;
+      }
+    }
+
+    void StitchAlphaEdge(ResidentTile& tile
+                         , unsigned chunk
+                         , ResidentTile& neighbour
+                         , unsigned neighbour_chunk
+                         , bool horizontal
+                         , IO::ADT::SeamReport& report) const
+    {
+      IO::ADT::ChunkTexturing& texturing = tile.texturing.chunks[chunk];
+      IO::ADT::ChunkTexturing& neighbour_texturing = neighbour.texturing.chunks[neighbour_chunk];
+
+      if (texturing.layers.empty() || neighbour_texturing.layers.empty())
+        return;
+
+      bool same_layers = texturing.layers.size() == neighbour_texturing.layers.size()
+        && texturing.alphamaps.size() + 1 >= texturing.layers.size()
+        && neighbour_texturing.alphamaps.size() + 1 >= neighbour_texturing.layers.size();
+
+      for (std::size_t i = 0; same_layers && i < texturing.layers.size(); ++i)
+      {
+        std::uint32_t const texture = texturing.layers[i].textureId;
+        std::uint32_t const neighbour_texture = neighbour_texturing.layers[i].textureId;
+
+        same_layers = texture < tile.texturing.textures.size()
+          && neighbour_texture < neighbour.texturing.textures.size()
+          && tile.texturing.textures[texture] == neighbour.texturing.textures[neighbour_texture];
+      }
+
+      if (!same_layers)
+      {
+        ++report.n_layer_mismatches;
+        return;
+      }
+
+      std::size_t const n_alpha_layers = texturing.layers.size() - 1;
+
+      if (!n_alpha_layers)
+        return;
+
+      bool const authoritative = IsAuthoritative(_settings, &tile);
+      bool const neighbour_authoritative = IsAuthoritative(_settings, &neighbour);
+
+      // pixels along the border: last column / row of the chunk, first column / row of the neighbour
+      auto pixel = [horizontal](unsigned i, bool first)
+      {
+        unsigned const across = first ? 0 : ALPHA_DIM - 1;
+        return horizontal ? across * ALPHA_DIM + i : i * ALPHA_DIM + across;
+      };
+
+      // rows are contiguous, columns are gathered first
+      auto edge = [horizontal, &pixel](IO::ADT::Alphamap const& alpha, bool first, AlphaEdge& column)
+      {
+        if (horizontal)
+          return alpha.data() + pixel(0, first);
+
+        for (unsigned i = 0; i < ALPHA_DIM; ++i)
+          column[i] = alpha[pixel(i, first)];
+
+        return static_cast<std::uint8_t const*>(column.data());
+      };
+
+      AlphaEdge mismatching {};
+      AlphaEdge column, neighbour_column;
+
+      for (std::size_t layer = 0; layer < n_alpha_layers; ++layer)
+      {
+        _mismatching_pixels(edge(texturing.alphamaps[layer], false, column)
+                            , edge(neighbour_texturing.alphamaps[layer], true, neighbour_column)
+                            , _settings.alpha_tolerance, mismatching);
+      }
+
+      std::size_t n_mismatching = 0;
+
+      for (std::uint8_t value : mismatching)
+        n_mismatching += value;
+
+      report.n_alpha_mismatches += n_mismatching;
+
+      if (!n_mismatching || !_repair)
+        return;
+
+      for (std::size_t layer = 0; layer < n_alpha_layers; ++layer)
+      {
+        auto& alpha = texturing.alphamaps[layer];
+        auto& neighbour_alpha = neighbour_texturing.alphamaps[layer];
+
+        for (unsigned i = 0; i < ALPHA_DIM; ++i)
+        {
+          if (!mismatching[i])
+            continue;
+
+          std::uint8_t& value = alpha[pixel(i, false)];
+          std::uint8_t& neighbour_value = neighbour_alpha[pixel(i, true)];
+
+          std::uint8_t const target = authoritative == neighbour_authoritative
+            ? static_cast<std::uint8_t>((value + neighbour_value + 1) / 2)
+            : authoritative ? value : neighbour_value;
+
+          value = target;
+          neighbour_value = target;
+        }
+      }
+
+      tile.modified = true;
+      neighbour.modified = true;
+    }
+
+    [[nodiscard]]
+    bool IsDirty(VertexCopy const& copy) const
+    {
+      return copy.tile->dirty_normals[copy.chunk * WorldConstants::CHUNK_BUF_SIZE + copy.vertex];
+    }
+
+    /**
+     * Normal of an outer vertex from central differences of the map-wide height field,
+     * one-sided where neighbouring vertices are not available.
+     */
+    [[nodiscard]]
+    IO::ADT::DataStructures::MCNREntry OuterNormal(unsigned x, unsigned y) const
+    {
+      float center = 0.f;
+      _window.HeightAt(static_cast<int>(x), static_cast<int>(y), center);
+
+      auto difference = [&](int x0, int y0, int x1, int y1, float& span)
+      {
+        float h0 = center, h1 = center;
+        span = 0.f;
+
+        if (_window.HeightAt(x0, y0, h0))
+          span += QUAD_SIZE;
+
+        if (_window.HeightAt(x1, y1, h1))
+          span += QUAD_SIZE;
+
+        return h0 - h1;
+      };
+
+      int const ix = static_cast<int>(x);
+      int const iy = static_cast<int>(y);
+
+      float span_x, span_z;
+      float const dx = difference(ix - 1, iy, ix + 1, iy, span_x);
+      float const dz = difference(ix, iy - 1, ix, iy + 1, span_z);
+
+      // normal of the height field is (-dh/dx, 1, -dh/dz), scaled by spans to avoid divisions
+      float const span = std::max(span_x, span_z);
+
+      if (span == 0.f)
+        return SeamStitcher::EncodeNormal({0.f, 1.f, 0.f});
+
+      return Normal(span_x > 0.f ? dx * span / span_x : 0.f, span, span_z > 0.f ? dz * span / span_z : 0.f);
+    }
+
+    [[nodiscard]]
+    static IO::ADT::DataStructures::MCNREntry Normal(float x, float y, float z)
+    {
+      float const length = std::sqrt(x * x + y * y + z * z);
+      return SeamStitcher::EncodeNormal({x / length, y / length, z / length});
+    }
+
+    IO::ADT::SeamSettings const& _settings;
+    TileWindow& _window;
+    bool const _repair;
+    decltype(&MismatchingPixels) _mismatching_pixels = &MismatchingPixels;
+  };
+
+  /**
+   * Marks normals depending on a changed outer vertex: the vertex itself, its four neighbours,
+   * and inner vertices of the quads around it.
+   */
+  void MarkNormalsDirty(TileWindow& window, unsigned x, unsigned y)
+  {
+    constexpr std::array<std::array<int, 2>, 5> offsets {{{0, 0}, {-1, 0}, {1, 0}, {0, -1}, {0, 1}}};
+
+    for (auto const& [dx, dy] : offsets)
+    {
+      int const nx = static_cast<int>(x) + dx;
+      int const ny = static_cast<int>(y) + dy;
+
+      if (nx < 0 || ny < 0 || nx > static_cast<int>(MAP_QUADS) || ny > static_cast<int>(MAP_QUADS))
+        continue;
+
+      VertexCopies copies;
+      unsigned const n_copies = window.OuterVertexCopies(static_cast<unsigned>(nx), static_cast<unsigned>(ny), copies);
+
+      for (unsigned i = 0; i < n_copies; ++i)
+        copies[i].tile->MarkNormalDirty(copies[i].chunk, copies[i].vertex);
+    }
+
+    for (unsigned quad_y = y ? y - 1 : 0; quad_y <= std::min(y, MAP_QUADS - 1); ++quad_y)
+    {
+      for (unsigned quad_x = x ? x - 1 : 0; quad_x <= std::min(x, MAP_QUADS - 1); ++quad_x)
+      {
+        ResidentTile* tile = window.Tile(quad_x / QUADS_PER_TILE, quad_y / QUADS_PER_TILE);
+
+        if (!tile)
+          continue;
+
+        unsigned const chunk = ((quad_y / N_QUADS) % N_CHUNKS) * N_CHUNKS + (quad_x / N_QUADS) % N_CHUNKS;
+        tile->MarkNormalDirty(chunk, (quad_y % N_QUADS) * ROW_STRIDE + WorldConstants::N_VERTS_CHUNK_ROW_OUTER
+                                     + quad_x % N_QUADS);
+      }
+    }
+  }
+
+  void MergeReport(IO::ADT::SeamReport& report, IO::ADT::SeamReport const& other)
+  {
+    report.n_height_mismatches += other.n_height_mismatches;
+    report.n_normal_mismatches += other.n_normal_mismatches;
+    report.n_color_mismatches += other.n_color_mismatches;
+    report.n_alpha_mismatches += other.n_alpha_mismatches;
+    report.n_layer_mismatches += other.n_layer_mismatches;
+    report.max_height_error = std::max(report.max_height_error, other.max_height_error);
+  }
+}
+
+IO::ADT::DataStructures::MCNREntry SeamStitcher::EncodeNormal(C3Vector const& normal)
+{
+  auto encode = [](float value)
+  {
+    return static_cast<std::int8_t>(std::clamp(std::lround(value * 127.f), -127l, 127l));
+  };
+
+  // MCNR stores world space (x, y, z up), placement space axes are (-y, z, -x)
+  return {{encode(-normal.z), encode(-normal.x), encode(normal.y)}};
+}
+
+SeamReport SeamStitcher::Stitch(std::bitset<WorldConstants::MAX_TILES_PER_MAP> const& tiles
+                                , TileLoader const& loader
+                                , TileConsumer const& consumer
+                                , SeamSettings const& settings
+                                , unsigned n_threads)
+{
+  LogDebugF(LCodeZones::FILE_IO, "Stitching seams of %d tiles.", tiles.count());
+
+  bool const repair = settings.policy != SeamRepairPolicy::VALIDATE_ONLY;
+
+  SeamReport report;
+  TileWindow window;
+  Stitcher const stitcher {settings, window};
+
+  auto load_row = [&](unsigned tile_y)
+  {
+    Utils::Misc::ParallelFor(N_TILES, [&](std::size_t tile_x)
+    {
+      if (!tiles[tile_y * N_TILES + tile_x])
+        return;
+
+      // terrain is too large to be kept on the stack of a worker thread
+      auto tile = std::make_unique<ResidentTile>();
+      tile->index = static_cast<unsigned>(tile_y * N_TILES + tile_x);
+
+      if (!loader({static_cast<std::uint16_t>(tile_x), static_cast<std::uint16_t>(tile_y)}, tile->terrain, tile->texturing))
+        return;
+
+      tile->dirty_normals.assign(WorldConstants::CHUNKS_PER_TILE * WorldConstants::CHUNK_BUF_SIZE, 0);
+      window.Slot(static_cast<unsigned>(tile_x), tile_y) = std::move(tile);
+    }, n_threads);
+  };
+
+  auto for_each_column = [&](unsigned tile_y, auto&& callback)
+  {
+    std::vector<ColumnResult> results (N_TILES);
+
+    Utils::Misc::ParallelFor(N_TILES, [&](std::size_t tile_x)
+    {
+      callback(static_cast<unsigned>(tile_x), tile_y, results[tile_x]);
+    }, n_threads);
+
+    return results;
+  };
+
+  auto finish_row = [&](unsigned tile_y)
+  {
+    if (repair && settings.recompute_normals)
+    {
+      auto const results = for_each_column(tile_y, [&](unsigned tile_x, unsigned y, ColumnResult& result)
+      {
+        stitcher.RecomputeNormals(tile_x, y, result.report.n_recomputed_normals);
+      });
+
+      for (ColumnResult const& result : results)
+        report.n_recomputed_normals += result.report.n_recomputed_normals;
+    }
+
+    std::vector<std::uint16_t> modified;
+
+    for (unsigned tile_x = 0; tile_x < N_TILES; ++tile_x)
+    {
+      ResidentTile* tile = window.Tile(tile_x, tile_y);
+
+      if (tile && tile->modified)
+      {
+        modified.push_back(static_cast<std::uint16_t>(tile_x));
+        report.modified_tiles.push_back({static_cast<std::uint16_t>(tile_x), static_cast<std::uint16_t>(tile_y)});
+      }
+    }
+
+    if (repair && consumer)
+    {
+      Utils::Misc::ParallelFor(modified.size(), [&](std::size_t i)
+      {
+        ResidentTile const* tile = window.Tile(modified[i], tile_y);
+        consumer({modified[i], static_cast<std::uint16_t>(tile_y)}, tile->terrain, tile->texturing);
+      }, n_threads);
+    }
+
+    for (unsigned tile_x = 0; tile_x < N_TILES; ++tile_x)
+      window.Slot(tile_x, tile_y).reset();
+  };
+
+  load_row(0);
+
+  for (unsigned tile_y = 0; tile_y < N_TILES; ++tile_y)
+  {
+    if (tile_y + 1 < N_TILES)
+      load_row(tile_y + 1);
+
+    auto const vertex_results = for_each_column(tile_y, [&](unsigned tile_x, unsigned y, ColumnResult& result)
+    {
+      stitcher.StitchVertices(tile_x, y, result);
+    });
+
+    // marking touches neighbouring columns, so it is done on this thread
+    for (ColumnResult const& result : vertex_results)
+    {
+      MergeReport(report, result.report);
+
+      if (settings.recompute_normals)
+      {
+        for (auto const& [x, y] : result.changed_heights)
+          MarkNormalsDirty(window, x, y);
+      }
+    }
+
+    // both passes touch corner pixels of neighbouring tiles, so they run one after another
+    for (bool horizontal : {false, true})
+    {
+      auto const alpha_results = for_each_column(tile_y, [&](unsigned tile_x, unsigned y, ColumnResult& result)
+      {
+        stitcher.StitchAlpha(tile_x, y, horizontal, result.report);
+      });
+
+      for (ColumnResult const& result : alpha_results)
+        MergeReport(report, result.report);
+    }
+
+    // normals of the previous row depend on heights up to the first vertex row of this one
+    if (tile_y)
+      finish_row(tile_y - 1);
+  }
+
+  finish_row(N_TILES - 1);
+
+  return report;
+}
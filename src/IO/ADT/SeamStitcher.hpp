@@ -0,0 +1,104 @@
+#pragma once
+#include <IO/Common.hpp>
+#include <IO/CommonDataStructures.hpp>
+#include <IO/WorldConstants.hpp>
+#include <IO/ADT/TileData.hpp>
+#include <IO/ADT/Root/TileTerrain.hpp>
+
+#include <bitset>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace IO::ADT
+{
+  /**
+   * Decides the value shared border vertices and pixels are repaired to.
+   */
+  enum class SeamRepairPolicy
+  {
+    VALIDATE_ONLY = 0, ///> Report mismatches, do not modify anything.
+    AVERAGE = 1, ///> Average of all copies.
+    AUTHORITATIVE = 2 ///> Average of copies on authoritative tiles, or of all copies if none is authoritative.
+  };
+
+  struct SeamSettings
+  {
+    SeamRepairPolicy policy = SeamRepairPolicy::AVERAGE;
+    std::bitset<Common::WorldConstants::MAX_TILES_PER_MAP> authoritative_tiles; ///> Bit (y * 64 + x), AUTHORITATIVE only.
+    float height_tolerance = 0.001f; ///> Absolute height difference in yards still considered matching.
+    int normal_tolerance = 1; ///> MCNR component difference still considered matching.
+    int color_tolerance = 0; ///> MCCV channel difference still considered matching.
+    int alpha_tolerance = 64; ///> Difference of alpha values of pixels facing each other across a border.
+    bool recompute_normals = true; ///> Recompute MCNR around repaired heights and on mismatching normals.
+  };
+
+  /**
+   * Mismatches found along chunk and tile borders. Each shared vertex or facing pixel pair counts once.
+   */
+  struct SeamReport
+  {
+    std::size_t n_height_mismatches = 0;
+    std::size_t n_normal_mismatches = 0;
+    std::size_t n_color_mismatches = 0;
+    std::size_t n_alpha_mismatches = 0;
+    std::size_t n_layer_mismatches = 0; ///> Facing chunks with different texture layers, alpha can't be compared.
+    float max_height_error = 0.f;
+    std::size_t n_recomputed_normals = 0;
+    std::vector<Common::DataStructures::TileIndex> modified_tiles;
+  };
+
+  /**
+   * Validates and repairs seams of a map: heights, normals (MCNR) and vertex colors (MCCV) of vertices
+   * shared by neighbouring chunks and tiles, and alpha (MCAL) of pixels facing each other across chunk borders.
+   *
+   * Tiles are streamed in rows, at most three rows of tiles are held in memory at once. Each row is
+   * processed in parallel by tile columns. Copies of a shared vertex are gathered into fixed-size arrays,
+   * alpha edges are compared 16 pixels at a time with SSE2 or NEON unless Utils::Misc::SIMD selects the scalar path.
+   */
+  class SeamStitcher
+  {
+  public:
+    /**
+     * Loads a tile. Invoked concurrently from worker threads, must be thread-safe.
+     * Must match signature: bool(Common::DataStructures::TileIndex tile_index, TileTerrain& terrain
+     *                            , TileTexturing& texturing).
+     * ADT::ExtractTileTerrain() fills terrain from a root ADT. Texturing may be left empty to skip alpha seams.
+     * Returns false if tile does not exist.
+     */
+    using TileLoader = std::function<bool(Common::DataStructures::TileIndex, TileTerrain&, TileTexturing&)>;
+
+    /**
+     * Receives a modified tile once all of its seams are final. Invoked concurrently from worker threads,
+     * must be thread-safe.
+     * Must match signature: void(Common::DataStructures::TileIndex tile_index, TileTerrain const& terrain
+     *                            , TileTexturing const& texturing).
+     */
+    using TileConsumer = std::function<void(Common::DataStructures::TileIndex, TileTerrain const&
+                                            , TileTexturing const&)>;
+
+    /**
+     * Validates and repairs seams between all tiles of a map.
+     * If a callback throws, the exception is propagated.
+     * @param tiles Tiles of the map, bit (y * 64 + x).
+     * @param loader Tile loader callback.
+     * @param consumer Modified tile consumer callback. Not invoked with SeamRepairPolicy::VALIDATE_ONLY.
+     * @param settings Repair settings.
+     * @param n_threads Number of worker threads. 0 means hardware concurrency.
+     * @return Report of mismatches found.
+     */
+    static SeamReport Stitch(std::bitset<Common::WorldConstants::MAX_TILES_PER_MAP> const& tiles
+                             , TileLoader const& loader
+                             , TileConsumer const& consumer
+                             , SeamSettings const& settings
+                             , unsigned n_threads = 0);
+
+    /**
+     * Encodes a normal in placement coordinates into MCNR.
+     * @param normal Unit normal, y is up.
+     * @return MCNR entry.
+     */
+    [[nodiscard]]
+    static DataStructures::MCNREntry EncodeNormal(Common::DataStructures::C3Vector const& normal);
+  };
+}
@@ -0,0 +1,536 @@
+#include <IO/ADT/Tex/AlphamapConverter.hpp>
+#include <IO/ADT/DataStructures.hpp>
+#include <IO/ADT/ChunkIdentifiers.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <Utils/Misc/SIMD.hpp>
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+
+using namespace IO::ADT;
+using namespace IO::Common;
+
+namespace
+{
+  using IO::ADT::DataStructures::SMChunk;
+  using IO::ADT::DataStructures::SMLayer;
+  namespace ChunkIds = IO::ADT::ChunkIdentifiers;
+
+  constexpr std::size_t ROW_SIZE = WorldConstants::ALPHAMAP_DIM;
+  constexpr std::uint8_t MAX_RUN = 127;
+
+  /**
+   * Rounded division of non-negative integers.
+   */
+  std::uint32_t DivideRounded(std::uint32_t value, std::uint32_t divisor)
+  {
+    return (value + divisor / 2) / divisor;
+  }
+
+  constexpr std::size_t N_LOWRES_BYTES = WorldConstants::N_BYTES_PER_LOWRES_ALPHA;
+
+  /**
+   * Conversions between the lowres bytes and the 8-bit pixels of an alpha map.
+   * Each must match signature: void(std::uint8_t const* src, std::uint8_t* dst).
+   */
+  struct NibbleFunctions
+  {
+    void (*unpack)(std::uint8_t const*, std::uint8_t*);
+    void (*pack)(std::uint8_t const*, std::uint8_t*);
+  };
+
+  void UnpackNibbles(std::uint8_t const* src, std::uint8_t* dst)
+  {
+    // nibble n expands to n * 17, which maps 0xF to 0xFF
+    for (std::size_t i = 0; i < N_LOWRES_BYTES; ++i)
+    {
+      std::uint8_t const low = src[i] & 0x0F;
+      std::uint8_t const high = src[i] >> 4;
+
+      dst[i * 2] = static_cast<std::uint8_t>(low | (low << 4));
+      dst[i * 2 + 1] = static_cast<std::uint8_t>(high | (high << 4));
+    }
+  }
+
+  void PackNibbles(std::uint8_t const* src, std::uint8_t* dst)
+  {
+    for (std::size_t i = 0; i < N_LOWRES_BYTES; ++i)
+    {
+      std::uint32_t const low = DivideRounded(src[i * 2] * 15u, 255);
+      std::uint32_t const high = DivideRounded(src[i * 2 + 1] * 15u, 255);
+
+      dst[i] = static_cast<std::uint8_t>(low | (high << 4));
+    }
+  }
+
+#if defined(UTILS_SIMD)
+  /**
+   * Same as UnpackNibbles(), 16 source bytes at a time.
+   */
+  void UnpackNibblesSIMD(std::uint8_t const* src, std::uint8_t* dst)
+  {
+    for (std::size_t i = 0; i < N_LOWRES_BYTES; i += 16)
+    {
+#if defined(UTILS_SIMD_SSE2)
+      __m128i const bytes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+      __m128i const mask = _mm_set1_epi8(0x0F);
+
+      // nibbles never carry across bytes when shifted within their 16-bit lane
+      __m128i const low = _mm_and_si128(bytes, mask);
+      __m128i const high = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+      __m128i const low_expanded = _mm_or_si128(low, _mm_slli_epi16(low, 4));
+      __m128i const high_expanded = _mm_or_si128(high, _mm_slli_epi16(high, 4));
+
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2), _mm_unpacklo_epi8(low_expanded, high_expanded));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2 + 16), _mm_unpackhi_epi8(low_expanded, high_expanded));
+#else
+      uint8x16_t const bytes = vld1q_u8(src + i);
+      uint8x16_t const low = vandq_u8(bytes, vdupq_n_u8(0x0F));
+      uint8x16_t const high = vshrq_n_u8(bytes, 4);
+
+      uint8x16x2_t expanded;
+      expanded.val[0] = vorrq_u8(low, vshlq_n_u8(low, 4));
+      expanded.val[1] = vorrq_u8(high, vshlq_n_u8(high, 4));
+      vst2q_u8(dst + i * 2, expanded);
+#endif
+    }
+  }
+
+  /**
+   * Same as PackNibbles(), 32 source bytes at a time. Rounded division of v * 15 by 255 equals (v * 15 + 135) >> 8
+   * for every byte, which fits 16-bit lanes.
+   */
+  void PackNibblesSIMD(std::uint8_t const* src, std::uint8_t* dst)
+  {
+    for (std::size_t i = 0; i < N_LOWRES_BYTES; i += 16)
+    {
+#if defined(UTILS_SIMD_SSE2)
+      auto pack = [](__m128i pixels) -> __m128i
+      {
+        auto requantize = [](__m128i values) -> __m128i
+        {
+          return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(values, _mm_set1_epi16(15)), _mm_set1_epi16(135)), 8);
+        };
+
+        // even pixels go to the low nibble of their 16-bit lane, odd ones to the high nibble
+        __m128i const low = requantize(_mm_and_si128(pixels, _mm_set1_epi16(0x00FF)));
+        __m128i const high = requantize(_mm_srli_epi16(pixels, 8));
+        return _mm_or_si128(low, _mm_slli_epi16(high, 4));
+      };
+
+      __m128i const first = pack(_mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i * 2)));
+      __m128i const second = pack(_mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i * 2 + 16)));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(first, second));
+#else
+      auto requantize = [](uint8x8_t values) -> uint8x8_t
+      {
+        return vshrn_n_u16(vaddq_u16(vmull_u8(values, vdup_n_u8(15)), vdupq_n_u16(135)), 8);
+      };
+
+      // even pixels go to the low nibble, odd ones to the high nibble
+      uint8x16x2_t const pixels = vld2q_u8(src + i * 2);
+      uint8x16_t const low = vcombine_u8(requantize(vget_low_u8(pixels.val[0])), requantize(vget_high_u8(pixels.val[0])));
+      uint8x16_t const high = vcombine_u8(requantize(vget_low_u8(pixels.val[1])), requantize(vget_high_u8(pixels.val[1])));
+      vst1q_u8(dst + i, vorrq_u8(low, vshlq_n_u8(high, 4)));
+#endif
+    }
+  }
+#endif
+
+  /**
+   * @return Vectorized nibble conversions, unless Utils::Misc::SIMD selects the scalar path.
+   */
+  NibbleFunctions SelectNibbleFunctions()
+  {
+#if defined(UTILS_SIMD)
+    if (Utils::Misc::SIMD::IsEnabled())
+      return {&UnpackNibblesSIMD, &PackNibblesSIMD};
+#endif
+
+    return {&UnpackNibbles, &PackNibbles};
+  }
+
+  /**
+   * Subchunk of a texture MCNK, referenced by its position in the source buffer.
+   */
+  struct Subchunk
+  {
+    ChunkHeader header;
+    std::size_t data_pos;
+  };
+
+  /**
+   * Invokes callback for every chunk in range [begin, end) of the buffer.
+   * Callback must match signature void(ChunkHeader const& chunk_header, std::size_t data_pos).
+   */
+  template<typename Callback>
+  void ForEachChunk(ByteBuffer const& buf, std::size_t begin, std::size_t end, Callback&& callback)
+  {
+    std::size_t pos = begin;
+
+    while (pos + sizeof(ChunkHeader) <= end)
+    {
+      buf.Seek(pos);
+      ChunkHeader const chunk_header = buf.Read<ChunkHeader>();
+      std::size_t const data_pos = pos + sizeof(ChunkHeader);
+
+      EnsureF(CCodeZones::FILE_IO, data_pos + chunk_header.size <= end, "Chunk exceeds its parent bounds.");
+
+      callback(chunk_header, data_pos);
+      pos = data_pos + chunk_header.size;
+    }
+  }
+
+  void AppendBytes(std::vector<char>& out, void const* data, std::size_t size)
+  {
+    auto const* bytes = static_cast<char const*>(data);
+    out.insert(out.end(), bytes, bytes + size);
+  }
+
+  void AppendChunk(std::vector<char>& out, std::uint32_t fourcc, void const* data, std::size_t size)
+  {
+    ChunkHeader const header {fourcc, static_cast<std::uint32_t>(size)};
+    AppendBytes(out, &header, sizeof(ChunkHeader));
+    AppendBytes(out, data, size);
+  }
+
+  void ConvertChunk(ByteBuffer const& src
+                    , std::size_t data_pos
+                    , std::size_t size
+                    , AlphaFormat source_format
+                    , bool fix_alpha
+                    , AlphaStorage const& target
+                    , std::vector<char>& out)
+  {
+    std::vector<Subchunk> subchunks;
+    std::array<SMLayer, IO::Common::WorldConstants::CHUNK_MAX_TEXTURE_LAYERS> layers {};
+    std::size_t n_layers = 0;
+    Subchunk const* alpha = nullptr;
+
+    ForEachChunk(src, data_pos, data_pos + size, [&](ChunkHeader const& header, std::size_t pos)
+    {
+      subchunks.push_back({header, pos});
+    });
+
+    for (Subchunk const& subchunk : subchunks)
+    {
+      if (subchunk.header.fourcc == ChunkIds::ADTTexMCNKSubchunks::MCLY)
+      {
+        n_layers = std::min<std::size_t>(subchunk.header.size / sizeof(SMLayer), layers.size());
+        src.Seek(subchunk.data_pos);
+        src.Read(layers.begin(), layers.begin() + n_layers);
+      }
+      else if (subchunk.header.fourcc == ChunkIds::ADTTexMCNKSubchunks::MCAL)
+      {
+        alpha = &subchunk;
+      }
+    }
+
+    // decode
+    std::array<Alphamap, WorldConstants::CHUNK_MAX_TEXTURE_LAYERS> alphamaps;
+    std::array<std::size_t, WorldConstants::CHUNK_MAX_TEXTURE_LAYERS> alpha_layers {};
+    std::size_t n_alpha_layers = 0;
+
+    for (std::size_t i = 1; i < n_layers; ++i)
+    {
+      if (!layers[i].flags.use_alpha_map)
+        continue;
+
+      EnsureF(CCodeZones::FILE_IO, alpha && layers[i].offsetInMCAL <= alpha->header.size
+              , "Alpha layer references data outside of MCAL.");
+
+      auto const* begin = reinterpret_cast<std::uint8_t const*>(src.Data() + alpha->data_pos + layers[i].offsetInMCAL);
+      std::size_t const available = alpha->header.size - layers[i].offsetInMCAL;
+      Alphamap& alphamap = alphamaps[n_alpha_layers];
+
+      if (source_format == AlphaFormat::LOWRES)
+      {
+        EnsureF(CCodeZones::FILE_IO, !layers[i].flags.alpha_map_compressed
+                                     && available >= WorldConstants::N_BYTES_PER_LOWRES_ALPHA
+                , "Invalid lowres alpha layer.");
+
+        AlphamapConverter::UnpackLowres(std::span<std::uint8_t const, WorldConstants::N_BYTES_PER_LOWRES_ALPHA>
+                                          {begin, WorldConstants::N_BYTES_PER_LOWRES_ALPHA}
+                                        , fix_alpha, alphamap);
+      }
+      else if (layers[i].flags.alpha_map_compressed)
+      {
+        AlphamapConverter::Decompress({begin, available}, alphamap);
+      }
+      else
+      {
+        EnsureF(CCodeZones::FILE_IO, available >= WorldConstants::N_BYTES_PER_HIGHRES_ALPHA
+                , "Invalid highres alpha layer.");
+
+        std::copy(begin, begin + WorldConstants::N_BYTES_PER_HIGHRES_ALPHA, alphamap.begin());
+      }
+
+      alpha_layers[n_alpha_layers++] = i;
+    }
+
+    if (source_format == AlphaFormat::LOWRES && target.format == AlphaFormat::HIGHRES)
+      AlphamapConverter::LowresToHighresBlending({alphamaps.data(), n_alpha_layers});
+    else if (source_format == AlphaFormat::HIGHRES && target.format == AlphaFormat::LOWRES)
+      AlphamapConverter::HighresToLowresBlending({alphamaps.data(), n_alpha_layers});
+
+    // encode
+    std::vector<std::uint8_t> alpha_data;
+
+    for (std::size_t i = 0; i < n_alpha_layers; ++i)
+    {
+      SMLayer& layer = layers[alpha_layers[i]];
+      layer.offsetInMCAL = static_cast<std::uint32_t>(alpha_data.size());
+      layer.flags.alpha_map_compressed = target.format == AlphaFormat::HIGHRES && target.compress;
+
+      if (target.format == AlphaFormat::LOWRES)
+      {
+        alpha_data.resize(alpha_data.size() + WorldConstants::N_BYTES_PER_LOWRES_ALPHA);
+        AlphamapConverter::PackLowres(alphamaps[i], std::span<std::uint8_t, WorldConstants::N_BYTES_PER_LOWRES_ALPHA>
+                                                      {alpha_data.end() - WorldConstants::N_BYTES_PER_LOWRES_ALPHA
+                                                       , WorldConstants::N_BYTES_PER_LOWRES_ALPHA});
+      }
+      else if (target.compress)
+      {
+        AlphamapConverter::Compress(alphamaps[i], alpha_data);
+      }
+      else
+      {
+        alpha_data.insert(alpha_data.end(), alphamaps[i].begin(), alphamaps[i].end());
+      }
+    }
+
+    // write, keeping the order of subchunks
+    std::size_t const chunk_pos = out.size();
+    AppendChunk(out, ChunkIds::ADTTexChunks::MCNK, nullptr, 0);
+
+    for (Subchunk const& subchunk : subchunks)
+    {
+      switch (subchunk.header.fourcc)
+      {
+        case ChunkIds::ADTTexMCNKSubchunks::MCLY:
+        {
+          // layers beyond the supported maximum are kept as they are
+          AppendBytes(out, &subchunk.header, sizeof(ChunkHeader));
+          AppendBytes(out, layers.data(), n_layers * sizeof(SMLayer));
+          AppendBytes(out, src.Data() + subchunk.data_pos + n_layers * sizeof(SMLayer)
+                      , subchunk.header.size - n_layers * sizeof(SMLayer));
+          break;
+        }
+        case ChunkIds::ADTTexMCNKSubchunks::MCAL:
+          AppendChunk(out, subchunk.header.fourcc, alpha_data.data(), alpha_data.size());
+          break;
+        default:
+          AppendChunk(out, subchunk.header.fourcc, src.Data() + subchunk.data_pos, subchunk.header.size);
+          break;
+      }
+    }
+
+    ChunkHeader const header {ChunkIds::ADTTexChunks::MCNK
+                              , static_cast<std::uint32_t>(out.size() - chunk_pos - sizeof(ChunkHeader))};
+    std::memcpy(out.data() + chunk_pos, &header, sizeof(ChunkHeader));
+  }
+}
+
+void AlphamapConverter::UnpackLowres(std::span<std::uint8_t const, WorldConstants::N_BYTES_PER_LOWRES_ALPHA> src
+                                     , bool fix_alpha
+                                     , Alphamap& dst)
+{
+  SelectNibbleFunctions().unpack(src.data(), dst.data());
+
+  if (!fix_alpha)
+    return;
+
+  for (std::size_t i = 0; i < ROW_SIZE; ++i)
+    dst[i * ROW_SIZE + ROW_SIZE - 1] = dst[i * ROW_SIZE + ROW_SIZE - 2];
+
+  std::copy_n(dst.begin() + (ROW_SIZE - 2) * ROW_SIZE, ROW_SIZE, dst.begin() + (ROW_SIZE - 1) * ROW_SIZE);
+}
+
+void AlphamapConverter::PackLowres(Alphamap const& src
+                                   , std::span<std::uint8_t, WorldConstants::N_BYTES_PER_LOWRES_ALPHA> dst)
+{
+  SelectNibbleFunctions().pack(src.data(), dst.data());
+}
+
+std::size_t AlphamapConverter::Decompress(std::span<std::uint8_t const> src, Alphamap& dst)
+{
+  std::size_t pos = 0;
+  std::size_t pixel = 0;
+
+  while (pixel < WorldConstants::N_PIXELS_PER_ALPHAMAP)
+  {
+    EnsureF(CCodeZones::FILE_IO, pos < src.size(), "Compressed alpha map is truncated.");
+
+    std::uint8_t const control = src[pos++];
+    std::size_t const count = control & 0x7F;
+    bool const is_fill = control & 0x80;
+
+    EnsureF(CCodeZones::FILE_IO, count <= WorldConstants::N_PIXELS_PER_ALPHAMAP - pixel
+            , "Compressed alpha map exceeds its size.");
+
+    if (is_fill)
+    {
+      EnsureF(CCodeZones::FILE_IO, pos < src.size(), "Compressed alpha map is truncated.");
+      std::fill_n(dst.begin() + pixel, count, src[pos++]);
+    }
+    else
+    {
+      EnsureF(CCodeZones::FILE_IO, count <= src.size() - pos, "Compressed alpha map is truncated.");
+      std::copy_n(src.begin() + pos, count, dst.begin() + pixel);
+      pos += count;
+    }
+
+    pixel += count;
+  }
+
+  return pos;
+}
+
+void AlphamapConverter::Compress(Alphamap const& src, std::vector<std::uint8_t>& dst)
+{
+  for (std::size_t row = 0; row < WorldConstants::N_PIXELS_PER_ALPHAMAP; row += ROW_SIZE)
+  {
+    std::size_t const row_end = row + ROW_SIZE;
+    std::size_t copy_control_pos = 0;
+    bool is_copy_open = false;
+
+    for (std::size_t i = row; i < row_end;)
+    {
+      std::size_t run = 1;
+
+      while (i + run < row_end && src[i + run] == src[i] && run < MAX_RUN)
+        ++run;
+
+      // a fill takes two bytes, so a pair is cheaper appended to an open copy block
+      if (run >= 3 || (run == 2 && !is_copy_open))
+      {
+        dst.push_back(static_cast<std::uint8_t>(0x80 | run));
+        dst.push_back(src[i]);
+        is_copy_open = false;
+        i += run;
+        continue;
+      }
+
+      if (!is_copy_open || dst[copy_control_pos] == MAX_RUN)
+      {
+        copy_control_pos = dst.size();
+        dst.push_back(0);
+        is_copy_open = true;
+      }
+
+      dst.push_back(src[i]);
+      ++dst[copy_control_pos];
+      ++i;
+    }
+  }
+}
+
+void AlphamapConverter::LowresToHighresBlending(std::span<Alphamap> layers)
+{
+  for (std::size_t pixel = 0; pixel < WorldConstants::N_PIXELS_PER_ALPHAMAP; ++pixel)
+  {
+    // the topmost layer keeps its alpha, each lower one only gets what upper layers let through
+    std::uint32_t remaining = 255;
+
+    for (auto layer = layers.rbegin(); layer != layers.rend(); ++layer)
+    {
+      std::uint32_t const weight = DivideRounded((*layer)[pixel] * remaining, 255);
+      (*layer)[pixel] = static_cast<std::uint8_t>(weight);
+      remaining -= weight;
+    }
+  }
+}
+
+void AlphamapConverter::HighresToLowresBlending(std::span<Alphamap> layers)
+{
+  for (std::size_t pixel = 0; pixel < WorldConstants::N_PIXELS_PER_ALPHAMAP; ++pixel)
+  {
+    std::uint32_t remaining = 255;
+
+    for (auto layer = layers.rbegin(); layer != layers.rend(); ++layer)
+    {
+      std::uint32_t const weight = std::min<std::uint32_t>((*layer)[pixel], remaining);
+      (*layer)[pixel] = remaining ? static_cast<std::uint8_t>(std::min(DivideRounded(weight * 255, remaining), 255u)) : 0;
+      remaining -= weight;
+    }
+  }
+}
+
+void AlphamapConverter::ConvertTexADT(ByteBuffer const& src
+                                      , AlphaFormat source_format
+                                      , ChunkFixAlphaFlags const& fix_alpha
+                                      , AlphaStorage const& target
+                                      , ByteBuffer& dst)
+{
+  // assembled separately, as ByteBuffer grows strictly to the size written
+  std::vector<char> out;
+  out.reserve(src.Size() * 2);
+  std::size_t chunk_index = 0;
+
+  ForEachChunk(src, 0, src.Size(), [&](ChunkHeader const& header, std::size_t data_pos)
+  {
+    if (header.fourcc != ChunkIds::ADTTexChunks::MCNK)
+    {
+      AppendChunk(out, header.fourcc, src.Data() + data_pos, header.size);
+      return;
+    }
+
+    EnsureF(CCodeZones::FILE_IO, chunk_index < WorldConstants::CHUNKS_PER_TILE, "Too many MCNK chunks.");
+    ConvertChunk(src, data_pos, header.size, source_format, fix_alpha[chunk_index++], target, out);
+  });
+
+  dst.Write(out.begin(), out.end());
+}
+
+std::size_t AlphamapConverter::ConvertTiles(std::vector<Common::DataStructures::TileIndex> const& tiles
+                                            , AlphaFormat source_format
+                                            , AlphaStorage const& target
+                                            , TileLoader const& loader
+                                            , TileConsumer const& consumer
+                                            , unsigned n_threads)
+{
+  LogDebugF(LCodeZones::FILE_IO, "Converting alpha maps of %d tiles.", tiles.size());
+
+  std::atomic<std::size_t> n_converted = 0;
+
+  Utils::Misc::ParallelFor(tiles.size(), [&](std::size_t i)
+  {
+    ByteBuffer src;
+    ChunkFixAlphaFlags fix_alpha;
+
+    if (!loader(tiles[i], src, fix_alpha))
+      return;
+
+    ByteBuffer dst;
+    ConvertTexADT(src, source_format, fix_alpha, target, dst);
+    consumer(tiles[i], dst);
+
+    ++n_converted;
+  }, n_threads);
+
+  return n_converted;
+}
+
+ChunkFixAlphaFlags AlphamapConverter::ReadFixAlphaFlags(ByteBuffer const& root_adt)
+{
+  ChunkFixAlphaFlags fix_alpha;
+  std::size_t chunk_index = 0;
+
+  ForEachChunk(root_adt, 0, root_adt.Size(), [&](ChunkHeader const& header, std::size_t)
+  {
+    if (header.fourcc != ChunkIds::ADTRootChunks::MCNK || chunk_index >= WorldConstants::CHUNKS_PER_TILE)
+      return;
+
+    EnsureF(CCodeZones::FILE_IO, header.size >= sizeof(SMChunk), "MCNK is too small.");
+
+    auto const mcnk_header = root_adt.Read<SMChunk>();
+    fix_alpha[chunk_index++] = !mcnk_header.flags.do_not_fix_alpha_map;
+  });
+
+  return fix_alpha;
+}
@@ -0,0 +1,156 @@
+#pragma once
+#include <IO/Common.hpp>
+#include <IO/ByteBuffer.hpp>
+#include <IO/CommonDataStructures.hpp>
+#include <IO/WorldConstants.hpp>
+#include <IO/ADT/Tex/MCAL.hpp>
+#include <IO/WDT/WDTRoot.hpp>
+
+#include <bitset>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace IO::ADT
+{
+  /**
+   * Target representation of alpha maps.
+   */
+  struct AlphaStorage
+  {
+    AlphaFormat format; ///> LOWRES (4-bit, 2048 bytes) or HIGHRES (8-bit).
+    bool compress = false; ///> Use RLE compression for highres layers.
+  };
+
+  /**
+   * Per-chunk "fix alpha map" state of a tile, taken from root ADT (MCNK flag do_not_fix_alpha_map is not set).
+   * Lowres alpha maps of such chunks are 63x63 with the last row and column duplicated.
+   */
+  using ChunkFixAlphaFlags = std::bitset<Common::WorldConstants::CHUNKS_PER_TILE>;
+
+  /**
+   * Converts alpha maps (MCAL) between lowres (4-bit) and highres (8-bit, optionally RLE-compressed) storage,
+   * updating MCLY flags and offsets accordingly.
+   *
+   * Lowres layers are blended one over another, while highres layers are weights summing with the base layer to 255,
+   * so conversion remaps values across layers of each pixel. Values are requantized by rounding, without dithering.
+   *
+   * Texture ADTs (tex0) are rewritten at chunk level, copying everything but MCLY and MCAL verbatim,
+   * which allows to convert a map tile by tile without fully parsing it.
+   */
+  class AlphamapConverter
+  {
+  public:
+    /**
+     * Loads texture ADT of a tile. Invoked concurrently from worker threads, must be thread-safe.
+     * Must match signature:
+     * bool(Common::DataStructures::TileIndex tile_index, Common::ByteBuffer& tex_adt, ChunkFixAlphaFlags& fix_alpha).
+     * ReadFixAlphaFlags() provides fix_alpha from root ADT. Returns false if tile does not exist.
+     */
+    using TileLoader = std::function<bool(Common::DataStructures::TileIndex, Common::ByteBuffer&, ChunkFixAlphaFlags&)>;
+
+    /**
+     * Receives converted texture ADT of a tile. Invoked concurrently from worker threads for distinct tiles.
+     * Must match signature: void(Common::DataStructures::TileIndex tile_index, Common::ByteBuffer const& tex_adt).
+     */
+    using TileConsumer = std::function<void(Common::DataStructures::TileIndex, Common::ByteBuffer const&)>;
+
+    /**
+     * Expands a lowres alpha map to 8-bit values.
+     * @param src 2048 bytes of lowres alpha, two pixels per byte, low nibble first.
+     * @param fix_alpha Replace the last row and column with the previous ones.
+     * @param dst Alpha map to write to.
+     */
+    static void UnpackLowres(std::span<std::uint8_t const, Common::WorldConstants::N_BYTES_PER_LOWRES_ALPHA> src
+                             , bool fix_alpha
+                             , Alphamap& dst);
+
+    /**
+     * Requantizes an 8-bit alpha map to lowres, rounding to the nearest 4-bit value.
+     * @param src Alpha map.
+     * @param dst 2048 bytes of lowres alpha to write to.
+     */
+    static void PackLowres(Alphamap const& src
+                           , std::span<std::uint8_t, Common::WorldConstants::N_BYTES_PER_LOWRES_ALPHA> dst);
+
+    /**
+     * Decompresses an RLE-compressed highres alpha map.
+     * @param src Compressed data, may extend past the end of the alpha map.
+     * @param dst Alpha map to write to.
+     * @return Number of bytes consumed.
+     */
+    static std::size_t Decompress(std::span<std::uint8_t const> src, Alphamap& dst);
+
+    /**
+     * Compresses a highres alpha map with RLE. Runs never cross rows.
+     * @param src Alpha map.
+     * @param dst Vector to append compressed data to.
+     */
+    static void Compress(Alphamap const& src, std::vector<std::uint8_t>& dst);
+
+    /**
+     * Converts alpha layers of one chunk from lowres blending (each layer over the previous) to highres weights.
+     * @param layers Alpha maps of layers 1..n of a chunk.
+     */
+    static void LowresToHighresBlending(std::span<Alphamap> layers);
+
+    /**
+     * Converts alpha layers of one chunk from highres weights to lowres blending. Inverse of LowresToHighresBlending().
+     * @param layers Alpha maps of layers 1..n of a chunk.
+     */
+    static void HighresToLowresBlending(std::span<Alphamap> layers);
+
+    /**
+     * Rewrites alpha maps of all chunks of a texture ADT (Cata+ tex0).
+     * @param src Texture ADT.
+     * @param source_format Format alpha maps are currently stored in (WDT MapHeaderFlags::UseHighresAlphamap).
+     * @param fix_alpha Per-chunk fix alpha state, only relevant for lowres source.
+     * @param target Target representation.
+     * @param dst Buffer to write converted texture ADT to.
+     */
+    static void ConvertTexADT(Common::ByteBuffer const& src
+                              , AlphaFormat source_format
+                              , ChunkFixAlphaFlags const& fix_alpha
+                              , AlphaStorage const& target
+                              , Common::ByteBuffer& dst);
+
+    /**
+     * Converts a set of tiles in parallel. Each worker holds one tile at a time, so memory use is bounded by
+     * the number of threads rather than the number of tiles.
+     * @param tiles Tiles to process.
+     * @param source_format Format alpha maps are currently stored in.
+     * @param target Target representation.
+     * @param loader Texture ADT loader callback.
+     * @param consumer Callback receiving converted texture ADTs.
+     * @param n_threads Number of worker threads. 0 means hardware concurrency.
+     * @return Number of tiles converted (present tiles only).
+     */
+    static std::size_t ConvertTiles(std::vector<Common::DataStructures::TileIndex> const& tiles
+                                    , AlphaFormat source_format
+                                    , AlphaStorage const& target
+                                    , TileLoader const& loader
+                                    , TileConsumer const& consumer
+                                    , unsigned n_threads = 0);
+
+    /**
+     * Reads per-chunk fix alpha state from MCNK headers of a root ADT.
+     * @param root_adt Root ADT.
+     * @return Fix alpha flags of chunks.
+     */
+    [[nodiscard]]
+    static ChunkFixAlphaFlags ReadFixAlphaFlags(Common::ByteBuffer const& root_adt);
+
+    /**
+     * Updates WDT header to match the format of alpha maps. Must only be called after all tiles were converted.
+     * @tparam client_version Version of the client.
+     * @param wdt WDT root of the map.
+     * @param format New format of alpha maps.
+     */
+    template<Common::ClientVersion client_version>
+    requires (client_version >= Common::ClientVersion::WOTLK)
+    static void MarkMapFormat(WDT::WDTRoot<client_version>& wdt, AlphaFormat format);
+  };
+}
+
+#include <IO/ADT/Tex/AlphamapConverter.inl>
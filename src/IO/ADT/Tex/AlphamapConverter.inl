@@ -0,0 +1,18 @@
+#pragma once
+#include <IO/ADT/Tex/AlphamapConverter.hpp>
+
+namespace IO::ADT
+{
+  template<Common::ClientVersion client_version>
+  requires (client_version >= Common::ClientVersion::WOTLK)
+  void AlphamapConverter::MarkMapFormat(WDT::WDTRoot<client_version>& wdt, AlphaFormat format)
+  {
+    auto& header = wdt.MapHeader();
+
+    if (!header.IsInitialized())
+      header.Initialize(WDT::DataStructures::MapHeader<client_version>{});
+
+    header.data.flags.SetFlag(WDT::DataStructures::MapHeaderFlags<client_version>::UseHighresAlphamap
+                              , format == AlphaFormat::HIGHRES);
+  }
+}
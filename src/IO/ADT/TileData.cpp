@@ -0,0 +1,26 @@
+#include <IO/ADT/TileData.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+using namespace IO::ADT;
+using IO::ADT::DataStructures::MDDF;
+using IO::ADT::DataStructures::MODF;
+
+AssetReference TilePlacements::ModelAsset(MDDF const& placement) const
+{
+  if (placement.flags.use_filedata_id)
+    return AssetReference{{}, placement.name_id};
+
+  EnsureF(CCodeZones::FILE_IO, placement.name_id < models.size(), "Model placement references non-existing file.");
+  return models[placement.name_id];
+}
+
+AssetReference TilePlacements::MapObjectAsset(MODF const& placement) const
+{
+  if (placement.flags.use_filedata_id)
+    return AssetReference{{}, placement.name_id};
+
+  EnsureF(CCodeZones::FILE_IO, placement.name_id < map_objects.size()
+          , "Map object placement references non-existing file.");
+  return map_objects[placement.name_id];
+}
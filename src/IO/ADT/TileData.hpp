@@ -0,0 +1,83 @@
+#pragma once
+#include <IO/Common.hpp>
+#include <IO/WorldConstants.hpp>
+#include <IO/ADT/DataStructures.hpp>
+#include <IO/ADT/Root/MH2O.hpp>
+#include <IO/ADT/Root/TileTerrain.hpp>
+#include <IO/ADT/Tex/MCAL.hpp>
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace IO::ADT
+{
+  /**
+   * File referenced by a tile, either by path or by FileDataID.
+   */
+  struct AssetReference
+  {
+    std::string path; ///> Empty if referenced by FileDataID only.
+    std::uint32_t file_data_id = 0; ///> 0 if unknown.
+
+    bool operator==(AssetReference const& other) const = default;
+  };
+
+  /**
+   * Texturing of one map chunk, detached from the texture ADT it was read from.
+   */
+  struct ChunkTexturing
+  {
+    std::vector<DataStructures::SMLayer> layers; ///> MCLY, textureId indexes TileTexturing::textures.
+    std::vector<Alphamap> alphamaps; ///> Highres weights of layers 1..n, as read by MCAL.
+    std::bitset<Common::WorldConstants::N_PIXELS_PER_SHADOWMAP> shadowmap; ///> MCSH, all clear if absent.
+  };
+
+  /**
+   * Texturing of all chunks of one map tile, row-major.
+   */
+  struct TileTexturing
+  {
+    std::vector<AssetReference> textures; ///> MTEX filenames or MDID FileDataIDs.
+    std::vector<std::uint32_t> height_textures; ///> MHID FileDataIDs, one per texture, empty if not loaded.
+    std::vector<DataStructures::SMTextureParams> texture_params; ///> MTXP, one per texture, empty if not loaded.
+    std::array<ChunkTexturing, Common::WorldConstants::CHUNKS_PER_TILE> chunks;
+  };
+
+  /**
+   * Model and map object placements of one map tile with the files they reference.
+   */
+  struct TilePlacements
+  {
+    std::vector<AssetReference> models; ///> Files referenced by MDDF name_id (MMDX / MMID).
+    std::vector<AssetReference> map_objects; ///> Files referenced by MODF name_id (MWMO / MWID).
+    std::vector<DataStructures::MDDF> model_placements;
+    std::vector<DataStructures::MODF> map_object_placements;
+
+    /**
+     * @return File of a model placement, through the model table or by FileDataID, as flagged by the placement.
+     */
+    [[nodiscard]]
+    AssetReference ModelAsset(DataStructures::MDDF const& placement) const;
+
+    /**
+     * @return File of a map object placement, through the map object table or by FileDataID, as flagged by the placement.
+     */
+    [[nodiscard]]
+    AssetReference MapObjectAsset(DataStructures::MODF const& placement) const;
+  };
+
+  /**
+   * Terrain, texturing, liquids and placements of one map tile, as exchanged with the loaders and consumers
+   * of tile editing tools (RegionClipboard, ChangeFeed, TileVersionStore).
+   */
+  struct RegionTile
+  {
+    TileTerrain terrain;
+    TileTexturing texturing;
+    MH2O liquids;
+    TilePlacements placements;
+  };
+}
@@ -0,0 +1,167 @@
+#include <IO/ADT/TileRelocator.hpp>
+#include <IO/WorldConstants.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <atomic>
+#include <bitset>
+#include <limits>
+
+using namespace IO::ADT;
+using namespace IO::Common;
+
+namespace
+{
+  using IO::Common::DataStructures::CAaBox;
+  using IO::Common::DataStructures::C3Vector;
+
+  void Translate(C3Vector& vec, C3Vector const& offset)
+  {
+    vec.x += offset.x;
+    vec.y += offset.y;
+    vec.z += offset.z;
+  }
+
+  void Translate(CAaBox& box, C3Vector const& offset)
+  {
+    Translate(box.min, offset);
+    Translate(box.max, offset);
+  }
+}
+
+TileRelocator::TileRelocator(TileRelocation const& relocation)
+: _relocation(relocation)
+{
+  RequireF(CCodeZones::FILE_IO, relocation.from.x < 64 && relocation.from.y < 64
+                                && relocation.to.x < 64 && relocation.to.y < 64
+           , "Tile index out of bounds.");
+
+  float const dx = (static_cast<float>(relocation.to.x) - static_cast<float>(relocation.from.x))
+    * WorldConstants::TILE_SIZE;
+  float const dy = (static_cast<float>(relocation.to.y) - static_cast<float>(relocation.from.y))
+    * WorldConstants::TILE_SIZE;
+
+  // placement coordinates grow with tile indices, world coordinates decrease with them and have axes swapped
+  _placement_offset = {dx, 0.f, dy};
+  _world_offset = {-dy, -dx, 0.f};
+}
+
+std::uint32_t TileRelocator::RelocateUniqueID(std::uint32_t unique_id) const
+{
+  RequireF(CCodeZones::FILE_IO, unique_id <= std::numeric_limits<std::uint32_t>::max() - _relocation.unique_id_offset
+           , "Unique ID offset overflows.");
+
+  return unique_id + _relocation.unique_id_offset;
+}
+
+void TileRelocator::RelocateChunk(DataStructures::SMChunk& header, std::span<DataStructures::MCSE> sound_emitters) const
+{
+  Translate(header.position, _world_offset);
+
+  for (DataStructures::MCSE& sound_emitter : sound_emitters)
+    Translate(sound_emitter.position, _world_offset);
+}
+
+void TileRelocator::RelocateModelPlacements(std::span<DataStructures::MDDF> placements) const
+{
+  for (DataStructures::MDDF& placement : placements)
+  {
+    placement.unique_id = RelocateUniqueID(placement.unique_id);
+    Translate(placement.position, _placement_offset);
+  }
+}
+
+void TileRelocator::RelocateMapObjectPlacements(std::span<DataStructures::MODF> placements) const
+{
+  for (DataStructures::MODF& placement : placements)
+  {
+    placement.unique_id = RelocateUniqueID(placement.unique_id);
+    Translate(placement.position, _placement_offset);
+    Translate(placement.extents, _placement_offset);
+  }
+}
+
+void TileRelocator::RelocateLodMapObjectPlacements(std::span<DataStructures::MLMD> placements
+                                                   , std::span<DataStructures::MLMX> extents) const
+{
+  RequireF(CCodeZones::FILE_IO, placements.size() == extents.size(), "MLMD and MLMX must match in size.");
+
+  for (DataStructures::MLMD& placement : placements)
+  {
+    placement.uniqueId = RelocateUniqueID(placement.uniqueId);
+    Translate(placement.position, _placement_offset);
+  }
+
+  for (DataStructures::MLMX& extent : extents)
+    Translate(extent.bounding, _placement_offset);
+}
+
+void TileRelocator::RelocateLodModelExtents(std::span<DataStructures::MLDX> extents) const
+{
+  for (DataStructures::MLDX& extent : extents)
+    Translate(extent.bounding, _placement_offset);
+}
+
+void TileRelocator::RelocateBlendMeshes(std::span<DataStructures::MBMH> headers
+                                        , std::span<DataStructures::MBBB> bounding_boxes
+                                        , std::span<DataStructures::MBNV> vertices) const
+{
+  // blend meshes reference map object placements by their unique ID
+  for (DataStructures::MBMH& header : headers)
+    header.mapObjectID = RelocateUniqueID(header.mapObjectID);
+
+  for (DataStructures::MBBB& bounding_box : bounding_boxes)
+  {
+    bounding_box.mapObjectID = RelocateUniqueID(bounding_box.mapObjectID);
+    Translate(bounding_box.bounding, _world_offset);
+  }
+
+  for (DataStructures::MBNV& vertex : vertices)
+    Translate(vertex.pos, _world_offset);
+}
+
+std::size_t TileRelocator::RelocateTiles(std::vector<TileRelocation> const& relocations
+                                         , RelocationCallback const& callback
+                                         , unsigned n_threads)
+{
+  LogDebugF(LCodeZones::FILE_IO, "Relocating %d tiles.", relocations.size());
+
+  std::bitset<WorldConstants::MAX_TILES_PER_MAP> sources;
+  std::bitset<WorldConstants::MAX_TILES_PER_MAP> targets;
+
+  for (TileRelocation const& relocation : relocations)
+  {
+    RequireF(CCodeZones::FILE_IO, relocation.from.x < 64 && relocation.from.y < 64
+                                  && relocation.to.x < 64 && relocation.to.y < 64
+             , "Tile index out of bounds.");
+
+    std::size_t const source = relocation.from.y * 64 + relocation.from.x;
+    std::size_t const target = relocation.to.y * 64 + relocation.to.x;
+
+    RequireF(CCodeZones::FILE_IO, !targets.test(target), "Relocation targets must be distinct.");
+    targets.set(target);
+    sources.set(source);
+  }
+
+  // a target may only be the source of its own relocation
+  for (TileRelocation const& relocation : relocations)
+  {
+    std::size_t const target = relocation.to.y * 64 + relocation.to.x;
+    bool const is_own_source = relocation.from.x == relocation.to.x && relocation.from.y == relocation.to.y;
+
+    RequireF(CCodeZones::FILE_IO, is_own_source || !sources.test(target)
+             , "Relocation target is the source of another relocation of the batch.");
+  }
+
+  std::atomic<std::size_t> n_relocated = 0;
+
+  Utils::Misc::ParallelFor(relocations.size(), [&](std::size_t i)
+  {
+    if (callback(TileRelocator(relocations[i])))
+      ++n_relocated;
+  }, n_threads);
+
+  return n_relocated;
+}
@@ -0,0 +1,169 @@
+#pragma once
+#include <IO/Common.hpp>
+#include <IO/CommonDataStructures.hpp>
+#include <IO/ADT/DataStructures.hpp>
+#include <IO/WDT/DataStructures.hpp>
+#include <IO/WDT/WDTRoot.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace IO::ADT
+{
+  /**
+   * Describes moving or duplicating one tile to other coordinates of the WDT grid.
+   */
+  struct TileRelocation
+  {
+    Common::DataStructures::TileIndex from; ///> Current tile coordinates.
+    Common::DataStructures::TileIndex to; ///> Target tile coordinates.
+
+    /**
+     * Added to unique IDs of all placements (MDDF, MODF, MLDD, MLMD) and their references (MBMH, MBBB).
+     * Duplicated tiles need an offset larger than any unique ID used on the map. Offsetting instead of renumbering
+     * keeps placements shared by several relocated tiles (see BorderCrossing) consistent without coordination.
+     * 0 keeps unique IDs, which is suitable for moving.
+     */
+    std::uint32_t unique_id_offset = 0;
+  };
+
+  /**
+   * Rewrites all absolute positions stored in ADT files of one tile, so that the tile can be saved under
+   * other coordinates. Data stored relative to map chunks (heightmap, MH2O, MFBO, MCNK indices) needs no changes.
+   * Tiles are independent of each other, so relocation of a region can be distributed with RelocateTiles().
+   */
+  class TileRelocator
+  {
+  public:
+    /**
+     * Invoked concurrently from worker threads for distinct relocations. Expected to load ADT files of the source
+     * tile, apply the relocator to them and save them under target coordinates.
+     * Must match signature: bool(TileRelocator const& relocator).
+     * Returns false if the source tile does not exist.
+     */
+    using RelocationCallback = std::function<bool(TileRelocator const&)>;
+
+    explicit TileRelocator(TileRelocation const& relocation);
+
+    [[nodiscard]]
+    TileRelocation const& Relocation() const { return _relocation; };
+
+    /**
+     * Offset applied to placement coordinates (x and z are horizontal, relative to the map corner, y is up).
+     */
+    [[nodiscard]]
+    Common::DataStructures::C3Vector const& PlacementOffset() const { return _placement_offset; };
+
+    /**
+     * Offset applied to world coordinates used by MCNK (x and y are horizontal, relative to the map center, z is up).
+     */
+    [[nodiscard]]
+    Common::DataStructures::C3Vector const& WorldOffset() const { return _world_offset; };
+
+    /**
+     * Relocates a map chunk header and its sound emitters.
+     * @param header MCNK header.
+     * @param sound_emitters MCSE entries of the chunk.
+     */
+    void RelocateChunk(DataStructures::SMChunk& header, std::span<DataStructures::MCSE> sound_emitters) const;
+
+    /**
+     * Relocates model placements (MDDF, or MLDD of obj1).
+     * @param placements Model placements.
+     */
+    void RelocateModelPlacements(std::span<DataStructures::MDDF> placements) const;
+
+    /**
+     * Relocates map object placements (MODF), including their extents.
+     * @param placements Map object placements.
+     */
+    void RelocateMapObjectPlacements(std::span<DataStructures::MODF> placements) const;
+
+    /**
+     * Relocates LOD map object placements (MLMD) and their extents (MLMX) of obj1.
+     * @param placements LOD map object placements.
+     * @param extents LOD map object extents.
+     */
+    void RelocateLodMapObjectPlacements(std::span<DataStructures::MLMD> placements
+                                        , std::span<DataStructures::MLMX> extents) const;
+
+    /**
+     * Relocates LOD model extents (MLDX) of obj1.
+     * @param extents LOD model extents.
+     */
+    void RelocateLodModelExtents(std::span<DataStructures::MLDX> extents) const;
+
+    /**
+     * Relocates blend meshes (MoP+) of root ADT.
+     * @param headers MBMH entries.
+     * @param bounding_boxes MBBB entries.
+     * @param vertices MBNV entries.
+     */
+    void RelocateBlendMeshes(std::span<DataStructures::MBMH> headers
+                             , std::span<DataStructures::MBBB> bounding_boxes
+                             , std::span<DataStructures::MBNV> vertices) const;
+
+    /**
+     * Relocates a root ADT.
+     * @tparam ADTRoot ADTRoot<client_version>.
+     * @param adt Root ADT of the source tile.
+     */
+    template<typename ADTRoot>
+    void RelocateRoot(ADTRoot& adt) const;
+
+    /**
+     * Relocates an obj0 ADT.
+     * @tparam ADTObj0 ADTObj<client_version, ADTObjLodLevel::NORMAL>.
+     * @param adt obj0 ADT of the source tile.
+     */
+    template<typename ADTObj0>
+    void RelocateObj0(ADTObj0& adt) const;
+
+    /**
+     * Relocates an obj1 ADT (Legion+).
+     * @tparam ADTObj1 ADTObj<client_version, ADTObjLodLevel::LOD>.
+     * @param adt obj1 ADT of the source tile.
+     */
+    template<typename ADTObj1>
+    void RelocateObj1(ADTObj1& adt) const;
+
+    /**
+     * Moves or copies the MAIN entry of the source tile to the target tile in WDT root.
+     * On BfA+, MAID of the target is set to the provided FileDataIDs, as relocated files are new files.
+     * @tparam client_version Version of the client.
+     * @param wdt WDT root of the map.
+     * @param target_file_data_ids FileDataIDs of the relocated tile files (BfA+ only).
+     * @param keep_source True to duplicate the tile, false to move it.
+     */
+    template<Common::ClientVersion client_version>
+    void RelocateMapArea(WDT::WDTRoot<client_version>& wdt
+                         , WDT::DataStructures::MapAreaID const& target_file_data_ids
+                         , bool keep_source) const;
+
+    /**
+     * Relocates a set of tiles in parallel.
+     * Tiles are processed concurrently, so a target must not be the source or target of another relocation
+     * of the batch.
+     * @param relocations Relocations to perform.
+     * @param callback Callback performing relocation of one tile.
+     * @param n_threads Number of worker threads. 0 means hardware concurrency.
+     * @return Number of tiles relocated (present tiles only).
+     */
+    static std::size_t RelocateTiles(std::vector<TileRelocation> const& relocations
+                                     , RelocationCallback const& callback
+                                     , unsigned n_threads = 0);
+
+  private:
+    [[nodiscard]]
+    std::uint32_t RelocateUniqueID(std::uint32_t unique_id) const;
+
+  private:
+    TileRelocation _relocation;
+    Common::DataStructures::C3Vector _placement_offset;
+    Common::DataStructures::C3Vector _world_offset;
+  };
+}
+
+#include <IO/ADT/TileRelocator.inl>
@@ -0,0 +1,77 @@
+#pragma once
+#include <IO/ADT/TileRelocator.hpp>
+#include <IO/WorldConstants.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+namespace IO::ADT
+{
+  namespace details
+  {
+    template<typename Array>
+    auto RelocationSpan(Array& array)
+    {
+      return std::span{array.begin(), array.end()};
+    }
+  }
+
+  template<typename ADTRoot>
+  void TileRelocator::RelocateRoot(ADTRoot& adt) const
+  {
+    for (auto& chunk : adt.Chunks())
+      RelocateChunk(chunk.Header().data, details::RelocationSpan(chunk.SoundEmitters()));
+
+    if constexpr (requires { adt.BlendMeshVertices(); })
+    {
+      RelocateBlendMeshes(details::RelocationSpan(adt.BlendMeshHeaders())
+                          , details::RelocationSpan(adt.BlendMeshBoundingBoxes())
+                          , details::RelocationSpan(adt.BlendMeshVertices()));
+    }
+  }
+
+  template<typename ADTObj0>
+  void TileRelocator::RelocateObj0(ADTObj0& adt) const
+  {
+    RelocateModelPlacements(details::RelocationSpan(adt.ModelPlacements()));
+    RelocateMapObjectPlacements(details::RelocationSpan(adt.MapObjectPlacements()));
+  }
+
+  template<typename ADTObj1>
+  void TileRelocator::RelocateObj1(ADTObj1& adt) const
+  {
+    RelocateModelPlacements(details::RelocationSpan(adt.LodModelPlacements()));
+    RelocateLodModelExtents(details::RelocationSpan(adt.LodModelExtents()));
+    RelocateLodMapObjectPlacements(details::RelocationSpan(adt.LodMapObjectPlacements())
+                                   , details::RelocationSpan(adt.LodMapObjectExtents()));
+  }
+
+  template<Common::ClientVersion client_version>
+  void TileRelocator::RelocateMapArea(WDT::WDTRoot<client_version>& wdt
+                                      , WDT::DataStructures::MapAreaID const& target_file_data_ids
+                                      , bool keep_source) const
+  {
+    std::size_t const source = _relocation.from.y * 64 + _relocation.from.x;
+    std::size_t const target = _relocation.to.y * 64 + _relocation.to.x;
+
+    auto& area_index = wdt.MapAreaIndex();
+    RequireF(CCodeZones::FILE_IO, area_index.IsInitialized(), "WDT has no MAIN chunk.");
+
+    area_index[target] = area_index[source];
+
+    if (!keep_source && source != target)
+      area_index[source] = WDT::DataStructures::MapAreaInfo<client_version>{};
+
+    if constexpr (client_version >= Common::ClientVersion::BFA)
+    {
+      auto& file_data_ids = wdt.MapAreaFileDataIDs();
+
+      if (!file_data_ids.IsInitialized())
+        file_data_ids.Initialize(WDT::DataStructures::MapAreaID{}, Common::WorldConstants::MAX_TILES_PER_MAP);
+
+      file_data_ids[target] = target_file_data_ids;
+
+      if (!keep_source && source != target)
+        file_data_ids[source] = WDT::DataStructures::MapAreaID{};
+    }
+  }
+}
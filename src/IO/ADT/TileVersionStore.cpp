@@ -0,0 +1,205 @@
+#include <IO/ADT/TileVersionStore.hpp>
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <utility>
+
+using namespace IO::ADT;
+using namespace IO::Common;
+
+ChunkData const& TileSnapshot::Chunk(std::size_t index) const
+{
+  RequireF(CCodeZones::FILE_IO, index < WorldConstants::CHUNKS_PER_TILE, "Chunk index out of bounds.");
+  return *_chunks[index];
+}
+
+bool TileSnapshot::SharesChunk(TileSnapshot const& other, std::size_t index) const
+{
+  RequireF(CCodeZones::FILE_IO, index < WorldConstants::CHUNKS_PER_TILE, "Chunk index out of bounds.");
+  return _chunks[index] == other._chunks[index];
+}
+
+void TileSnapshot::Extract(RegionTile& tile) const
+{
+  bool has_liquids = false;
+
+  for (std::size_t i = 0; i < WorldConstants::CHUNKS_PER_TILE; ++i)
+  {
+    tile.terrain[i] = _chunks[i]->terrain;
+    tile.texturing.chunks[i] = _chunks[i]->texturing;
+    tile.liquids.chunks()[i] = _chunks[i]->liquids;
+    has_liquids |= !_chunks[i]->liquids.Layers().empty();
+  }
+
+  if (has_liquids)
+    tile.liquids.Initialize();
+
+  tile.texturing.textures = *_textures;
+  tile.placements = *_placements;
+}
+
+TileTransaction::TileTransaction(TileSnapshotHandle base)
+: _base(std::move(base))
+{
+  RequireF(CCodeZones::FILE_IO, _base != nullptr, "Transaction requires a base version.");
+
+  _chunks = _base->_chunks;
+  _textures = _base->_textures;
+  _placements = _base->_placements;
+}
+
+TileTransaction::TileTransaction(TileTransaction&& other) noexcept
+: _base(std::move(other._base))
+, _chunks(std::move(other._chunks))
+, _textures(std::move(other._textures))
+, _placements(std::move(other._placements))
+, _edited_chunks(std::exchange(other._edited_chunks, {}))
+, _edited_textures(std::exchange(other._edited_textures, nullptr))
+, _edited_placements(std::exchange(other._edited_placements, nullptr))
+{
+}
+
+TileTransaction& TileTransaction::operator=(TileTransaction&& other) noexcept
+{
+  if (this != &other)
+  {
+    _base = std::move(other._base);
+    _chunks = std::move(other._chunks);
+    _textures = std::move(other._textures);
+    _placements = std::move(other._placements);
+    _edited_chunks = std::exchange(other._edited_chunks, {});
+    _edited_textures = std::exchange(other._edited_textures, nullptr);
+    _edited_placements = std::exchange(other._edited_placements, nullptr);
+  }
+
+  return *this;
+}
+
+ChunkData const& TileTransaction::Chunk(std::size_t index) const
+{
+  RequireF(CCodeZones::FILE_IO, index < WorldConstants::CHUNKS_PER_TILE, "Chunk index out of bounds.");
+  return *_chunks[index];
+}
+
+ChunkData& TileTransaction::EditChunk(std::size_t index)
+{
+  RequireF(CCodeZones::FILE_IO, index < WorldConstants::CHUNKS_PER_TILE, "Chunk index out of bounds.");
+
+  if (!_edited_chunks[index])
+  {
+    auto copy = std::make_shared<ChunkData>(*_chunks[index]);
+    _edited_chunks[index] = copy.get();
+    _chunks[index] = std::move(copy);
+  }
+
+  return *_edited_chunks[index];
+}
+
+std::vector<AssetReference>& TileTransaction::EditTextures()
+{
+  if (!_edited_textures)
+  {
+    auto copy = std::make_shared<std::vector<AssetReference>>(*_textures);
+    _edited_textures = copy.get();
+    _textures = std::move(copy);
+  }
+
+  return *_edited_textures;
+}
+
+TilePlacements& TileTransaction::EditPlacements()
+{
+  if (!_edited_placements)
+  {
+    auto copy = std::make_shared<TilePlacements>(*_placements);
+    _edited_placements = copy.get();
+    _placements = std::move(copy);
+  }
+
+  return *_edited_placements;
+}
+
+bool TileTransaction::IsModified() const
+{
+  return _edited_textures || _edited_placements
+    || std::any_of(_edited_chunks.begin(), _edited_chunks.end(), [](ChunkData* chunk) { return chunk; });
+}
+
+TileVersionStore::TileVersionStore()
+: _tiles(std::make_unique<std::array<std::atomic<TileSnapshotHandle>, WorldConstants::MAX_TILES_PER_MAP>>())
+{
+}
+
+std::size_t TileVersionStore::Slot(Common::DataStructures::TileIndex tile_index)
+{
+  RequireF(CCodeZones::FILE_IO, tile_index.x < 64 && tile_index.y < 64, "Tile index out of bounds.");
+  return tile_index.y * 64 + tile_index.x;
+}
+
+void TileVersionStore::Load(Common::DataStructures::TileIndex tile_index, RegionTile const& tile)
+{
+  // not constructible through make_shared, constructor is private
+  std::shared_ptr<TileSnapshot> snapshot {new TileSnapshot()};
+  snapshot->_tile = tile_index;
+
+  for (std::size_t i = 0; i < WorldConstants::CHUNKS_PER_TILE; ++i)
+  {
+    snapshot->_chunks[i] = std::make_shared<ChunkData const>(ChunkData{tile.terrain[i]
+                                                                       , tile.texturing.chunks[i]
+                                                                       , tile.liquids.chunks()[i]});
+  }
+
+  snapshot->_textures = std::make_shared<std::vector<AssetReference> const>(tile.texturing.textures);
+  snapshot->_placements = std::make_shared<TilePlacements const>(tile.placements);
+
+  (*_tiles)[Slot(tile_index)].store(std::move(snapshot));
+}
+
+void TileVersionStore::Unload(Common::DataStructures::TileIndex tile_index)
+{
+  (*_tiles)[Slot(tile_index)].store(nullptr);
+}
+
+TileSnapshotHandle TileVersionStore::Acquire(Common::DataStructures::TileIndex tile_index) const
+{
+  return (*_tiles)[Slot(tile_index)].load();
+}
+
+TileTransaction TileVersionStore::Begin(Common::DataStructures::TileIndex tile_index) const
+{
+  TileSnapshotHandle base = Acquire(tile_index);
+  RequireF(CCodeZones::FILE_IO, base != nullptr, "Tile is not loaded.");
+
+  return TileTransaction{std::move(base)};
+}
+
+TileSnapshotHandle TileVersionStore::Commit(TileTransaction&& transaction)
+{
+  RequireF(CCodeZones::FILE_IO, transaction._base != nullptr, "Transaction was moved-from or already committed.");
+
+  TileTransaction consumed = std::move(transaction);
+  TileSnapshotHandle expected = consumed._base;
+
+  if (!consumed.IsModified())
+    return expected;
+
+  std::shared_ptr<TileSnapshot> snapshot {new TileSnapshot()};
+  snapshot->_tile = expected->_tile;
+  snapshot->_version = expected->_version + 1;
+  snapshot->_chunks = std::move(consumed._chunks);
+  snapshot->_textures = std::move(consumed._textures);
+  snapshot->_placements = std::move(consumed._placements);
+
+  TileSnapshotHandle published = std::move(snapshot);
+
+  if (!(*_tiles)[Slot(expected->_tile)].compare_exchange_strong(expected, published))
+  {
+    LogDebugF(LCodeZones::FILE_IO, "Commit to tile (%d, %d) conflicted with version %d."
+              , published->Tile().x, published->Tile().y, expected ? expected->Version() : 0);
+    return nullptr;
+  }
+
+  return published;
+}
@@ -0,0 +1,213 @@
+#pragma once
+#include <IO/CommonDataStructures.hpp>
+#include <IO/WorldConstants.hpp>
+#include <IO/ADT/TileData.hpp>
+#include <IO/ADT/Root/MH2O.hpp>
+#include <IO/ADT/Root/TileTerrain.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace IO::ADT
+{
+  /**
+   * Data of one map chunk across root, texture and liquid storage. Unit of sharing between tile versions.
+   */
+  struct ChunkData
+  {
+    ChunkTerrain terrain;
+    ChunkTexturing texturing;
+    LiquidChunk liquids;
+  };
+
+  /**
+   * Immutable version of a tile. Versions share chunks and tile-level data they did not change,
+   * so a version costs only the chunks edited since the previous one.
+   */
+  class TileSnapshot
+  {
+    friend class TileTransaction;
+    friend class TileVersionStore;
+
+  public:
+    /**
+     * Version number, counting commits of the tile since it was loaded.
+     */
+    [[nodiscard]]
+    std::uint64_t Version() const { return _version; };
+
+    [[nodiscard]]
+    Common::DataStructures::TileIndex Tile() const { return _tile; };
+
+    /**
+     * @param index Row-major chunk index.
+     */
+    [[nodiscard]]
+    ChunkData const& Chunk(std::size_t index) const;
+
+    [[nodiscard]]
+    std::vector<AssetReference> const& Textures() const { return *_textures; };
+
+    [[nodiscard]]
+    TilePlacements const& Placements() const { return *_placements; };
+
+    /**
+     * Checks whether a chunk is the same object in another version of the tile, i.e. unchanged between them.
+     * @param other Another version of the tile.
+     * @param index Row-major chunk index.
+     * @return True if the chunk is shared.
+     */
+    [[nodiscard]]
+    bool SharesChunk(TileSnapshot const& other, std::size_t index) const;
+
+    /**
+     * Copies the version into detached tile data.
+     * @param tile Tile to write to.
+     */
+    void Extract(RegionTile& tile) const;
+
+  private:
+    TileSnapshot() = default;
+
+    Common::DataStructures::TileIndex _tile {};
+    std::uint64_t _version = 0;
+    std::array<std::shared_ptr<ChunkData const>, Common::WorldConstants::CHUNKS_PER_TILE> _chunks;
+    std::shared_ptr<std::vector<AssetReference> const> _textures;
+    std::shared_ptr<TilePlacements const> _placements;
+  };
+
+  /**
+   * Handle keeping a tile version alive. Versions are reclaimed once the last handle to them is released.
+   */
+  using TileSnapshotHandle = std::shared_ptr<TileSnapshot const>;
+
+  /**
+   * Edits of one tile, based on a version of it. Data is copied on first write at chunk granularity,
+   * reads of untouched data go to the base version. Not thread-safe, a transaction belongs to one writer.
+   */
+  class TileTransaction
+  {
+    friend class TileVersionStore;
+
+  public:
+    explicit TileTransaction(TileSnapshotHandle base);
+
+    // copies would share the data copied on write, edits of one would leak into the other
+    TileTransaction(TileTransaction const&) = delete;
+    TileTransaction& operator=(TileTransaction const&) = delete;
+
+    // written out, so that the moved-from transaction no longer points to data it handed over
+    TileTransaction(TileTransaction&& other) noexcept;
+    TileTransaction& operator=(TileTransaction&& other) noexcept;
+
+    [[nodiscard]]
+    TileSnapshotHandle const& Base() const { return _base; };
+
+    /**
+     * @param index Row-major chunk index.
+     */
+    [[nodiscard]]
+    ChunkData const& Chunk(std::size_t index) const;
+
+    /**
+     * Provides a chunk for writing, copying it from the base version on first access.
+     * @param index Row-major chunk index.
+     */
+    [[nodiscard]]
+    ChunkData& EditChunk(std::size_t index);
+
+    [[nodiscard]]
+    std::vector<AssetReference> const& Textures() const { return *_textures; };
+
+    [[nodiscard]]
+    std::vector<AssetReference>& EditTextures();
+
+    [[nodiscard]]
+    TilePlacements const& Placements() const { return *_placements; };
+
+    [[nodiscard]]
+    TilePlacements& EditPlacements();
+
+    /**
+     * Checks whether anything was edited.
+     */
+    [[nodiscard]]
+    bool IsModified() const;
+
+  private:
+    TileSnapshotHandle _base;
+    std::array<std::shared_ptr<ChunkData const>, Common::WorldConstants::CHUNKS_PER_TILE> _chunks;
+    std::shared_ptr<std::vector<AssetReference> const> _textures;
+    std::shared_ptr<TilePlacements const> _placements;
+
+    // data copied by this transaction, still writable
+    std::array<ChunkData*, Common::WorldConstants::CHUNKS_PER_TILE> _edited_chunks {};
+    std::vector<AssetReference>* _edited_textures = nullptr;
+    TilePlacements* _edited_placements = nullptr;
+  };
+
+  /**
+   * Multi-version store of map tiles for concurrent readers and writers.
+   *
+   * Readers acquire an immutable snapshot of a tile and keep reading it while writers prepare new versions
+   * in transactions. A commit publishes the new version atomically if nobody else committed to the tile
+   * in the meantime (optimistic concurrency), otherwise the writer has to rebase.
+   * Unchanged chunks are shared between versions instead of deep-copied, and versions are reclaimed
+   * by reference counting as soon as the last reader releases them.
+   *
+   * Tiles are published through std::atomic<std::shared_ptr>, which is not lock-free in libstdc++ or MSVC:
+   * acquiring and committing take a short per-tile lock around the reference count update.
+   * Readers never wait for transactions, only for concurrent acquires and commits of the same tile.
+   */
+  class TileVersionStore
+  {
+  public:
+    TileVersionStore();
+
+    /**
+     * Loads a tile as version 0, replacing any loaded version.
+     * @param tile_index Tile coordinates on WDT grid.
+     * @param tile Detached tile data.
+     */
+    void Load(Common::DataStructures::TileIndex tile_index, RegionTile const& tile);
+
+    /**
+     * Removes a tile. Readers holding snapshots of it are not affected.
+     * @param tile_index Tile coordinates on WDT grid.
+     */
+    void Unload(Common::DataStructures::TileIndex tile_index);
+
+    /**
+     * Acquires the latest version of a tile. Thread-safe.
+     * @param tile_index Tile coordinates on WDT grid.
+     * @return Snapshot handle, empty if the tile is not loaded.
+     */
+    [[nodiscard]]
+    TileSnapshotHandle Acquire(Common::DataStructures::TileIndex tile_index) const;
+
+    /**
+     * Starts editing the latest version of a tile. Thread-safe.
+     * @param tile_index Tile coordinates on WDT grid. Tile must be loaded.
+     * @return Transaction based on the latest version.
+     */
+    [[nodiscard]]
+    TileTransaction Begin(Common::DataStructures::TileIndex tile_index) const;
+
+    /**
+     * Publishes edits of a transaction as the next version of its tile. Thread-safe.
+     * The transaction is consumed either way.
+     * @param transaction Transaction to commit. Must not be moved-from or already committed.
+     * @return Published version, empty if another version was committed since the transaction began.
+     */
+    TileSnapshotHandle Commit(TileTransaction&& transaction);
+
+  private:
+    [[nodiscard]]
+    static std::size_t Slot(Common::DataStructures::TileIndex tile_index);
+
+    std::unique_ptr<std::array<std::atomic<TileSnapshotHandle>, Common::WorldConstants::MAX_TILES_PER_MAP>> _tiles;
+  };
+}
@@ -0,0 +1,304 @@
+#include <IO/BLP/BLPEncoder.hpp>
+#include <IO/Common.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numbers>
+
+using namespace IO::BLP;
+using namespace IO::BLP::DataStructures;
+using namespace IO::Common;
+
+namespace
+{
+  struct FilterTap
+  {
+    int offset; ///> Source pixel relative to 2 * destination pixel.
+    float weight;
+  };
+
+  double BesselI0(double x)
+  {
+    double sum = 1.0;
+    double term = 1.0;
+
+    for (int k = 1; k < 32; ++k)
+    {
+      term *= (x / (2.0 * k)) * (x / (2.0 * k));
+      sum += term;
+    }
+
+    return sum;
+  }
+
+  std::vector<FilterTap> BuildKaiserTaps()
+  {
+    constexpr double width = 3.0;
+    constexpr double alpha = 4.0;
+    constexpr int n_side_taps = 6;
+
+    std::vector<FilterTap> taps;
+    double sum = 0.0;
+
+    for (int offset = 1 - n_side_taps; offset <= n_side_taps; ++offset)
+    {
+      // distance from the destination pixel center, in destination pixels
+      double const t = (offset - 0.5) / 2.0;
+      double const sinc = std::sin(std::numbers::pi * t) / (std::numbers::pi * t);
+      double const window = BesselI0(alpha * std::sqrt(1.0 - (t / width) * (t / width))) / BesselI0(alpha);
+
+      taps.push_back({offset, static_cast<float>(sinc * window)});
+      sum += sinc * window;
+    }
+
+    for (FilterTap& tap : taps)
+      tap.weight = static_cast<float>(tap.weight / sum);
+
+    return taps;
+  }
+
+  std::vector<FilterTap> const& FilterTaps(MipFilter filter)
+  {
+    static std::vector<FilterTap> const box_taps {{0, 0.5f}, {1, 0.5f}};
+    static std::vector<FilterTap> const kaiser_taps = BuildKaiserTaps();
+
+    return filter == MipFilter::KAISER ? kaiser_taps : box_taps;
+  }
+
+  std::uint8_t ToByte(float value)
+  {
+    return static_cast<std::uint8_t>(std::clamp(value + 0.5f, 0.f, 255.f));
+  }
+
+  std::uint32_t NumMipLevels(std::uint32_t width, std::uint32_t height)
+  {
+    std::uint32_t n_levels = 1;
+
+    while ((width > 1 || height > 1) && n_levels < BLP_MAX_MIP_LEVELS)
+    {
+      width = std::max(width / 2, 1u);
+      height = std::max(height / 2, 1u);
+      ++n_levels;
+    }
+
+    return n_levels;
+  }
+}
+
+void BLPEncoder::Downsample(Image const& image, MipFilter filter, Image& mip)
+{
+  RequireF(CCodeZones::FILE_IO, image.width && image.height
+           && image.pixels.size() == std::size_t(image.width) * image.height * 4, "Malformed image.");
+
+  auto const& taps = FilterTaps(filter);
+
+  mip.width = std::max(image.width / 2, 1u);
+  mip.height = std::max(image.height / 2, 1u);
+  mip.pixels.resize(std::size_t(mip.width) * mip.height * 4);
+
+  int const max_x = static_cast<int>(image.width) - 1;
+  int const max_y = static_cast<int>(image.height) - 1;
+
+  // horizontal pass into float rows of the destination width
+  std::vector<float> horizontal (std::size_t(mip.width) * image.height * 4, 0.f);
+
+  for (std::uint32_t y = 0; y < image.height; ++y)
+  {
+    std::uint8_t const* src_row = image.pixels.data() + std::size_t(y) * image.width * 4;
+    float* dst_row = horizontal.data() + std::size_t(y) * mip.width * 4;
+
+    for (std::uint32_t x = 0; x < mip.width; ++x)
+    {
+      for (FilterTap const& tap : taps)
+      {
+        std::uint8_t const* src = src_row + std::clamp(int(x * 2) + tap.offset, 0, max_x) * 4;
+
+        for (unsigned c = 0; c < 4; ++c)
+          dst_row[x * 4 + c] += src[c] * tap.weight;
+      }
+    }
+  }
+
+  // vertical pass, accumulated over whole rows
+  std::vector<float> row (std::size_t(mip.width) * 4);
+
+  for (std::uint32_t y = 0; y < mip.height; ++y)
+  {
+    std::fill(row.begin(), row.end(), 0.f);
+
+    for (FilterTap const& tap : taps)
+    {
+      float const* src_row = horizontal.data()
+        + std::size_t(std::clamp(int(y * 2) + tap.offset, 0, max_y)) * mip.width * 4;
+
+      for (std::size_t i = 0; i < row.size(); ++i)
+        row[i] += src_row[i] * tap.weight;
+    }
+
+    std::transform(row.begin(), row.end(), mip.pixels.begin() + std::ptrdiff_t(y) * mip.width * 4, ToByte);
+  }
+}
+
+void BLPEncoder::EncodeLevel(Image const& image, BLPFormat format, CompressionQuality quality, std::vector<char>& out)
+{
+  RequireF(CCodeZones::FILE_IO, image.width && image.height
+           && image.pixels.size() == std::size_t(image.width) * image.height * 4, "Malformed image.");
+
+  if (format == BLPFormat::UNCOMPRESSED)
+  {
+    std::size_t const begin = out.size();
+    out.resize(begin + image.pixels.size());
+
+    for (std::size_t i = 0; i < image.pixels.size(); i += 4)
+    {
+      out[begin + i] = static_cast<char>(image.pixels[i + 2]);
+      out[begin + i + 1] = static_cast<char>(image.pixels[i + 1]);
+      out[begin + i + 2] = static_cast<char>(image.pixels[i]);
+      out[begin + i + 3] = static_cast<char>(image.pixels[i + 3]);
+    }
+
+    return;
+  }
+
+  std::size_t const block_size = format == BLPFormat::DXT1 ? 8 : 16;
+  std::uint32_t const n_blocks_x = (image.width + 3) / 4;
+  std::uint32_t const n_blocks_y = (image.height + 3) / 4;
+
+  std::size_t const begin = out.size();
+  out.resize(begin + block_size * n_blocks_x * n_blocks_y);
+  auto dst = reinterpret_cast<std::uint8_t*>(out.data() + begin);
+
+  BlockCompressor::Block block;
+
+  for (std::uint32_t block_y = 0; block_y < n_blocks_y; ++block_y)
+  {
+    for (std::uint32_t block_x = 0; block_x < n_blocks_x; ++block_x)
+    {
+      // partial blocks replicate edge pixels
+      for (std::uint32_t y = 0; y < 4; ++y)
+      {
+        std::uint32_t const src_y = std::min(block_y * 4 + y, image.height - 1);
+
+        for (std::uint32_t x = 0; x < 4; ++x)
+        {
+          std::uint32_t const src_x = std::min(block_x * 4 + x, image.width - 1);
+          std::copy_n(image.pixels.data() + (std::size_t(src_y) * image.width + src_x) * 4, 4
+                      , block.data() + (y * 4 + x) * 4);
+        }
+      }
+
+      switch (format)
+      {
+        case BLPFormat::DXT1:
+          BlockCompressor::CompressColor(block, quality, dst);
+          break;
+        case BLPFormat::DXT3:
+          BlockCompressor::CompressExplicitAlpha(block, dst);
+          BlockCompressor::CompressColor(block, quality, dst + 8);
+          break;
+        case BLPFormat::DXT5:
+          BlockCompressor::CompressInterpolatedAlpha(block, dst);
+          BlockCompressor::CompressColor(block, quality, dst + 8);
+          break;
+        default:
+          break;
+      }
+
+      dst += block_size;
+    }
+  }
+}
+
+void BLPEncoder::Encode(Image const& image, EncodeSettings const& settings, ByteBuffer& buf)
+{
+  RequireF(CCodeZones::FILE_IO, image.width && image.height
+           && image.pixels.size() == std::size_t(image.width) * image.height * 4, "Malformed image.");
+
+  BLP2Header header {};
+  header.magic = FourCC<"BLP2", FourCCEndian::Big>;
+  header.type = 1;
+  header.has_mips = settings.generate_mips;
+  header.width = image.width;
+  header.height = image.height;
+
+  switch (settings.format)
+  {
+    case BLPFormat::DXT1:
+      header.color_encoding = BLPColorEncoding::DXT;
+      header.alpha_depth = 0;
+      header.preferred_format = BLPPreferredFormat::DXT1;
+      break;
+    case BLPFormat::DXT3:
+      header.color_encoding = BLPColorEncoding::DXT;
+      header.alpha_depth = 8;
+      header.preferred_format = BLPPreferredFormat::DXT3;
+      break;
+    case BLPFormat::DXT5:
+      header.color_encoding = BLPColorEncoding::DXT;
+      header.alpha_depth = 8;
+      header.preferred_format = BLPPreferredFormat::DXT5;
+      break;
+    case BLPFormat::UNCOMPRESSED:
+      header.color_encoding = BLPColorEncoding::ARGB8888;
+      header.alpha_depth = 8;
+      header.preferred_format = BLPPreferredFormat::ARGB8888;
+      break;
+  }
+
+  std::uint32_t const n_levels = settings.generate_mips ? NumMipLevels(image.width, image.height) : 1;
+
+  std::vector<char> out (sizeof(BLP2Header));
+  Image mips[2];
+  Image const* level = &image;
+
+  for (std::uint32_t i = 0; i < n_levels; ++i)
+  {
+    if (i)
+    {
+      Image& mip = mips[i % 2];
+      Downsample(*level, settings.mip_filter, mip);
+      level = &mip;
+    }
+
+    std::size_t const offset = out.size();
+    EncodeLevel(*level, settings.format, settings.quality, out);
+
+    header.mip_offsets[i] = static_cast<std::uint32_t>(offset);
+    header.mip_sizes[i] = static_cast<std::uint32_t>(out.size() - offset);
+  }
+
+  std::copy_n(reinterpret_cast<char const*>(&header), sizeof(BLP2Header), out.begin());
+  buf.Write(out.begin(), out.end());
+}
+
+std::size_t BLPEncoder::EncodeBatch(std::size_t n_images
+                                    , ImageLoader const& loader
+                                    , BLPConsumer const& consumer
+                                    , EncodeSettings const& settings
+                                    , unsigned n_threads)
+{
+  LogDebugF(LCodeZones::FILE_IO, "Encoding %d images to BLP.", n_images);
+
+  std::atomic<std::size_t> n_encoded = 0;
+
+  Utils::Misc::ParallelFor(n_images, [&](std::size_t i)
+  {
+    Image image;
+
+    if (!loader(i, image))
+      return;
+
+    ByteBuffer buf;
+    Encode(image, settings, buf);
+    consumer(i, buf);
+
+    ++n_encoded;
+  }, n_threads);
+
+  return n_encoded;
+}
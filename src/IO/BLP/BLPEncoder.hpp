@@ -0,0 +1,127 @@
+#pragma once
+#include <IO/ByteBuffer.hpp>
+#include <IO/BLP/BlockCompressor.hpp>
+#include <IO/BLP/DataStructures.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace IO::BLP
+{
+  /**
+   * RGBA8 image, row-major, 4 bytes per pixel.
+   */
+  struct Image
+  {
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+    std::vector<std::uint8_t> pixels;
+  };
+
+  /**
+   * Pixel format of encoded BLP2 files.
+   */
+  enum class BLPFormat
+  {
+    DXT1 = 0, ///> Opaque, 4 bits per pixel.
+    DXT3 = 1, ///> Explicit 4-bit alpha, 8 bits per pixel.
+    DXT5 = 2, ///> Interpolated alpha, 8 bits per pixel.
+    UNCOMPRESSED = 3 ///> BGRA8888, 32 bits per pixel.
+  };
+
+  /**
+   * Filter used to downsample mip levels.
+   */
+  enum class MipFilter
+  {
+    BOX = 0, ///> 2x2 average, fastest.
+    KAISER = 1 ///> Kaiser-windowed sinc, sharper minified images.
+  };
+
+  struct EncodeSettings
+  {
+    BLPFormat format = BLPFormat::DXT1;
+    CompressionQuality quality = CompressionQuality::NORMAL;
+    MipFilter mip_filter = MipFilter::BOX;
+    bool generate_mips = true;
+
+    /**
+     * Settings favouring speed, e.g. for previews.
+     */
+    static EncodeSettings Fast(BLPFormat format)
+    {
+      return {format, CompressionQuality::FAST, MipFilter::BOX, true};
+    };
+
+    /**
+     * Settings favouring quality, e.g. for final minimap tiles.
+     */
+    static EncodeSettings Best(BLPFormat format)
+    {
+      return {format, CompressionQuality::HIGH, MipFilter::KAISER, true};
+    };
+  };
+
+  /**
+   * Encodes RGBA8 images into BLP2 files (DXT1, DXT3, DXT5 or uncompressed), with optional mip chains.
+   */
+  class BLPEncoder
+  {
+  public:
+    /**
+     * Loads an image to encode. Invoked concurrently from worker threads, must be thread-safe.
+     * Must match signature: bool(std::size_t index, Image& image).
+     * Returns false to skip the image.
+     */
+    using ImageLoader = std::function<bool(std::size_t, Image&)>;
+
+    /**
+     * Receives an encoded file. Invoked concurrently from worker threads, must be thread-safe.
+     * Must match signature: void(std::size_t index, Common::ByteBuffer const& blp).
+     */
+    using BLPConsumer = std::function<void(std::size_t, Common::ByteBuffer const&)>;
+
+    /**
+     * Encodes an image into a BLP2 file.
+     * @param image Image to encode, at least 1x1.
+     * @param settings Encoding settings.
+     * @param buf Buffer to write the file to.
+     */
+    static void Encode(Image const& image, EncodeSettings const& settings, Common::ByteBuffer& buf);
+
+    /**
+     * Encodes a batch of images in parallel, one image per worker at a time, so that only as many images
+     * as there are workers are held in memory.
+     * If a callback throws, the exception is propagated.
+     * @param n_images Number of images.
+     * @param loader Image loader callback.
+     * @param consumer Encoded file consumer callback.
+     * @param settings Encoding settings.
+     * @param n_threads Number of worker threads. 0 means hardware concurrency.
+     * @return Number of images encoded.
+     */
+    static std::size_t EncodeBatch(std::size_t n_images
+                                   , ImageLoader const& loader
+                                   , BLPConsumer const& consumer
+                                   , EncodeSettings const& settings
+                                   , unsigned n_threads = 0);
+
+    /**
+     * Downsamples an image to half its size (rounded down, at least 1) with edge clamping.
+     * @param image Source image.
+     * @param filter Downsampling filter.
+     * @param mip Image to write the result to.
+     */
+    static void Downsample(Image const& image, MipFilter filter, Image& mip);
+
+    /**
+     * Encodes the pixel data of one mip level.
+     * @param image Mip level image.
+     * @param format Pixel format, block formats are padded to 4x4 blocks by edge replication.
+     * @param quality Block compression quality.
+     * @param out Vector to append the data to.
+     */
+    static void EncodeLevel(Image const& image, BLPFormat format, CompressionQuality quality, std::vector<char>& out);
+  };
+}
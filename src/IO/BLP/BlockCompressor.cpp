@@ -0,0 +1,441 @@
+#include <IO/BLP/BlockCompressor.hpp>
+#include <Utils/Misc/SIMD.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace IO::BLP;
+
+namespace
+{
+  constexpr unsigned N_PIXELS = 16;
+
+  using Color = std::array<float, 3>;
+
+  // block colors as separate channels, so that per-pixel loops vectorize
+  struct ColorBlock
+  {
+    std::array<std::array<float, N_PIXELS>, 3> channels;
+  };
+
+  struct ColorFit
+  {
+    std::uint16_t color0;
+    std::uint16_t color1;
+    std::uint32_t indices;
+    float error;
+  };
+
+  using Palette = std::array<Color, 4>;
+
+  /**
+   * Finds the nearest of the first n_entries palette colors to every pixel.
+   * The error sum must not be fused into multiply-adds, which the build turns off for this file.
+   * Must match signature: void(ColorBlock const& block, Palette const& palette, unsigned n_entries
+   *                            , std::array<float, N_PIXELS>& best_error, std::array<std::uint32_t, N_PIXELS>& best_index).
+   */
+  using NearestEntriesFunction = void (*)(ColorBlock const&
+                                          , Palette const&
+                                          , unsigned
+                                          , std::array<float, N_PIXELS>&
+                                          , std::array<std::uint32_t, N_PIXELS>&);
+
+  void NearestEntries(ColorBlock const& block
+                      , Palette const& palette
+                      , unsigned n_entries
+                      , std::array<float, N_PIXELS>& best_error
+                      , std::array<std::uint32_t, N_PIXELS>& best_index)
+  {
+    best_error.fill(std::numeric_limits<float>::max());
+    best_index.fill(0);
+
+    for (std::uint32_t entry = 0; entry < n_entries; ++entry)
+    {
+      for (unsigned i = 0; i < N_PIXELS; ++i)
+      {
+        float const dr = block.channels[0][i] - palette[entry][0];
+        float const dg = block.channels[1][i] - palette[entry][1];
+        float const db = block.channels[2][i] - palette[entry][2];
+        float const error = dr * dr + dg * dg + db * db;
+
+        best_index[i] = error < best_error[i] ? entry : best_index[i];
+        best_error[i] = std::min(error, best_error[i]);
+      }
+    }
+  }
+
+#if defined(UTILS_SIMD)
+  /**
+   * Same as NearestEntries(), bit for bit, with 4 pixels per vector. Errors are summed in the same order
+   * and never fused, and a pixel only moves to an entry with a strictly lower error.
+   */
+  void NearestEntriesSIMD(ColorBlock const& block
+                          , Palette const& palette
+                          , unsigned n_entries
+                          , std::array<float, N_PIXELS>& best_error
+                          , std::array<std::uint32_t, N_PIXELS>& best_index)
+  {
+    for (unsigned i = 0; i < N_PIXELS; i += 4)
+    {
+#if defined(UTILS_SIMD_SSE2)
+      __m128 const r = _mm_loadu_ps(block.channels[0].data() + i);
+      __m128 const g = _mm_loadu_ps(block.channels[1].data() + i);
+      __m128 const b = _mm_loadu_ps(block.channels[2].data() + i);
+
+      __m128 best = _mm_set1_ps(std::numeric_limits<float>::max());
+      __m128i index = _mm_setzero_si128();
+
+      for (std::uint32_t entry = 0; entry < n_entries; ++entry)
+      {
+        __m128 const dr = _mm_sub_ps(r, _mm_set1_ps(palette[entry][0]));
+        __m128 const dg = _mm_sub_ps(g, _mm_set1_ps(palette[entry][1]));
+        __m128 const db = _mm_sub_ps(b, _mm_set1_ps(palette[entry][2]));
+        __m128 const error = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)), _mm_mul_ps(db, db));
+
+        __m128i const closer = _mm_castps_si128(_mm_cmplt_ps(error, best));
+        index = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(static_cast<int>(entry)))
+                             , _mm_andnot_si128(closer, index));
+        best = _mm_min_ps(best, error);
+      }
+
+      _mm_storeu_ps(best_error.data() + i, best);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(best_index.data() + i), index);
+#else
+      float32x4_t const r = vld1q_f32(block.channels[0].data() + i);
+      float32x4_t const g = vld1q_f32(block.channels[1].data() + i);
+      float32x4_t const b = vld1q_f32(block.channels[2].data() + i);
+
+      float32x4_t best = vdupq_n_f32(std::numeric_limits<float>::max());
+      uint32x4_t index = vdupq_n_u32(0);
+
+      for (std::uint32_t entry = 0; entry < n_entries; ++entry)
+      {
+        float32x4_t const dr = vsubq_f32(r, vdupq_n_f32(palette[entry][0]));
+        float32x4_t const dg = vsubq_f32(g, vdupq_n_f32(palette[entry][1]));
+        float32x4_t const db = vsubq_f32(b, vdupq_n_f32(palette[entry][2]));
+        float32x4_t const error = vaddq_f32(vaddq_f32(vmulq_f32(dr, dr), vmulq_f32(dg, dg)), vmulq_f32(db, db));
+
+        uint32x4_t const closer = vcltq_f32(error, best);
+        index = vbslq_u32(closer, vdupq_n_u32(entry), index);
+        best = vbslq_f32(closer, error, best);
+      }
+
+      vst1q_f32(best_error.data() + i, best);
+      vst1q_u32(best_index.data() + i, index);
+#endif
+    }
+  }
+#endif
+
+  /**
+   * @return Vectorized nearest entry search, unless Utils::Misc::SIMD selects the scalar path.
+   */
+  NearestEntriesFunction SelectNearestEntries()
+  {
+#if defined(UTILS_SIMD)
+    if (Utils::Misc::SIMD::IsEnabled())
+      return &NearestEntriesSIMD;
+#endif
+
+    return &NearestEntries;
+  }
+
+  std::uint16_t To565(Color const& color)
+  {
+    auto quantize = [](float value, int max) -> std::uint16_t
+    {
+      return static_cast<std::uint16_t>(std::clamp<long>(std::lround(value * max / 255.f), 0, max));
+    };
+
+    return static_cast<std::uint16_t>(quantize(color[0], 31) << 11 | quantize(color[1], 63) << 5 | quantize(color[2], 31));
+  }
+
+  Color From565(std::uint16_t value)
+  {
+    unsigned const r = (value >> 11) & 31;
+    unsigned const g = (value >> 5) & 63;
+    unsigned const b = value & 31;
+
+    return {float(r << 3 | r >> 2), float(g << 2 | g >> 4), float(b << 3 | b >> 2)};
+  }
+
+  /**
+   * Quantizes endpoints and assigns every pixel the nearest color of the resulting 4-color palette.
+   */
+  ColorFit FitIndices(ColorBlock const& block
+                      , Color const& endpoint0
+                      , Color const& endpoint1
+                      , NearestEntriesFunction nearest_entries)
+  {
+    ColorFit fit {To565(endpoint0), To565(endpoint1), 0, 0.f};
+
+    // 4-color mode requires color0 > color1, equal endpoints are encoded with index 0 only
+    if (fit.color0 < fit.color1)
+      std::swap(fit.color0, fit.color1);
+
+    Palette palette {From565(fit.color0), From565(fit.color1)};
+
+    for (unsigned c = 0; c < 3; ++c)
+    {
+      palette[2][c] = (2.f * palette[0][c] + palette[1][c]) / 3.f;
+      palette[3][c] = (palette[0][c] + 2.f * palette[1][c]) / 3.f;
+    }
+
+    std::array<float, N_PIXELS> best_error;
+    std::array<std::uint32_t, N_PIXELS> best_index;
+    nearest_entries(block, palette, fit.color0 == fit.color1 ? 1 : 4, best_error, best_index);
+
+    // summed in pixel order by every path, so that the error compared between fits is the same
+    for (unsigned i = 0; i < N_PIXELS; ++i)
+    {
+      fit.indices |= best_index[i] << (i * 2);
+      fit.error += best_error[i];
+    }
+
+    return fit;
+  }
+
+  void BoundingBoxEndpoints(ColorBlock const& block, Color& endpoint0, Color& endpoint1)
+  {
+    Color mean {};
+
+    for (unsigned c = 0; c < 3; ++c)
+    {
+      auto const [min, max] = std::minmax_element(block.channels[c].begin(), block.channels[c].end());
+
+      // inset the box to reduce the error of the interpolated colors
+      float const inset = (*max - *min) / 16.f;
+      endpoint0[c] = *max - inset;
+      endpoint1[c] = *min + inset;
+
+      for (float value : block.channels[c])
+        mean[c] += value / N_PIXELS;
+    }
+
+    // pick the box diagonal matching the correlation of red and blue with green
+    for (unsigned c : {0u, 2u})
+    {
+      float covariance = 0.f;
+
+      for (unsigned i = 0; i < N_PIXELS; ++i)
+        covariance += (block.channels[c][i] - mean[c]) * (block.channels[1][i] - mean[1]);
+
+      if (covariance < 0.f)
+        std::swap(endpoint0[c], endpoint1[c]);
+    }
+  }
+
+  void PrincipalAxisEndpoints(ColorBlock const& block, Color& endpoint0, Color& endpoint1)
+  {
+    Color mean {};
+
+    for (unsigned c = 0; c < 3; ++c)
+    {
+      for (float value : block.channels[c])
+        mean[c] += value / N_PIXELS;
+    }
+
+    std::array<float, 6> covariance {}; // rr, rg, rb, gg, gb, bb
+
+    for (unsigned i = 0; i < N_PIXELS; ++i)
+    {
+      float const r = block.channels[0][i] - mean[0];
+      float const g = block.channels[1][i] - mean[1];
+      float const b = block.channels[2][i] - mean[2];
+
+      covariance[0] += r * r;
+      covariance[1] += r * g;
+      covariance[2] += r * b;
+      covariance[3] += g * g;
+      covariance[4] += g * b;
+      covariance[5] += b * b;
+    }
+
+    // power iteration for the dominant eigenvector
+    Color axis {1.f, 1.f, 1.f};
+
+    for (unsigned iteration = 0; iteration < 8; ++iteration)
+    {
+      Color const next {covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2]
+                        , covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2]
+                        , covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2]};
+
+      float const length = std::max({std::abs(next[0]), std::abs(next[1]), std::abs(next[2])});
+
+      if (length < std::numeric_limits<float>::epsilon())
+        break;
+
+      axis = {next[0] / length, next[1] / length, next[2] / length};
+    }
+
+    float const axis_length_sq = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+    float min_t = std::numeric_limits<float>::max();
+    float max_t = std::numeric_limits<float>::lowest();
+
+    for (unsigned i = 0; i < N_PIXELS; ++i)
+    {
+      float const t = ((block.channels[0][i] - mean[0]) * axis[0]
+        + (block.channels[1][i] - mean[1]) * axis[1]
+        + (block.channels[2][i] - mean[2]) * axis[2]) / axis_length_sq;
+
+      min_t = std::min(min_t, t);
+      max_t = std::max(max_t, t);
+    }
+
+    for (unsigned c = 0; c < 3; ++c)
+    {
+      endpoint0[c] = std::clamp(mean[c] + axis[c] * max_t, 0.f, 255.f);
+      endpoint1[c] = std::clamp(mean[c] + axis[c] * min_t, 0.f, 255.f);
+    }
+  }
+
+  /**
+   * Solves for endpoints minimizing the squared error given the current index assignment.
+   * @return False if the assignment does not determine two endpoints.
+   */
+  bool RefitEndpoints(ColorBlock const& block, ColorFit const& fit, Color& endpoint0, Color& endpoint1)
+  {
+    constexpr std::array<float, 4> weights {1.f, 0.f, 2.f / 3.f, 1.f / 3.f};
+
+    float aa = 0.f, ab = 0.f, bb = 0.f;
+    Color ap {}, bp {};
+
+    for (unsigned i = 0; i < N_PIXELS; ++i)
+    {
+      float const a = weights[(fit.indices >> (i * 2)) & 3];
+      float const b = 1.f - a;
+
+      aa += a * a;
+      ab += a * b;
+      bb += b * b;
+
+      for (unsigned c = 0; c < 3; ++c)
+      {
+        ap[c] += a * block.channels[c][i];
+        bp[c] += b * block.channels[c][i];
+      }
+    }
+
+    float const determinant = aa * bb - ab * ab;
+
+    if (std::abs(determinant) < std::numeric_limits<float>::epsilon())
+      return false;
+
+    for (unsigned c = 0; c < 3; ++c)
+    {
+      endpoint0[c] = std::clamp((ap[c] * bb - bp[c] * ab) / determinant, 0.f, 255.f);
+      endpoint1[c] = std::clamp((bp[c] * aa - ap[c] * ab) / determinant, 0.f, 255.f);
+    }
+
+    return true;
+  }
+
+  template<typename T>
+  void WriteLE(std::uint8_t* out, T value)
+  {
+    for (unsigned i = 0; i < sizeof(T); ++i)
+      out[i] = static_cast<std::uint8_t>(value >> (i * 8));
+  }
+}
+
+void BlockCompressor::CompressColor(Block const& block, CompressionQuality quality, std::uint8_t* out)
+{
+  ColorBlock colors;
+
+  for (unsigned i = 0; i < N_PIXELS; ++i)
+  {
+    for (unsigned c = 0; c < 3; ++c)
+      colors.channels[c][i] = block[i * 4 + c];
+  }
+
+  Color endpoint0, endpoint1;
+
+  if (quality == CompressionQuality::FAST)
+    BoundingBoxEndpoints(colors, endpoint0, endpoint1);
+  else
+    PrincipalAxisEndpoints(colors, endpoint0, endpoint1);
+
+  NearestEntriesFunction const nearest_entries = SelectNearestEntries();
+  ColorFit fit = FitIndices(colors, endpoint0, endpoint1, nearest_entries);
+
+  if (quality == CompressionQuality::HIGH)
+  {
+    for (unsigned iteration = 0; iteration < 2 && fit.error > 0.f; ++iteration)
+    {
+      if (!RefitEndpoints(colors, fit, endpoint0, endpoint1))
+        break;
+
+      ColorFit const refit = FitIndices(colors, endpoint0, endpoint1, nearest_entries);
+
+      if (refit.error >= fit.error)
+        break;
+
+      fit = refit;
+    }
+  }
+
+  WriteLE(out, fit.color0);
+  WriteLE(out + 2, fit.color1);
+  WriteLE(out + 4, fit.indices);
+}
+
+void BlockCompressor::CompressExplicitAlpha(Block const& block, std::uint8_t* out)
+{
+  std::fill(out, out + 8, 0);
+
+  for (unsigned i = 0; i < N_PIXELS; ++i)
+  {
+    unsigned const alpha = (block[i * 4 + 3] * 15u + 127u) / 255u;
+    out[i / 2] |= static_cast<std::uint8_t>(alpha << ((i % 2) * 4));
+  }
+}
+
+void BlockCompressor::CompressInterpolatedAlpha(Block const& block, std::uint8_t* out)
+{
+  std::uint8_t alpha0 = 0;
+  std::uint8_t alpha1 = 255;
+
+  for (unsigned i = 0; i < N_PIXELS; ++i)
+  {
+    alpha0 = std::max(alpha0, block[i * 4 + 3]);
+    alpha1 = std::min(alpha1, block[i * 4 + 3]);
+  }
+
+  out[0] = alpha0;
+  out[1] = alpha1;
+
+  std::uint64_t indices = 0;
+
+  // equal endpoints select 6-alpha mode, where index 0 still yields alpha0
+  if (alpha0 != alpha1)
+  {
+    std::array<int, 8> palette {alpha0, alpha1};
+
+    for (int k = 1; k < 7; ++k)
+      palette[k + 1] = ((7 - k) * alpha0 + k * alpha1 + 3) / 7;
+
+    for (unsigned i = 0; i < N_PIXELS; ++i)
+    {
+      int const alpha = block[i * 4 + 3];
+      std::uint64_t best_index = 0;
+      int best_error = std::numeric_limits<int>::max();
+
+      for (unsigned entry = 0; entry < 8; ++entry)
+      {
+        int const error = std::abs(alpha - palette[entry]);
+
+        if (error < best_error)
+        {
+          best_error = error;
+          best_index = entry;
+        }
+      }
+
+      indices |= best_index << (i * 3);
+    }
+  }
+
+  for (unsigned i = 0; i < 6; ++i)
+    out[2 + i] = static_cast<std::uint8_t>(indices >> (i * 8));
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+namespace IO::BLP
+{
+  /**
+   * Trade-off between speed and quality of block compression.
+   */
+  enum class CompressionQuality
+  {
+    FAST = 0, ///> Color endpoints from the bounding box of a block.
+    NORMAL = 1, ///> Color endpoints from the principal axis of a block.
+    HIGH = 2 ///> Principal axis endpoints refined by least squares fitting.
+  };
+
+  /**
+   * Compresses 4x4 pixel blocks into DXT (BC1 - BC3) blocks.
+   *
+   * Blocks are given as 16 RGBA pixels, row-major. Colors are kept as separate channels, so that the search
+   * for the nearest palette color, which dominates compression time, runs on 4 pixels at once with SSE2 or NEON.
+   * The scalar path is used if Utils::Misc::SIMD::SetEnabled() selects it, and produces the same blocks.
+   */
+  class BlockCompressor
+  {
+  public:
+    using Block = std::array<std::uint8_t, 16 * 4>;
+
+    /**
+     * Compresses colors of a block in 4-color mode, ignoring alpha. Also used as color part of DXT3 / DXT5.
+     * @param block Block pixels.
+     * @param quality Compression quality.
+     * @param out 8 bytes of DXT1 block.
+     */
+    static void CompressColor(Block const& block, CompressionQuality quality, std::uint8_t* out);
+
+    /**
+     * Compresses alpha of a block into explicit 4-bit values.
+     * @param block Block pixels.
+     * @param out 8 bytes of DXT3 alpha block.
+     */
+    static void CompressExplicitAlpha(Block const& block, std::uint8_t* out);
+
+    /**
+     * Compresses alpha of a block into interpolated values.
+     * @param block Block pixels.
+     * @param out 8 bytes of DXT5 alpha block.
+     */
+    static void CompressInterpolatedAlpha(Block const& block, std::uint8_t* out);
+  };
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+namespace IO::BLP::DataStructures
+{
+  /**
+   * Color encoding of BLP2 pixel data.
+   */
+  enum class BLPColorEncoding : std::uint8_t
+  {
+    PALETTE = 1,
+    DXT = 2,
+    ARGB8888 = 3
+  };
+
+  /**
+   * Preferred pixel format of BLP2, selects the DXT variant for DXT encoding.
+   */
+  enum class BLPPreferredFormat : std::uint8_t
+  {
+    DXT1 = 0,
+    DXT3 = 1,
+    ARGB8888 = 2,
+    DXT5 = 7
+  };
+
+  constexpr unsigned BLP_MAX_MIP_LEVELS = 16;
+
+  /**
+   * BLP2 file header, followed by mip level data at the listed offsets.
+   */
+  struct BLP2Header
+  {
+    std::uint32_t magic;
+    std::uint32_t type; ///> 1 for DirectX-style formats, 0 for JPEG (unused).
+    BLPColorEncoding color_encoding;
+    std::uint8_t alpha_depth; ///> Bits of alpha: 0, 1, 4 or 8.
+    BLPPreferredFormat preferred_format;
+    std::uint8_t has_mips;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::array<std::uint32_t, BLP_MAX_MIP_LEVELS> mip_offsets; ///> Absolute offsets of mip levels, 0 if absent.
+    std::array<std::uint32_t, BLP_MAX_MIP_LEVELS> mip_sizes; ///> Sizes of mip levels in bytes, 0 if absent.
+    std::array<std::uint32_t, 256> palette; ///> BGRA palette, only used by palette encoding.
+  };
+
+  static_assert(sizeof(BLP2Header) == 1172);
+}
@@ -0,0 +1,164 @@
+#include <IO/Collision/BoundingVolumeHierarchy.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+using namespace IO::Collision;
+using namespace IO::Common;
+
+namespace
+{
+  using IO::Common::DataStructures::CAaBox;
+  using IO::Common::DataStructures::C3Vector;
+
+  constexpr std::size_t MAX_DEPTH = 64;
+
+  void ExtendBox(CAaBox& box, CAaBox const& other)
+  {
+    box.min = {std::min(box.min.x, other.min.x), std::min(box.min.y, other.min.y), std::min(box.min.z, other.min.z)};
+    box.max = {std::max(box.max.x, other.max.x), std::max(box.max.y, other.max.y), std::max(box.max.z, other.max.z)};
+  }
+
+  float Axis(C3Vector const& vec, unsigned axis)
+  {
+    return axis == 0 ? vec.x : (axis == 1 ? vec.y : vec.z);
+  }
+}
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy(std::vector<CAaBox> const& primitive_bounds)
+{
+  if (primitive_bounds.empty())
+    return;
+
+  RequireF(CCodeZones::FILE_IO, primitive_bounds.size() < std::numeric_limits<std::uint32_t>::max()
+           , "Too many primitives.");
+
+  std::vector<C3Vector> centroids;
+  centroids.reserve(primitive_bounds.size());
+
+  for (CAaBox const& box : primitive_bounds)
+  {
+    centroids.push_back({(box.min.x + box.max.x) / 2.f, (box.min.y + box.max.y) / 2.f
+                         , (box.min.z + box.max.z) / 2.f});
+  }
+
+  _primitives.resize(primitive_bounds.size());
+  std::iota(_primitives.begin(), _primitives.end(), 0);
+
+  // a binary tree with leaves of at least half capacity never needs more nodes than that
+  _nodes.reserve(2 * primitive_bounds.size() / (MAX_LEAF_SIZE / 2) + 1);
+
+  BuildNode(primitive_bounds, centroids, 0, static_cast<std::uint32_t>(primitive_bounds.size()));
+}
+
+std::uint32_t BoundingVolumeHierarchy::BuildNode(std::vector<CAaBox> const& primitive_bounds
+                                                 , std::vector<C3Vector> const& centroids
+                                                 , std::uint32_t begin
+                                                 , std::uint32_t end)
+{
+  std::uint32_t const node_index = static_cast<std::uint32_t>(_nodes.size());
+  _nodes.emplace_back();
+
+  CAaBox bounds = primitive_bounds[_primitives[begin]];
+  CAaBox centroid_bounds {centroids[_primitives[begin]], centroids[_primitives[begin]]};
+
+  for (std::uint32_t i = begin + 1; i < end; ++i)
+  {
+    ExtendBox(bounds, primitive_bounds[_primitives[i]]);
+    ExtendBox(centroid_bounds, {centroids[_primitives[i]], centroids[_primitives[i]]});
+  }
+
+  _nodes[node_index].bounds = bounds;
+
+  if (end - begin <= MAX_LEAF_SIZE)
+  {
+    _nodes[node_index].offset = begin;
+    _nodes[node_index].count = end - begin;
+    return node_index;
+  }
+
+  C3Vector const extent {centroid_bounds.max.x - centroid_bounds.min.x
+                         , centroid_bounds.max.y - centroid_bounds.min.y
+                         , centroid_bounds.max.z - centroid_bounds.min.z};
+
+  unsigned const axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+  std::uint32_t const middle = begin + (end - begin) / 2;
+
+  // ties are broken by primitive index to keep the build deterministic across standard library implementations
+  std::nth_element(_primitives.begin() + begin, _primitives.begin() + middle, _primitives.begin() + end
+                   , [&](std::uint32_t lhs, std::uint32_t rhs)
+                     {
+                       float const lhs_value = Axis(centroids[lhs], axis);
+                       float const rhs_value = Axis(centroids[rhs], axis);
+                       return lhs_value < rhs_value || (lhs_value == rhs_value && lhs < rhs);
+                     });
+
+  // sort the halves by index so that the layout does not depend on the selection algorithm either
+  std::sort(_primitives.begin() + begin, _primitives.begin() + middle);
+  std::sort(_primitives.begin() + middle, _primitives.begin() + end);
+
+  BuildNode(primitive_bounds, centroids, begin, middle);
+  std::uint32_t const second_child = BuildNode(primitive_bounds, centroids, middle, end);
+
+  _nodes[node_index].offset = second_child;
+  _nodes[node_index].count = 0;
+
+  return node_index;
+}
+
+void BoundingVolumeHierarchy::Read(ByteBuffer const& buf)
+{
+  _nodes.resize(buf.Read<std::uint32_t>());
+  buf.Read(_nodes.begin(), _nodes.end());
+
+  _primitives.resize(buf.Read<std::uint32_t>());
+  buf.Read(_primitives.begin(), _primitives.end());
+
+  // validate the topology, as traversal relies on it without checks
+  std::vector<std::pair<std::uint32_t, std::size_t>> stack;
+
+  if (!_nodes.empty())
+    stack.emplace_back(0, 1);
+
+  std::size_t n_visited = 0;
+
+  while (!stack.empty())
+  {
+    auto const [node_index, depth] = stack.back();
+    stack.pop_back();
+
+    EnsureF(CCodeZones::FILE_IO, ++n_visited <= _nodes.size(), "BVH contains shared nodes.");
+    EnsureF(CCodeZones::FILE_IO, depth <= MAX_DEPTH, "BVH is too deep.");
+
+    BVHNode const& node = _nodes[node_index];
+
+    if (node.count)
+    {
+      EnsureF(CCodeZones::FILE_IO, node.offset <= _primitives.size() && node.count <= _primitives.size() - node.offset
+              , "BVH leaf references non-existing primitives.");
+
+      continue;
+    }
+
+    EnsureF(CCodeZones::FILE_IO, node.offset > node_index + 1 && node.offset < _nodes.size()
+            , "BVH node references invalid children.");
+
+    stack.emplace_back(node_index + 1, depth + 1);
+    stack.emplace_back(node.offset, depth + 1);
+  }
+
+  EnsureF(CCodeZones::FILE_IO, n_visited == _nodes.size(), "BVH contains unreachable nodes.");
+}
+
+void BoundingVolumeHierarchy::Write(ByteBuffer& buf) const
+{
+  buf.Write(static_cast<std::uint32_t>(_nodes.size()));
+  buf.Write(_nodes.begin(), _nodes.end());
+
+  buf.Write(static_cast<std::uint32_t>(_primitives.size()));
+  buf.Write(_primitives.begin(), _primitives.end());
+}
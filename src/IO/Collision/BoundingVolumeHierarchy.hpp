@@ -0,0 +1,110 @@
+#pragma once
+#include <IO/ByteBuffer.hpp>
+#include <IO/CommonDataStructures.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace IO::Collision
+{
+  /**
+   * Node of a flattened bounding volume hierarchy.
+   * Nodes are stored depth-first, so the first child of an inner node always directly follows it.
+   */
+  struct BVHNode
+  {
+    Common::DataStructures::CAaBox bounds;
+    std::uint32_t offset; ///> Leaf: index of the first primitive in PrimitiveOrder(). Inner node: index of the second child.
+    std::uint32_t count; ///> Number of primitives in a leaf, 0 for inner nodes.
+  };
+
+  static_assert(sizeof(BVHNode) == 32);
+
+  /**
+   * Bounding volume hierarchy over a set of primitives given by their bounding boxes.
+   * Primitives themselves are not stored: queries report primitive indices to a callback, which performs
+   * the exact test. Used both for triangles of a mesh and for instances of meshes.
+   */
+  class BoundingVolumeHierarchy
+  {
+  public:
+    /**
+     * Maximum number of primitives stored in a leaf.
+     */
+    static constexpr std::uint32_t MAX_LEAF_SIZE = 4;
+
+    BoundingVolumeHierarchy() = default;
+
+    /**
+     * Builds the hierarchy by recursive median split along the largest axis of primitive centroids.
+     * The result only depends on the input, so it can be cached.
+     * @param primitive_bounds Bounding box of each primitive.
+     */
+    explicit BoundingVolumeHierarchy(std::vector<Common::DataStructures::CAaBox> const& primitive_bounds);
+
+    /**
+     * Visits primitives whose bounds are crossed by the ray within [t_min, t_max], approximately front to back.
+     * @tparam Callback Callable matching signature float(std::uint32_t primitive, float t_max).
+     * It returns the new maximal distance, i.e. the distance of a found hit, or t_max to keep searching as before.
+     * Returning a negative value stops the traversal.
+     * @param origin Ray origin.
+     * @param direction Ray direction. Not required to be normalized, distances are measured in its units.
+     * @param t_min Minimal distance along the ray.
+     * @param t_max Maximal distance along the ray.
+     * @param callback Exact primitive test.
+     */
+    template<typename Callback>
+    void QueryRay(Common::DataStructures::C3Vector const& origin
+                  , Common::DataStructures::C3Vector const& direction
+                  , float t_min
+                  , float t_max
+                  , Callback&& callback) const;
+
+    /**
+     * Visits primitives whose bounds overlap a box.
+     * @tparam Callback Callable matching signature bool(std::uint32_t primitive). Returning true stops the traversal.
+     * @param box Box to test against.
+     * @param callback Exact primitive test.
+     */
+    template<typename Callback>
+    void QueryBox(Common::DataStructures::CAaBox const& box, Callback&& callback) const;
+
+    [[nodiscard]]
+    bool IsEmpty() const { return _nodes.empty(); };
+
+    /**
+     * Returns the bounds of all primitives. Must not be called on an empty hierarchy.
+     */
+    [[nodiscard]]
+    Common::DataStructures::CAaBox const& Bounds() const { return _nodes.front().bounds; };
+
+    [[nodiscard]]
+    std::vector<BVHNode> const& Nodes() const { return _nodes; };
+
+    [[nodiscard]]
+    std::vector<std::uint32_t> const& PrimitiveOrder() const { return _primitives; };
+
+    /**
+     * Reads the hierarchy written by Write() at the current position of the buffer.
+     * @param buf Buffer to read from.
+     */
+    void Read(Common::ByteBuffer const& buf);
+
+    /**
+     * Writes the hierarchy into a buffer.
+     * @param buf Buffer to write to.
+     */
+    void Write(Common::ByteBuffer& buf) const;
+
+  private:
+    std::uint32_t BuildNode(std::vector<Common::DataStructures::CAaBox> const& primitive_bounds
+                            , std::vector<Common::DataStructures::C3Vector> const& centroids
+                            , std::uint32_t begin
+                            , std::uint32_t end);
+
+    std::vector<BVHNode> _nodes;
+    std::vector<std::uint32_t> _primitives;
+  };
+}
+
+#include <IO/Collision/BoundingVolumeHierarchy.inl>
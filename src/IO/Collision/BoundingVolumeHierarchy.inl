@@ -0,0 +1,251 @@
+#pragma once
+#include <IO/Collision/BoundingVolumeHierarchy.hpp>
+#include <Utils/Misc/SIMD.hpp>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+
+namespace IO::Collision
+{
+  namespace details
+  {
+    /**
+     * Ray-box slab test.
+     * @return Entry distance of the ray into the box, or +inf if the box is missed within [t_min, t_max].
+     */
+    inline float RayBoxEntry(Common::DataStructures::CAaBox const& box
+                             , Common::DataStructures::C3Vector const& origin
+                             , Common::DataStructures::C3Vector const& inv_direction
+                             , float t_min
+                             , float t_max)
+    {
+      float const tx0 = (box.min.x - origin.x) * inv_direction.x;
+      float const tx1 = (box.max.x - origin.x) * inv_direction.x;
+      float const ty0 = (box.min.y - origin.y) * inv_direction.y;
+      float const ty1 = (box.max.y - origin.y) * inv_direction.y;
+      float const tz0 = (box.min.z - origin.z) * inv_direction.z;
+      float const tz1 = (box.max.z - origin.z) * inv_direction.z;
+
+      float const t_enter = std::max({t_min, std::min(tx0, tx1), std::min(ty0, ty1), std::min(tz0, tz1)});
+      float const t_exit = std::min({t_max, std::max(tx0, tx1), std::max(ty0, ty1), std::max(tz0, tz1)});
+
+      return t_enter <= t_exit ? t_enter : std::numeric_limits<float>::infinity();
+    }
+
+    /**
+     * Slab test of both children of a node.
+     * @return Entry distances of the ray into the children, +inf for missed ones.
+     */
+    inline std::array<float, 2> RayChildrenEntry(Common::DataStructures::CAaBox const& first
+                                                 , Common::DataStructures::CAaBox const& second
+                                                 , Common::DataStructures::C3Vector const& origin
+                                                 , Common::DataStructures::C3Vector const& inv_direction
+                                                 , float t_min
+                                                 , float t_max)
+    {
+      return {RayBoxEntry(first, origin, inv_direction, t_min, t_max)
+              , RayBoxEntry(second, origin, inv_direction, t_min, t_max)};
+    }
+
+#if defined(UTILS_SIMD)
+    /**
+     * Same as RayChildrenEntry(), bit for bit, with one child per lane. Minima and maxima keep the operand order
+     * of std::min() and std::max(), so NaNs of rays starting on a slab plane resolve the same way.
+     */
+    inline std::array<float, 2> RayChildrenEntrySIMD(Common::DataStructures::CAaBox const& first
+                                                     , Common::DataStructures::CAaBox const& second
+                                                     , Common::DataStructures::C3Vector const& origin
+                                                     , Common::DataStructures::C3Vector const& inv_direction
+                                                     , float t_min
+                                                     , float t_max)
+    {
+      alignas(16) std::array<float, 4> t_entry;
+
+#if defined(UTILS_SIMD_SSE2)
+      struct Slab
+      {
+        __m128 enter;
+        __m128 exit;
+      };
+
+      // _mm_min_ps(b, a) and _mm_max_ps(b, a) return a unless b is smaller or larger, like std::min(a, b)
+      auto const slab = [&](float first_min, float second_min, float first_max, float second_max, float o, float inv)
+      {
+        __m128 const t0 = _mm_mul_ps(_mm_sub_ps(_mm_setr_ps(first_min, second_min, 0.f, 0.f), _mm_set1_ps(o))
+                                     , _mm_set1_ps(inv));
+        __m128 const t1 = _mm_mul_ps(_mm_sub_ps(_mm_setr_ps(first_max, second_max, 0.f, 0.f), _mm_set1_ps(o))
+                                     , _mm_set1_ps(inv));
+        return Slab {_mm_min_ps(t1, t0), _mm_max_ps(t1, t0)};
+      };
+
+      auto const [x_enter, x_exit] = slab(first.min.x, second.min.x, first.max.x, second.max.x, origin.x, inv_direction.x);
+      auto const [y_enter, y_exit] = slab(first.min.y, second.min.y, first.max.y, second.max.y, origin.y, inv_direction.y);
+      auto const [z_enter, z_exit] = slab(first.min.z, second.min.z, first.max.z, second.max.z, origin.z, inv_direction.z);
+
+      __m128 const t_enter = _mm_max_ps(z_enter, _mm_max_ps(y_enter, _mm_max_ps(x_enter, _mm_set1_ps(t_min))));
+      __m128 const t_exit = _mm_min_ps(z_exit, _mm_min_ps(y_exit, _mm_min_ps(x_exit, _mm_set1_ps(t_max))));
+      __m128 const is_hit = _mm_cmple_ps(t_enter, t_exit);
+
+      _mm_store_ps(t_entry.data(), _mm_or_ps(_mm_and_ps(is_hit, t_enter)
+                                             , _mm_andnot_ps(is_hit, _mm_set1_ps(std::numeric_limits<float>::infinity()))));
+#else
+      // vminq_f32() and vmaxq_f32() propagate NaNs, so minima and maxima select like std::min(a, b) instead
+      auto const min = [](float32x4_t a, float32x4_t b) { return vbslq_f32(vcltq_f32(b, a), b, a); };
+      auto const max = [](float32x4_t a, float32x4_t b) { return vbslq_f32(vcltq_f32(a, b), b, a); };
+
+      struct Slab
+      {
+        float32x4_t enter;
+        float32x4_t exit;
+      };
+
+      auto const slab = [&](float first_min, float second_min, float first_max, float second_max, float o, float inv)
+      {
+        alignas(16) std::array<float, 4> const mins {first_min, second_min, 0.f, 0.f};
+        alignas(16) std::array<float, 4> const maxs {first_max, second_max, 0.f, 0.f};
+
+        float32x4_t const t0 = vmulq_f32(vsubq_f32(vld1q_f32(mins.data()), vdupq_n_f32(o)), vdupq_n_f32(inv));
+        float32x4_t const t1 = vmulq_f32(vsubq_f32(vld1q_f32(maxs.data()), vdupq_n_f32(o)), vdupq_n_f32(inv));
+        return Slab {min(t0, t1), max(t0, t1)};
+      };
+
+      auto const [x_enter, x_exit] = slab(first.min.x, second.min.x, first.max.x, second.max.x, origin.x, inv_direction.x);
+      auto const [y_enter, y_exit] = slab(first.min.y, second.min.y, first.max.y, second.max.y, origin.y, inv_direction.y);
+      auto const [z_enter, z_exit] = slab(first.min.z, second.min.z, first.max.z, second.max.z, origin.z, inv_direction.z);
+
+      float32x4_t const t_enter = max(max(max(vdupq_n_f32(t_min), x_enter), y_enter), z_enter);
+      float32x4_t const t_exit = min(min(min(vdupq_n_f32(t_max), x_exit), y_exit), z_exit);
+
+      vst1q_f32(t_entry.data(), vbslq_f32(vcleq_f32(t_enter, t_exit), t_enter
+                                          , vdupq_n_f32(std::numeric_limits<float>::infinity())));
+#endif
+
+      return {t_entry[0], t_entry[1]};
+    }
+#endif
+
+    inline bool BoxesOverlap(Common::DataStructures::CAaBox const& a, Common::DataStructures::CAaBox const& b)
+    {
+      return a.min.x <= b.max.x && a.max.x >= b.min.x
+        && a.min.y <= b.max.y && a.max.y >= b.min.y
+        && a.min.z <= b.max.z && a.max.z >= b.min.z;
+    }
+  }
+
+  template<typename Callback>
+  void BoundingVolumeHierarchy::QueryRay(Common::DataStructures::C3Vector const& origin
+                                         , Common::DataStructures::C3Vector const& direction
+                                         , float t_min
+                                         , float t_max
+                                         , Callback&& callback) const
+  {
+    if (_nodes.empty())
+      return;
+
+    // division by zero yields infinities, which the slab test handles
+    Common::DataStructures::C3Vector const inv_direction {1.f / direction.x, 1.f / direction.y, 1.f / direction.z};
+
+    auto children_entry = &details::RayChildrenEntry;
+
+#if defined(UTILS_SIMD)
+    if (Utils::Misc::SIMD::IsEnabled())
+      children_entry = &details::RayChildrenEntrySIMD;
+#endif
+
+    constexpr float miss = std::numeric_limits<float>::infinity();
+
+    if (details::RayBoxEntry(_nodes[0].bounds, origin, inv_direction, t_min, t_max) == miss)
+      return;
+
+    // depth is bounded by the median split, 64 levels hold far more primitives than addressable
+    std::array<std::uint32_t, 64> stack;
+    std::size_t stack_size = 0;
+    std::uint32_t node_index = 0;
+
+    while (true)
+    {
+      BVHNode const& node = _nodes[node_index];
+
+      if (node.count)
+      {
+        for (std::uint32_t i = node.offset; i < node.offset + node.count; ++i)
+        {
+          t_max = callback(_primitives[i], t_max);
+
+          if (t_max < 0.f)
+            return;
+        }
+      }
+      else
+      {
+        std::uint32_t near_child = node_index + 1;
+        std::uint32_t far_child = node.offset;
+
+        auto [t_near, t_far] = children_entry(_nodes[near_child].bounds, _nodes[far_child].bounds
+                                              , origin, inv_direction, t_min, t_max);
+
+        if (t_far < t_near)
+        {
+          std::swap(near_child, far_child);
+          std::swap(t_near, t_far);
+        }
+
+        if (t_near != miss)
+        {
+          if (t_far != miss)
+            stack[stack_size++] = far_child;
+
+          node_index = near_child;
+          continue;
+        }
+      }
+
+      // pop nodes which may have become irrelevant after a closer hit was found
+      while (true)
+      {
+        if (!stack_size)
+          return;
+
+        node_index = stack[--stack_size];
+
+        if (details::RayBoxEntry(_nodes[node_index].bounds, origin, inv_direction, t_min, t_max) != miss)
+          break;
+      }
+    }
+  }
+
+  template<typename Callback>
+  void BoundingVolumeHierarchy::QueryBox(Common::DataStructures::CAaBox const& box, Callback&& callback) const
+  {
+    if (_nodes.empty())
+      return;
+
+    std::array<std::uint32_t, 64> stack;
+    std::size_t stack_size = 0;
+    stack[stack_size++] = 0;
+
+    while (stack_size)
+    {
+      BVHNode const& node = _nodes[stack[--stack_size]];
+
+      if (!details::BoxesOverlap(node.bounds, box))
+        continue;
+
+      if (node.count)
+      {
+        for (std::uint32_t i = node.offset; i < node.offset + node.count; ++i)
+        {
+          if (callback(_primitives[i]))
+            return;
+        }
+
+        continue;
+      }
+
+      std::uint32_t const node_index = static_cast<std::uint32_t>(&node - _nodes.data());
+      stack[stack_size++] = node.offset;
+      stack[stack_size++] = node_index + 1;
+    }
+  }
+}
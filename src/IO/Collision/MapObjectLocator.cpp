@@ -0,0 +1,485 @@
+#include <IO/Collision/MapObjectLocator.hpp>
+#include <IO/Common.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+using namespace IO::Collision;
+using namespace IO::Common;
+
+namespace
+{
+  using IO::Common::DataStructures::CAaBox;
+  using IO::Common::DataStructures::C3Vector;
+
+  constexpr std::uint32_t CACHE_MAGIC = IO::Common::FourCC<"MOLC">;
+  constexpr std::uint32_t CACHE_VERSION = 1;
+
+  // number of queries claimed by a worker at once
+  constexpr std::size_t QUERY_BATCH_SIZE = 64;
+
+  // distance within which the viewer counts as standing in a portal, in model space units
+  constexpr float PORTAL_EPSILON = 0.001f;
+
+  C3Vector Sub(C3Vector const& a, C3Vector const& b)
+  {
+    return {a.x - b.x, a.y - b.y, a.z - b.z};
+  }
+
+  C3Vector Cross(C3Vector const& a, C3Vector const& b)
+  {
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+  }
+
+  float Dot(C3Vector const& a, C3Vector const& b)
+  {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+  }
+
+  float Length(C3Vector const& a)
+  {
+    return std::sqrt(Dot(a, a));
+  }
+
+  C3Vector Lerp(C3Vector const& a, C3Vector const& b, float t)
+  {
+    return {a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t};
+  }
+}
+
+MapObjectModel::MapObjectModel(MapObjectDefinition const& definition)
+  : _root_id(definition.root_id)
+  , _groups(definition.groups)
+  , _portal_refs(definition.portal_refs)
+{
+  RequireF(CCodeZones::FILE_IO, definition.meshes.size() == definition.groups.size()
+           , "Map object must have one collision mesh per group.");
+
+  RequireF(CCodeZones::FILE_IO, std::all_of(_groups.begin(), _groups.end(), [this](MapObjectGroup const& group)
+                                            { return group.portal_start + group.portal_count <= _portal_refs.size(); })
+           , "Map object group references non-existing portal references.");
+
+  RequireF(CCodeZones::FILE_IO, std::all_of(_portal_refs.begin(), _portal_refs.end()
+                                            , [&](MapObjectPortalRef const& ref)
+                                              { return ref.portal < definition.portals.size()
+                                                  && ref.group < _groups.size(); })
+           , "Map object portal reference points to non-existing portal or group.");
+
+  _colliders.reserve(definition.meshes.size());
+
+  for (CollisionMesh const& mesh : definition.meshes)
+    _colliders.emplace_back(mesh);
+
+  _portals.reserve(definition.portals.size());
+
+  for (MapObjectPortal const& portal : definition.portals)
+  {
+    RequireF(CCodeZones::FILE_IO, portal.vertices.size() >= 3, "Map object portal must have at least 3 vertices.");
+
+    PortalData& data = _portals.emplace_back();
+    data.plane.normal = portal.normal;
+    data.plane.distance = -Dot(portal.normal, portal.vertices.front());
+    data.first_vertex = static_cast<std::uint32_t>(_portal_vertices.size());
+    data.n_vertices = static_cast<std::uint32_t>(portal.vertices.size());
+
+    _portal_vertices.insert(_portal_vertices.end(), portal.vertices.begin(), portal.vertices.end());
+  }
+
+  std::vector<CAaBox> group_bounds;
+  group_bounds.reserve(_groups.size());
+
+  for (MapObjectGroup const& group : _groups)
+    group_bounds.push_back(group.bounds);
+
+  _bvh = BoundingVolumeHierarchy(group_bounds);
+
+  LogDebugF(LCodeZones::FILE_IO, "Built map object model %d of %d groups, %d portals."
+            , _root_id, _groups.size(), _portals.size());
+}
+
+std::uint32_t MapObjectModel::LocateGroup(C3Vector const& point, C3Vector const& up, float& floor_distance) const
+{
+  if (_bvh.IsEmpty())
+    return NO_GROUP;
+
+  C3Vector const down {-up.x, -up.y, -up.z};
+  std::uint32_t result = NO_GROUP;
+
+  _bvh.QueryBox({point, point}, [&](std::uint32_t group_index) -> bool
+  {
+    MeshCollider const& collider = _colliders[group_index];
+
+    if (collider.IsEmpty())
+      return false;
+
+    // no floor or ceiling of the group is further away than its diagonal
+    MapObjectGroup const& group = _groups[group_index];
+    float const reach = Length(Sub(group.bounds.max, group.bounds.min)) / Length(up);
+
+    float floor = std::min(reach, result == NO_GROUP ? reach : floor_distance);
+
+    if (!collider.Raycast(point, down, 0.f, floor))
+      return false;
+
+    if ((group.flags & GROUP_INTERIOR) && !(group.flags & GROUP_EXTERIOR))
+    {
+      float ceiling = reach;
+
+      if (!collider.Raycast(point, up, 0.f, ceiling))
+        return false;
+    }
+
+    result = group_index;
+    floor_distance = floor;
+    return false;
+  });
+
+  return result;
+}
+
+std::vector<std::uint32_t> MapObjectModel::VisibleGroups(std::uint32_t group, C3Vector const& eye) const
+{
+  RequireF(CCodeZones::FILE_IO, group < _groups.size(), "Group index out of range.");
+
+  // std::vector<bool> would do, but is slower to access in the traversal
+  std::vector<std::uint8_t> visible(_groups.size());
+  visible[group] = 1;
+
+  TraversePortals(group, eye, {}, 0, visible);
+
+  std::vector<std::uint32_t> result;
+
+  for (std::uint32_t i = 0; i < visible.size(); ++i)
+  {
+    if (visible[i])
+      result.push_back(i);
+  }
+
+  return result;
+}
+
+void MapObjectModel::TraversePortals(std::uint32_t group
+                                     , C3Vector const& eye
+                                     , std::vector<Geometry::Plane> const& frustum
+                                     , unsigned depth
+                                     , std::vector<std::uint8_t>& visible) const
+{
+  MapObjectGroup const& group_data = _groups[group];
+
+  std::vector<C3Vector> polygon;
+  std::vector<C3Vector> clipped;
+
+  for (std::uint32_t i = group_data.portal_start; i < group_data.portal_start + group_data.portal_count; ++i)
+  {
+    MapObjectPortalRef const& ref = _portal_refs[i];
+    PortalData const& portal = _portals[ref.portal];
+
+    float const eye_distance = Dot(portal.plane.normal, eye) + portal.plane.distance;
+    bool const in_portal = std::abs(eye_distance) < PORTAL_EPSILON;
+
+    // portals are only looked through from the side of the group referencing them
+    if (!in_portal && eye_distance * static_cast<float>(ref.side) < 0.f)
+      continue;
+
+    polygon.assign(_portal_vertices.begin() + portal.first_vertex
+                   , _portal_vertices.begin() + portal.first_vertex + portal.n_vertices);
+
+    // Sutherland-Hodgman clipping against the current frustum
+    for (Geometry::Plane const& plane : frustum)
+    {
+      clipped.clear();
+
+      for (std::size_t j = 0; j < polygon.size(); ++j)
+      {
+        C3Vector const& a = polygon[j];
+        C3Vector const& b = polygon[(j + 1) % polygon.size()];
+        float const distance_a = Dot(plane.normal, a) + plane.distance;
+        float const distance_b = Dot(plane.normal, b) + plane.distance;
+
+        if (distance_a >= 0.f)
+          clipped.push_back(a);
+
+        if ((distance_a >= 0.f) != (distance_b >= 0.f))
+          clipped.push_back(Lerp(a, b, distance_a / (distance_a - distance_b)));
+      }
+
+      polygon.swap(clipped);
+
+      if (polygon.size() < 3)
+        break;
+    }
+
+    if (polygon.size() < 3)
+      continue;
+
+    visible[ref.group] = 1;
+
+    if (depth + 1 >= MAX_PORTAL_DEPTH)
+      continue;
+
+    // standing in the portal, the view into the next group is not narrowed by it
+    if (in_portal)
+    {
+      TraversePortals(ref.group, eye, frustum, depth + 1, visible);
+      continue;
+    }
+
+    C3Vector centroid {};
+
+    for (C3Vector const& vertex : polygon)
+      centroid = {centroid.x + vertex.x, centroid.y + vertex.y, centroid.z + vertex.z};
+
+    float const inv_count = 1.f / static_cast<float>(polygon.size());
+    centroid = {centroid.x * inv_count, centroid.y * inv_count, centroid.z * inv_count};
+
+    std::vector<Geometry::Plane> narrowed;
+    narrowed.reserve(polygon.size() + 1);
+
+    // near plane: only what lies beyond the portal
+    float const near_sign = eye_distance > 0.f ? -1.f : 1.f;
+    narrowed.push_back({{portal.plane.normal.x * near_sign, portal.plane.normal.y * near_sign
+                         , portal.plane.normal.z * near_sign}, portal.plane.distance * near_sign});
+
+    for (std::size_t j = 0; j < polygon.size(); ++j)
+    {
+      C3Vector normal = Cross(Sub(polygon[j], eye), Sub(polygon[(j + 1) % polygon.size()], eye));
+
+      if (Length(normal) < PORTAL_EPSILON * PORTAL_EPSILON)
+        continue;
+
+      float distance = -Dot(normal, eye);
+
+      if (Dot(normal, centroid) + distance < 0.f)
+      {
+        normal = {-normal.x, -normal.y, -normal.z};
+        distance = -distance;
+      }
+
+      narrowed.push_back({normal, distance});
+    }
+
+    TraversePortals(ref.group, eye, narrowed, depth + 1, visible);
+  }
+}
+
+void MapObjectModel::Read(ByteBuffer const& buf)
+{
+  EnsureF(CCodeZones::FILE_IO, buf.Read<std::uint32_t>() == CACHE_MAGIC, "Not a map object model cache.");
+  EnsureF(CCodeZones::FILE_IO, buf.Read<std::uint32_t>() == CACHE_VERSION, "Unsupported map object model cache version.");
+
+  _root_id = buf.Read<std::uint32_t>();
+
+  _groups.resize(buf.Read<std::uint32_t>());
+  buf.Read(_groups.begin(), _groups.end());
+
+  _colliders.resize(_groups.size());
+
+  for (MeshCollider& collider : _colliders)
+    collider.Read(buf);
+
+  _portals.resize(buf.Read<std::uint32_t>());
+  buf.Read(_portals.begin(), _portals.end());
+
+  _portal_vertices.resize(buf.Read<std::uint32_t>());
+  buf.Read(_portal_vertices.begin(), _portal_vertices.end());
+
+  _portal_refs.resize(buf.Read<std::uint32_t>());
+  buf.Read(_portal_refs.begin(), _portal_refs.end());
+
+  EnsureF(CCodeZones::FILE_IO, std::all_of(_portals.begin(), _portals.end(), [this](PortalData const& portal)
+                                           { return portal.n_vertices >= 3
+                                               && portal.first_vertex + portal.n_vertices <= _portal_vertices.size(); })
+          , "Map object portal references non-existing vertices.");
+
+  EnsureF(CCodeZones::FILE_IO, std::all_of(_portal_refs.begin(), _portal_refs.end()
+                                           , [this](MapObjectPortalRef const& ref)
+                                             { return ref.portal < _portals.size() && ref.group < _groups.size(); })
+                               && std::all_of(_groups.begin(), _groups.end(), [this](MapObjectGroup const& group)
+                                              { return group.portal_start + group.portal_count
+                                                  <= _portal_refs.size(); })
+          , "Corrupted map object portal references.");
+
+  _bvh.Read(buf);
+
+  EnsureF(CCodeZones::FILE_IO, _bvh.PrimitiveOrder().size() == _groups.size()
+                               && std::all_of(_bvh.PrimitiveOrder().begin(), _bvh.PrimitiveOrder().end()
+                                              , [this](std::uint32_t group) { return group < _groups.size(); })
+          , "Map object hierarchy does not match its groups.");
+}
+
+void MapObjectModel::Write(ByteBuffer& buf) const
+{
+  buf.Write(CACHE_MAGIC);
+  buf.Write(CACHE_VERSION);
+
+  buf.Write(_root_id);
+
+  buf.Write(static_cast<std::uint32_t>(_groups.size()));
+  buf.Write(_groups.begin(), _groups.end());
+
+  for (MeshCollider const& collider : _colliders)
+    collider.Write(buf);
+
+  buf.Write(static_cast<std::uint32_t>(_portals.size()));
+  buf.Write(_portals.begin(), _portals.end());
+
+  buf.Write(static_cast<std::uint32_t>(_portal_vertices.size()));
+  buf.Write(_portal_vertices.begin(), _portal_vertices.end());
+
+  buf.Write(static_cast<std::uint32_t>(_portal_refs.size()));
+  buf.Write(_portal_refs.begin(), _portal_refs.end());
+
+  _bvh.Write(buf);
+}
+
+MapObjectLocator::MapObjectLocator(ADT::TilePlacements const& placements, ModelProvider const& model_provider)
+{
+  // model pointer to its index in _models
+  std::unordered_map<MapObjectModel const*, std::uint32_t> model_indices;
+  std::vector<CAaBox> instance_bounds;
+
+  for (auto const& placement : placements.map_object_placements)
+  {
+    std::shared_ptr<MapObjectModel const> model = model_provider(placements.MapObjectAsset(placement));
+
+    if (!model || model->IsEmpty())
+      continue;
+
+    auto [it, is_new] = model_indices.try_emplace(model.get(), static_cast<std::uint32_t>(_models.size()));
+
+    if (is_new)
+      _models.push_back(model);
+
+    // scale of map objects is only used since Legion, and only if flagged
+    float const scale = placement.flags.has_scale ? static_cast<float>(placement.scale) / 1024.f : 1.f;
+
+    MapObjectInstance& instance = _instances.emplace_back();
+    instance.model = it->second;
+    instance.unique_id = placement.unique_id;
+    instance.name_set = placement.nameSet;
+    instance.to_world = TileCollision::PlacementTransform(placement.position, placement.rotation, scale);
+    instance.to_local = instance.to_world.Inverse();
+
+    instance_bounds.push_back(Geometry::TransformBox(instance.to_world.matrix, model->Bounds()));
+  }
+
+  _bvh = BoundingVolumeHierarchy(instance_bounds);
+
+  LogDebugF(LCodeZones::FILE_IO, "Built map object locator of %d instances, %d unique models."
+            , _instances.size(), _models.size());
+}
+
+std::uint32_t MapObjectLocator::Locate(C3Vector const& position, MapObjectLocation& location) const
+{
+  std::uint32_t result = MapObjectModel::NO_GROUP;
+
+  if (_bvh.IsEmpty())
+    return result;
+
+  _bvh.QueryBox({position, position}, [&](std::uint32_t instance_index) -> bool
+  {
+    MapObjectInstance const& instance = _instances[instance_index];
+    MapObjectModel const& model = *_models[instance.model];
+
+    // placement coordinates are y-up, the local up vector keeps floor distances in placement units
+    float floor_distance;
+    std::uint32_t const group = model.LocateGroup(instance.to_local.TransformPoint(position)
+                                                  , instance.to_local.TransformVector({0.f, 1.f, 0.f})
+                                                  , floor_distance);
+
+    if (group == MapObjectModel::NO_GROUP || (location.inside && floor_distance >= location.floor_distance))
+      return false;
+
+    MapObjectGroup const& group_data = model.Groups()[group];
+
+    location.inside = true;
+    location.unique_id = instance.unique_id;
+    location.root_id = model.RootId();
+    location.name_set = instance.name_set;
+    location.group = group;
+    location.group_id = group_data.group_id;
+    location.flags = group_data.flags;
+    location.floor_distance = floor_distance;
+
+    result = instance_index;
+    return false;
+  });
+
+  return result;
+}
+
+MapObjectLocation MapObjectLocator::Locate(C3Vector const& position) const
+{
+  MapObjectLocation location {};
+  Locate(position, location);
+  return location;
+}
+
+std::vector<MapObjectLocation> MapObjectLocator::Locate(std::vector<C3Vector> const& positions
+                                                        , unsigned n_threads) const
+{
+  std::vector<MapObjectLocation> locations(positions.size());
+
+  Utils::Misc::ParallelFor((positions.size() + QUERY_BATCH_SIZE - 1) / QUERY_BATCH_SIZE, [&](std::size_t batch)
+  {
+    std::size_t const end = std::min(positions.size(), (batch + 1) * QUERY_BATCH_SIZE);
+
+    for (std::size_t i = batch * QUERY_BATCH_SIZE; i < end; ++i)
+      Locate(positions[i], locations[i]);
+  }, n_threads);
+
+  return locations;
+}
+
+std::vector<std::uint32_t> MapObjectLocator::VisibleGroups(C3Vector const& position) const
+{
+  MapObjectLocation location {};
+  std::uint32_t const instance_index = Locate(position, location);
+
+  if (instance_index == MapObjectModel::NO_GROUP)
+    return {};
+
+  MapObjectInstance const& instance = _instances[instance_index];
+  return _models[instance.model]->VisibleGroups(location.group, instance.to_local.TransformPoint(position));
+}
+
+bool MapObjectLocator::SeesOutside(std::uint32_t instance_index
+                                   , MapObjectLocation const& location
+                                   , C3Vector const& position) const
+{
+  if (instance_index == MapObjectModel::NO_GROUP || (location.flags & GROUP_EXTERIOR))
+    return true;
+
+  MapObjectInstance const& instance = _instances[instance_index];
+  MapObjectModel const& model = *_models[instance.model];
+
+  std::vector<std::uint32_t> const visible = model.VisibleGroups(location.group
+                                                                 , instance.to_local.TransformPoint(position));
+
+  return std::any_of(visible.begin(), visible.end(), [&](std::uint32_t group)
+                     { return model.Groups()[group].flags & GROUP_EXTERIOR; });
+}
+
+bool MapObjectLocator::IsVisible(C3Vector const& from, C3Vector const& to) const
+{
+  MapObjectLocation from_location {};
+  MapObjectLocation to_location {};
+  std::uint32_t const from_instance = Locate(from, from_location);
+  std::uint32_t const to_instance = Locate(to, to_location);
+
+  if (from_instance != MapObjectModel::NO_GROUP && from_instance == to_instance)
+  {
+    MapObjectInstance const& instance = _instances[from_instance];
+    std::vector<std::uint32_t> const visible = _models[instance.model]->VisibleGroups(
+      from_location.group, instance.to_local.TransformPoint(from));
+
+    return std::binary_search(visible.begin(), visible.end(), to_location.group);
+  }
+
+  return SeesOutside(from_instance, from_location, from) && SeesOutside(to_instance, to_location, to);
+}
@@ -0,0 +1,296 @@
+#pragma once
+#include <IO/ByteBuffer.hpp>
+#include <IO/CommonDataStructures.hpp>
+#include <IO/CommonGeometry.hpp>
+#include <IO/ADT/DataStructures.hpp>
+#include <IO/ADT/TileData.hpp>
+#include <IO/Collision/BoundingVolumeHierarchy.hpp>
+#include <IO/Collision/MeshCollider.hpp>
+#include <IO/Collision/TileCollision.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace IO::Collision
+{
+  /**
+   * Group flags (MOGP) relevant to location queries.
+   */
+  enum MapObjectGroupFlags : std::uint32_t
+  {
+    GROUP_EXTERIOR = 0x8, ///> Outdoor part of a map object, e.g. a courtyard or a ruin without roof.
+    GROUP_INTERIOR = 0x2000 ///> Indoor part of a map object. Blocks mounting, selects indoor ambience.
+  };
+
+  /**
+   * Header of one map object group, as stored in MOGP.
+   */
+  struct MapObjectGroup
+  {
+    Common::DataStructures::CAaBox bounds; ///> Bounding box, model space.
+    std::uint32_t flags; ///> MapObjectGroupFlags and others.
+    std::uint32_t group_id; ///> Key of WMOAreaTable, together with MapObjectLocation::root_id and name_set.
+    std::uint16_t portal_start; ///> First portal reference (MOPR) of the group.
+    std::uint16_t portal_count; ///> Number of portal references of the group.
+  };
+
+  /**
+   * Portal between two groups (MOPT, MOPV).
+   */
+  struct MapObjectPortal
+  {
+    std::vector<Common::DataStructures::C3Vector> vertices; ///> Convex polygon, model space.
+    Common::DataStructures::C3Vector normal; ///> Normal of the portal plane. The plane passes through vertices.
+  };
+
+  /**
+   * Reference of a group to one of its portals (MOPR).
+   */
+  struct MapObjectPortalRef
+  {
+    std::uint16_t portal; ///> Index of the portal.
+    std::uint16_t group; ///> Index of the group on the other side of the portal.
+    std::int16_t side; ///> Side of the portal plane the referencing group is on: 1 in front of the normal, -1 behind.
+    std::uint16_t _unused;
+  };
+
+  static_assert(sizeof(MapObjectPortalRef) == 8);
+
+  /**
+   * Data of one map object (WMO) needed for location queries, collected from its root and group files.
+   */
+  struct MapObjectDefinition
+  {
+    std::uint32_t root_id = 0; ///> WMO ID (MOHD).
+    std::vector<MapObjectGroup> groups;
+    std::vector<CollisionMesh> meshes; ///> Collision geometry of each group (MOVT, MOVI), in the order of groups.
+    std::vector<MapObjectPortal> portals;
+    std::vector<MapObjectPortalRef> portal_refs;
+  };
+
+  /**
+   * Acceleration data of one map object. Built once per file and shared by all of its placements.
+   *
+   * A hierarchy over group bounding boxes selects candidate groups of a point, a hierarchy over the collision
+   * geometry of each group then finds the floor below and the ceiling above it, which stands in for the BSP
+   * tree (MOBN, MOBR) the client walks. Visibility between groups is found by clipping portal polygons against
+   * the view frustum narrowed by each portal passed, starting from the viewer.
+   *
+   * Instances are immutable once built, so queries are safe from any number of threads.
+   */
+  class MapObjectModel
+  {
+  public:
+    /**
+     * Returned when a point is not inside any group.
+     */
+    static constexpr std::uint32_t NO_GROUP = std::numeric_limits<std::uint32_t>::max();
+
+    /**
+     * Maximum number of portals passed from the group of the viewer.
+     */
+    static constexpr unsigned MAX_PORTAL_DEPTH = 16;
+
+    MapObjectModel() = default;
+
+    /**
+     * Builds acceleration data of a map object.
+     * @param definition Groups, collision geometry and portals of the map object.
+     */
+    explicit MapObjectModel(MapObjectDefinition const& definition);
+
+    /**
+     * Finds the group containing a point. A point is inside a group if it is within its bounds and above its floor.
+     * Interior groups additionally require a ceiling above the point, so that roofs do not count as inside.
+     * Of several such groups, the one with the closest floor wins.
+     * @param point Point in model space.
+     * @param up Up direction in model space. Not required to be normalized, distances are measured in its units.
+     * @param floor_distance Receives the distance to the floor below the point, if a group is found.
+     * @return Index of the group, or NO_GROUP.
+     */
+    [[nodiscard]]
+    std::uint32_t LocateGroup(Common::DataStructures::C3Vector const& point
+                              , Common::DataStructures::C3Vector const& up
+                              , float& floor_distance) const;
+
+    /**
+     * Finds groups visible from a point through portals.
+     * @param group Group containing the viewer, as returned by LocateGroup().
+     * @param eye Position of the viewer in model space.
+     * @return Indices of visible groups, including the group of the viewer, ascending.
+     */
+    [[nodiscard]]
+    std::vector<std::uint32_t> VisibleGroups(std::uint32_t group, Common::DataStructures::C3Vector const& eye) const;
+
+    [[nodiscard]]
+    std::uint32_t RootId() const { return _root_id; };
+
+    [[nodiscard]]
+    std::vector<MapObjectGroup> const& Groups() const { return _groups; };
+
+    [[nodiscard]]
+    bool IsEmpty() const { return _bvh.IsEmpty(); };
+
+    /**
+     * Returns bounds of all groups. Must not be called on an empty map object.
+     */
+    [[nodiscard]]
+    Common::DataStructures::CAaBox const& Bounds() const { return _bvh.Bounds(); };
+
+    /**
+     * Reads acceleration data written by Write(), so it does not need to be rebuilt from source files.
+     * @param buf Buffer to read from.
+     */
+    void Read(Common::ByteBuffer const& buf);
+
+    /**
+     * Writes acceleration data, including hierarchies, into a buffer.
+     * @param buf Buffer to write to.
+     */
+    void Write(Common::ByteBuffer& buf) const;
+
+  private:
+    struct PortalData
+    {
+      Common::Geometry::Plane plane;
+      std::uint32_t first_vertex; ///> Index of the first vertex in _portal_vertices.
+      std::uint32_t n_vertices;
+    };
+
+    void TraversePortals(std::uint32_t group
+                         , Common::DataStructures::C3Vector const& eye
+                         , std::vector<Common::Geometry::Plane> const& frustum
+                         , unsigned depth
+                         , std::vector<std::uint8_t>& visible) const;
+
+    std::uint32_t _root_id = 0;
+    std::vector<MapObjectGroup> _groups;
+    std::vector<MeshCollider> _colliders;
+    std::vector<PortalData> _portals;
+    std::vector<Common::DataStructures::C3Vector> _portal_vertices;
+    std::vector<MapObjectPortalRef> _portal_refs;
+    BoundingVolumeHierarchy _bvh;
+  };
+
+  /**
+   * Result of a location query against placed map objects.
+   */
+  struct MapObjectLocation
+  {
+    bool inside = false; ///> Position is inside a group of a placed map object.
+    std::uint32_t unique_id = 0; ///> Unique ID of the placement (MODF).
+    std::uint32_t root_id = 0; ///> WMO ID of the map object (MOHD).
+    std::uint16_t name_set = 0; ///> Name set of the placement (MODF).
+    std::uint32_t group = MapObjectModel::NO_GROUP; ///> Index of the group in the map object.
+    std::uint32_t group_id = 0; ///> Group ID (MOGP).
+    std::uint32_t flags = 0; ///> Group flags (MOGP).
+    float floor_distance = 0.f; ///> Distance to the floor of the group below the position.
+
+    [[nodiscard]]
+    bool IsIndoor() const { return inside && (flags & GROUP_INTERIOR) && !(flags & GROUP_EXTERIOR); };
+  };
+
+  /**
+   * Location and visibility queries against map objects placed on one map tile, e.g. to block mounting indoors
+   * or to look up WMOAreaTable entries of a position.
+   * A top-level hierarchy over placement bounds selects placements, queries are then transformed into model space
+   * of each placement and answered by its MapObjectModel. Models are shared between placements.
+   * Batched queries are spread over worker threads rather than vectorized: each one descends its own path through
+   * the hierarchies, which leaves no uniform loop for the batch kernels of Common::Geometry.
+   *
+   * Instances are immutable once built, so queries are safe from any number of threads.
+   */
+  class MapObjectLocator
+  {
+  public:
+    /**
+     * Provides the model of a map object, or nullptr if it is not available.
+     * Must match signature: std::shared_ptr<MapObjectModel const>(ADT::AssetReference const& asset).
+     * asset is the file of the placement, resolved through the tile's table or by FileDataID, as flagged by it.
+     * Returning the same pointer for the same map object lets placements share a model.
+     */
+    using ModelProvider = std::function<std::shared_ptr<MapObjectModel const>(ADT::AssetReference const&)>;
+
+    MapObjectLocator() = default;
+
+    /**
+     * Instantiates models for map object placements of a tile.
+     * @param placements Placements (MODF) and map object table of the tile.
+     * @param model_provider Model provider.
+     */
+    MapObjectLocator(ADT::TilePlacements const& placements, ModelProvider const& model_provider);
+
+    /**
+     * Finds the placed map object group containing a position.
+     * Where placements overlap, the group with the closest floor below the position wins.
+     * @param position Position in placement coordinates.
+     * @return Location.
+     */
+    [[nodiscard]]
+    MapObjectLocation Locate(Common::DataStructures::C3Vector const& position) const;
+
+    /**
+     * Finds the placed map object group containing each position, in parallel.
+     * @param positions Positions in placement coordinates.
+     * @param n_threads Number of worker threads. 0 means hardware concurrency.
+     * @return Location of each position, in the same order.
+     */
+    [[nodiscard]]
+    std::vector<MapObjectLocation> Locate(std::vector<Common::DataStructures::C3Vector> const& positions
+                                          , unsigned n_threads = 0) const;
+
+    /**
+     * Finds groups visible through portals from a position inside a placed map object.
+     * @param position Position of the viewer in placement coordinates.
+     * @return Indices of visible groups of the map object containing the position, empty if outside.
+     */
+    [[nodiscard]]
+    std::vector<std::uint32_t> VisibleGroups(Common::DataStructures::C3Vector const& position) const;
+
+    /**
+     * Tests whether portals allow seeing from one position to another. Terrain and other geometry are not tested.
+     * Within one placement, the group of the target must be visible from the viewer. Otherwise, the sight line
+     * leaves through the outside: each position inside a map object must see one of its exterior groups.
+     * Positions outside of all map objects always pass.
+     * @param from Position of the viewer in placement coordinates.
+     * @param to Position of the target in placement coordinates.
+     * @return True if visible.
+     */
+    [[nodiscard]]
+    bool IsVisible(Common::DataStructures::C3Vector const& from, Common::DataStructures::C3Vector const& to) const;
+
+    [[nodiscard]]
+    std::size_t NumInstances() const { return _instances.size(); };
+
+    [[nodiscard]]
+    std::size_t NumModels() const { return _models.size(); };
+
+  private:
+    struct MapObjectInstance
+    {
+      std::uint32_t model; ///> Index of the model in the tile.
+      std::uint32_t unique_id;
+      std::uint16_t name_set;
+      Transform to_world;
+      Transform to_local;
+    };
+
+    /**
+     * @return Index of the instance containing the position, or MapObjectModel::NO_GROUP.
+     */
+    std::uint32_t Locate(Common::DataStructures::C3Vector const& position, MapObjectLocation& location) const;
+
+    /**
+     * @return True if an exterior group of the instance is visible from the position.
+     */
+    bool SeesOutside(std::uint32_t instance, MapObjectLocation const& location
+                     , Common::DataStructures::C3Vector const& position) const;
+
+    std::vector<std::shared_ptr<MapObjectModel const>> _models;
+    std::vector<MapObjectInstance> _instances;
+    BoundingVolumeHierarchy _bvh;
+  };
+}
@@ -0,0 +1,191 @@
+#include <IO/Collision/MeshCollider.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+using namespace IO::Collision;
+using namespace IO::Common;
+
+namespace
+{
+  using IO::Common::DataStructures::CAaBox;
+  using IO::Common::DataStructures::C3Vector;
+
+  C3Vector Sub(C3Vector const& a, C3Vector const& b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+  C3Vector Cross(C3Vector const& a, C3Vector const& b)
+  {
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+  }
+  float Dot(C3Vector const& a, C3Vector const& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+  /**
+   * Moller-Trumbore ray-triangle intersection.
+   * @return Distance along the ray, or a negative value on miss.
+   */
+  float IntersectTriangle(C3Vector const& origin, C3Vector const& direction
+                          , C3Vector const& v0, C3Vector const& v1, C3Vector const& v2)
+  {
+    C3Vector const e1 = Sub(v1, v0);
+    C3Vector const e2 = Sub(v2, v0);
+    C3Vector const p = Cross(direction, e2);
+    float const det = Dot(e1, p);
+
+    if (det == 0.f)
+      return -1.f;
+
+    float const inv_det = 1.f / det;
+    C3Vector const s = Sub(origin, v0);
+    float const u = Dot(s, p) * inv_det;
+
+    if (u < 0.f || u > 1.f)
+      return -1.f;
+
+    C3Vector const q = Cross(s, e1);
+    float const v = Dot(direction, q) * inv_det;
+
+    if (v < 0.f || u + v > 1.f)
+      return -1.f;
+
+    return Dot(e2, q) * inv_det;
+  }
+
+  /**
+   * Separating axis test of a triangle against an axis-aligned box (Akenine-Moller).
+   */
+  bool TriangleOverlapsBox(C3Vector const& a, C3Vector const& b, C3Vector const& c, CAaBox const& box)
+  {
+    C3Vector const center {(box.min.x + box.max.x) / 2.f, (box.min.y + box.max.y) / 2.f, (box.min.z + box.max.z) / 2.f};
+    C3Vector const half {(box.max.x - box.min.x) / 2.f, (box.max.y - box.min.y) / 2.f, (box.max.z - box.min.z) / 2.f};
+
+    std::array<C3Vector, 3> const v {Sub(a, center), Sub(b, center), Sub(c, center)};
+    std::array<C3Vector, 3> const e {Sub(v[1], v[0]), Sub(v[2], v[1]), Sub(v[0], v[2])};
+
+    auto separated_on = [&](C3Vector const& axis) -> bool
+    {
+      float const p0 = Dot(v[0], axis);
+      float const p1 = Dot(v[1], axis);
+      float const p2 = Dot(v[2], axis);
+      float const r = half.x * std::abs(axis.x) + half.y * std::abs(axis.y) + half.z * std::abs(axis.z);
+
+      return std::min({p0, p1, p2}) > r || std::max({p0, p1, p2}) < -r;
+    };
+
+    // box face normals
+    if (separated_on({1.f, 0.f, 0.f}) || separated_on({0.f, 1.f, 0.f}) || separated_on({0.f, 0.f, 1.f}))
+      return false;
+
+    // triangle normal
+    if (separated_on(Cross(e[0], e[1])))
+      return false;
+
+    // cross products of edges
+    std::array<C3Vector, 3> const box_axes {C3Vector{1.f, 0.f, 0.f}, C3Vector{0.f, 1.f, 0.f}, C3Vector{0.f, 0.f, 1.f}};
+
+    for (C3Vector const& box_axis : box_axes)
+    {
+      for (C3Vector const& edge : e)
+      {
+        if (separated_on(Cross(box_axis, edge)))
+          return false;
+      }
+    }
+
+    return true;
+  }
+}
+
+MeshCollider::MeshCollider(CollisionMesh mesh)
+: _mesh(std::move(mesh))
+{
+  RequireF(CCodeZones::FILE_IO, _mesh.indices.size() % 3 == 0, "Collision mesh must consist of triangles.");
+  RequireF(CCodeZones::FILE_IO, std::all_of(_mesh.indices.begin(), _mesh.indices.end()
+                                            , [this](std::uint32_t index) { return index < _mesh.vertices.size(); })
+           , "Collision mesh references non-existing vertices.");
+
+  std::vector<CAaBox> triangle_bounds;
+  triangle_bounds.reserve(_mesh.indices.size() / 3);
+
+  for (std::size_t i = 0; i < _mesh.indices.size(); i += 3)
+  {
+    C3Vector const& a = _mesh.vertices[_mesh.indices[i]];
+    C3Vector const& b = _mesh.vertices[_mesh.indices[i + 1]];
+    C3Vector const& c = _mesh.vertices[_mesh.indices[i + 2]];
+
+    triangle_bounds.push_back({{std::min({a.x, b.x, c.x}), std::min({a.y, b.y, c.y}), std::min({a.z, b.z, c.z})}
+                               , {std::max({a.x, b.x, c.x}), std::max({a.y, b.y, c.y}), std::max({a.z, b.z, c.z})}});
+  }
+
+  _bvh = BoundingVolumeHierarchy(triangle_bounds);
+}
+
+bool MeshCollider::Raycast(C3Vector const& origin, C3Vector const& direction, float t_min, float& t_max) const
+{
+  bool is_hit = false;
+
+  _bvh.QueryRay(origin, direction, t_min, t_max, [&](std::uint32_t triangle, float t_closest) -> float
+  {
+    std::uint32_t const* indices = &_mesh.indices[triangle * 3];
+    float const t = IntersectTriangle(origin, direction, _mesh.vertices[indices[0]], _mesh.vertices[indices[1]]
+                                      , _mesh.vertices[indices[2]]);
+
+    if (t < t_min || t > t_closest)
+      return t_closest;
+
+    is_hit = true;
+    t_max = t;
+    return t;
+  });
+
+  return is_hit;
+}
+
+bool MeshCollider::Overlaps(CAaBox const& box) const
+{
+  bool overlaps = false;
+
+  _bvh.QueryBox(box, [&](std::uint32_t triangle) -> bool
+  {
+    std::uint32_t const* indices = &_mesh.indices[triangle * 3];
+    overlaps = TriangleOverlapsBox(_mesh.vertices[indices[0]], _mesh.vertices[indices[1]]
+                                   , _mesh.vertices[indices[2]], box);
+    return overlaps;
+  });
+
+  return overlaps;
+}
+
+void MeshCollider::Read(ByteBuffer const& buf)
+{
+  _mesh.vertices.resize(buf.Read<std::uint32_t>());
+  buf.Read(_mesh.vertices.begin(), _mesh.vertices.end());
+
+  _mesh.indices.resize(buf.Read<std::uint32_t>());
+  buf.Read(_mesh.indices.begin(), _mesh.indices.end());
+
+  EnsureF(CCodeZones::FILE_IO, _mesh.indices.size() % 3 == 0
+                               && std::all_of(_mesh.indices.begin(), _mesh.indices.end()
+                                              , [this](std::uint32_t index) { return index < _mesh.vertices.size(); })
+          , "Corrupted collision mesh.");
+
+  _bvh.Read(buf);
+
+  EnsureF(CCodeZones::FILE_IO, _bvh.PrimitiveOrder().size() == _mesh.indices.size() / 3
+                               && std::all_of(_bvh.PrimitiveOrder().begin(), _bvh.PrimitiveOrder().end()
+                                              , [this](std::uint32_t triangle)
+                                                { return triangle < _mesh.indices.size() / 3; })
+          , "Collision mesh hierarchy does not match the mesh.");
+}
+
+void MeshCollider::Write(ByteBuffer& buf) const
+{
+  buf.Write(static_cast<std::uint32_t>(_mesh.vertices.size()));
+  buf.Write(_mesh.vertices.begin(), _mesh.vertices.end());
+
+  buf.Write(static_cast<std::uint32_t>(_mesh.indices.size()));
+  buf.Write(_mesh.indices.begin(), _mesh.indices.end());
+
+  _bvh.Write(buf);
+}
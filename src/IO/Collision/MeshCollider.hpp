@@ -0,0 +1,84 @@
+#pragma once
+#include <IO/ByteBuffer.hpp>
+#include <IO/CommonDataStructures.hpp>
+#include <IO/Collision/BoundingVolumeHierarchy.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace IO::Collision
+{
+  /**
+   * Indexed triangle list used for collision, in model space of the file it comes from
+   * (WMO group or M2 collision geometry, z is up).
+   */
+  struct CollisionMesh
+  {
+    std::vector<Common::DataStructures::C3Vector> vertices;
+    std::vector<std::uint32_t> indices; ///> Three indices per triangle.
+  };
+
+  /**
+   * Collision mesh with a bounding volume hierarchy over its triangles.
+   */
+  class MeshCollider
+  {
+  public:
+    MeshCollider() = default;
+
+    /**
+     * Builds the hierarchy over triangles of a mesh.
+     * @param mesh Collision mesh.
+     */
+    explicit MeshCollider(CollisionMesh mesh);
+
+    /**
+     * Finds the closest triangle crossed by a ray.
+     * @param origin Ray origin.
+     * @param direction Ray direction. Not required to be normalized, distances are measured in its units.
+     * @param t_min Minimal distance along the ray.
+     * @param t_max Maximal distance along the ray. Set to the distance of the hit if one is found.
+     * @return True if ray hits the mesh within [t_min, t_max].
+     */
+    bool Raycast(Common::DataStructures::C3Vector const& origin
+                 , Common::DataStructures::C3Vector const& direction
+                 , float t_min
+                 , float& t_max) const;
+
+    /**
+     * Tests whether any triangle of the mesh overlaps a box.
+     * @param box Box in model space.
+     * @return True on overlap.
+     */
+    [[nodiscard]]
+    bool Overlaps(Common::DataStructures::CAaBox const& box) const;
+
+    [[nodiscard]]
+    bool IsEmpty() const { return _bvh.IsEmpty(); };
+
+    /**
+     * Returns bounds of the mesh. Must not be called on an empty mesh.
+     */
+    [[nodiscard]]
+    Common::DataStructures::CAaBox const& Bounds() const { return _bvh.Bounds(); };
+
+    [[nodiscard]]
+    CollisionMesh const& Mesh() const { return _mesh; };
+
+    /**
+     * Reads the mesh and its hierarchy written by Write() at the current position of the buffer.
+     * @param buf Buffer to read from.
+     */
+    void Read(Common::ByteBuffer const& buf);
+
+    /**
+     * Writes the mesh and its hierarchy into a buffer.
+     * @param buf Buffer to write to.
+     */
+    void Write(Common::ByteBuffer& buf) const;
+
+  private:
+    CollisionMesh _mesh;
+    BoundingVolumeHierarchy _bvh;
+  };
+}
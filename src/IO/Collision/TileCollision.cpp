@@ -0,0 +1,303 @@
+#include <IO/Collision/TileCollision.hpp>
+#include <IO/Common.hpp>
+#include <IO/CommonGeometry.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <unordered_map>
+
+using namespace IO::Collision;
+using namespace IO::Common;
+
+namespace
+{
+  using IO::Common::DataStructures::CAaBox;
+  using IO::Common::DataStructures::C3Vector;
+
+  using Matrix3 = std::array<float, 9>;
+
+  constexpr std::uint32_t CACHE_MAGIC = IO::Common::FourCC<"TCOL">;
+  constexpr std::uint32_t CACHE_VERSION = 1;
+
+  // number of queries claimed by a worker at once
+  constexpr std::size_t QUERY_BATCH_SIZE = 64;
+
+  Matrix3 Multiply(Matrix3 const& a, Matrix3 const& b)
+  {
+    Matrix3 result {};
+
+    for (unsigned row = 0; row < 3; ++row)
+    {
+      for (unsigned col = 0; col < 3; ++col)
+      {
+        for (unsigned i = 0; i < 3; ++i)
+          result[row * 3 + col] += a[row * 3 + i] * b[i * 3 + col];
+      }
+    }
+
+    return result;
+  }
+
+  Matrix3 RotationX(float radians)
+  {
+    float const c = std::cos(radians);
+    float const s = std::sin(radians);
+    return {1.f, 0.f, 0.f, 0.f, c, -s, 0.f, s, c};
+  }
+
+  Matrix3 RotationY(float radians)
+  {
+    float const c = std::cos(radians);
+    float const s = std::sin(radians);
+    return {c, 0.f, s, 0.f, 1.f, 0.f, -s, 0.f, c};
+  }
+
+  Matrix3 RotationZ(float radians)
+  {
+    float const c = std::cos(radians);
+    float const s = std::sin(radians);
+    return {c, -s, 0.f, s, c, 0.f, 0.f, 0.f, 1.f};
+  }
+
+  float ToRadians(float degrees)
+  {
+    return degrees * std::numbers::pi_v<float> / 180.f;
+  }
+}
+
+C3Vector Transform::TransformPoint(C3Vector const& point) const
+{
+  C3Vector const result = TransformVector(point);
+  return {result.x + matrix[3], result.y + matrix[7], result.z + matrix[11]};
+}
+
+C3Vector Transform::TransformVector(C3Vector const& vector) const
+{
+  return {matrix[0] * vector.x + matrix[1] * vector.y + matrix[2] * vector.z
+          , matrix[4] * vector.x + matrix[5] * vector.y + matrix[6] * vector.z
+          , matrix[8] * vector.x + matrix[9] * vector.y + matrix[10] * vector.z};
+}
+
+Transform Transform::Inverse() const
+{
+  float const a = matrix[0], b = matrix[1], c = matrix[2];
+  float const d = matrix[4], e = matrix[5], f = matrix[6];
+  float const g = matrix[8], h = matrix[9], i = matrix[10];
+
+  float const det = a * (e * i - f * h) - b * (d * i - f * g) + c * (d * h - e * g);
+  RequireF(CCodeZones::FILE_IO, det != 0.f, "Transform is not invertible.");
+  float const inv_det = 1.f / det;
+
+  Transform inverse {{(e * i - f * h) * inv_det, (c * h - b * i) * inv_det, (b * f - c * e) * inv_det, 0.f
+                      , (f * g - d * i) * inv_det, (a * i - c * g) * inv_det, (c * d - a * f) * inv_det, 0.f
+                      , (d * h - e * g) * inv_det, (b * g - a * h) * inv_det, (a * e - b * d) * inv_det, 0.f}};
+
+  C3Vector const translation = inverse.TransformVector({matrix[3], matrix[7], matrix[11]});
+  inverse.matrix[3] = -translation.x;
+  inverse.matrix[7] = -translation.y;
+  inverse.matrix[11] = -translation.z;
+
+  return inverse;
+}
+
+TileCollision::TileCollision(ADT::TilePlacements const& placements, MeshProvider const& mesh_provider)
+{
+  // mesh pointer to its index in _meshes
+  std::unordered_map<MeshCollider const*, std::uint32_t> mesh_indices;
+
+  auto add_placement = [&](bool is_map_object, ADT::AssetReference const& asset, std::uint32_t unique_id
+                           , Transform const& to_world)
+  {
+    std::shared_ptr<MeshCollider const> mesh = mesh_provider(is_map_object, asset);
+
+    if (!mesh || mesh->IsEmpty())
+      return;
+
+    auto [it, is_new] = mesh_indices.try_emplace(mesh.get(), static_cast<std::uint32_t>(_meshes.size()));
+
+    if (is_new)
+      _meshes.push_back(mesh);
+
+    CollisionInstance& instance = _instances.emplace_back();
+    instance.mesh = it->second;
+    instance.unique_id = unique_id;
+    instance.to_world = to_world;
+    instance.to_local = to_world.Inverse();
+    instance.bounds = Geometry::TransformBox(to_world.matrix, mesh->Bounds());
+  };
+
+  for (auto const& placement : placements.model_placements)
+  {
+    add_placement(false, placements.ModelAsset(placement), placement.unique_id
+                  , PlacementTransform(placement.position, placement.rotation
+                                       , static_cast<float>(placement.scale) / 1024.f));
+  }
+
+  for (auto const& placement : placements.map_object_placements)
+  {
+    // scale of map objects is only used since Legion, and only if flagged
+    float const scale = placement.flags.has_scale ? static_cast<float>(placement.scale) / 1024.f : 1.f;
+    add_placement(true, placements.MapObjectAsset(placement), placement.unique_id
+                  , PlacementTransform(placement.position, placement.rotation, scale));
+  }
+
+  std::vector<CAaBox> instance_bounds;
+  instance_bounds.reserve(_instances.size());
+
+  for (CollisionInstance const& instance : _instances)
+    instance_bounds.push_back(instance.bounds);
+
+  _bvh = BoundingVolumeHierarchy(instance_bounds);
+
+  LogDebugF(LCodeZones::FILE_IO, "Built tile collision of %d instances, %d unique meshes."
+            , _instances.size(), _meshes.size());
+}
+
+Transform TileCollision::PlacementTransform(C3Vector const& position, C3Vector const& rotation, float scale)
+{
+  // files are z-up, placement coordinates are y-up: (x, y, z) -> (x, z, -y)
+  constexpr Matrix3 axis_swap {1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, -1.f, 0.f};
+
+  // the client applies placement rotation in Y-Z-X order, with yaw offset by 90 degrees
+  Matrix3 const rotation_matrix = Multiply(Multiply(RotationY(ToRadians(rotation.y - 90.f))
+                                                    , RotationZ(ToRadians(rotation.x)))
+                                           , RotationX(ToRadians(-rotation.z)));
+
+  Matrix3 linear = Multiply(rotation_matrix, axis_swap);
+  std::transform(linear.begin(), linear.end(), linear.begin(), [scale](float value) { return value * scale; });
+
+  return {{linear[0], linear[1], linear[2], position.x
+           , linear[3], linear[4], linear[5], position.y
+           , linear[6], linear[7], linear[8], position.z}};
+}
+
+CollisionHit TileCollision::Raycast(CollisionSegment const& segment) const
+{
+  C3Vector const delta {segment.to.x - segment.from.x, segment.to.y - segment.from.y, segment.to.z - segment.from.z};
+
+  CollisionHit result {};
+
+  // affine transforms preserve the segment parameter, so distances of all instances are comparable
+  _bvh.QueryRay(segment.from, delta, 0.f, 1.f, [&](std::uint32_t instance_index, float t_max) -> float
+  {
+    CollisionInstance const& instance = _instances[instance_index];
+
+    C3Vector const local_origin = instance.to_local.TransformPoint(segment.from);
+    C3Vector const local_direction = instance.to_local.TransformVector(delta);
+
+    if (!_meshes[instance.mesh]->Raycast(local_origin, local_direction, 0.f, t_max))
+      return t_max;
+
+    result.hit = true;
+    result.t = t_max;
+    result.unique_id = instance.unique_id;
+    return t_max;
+  });
+
+  if (result.hit)
+  {
+    result.position = {segment.from.x + delta.x * result.t, segment.from.y + delta.y * result.t
+                       , segment.from.z + delta.z * result.t};
+  }
+
+  return result;
+}
+
+bool TileCollision::Overlaps(CAaBox const& box) const
+{
+  bool overlaps = false;
+
+  _bvh.QueryBox(box, [&](std::uint32_t instance_index) -> bool
+  {
+    CollisionInstance const& instance = _instances[instance_index];
+
+    // conservative: the box is enlarged by rotation into model space
+    overlaps = _meshes[instance.mesh]->Overlaps(Geometry::TransformBox(instance.to_local.matrix, box));
+    return overlaps;
+  });
+
+  return overlaps;
+}
+
+std::vector<CollisionHit> TileCollision::Raycast(std::vector<CollisionSegment> const& segments
+                                                 , unsigned n_threads) const
+{
+  std::vector<CollisionHit> hits(segments.size());
+
+  Utils::Misc::ParallelFor((segments.size() + QUERY_BATCH_SIZE - 1) / QUERY_BATCH_SIZE, [&](std::size_t batch)
+  {
+    std::size_t const end = std::min(segments.size(), (batch + 1) * QUERY_BATCH_SIZE);
+
+    for (std::size_t i = batch * QUERY_BATCH_SIZE; i < end; ++i)
+      hits[i] = Raycast(segments[i]);
+  }, n_threads);
+
+  return hits;
+}
+
+std::vector<bool> TileCollision::Overlaps(std::vector<CAaBox> const& boxes, unsigned n_threads) const
+{
+  // std::vector<bool> is not safe for concurrent writes of distinct elements
+  std::vector<std::uint8_t> overlaps(boxes.size());
+
+  Utils::Misc::ParallelFor((boxes.size() + QUERY_BATCH_SIZE - 1) / QUERY_BATCH_SIZE, [&](std::size_t batch)
+  {
+    std::size_t const end = std::min(boxes.size(), (batch + 1) * QUERY_BATCH_SIZE);
+
+    for (std::size_t i = batch * QUERY_BATCH_SIZE; i < end; ++i)
+      overlaps[i] = Overlaps(boxes[i]);
+  }, n_threads);
+
+  return {overlaps.begin(), overlaps.end()};
+}
+
+void TileCollision::Read(ByteBuffer const& buf)
+{
+  EnsureF(CCodeZones::FILE_IO, buf.Read<std::uint32_t>() == CACHE_MAGIC, "Not a tile collision cache.");
+  EnsureF(CCodeZones::FILE_IO, buf.Read<std::uint32_t>() == CACHE_VERSION, "Unsupported tile collision cache version.");
+
+  _meshes.resize(buf.Read<std::uint32_t>());
+
+  for (auto& mesh : _meshes)
+  {
+    auto new_mesh = std::make_shared<MeshCollider>();
+    new_mesh->Read(buf);
+    mesh = std::move(new_mesh);
+  }
+
+  _instances.resize(buf.Read<std::uint32_t>());
+  buf.Read(_instances.begin(), _instances.end());
+
+  EnsureF(CCodeZones::FILE_IO, std::all_of(_instances.begin(), _instances.end()
+                                           , [this](CollisionInstance const& instance)
+                                             { return instance.mesh < _meshes.size(); })
+          , "Collision instance references non-existing mesh.");
+
+  _bvh.Read(buf);
+
+  EnsureF(CCodeZones::FILE_IO, _bvh.PrimitiveOrder().size() == _instances.size()
+                               && std::all_of(_bvh.PrimitiveOrder().begin(), _bvh.PrimitiveOrder().end()
+                                              , [this](std::uint32_t instance) { return instance < _instances.size(); })
+          , "Tile collision hierarchy does not match its instances.");
+}
+
+void TileCollision::Write(ByteBuffer& buf) const
+{
+  buf.Write(CACHE_MAGIC);
+  buf.Write(CACHE_VERSION);
+
+  buf.Write(static_cast<std::uint32_t>(_meshes.size()));
+
+  for (auto const& mesh : _meshes)
+    mesh->Write(buf);
+
+  buf.Write(static_cast<std::uint32_t>(_instances.size()));
+  buf.Write(_instances.begin(), _instances.end());
+
+  _bvh.Write(buf);
+}
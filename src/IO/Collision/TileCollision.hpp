@@ -0,0 +1,160 @@
+#pragma once
+#include <IO/ByteBuffer.hpp>
+#include <IO/CommonDataStructures.hpp>
+#include <IO/ADT/DataStructures.hpp>
+#include <IO/ADT/TileData.hpp>
+#include <IO/Collision/BoundingVolumeHierarchy.hpp>
+#include <IO/Collision/MeshCollider.hpp>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace IO::Collision
+{
+  /**
+   * Affine transform stored as a row-major 3x4 matrix.
+   */
+  struct Transform
+  {
+    std::array<float, 12> matrix;
+
+    [[nodiscard]]
+    Common::DataStructures::C3Vector TransformPoint(Common::DataStructures::C3Vector const& point) const;
+
+    [[nodiscard]]
+    Common::DataStructures::C3Vector TransformVector(Common::DataStructures::C3Vector const& vector) const;
+
+    [[nodiscard]]
+    Transform Inverse() const;
+  };
+
+  /**
+   * Placed collision mesh.
+   */
+  struct CollisionInstance
+  {
+    std::uint32_t mesh; ///> Index of the mesh in the tile.
+    std::uint32_t unique_id; ///> Unique ID of the placement (MDDF, MODF).
+    Transform to_world; ///> Model space of the file to placement coordinates.
+    Transform to_local; ///> Inverse of to_world.
+    Common::DataStructures::CAaBox bounds; ///> Bounds in placement coordinates.
+  };
+
+  /**
+   * Line segment in placement coordinates (x and z are horizontal, relative to the map corner, y is up).
+   */
+  struct CollisionSegment
+  {
+    Common::DataStructures::C3Vector from;
+    Common::DataStructures::C3Vector to;
+  };
+
+  /**
+   * Result of a segment query against placed objects.
+   */
+  struct CollisionHit
+  {
+    bool hit = false; ///> Segment intersects an object.
+    float t = 1.f; ///> Position of the first intersection along the segment, [0, 1].
+    Common::DataStructures::C3Vector position {}; ///> Point of the first intersection.
+    std::uint32_t unique_id = 0; ///> Unique ID of the placement hit.
+  };
+
+  /**
+   * Collision geometry of all objects (WMOs, M2s) placed on one map tile.
+   * A top-level hierarchy over instance bounds selects instances, queries are then transformed into model space
+   * of each instance and answered by the hierarchy of its mesh. Meshes are shared between instances.
+   */
+  class TileCollision
+  {
+  public:
+    /**
+     * Provides the collision mesh of a model or map object, or nullptr if it has no collision.
+     * Must match signature: std::shared_ptr<MeshCollider const>(bool is_map_object, ADT::AssetReference const& asset).
+     * asset is the file of the placement, resolved through the tile's tables or by FileDataID, as flagged by it.
+     * Returning the same pointer for the same model lets instances share a mesh.
+     */
+    using MeshProvider = std::function<std::shared_ptr<MeshCollider const>(bool, ADT::AssetReference const&)>;
+
+    TileCollision() = default;
+
+    /**
+     * Instantiates collision meshes for placements of a tile.
+     * @param placements Placements (MDDF, MODF) and file tables of the tile.
+     * @param mesh_provider Collision mesh provider.
+     */
+    TileCollision(ADT::TilePlacements const& placements, MeshProvider const& mesh_provider);
+
+    /**
+     * Builds the transform from model space of a file to placement coordinates.
+     * @param position Placement position.
+     * @param rotation Placement rotation in degrees, as stored in MDDF / MODF.
+     * @param scale Placement scale, 1.0 being the original size.
+     * @return Transform.
+     */
+    [[nodiscard]]
+    static Transform PlacementTransform(Common::DataStructures::C3Vector const& position
+                                        , Common::DataStructures::C3Vector const& rotation
+                                        , float scale);
+
+    /**
+     * Finds the first intersection of a segment with placed objects.
+     * @param segment Segment to test.
+     * @return Hit.
+     */
+    [[nodiscard]]
+    CollisionHit Raycast(CollisionSegment const& segment) const;
+
+    /**
+     * Tests whether a box overlaps geometry of any placed object.
+     * @param box Box in placement coordinates.
+     * @return True on overlap.
+     */
+    [[nodiscard]]
+    bool Overlaps(Common::DataStructures::CAaBox const& box) const;
+
+    /**
+     * Finds the first intersection of each segment with placed objects, in parallel.
+     * @param segments Segments to test.
+     * @param n_threads Number of worker threads. 0 means hardware concurrency.
+     * @return Hit for each segment, in the same order.
+     */
+    [[nodiscard]]
+    std::vector<CollisionHit> Raycast(std::vector<CollisionSegment> const& segments, unsigned n_threads = 0) const;
+
+    /**
+     * Tests each box for overlap with placed objects, in parallel.
+     * @param boxes Boxes in placement coordinates.
+     * @param n_threads Number of worker threads. 0 means hardware concurrency.
+     * @return True for each overlapping box, in the same order.
+     */
+    [[nodiscard]]
+    std::vector<bool> Overlaps(std::vector<Common::DataStructures::CAaBox> const& boxes, unsigned n_threads = 0) const;
+
+    [[nodiscard]]
+    std::size_t NumInstances() const { return _instances.size(); };
+
+    [[nodiscard]]
+    std::size_t NumMeshes() const { return _meshes.size(); };
+
+    /**
+     * Reads collision data written by Write(), so it does not need to be rebuilt from source files.
+     * @param buf Buffer to read from.
+     */
+    void Read(Common::ByteBuffer const& buf);
+
+    /**
+     * Writes collision data, including hierarchies, into a buffer.
+     * @param buf Buffer to write to.
+     */
+    void Write(Common::ByteBuffer& buf) const;
+
+  private:
+    std::vector<std::shared_ptr<MeshCollider const>> _meshes;
+    std::vector<CollisionInstance> _instances;
+    BoundingVolumeHierarchy _bvh;
+  };
+}
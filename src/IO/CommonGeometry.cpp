@@ -0,0 +1,257 @@
+#include <IO/CommonGeometry.hpp>
+#include <IO/CommonGeometryKernels.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <atomic>
+
+using namespace IO::Common;
+using namespace IO::Common::Geometry;
+using namespace IO::Common::Geometry::Kernels;
+using namespace IO::Common::DataStructures;
+
+namespace
+{
+  constexpr std::size_t N_INSTRUCTION_SETS = static_cast<std::size_t>(InstructionSet::NEON) + 1;
+
+  /**
+   * Applies a single-element function to every element.
+   */
+  template<typename In, typename Out, typename Function>
+  void Map(In const* in, Out* out, std::size_t n, Function&& function)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      out[i] = function(in[i]);
+  }
+
+  KernelTable const SCALAR_KERNELS
+  {
+    .transform_points = [](Matrix34 const& matrix, C3Vector const* points, C3Vector* out, std::size_t n)
+    {
+      Map(points, out, n, [&](C3Vector const& point) { return TransformPoint(matrix, point); });
+    },
+    .transform_boxes = [](Matrix34 const& matrix, CAaBox const* boxes, CAaBox* out, std::size_t n)
+    {
+      Map(boxes, out, n, [&](CAaBox const& box) { return TransformBox(matrix, box); });
+    },
+    .merge_boxes = [](CAaBox const* boxes, std::size_t n)
+    {
+      CAaBox result = EMPTY_BOX;
+
+      for (std::size_t i = 0; i < n; ++i)
+        result = MergeBox(result, boxes[i]);
+
+      return result;
+    },
+    .intersect_boxes = [](CAaBox const& clip, CAaBox const* boxes, CAaBox* out, std::size_t n)
+    {
+      Map(boxes, out, n, [&](CAaBox const& box) { return IntersectBox(clip, box); });
+    },
+    .contains_points = [](CAaBox const& box, C3Vector const* points, std::uint8_t* out, std::size_t n)
+    {
+      Map(points, out, n, [&](C3Vector const& point) { return static_cast<std::uint8_t>(Contains(box, point)); });
+    },
+    .classify_boxes = [](Frustum const& frustum, CAaBox const* boxes, Containment* out, std::size_t n)
+    {
+      Map(boxes, out, n, [&](CAaBox const& box) { return Classify(frustum, box); });
+    },
+    .classify_spheres = [](Frustum const& frustum, CAaSphere const* spheres, Containment* out, std::size_t n)
+    {
+      Map(spheres, out, n, [&](CAaSphere const& sphere) { return Classify(frustum, sphere); });
+    },
+    .placement_to_world = [](C3Vector const* points, C3Vector* out, std::size_t n)
+    {
+      Map(points, out, n, [](C3Vector const& point) { return PlacementToWorld(point); });
+    },
+    .world_to_placement = [](C3Vector const* points, C3Vector* out, std::size_t n)
+    {
+      Map(points, out, n, [](C3Vector const& point) { return WorldToPlacement(point); });
+    },
+    .tile_indices_at = [](C3Vector const* points, TileIndex* out, std::size_t n)
+    {
+      Map(points, out, n, [](C3Vector const& point) { return TileIndexAt(point); });
+    },
+    .chunk_indices_at = [](C3Vector const* points, std::uint16_t* out, std::size_t n)
+    {
+      Map(points, out, n, [](C3Vector const& point) { return ChunkIndexAt(point); });
+    },
+    .height_range = [](C3Vector const* points, std::size_t n)
+    {
+      CRange range {std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity()};
+
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        range.min = std::min(range.min, points[i].y);
+        range.max = std::max(range.max, points[i].y);
+      }
+
+      return range;
+    }
+  };
+
+  /**
+   * Kernel table and support of each instruction set, built once.
+   */
+  struct Dispatch
+  {
+    std::array<KernelTable, N_INSTRUCTION_SETS> tables;
+    std::array<bool, N_INSTRUCTION_SETS> supported {};
+    std::atomic<KernelTable const*> active;
+
+    Dispatch()
+    {
+      tables.fill(SCALAR_KERNELS);
+      supported[static_cast<std::size_t>(InstructionSet::SCALAR)] = true;
+      InstructionSet best = InstructionSet::SCALAR;
+
+#if defined(GEOMETRY_SIMD_X86)
+      // every x86 set extends the table of the one before
+      void (* const loaders[])(KernelTable&) = {LoadKernelsSSE2, LoadKernelsSSE41, LoadKernelsAVX2};
+      InstructionSet const x86_sets[] = {InstructionSet::SSE2, InstructionSet::SSE41, InstructionSet::AVX2};
+      KernelTable table = SCALAR_KERNELS;
+
+      for (std::size_t i = 0; i < std::size(x86_sets) && IsSupportedX86(x86_sets[i]); ++i)
+      {
+        loaders[i](table);
+        tables[static_cast<std::size_t>(x86_sets[i])] = table;
+        supported[static_cast<std::size_t>(x86_sets[i])] = true;
+        best = x86_sets[i];
+      }
+#elif defined(GEOMETRY_SIMD_NEON)
+      LoadKernelsNEON(tables[static_cast<std::size_t>(InstructionSet::NEON)]);
+      supported[static_cast<std::size_t>(InstructionSet::NEON)] = true;
+      best = InstructionSet::NEON;
+#endif
+
+      active = &tables[static_cast<std::size_t>(best)];
+    }
+  };
+
+  Dispatch& GetDispatch()
+  {
+    static Dispatch dispatch;
+    return dispatch;
+  }
+
+  KernelTable const& ActiveKernels()
+  {
+    return *GetDispatch().active.load(std::memory_order_relaxed);
+  }
+
+  template<typename In, typename Out>
+  void RequireOutput(std::span<In const> in, std::span<Out> out)
+  {
+    RequireF(CCodeZones::FILE_IO, out.size() >= in.size(), "Output span is too small.");
+  }
+
+  std::size_t CountVisible(std::span<Containment const> out)
+  {
+    std::size_t n_visible = 0;
+
+    for (Containment const containment : out)
+      n_visible += containment != Containment::OUTSIDE;
+
+    return n_visible;
+  }
+}
+
+bool Geometry::IsSupported(InstructionSet instruction_set)
+{
+  std::size_t const index = static_cast<std::size_t>(instruction_set);
+  return index < N_INSTRUCTION_SETS && GetDispatch().supported[index];
+}
+
+InstructionSet Geometry::ActiveInstructionSet()
+{
+  Dispatch const& dispatch = GetDispatch();
+  return static_cast<InstructionSet>(dispatch.active.load(std::memory_order_relaxed) - dispatch.tables.data());
+}
+
+void Geometry::SetInstructionSet(InstructionSet instruction_set)
+{
+  RequireF(CCodeZones::FILE_IO, IsSupported(instruction_set), "Instruction set is not supported by this CPU.");
+
+  Dispatch& dispatch = GetDispatch();
+  dispatch.active.store(&dispatch.tables[static_cast<std::size_t>(instruction_set)], std::memory_order_relaxed);
+}
+
+void Geometry::TransformPoints(Matrix34 const& matrix, std::span<C3Vector const> points, std::span<C3Vector> out)
+{
+  RequireOutput(points, out);
+  ActiveKernels().transform_points(matrix, points.data(), out.data(), points.size());
+}
+
+void Geometry::TransformBoxes(Matrix34 const& matrix, std::span<CAaBox const> boxes, std::span<CAaBox> out)
+{
+  RequireOutput(boxes, out);
+  ActiveKernels().transform_boxes(matrix, boxes.data(), out.data(), boxes.size());
+}
+
+CAaBox Geometry::MergeBoxes(std::span<CAaBox const> boxes)
+{
+  return ActiveKernels().merge_boxes(boxes.data(), boxes.size());
+}
+
+void Geometry::IntersectBoxes(CAaBox const& clip, std::span<CAaBox const> boxes, std::span<CAaBox> out)
+{
+  RequireOutput(boxes, out);
+  ActiveKernels().intersect_boxes(clip, boxes.data(), out.data(), boxes.size());
+}
+
+std::size_t Geometry::ContainsPoints(CAaBox const& box, std::span<C3Vector const> points, std::span<std::uint8_t> out)
+{
+  RequireOutput(points, out);
+  ActiveKernels().contains_points(box, points.data(), out.data(), points.size());
+
+  std::size_t n_inside = 0;
+
+  for (std::size_t i = 0; i < points.size(); ++i)
+    n_inside += out[i];
+
+  return n_inside;
+}
+
+std::size_t Geometry::ClassifyBoxes(Frustum const& frustum, std::span<CAaBox const> boxes, std::span<Containment> out)
+{
+  RequireOutput(boxes, out);
+  ActiveKernels().classify_boxes(frustum, boxes.data(), out.data(), boxes.size());
+  return CountVisible(out.first(boxes.size()));
+}
+
+std::size_t Geometry::ClassifySpheres(Frustum const& frustum
+                                      , std::span<CAaSphere const> spheres
+                                      , std::span<Containment> out)
+{
+  RequireOutput(spheres, out);
+  ActiveKernels().classify_spheres(frustum, spheres.data(), out.data(), spheres.size());
+  return CountVisible(out.first(spheres.size()));
+}
+
+void Geometry::PlacementToWorld(std::span<C3Vector const> points, std::span<C3Vector> out)
+{
+  RequireOutput(points, out);
+  ActiveKernels().placement_to_world(points.data(), out.data(), points.size());
+}
+
+void Geometry::WorldToPlacement(std::span<C3Vector const> points, std::span<C3Vector> out)
+{
+  RequireOutput(points, out);
+  ActiveKernels().world_to_placement(points.data(), out.data(), points.size());
+}
+
+void Geometry::TileIndicesAt(std::span<C3Vector const> points, std::span<TileIndex> out)
+{
+  RequireOutput(points, out);
+  ActiveKernels().tile_indices_at(points.data(), out.data(), points.size());
+}
+
+void Geometry::ChunkIndicesAt(std::span<C3Vector const> points, std::span<std::uint16_t> out)
+{
+  RequireOutput(points, out);
+  ActiveKernels().chunk_indices_at(points.data(), out.data(), points.size());
+}
+
+CRange Geometry::HeightRange(std::span<C3Vector const> points)
+{
+  return ActiveKernels().height_range(points.data(), points.size());
+}
@@ -0,0 +1,318 @@
+#pragma once
+#include <IO/CommonDataStructures.hpp>
+#include <IO/WorldConstants.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+/**
+ * Geometry on common data structures, as single-element functions and batch kernels over spans.
+ *
+ * Batch kernels have SSE2, SSE4.1 and AVX2 paths on x86 and NEON paths on AArch64, selected at runtime by what
+ * the CPU supports. Every path returns results identical bit for bit to the single-element functions, other than
+ * the payload of NaNs. This holds as long as multiply-adds are not fused. The build turns fusion off for the kernel
+ * sources only, callers comparing against the inline functions need to do the same.
+ *
+ * Coordinates are placement coordinates (MDDF, MODF): x and z are horizontal and grow with tile indices, y is up.
+ */
+namespace IO::Common::Geometry
+{
+  /**
+   * Affine transform as a row-major 3x4 matrix, same layout as IO::Collision::Transform.
+   */
+  using Matrix34 = std::array<float, 12>;
+
+  /**
+   * Plane of points p satisfying dot(normal, p) + distance = 0. Positive side is inside.
+   */
+  struct Plane
+  {
+    DataStructures::C3Vector normal;
+    float distance;
+  };
+
+  /**
+   * Frustum given by inward facing planes.
+   */
+  using Frustum = std::array<Plane, 6>;
+
+  enum class Containment : std::uint8_t
+  {
+    OUTSIDE = 0, ///> Fully outside of at least one plane.
+    INTERSECTS = 1, ///> Possibly crossing the boundary, conservative.
+    INSIDE = 2 ///> Fully inside of all planes.
+  };
+
+  /**
+   * Coordinate of the map center along horizontal axes, where world and placement coordinates meet.
+   */
+  constexpr float MAP_HALFSIZE = 32.f * WorldConstants::TILE_SIZE;
+
+  /**
+   * Box containing nothing, identity of MergeBox().
+   */
+  constexpr DataStructures::CAaBox EMPTY_BOX {{std::numeric_limits<float>::infinity()
+                                                , std::numeric_limits<float>::infinity()
+                                                , std::numeric_limits<float>::infinity()}
+                                               , {-std::numeric_limits<float>::infinity()
+                                                  , -std::numeric_limits<float>::infinity()
+                                                  , -std::numeric_limits<float>::infinity()}};
+
+  [[nodiscard]]
+  inline DataStructures::C3Vector TransformPoint(Matrix34 const& matrix, DataStructures::C3Vector const& point)
+  {
+    return {matrix[0] * point.x + matrix[1] * point.y + matrix[2] * point.z + matrix[3]
+            , matrix[4] * point.x + matrix[5] * point.y + matrix[6] * point.z + matrix[7]
+            , matrix[8] * point.x + matrix[9] * point.y + matrix[10] * point.z + matrix[11]};
+  }
+
+  /**
+   * Transforms a box, producing the tightest box around the transformed one.
+   */
+  [[nodiscard]]
+  inline DataStructures::CAaBox TransformBox(Matrix34 const& matrix, DataStructures::CAaBox const& box)
+  {
+    DataStructures::CAaBox result;
+    float* const out_min = &result.min.x;
+    float* const out_max = &result.max.x;
+
+    for (unsigned row = 0; row < 3; ++row)
+    {
+      float const* m = matrix.data() + row * 4;
+
+      // every matrix entry scales one axis, its extremes come from the box extremes of that axis
+      float const x0 = m[0] * box.min.x, x1 = m[0] * box.max.x;
+      float const y0 = m[1] * box.min.y, y1 = m[1] * box.max.y;
+      float const z0 = m[2] * box.min.z, z1 = m[2] * box.max.z;
+
+      out_min[row] = std::min(x0, x1) + std::min(y0, y1) + std::min(z0, z1) + m[3];
+      out_max[row] = std::max(x0, x1) + std::max(y0, y1) + std::max(z0, z1) + m[3];
+    }
+
+    return result;
+  }
+
+  [[nodiscard]]
+  inline DataStructures::CAaBox MergeBox(DataStructures::CAaBox const& a, DataStructures::CAaBox const& b)
+  {
+    return {{std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y), std::min(a.min.z, b.min.z)}
+            , {std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y), std::max(a.max.z, b.max.z)}};
+  }
+
+  /**
+   * Intersects two boxes. If they do not overlap, the result has min > max along some axis.
+   */
+  [[nodiscard]]
+  inline DataStructures::CAaBox IntersectBox(DataStructures::CAaBox const& a, DataStructures::CAaBox const& b)
+  {
+    return {{std::max(a.min.x, b.min.x), std::max(a.min.y, b.min.y), std::max(a.min.z, b.min.z)}
+            , {std::min(a.max.x, b.max.x), std::min(a.max.y, b.max.y), std::min(a.max.z, b.max.z)}};
+  }
+
+  [[nodiscard]]
+  inline bool IsEmpty(DataStructures::CAaBox const& box)
+  {
+    // negated comparison also treats NaN as empty
+    return !(box.min.x <= box.max.x && box.min.y <= box.max.y && box.min.z <= box.max.z);
+  }
+
+  /**
+   * @return True if the point is inside the box or on its boundary.
+   */
+  [[nodiscard]]
+  inline bool Contains(DataStructures::CAaBox const& box, DataStructures::C3Vector const& point)
+  {
+    return (box.min.x <= point.x) & (point.x <= box.max.x)
+      & (box.min.y <= point.y) & (point.y <= box.max.y)
+      & (box.min.z <= point.z) & (point.z <= box.max.z);
+  }
+
+  [[nodiscard]]
+  inline Containment Classify(Frustum const& frustum, DataStructures::CAaBox const& box)
+  {
+    bool outside = false;
+    bool inside = true;
+
+    for (Plane const& plane : frustum)
+    {
+      // box corners farthest along and against the plane normal
+      float const min_distance = plane.normal.x * (plane.normal.x < 0.f ? box.max.x : box.min.x)
+        + plane.normal.y * (plane.normal.y < 0.f ? box.max.y : box.min.y)
+        + plane.normal.z * (plane.normal.z < 0.f ? box.max.z : box.min.z) + plane.distance;
+      float const max_distance = plane.normal.x * (plane.normal.x < 0.f ? box.min.x : box.max.x)
+        + plane.normal.y * (plane.normal.y < 0.f ? box.min.y : box.max.y)
+        + plane.normal.z * (plane.normal.z < 0.f ? box.min.z : box.max.z) + plane.distance;
+
+      outside |= max_distance < 0.f;
+      inside &= min_distance >= 0.f;
+    }
+
+    return outside ? Containment::OUTSIDE : inside ? Containment::INSIDE : Containment::INTERSECTS;
+  }
+
+  [[nodiscard]]
+  inline Containment Classify(Frustum const& frustum, DataStructures::CAaSphere const& sphere)
+  {
+    bool outside = false;
+    bool inside = true;
+
+    for (Plane const& plane : frustum)
+    {
+      float const distance = plane.normal.x * sphere.position.x + plane.normal.y * sphere.position.y
+        + plane.normal.z * sphere.position.z + plane.distance;
+
+      outside |= distance < -sphere.radius;
+      inside &= distance >= sphere.radius;
+    }
+
+    return outside ? Containment::OUTSIDE : inside ? Containment::INSIDE : Containment::INTERSECTS;
+  }
+
+  /**
+   * Converts placement coordinates to world (server, client) coordinates, where x points north, y west and z up.
+   */
+  [[nodiscard]]
+  inline DataStructures::C3Vector PlacementToWorld(DataStructures::C3Vector const& point)
+  {
+    return {MAP_HALFSIZE - point.z, MAP_HALFSIZE - point.x, point.y};
+  }
+
+  [[nodiscard]]
+  inline DataStructures::C3Vector WorldToPlacement(DataStructures::C3Vector const& point)
+  {
+    return {MAP_HALFSIZE - point.y, point.z, MAP_HALFSIZE - point.x};
+  }
+
+  /**
+   * Grid cell containing a coordinate, clamped to [0, last_cell]. NaN maps to 0.
+   */
+  [[nodiscard]]
+  inline unsigned CellAt(float coordinate, float cell_size, float last_cell)
+  {
+    // argument order makes NaN fall through both comparisons to 0
+    return static_cast<unsigned>(std::max(0.f, std::min(std::floor(coordinate / cell_size), last_cell)));
+  }
+
+  /**
+   * Tile containing a point, clamped to the map.
+   */
+  [[nodiscard]]
+  inline DataStructures::TileIndex TileIndexAt(DataStructures::C3Vector const& point)
+  {
+    return {static_cast<std::uint16_t>(CellAt(point.x, WorldConstants::TILE_SIZE, 63.f))
+            , static_cast<std::uint16_t>(CellAt(point.z, WorldConstants::TILE_SIZE, 63.f))};
+  }
+
+  /**
+   * Chunk containing a point, as index into the chunks of the tile given by TileIndexAt() (y * 16 + x).
+   */
+  [[nodiscard]]
+  inline std::uint16_t ChunkIndexAt(DataStructures::C3Vector const& point)
+  {
+    DataStructures::TileIndex const tile_index = TileIndexAt(point);
+
+    // relative to the tile origin, so that tile and chunk agree on borders
+    unsigned const x = CellAt(point.x - tile_index.x * WorldConstants::TILE_SIZE, WorldConstants::CHUNK_SIZE, 15.f);
+    unsigned const y = CellAt(point.z - tile_index.y * WorldConstants::TILE_SIZE, WorldConstants::CHUNK_SIZE, 15.f);
+
+    return static_cast<std::uint16_t>(y * 16 + x);
+  }
+
+  /**
+   * Instruction sets of batch kernels.
+   */
+  enum class InstructionSet : std::uint8_t
+  {
+    SCALAR = 0, ///> Single-element functions, always available.
+    SSE2 = 1,
+    SSE41 = 2, ///> SSE4.1, adds rounding for tile and chunk lookups.
+    AVX2 = 3,
+    NEON = 4 ///> AArch64 only.
+  };
+
+  /**
+   * @return True if batch kernels can run with an instruction set on this CPU.
+   */
+  [[nodiscard]]
+  bool IsSupported(InstructionSet instruction_set);
+
+  /**
+   * @return Instruction set used by batch kernels. Defaults to the best one supported.
+   */
+  [[nodiscard]]
+  InstructionSet ActiveInstructionSet();
+
+  /**
+   * Selects the instruction set used by batch kernels, e.g. to compare paths. Must be supported.
+   * Calls already running keep the previous one. Kernels outside of this header are switched by
+   * Utils::Misc::SIMD::SetEnabled() instead.
+   */
+  void SetInstructionSet(InstructionSet instruction_set);
+
+  /**
+   * Batch kernels. Output spans must be at least as large as input spans, input and output may alias exactly.
+   */
+
+  void TransformPoints(Matrix34 const& matrix
+                       , std::span<DataStructures::C3Vector const> points
+                       , std::span<DataStructures::C3Vector> out);
+
+  void TransformBoxes(Matrix34 const& matrix
+                      , std::span<DataStructures::CAaBox const> boxes
+                      , std::span<DataStructures::CAaBox> out);
+
+  /**
+   * @return Union of all boxes, EMPTY_BOX if there are none.
+   */
+  [[nodiscard]]
+  DataStructures::CAaBox MergeBoxes(std::span<DataStructures::CAaBox const> boxes);
+
+  /**
+   * Intersects every box with a clip box.
+   */
+  void IntersectBoxes(DataStructures::CAaBox const& clip
+                      , std::span<DataStructures::CAaBox const> boxes
+                      , std::span<DataStructures::CAaBox> out);
+
+  /**
+   * Tests points against a box.
+   * @return Number of points inside.
+   */
+  std::size_t ContainsPoints(DataStructures::CAaBox const& box
+                             , std::span<DataStructures::C3Vector const> points
+                             , std::span<std::uint8_t> out);
+
+  /**
+   * Classifies boxes against a frustum.
+   * @return Number of boxes not outside.
+   */
+  std::size_t ClassifyBoxes(Frustum const& frustum
+                            , std::span<DataStructures::CAaBox const> boxes
+                            , std::span<Containment> out);
+
+  /**
+   * Classifies spheres against a frustum.
+   * @return Number of spheres not outside.
+   */
+  std::size_t ClassifySpheres(Frustum const& frustum
+                              , std::span<DataStructures::CAaSphere const> spheres
+                              , std::span<Containment> out);
+
+  void PlacementToWorld(std::span<DataStructures::C3Vector const> points, std::span<DataStructures::C3Vector> out);
+
+  void WorldToPlacement(std::span<DataStructures::C3Vector const> points, std::span<DataStructures::C3Vector> out);
+
+  void TileIndicesAt(std::span<DataStructures::C3Vector const> points, std::span<DataStructures::TileIndex> out);
+
+  void ChunkIndicesAt(std::span<DataStructures::C3Vector const> points, std::span<std::uint16_t> out);
+
+  /**
+   * @return Range of heights (y) of the points, {+inf, -inf} if there are none.
+   */
+  [[nodiscard]]
+  DataStructures::CRange HeightRange(std::span<DataStructures::C3Vector const> points);
+}
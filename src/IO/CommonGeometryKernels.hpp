@@ -0,0 +1,122 @@
+#pragma once
+#include <IO/CommonGeometry.hpp>
+
+#include <cstddef>
+
+/**
+ * Internal to the batch kernels of IO/CommonGeometry, not part of the public interface.
+ *
+ * Every instruction set fills the entries of a kernel table it has a path for. Tables start out as scalar
+ * kernels and are overridden by each supported instruction set in ascending order, so entries without a path
+ * of their own fall back to the best lower one.
+ */
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  define GEOMETRY_SIMD_X86
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define GEOMETRY_SIMD_NEON
+#endif
+
+namespace IO::Common::Geometry::Kernels
+{
+  /**
+   * Batch kernels over raw arrays of n elements. Sizes are validated by the public functions.
+   */
+  struct KernelTable
+  {
+    void (*transform_points)(Matrix34 const& matrix
+                             , DataStructures::C3Vector const* points
+                             , DataStructures::C3Vector* out
+                             , std::size_t n);
+
+    void (*transform_boxes)(Matrix34 const& matrix
+                            , DataStructures::CAaBox const* boxes
+                            , DataStructures::CAaBox* out
+                            , std::size_t n);
+
+    DataStructures::CAaBox (*merge_boxes)(DataStructures::CAaBox const* boxes, std::size_t n);
+
+    void (*intersect_boxes)(DataStructures::CAaBox const& clip
+                            , DataStructures::CAaBox const* boxes
+                            , DataStructures::CAaBox* out
+                            , std::size_t n);
+
+    void (*contains_points)(DataStructures::CAaBox const& box
+                            , DataStructures::C3Vector const* points
+                            , std::uint8_t* out
+                            , std::size_t n);
+
+    void (*classify_boxes)(Frustum const& frustum
+                           , DataStructures::CAaBox const* boxes
+                           , Containment* out
+                           , std::size_t n);
+
+    void (*classify_spheres)(Frustum const& frustum
+                             , DataStructures::CAaSphere const* spheres
+                             , Containment* out
+                             , std::size_t n);
+
+    void (*placement_to_world)(DataStructures::C3Vector const* points, DataStructures::C3Vector* out, std::size_t n);
+
+    void (*world_to_placement)(DataStructures::C3Vector const* points, DataStructures::C3Vector* out, std::size_t n);
+
+    void (*tile_indices_at)(DataStructures::C3Vector const* points, DataStructures::TileIndex* out, std::size_t n);
+
+    void (*chunk_indices_at)(DataStructures::C3Vector const* points, std::uint16_t* out, std::size_t n);
+
+    DataStructures::CRange (*height_range)(DataStructures::C3Vector const* points, std::size_t n);
+  };
+
+  static_assert(sizeof(DataStructures::C3Vector) == 3 * sizeof(float));
+  static_assert(sizeof(DataStructures::CAaBox) == 6 * sizeof(float));
+  static_assert(sizeof(DataStructures::CAaSphere) == 4 * sizeof(float));
+  static_assert(sizeof(DataStructures::TileIndex) == sizeof(std::uint32_t));
+  static_assert(sizeof(Containment) == 1);
+
+  /**
+   * Minima and maxima reduced over several lanes agree with a sequential scan except for the sign of zero:
+   * the scan keeps the first of equal values, which for zeros is the first one met. Restores it.
+   */
+  inline DataStructures::CRange RestoreZeroSigns(DataStructures::CRange range
+                                                 , DataStructures::C3Vector const* points
+                                                 , std::size_t n)
+  {
+    if (range.min != 0.f && range.max != 0.f)
+      return range;
+
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      if (points[i].y == 0.f)
+      {
+        // a zero minimum means no negative heights, so the scan settles on the first zero, likewise for maxima
+        if (range.min == 0.f)
+          range.min = points[i].y;
+
+        if (range.max == 0.f)
+          range.max = points[i].y;
+
+        break;
+      }
+    }
+
+    return range;
+  }
+
+#if defined(GEOMETRY_SIMD_X86)
+  /**
+   * @return True if the CPU and the operating system support the instruction set. Only x86 sets are reported.
+   */
+  [[nodiscard]]
+  bool IsSupportedX86(InstructionSet instruction_set);
+
+  void LoadKernelsSSE2(KernelTable& table);
+
+  void LoadKernelsSSE41(KernelTable& table);
+
+  void LoadKernelsAVX2(KernelTable& table);
+#endif
+
+#if defined(GEOMETRY_SIMD_NEON)
+  void LoadKernelsNEON(KernelTable& table);
+#endif
+}
@@ -0,0 +1,420 @@
+#include <IO/CommonGeometryKernels.hpp>
+
+#if defined(GEOMETRY_SIMD_NEON)
+
+#include <arm_neon.h>
+
+/**
+ * NEON paths of the batch kernels, AArch64 only (division and directed rounding are not available on 32-bit ARM).
+ *
+ * Results match the single-element functions bit for bit:
+ *  - sums are evaluated in the same order and never fused;
+ *  - vminq_f32 / vmaxq_f32 propagate NaN and order signed zeros, unlike std::min / std::max, so minima and maxima
+ *    are selected by comparison instead, see Min() and Max();
+ *  - reductions across lanes restore the sign of zero, see RestoreZeroSigns().
+ */
+
+using namespace IO::Common;
+using namespace IO::Common::Geometry;
+using namespace IO::Common::DataStructures;
+
+namespace
+{
+  /**
+   * a < b ? a : b, so std::min(a, b) is Min(b, a).
+   */
+  inline float32x4_t Min(float32x4_t a, float32x4_t b)
+  {
+    return vbslq_f32(vcltq_f32(a, b), a, b);
+  }
+
+  /**
+   * a > b ? a : b, so std::max(a, b) is Max(b, a).
+   */
+  inline float32x4_t Max(float32x4_t a, float32x4_t b)
+  {
+    return vbslq_f32(vcgtq_f32(a, b), a, b);
+  }
+
+  inline float32x4_t Dot(float32x4_t nx, float32x4_t ny, float32x4_t nz, float32x4_t d
+                         , float32x4_t x, float32x4_t y, float32x4_t z)
+  {
+    return vaddq_f32(vaddq_f32(vaddq_f32(vmulq_f32(nx, x), vmulq_f32(ny, y)), vmulq_f32(nz, z)), d);
+  }
+
+  inline float32x4x3_t Load4(C3Vector const* points)
+  {
+    return vld3q_f32(reinterpret_cast<float const*>(points));
+  }
+
+  inline void Store4(C3Vector* points, float32x4_t x, float32x4_t y, float32x4_t z)
+  {
+    vst3q_f32(reinterpret_cast<float*>(points), float32x4x3_t {{x, y, z}});
+  }
+
+  /**
+   * Transposes 4 boxes into min x, y, z and max x, y, z. Each pair of boxes loads as 4 vectors (min, max, min, max).
+   */
+  inline void Load4(CAaBox const* boxes, float32x4_t (&v)[6])
+  {
+    float32x4x3_t const lo = vld3q_f32(reinterpret_cast<float const*>(boxes));
+    float32x4x3_t const hi = vld3q_f32(reinterpret_cast<float const*>(boxes + 2));
+
+    for (unsigned k = 0; k < 3; ++k)
+    {
+      v[k] = vuzp1q_f32(lo.val[k], hi.val[k]);
+      v[k + 3] = vuzp2q_f32(lo.val[k], hi.val[k]);
+    }
+  }
+
+  inline void Store4(CAaBox* boxes, float32x4_t const (&v)[6])
+  {
+    float32x4x3_t lo;
+    float32x4x3_t hi;
+
+    for (unsigned k = 0; k < 3; ++k)
+    {
+      lo.val[k] = vzip1q_f32(v[k], v[k + 3]);
+      hi.val[k] = vzip2q_f32(v[k], v[k + 3]);
+    }
+
+    vst3q_f32(reinterpret_cast<float*>(boxes), lo);
+    vst3q_f32(reinterpret_cast<float*>(boxes + 2), hi);
+  }
+
+  inline void StoreContainment(uint32x4_t outside, uint32x4_t inside, Containment* out)
+  {
+    std::uint32_t outside_lanes[4];
+    std::uint32_t inside_lanes[4];
+    vst1q_u32(outside_lanes, outside);
+    vst1q_u32(inside_lanes, inside);
+
+    for (unsigned lane = 0; lane < 4; ++lane)
+    {
+      unsigned const is_outside = outside_lanes[lane] & 1;
+      unsigned const is_inside = inside_lanes[lane] & 1;
+      out[lane] = static_cast<Containment>((1 - is_outside) * (1 + is_inside));
+    }
+  }
+
+  inline uint32x4_t CellAt(float32x4_t coordinate, float32x4_t cell_size, float32x4_t last_cell)
+  {
+    float32x4_t const cell = vrndmq_f32(vdivq_f32(coordinate, cell_size));
+    return vcvtq_u32_f32(Max(Min(last_cell, cell), vdupq_n_f32(0.f)));
+  }
+
+  void TransformPointsNEON(Matrix34 const& matrix, C3Vector const* points, C3Vector* out, std::size_t n)
+  {
+    float32x4_t m[12];
+
+    for (unsigned i = 0; i < 12; ++i)
+      m[i] = vdupq_n_f32(matrix[i]);
+
+    std::size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+      float32x4x3_t const v = Load4(points + i);
+      Store4(out + i, Dot(m[0], m[1], m[2], m[3], v.val[0], v.val[1], v.val[2])
+             , Dot(m[4], m[5], m[6], m[7], v.val[0], v.val[1], v.val[2])
+             , Dot(m[8], m[9], m[10], m[11], v.val[0], v.val[1], v.val[2]));
+    }
+
+    for (; i < n; ++i)
+      out[i] = TransformPoint(matrix, points[i]);
+  }
+
+  void TransformBoxesNEON(Matrix34 const& matrix, CAaBox const* boxes, CAaBox* out, std::size_t n)
+  {
+    std::size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+      float32x4_t v[6];
+      Load4(boxes + i, v);
+
+      float32x4_t result[6];
+
+      for (unsigned row = 0; row < 3; ++row)
+      {
+        float const* m = matrix.data() + row * 4;
+
+        float32x4_t const mt = vdupq_n_f32(m[3]);
+        float32x4_t const x0 = vmulq_n_f32(v[0], m[0]), x1 = vmulq_n_f32(v[3], m[0]);
+        float32x4_t const y0 = vmulq_n_f32(v[1], m[1]), y1 = vmulq_n_f32(v[4], m[1]);
+        float32x4_t const z0 = vmulq_n_f32(v[2], m[2]), z1 = vmulq_n_f32(v[5], m[2]);
+
+        result[row] = vaddq_f32(vaddq_f32(vaddq_f32(Min(x1, x0), Min(y1, y0)), Min(z1, z0)), mt);
+        result[row + 3] = vaddq_f32(vaddq_f32(vaddq_f32(Max(x1, x0), Max(y1, y0)), Max(z1, z0)), mt);
+      }
+
+      Store4(out + i, result);
+    }
+
+    for (; i < n; ++i)
+      out[i] = TransformBox(matrix, boxes[i]);
+  }
+
+  CAaBox MergeBoxesNEON(CAaBox const* boxes, std::size_t n)
+  {
+    // one box per step, min and max parts in lanes 0-2 and 1-3, so boxes merge in the same order as the scan
+    float32x4_t min = vdupq_n_f32(std::numeric_limits<float>::infinity());
+    float32x4_t max = vdupq_n_f32(-std::numeric_limits<float>::infinity());
+
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      float const* p = reinterpret_cast<float const*>(boxes + i);
+      min = Min(vld1q_f32(p), min);
+      max = Max(vld1q_f32(p + 2), max);
+    }
+
+    return {{vgetq_lane_f32(min, 0), vgetq_lane_f32(min, 1), vgetq_lane_f32(min, 2)}
+            , {vgetq_lane_f32(max, 1), vgetq_lane_f32(max, 2), vgetq_lane_f32(max, 3)}};
+  }
+
+  void IntersectBoxesNEON(CAaBox const& clip, CAaBox const* boxes, CAaBox* out, std::size_t n)
+  {
+    float32x4_t const clip_min[3] = {vdupq_n_f32(clip.min.x), vdupq_n_f32(clip.min.y), vdupq_n_f32(clip.min.z)};
+    float32x4_t const clip_max[3] = {vdupq_n_f32(clip.max.x), vdupq_n_f32(clip.max.y), vdupq_n_f32(clip.max.z)};
+    std::size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+      float32x4_t v[6];
+      Load4(boxes + i, v);
+
+      for (unsigned k = 0; k < 3; ++k)
+      {
+        v[k] = Max(v[k], clip_min[k]);
+        v[k + 3] = Min(v[k + 3], clip_max[k]);
+      }
+
+      Store4(out + i, v);
+    }
+
+    for (; i < n; ++i)
+      out[i] = IntersectBox(clip, boxes[i]);
+  }
+
+  void ContainsPointsNEON(CAaBox const& box, C3Vector const* points, std::uint8_t* out, std::size_t n)
+  {
+    float32x4_t const min_x = vdupq_n_f32(box.min.x), max_x = vdupq_n_f32(box.max.x);
+    float32x4_t const min_y = vdupq_n_f32(box.min.y), max_y = vdupq_n_f32(box.max.y);
+    float32x4_t const min_z = vdupq_n_f32(box.min.z), max_z = vdupq_n_f32(box.max.z);
+
+    std::size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+      float32x4x3_t const v = Load4(points + i);
+
+      uint32x4_t const inside = vandq_u32(vandq_u32(vandq_u32(vcleq_f32(min_x, v.val[0]), vcleq_f32(v.val[0], max_x))
+                                                    , vandq_u32(vcleq_f32(min_y, v.val[1]), vcleq_f32(v.val[1], max_y)))
+                                          , vandq_u32(vcleq_f32(min_z, v.val[2]), vcleq_f32(v.val[2], max_z)));
+
+      // lanes are all ones or all zeros, narrow twice to one byte each
+      std::uint8_t lanes[8];
+      vst1_u8(lanes, vmovn_u16(vcombine_u16(vmovn_u32(inside), vdup_n_u16(0))));
+
+      for (unsigned lane = 0; lane < 4; ++lane)
+        out[i + lane] = lanes[lane] & 1;
+    }
+
+    for (; i < n; ++i)
+      out[i] = static_cast<std::uint8_t>(Contains(box, points[i]));
+  }
+
+  void ClassifyBoxesNEON(Frustum const& frustum, CAaBox const* boxes, Containment* out, std::size_t n)
+  {
+    float32x4_t const zero = vdupq_n_f32(0.f);
+    std::size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+      float32x4_t v[6];
+      Load4(boxes + i, v);
+
+      uint32x4_t outside = vdupq_n_u32(0);
+      uint32x4_t inside = vdupq_n_u32(~0u);
+
+      for (Plane const& plane : frustum)
+      {
+        // corners are picked per plane, the same for all boxes
+        bool const neg_x = plane.normal.x < 0.f, neg_y = plane.normal.y < 0.f, neg_z = plane.normal.z < 0.f;
+
+        float32x4_t const nx = vdupq_n_f32(plane.normal.x);
+        float32x4_t const ny = vdupq_n_f32(plane.normal.y);
+        float32x4_t const nz = vdupq_n_f32(plane.normal.z);
+        float32x4_t const d = vdupq_n_f32(plane.distance);
+
+        float32x4_t const min_distance = Dot(nx, ny, nz, d, neg_x ? v[3] : v[0], neg_y ? v[4] : v[1]
+                                             , neg_z ? v[5] : v[2]);
+        float32x4_t const max_distance = Dot(nx, ny, nz, d, neg_x ? v[0] : v[3], neg_y ? v[1] : v[4]
+                                             , neg_z ? v[2] : v[5]);
+
+        outside = vorrq_u32(outside, vcltq_f32(max_distance, zero));
+        inside = vandq_u32(inside, vcgeq_f32(min_distance, zero));
+      }
+
+      StoreContainment(outside, inside, out + i);
+    }
+
+    for (; i < n; ++i)
+      out[i] = Classify(frustum, boxes[i]);
+  }
+
+  void ClassifySpheresNEON(Frustum const& frustum, CAaSphere const* spheres, Containment* out, std::size_t n)
+  {
+    std::size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+      float32x4x4_t const v = vld4q_f32(reinterpret_cast<float const*>(spheres + i));
+      float32x4_t const neg_r = vnegq_f32(v.val[3]);
+
+      uint32x4_t outside = vdupq_n_u32(0);
+      uint32x4_t inside = vdupq_n_u32(~0u);
+
+      for (Plane const& plane : frustum)
+      {
+        float32x4_t const distance = Dot(vdupq_n_f32(plane.normal.x), vdupq_n_f32(plane.normal.y)
+                                         , vdupq_n_f32(plane.normal.z), vdupq_n_f32(plane.distance)
+                                         , v.val[0], v.val[1], v.val[2]);
+
+        outside = vorrq_u32(outside, vcltq_f32(distance, neg_r));
+        inside = vandq_u32(inside, vcgeq_f32(distance, v.val[3]));
+      }
+
+      StoreContainment(outside, inside, out + i);
+    }
+
+    for (; i < n; ++i)
+      out[i] = Classify(frustum, spheres[i]);
+  }
+
+  void PlacementToWorldNEON(C3Vector const* points, C3Vector* out, std::size_t n)
+  {
+    float32x4_t const half = vdupq_n_f32(MAP_HALFSIZE);
+    std::size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+      float32x4x3_t const v = Load4(points + i);
+      Store4(out + i, vsubq_f32(half, v.val[2]), vsubq_f32(half, v.val[0]), v.val[1]);
+    }
+
+    for (; i < n; ++i)
+      out[i] = PlacementToWorld(points[i]);
+  }
+
+  void WorldToPlacementNEON(C3Vector const* points, C3Vector* out, std::size_t n)
+  {
+    float32x4_t const half = vdupq_n_f32(MAP_HALFSIZE);
+    std::size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+      float32x4x3_t const v = Load4(points + i);
+      Store4(out + i, vsubq_f32(half, v.val[1]), v.val[2], vsubq_f32(half, v.val[0]));
+    }
+
+    for (; i < n; ++i)
+      out[i] = WorldToPlacement(points[i]);
+  }
+
+  void TileIndicesAtNEON(C3Vector const* points, TileIndex* out, std::size_t n)
+  {
+    float32x4_t const tile_size = vdupq_n_f32(WorldConstants::TILE_SIZE);
+    float32x4_t const last_tile = vdupq_n_f32(63.f);
+    std::size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+      float32x4x3_t const v = Load4(points + i);
+
+      uint32x4_t const tile_x = CellAt(v.val[0], tile_size, last_tile);
+      uint32x4_t const tile_y = CellAt(v.val[2], tile_size, last_tile);
+      vst1q_u32(reinterpret_cast<std::uint32_t*>(out + i), vorrq_u32(tile_x, vshlq_n_u32(tile_y, 16)));
+    }
+
+    for (; i < n; ++i)
+      out[i] = TileIndexAt(points[i]);
+  }
+
+  void ChunkIndicesAtNEON(C3Vector const* points, std::uint16_t* out, std::size_t n)
+  {
+    float32x4_t const tile_size = vdupq_n_f32(WorldConstants::TILE_SIZE);
+    float32x4_t const chunk_size = vdupq_n_f32(WorldConstants::CHUNK_SIZE);
+    float32x4_t const last_tile = vdupq_n_f32(63.f);
+    float32x4_t const last_chunk = vdupq_n_f32(15.f);
+    std::size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+      float32x4x3_t const v = Load4(points + i);
+
+      float32x4_t const tile_x = vcvtq_f32_u32(CellAt(v.val[0], tile_size, last_tile));
+      float32x4_t const tile_y = vcvtq_f32_u32(CellAt(v.val[2], tile_size, last_tile));
+      uint32x4_t const chunk_x = CellAt(vsubq_f32(v.val[0], vmulq_f32(tile_x, tile_size)), chunk_size, last_chunk);
+      uint32x4_t const chunk_y = CellAt(vsubq_f32(v.val[2], vmulq_f32(tile_y, tile_size)), chunk_size, last_chunk);
+
+      vst1_u16(out + i, vmovn_u32(vaddq_u32(vshlq_n_u32(chunk_y, 4), chunk_x)));
+    }
+
+    for (; i < n; ++i)
+      out[i] = ChunkIndexAt(points[i]);
+  }
+
+  CRange HeightRangeNEON(C3Vector const* points, std::size_t n)
+  {
+    float32x4_t min = vdupq_n_f32(std::numeric_limits<float>::infinity());
+    float32x4_t max = vdupq_n_f32(-std::numeric_limits<float>::infinity());
+    std::size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+      float32x4x3_t const v = Load4(points + i);
+      min = Min(v.val[1], min);
+      max = Max(v.val[1], max);
+    }
+
+    float min_lanes[4];
+    float max_lanes[4];
+    vst1q_f32(min_lanes, min);
+    vst1q_f32(max_lanes, max);
+
+    CRange range {min_lanes[0], max_lanes[0]};
+
+    for (unsigned lane = 1; lane < 4; ++lane)
+    {
+      range.min = std::min(range.min, min_lanes[lane]);
+      range.max = std::max(range.max, max_lanes[lane]);
+    }
+
+    for (; i < n; ++i)
+    {
+      range.min = std::min(range.min, points[i].y);
+      range.max = std::max(range.max, points[i].y);
+    }
+
+    return Kernels::RestoreZeroSigns(range, points, n);
+  }
+}
+
+void Geometry::Kernels::LoadKernelsNEON(KernelTable& table)
+{
+  table.transform_points = TransformPointsNEON;
+  table.transform_boxes = TransformBoxesNEON;
+  table.merge_boxes = MergeBoxesNEON;
+  table.intersect_boxes = IntersectBoxesNEON;
+  table.contains_points = ContainsPointsNEON;
+  table.classify_boxes = ClassifyBoxesNEON;
+  table.classify_spheres = ClassifySpheresNEON;
+  table.placement_to_world = PlacementToWorldNEON;
+  table.world_to_placement = WorldToPlacementNEON;
+  table.tile_indices_at = TileIndicesAtNEON;
+  table.chunk_indices_at = ChunkIndicesAtNEON;
+  table.height_range = HeightRangeNEON;
+}
+
+#endif
@@ -0,0 +1,891 @@
+#include <IO/CommonGeometryKernels.hpp>
+
+#if defined(GEOMETRY_SIMD_X86)
+
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#endif
+
+#include <immintrin.h>
+
+/**
+ * SSE2, SSE4.1 and AVX2 paths of the batch kernels.
+ *
+ * Functions are compiled for their instruction set through target attributes rather than per-file flags, so that
+ * inline functions from headers instantiated here are never emitted with instructions the CPU may lack.
+ * MSVC accepts intrinsics of any instruction set without flags.
+ *
+ * Results match the single-element functions bit for bit:
+ *  - sums are evaluated in the same order and never fused;
+ *  - std::min(a, b) is (b < a) ? b : a, which is _mm_min_ps(b, a), likewise std::max(a, b) is _mm_max_ps(b, a),
+ *    so NaN and signed zeros resolve the same way;
+ *  - reductions across lanes restore the sign of zero, see RestoreZeroSigns().
+ */
+
+#if defined(__GNUC__)
+#  define TARGET_SSE2 __attribute__((target("sse2")))
+#  define TARGET_SSE41 __attribute__((target("sse4.1")))
+#  define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#  define TARGET_SSE2
+#  define TARGET_SSE41
+#  define TARGET_AVX2
+#endif
+
+using namespace IO::Common;
+using namespace IO::Common::Geometry;
+using namespace IO::Common::DataStructures;
+
+namespace
+{
+  /**
+   * Deinterleaves 4 vectors (x0 y0 z0 x1, y1 z1 x2 y2, z2 x3 y3 z3) into components.
+   */
+  TARGET_SSE2 inline void Load4(C3Vector const* points, __m128& x, __m128& y, __m128& z)
+  {
+    float const* p = reinterpret_cast<float const*>(points);
+
+    __m128 const m03 = _mm_loadu_ps(p);
+    __m128 const m14 = _mm_loadu_ps(p + 4);
+    __m128 const m25 = _mm_loadu_ps(p + 8);
+
+    __m128 const xy = _mm_shuffle_ps(m14, m25, _MM_SHUFFLE(2, 1, 3, 2)); // x2 y2 x3 y3
+    __m128 const yz = _mm_shuffle_ps(m03, m14, _MM_SHUFFLE(1, 0, 2, 1)); // y0 z0 y1 z1
+
+    x = _mm_shuffle_ps(m03, xy, _MM_SHUFFLE(2, 0, 3, 0));
+    y = _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+    z = _mm_shuffle_ps(yz, m25, _MM_SHUFFLE(3, 0, 3, 1));
+  }
+
+  /**
+   * Inverse of Load4().
+   */
+  TARGET_SSE2 inline void Store4(C3Vector* points, __m128 x, __m128 y, __m128 z)
+  {
+    float* p = reinterpret_cast<float*>(points);
+
+    __m128 const rxy = _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0)); // x0 x2 y0 y2
+    __m128 const ryz = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1)); // y1 y3 z1 z3
+    __m128 const rzx = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0)); // z0 z2 x1 x3
+
+    _mm_storeu_ps(p, _mm_shuffle_ps(rxy, rzx, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(p + 4, _mm_shuffle_ps(ryz, rxy, _MM_SHUFFLE(3, 1, 2, 0)));
+    _mm_storeu_ps(p + 8, _mm_shuffle_ps(rzx, ryz, _MM_SHUFFLE(3, 1, 3, 1)));
+  }
+
+  /**
+   * Transposes 4 boxes into min x, y, z and max x, y, z.
+   */
+  TARGET_SSE2 inline void Load4(CAaBox const* boxes, __m128 (&v)[6])
+  {
+    float const* p = reinterpret_cast<float const*>(boxes);
+
+    __m128 b0 = _mm_loadu_ps(p);
+    __m128 b1 = _mm_loadu_ps(p + 6);
+    __m128 b2 = _mm_loadu_ps(p + 12);
+    __m128 b3 = _mm_loadu_ps(p + 18);
+    _MM_TRANSPOSE4_PS(b0, b1, b2, b3);
+
+    v[0] = b0;
+    v[1] = b1;
+    v[2] = b2;
+    v[3] = b3;
+
+    // min z, max x, max y, max z of each box, only the last two are needed
+    __m128 const u01 = _mm_unpackhi_ps(_mm_loadu_ps(p + 2), _mm_loadu_ps(p + 8));
+    __m128 const u23 = _mm_unpackhi_ps(_mm_loadu_ps(p + 14), _mm_loadu_ps(p + 20));
+
+    v[4] = _mm_movelh_ps(u01, u23);
+    v[5] = _mm_movehl_ps(u23, u01);
+  }
+
+  /**
+   * Inverse of Load4().
+   */
+  TARGET_SSE2 inline void Store4(CAaBox* boxes, __m128 const (&v)[6])
+  {
+    float* p = reinterpret_cast<float*>(boxes);
+
+    __m128 b0 = v[0];
+    __m128 b1 = v[1];
+    __m128 b2 = v[2];
+    __m128 b3 = v[3];
+    _MM_TRANSPOSE4_PS(b0, b1, b2, b3);
+
+    __m128 const lo = _mm_unpacklo_ps(v[4], v[5]);
+    __m128 const hi = _mm_unpackhi_ps(v[4], v[5]);
+
+    _mm_storeu_ps(p, b0);
+    _mm_storel_pi(reinterpret_cast<__m64*>(p + 4), lo);
+    _mm_storeu_ps(p + 6, b1);
+    _mm_storeh_pi(reinterpret_cast<__m64*>(p + 10), lo);
+    _mm_storeu_ps(p + 12, b2);
+    _mm_storel_pi(reinterpret_cast<__m64*>(p + 16), hi);
+    _mm_storeu_ps(p + 18, b3);
+    _mm_storeh_pi(reinterpret_cast<__m64*>(p + 22), hi);
+  }
+
+  /**
+   * Transposes 4 spheres into position x, y, z and radius.
+   */
+  TARGET_SSE2 inline void Load4(CAaSphere const* spheres, __m128& x, __m128& y, __m128& z, __m128& r)
+  {
+    float const* p = reinterpret_cast<float const*>(spheres);
+
+    x = _mm_loadu_ps(p);
+    y = _mm_loadu_ps(p + 4);
+    z = _mm_loadu_ps(p + 8);
+    r = _mm_loadu_ps(p + 12);
+    _MM_TRANSPOSE4_PS(x, y, z, r);
+  }
+
+  TARGET_SSE2 inline __m128 Dot(__m128 nx, __m128 ny, __m128 nz, __m128 d, __m128 x, __m128 y, __m128 z)
+  {
+    return _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, x), _mm_mul_ps(ny, y)), _mm_mul_ps(nz, z)), d);
+  }
+
+  /**
+   * Writes Containment of 4 elements from lane masks.
+   */
+  inline void StoreContainment(int outside, int inside, Containment* out)
+  {
+    for (unsigned lane = 0; lane < 4; ++lane)
+    {
+      unsigned const is_outside = (outside >> lane) & 1;
+      unsigned const is_inside = (inside >> lane) & 1;
+      out[lane] = static_cast<Containment>((1 - is_outside) * (1 + is_inside));
+    }
+  }
+
+  /**
+   * Clip box repeated over 4 boxes, and masks selecting its min part, for kernels working on boxes as plain floats.
+   */
+  struct BoxPattern
+  {
+    alignas(32) float clip[24];
+    alignas(32) std::int32_t is_min[24];
+
+    explicit BoxPattern(CAaBox const& box)
+    {
+      float const* p = reinterpret_cast<float const*>(&box);
+
+      for (unsigned i = 0; i < 24; ++i)
+      {
+        clip[i] = p[i % 6];
+        is_min[i] = i % 6 < 3 ? -1 : 0;
+      }
+    }
+  };
+
+  // SSE2
+
+  TARGET_SSE2 void TransformPointsSSE2(Matrix34 const& matrix, C3Vector const* points, C3Vector* out, std::size_t n)
+  {
+    __m128 m[12];
+
+    for (unsigned i = 0; i < 12; ++i)
+      m[i] = _mm_set1_ps(matrix[i]);
+
+    std::size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+      __m128 x, y, z;
+      Load4(points + i, x, y, z);
+      Store4(out + i, Dot(m[0], m[1], m[2], m[3], x, y, z)
+             , Dot(m[4], m[5], m[6], m[7], x, y, z)
+             , Dot(m[8], m[9], m[10], m[11], x, y, z));
+    }
+
+    for (; i < n; ++i)
+      out[i] = TransformPoint(matrix, points[i]);
+  }
+
+  TARGET_SSE2 void TransformBoxesSSE2(Matrix34 const& matrix, CAaBox const* boxes, CAaBox* out, std::size_t n)
+  {
+    std::size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+      __m128 v[6];
+      Load4(boxes + i, v);
+
+      __m128 result[6];
+
+      for (unsigned row = 0; row < 3; ++row)
+      {
+        float const* m = matrix.data() + row * 4;
+
+        __m128 const mx = _mm_set1_ps(m[0]);
+        __m128 const my = _mm_set1_ps(m[1]);
+        __m128 const mz = _mm_set1_ps(m[2]);
+        __m128 const mt = _mm_set1_ps(m[3]);
+
+        __m128 const x0 = _mm_mul_ps(mx, v[0]), x1 = _mm_mul_ps(mx, v[3]);
+        __m128 const y0 = _mm_mul_ps(my, v[1]), y1 = _mm_mul_ps(my, v[4]);
+        __m128 const z0 = _mm_mul_ps(mz, v[2]), z1 = _mm_mul_ps(mz, v[5]);
+
+        result[row] = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_min_ps(x1, x0), _mm_min_ps(y1, y0))
+                                            , _mm_min_ps(z1, z0)), mt);
+        result[row + 3] = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_max_ps(x1, x0), _mm_max_ps(y1, y0))
+                                                , _mm_max_ps(z1, z0)), mt);
+      }
+
+      Store4(out + i, result);
+    }
+
+    for (; i < n; ++i)
+      out[i] = TransformBox(matrix, boxes[i]);
+  }
+
+  TARGET_SSE2 CAaBox MergeBoxesSSE2(CAaBox const* boxes, std::size_t n)
+  {
+    // one box per step, min and max parts in lanes 0-2 and 1-3, so boxes merge in the same order as the scan
+    __m128 min = _mm_set1_ps(std::numeric_limits<float>::infinity());
+    __m128 max = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      float const* p = reinterpret_cast<float const*>(boxes + i);
+      min = _mm_min_ps(_mm_loadu_ps(p), min);
+      max = _mm_max_ps(_mm_loadu_ps(p + 2), max);
+    }
+
+    alignas(16) float min_lanes[4];
+    alignas(16) float max_lanes[4];
+    _mm_store_ps(min_lanes, min);
+    _mm_store_ps(max_lanes, max);
+
+    return {{min_lanes[0], min_lanes[1], min_lanes[2]}, {max_lanes[1], max_lanes[2], max_lanes[3]}};
+  }
+
+  TARGET_SSE2 void IntersectBoxesSSE2(CAaBox const& clip, CAaBox const* boxes, CAaBox* out, std::size_t n)
+  {
+    // 2 boxes fill 3 registers, min parts take the maximum and max parts the minimum
+    BoxPattern const pattern(clip);
+    __m128 clips[3];
+    __m128 masks[3];
+
+    for (unsigned k = 0; k < 3; ++k)
+    {
+      clips[k] = _mm_load_ps(pattern.clip + k * 4);
+      masks[k] = _mm_castsi128_ps(_mm_load_si128(reinterpret_cast<__m128i const*>(pattern.is_min + k * 4)));
+    }
+
+    std::size_t i = 0;
+
+    for (; i + 2 <= n; i += 2)
+    {
+      float const* src = reinterpret_cast<float const*>(boxes + i);
+      float* dst = reinterpret_cast<float*>(out + i);
+
+      __m128 const v[3] = {_mm_loadu_ps(src), _mm_loadu_ps(src + 4), _mm_loadu_ps(src + 8)};
+
+      for (unsigned k = 0; k < 3; ++k)
+      {
+        __m128 const max = _mm_max_ps(v[k], clips[k]);
+        __m128 const min = _mm_min_ps(v[k], clips[k]);
+        _mm_storeu_ps(dst + k * 4, _mm_or_ps(_mm_and_ps(masks[k], max), _mm_andnot_ps(masks[k], min)));
+      }
+    }
+
+    for (; i < n; ++i)
+      out[i] = IntersectBox(clip, boxes[i]);
+  }
+
+  TARGET_SSE2 void ContainsPointsSSE2(CAaBox const& box, C3Vector const* points, std::uint8_t* out, std::size_t n)
+  {
+    __m128 const min_x = _mm_set1_ps(box.min.x), max_x = _mm_set1_ps(box.max.x);
+    __m128 const min_y = _mm_set1_ps(box.min.y), max_y = _mm_set1_ps(box.max.y);
+    __m128 const min_z = _mm_set1_ps(box.min.z), max_z = _mm_set1_ps(box.max.z);
+
+    std::size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+      __m128 x, y, z;
+      Load4(points + i, x, y, z);
+
+      __m128 const inside = _mm_and_ps(_mm_and_ps(_mm_and_ps(_mm_cmple_ps(min_x, x), _mm_cmple_ps(x, max_x))
+                                                  , _mm_and_ps(_mm_cmple_ps(min_y, y), _mm_cmple_ps(y, max_y)))
+                                       , _mm_and_ps(_mm_cmple_ps(min_z, z), _mm_cmple_ps(z, max_z)));
+
+      int const bits = _mm_movemask_ps(inside);
+
+      for (unsigned lane = 0; lane < 4; ++lane)
+        out[i + lane] = static_cast<std::uint8_t>((bits >> lane) & 1);
+    }
+
+    for (; i < n; ++i)
+      out[i] = static_cast<std::uint8_t>(Contains(box, points[i]));
+  }
+
+  TARGET_SSE2 void ClassifyBoxesSSE2(Frustum const& frustum, CAaBox const* boxes, Containment* out, std::size_t n)
+  {
+    std::size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+      __m128 v[6];
+      Load4(boxes + i, v);
+
+      __m128 outside = _mm_setzero_ps();
+      __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+      for (Plane const& plane : frustum)
+      {
+        // corners are picked per plane, the same for all boxes
+        bool const neg_x = plane.normal.x < 0.f, neg_y = plane.normal.y < 0.f, neg_z = plane.normal.z < 0.f;
+
+        __m128 const nx = _mm_set1_ps(plane.normal.x);
+        __m128 const ny = _mm_set1_ps(plane.normal.y);
+        __m128 const nz = _mm_set1_ps(plane.normal.z);
+        __m128 const d = _mm_set1_ps(plane.distance);
+
+        __m128 const min_distance = Dot(nx, ny, nz, d, neg_x ? v[3] : v[0], neg_y ? v[4] : v[1], neg_z ? v[5] : v[2]);
+        __m128 const max_distance = Dot(nx, ny, nz, d, neg_x ? v[0] : v[3], neg_y ? v[1] : v[4], neg_z ? v[2] : v[5]);
+
+        outside = _mm_or_ps(outside, _mm_cmplt_ps(max_distance, _mm_setzero_ps()));
+        inside = _mm_and_ps(inside, _mm_cmpge_ps(min_distance, _mm_setzero_ps()));
+      }
+
+      StoreContainment(_mm_movemask_ps(outside), _mm_movemask_ps(inside), out + i);
+    }
+
+    for (; i < n; ++i)
+      out[i] = Classify(frustum, boxes[i]);
+  }
+
+  TARGET_SSE2 void ClassifySpheresSSE2(Frustum const& frustum
+                                       , CAaSphere const* spheres
+                                       , Containment* out
+                                       , std::size_t n)
+  {
+    __m128 const sign = _mm_set1_ps(-0.f);
+    std::size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+      __m128 x, y, z, r;
+      Load4(spheres + i, x, y, z, r);
+
+      __m128 const neg_r = _mm_xor_ps(r, sign);
+      __m128 outside = _mm_setzero_ps();
+      __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+      for (Plane const& plane : frustum)
+      {
+        __m128 const distance = Dot(_mm_set1_ps(plane.normal.x), _mm_set1_ps(plane.normal.y)
+                                    , _mm_set1_ps(plane.normal.z), _mm_set1_ps(plane.distance), x, y, z);
+
+        outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, neg_r));
+        inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, r));
+      }
+
+      StoreContainment(_mm_movemask_ps(outside), _mm_movemask_ps(inside), out + i);
+    }
+
+    for (; i < n; ++i)
+      out[i] = Classify(frustum, spheres[i]);
+  }
+
+  TARGET_SSE2 void PlacementToWorldSSE2(C3Vector const* points, C3Vector* out, std::size_t n)
+  {
+    __m128 const half = _mm_set1_ps(MAP_HALFSIZE);
+    std::size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+      __m128 x, y, z;
+      Load4(points + i, x, y, z);
+      Store4(out + i, _mm_sub_ps(half, z), _mm_sub_ps(half, x), y);
+    }
+
+    for (; i < n; ++i)
+      out[i] = PlacementToWorld(points[i]);
+  }
+
+  TARGET_SSE2 void WorldToPlacementSSE2(C3Vector const* points, C3Vector* out, std::size_t n)
+  {
+    __m128 const half = _mm_set1_ps(MAP_HALFSIZE);
+    std::size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+      __m128 x, y, z;
+      Load4(points + i, x, y, z);
+      Store4(out + i, _mm_sub_ps(half, y), z, _mm_sub_ps(half, x));
+    }
+
+    for (; i < n; ++i)
+      out[i] = WorldToPlacement(points[i]);
+  }
+
+  TARGET_SSE2 CRange HeightRangeSSE2(C3Vector const* points, std::size_t n)
+  {
+    __m128 min = _mm_set1_ps(std::numeric_limits<float>::infinity());
+    __m128 max = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+    std::size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+      __m128 x, y, z;
+      Load4(points + i, x, y, z);
+      min = _mm_min_ps(y, min);
+      max = _mm_max_ps(y, max);
+    }
+
+    alignas(16) float min_lanes[4];
+    alignas(16) float max_lanes[4];
+    _mm_store_ps(min_lanes, min);
+    _mm_store_ps(max_lanes, max);
+
+    CRange range {min_lanes[0], max_lanes[0]};
+
+    for (unsigned lane = 1; lane < 4; ++lane)
+    {
+      range.min = std::min(range.min, min_lanes[lane]);
+      range.max = std::max(range.max, max_lanes[lane]);
+    }
+
+    for (; i < n; ++i)
+    {
+      range.min = std::min(range.min, points[i].y);
+      range.max = std::max(range.max, points[i].y);
+    }
+
+    return Kernels::RestoreZeroSigns(range, points, n);
+  }
+
+  // SSE4.1, floor for cell lookups
+
+  TARGET_SSE41 inline __m128i CellAt(__m128 coordinate, __m128 cell_size, __m128 last_cell)
+  {
+    __m128 const cell = _mm_floor_ps(_mm_div_ps(coordinate, cell_size));
+    return _mm_cvttps_epi32(_mm_max_ps(_mm_min_ps(last_cell, cell), _mm_setzero_ps()));
+  }
+
+  TARGET_SSE41 void TileIndicesAtSSE41(C3Vector const* points, TileIndex* out, std::size_t n)
+  {
+    __m128 const tile_size = _mm_set1_ps(WorldConstants::TILE_SIZE);
+    __m128 const last_tile = _mm_set1_ps(63.f);
+    std::size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+      __m128 x, y, z;
+      Load4(points + i, x, y, z);
+
+      __m128i const tile_x = CellAt(x, tile_size, last_tile);
+      __m128i const tile_y = CellAt(z, tile_size, last_tile);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_or_si128(tile_x, _mm_slli_epi32(tile_y, 16)));
+    }
+
+    for (; i < n; ++i)
+      out[i] = TileIndexAt(points[i]);
+  }
+
+  TARGET_SSE41 void ChunkIndicesAtSSE41(C3Vector const* points, std::uint16_t* out, std::size_t n)
+  {
+    __m128 const tile_size = _mm_set1_ps(WorldConstants::TILE_SIZE);
+    __m128 const chunk_size = _mm_set1_ps(WorldConstants::CHUNK_SIZE);
+    __m128 const last_tile = _mm_set1_ps(63.f);
+    __m128 const last_chunk = _mm_set1_ps(15.f);
+    std::size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+      __m128 x, y, z;
+      Load4(points + i, x, y, z);
+
+      __m128 const tile_x = _mm_cvtepi32_ps(CellAt(x, tile_size, last_tile));
+      __m128 const tile_y = _mm_cvtepi32_ps(CellAt(z, tile_size, last_tile));
+      __m128i const chunk_x = CellAt(_mm_sub_ps(x, _mm_mul_ps(tile_x, tile_size)), chunk_size, last_chunk);
+      __m128i const chunk_y = CellAt(_mm_sub_ps(z, _mm_mul_ps(tile_y, tile_size)), chunk_size, last_chunk);
+
+      __m128i const index = _mm_add_epi32(_mm_slli_epi32(chunk_y, 4), chunk_x);
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(index, index));
+    }
+
+    for (; i < n; ++i)
+      out[i] = ChunkIndexAt(points[i]);
+  }
+
+  // AVX2, arithmetic bound kernels only. Memory bound ones (coordinate conversions, reductions) keep SSE paths.
+
+  TARGET_AVX2 inline void Load8(C3Vector const* points, __m256& x, __m256& y, __m256& z)
+  {
+    __m128 x0, y0, z0, x1, y1, z1;
+    Load4(points, x0, y0, z0);
+    Load4(points + 4, x1, y1, z1);
+
+    x = _mm256_set_m128(x1, x0);
+    y = _mm256_set_m128(y1, y0);
+    z = _mm256_set_m128(z1, z0);
+  }
+
+  TARGET_AVX2 inline void Store8(C3Vector* points, __m256 x, __m256 y, __m256 z)
+  {
+    Store4(points, _mm256_castps256_ps128(x), _mm256_castps256_ps128(y), _mm256_castps256_ps128(z));
+    Store4(points + 4, _mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1), _mm256_extractf128_ps(z, 1));
+  }
+
+  TARGET_AVX2 inline void Load8(CAaBox const* boxes, __m256 (&v)[6])
+  {
+    __m128 lo[6];
+    __m128 hi[6];
+    Load4(boxes, lo);
+    Load4(boxes + 4, hi);
+
+    for (unsigned k = 0; k < 6; ++k)
+      v[k] = _mm256_set_m128(hi[k], lo[k]);
+  }
+
+  TARGET_AVX2 inline void Store8(CAaBox* boxes, __m256 const (&v)[6])
+  {
+    __m128 lo[6];
+    __m128 hi[6];
+
+    for (unsigned k = 0; k < 6; ++k)
+    {
+      lo[k] = _mm256_castps256_ps128(v[k]);
+      hi[k] = _mm256_extractf128_ps(v[k], 1);
+    }
+
+    Store4(boxes, lo);
+    Store4(boxes + 4, hi);
+  }
+
+  TARGET_AVX2 inline void Load8(CAaSphere const* spheres, __m256& x, __m256& y, __m256& z, __m256& r)
+  {
+    __m128 x0, y0, z0, r0, x1, y1, z1, r1;
+    Load4(spheres, x0, y0, z0, r0);
+    Load4(spheres + 4, x1, y1, z1, r1);
+
+    x = _mm256_set_m128(x1, x0);
+    y = _mm256_set_m128(y1, y0);
+    z = _mm256_set_m128(z1, z0);
+    r = _mm256_set_m128(r1, r0);
+  }
+
+  TARGET_AVX2 inline __m256 Dot(__m256 nx, __m256 ny, __m256 nz, __m256 d, __m256 x, __m256 y, __m256 z)
+  {
+    return _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, x), _mm256_mul_ps(ny, y))
+                                       , _mm256_mul_ps(nz, z)), d);
+  }
+
+  TARGET_AVX2 void TransformPointsAVX2(Matrix34 const& matrix, C3Vector const* points, C3Vector* out, std::size_t n)
+  {
+    __m256 m[12];
+
+    for (unsigned i = 0; i < 12; ++i)
+      m[i] = _mm256_set1_ps(matrix[i]);
+
+    std::size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+      __m256 x, y, z;
+      Load8(points + i, x, y, z);
+      Store8(out + i, Dot(m[0], m[1], m[2], m[3], x, y, z)
+             , Dot(m[4], m[5], m[6], m[7], x, y, z)
+             , Dot(m[8], m[9], m[10], m[11], x, y, z));
+    }
+
+    TransformPointsSSE2(matrix, points + i, out + i, n - i);
+  }
+
+  TARGET_AVX2 void TransformBoxesAVX2(Matrix34 const& matrix, CAaBox const* boxes, CAaBox* out, std::size_t n)
+  {
+    std::size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+      __m256 v[6];
+      Load8(boxes + i, v);
+
+      __m256 result[6];
+
+      for (unsigned row = 0; row < 3; ++row)
+      {
+        float const* m = matrix.data() + row * 4;
+
+        __m256 const mx = _mm256_set1_ps(m[0]);
+        __m256 const my = _mm256_set1_ps(m[1]);
+        __m256 const mz = _mm256_set1_ps(m[2]);
+        __m256 const mt = _mm256_set1_ps(m[3]);
+
+        __m256 const x0 = _mm256_mul_ps(mx, v[0]), x1 = _mm256_mul_ps(mx, v[3]);
+        __m256 const y0 = _mm256_mul_ps(my, v[1]), y1 = _mm256_mul_ps(my, v[4]);
+        __m256 const z0 = _mm256_mul_ps(mz, v[2]), z1 = _mm256_mul_ps(mz, v[5]);
+
+        result[row] = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_min_ps(x1, x0), _mm256_min_ps(y1, y0))
+                                                  , _mm256_min_ps(z1, z0)), mt);
+        result[row + 3] = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_max_ps(x1, x0), _mm256_max_ps(y1, y0))
+                                                      , _mm256_max_ps(z1, z0)), mt);
+      }
+
+      Store8(out + i, result);
+    }
+
+    TransformBoxesSSE2(matrix, boxes + i, out + i, n - i);
+  }
+
+  TARGET_AVX2 void IntersectBoxesAVX2(CAaBox const& clip, CAaBox const* boxes, CAaBox* out, std::size_t n)
+  {
+    // 4 boxes fill 3 registers
+    BoxPattern const pattern(clip);
+    __m256 clips[3];
+    __m256 masks[3];
+
+    for (unsigned k = 0; k < 3; ++k)
+    {
+      clips[k] = _mm256_load_ps(pattern.clip + k * 8);
+      masks[k] = _mm256_castsi256_ps(_mm256_load_si256(reinterpret_cast<__m256i const*>(pattern.is_min + k * 8)));
+    }
+
+    std::size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+      float const* src = reinterpret_cast<float const*>(boxes + i);
+      float* dst = reinterpret_cast<float*>(out + i);
+
+      __m256 const v[3] = {_mm256_loadu_ps(src), _mm256_loadu_ps(src + 8), _mm256_loadu_ps(src + 16)};
+
+      for (unsigned k = 0; k < 3; ++k)
+      {
+        __m256 const max = _mm256_max_ps(v[k], clips[k]);
+        __m256 const min = _mm256_min_ps(v[k], clips[k]);
+        _mm256_storeu_ps(dst + k * 8, _mm256_blendv_ps(min, max, masks[k]));
+      }
+    }
+
+    IntersectBoxesSSE2(clip, boxes + i, out + i, n - i);
+  }
+
+  TARGET_AVX2 void ContainsPointsAVX2(CAaBox const& box, C3Vector const* points, std::uint8_t* out, std::size_t n)
+  {
+    __m256 const min_x = _mm256_set1_ps(box.min.x), max_x = _mm256_set1_ps(box.max.x);
+    __m256 const min_y = _mm256_set1_ps(box.min.y), max_y = _mm256_set1_ps(box.max.y);
+    __m256 const min_z = _mm256_set1_ps(box.min.z), max_z = _mm256_set1_ps(box.max.z);
+
+    std::size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+      __m256 x, y, z;
+      Load8(points + i, x, y, z);
+
+      __m256 const inside_x = _mm256_and_ps(_mm256_cmp_ps(min_x, x, _CMP_LE_OQ), _mm256_cmp_ps(x, max_x, _CMP_LE_OQ));
+      __m256 const inside_y = _mm256_and_ps(_mm256_cmp_ps(min_y, y, _CMP_LE_OQ), _mm256_cmp_ps(y, max_y, _CMP_LE_OQ));
+      __m256 const inside_z = _mm256_and_ps(_mm256_cmp_ps(min_z, z, _CMP_LE_OQ), _mm256_cmp_ps(z, max_z, _CMP_LE_OQ));
+
+      int const bits = _mm256_movemask_ps(_mm256_and_ps(_mm256_and_ps(inside_x, inside_y), inside_z));
+
+      for (unsigned lane = 0; lane < 8; ++lane)
+        out[i + lane] = static_cast<std::uint8_t>((bits >> lane) & 1);
+    }
+
+    ContainsPointsSSE2(box, points + i, out + i, n - i);
+  }
+
+  TARGET_AVX2 void ClassifyBoxesAVX2(Frustum const& frustum, CAaBox const* boxes, Containment* out, std::size_t n)
+  {
+    std::size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+      __m256 v[6];
+      Load8(boxes + i, v);
+
+      __m256 outside = _mm256_setzero_ps();
+      __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+      for (Plane const& plane : frustum)
+      {
+        bool const neg_x = plane.normal.x < 0.f, neg_y = plane.normal.y < 0.f, neg_z = plane.normal.z < 0.f;
+
+        __m256 const nx = _mm256_set1_ps(plane.normal.x);
+        __m256 const ny = _mm256_set1_ps(plane.normal.y);
+        __m256 const nz = _mm256_set1_ps(plane.normal.z);
+        __m256 const d = _mm256_set1_ps(plane.distance);
+
+        __m256 const min_distance = Dot(nx, ny, nz, d, neg_x ? v[3] : v[0], neg_y ? v[4] : v[1], neg_z ? v[5] : v[2]);
+        __m256 const max_distance = Dot(nx, ny, nz, d, neg_x ? v[0] : v[3], neg_y ? v[1] : v[4], neg_z ? v[2] : v[5]);
+
+        outside = _mm256_or_ps(outside, _mm256_cmp_ps(max_distance, _mm256_setzero_ps(), _CMP_LT_OQ));
+        inside = _mm256_and_ps(inside, _mm256_cmp_ps(min_distance, _mm256_setzero_ps(), _CMP_GE_OQ));
+      }
+
+      int const outside_bits = _mm256_movemask_ps(outside);
+      int const inside_bits = _mm256_movemask_ps(inside);
+      StoreContainment(outside_bits, inside_bits, out + i);
+      StoreContainment(outside_bits >> 4, inside_bits >> 4, out + i + 4);
+    }
+
+    ClassifyBoxesSSE2(frustum, boxes + i, out + i, n - i);
+  }
+
+  TARGET_AVX2 void ClassifySpheresAVX2(Frustum const& frustum
+                                       , CAaSphere const* spheres
+                                       , Containment* out
+                                       , std::size_t n)
+  {
+    __m256 const sign = _mm256_set1_ps(-0.f);
+    std::size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+      __m256 x, y, z, r;
+      Load8(spheres + i, x, y, z, r);
+
+      __m256 const neg_r = _mm256_xor_ps(r, sign);
+      __m256 outside = _mm256_setzero_ps();
+      __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+      for (Plane const& plane : frustum)
+      {
+        __m256 const distance = Dot(_mm256_set1_ps(plane.normal.x), _mm256_set1_ps(plane.normal.y)
+                                    , _mm256_set1_ps(plane.normal.z), _mm256_set1_ps(plane.distance), x, y, z);
+
+        outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, neg_r, _CMP_LT_OQ));
+        inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, r, _CMP_GE_OQ));
+      }
+
+      int const outside_bits = _mm256_movemask_ps(outside);
+      int const inside_bits = _mm256_movemask_ps(inside);
+      StoreContainment(outside_bits, inside_bits, out + i);
+      StoreContainment(outside_bits >> 4, inside_bits >> 4, out + i + 4);
+    }
+
+    ClassifySpheresSSE2(frustum, spheres + i, out + i, n - i);
+  }
+
+  TARGET_AVX2 inline __m256i CellAt(__m256 coordinate, __m256 cell_size, __m256 last_cell)
+  {
+    __m256 const cell = _mm256_floor_ps(_mm256_div_ps(coordinate, cell_size));
+    return _mm256_cvttps_epi32(_mm256_max_ps(_mm256_min_ps(last_cell, cell), _mm256_setzero_ps()));
+  }
+
+  TARGET_AVX2 void TileIndicesAtAVX2(C3Vector const* points, TileIndex* out, std::size_t n)
+  {
+    __m256 const tile_size = _mm256_set1_ps(WorldConstants::TILE_SIZE);
+    __m256 const last_tile = _mm256_set1_ps(63.f);
+    std::size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+      __m256 x, y, z;
+      Load8(points + i, x, y, z);
+
+      __m256i const tile_x = CellAt(x, tile_size, last_tile);
+      __m256i const tile_y = CellAt(z, tile_size, last_tile);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_or_si256(tile_x, _mm256_slli_epi32(tile_y, 16)));
+    }
+
+    TileIndicesAtSSE41(points + i, out + i, n - i);
+  }
+
+  TARGET_AVX2 void ChunkIndicesAtAVX2(C3Vector const* points, std::uint16_t* out, std::size_t n)
+  {
+    __m256 const tile_size = _mm256_set1_ps(WorldConstants::TILE_SIZE);
+    __m256 const chunk_size = _mm256_set1_ps(WorldConstants::CHUNK_SIZE);
+    __m256 const last_tile = _mm256_set1_ps(63.f);
+    __m256 const last_chunk = _mm256_set1_ps(15.f);
+    std::size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+      __m256 x, y, z;
+      Load8(points + i, x, y, z);
+
+      __m256 const tile_x = _mm256_cvtepi32_ps(CellAt(x, tile_size, last_tile));
+      __m256 const tile_y = _mm256_cvtepi32_ps(CellAt(z, tile_size, last_tile));
+      __m256i const chunk_x = CellAt(_mm256_sub_ps(x, _mm256_mul_ps(tile_x, tile_size)), chunk_size, last_chunk);
+      __m256i const chunk_y = CellAt(_mm256_sub_ps(z, _mm256_mul_ps(tile_y, tile_size)), chunk_size, last_chunk);
+
+      __m256i const index = _mm256_add_epi32(_mm256_slli_epi32(chunk_y, 4), chunk_x);
+      __m128i const packed = _mm_packs_epi32(_mm256_castsi256_si128(index), _mm256_extracti128_si256(index, 1));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+    }
+
+    ChunkIndicesAtSSE41(points + i, out + i, n - i);
+  }
+}
+
+bool Geometry::Kernels::IsSupportedX86(InstructionSet instruction_set)
+{
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  int const max_leaf = info[0];
+
+  __cpuid(info, 1);
+  bool const sse2 = info[3] & (1 << 26);
+  bool const sse41 = info[2] & (1 << 19);
+
+  // AVX state must also be enabled by the operating system
+  bool const os_avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 0x6) == 0x6;
+  bool avx2 = false;
+
+  if (os_avx && max_leaf >= 7)
+  {
+    __cpuidex(info, 7, 0);
+    avx2 = info[1] & (1 << 5);
+  }
+#else
+  __builtin_cpu_init();
+  bool const sse2 = __builtin_cpu_supports("sse2");
+  bool const sse41 = __builtin_cpu_supports("sse4.1");
+  bool const avx2 = __builtin_cpu_supports("avx2");
+#endif
+
+  switch (instruction_set)
+  {
+    case InstructionSet::SCALAR:
+      return true;
+    case InstructionSet::SSE2:
+      return sse2;
+    case InstructionSet::SSE41:
+      return sse2 && sse41;
+    case InstructionSet::AVX2:
+      return sse2 && sse41 && avx2;
+    default:
+      return false;
+  }
+}
+
+void Geometry::Kernels::LoadKernelsSSE2(KernelTable& table)
+{
+  table.transform_points = TransformPointsSSE2;
+  table.transform_boxes = TransformBoxesSSE2;
+  table.merge_boxes = MergeBoxesSSE2;
+  table.intersect_boxes = IntersectBoxesSSE2;
+  table.contains_points = ContainsPointsSSE2;
+  table.classify_boxes = ClassifyBoxesSSE2;
+  table.classify_spheres = ClassifySpheresSSE2;
+  table.placement_to_world = PlacementToWorldSSE2;
+  table.world_to_placement = WorldToPlacementSSE2;
+  table.height_range = HeightRangeSSE2;
+}
+
+void Geometry::Kernels::LoadKernelsSSE41(KernelTable& table)
+{
+  table.tile_indices_at = TileIndicesAtSSE41;
+  table.chunk_indices_at = ChunkIndicesAtSSE41;
+}
+
+void Geometry::Kernels::LoadKernelsAVX2(KernelTable& table)
+{
+  table.transform_points = TransformPointsAVX2;
+  table.transform_boxes = TransformBoxesAVX2;
+  table.intersect_boxes = IntersectBoxesAVX2;
+  table.contains_points = ContainsPointsAVX2;
+  table.classify_boxes = ClassifyBoxesAVX2;
+  table.classify_spheres = ClassifySpheresAVX2;
+  table.tile_indices_at = TileIndicesAtAVX2;
+  table.chunk_indices_at = ChunkIndicesAtAVX2;
+}
+
+#endif
@@ -0,0 +1,282 @@
+#include <IO/DBC/DBCTable.hpp>
+#include <IO/Common.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace IO::DBC;
+using namespace IO::DBC::DataStructures;
+using namespace IO::Common;
+
+namespace
+{
+  constexpr std::uint32_t WDBC_MAGIC = FourCC<"WDBC", FourCCEndian::Big>;
+  constexpr std::uint32_t WDB2_MAGIC = FourCC<"WDB2", FourCCEndian::Big>;
+
+  template<typename T>
+  T ReadHeader(char const* data, std::size_t size, std::size_t offset)
+  {
+    EnsureF(CCodeZones::FILE_IO, offset + sizeof(T) <= size, "Table header is truncated.");
+
+    T header;
+    std::memcpy(&header, data + offset, sizeof(T));
+    return header;
+  }
+
+  template<typename T>
+  void Append(std::vector<char>& out, T const& value)
+  {
+    auto bytes = reinterpret_cast<char const*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+  }
+}
+
+DBCTable::DBCTable(ByteBuffer const& buf)
+{
+  Parse(buf.Data(), buf.Size());
+}
+
+DBCTable::DBCTable(ByteBuffer&& buf)
+: _owned_buf(std::move(buf))
+{
+  Parse(_owned_buf.Data(), _owned_buf.Size());
+}
+
+void DBCTable::Parse(char const* data, std::size_t size)
+{
+  std::size_t offset = 0;
+  std::uint32_t magic = ReadHeader<std::uint32_t>(data, size, 0);
+
+  if (magic == WDBC_MAGIC)
+  {
+    auto header = ReadHeader<DBCHeader>(data, size, 0);
+    offset = sizeof(DBCHeader);
+
+    _format = DBCFormat::WDBC;
+    _record_count = header.record_count;
+    _field_count = header.field_count;
+    _record_size = header.record_size;
+    _string_block_size = header.string_block_size;
+  }
+  else
+  {
+    EnsureF(CCodeZones::FILE_IO, magic == WDB2_MAGIC, "Unsupported table format.");
+
+    auto header = ReadHeader<DB2Header>(data, size, 0);
+    offset = sizeof(DB2Header);
+
+    _format = DBCFormat::WDB2;
+    _record_count = header.record_count;
+    _field_count = header.field_count;
+    _record_size = header.record_size;
+    _string_block_size = header.string_block_size;
+    _table_hash = header.table_hash;
+    _build = header.build;
+
+    if (_build > DB2_EXTENDED_HEADER_BUILD)
+    {
+      auto extended_header = ReadHeader<DB2ExtendedHeader>(data, size, offset);
+      offset += sizeof(DB2ExtendedHeader);
+
+      _locale = extended_header.locale;
+
+      // ID index and string lengths, not needed to read records
+      if (extended_header.max_id)
+      {
+        EnsureF(CCodeZones::FILE_IO, extended_header.max_id >= extended_header.min_id, "Malformed table ID range.");
+        std::size_t n_ids = std::size_t(extended_header.max_id) - extended_header.min_id + 1;
+        offset += n_ids * (sizeof(std::uint32_t) + sizeof(std::uint16_t));
+      }
+    }
+  }
+
+  EnsureF(CCodeZones::FILE_IO, !_record_count || _record_size >= sizeof(std::uint32_t), "Records are too small to hold IDs.");
+  EnsureF(CCodeZones::FILE_IO, offset + std::size_t(_record_count) * _record_size + _string_block_size <= size
+          , "Table is truncated.");
+
+  _records = data + offset;
+  _strings = _records + std::size_t(_record_count) * _record_size;
+
+  BuildIndex();
+}
+
+void DBCTable::BuildIndex()
+{
+  if (!_record_count)
+    return;
+
+  std::uint32_t min_id = std::numeric_limits<std::uint32_t>::max();
+  std::uint32_t max_id = 0;
+
+  for (std::size_t row = 0; row < _record_count; ++row)
+  {
+    std::uint32_t id = ID(row);
+    min_id = std::min(min_id, id);
+    max_id = std::max(max_id, id);
+  }
+
+  std::size_t spread = std::size_t(max_id) - min_id + 1;
+
+  if (spread <= std::size_t(_record_count) * MAX_DENSE_INDEX_SPREAD + 1024)
+  {
+    _min_id = min_id;
+    _dense_index.assign(spread, NO_INDEX_ROW);
+
+    // first record wins on duplicate IDs, same as for the sparse index
+    for (std::size_t row = _record_count; row-- > 0;)
+      _dense_index[ID(row) - min_id] = static_cast<std::uint32_t>(row);
+  }
+  else
+  {
+    _sparse_index.reserve(_record_count);
+
+    for (std::size_t row = 0; row < _record_count; ++row)
+      _sparse_index.emplace_back(ID(row), static_cast<std::uint32_t>(row));
+
+    std::stable_sort(_sparse_index.begin(), _sparse_index.end()
+                     , [](auto const& a, auto const& b) { return a.first < b.first; });
+  }
+}
+
+char const* DBCTable::RawRecord(std::size_t row) const
+{
+  RequireF(CCodeZones::FILE_IO, row < _record_count, "Row out of bounds.");
+  return _records + row * _record_size;
+}
+
+std::uint32_t DBCTable::ID(std::size_t row) const
+{
+  std::uint32_t id;
+  std::memcpy(&id, RawRecord(row), sizeof(std::uint32_t));
+  return id;
+}
+
+std::size_t DBCTable::Row(std::uint32_t id) const
+{
+  if (!_dense_index.empty())
+  {
+    if (id < _min_id || id - _min_id >= _dense_index.size())
+      return NO_ROW;
+
+    std::uint32_t row = _dense_index[id - _min_id];
+    return row == NO_INDEX_ROW ? NO_ROW : row;
+  }
+
+  auto it = std::lower_bound(_sparse_index.begin(), _sparse_index.end(), id
+                             , [](auto const& entry, std::uint32_t value) { return entry.first < value; });
+
+  return it != _sparse_index.end() && it->first == id ? it->second : NO_ROW;
+}
+
+std::string_view DBCTable::String(StringRef ref) const
+{
+  RequireF(CCodeZones::FILE_IO, ref.offset < _string_block_size, "String offset out of bounds.");
+
+  auto begin = _strings + ref.offset;
+  auto end = static_cast<char const*>(std::memchr(begin, '\0', _string_block_size - ref.offset));
+  EnsureF(CCodeZones::FILE_IO, end, "String is not null-terminated.");
+
+  return {begin, static_cast<std::size_t>(end - begin)};
+}
+
+DBCTableWriter::DBCTableWriter(DBCFormat format, std::uint32_t field_count, std::uint32_t record_size)
+: _format(format)
+, _field_count(field_count)
+, _record_size(record_size)
+, _strings(1, '\0')
+{
+  RequireF(CCodeZones::FILE_IO, record_size >= sizeof(std::uint32_t), "Records are too small to hold IDs.");
+  _string_offsets.emplace("", 0);
+}
+
+DBCTableWriter::DBCTableWriter(DBCTable const& table)
+: _format(table.Format())
+, _field_count(static_cast<std::uint32_t>(table.NumFields()))
+, _record_size(static_cast<std::uint32_t>(table.RecordSize()))
+, _table_hash(table.TableHash())
+, _build(table.Build())
+, _locale(table.Locale())
+{
+  RequireF(CCodeZones::FILE_IO, _record_size >= sizeof(std::uint32_t), "Records are too small to hold IDs.");
+
+  if (table.NumRecords())
+    _records.assign(table.RawRecord(0), table.RawRecord(0) + table.NumRecords() * _record_size);
+
+  auto strings = table.StringBlock();
+  _strings.assign(strings.begin(), strings.end());
+
+  // existing offsets must stay valid, so the block is only ever appended to
+  if (_strings.empty() || _strings.back() != '\0')
+    _strings.push_back('\0');
+
+  for (std::size_t offset = 0; offset < _strings.size();)
+  {
+    std::string_view str {_strings.data() + offset};
+    _string_offsets.emplace(str, static_cast<std::uint32_t>(offset));
+    offset += str.size() + 1;
+  }
+}
+
+char* DBCTableWriter::RawRecord(std::size_t row)
+{
+  RequireF(CCodeZones::FILE_IO, row < NumRecords(), "Row out of bounds.");
+  return _records.data() + row * _record_size;
+}
+
+char* DBCTableWriter::AddRawRecord()
+{
+  _records.resize(_records.size() + _record_size, 0);
+  return _records.data() + _records.size() - _record_size;
+}
+
+void DBCTableWriter::RemoveRecord(std::size_t row)
+{
+  RequireF(CCodeZones::FILE_IO, row < NumRecords(), "Row out of bounds.");
+
+  auto begin = _records.begin() + static_cast<std::ptrdiff_t>(row * _record_size);
+  _records.erase(begin, begin + _record_size);
+}
+
+StringRef DBCTableWriter::AddString(std::string_view str)
+{
+  RequireF(CCodeZones::FILE_IO, str.find('\0') == std::string_view::npos, "Strings must not contain null characters.");
+
+  auto [it, inserted] = _string_offsets.emplace(str, static_cast<std::uint32_t>(_strings.size()));
+
+  if (inserted)
+  {
+    _strings.insert(_strings.end(), str.begin(), str.end());
+    _strings.push_back('\0');
+  }
+
+  return StringRef{it->second};
+}
+
+void DBCTableWriter::Write(ByteBuffer& buf) const
+{
+  auto record_count = static_cast<std::uint32_t>(NumRecords());
+  auto string_block_size = static_cast<std::uint32_t>(_strings.size());
+
+  std::vector<char> out;
+  out.reserve(sizeof(DB2Header) + sizeof(DB2ExtendedHeader) + _records.size() + _strings.size());
+
+  if (_format == DBCFormat::WDBC)
+  {
+    Append(out, DBCHeader{WDBC_MAGIC, record_count, _field_count, _record_size, string_block_size});
+  }
+  else
+  {
+    Append(out, DB2Header{WDB2_MAGIC, record_count, _field_count, _record_size, string_block_size
+                          , _table_hash, _build, 0});
+
+    if (_build > DB2_EXTENDED_HEADER_BUILD)
+      Append(out, DB2ExtendedHeader{0, 0, _locale, 0});
+  }
+
+  out.insert(out.end(), _records.begin(), _records.end());
+  out.insert(out.end(), _strings.begin(), _strings.end());
+
+  buf.Write(out.begin(), out.end());
+}
@@ -0,0 +1,269 @@
+#pragma once
+#include <IO/ByteBuffer.hpp>
+#include <IO/DBC/DataStructures.hpp>
+#include <Utils/Meta/Concepts.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace IO::DBC
+{
+  /**
+   * Layout of a client table file.
+   */
+  enum class DBCFormat
+  {
+    WDBC = 0, ///> Classic - WotLK.
+    WDB2 = 1 ///> Cataclysm - MoP.
+  };
+
+  /**
+   * Read-only view of a WDBC or WDB2 table.
+   *
+   * Records and strings are never copied out of the file buffer: rows are viewed in place as record structures
+   * (e.g. the ones generated from codegen/structures definitions into IO/DBC/Records.hpp) and strings
+   * are returned as views into the string block. The first field of every record is its ID, an index from IDs to rows
+   * is built once on construction. Lookups by ID take constant time in tables with densely packed IDs, and
+   * logarithmic time (binary search) in tables whose IDs are spread too thin for a direct index.
+   */
+  class DBCTable
+  {
+  public:
+    /**
+     * Views a table in a buffer, which must outlive the table. To avoid any copies of a file on disk,
+     * pass a borrowed ByteBuffer constructed over mapped file memory.
+     * @param buf Buffer holding the table file.
+     */
+    explicit DBCTable(Common::ByteBuffer const& buf);
+
+    /**
+     * Takes ownership of a buffer and views the table in it.
+     * @param buf Buffer holding the table file.
+     */
+    explicit DBCTable(Common::ByteBuffer&& buf);
+
+    DBCTable(DBCTable&& other) noexcept = default;
+    DBCTable(DBCTable const& other) = delete;
+    DBCTable& operator=(DBCTable const& other) = delete;
+
+    [[nodiscard]]
+    DBCFormat Format() const { return _format; };
+
+    [[nodiscard]]
+    std::size_t NumRecords() const { return _record_count; };
+
+    [[nodiscard]]
+    std::size_t NumFields() const { return _field_count; };
+
+    [[nodiscard]]
+    std::size_t RecordSize() const { return _record_size; };
+
+    /**
+     * @return Client build the table was written by, 0 for WDBC.
+     */
+    [[nodiscard]]
+    std::uint32_t Build() const { return _build; };
+
+    /**
+     * @return Table name hash, 0 for WDBC.
+     */
+    [[nodiscard]]
+    std::uint32_t TableHash() const { return _table_hash; };
+
+    /**
+     * @return Locale of the table, 0 for WDBC and older WDB2.
+     */
+    [[nodiscard]]
+    std::uint32_t Locale() const { return _locale; };
+
+    /**
+     * @param row Row index.
+     * @return Pointer to the first byte of a record.
+     */
+    [[nodiscard]]
+    char const* RawRecord(std::size_t row) const;
+
+    /**
+     * Views a record as a structure matching the table layout.
+     * @tparam T Record structure, size must equal RecordSize().
+     * @param row Row index.
+     * @return Reference to the record within the file buffer.
+     */
+    template<Utils::Meta::Concepts::ImplicitLifetimeType T>
+    [[nodiscard]]
+    T const& Record(std::size_t row) const;
+
+    /**
+     * Views all records as structures matching the table layout.
+     * @tparam T Record structure, size must equal RecordSize().
+     * @return Span over the records within the file buffer.
+     */
+    template<Utils::Meta::Concepts::ImplicitLifetimeType T>
+    [[nodiscard]]
+    std::span<T const> Records() const;
+
+    /**
+     * @param row Row index.
+     * @return ID of the record, i.e. its first field.
+     */
+    [[nodiscard]]
+    std::uint32_t ID(std::size_t row) const;
+
+    /**
+     * Finds the row of a record by ID, in constant time for dense tables and logarithmic time for sparse ones.
+     * @param id Record ID.
+     * @return Row index, or NO_ROW if there is no such record.
+     */
+    [[nodiscard]]
+    std::size_t Row(std::uint32_t id) const;
+
+    /**
+     * Finds a record by ID, in constant time for dense tables and logarithmic time for sparse ones.
+     * @tparam T Record structure, size must equal RecordSize().
+     * @param id Record ID.
+     * @return Pointer to the record within the file buffer, nullptr if there is no such record.
+     */
+    template<Utils::Meta::Concepts::ImplicitLifetimeType T>
+    [[nodiscard]]
+    T const* Find(std::uint32_t id) const;
+
+    /**
+     * @param ref Reference to a string, offset must be within the string block.
+     * @return View of the string within the file buffer.
+     */
+    [[nodiscard]]
+    std::string_view String(DataStructures::StringRef ref) const;
+
+    /**
+     * @return Raw string block.
+     */
+    [[nodiscard]]
+    std::span<char const> StringBlock() const { return {_strings, _string_block_size}; };
+
+    static constexpr std::size_t NO_ROW = std::numeric_limits<std::size_t>::max();
+
+  private:
+    void Parse(char const* data, std::size_t size);
+    void BuildIndex();
+
+    // tables with IDs spread over more than this many slots per record are indexed by binary search instead
+    static constexpr std::size_t MAX_DENSE_INDEX_SPREAD = 4;
+    static constexpr std::uint32_t NO_INDEX_ROW = std::numeric_limits<std::uint32_t>::max();
+
+    Common::ByteBuffer _owned_buf;
+
+    DBCFormat _format = DBCFormat::WDBC;
+    std::uint32_t _record_count = 0;
+    std::uint32_t _field_count = 0;
+    std::uint32_t _record_size = 0;
+    std::uint32_t _string_block_size = 0;
+    std::uint32_t _table_hash = 0;
+    std::uint32_t _build = 0;
+    std::uint32_t _locale = 0;
+
+    char const* _records = nullptr;
+    char const* _strings = nullptr;
+
+    std::uint32_t _min_id = 0;
+    std::vector<std::uint32_t> _dense_index; ///> Row of each ID starting from _min_id, NO_INDEX_ROW if absent.
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> _sparse_index; ///> (ID, row) pairs sorted by ID.
+  };
+
+  /**
+   * Builds a WDBC or WDB2 table, either from scratch or from an existing one to patch it.
+   * Strings added to the table are deduplicated against each other and against strings of the source table.
+   */
+  class DBCTableWriter
+  {
+  public:
+    /**
+     * Starts an empty table.
+     * @param format Layout to write.
+     * @param field_count Number of fields per record.
+     * @param record_size Size of a record in bytes, at least 4 for the ID.
+     */
+    DBCTableWriter(DBCFormat format, std::uint32_t field_count, std::uint32_t record_size);
+
+    /**
+     * Copies a table for patching, keeping its layout and header values.
+     * @param table Source table.
+     */
+    explicit DBCTableWriter(DBCTable const& table);
+
+    [[nodiscard]]
+    std::size_t NumRecords() const { return _records.size() / _record_size; };
+
+    [[nodiscard]]
+    std::size_t RecordSize() const { return _record_size; };
+
+    /**
+     * @param row Row index.
+     * @return Pointer to the first byte of a record. Invalidated by adding records.
+     */
+    [[nodiscard]]
+    char* RawRecord(std::size_t row);
+
+    /**
+     * @tparam T Record structure, size must equal RecordSize().
+     * @param row Row index.
+     * @return Reference to the record. Invalidated by adding records.
+     */
+    template<Utils::Meta::Concepts::ImplicitLifetimeType T>
+    [[nodiscard]]
+    T& Record(std::size_t row);
+
+    /**
+     * Appends a zero-filled record.
+     * @return Pointer to the first byte of the record. Invalidated by adding records.
+     */
+    char* AddRawRecord();
+
+    /**
+     * Appends a record.
+     * @tparam T Record structure, size must equal RecordSize().
+     * @param record Record to add.
+     * @return Reference to the added record. Invalidated by adding records.
+     */
+    template<Utils::Meta::Concepts::ImplicitLifetimeType T>
+    T& AddRecord(T const& record);
+
+    /**
+     * Removes a record, shifting the following ones.
+     * @param row Row index.
+     */
+    void RemoveRecord(std::size_t row);
+
+    /**
+     * Adds a string to the string block, or finds an identical one.
+     * @param str String to add, must not contain null characters.
+     * @return Reference to the string.
+     */
+    DataStructures::StringRef AddString(std::string_view str);
+
+    /**
+     * Writes the table. WDB2 tables are written without the optional ID index following the extended header.
+     * @param buf Buffer to write to.
+     */
+    void Write(Common::ByteBuffer& buf) const;
+
+  private:
+    DBCFormat _format;
+    std::uint32_t _field_count;
+    std::uint32_t _record_size;
+    std::uint32_t _table_hash = 0;
+    std::uint32_t _build = 0;
+    std::uint32_t _locale = 0;
+
+    std::vector<char> _records;
+    std::vector<char> _strings;
+    std::unordered_map<std::string, std::uint32_t> _string_offsets;
+  };
+}
+
+#include <IO/DBC/DBCTable.inl>
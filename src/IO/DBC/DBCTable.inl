@@ -0,0 +1,46 @@
+#pragma once
+#include <IO/DBC/DBCTable.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <cstring>
+
+namespace IO::DBC
+{
+  template<Utils::Meta::Concepts::ImplicitLifetimeType T>
+  T const& DBCTable::Record(std::size_t row) const
+  {
+    RequireF(CCodeZones::FILE_IO, sizeof(T) == _record_size, "Record structure does not match table layout.");
+    return *reinterpret_cast<T const*>(RawRecord(row));
+  }
+
+  template<Utils::Meta::Concepts::ImplicitLifetimeType T>
+  std::span<T const> DBCTable::Records() const
+  {
+    RequireF(CCodeZones::FILE_IO, sizeof(T) == _record_size, "Record structure does not match table layout.");
+    return {reinterpret_cast<T const*>(_records), _record_count};
+  }
+
+  template<Utils::Meta::Concepts::ImplicitLifetimeType T>
+  T const* DBCTable::Find(std::uint32_t id) const
+  {
+    std::size_t row = Row(id);
+    return row == NO_ROW ? nullptr : &Record<T>(row);
+  }
+
+  template<Utils::Meta::Concepts::ImplicitLifetimeType T>
+  T& DBCTableWriter::Record(std::size_t row)
+  {
+    RequireF(CCodeZones::FILE_IO, sizeof(T) == _record_size, "Record structure does not match table layout.");
+    return *reinterpret_cast<T*>(RawRecord(row));
+  }
+
+  template<Utils::Meta::Concepts::ImplicitLifetimeType T>
+  T& DBCTableWriter::AddRecord(T const& record)
+  {
+    RequireF(CCodeZones::FILE_IO, sizeof(T) == _record_size, "Record structure does not match table layout.");
+    char* data = AddRawRecord();
+    std::memcpy(data, &record, sizeof(T));
+    return *reinterpret_cast<T*>(data);
+  }
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+
+namespace IO::DBC::DataStructures
+{
+  /**
+   * Reference to a null-terminated string in the string block of a table, stored as a byte offset.
+   */
+  struct StringRef
+  {
+    std::uint32_t offset;
+  };
+
+  /**
+   * Header of WDBC tables (Classic - WotLK).
+   */
+  struct DBCHeader
+  {
+    std::uint32_t magic;
+    std::uint32_t record_count;
+    std::uint32_t field_count;
+    std::uint32_t record_size;
+    std::uint32_t string_block_size;
+  };
+
+  /**
+   * Header of WDB2 tables (Cataclysm - MoP).
+   */
+  struct DB2Header
+  {
+    std::uint32_t magic;
+    std::uint32_t record_count;
+    std::uint32_t field_count;
+    std::uint32_t record_size;
+    std::uint32_t string_block_size;
+    std::uint32_t table_hash;
+    std::uint32_t build;
+    std::uint32_t timestamp_last_written;
+  };
+
+  /**
+   * Extension of the WDB2 header present in builds newer than DB2_EXTENDED_HEADER_BUILD.
+   * If max_id is not 0, it is followed by an index of (max_id - min_id + 1) uint32 and as many uint16 string lengths.
+   */
+  struct DB2ExtendedHeader
+  {
+    std::uint32_t min_id;
+    std::uint32_t max_id;
+    std::uint32_t locale;
+    std::uint32_t copy_table_size;
+  };
+
+  constexpr std::uint32_t DB2_EXTENDED_HEADER_BUILD = 12880;
+}
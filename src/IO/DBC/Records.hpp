@@ -0,0 +1,42 @@
+/*
+This file is autogenerated by codegen script. Do not edit manually, changes will be overriden.
+Structures are defined in Python files under "/codegen/structures/definitions/".
+*/
+#pragma once
+#include <IO/Common.hpp>
+#include <Utils/Meta/Reflection.hpp>
+#include <IO/DBC/DataStructures.hpp>
+#include <cstdint>
+
+namespace IO::DBC::DataStructures
+{
+
+/**
+* Record of LightSkybox.dbc (WotLK - MoP).
+* View rows with IO::DBC::DBCTable::Record<LightSkyboxRec>(row) or Find<LightSkyboxRec>(id).
+**/
+struct LightSkyboxRec{
+  std::uint32_t id; ///> Record ID.
+  IO::DBC::DataStructures::StringRef name; ///> Path to skybox model, empty string by default.
+  std::uint32_t flags; ///> Skybox flags.
+
+  static LightSkyboxRec New()
+  {
+    return 
+    {
+      .id = 0, 
+      .name = { 0 }, 
+      .flags = 0
+    };
+  }
+};
+
+} // namespace IO::DBC::DataStructures
+
+REFLECTION_DESCRIPTOR(
+  IO::DBC::DataStructures::LightSkyboxRec
+, id  
+, name  
+, flags
+);
+
@@ -0,0 +1,463 @@
+#include <IO/Storage/ClientExtractor.hpp>
+#include <Utils/PathUtils.hpp>
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+using namespace IO::Storage;
+namespace fs = std::filesystem;
+
+namespace
+{
+  struct ExtractedFile
+  {
+    std::uint32_t file_data_id;
+    std::string filepath; ///> Relative to output directory.
+  };
+
+  struct ManifestRecord
+  {
+    std::uint64_t size = 0;
+    std::uint64_t hash = 0;
+  };
+
+  struct PendingFile
+  {
+    std::size_t index;
+    IO::Common::ByteBuffer data;
+  };
+
+  constexpr std::uint64_t HASH_SEED = 14695981039346656037ull;
+
+  // 64-bit FNV-1a, continues from hash for data read in parts
+  std::uint64_t HashData(char const* data, std::size_t size, std::uint64_t hash = HASH_SEED)
+  {
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      hash ^= static_cast<std::uint8_t>(data[i]);
+      hash *= 1099511628211ull;
+    }
+
+    return hash;
+  }
+
+  /**
+   * @return Hash of the file on disk, or nothing if it can't be read.
+   */
+  std::optional<std::uint64_t> HashFile(fs::path const& path)
+  {
+    std::ifstream stream(path, std::ios::binary);
+
+    if (!stream.is_open())
+      return std::nullopt;
+
+    std::uint64_t hash = HASH_SEED;
+    std::vector<char> buf (64 * 1024);
+
+    while (stream)
+    {
+      stream.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+      hash = HashData(buf.data(), static_cast<std::size_t>(stream.gcount()), hash);
+    }
+
+    if (stream.bad())
+      return std::nullopt;
+
+    return hash;
+  }
+
+  std::unordered_map<std::string, ManifestRecord> LoadManifest(fs::path const& path)
+  {
+    std::unordered_map<std::string, ManifestRecord> manifest;
+    std::ifstream stream(path);
+    std::string line;
+
+    // size;hash;filepath, later records override earlier ones
+    while (std::getline(stream, line))
+    {
+      auto const size_end = line.find(';');
+      auto const hash_end = line.find(';', size_end == std::string::npos ? size_end : size_end + 1);
+
+      if (hash_end == std::string::npos)
+        continue;
+
+      ManifestRecord record;
+      auto const size_result = std::from_chars(line.data(), line.data() + size_end, record.size);
+      auto const hash_result = std::from_chars(line.data() + size_end + 1, line.data() + hash_end, record.hash, 16);
+
+      if (size_result.ec != std::errc() || hash_result.ec != std::errc())
+        continue;
+
+      manifest[line.substr(hash_end + 1)] = record;
+    }
+
+    return manifest;
+  }
+
+  void WriteManifestRecord(std::ostream& stream, std::string const& filepath, ManifestRecord const& record)
+  {
+    char buf[48];
+    auto end = std::to_chars(buf, buf + sizeof(buf), record.size).ptr;
+    *end++ = ';';
+    end = std::to_chars(end, buf + sizeof(buf), record.hash, 16).ptr;
+    *end++ = ';';
+
+    stream.write(buf, end - buf);
+    stream << filepath << '\n';
+  }
+
+  /**
+   * Replaces the manifest with one record per file, sorted by filepath. Written next to it and renamed over it,
+   * so that an interruption leaves either manifest intact.
+   */
+  void CompactManifest(fs::path const& path, std::map<std::string, ManifestRecord> const& records)
+  {
+    fs::path const compacted_path = fs::path(path).concat(".tmp");
+
+    {
+      std::ofstream stream(compacted_path, std::ios::binary | std::ios::trunc);
+
+      for (auto const& [filepath, record] : records)
+        WriteManifestRecord(stream, filepath, record);
+
+      if (!stream)
+      {
+        LogError("Compacting extraction manifest failed.");
+        return;
+      }
+    }
+
+    fs::rename(compacted_path, path);
+  }
+
+  /**
+   * Queue of files read, but not written yet. Holds up to max_bytes of data, or a single file larger than that.
+   */
+  class PendingFileQueue
+  {
+  public:
+    explicit PendingFileQueue(std::size_t max_bytes) : _max_bytes(max_bytes) {};
+
+    /**
+     * Blocks until the file fits into the budget.
+     * @return False if the queue was aborted.
+     */
+    bool Push(PendingFile&& file)
+    {
+      std::unique_lock lock(_mutex);
+      _not_full.wait(lock, [&]{ return _aborted || _files.empty() || _n_bytes + file.data.Size() <= _max_bytes; });
+
+      if (_aborted)
+        return false;
+
+      _n_bytes += file.data.Size();
+      _files.push_back(std::move(file));
+      _not_empty.notify_one();
+
+      return true;
+    }
+
+    /**
+     * Blocks until a file is available.
+     * @return File, or nothing once the queue is closed and drained, or aborted.
+     */
+    std::optional<PendingFile> Pop()
+    {
+      std::unique_lock lock(_mutex);
+      _not_empty.wait(lock, [&]{ return _aborted || _closed || !_files.empty(); });
+
+      if (_aborted || _files.empty())
+        return std::nullopt;
+
+      std::optional<PendingFile> file {std::move(_files.front())};
+      _files.pop_front();
+      _n_bytes -= file->data.Size();
+
+      // readers wait for different amounts of space
+      _not_full.notify_all();
+
+      return file;
+    }
+
+    void Close()
+    {
+      std::lock_guard lock(_mutex);
+      _closed = true;
+      _not_empty.notify_all();
+    }
+
+    void Abort()
+    {
+      std::lock_guard lock(_mutex);
+      _aborted = true;
+      _not_empty.notify_all();
+      _not_full.notify_all();
+    }
+
+  private:
+    std::mutex _mutex;
+    std::condition_variable _not_full;
+    std::condition_variable _not_empty;
+    std::deque<PendingFile> _files;
+    std::size_t _n_bytes = 0;
+    std::size_t const _max_bytes;
+    bool _closed = false;
+    bool _aborted = false;
+  };
+}
+
+bool ExtractionFilter::Matches(std::string_view filepath) const
+{
+  auto const matches_prefix = [&](std::string const& prefix)
+  {
+    return filepath.starts_with(Utils::PathUtils::NormalizeFilepathGame(prefix));
+  };
+
+  auto const matches_extension = [&](std::string const& extension)
+  {
+    return filepath.ends_with(Utils::PathUtils::NormalizeFilepathGame(extension));
+  };
+
+  return (prefixes.empty() || std::any_of(prefixes.begin(), prefixes.end(), matches_prefix))
+    && (extensions.empty() || std::any_of(extensions.begin(), extensions.end(), matches_extension));
+}
+
+ClientExtractor::ClientExtractor(ClientStorage& storage)
+: _readers({&storage})
+{
+}
+
+void ClientExtractor::AddReader(ClientStorage& storage)
+{
+  RequireF(CCodeZones::STORAGE, storage.ClientVersion() == _readers.front()->ClientVersion()
+           , "Reader storage is opened on a different client version.");
+
+  _readers.push_back(&storage);
+}
+
+ExtractionStats ClientExtractor::Extract(std::string const& output_path, ExtractionSettings const& settings)
+{
+  fs::path const output_dir = Utils::PathUtils::NormalizeFilepathUnix(output_path);
+  fs::create_directories(output_dir);
+
+  ExtractionStats stats;
+
+  auto const manifest_path = output_dir / MANIFEST_FILENAME;
+  auto const manifest = LoadManifest(manifest_path);
+
+  std::vector<ExtractedFile> files;
+
+  for (auto& [file_data_id, filepath] : _readers.front()->Listfile().Entries())
+  {
+    if (!settings.filter.Matches(filepath))
+      continue;
+
+    std::string output_filepath = Utils::PathUtils::NormalizeFilepathUnixLower(filepath);
+
+    if (settings.trust_manifest)
+    {
+      auto it = manifest.find(output_filepath);
+      std::error_code error;
+
+      if (it != manifest.end() && fs::file_size(output_dir / output_filepath, error) == it->second.size && !error)
+      {
+        ++stats.n_trusted;
+        continue;
+      }
+    }
+
+    files.push_back({file_data_id, std::move(output_filepath)});
+  }
+
+  Log("Extracting %d files with %d readers.", files.size(), _readers.size());
+
+  // directories are created once up front, instead of checking them for every file
+  {
+    std::set<fs::path> dirs;
+
+    for (ExtractedFile const& file : files)
+      dirs.insert(fs::path(file.filepath).parent_path());
+
+    for (fs::path const& dir : dirs)
+      fs::create_directories(output_dir / dir);
+  }
+
+  std::ofstream manifest_stream(manifest_path, std::ios::binary | std::ios::app);
+  std::mutex manifest_mutex;
+  std::size_t n_unflushed_records = 0;
+
+  // extracted copies known to match after this run, by index of file
+  std::vector<std::pair<std::size_t, ManifestRecord>> records;
+
+  PendingFileQueue queue (settings.max_pending_bytes);
+
+  std::atomic<std::size_t> next_file = 0;
+  std::atomic<std::size_t> n_active_readers = _readers.size();
+  std::atomic<std::size_t> n_failed = 0;
+  std::exception_ptr first_exception = nullptr;
+  std::mutex exception_mutex;
+
+  auto fail = [&]()
+  {
+    std::lock_guard lock {exception_mutex};
+
+    if (!first_exception)
+      first_exception = std::current_exception();
+
+    queue.Abort();
+  };
+
+  auto reader = [&](ClientStorage& storage)
+  {
+    try
+    {
+      for (std::size_t i = next_file++; i < files.size(); i = next_file++)
+      {
+        FileKey const file_key {storage, files[i].file_data_id, FileKey::FileExistPolicy::WEAK};
+        Common::ByteBuffer data;
+
+        if (file_key.Read(data) != FileKey::FileReadStatus::SUCCESS)
+        {
+          LogError("Reading file \"%s\" failed.", file_key.FilePath().c_str());
+          ++n_failed;
+          continue;
+        }
+
+        if (!queue.Push({i, std::move(data)}))
+          break;
+      }
+    }
+    catch (...)
+    {
+      fail();
+    }
+
+    if (!--n_active_readers)
+      queue.Close();
+  };
+
+  auto writer = [&](ExtractionStats& writer_stats)
+  {
+    try
+    {
+      while (auto pending = queue.Pop())
+      {
+        ExtractedFile const& file = files[pending->index];
+        fs::path const filepath = output_dir / file.filepath;
+
+        ManifestRecord const record {pending->data.Size(), HashData(pending->data.Data(), pending->data.Size())};
+
+        auto const recorded = manifest.find(file.filepath);
+        bool const is_recorded = recorded != manifest.end()
+          && recorded->second.size == record.size && recorded->second.hash == record.hash;
+
+        // the extracted copy may have been modified or replaced since it was recorded, so its content is compared
+        std::error_code error;
+        bool const is_unchanged = fs::file_size(filepath, error) == record.size && !error
+          && HashFile(filepath) == record.hash;
+
+        if (is_unchanged)
+          ++writer_stats.n_unchanged;
+
+        if (is_unchanged && is_recorded)
+        {
+          std::lock_guard lock {manifest_mutex};
+          records.emplace_back(pending->index, record);
+          continue;
+        }
+
+        if (!is_unchanged)
+        {
+          std::fstream strm {filepath, std::fstream::binary | std::fstream::out | std::fstream::trunc};
+
+          if (!strm.is_open())
+          {
+            LogError("Writing file \"%s\" failed. Unknown OS error.", filepath.string().c_str());
+            ++writer_stats.n_failed;
+            continue;
+          }
+
+          pending->data.Flush(strm);
+
+          ++writer_stats.n_written;
+          writer_stats.n_bytes_written += record.size;
+        }
+
+        std::lock_guard lock {manifest_mutex};
+        records.emplace_back(pending->index, record);
+        WriteManifestRecord(manifest_stream, file.filepath, record);
+
+        // keep the manifest close to the files on disk, so that an interrupted run resumes where it stopped
+        if (++n_unflushed_records >= 256)
+        {
+          manifest_stream.flush();
+          n_unflushed_records = 0;
+        }
+      }
+    }
+    catch (...)
+    {
+      fail();
+    }
+  };
+
+  unsigned n_writers = settings.n_write_threads ? settings.n_write_threads
+    : std::max(1u, std::thread::hardware_concurrency());
+
+  std::vector<ExtractionStats> writer_stats (n_writers);
+
+  {
+    std::vector<std::jthread> threads;
+    threads.reserve(_readers.size() + n_writers);
+
+    for (ClientStorage* storage : _readers)
+      threads.emplace_back(reader, std::ref(*storage));
+
+    for (ExtractionStats& thread_stats : writer_stats)
+      threads.emplace_back(writer, std::ref(thread_stats));
+  }
+
+  manifest_stream.close();
+
+  if (first_exception)
+    std::rethrow_exception(first_exception);
+
+  // records of earlier runs superseded by this one are dropped, records of files not read in this run are kept
+  {
+    std::map<std::string, ManifestRecord> compacted (manifest.begin(), manifest.end());
+
+    for (auto const& [index, record] : records)
+      compacted[files[index].filepath] = record;
+
+    CompactManifest(manifest_path, compacted);
+  }
+
+  for (ExtractionStats const& thread_stats : writer_stats)
+  {
+    stats.n_written += thread_stats.n_written;
+    stats.n_unchanged += thread_stats.n_unchanged;
+    stats.n_failed += thread_stats.n_failed;
+    stats.n_bytes_written += thread_stats.n_bytes_written;
+  }
+
+  stats.n_failed += n_failed;
+
+  Log("Extraction finished. Written: %d, unchanged: %d, failed: %d.", stats.n_written, stats.n_unchanged, stats.n_failed);
+
+  return stats;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <IO/Storage/ClientStorage.hpp>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace IO::Storage
+{
+  /**
+   * Selects files to extract. A file is extracted if it matches any of the prefixes and any of the extensions.
+   */
+  struct ExtractionFilter
+  {
+    std::vector<std::string> prefixes; ///> Filepath prefixes, any case or separator. Empty means all files.
+    std::vector<std::string> extensions; ///> Extensions including the dot, e.g. ".adt". Empty means all files.
+
+    /**
+     * @param filepath Game format filepath.
+     * @return True if the file is selected.
+     */
+    [[nodiscard]]
+    bool Matches(std::string_view filepath) const;
+  };
+
+  struct ExtractionSettings
+  {
+    ExtractionFilter filter;
+    std::size_t max_pending_bytes = 256 * 1024 * 1024; ///> Memory budget of files read, but not written yet.
+    unsigned n_write_threads = 0; ///> Number of threads hashing and writing files. 0 means hardware concurrency.
+
+    /**
+     * Skip files recorded in the manifest without reading them from the client, as long as the extracted copy
+     * still has the recorded size. Makes resuming an interrupted extraction cheap, but misses client updates.
+     */
+    bool trust_manifest = false;
+  };
+
+  struct ExtractionStats
+  {
+    std::size_t n_written = 0; ///> Files written to disk.
+    std::size_t n_unchanged = 0; ///> Files read, but matching their extracted copy.
+    std::size_t n_trusted = 0; ///> Files skipped by the manifest without reading.
+    std::size_t n_failed = 0; ///> Files failed to be read or written.
+    std::uint64_t n_bytes_written = 0;
+  };
+
+  /**
+   * Extracts files of a client storage into a directory tree, as seen by the storage: MPQ patch order,
+   * CASC locale and overlay layers apply the same way as for FileKey::Read().
+   *
+   * Reading and writing are pipelined: reader threads feed a queue bounded by memory budget, writer threads
+   * hash and write files. Archive handles are not thread-safe, so each reader owns one storage. Parallel archive
+   * reads require additional storages opened on the same client, see AddReader().
+   *
+   * Extracted files are recorded (size and hash) in a manifest in the output directory, appended to as files
+   * complete and compacted to one record per file when a run finishes. A later run, e.g. after an interruption
+   * or client update, rewrites only files whose extracted copy differs. Copies of the same size are hashed,
+   * so files modified on disk are restored as well.
+   */
+  class ClientExtractor
+  {
+  public:
+    /**
+     * @param storage Storage to extract files from. Its listfile determines files to extract.
+     */
+    explicit ClientExtractor(ClientStorage& storage);
+
+    /**
+     * Adds a storage opened on the same client with the same listfile, read from by a separate thread.
+     * @param storage Client storage.
+     */
+    void AddReader(ClientStorage& storage);
+
+    /**
+     * Extracts files selected by the filter. Failures of individual files are logged and counted.
+     * @param output_path Output directory, created if missing.
+     * @param settings Extraction settings.
+     * @return Extraction statistics.
+     * @throws std::filesystem::filesystem_error Thrown if output directories can't be created.
+     */
+    ExtractionStats Extract(std::string const& output_path, ExtractionSettings const& settings);
+
+    static constexpr std::string_view MANIFEST_FILENAME = ".extract_manifest";
+
+  private:
+    std::vector<ClientStorage*> _readers;
+  };
+}
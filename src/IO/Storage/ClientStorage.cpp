@@ -4,12 +4,24 @@
 #include <IO/Storage/ClientLoaders/CASCLoader.hpp>
 #include <Utils/PathUtils.hpp>
 
+#include <bit>
+#include <mutex>
 #include <system_error>
 #include <fstream>
 
 using namespace IO::Storage;
 namespace fs = std::filesystem;
 
+namespace
+{
+  constexpr std::string_view WHITEOUT_PREFIX = ".wh.";
+
+  fs::path WhiteoutPath(fs::path const& filepath)
+  {
+    return filepath.parent_path() / (std::string(WHITEOUT_PREFIX) + filepath.filename().string());
+  }
+}
+
 ClientStorage::ClientStorage(std::string const& path
                              , std::string const& project_path
                              , Common::ClientVersion client_version
@@ -29,6 +41,9 @@ ClientStorage::ClientStorage(std::string const& path
     fs::create_directories(project_path);
   }
 
+  _layers.push_back(_project_path);
+  RefreshLayers();
+
   Log("Initializing MPQ storage...");
   switch (client_version)
   {
@@ -65,6 +80,9 @@ ClientStorage::ClientStorage(std::string const& path
   RequireF(CCodeZones::STORAGE, client_version >= Common::ClientVersion::WOD
            , "This contructor can be used for CASC-based clients only.");
 
+  _layers.push_back(_project_path);
+  RefreshLayers();
+
   _loader = std::make_unique<ClientLoaders::CASCLoader>(*this, product);
   _listfile = Storage::ListfileManager((fs::path(project_path) / "listfile.csv").string());
 }
@@ -84,20 +102,192 @@ ClientStorage::ClientStorage(std::string const& cdn_url
   RequireF(CCodeZones::STORAGE, client_version >= Common::ClientVersion::WOD
            , "This contructor can be used for CASC-based clients only.");
 
+  _layers.push_back(_project_path);
+  RefreshLayers();
+
   _loader = std::make_unique<ClientLoaders::CASCLoader>(*this, std::optional{_path.string()}
                                                         , product, region);
   _listfile = Storage::ListfileManager((fs::path(project_path) / "listfile.csv").string());
 }
 
+ClientStorage::ClientStorage(std::string const& project_path
+                             , IO::Common::ClientVersion client_version
+                             , Common::ByteBuffer const& listfile)
+: _project_path(Utils::PathUtils::NormalizeFilepathUnix(project_path))
+, _locale(Common::ClientLocale::AUTO)
+, _client_version(client_version)
+{
+  if (!fs::exists(_project_path))
+  {
+    fs::create_directories(_project_path);
+  }
+
+  _layers.push_back(_project_path);
+  RefreshLayers();
+
+  // a loader without archives, i.e. a client holding no files
+  _loader = std::make_unique<ClientLoaders::BaseLoader>(*this);
+  _listfile = Storage::ListfileManager(listfile);
+}
+
+std::size_t ClientStorage::AddLayer(std::string const& path)
+{
+  fs::path layer_path = Utils::PathUtils::NormalizeFilepathUnix(path);
+
+  if (!fs::exists(layer_path))
+  {
+    fs::create_directories(layer_path);
+  }
+
+  std::unique_lock lock(_layer_index_mutex);
+
+  RequireF(CCodeZones::STORAGE, _layers.size() < MAX_LAYERS, "Too many storage layers.");
+
+  _layers.push_back(std::move(layer_path));
+  IndexLayer(_layers.size() - 1);
+
+  return _layers.size() - 1;
+}
+
+std::size_t ClientStorage::NumLayers() const
+{
+  std::shared_lock lock(_layer_index_mutex);
+  return _layers.size();
+}
+
+fs::path ClientStorage::LayerPath(std::size_t layer) const
+{
+  std::shared_lock lock(_layer_index_mutex);
+
+  RequireF(CCodeZones::STORAGE, layer < _layers.size(), "Layer index out of bounds.");
+  return _layers[layer];
+}
+
+void ClientStorage::SetWriteLayer(std::size_t layer)
+{
+  std::shared_lock lock(_layer_index_mutex);
+
+  RequireF(CCodeZones::STORAGE, layer < _layers.size(), "Layer index out of bounds.");
+  _write_layer.store(layer, std::memory_order_relaxed);
+}
+
+std::size_t ClientStorage::FindLayer(FileKey const& file_key) const
+{
+  return FindLayer(file_key.FilePath());
+}
+
+std::size_t ClientStorage::FindLayer(std::string const& filepath) const
+{
+  std::string const key = Utils::PathUtils::NormalizeFilepathUnixLower(filepath);
+
+  std::shared_lock lock(_layer_index_mutex);
+
+  auto it = _layer_index.find(key);
+
+  if (it == _layer_index.end())
+    return NO_LAYER;
+
+  std::size_t const layer = TopLayer(it->second);
+
+  return (it->second.files >> layer) & 1 ? layer : NO_LAYER;
+}
+
+void ClientStorage::RefreshLayers()
+{
+  std::unique_lock lock(_layer_index_mutex);
+
+  _layer_index.clear();
+
+  for (std::size_t i = 0; i < _layers.size(); ++i)
+    IndexLayer(i);
+
+  LogDebugF(LCodeZones::FILE_IO, "Indexed %d files in %d storage layers.", _layer_index.size(), _layers.size());
+}
+
+void ClientStorage::IndexLayer(std::size_t layer)
+{
+  fs::path const& layer_path = _layers[layer];
+  std::uint64_t const bit = std::uint64_t(1) << layer;
+
+  std::error_code error;
+  fs::recursive_directory_iterator it(layer_path, fs::directory_options::skip_permission_denied, error);
+
+  if (error)
+    return;
+
+  for (; it != fs::recursive_directory_iterator(); it.increment(error))
+  {
+    if (error)
+    {
+      LogError("Indexing storage layer \"%s\" failed. msg: %s.", layer_path.string().c_str(), error.message().c_str());
+      return;
+    }
+
+    if (!it->is_regular_file())
+      continue;
+
+    fs::path filepath = it->path().lexically_relative(layer_path);
+    std::string const filename = filepath.filename().string();
+
+    bool const whiteout = filename.starts_with(WHITEOUT_PREFIX);
+
+    if (whiteout)
+    {
+      filepath.replace_filename(filename.substr(WHITEOUT_PREFIX.size()));
+    }
+
+    std::string relative_path = filepath.generic_string();
+    LayerEntry& entry = _layer_index[Utils::PathUtils::NormalizeFilepathUnixLower(relative_path)];
+
+    // layers are indexed bottom to top, so the spelling of the top-most one wins
+    entry.path = std::move(relative_path);
+    (whiteout ? entry.whiteouts : entry.files) |= bit;
+  }
+}
+
+std::size_t ClientStorage::TopLayer(LayerEntry const& entry)
+{
+  std::uint64_t const layers = entry.files | entry.whiteouts;
+  return layers ? static_cast<std::size_t>(std::bit_width(layers)) - 1 : NO_LAYER;
+}
+
+std::string ClientStorage::LayerKey(FileKey const& file_key)
+{
+  return Utils::PathUtils::NormalizeFilepathUnixLower(file_key.FilePath());
+}
 
 FileKey::FileReadStatus ClientStorage::ReadFile(FileKey const& file_key, Common::ByteBuffer& buf) const
 {
-  fs::path filepath = _project_path / Utils::PathUtils::NormalizeFilepathUnixLower(file_key.FilePath());
+  std::string const key = LayerKey(file_key);
+  fs::path filepath;
 
-  // first try to read from project directory
-  if (fs::exists(filepath))
   {
-    std::uintmax_t size = fs::file_size(filepath);
+    std::shared_lock lock(_layer_index_mutex);
+
+    if (auto it = _layer_index.find(key); it != _layer_index.end())
+    {
+      std::size_t const layer = TopLayer(it->second);
+
+      // hidden by a whiteout, lower layers and the client are not consulted
+      if (!((it->second.files >> layer) & 1))
+      {
+        return FileKey::FileReadStatus::FILE_NOT_FOUND;
+      }
+
+      filepath = _layers[layer] / it->second.path;
+    }
+  }
+
+  // first try to read from the top-most layer holding the file
+  if (!filepath.empty())
+  {
+    std::error_code error;
+    std::uintmax_t size = fs::file_size(filepath, error);
+
+    if (error)
+    {
+      return FileKey::FileReadStatus::FILE_OPEN_FAILED_OS;
+    }
 
     EnsureF(CCodeZones::STORAGE, size <= std::numeric_limits<std::uint32_t>::max(), "Invalid filesize.");
 
@@ -122,8 +312,18 @@ FileKey::FileReadStatus ClientStorage::ReadFile(FileKey const& file_key, Common:
 
 FileKey::FileWriteStatus ClientStorage::WriteFile(FileKey const& file_key, Common::ByteBuffer const& buf) const
 {
-  fs::path filepath = _project_path / Utils::PathUtils::NormalizeFilepathUnixLower(file_key.FilePath());
-  fs::path dir_path = filepath.remove_filename();
+  std::string const key = LayerKey(file_key);
+  std::size_t const layer = _write_layer.load(std::memory_order_relaxed);
+  std::uint64_t const bit = std::uint64_t(1) << layer;
+
+  // writes of one file are serialized from file IO until published, see WriteMutex(). File IO runs under the shared
+  // lock, the index is locked exclusively only to publish the result
+  std::lock_guard write_lock(WriteMutex(key));
+  std::shared_lock lock(_layer_index_mutex);
+
+  LayerEntry entry = IndexedEntry(key, file_key);
+  fs::path const filepath = _layers[layer] / entry.path;
+  fs::path const dir_path = filepath.parent_path();
 
   std::error_code error;
   fs::create_directories(dir_path, error);
@@ -135,19 +335,125 @@ FileKey::FileWriteStatus ClientStorage::WriteFile(FileKey const& file_key, Commo
     return FileKey::FileWriteStatus::FILE_WRITE_FAILED;
   }
 
-  std::fstream strm{filepath, std::fstream::binary | std::fstream::out | std::fstream::trunc};
+  {
+    std::fstream strm{filepath, std::fstream::binary | std::fstream::out | std::fstream::trunc};
+
+    if (!strm.is_open())
+    {
+      LogError("Writing file \"%s\" failed. Unknown OS error.", filepath.string().c_str());
+      return FileKey::FileWriteStatus::FILE_WRITE_FAILED;
+    }
+
+    buf.Flush(strm);
+  }
 
-  if (!strm.is_open())
+  if (entry.whiteouts & bit)
   {
-    LogError("Writing file \"%s\" failed. Unknown OS error.", filepath.string().c_str());
-    return FileKey::FileWriteStatus::FILE_WRITE_FAILED;
+    fs::remove(WhiteoutPath(filepath), error);
   }
 
-  buf.Flush(strm);
+  lock.unlock();
+
+  std::unique_lock index_lock(_layer_index_mutex);
+  LayerEntry& indexed = _layer_index[key];
+
+  if (indexed.path.empty())
+  {
+    indexed.path = std::move(entry.path);
+  }
+
+  indexed.whiteouts &= ~bit;
+  indexed.files |= bit;
 
   return FileKey::FileWriteStatus::SUCCESS;
 }
 
+FileKey::FileWriteStatus ClientStorage::RemoveFile(FileKey const& file_key) const
+{
+  std::string const key = LayerKey(file_key);
+  std::size_t const layer = _write_layer.load(std::memory_order_relaxed);
+  std::uint64_t const bit = std::uint64_t(1) << layer;
+
+  std::lock_guard write_lock(WriteMutex(key));
+  std::shared_lock lock(_layer_index_mutex);
+
+  LayerEntry entry = IndexedEntry(key, file_key);
+  fs::path const filepath = _layers[layer] / entry.path;
+
+  std::error_code error;
+  fs::remove(filepath, error);
+
+  if (error)
+  {
+    LogError("Removing file \"%s\" failed. OS error code: %d. msg: %s.", filepath.string().c_str(), error.value(), error
+        .message().c_str());
+    return FileKey::FileWriteStatus::FILE_WRITE_FAILED;
+  }
+
+  FileKey::FileWriteStatus status = FileKey::FileWriteStatus::SUCCESS;
+
+  if (!(entry.whiteouts & bit))
+  {
+    // the file is still visible if the top-most lower layer holds it, or if no lower layer mentions it and the client does
+    std::size_t const lower_layer = TopLayer({entry.files & (bit - 1), entry.whiteouts & (bit - 1), {}});
+    bool const visible = lower_layer != NO_LAYER ? (entry.files >> lower_layer) & 1 : _loader->Exists(file_key);
+
+    if (visible)
+    {
+      fs::path const whiteout_path = WhiteoutPath(filepath);
+      fs::create_directories(whiteout_path.parent_path(), error);
+
+      std::fstream strm{whiteout_path, std::fstream::binary | std::fstream::out | std::fstream::trunc};
+
+      if (error || !strm.is_open())
+      {
+        LogError("Writing whiteout \"%s\" failed.", whiteout_path.string().c_str());
+        status = FileKey::FileWriteStatus::FILE_WRITE_FAILED;
+      }
+      else
+      {
+        entry.whiteouts |= bit;
+      }
+    }
+  }
+
+  lock.unlock();
+
+  // the file is gone from the write layer even if placing its whiteout failed
+  std::unique_lock index_lock(_layer_index_mutex);
+  LayerEntry& indexed = _layer_index[key];
+
+  if (indexed.path.empty())
+  {
+    indexed.path = std::move(entry.path);
+  }
+
+  indexed.files &= ~bit;
+  indexed.whiteouts |= entry.whiteouts & bit;
+
+  if (!indexed.files && !indexed.whiteouts)
+  {
+    _layer_index.erase(key);
+  }
+
+  return status;
+}
+
+ClientStorage::LayerEntry ClientStorage::IndexedEntry(std::string const& key, FileKey const& file_key) const
+{
+  if (auto it = _layer_index.find(key); it != _layer_index.end())
+  {
+    return it->second;
+  }
+
+  return {0, 0, Utils::PathUtils::NormalizeFilepathUnix(file_key.FilePath())};
+}
+
+std::mutex& ClientStorage::WriteMutex(std::string const& key) const
+{
+  return _write_mutexes[std::hash<std::string>{}(key) % N_WRITE_MUTEXES];
+}
+
 bool ClientStorage::Exists(FileKey const& file_key) const
 {
   EnsureF(CCodeZones::STORAGE, file_key.FileDataID(), "Invalid FileDataID.");
@@ -156,12 +462,16 @@ bool ClientStorage::Exists(FileKey const& file_key) const
   {
     return false;
   }
-  else if (fs::exists(file_key.FilePath()) || _loader->Exists(file_key))
+
   {
-    return true;
+    std::shared_lock lock(_layer_index_mutex);
+
+    if (auto it = _layer_index.find(LayerKey(file_key)); it != _layer_index.end())
+    {
+      return (it->second.files >> TopLayer(it->second)) & 1;
+    }
   }
 
-  return false;
+  return _loader->Exists(file_key);
 }
 
-
@@ -4,9 +4,18 @@
 #include <IO/Storage/FileKey.hpp>
 #include <IO/Storage/ClientLoaders/BaseLoader.hpp>
 
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <stdexcept>
 #include <memory>
 #include <filesystem>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace IO::Storage
 {
@@ -24,6 +33,15 @@ namespace IO::Storage
     LOCAL = 1
   };
 
+  /**
+   * Client storage: archives of a game client, overlaid by local directories (layers).
+   *
+   * Layer 0 is the project directory, overlay layers added later take precedence over the ones below them.
+   * A file is read from the top-most layer containing it, falling back to the client. A whiteout file
+   * (".wh." followed by the file name, in the same directory) hides the file in all layers below it
+   * and in the client. Layer contents are indexed once in memory, so lookups do not touch the file system.
+   * Files added to layer directories by other means than this storage are only picked up by RefreshLayers().
+   */
   class ClientStorage
   {
     friend struct FileKey;
@@ -77,6 +95,17 @@ namespace IO::Storage
                   , std::string const& region
                   , Common::ClientLocale locale = Common::ClientLocale::AUTO);
 
+    /**
+     * Constructs a storage of local directories only, without a client. Files are read from and written to layers,
+     * e.g. to work on previously extracted data.
+     * @param project_path Path to a local directory used as a project path.
+     * @param client_version Version of WoW client the files belong to.
+     * @param listfile Listfile contents, one filepath per line. FileDataIDs are derived the same way as for MPQ clients.
+     */
+    ClientStorage(std::string const& project_path
+                  , Common::ClientVersion client_version
+                  , Common::ByteBuffer const& listfile);
+
     /**
      * Gets underlying listfile.
      * @return Reference to listfile.
@@ -111,6 +140,60 @@ namespace IO::Storage
       */
      [[nodiscard]]
      Common::ClientVersion ClientVersion() const { return _client_version; };
+
+    /**
+     * Adds an overlay directory on top of all layers and indexes its contents. The directory is created if missing.
+     * Thread-safe.
+     * @param path Path to the overlay directory.
+     * @return Index of the new layer.
+     */
+    std::size_t AddLayer(std::string const& path);
+
+    [[nodiscard]]
+    std::size_t NumLayers() const;
+
+    /**
+     * @param layer Layer index.
+     * @return Directory of the layer. Copied, as adding layers may move the stored ones.
+     */
+    [[nodiscard]]
+    std::filesystem::path LayerPath(std::size_t layer) const;
+
+    /**
+     * Selects the layer files are written to and removed from. Project directory (layer 0) by default.
+     * Thread-safe, writes and removals already running keep the previous layer.
+     * @param layer Layer index.
+     */
+    void SetWriteLayer(std::size_t layer);
+
+    [[nodiscard]]
+    std::size_t WriteLayer() const { return _write_layer.load(std::memory_order_relaxed); };
+
+    /**
+     * Finds the layer a file is read from.
+     * @param file_key File key.
+     * @return Layer index, or NO_LAYER if the file is read from the client, or is hidden by a whiteout.
+     */
+    [[nodiscard]]
+    std::size_t FindLayer(FileKey const& file_key) const;
+
+    /**
+     * Finds the layer a file is read from, without assigning the file a FileDataID.
+     * @param filepath Game format filepath.
+     * @return Layer index, or NO_LAYER if no layer holds the file, or it is hidden by a whiteout.
+     */
+    [[nodiscard]]
+    std::size_t FindLayer(std::string const& filepath) const;
+
+    /**
+     * Rebuilds the layer index from the file system.
+     */
+    void RefreshLayers();
+
+    static constexpr std::size_t NO_LAYER = std::numeric_limits<std::size_t>::max();
+    static constexpr std::size_t MAX_LAYERS = 64;
+    static constexpr std::size_t N_WRITE_MUTEXES = 64;
+
   private:
     /**
      * Reads the file content into the provided buffer.
@@ -122,7 +205,7 @@ namespace IO::Storage
     FileKey::FileReadStatus ReadFile(FileKey const& file_key, Common::ByteBuffer& buf) const;
 
     /**
-     * Writes the file content from the provided buffer into project dir.
+     * Writes the file content from the provided buffer into the write layer, removing its whiteout if any.
      * @param file_key File key.
      * @param buf ByteBuffer instance to read data from.
      * @return Status of the file writing operation.
@@ -138,6 +221,52 @@ namespace IO::Storage
     [[nodiscard]]
     bool Exists(FileKey const& file_key) const;
 
+    /**
+     * Removes the file from the write layer. If the file is still visible from a lower layer or the client,
+     * a whiteout is placed in the write layer instead.
+     * @param file_key File key.
+     * @return Status of the file writing operation.
+     */
+    [[nodiscard]]
+    FileKey::FileWriteStatus RemoveFile(FileKey const& file_key) const;
+
+    /**
+     * Files and whiteouts of one path across layers, bit N stands for layer N.
+     */
+    struct LayerEntry
+    {
+      std::uint64_t files = 0;
+      std::uint64_t whiteouts = 0;
+      std::string path; ///> Relative path as spelled on disk, files are opened by it rather than by the lowercase key.
+    };
+
+    /**
+     * Adds contents of a layer directory to the index.
+     */
+    void IndexLayer(std::size_t layer);
+
+    /**
+     * @return Top-most layer holding the file or a whiteout of it, NO_LAYER if none does.
+     */
+    [[nodiscard]]
+    static std::size_t TopLayer(LayerEntry const& entry);
+
+    [[nodiscard]]
+    static std::string LayerKey(FileKey const& file_key);
+
+    /**
+     * Copies the index entry of a file, or makes an empty one spelled as the file key. Requires the index lock.
+     */
+    [[nodiscard]]
+    LayerEntry IndexedEntry(std::string const& key, FileKey const& file_key) const;
+
+    /**
+     * Writes and removals of a file hold its mutex across file IO and publishing to the index, so that the index
+     * always reflects the last of them. Files are spread over N_WRITE_MUTEXES by key.
+     */
+    [[nodiscard]]
+    std::mutex& WriteMutex(std::string const& key) const;
+
   private:
     ListfileManager _listfile;
     std::filesystem::path _project_path;
@@ -145,6 +274,13 @@ namespace IO::Storage
     std::unique_ptr<ClientLoaders::BaseLoader> _loader;
     Common::ClientLocale _locale;
     Common::ClientVersion _client_version;
+
+    std::vector<std::filesystem::path> _layers; ///> Guarded by _layer_index_mutex once constructed.
+    std::atomic<std::size_t> _write_layer {0};
+
+    mutable std::shared_mutex _layer_index_mutex;
+    mutable std::unordered_map<std::string, LayerEntry> _layer_index; ///> Keyed by normalized lowercase path.
+    mutable std::array<std::mutex, N_WRITE_MUTEXES> _write_mutexes;
   };
 }
 
@@ -8,7 +8,8 @@
 using namespace IO::Storage;
 
 FileKey::FileKey(ClientStorage& storage, std::uint32_t file_data_id, FileExistPolicy file_exist_policy)
-: _storage(&storage)
+: _file_data_id(file_data_id)
+, _storage(&storage)
 {
   RequireF(CCodeZones::STORAGE, file_exist_policy != FileExistPolicy::CREATE, "Adding by FDID is not supported.");
   if (file_exist_policy == FileExistPolicy::CHECKEXISTS)
@@ -111,5 +112,10 @@ bool FileKey::Exists() const
   return _storage->Exists(*this);
 }
 
+FileKey::FileWriteStatus FileKey::Remove() const
+{
+  return _storage->RemoveFile(*this);
+}
+
 
 
@@ -98,7 +98,7 @@ namespace IO::Storage
     FileReadStatus Read(Common::ByteBuffer& buf) const;
 
     /**
-     * Write file into project directory.
+     * Write file into the write layer of the associated storage (project directory by default).
      * @param buf Self-owned ByteBuffer instance.
      * @return Status of operation.
      */
@@ -112,6 +112,14 @@ namespace IO::Storage
      [[nodiscard]]
      bool Exists() const;
 
+    /**
+     * Remove file from the write layer of the associated storage. If the file is still provided
+     * by a lower layer or the client, it is hidden instead.
+     * @return Status of operation.
+     */
+    [[nodiscard]]
+    FileWriteStatus Remove() const;
+
   private:
     std::uint32_t _file_data_id = 0;
     ClientStorage* const _storage;
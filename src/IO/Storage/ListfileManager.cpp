@@ -3,6 +3,7 @@
 #include <IO/Storage/FileKey.hpp>
 #include <Utils/PathUtils.hpp>
 
+#include <algorithm>
 #include <charconv>
 #include <fstream>
 
@@ -45,6 +46,7 @@ ListfileManager::ListfileManager(IO::Common::ByteBuffer const& listfile_buf)
 : _max_file_data_id(0)
 , _file_data_id_policy(FileDataIDPolicy::INTERNAL)
 {
+  std::vector<std::string> filepaths;
   std::string current;
 
   for (std::size_t i = 0; i < listfile_buf.Size(); ++i)
@@ -57,7 +59,9 @@ ListfileManager::ListfileManager(IO::Common::ByteBuffer const& listfile_buf)
     }
     if (c == '\n')
     {
-      _fdid_path_map.insert(bm_type::value_type(++_max_file_data_id, Utils::PathUtils::NormalizeFilepathGame(current)));
+      if (!current.empty())
+        filepaths.push_back(Utils::PathUtils::NormalizeFilepathGame(current));
+
       current.resize(0);
     }
     else
@@ -68,9 +72,80 @@ ListfileManager::ListfileManager(IO::Common::ByteBuffer const& listfile_buf)
 
   if (!current.empty())
   {
-    _fdid_path_map.insert(bm_type::value_type(++_max_file_data_id, Utils::PathUtils::NormalizeFilepathGame(current)));
+    filepaths.push_back(Utils::PathUtils::NormalizeFilepathGame(current));
+  }
+
+  // listfiles of several archives overlap and come in archive order, sorting makes collision resolution
+  // independent of both
+  std::sort(filepaths.begin(), filepaths.end());
+  filepaths.erase(std::unique(filepaths.begin(), filepaths.end()), filepaths.end());
+
+  for (auto const& filepath : filepaths)
+  {
+    std::uint32_t const file_data_id = ProbeInternalFileDataID(filepath);
+
+    _fdid_path_map.insert(bm_type::value_type(file_data_id, filepath));
+    _listfile_file_data_ids.insert(file_data_id);
+    _max_file_data_id = std::max(_max_file_data_id, file_data_id);
+  }
+}
+
+std::uint32_t ListfileManager::InternalFileDataID(std::string_view filepath)
+{
+  // 32-bit FNV-1a
+  std::uint32_t hash = 2166136261u;
+
+  for (char c : filepath)
+  {
+    hash ^= static_cast<std::uint8_t>(c);
+    hash *= 16777619u;
+  }
+
+  return hash ? hash : 1;
+}
+
+std::uint32_t ListfileManager::ProbeInternalFileDataID(std::string const& filepath) const
+{
+  std::uint32_t file_data_id = InternalFileDataID(filepath);
+
+  // paths added at runtime are not considered, otherwise their IDs would depend on the order they were added in
+  while (_listfile_file_data_ids.contains(file_data_id))
+  {
+    // 0 is never a valid FileDataID
+    if (!++file_data_id)
+      file_data_id = 1;
+  }
+
+  return file_data_id;
+}
+
+std::uint32_t ListfileManager::AddInternalFileDataID(std::string const& filepath)
+{
+  std::uint32_t file_data_id = ProbeInternalFileDataID(filepath);
+  auto it = _fdid_path_map.left.find(file_data_id);
+
+  // the ID is taken by another path added at runtime, probe past every ID taken by a known path;
+  // only the IDs of such colliding pairs depend on the order they were added in
+  while (it != _fdid_path_map.left.end() && !_generated_file_data_ids.contains(file_data_id))
+  {
+    if (!++file_data_id)
+      file_data_id = 1;
+
+    it = _fdid_path_map.left.find(file_data_id);
+  }
+
+  if (it != _fdid_path_map.left.end())
+  {
+    // the ID was referenced before its path was known, the generated path is replaced in place
+    _fdid_path_map.left.replace_data(it, filepath);
+    _generated_file_data_ids.erase(file_data_id);
+    return file_data_id;
   }
 
+  _fdid_path_map.insert(bm_type::value_type(file_data_id, filepath));
+  _max_file_data_id = std::max(_max_file_data_id, file_data_id);
+
+  return file_data_id;
 }
 
 std::uint32_t ListfileManager::GetOrAddFileDataID(std::string const& filepath)
@@ -82,6 +157,11 @@ std::uint32_t ListfileManager::GetOrAddFileDataID(std::string const& filepath)
     return it->get_left();
   }
 
+  if (_file_data_id_policy == FileDataIDPolicy::INTERNAL)
+  {
+    return AddInternalFileDataID(filepath);
+  }
+
   _fdid_path_map.insert(bm_type::value_type(++_max_file_data_id, filepath));
   return _max_file_data_id;
 }
@@ -96,6 +176,7 @@ std::string const& ListfileManager::GetOrGenerateFilepath(std::uint32_t file_dat
   }
 
   auto new_it = _fdid_path_map.insert(bm_type::value_type(file_data_id, "UNKNOWN\\" + std::to_string(file_data_id)));
+  _generated_file_data_ids.insert(file_data_id);
   return new_it.first->get_right();
 }
 
@@ -125,7 +206,32 @@ std::uint32_t ListfileManager::GetFileDatIDForFilepath(std::string const& filepa
   return it != _fdid_path_map.right.end() ? it->get_left() : 0;
 }
 
+std::vector<std::uint32_t> ListfileManager::GetFileDataIDsForFilepaths(std::vector<std::string> const& filepaths) const
+{
+  std::vector<std::uint32_t> file_data_ids;
+  file_data_ids.reserve(filepaths.size());
+
+  for (auto const& filepath : filepaths)
+  {
+    auto it = _fdid_path_map.right.find(filepath);
+    file_data_ids.push_back(it != _fdid_path_map.right.end() ? it->get_left() : 0);
+  }
+
+  return file_data_ids;
+}
+
 bool ListfileManager::Exists(std::uint32_t file_data_id) const
 {
   return _fdid_path_map.left.find(file_data_id) != _fdid_path_map.left.end();
 }
+
+std::vector<std::pair<std::uint32_t, std::string>> ListfileManager::Entries() const
+{
+  std::vector<std::pair<std::uint32_t, std::string>> entries;
+  entries.reserve(_fdid_path_map.size());
+
+  for (auto const& entry : _fdid_path_map.left)
+    entries.emplace_back(entry.first, entry.second);
+
+  return entries;
+}
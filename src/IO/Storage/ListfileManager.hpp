@@ -1,7 +1,12 @@
 #pragma once
 
 #include <boost/bimap.hpp>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 #include <stdexcept>
 
 namespace IO::Common
@@ -32,7 +37,11 @@ namespace IO::Storage
 
     /**
      * FileDataIDs are fake FileDataIDs assigned at runtime to reduce string overhead in library code.
-     * Used for pre-CASC clients.
+     * Used for pre-CASC clients. IDs are derived from a hash of the normalized filepath, so the same path maps
+     * to the same ID across runs and machines, and can be used as a key of persistent data.
+     * Collisions with listfile entries are resolved by probing the next free ID, in sorted path order. Paths added
+     * at runtime only probe past listfile entries, so their IDs do not depend on the order they are added in,
+     * unless two of them collide: the one added later then probes past every ID taken by a known path.
      */
     INTERNAL = 1
   };
@@ -61,6 +70,8 @@ namespace IO::Storage
 
     /**
      * Returns FileDataID for filepath. (assignes a new one, if does not exist)
+     * With the INTERNAL policy, a path takes over an ID previously generated by GetOrGenerateFilepath().
+     * Never fails, colliding paths added at runtime get the next free ID.
      * @param filepath Game format filepath
      * @return FileDataID
      */
@@ -75,6 +86,14 @@ namespace IO::Storage
     [[nodiscard]]
     std::uint32_t GetFileDatIDForFilepath(std::string const& filepath) const;
 
+    /**
+     * Returns FileDataIDs for a batch of filepaths in one pass, avoiding per-file FileKey construction.
+     * @param filepaths Game format filepaths.
+     * @return FileDataIDs in the same order as filepaths. 0 for filepaths that do not exist.
+     */
+    [[nodiscard]]
+    std::vector<std::uint32_t> GetFileDataIDsForFilepaths(std::vector<std::string> const& filepaths) const;
+
     /**
      * Returns filepath for given FileDataID. If FileDataID does not exist, automatic path is returned.
      * @param file_data_id FileDataID.
@@ -91,6 +110,21 @@ namespace IO::Storage
     [[nodiscard]]
     bool Exists(std::uint32_t file_data_id) const;
 
+    /**
+     * Returns all files known to the listfile.
+     * @return Pairs of FileDataID and game format filepath, ordered by FileDataID.
+     */
+    [[nodiscard]]
+    std::vector<std::pair<std::uint32_t, std::string>> Entries() const;
+
+    /**
+     * Computes the preferred internal FileDataID of a filepath, before collision resolution.
+     * @param filepath Game format filepath.
+     * @return Non-zero FileDataID.
+     */
+    [[nodiscard]]
+    static std::uint32_t InternalFileDataID(std::string_view filepath);
+
     /**
      * Saves listfile. Works only for CASC-based clients.
      * @throws IO::Storage::Exceptions::ListFileNotFoundError Thrown if listfile writing failed.
@@ -98,12 +132,26 @@ namespace IO::Storage
     void Save();
 
 
+  private:
+    /**
+     * Computes the internal FileDataID of a filepath, probing past the IDs of listfile entries only.
+     */
+    [[nodiscard]]
+    std::uint32_t ProbeInternalFileDataID(std::string const& filepath) const;
+
+    /**
+     * Assigns an internal FileDataID to a filepath added at runtime.
+     */
+    std::uint32_t AddInternalFileDataID(std::string const& filepath);
+
   private:
     using bm_type = boost::bimap<std::uint32_t, std::string>;
     bm_type _fdid_path_map;
+    std::unordered_set<std::uint32_t> _listfile_file_data_ids;
+    std::unordered_set<std::uint32_t> _generated_file_data_ids;
     std::string _path;
-    std::uint32_t _max_file_data_id;
-    FileDataIDPolicy _file_data_id_policy;
+    std::uint32_t _max_file_data_id = 0;
+    FileDataIDPolicy _file_data_id_policy = FileDataIDPolicy::INTERNAL;
 
   };
 }
\ No newline at end of file
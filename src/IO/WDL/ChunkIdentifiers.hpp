@@ -0,0 +1,24 @@
+#pragma once
+#include <Utils/Meta/Templates.hpp>
+#include <IO/Common.hpp>
+
+namespace IO::WDL::ChunkIdentifiers
+{
+  /**
+   * Chunks found in WDL (low resolution world) files.
+   */
+  namespace WDLChunks
+  {
+    enum eWDLChunks
+    {
+      MAOF = Common::FourCC<"MAOF">, ///> Map Area Offset. Absolute file offsets of MARE chunks for each tile.
+      MARE = Common::FourCC<"MARE">, ///> Map Area. Low resolution heightmap of one tile.
+      MAHO = Common::FourCC<"MAHO">, ///> Map Area Holes. Per-chunk hole mask of one tile, always follows MARE.
+
+      // pre Legion
+      MWMO = Common::FourCC<"MWMO">, ///> Map World Map Object. WMO filenames for low detail map objects.
+      MWID = Common::FourCC<"MWID">, ///> Map World Map Object Index. Offsets into MWMO.
+      MODF = Common::FourCC<"MODF">, ///> Map Object Definition. Low detail WMO placements.
+    };
+  }
+}
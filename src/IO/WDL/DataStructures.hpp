@@ -0,0 +1,41 @@
+#pragma once
+
+#include <IO/Common.hpp>
+#include <IO/CommonDataStructures.hpp>
+#include <IO/WorldConstants.hpp>
+
+#include <cstdint>
+#include <array>
+
+namespace IO::WDL::DataStructures
+{
+  /**
+   * Low resolution heightmap of one tile (MARE chunk). Heights are absolute and rounded to integer yards.
+   * Outer vertices lie on chunk corners, inner vertices lie on chunk centers.
+   */
+  struct MapAreaLowResHeightmap
+  {
+    std::array
+    <
+      std::int16_t
+      , Common::WorldConstants::N_VERTS_TILE_LOWRES_ROW_OUTER * Common::WorldConstants::N_VERTS_TILE_LOWRES_ROW_OUTER
+    > outer; ///> 17x17 grid of chunk corner heights, row-major.
+
+    std::array
+    <
+      std::int16_t
+      , Common::WorldConstants::N_VERTS_TILE_LOWRES_ROW_INNER * Common::WorldConstants::N_VERTS_TILE_LOWRES_ROW_INNER
+    > inner; ///> 16x16 grid of chunk center heights, row-major.
+  };
+
+  static_assert(sizeof(MapAreaLowResHeightmap)
+                == Common::WorldConstants::MAP_AREA_LOWRES_HEIGHTMAP_SIZE * sizeof(std::int16_t));
+
+  /**
+   * Hole mask of one tile (MAHO chunk). One row per chunk row, bit N is set when chunk N of the row is a hole.
+   */
+  struct MapAreaLowResHoles
+  {
+    std::array<std::uint16_t, 16> rows;
+  };
+}
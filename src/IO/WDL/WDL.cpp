@@ -0,0 +1,161 @@
+#include <IO/WDL/WDL.hpp>
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <array>
+
+using namespace IO::WDL;
+using namespace IO::Common;
+
+WDL::WDL()
+{
+  _version.Initialize(18);
+  _tiles.resize(WorldConstants::MAX_TILES_PER_MAP);
+}
+
+WDL::WDL(Common::ByteBuffer const& buf)
+{
+  _tiles.resize(WorldConstants::MAX_TILES_PER_MAP);
+  Read(buf);
+}
+
+bool WDL::HasTile(Common::DataStructures::TileIndex tile_index) const
+{
+  RequireF(CCodeZones::FILE_IO, tile_index.x < 64 && tile_index.y < 64, "Tile index out of bounds.");
+  return _tiles[LinearTileIndex(tile_index)].has_value();
+}
+
+LowResTile& WDL::Tile(Common::DataStructures::TileIndex tile_index)
+{
+  RequireF(CCodeZones::FILE_IO, HasTile(tile_index), "Requested tile (%d, %d) is not present."
+           , tile_index.x, tile_index.y);
+  return *_tiles[LinearTileIndex(tile_index)];
+}
+
+LowResTile const& WDL::Tile(Common::DataStructures::TileIndex tile_index) const
+{
+  RequireF(CCodeZones::FILE_IO, HasTile(tile_index), "Requested tile (%d, %d) is not present."
+           , tile_index.x, tile_index.y);
+  return *_tiles[LinearTileIndex(tile_index)];
+}
+
+LowResTile& WDL::AddTile(Common::DataStructures::TileIndex tile_index)
+{
+  RequireF(CCodeZones::FILE_IO, tile_index.x < 64 && tile_index.y < 64, "Tile index out of bounds.");
+  return _tiles[LinearTileIndex(tile_index)].emplace(LowResTile{});
+}
+
+void WDL::RemoveTile(Common::DataStructures::TileIndex tile_index)
+{
+  RequireF(CCodeZones::FILE_IO, tile_index.x < 64 && tile_index.y < 64, "Tile index out of bounds.");
+  _tiles[LinearTileIndex(tile_index)].reset();
+}
+
+std::size_t WDL::NumTiles() const
+{
+  return std::count_if(_tiles.begin(), _tiles.end(), [](auto const& tile) { return tile.has_value(); });
+}
+
+bool WDL::ReadTileChunk(Common::ByteBuffer const& buf, Common::ChunkHeader const& chunk_header)
+{
+  switch (chunk_header.fourcc)
+  {
+    case ChunkIdentifiers::WDLChunks::MAOF:
+    {
+      LogDebugF(LCodeZones::FILE_IO, "Reading chunk: MAOF, size: %d.", chunk_header.size);
+
+      std::array<std::uint32_t, WorldConstants::MAX_TILES_PER_MAP> offsets {};
+      EnsureF(CCodeZones::FILE_IO, chunk_header.size == sizeof(offsets), "MAOF: unexpected chunk size %d."
+              , chunk_header.size);
+      buf.Read(offsets.begin(), offsets.end());
+
+      _read_tile_offsets.clear();
+
+      for (std::uint32_t i = 0; i < offsets.size(); ++i)
+      {
+        if (offsets[i])
+          _read_tile_offsets.emplace_back(offsets[i], i);
+      }
+
+      std::sort(_read_tile_offsets.begin(), _read_tile_offsets.end());
+      return true;
+    }
+    case ChunkIdentifiers::WDLChunks::MARE:
+    {
+      auto const chunk_pos = static_cast<std::uint32_t>(buf.Tell() - sizeof(Common::ChunkHeader));
+
+      auto it = std::lower_bound(_read_tile_offsets.begin(), _read_tile_offsets.end()
+                                 , std::make_pair(chunk_pos, std::uint32_t{0}));
+
+      if (it == _read_tile_offsets.end() || it->first != chunk_pos) [[unlikely]]
+      {
+        LogError("MARE at offset %d is not referenced by MAOF. Skipped.", chunk_pos);
+        buf.Seek<ByteBuffer::SeekDir::Forward, ByteBuffer::SeekType::Relative>(chunk_header.size);
+        _read_last_tile = WorldConstants::MAX_TILES_PER_MAP;
+        return true;
+      }
+
+      EnsureF(CCodeZones::FILE_IO, chunk_header.size == sizeof(DataStructures::MapAreaLowResHeightmap)
+              , "MARE: unexpected chunk size %d.", chunk_header.size);
+
+      _read_last_tile = it->second;
+
+      auto& tile = _tiles[_read_last_tile].emplace(LowResTile{});
+      buf.Read(tile.heightmap);
+      return true;
+    }
+    case ChunkIdentifiers::WDLChunks::MAHO:
+    {
+      if (_read_last_tile >= WorldConstants::MAX_TILES_PER_MAP
+          || !_tiles[_read_last_tile].has_value()) [[unlikely]]
+      {
+        LogError("MAHO encountered without preceding MARE. Skipped.");
+        buf.Seek<ByteBuffer::SeekDir::Forward, ByteBuffer::SeekType::Relative>(chunk_header.size);
+        return true;
+      }
+
+      EnsureF(CCodeZones::FILE_IO, chunk_header.size == sizeof(DataStructures::MapAreaLowResHoles)
+              , "MAHO: unexpected chunk size %d.", chunk_header.size);
+
+      buf.Read(_tiles[_read_last_tile]->holes);
+      _read_last_tile = WorldConstants::MAX_TILES_PER_MAP;
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+void WDL::WriteTileChunks(Common::ByteBuffer& buf) const
+{
+  LogDebugF(LCodeZones::FILE_IO, "Writing chunk: MAOF.");
+
+  std::array<std::uint32_t, WorldConstants::MAX_TILES_PER_MAP> offsets {};
+
+  std::size_t const offsets_pos = buf.Tell() + sizeof(Common::ChunkHeader);
+  buf.Write(Common::ChunkHeader{ChunkIdentifiers::WDLChunks::MAOF, sizeof(offsets)});
+  buf.Write(offsets.begin(), offsets.end());
+
+  for (std::uint32_t i = 0; i < _tiles.size(); ++i)
+  {
+    if (!_tiles[i])
+      continue;
+
+    EnsureF(CCodeZones::FILE_IO, buf.Tell() <= std::numeric_limits<std::uint32_t>::max(), "MAOF offset overflow.");
+    offsets[i] = static_cast<std::uint32_t>(buf.Tell());
+
+    buf.Write(Common::ChunkHeader{ChunkIdentifiers::WDLChunks::MARE, sizeof(DataStructures::MapAreaLowResHeightmap)});
+    buf.Write(_tiles[i]->heightmap);
+
+    buf.Write(Common::ChunkHeader{ChunkIdentifiers::WDLChunks::MAHO, sizeof(DataStructures::MapAreaLowResHoles)});
+    buf.Write(_tiles[i]->holes);
+  }
+
+  // go back and write actual offsets
+  std::size_t const end_pos = buf.Tell();
+  buf.Seek(offsets_pos);
+  buf.Write(offsets.begin(), offsets.end());
+  buf.Seek(end_pos);
+}
@@ -0,0 +1,144 @@
+#pragma once
+#include <IO/Common.hpp>
+#include <IO/CommonTraits.hpp>
+#include <IO/CommonChunkIdentifiers.hpp>
+#include <IO/CommonDataStructures.hpp>
+#include <IO/WorldConstants.hpp>
+#include <IO/WDL/ChunkIdentifiers.hpp>
+#include <IO/WDL/DataStructures.hpp>
+#include <IO/WDT/DataStructures.hpp>
+#include <Utils/Misc/ForceInline.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include <utility>
+
+namespace IO::WDL
+{
+  /**
+   * Low resolution representation of one map tile as stored in WDL.
+   */
+  struct LowResTile
+  {
+    DataStructures::MapAreaLowResHeightmap heightmap; ///> MARE.
+    DataStructures::MapAreaLowResHoles holes; ///> MAHO.
+  };
+
+  /**
+   * WDL (low resolution world) file. Holds far terrain heightmaps for every tile of a map.
+   * Tile data is addressed through the MAOF offset table and cannot be handled by auto traits,
+   * so it is read and written manually by extra IO hooks.
+   */
+  class WDL : public Common::Traits::AutoIOTraitInterface<WDL, Common::Traits::TraitType::File>
+  {
+    AutoIOTraitInterfaceUser;
+
+  public:
+    WDL();
+    explicit WDL(Common::ByteBuffer const& buf);
+
+    /**
+     * Checks if low resolution data is present for a tile.
+     * @param tile_index Tile coordinates on WDT grid.
+     * @return True if tile is present.
+     */
+    [[nodiscard]]
+    bool HasTile(Common::DataStructures::TileIndex tile_index) const;
+
+    /**
+     * Returns low resolution data of a tile. Tile must be present.
+     * @param tile_index Tile coordinates on WDT grid.
+     * @return Reference to tile data.
+     */
+    [[nodiscard]]
+    LowResTile& Tile(Common::DataStructures::TileIndex tile_index);
+
+    [[nodiscard]]
+    LowResTile const& Tile(Common::DataStructures::TileIndex tile_index) const;
+
+    /**
+     * Adds a tile (or resets an existing one) with flat zero heightmap and no holes.
+     * Adding and removing distinct tiles from multiple threads is safe.
+     * @param tile_index Tile coordinates on WDT grid.
+     * @return Reference to tile data.
+     */
+    LowResTile& AddTile(Common::DataStructures::TileIndex tile_index);
+
+    /**
+     * Removes a tile. No-op if tile is not present.
+     * @param tile_index Tile coordinates on WDT grid.
+     */
+    void RemoveTile(Common::DataStructures::TileIndex tile_index);
+
+    /**
+     * Counts tiles present in the file.
+     * @return Number of tiles.
+     */
+    [[nodiscard]]
+    std::size_t NumTiles() const;
+
+  private:
+    template<typename ReadContext>
+    bool ReadExtraPre([[maybe_unused]] ReadContext& read_ctx, Common::ByteBuffer const& buf, Common::ChunkHeader const& chunk_header)
+    {
+      return ReadTileChunk(buf, chunk_header);
+    };
+
+    template<typename WriteContext>
+    void WriteExtraPost([[maybe_unused]] WriteContext& write_ctx, Common::ByteBuffer& buf) const
+    {
+      WriteTileChunks(buf);
+    };
+
+    bool ReadTileChunk(Common::ByteBuffer const& buf, Common::ChunkHeader const& chunk_header);
+    void WriteTileChunks(Common::ByteBuffer& buf) const;
+
+    [[nodiscard]]
+    static FORCEINLINE std::uint32_t LinearTileIndex(Common::DataStructures::TileIndex tile_index)
+    {
+      return tile_index.y * 64u + tile_index.x;
+    };
+
+  private:
+    Common::DataChunk
+    <
+      std::uint32_t
+      , Common::ChunkIdentifiers::CommonChunks::MVER
+    > _version;
+
+    Common::StringBlockChunk
+    <
+      Common::StringBlockChunkType::OFFSET
+      , ChunkIdentifiers::WDLChunks::MWMO
+    > _map_object_filenames;
+
+    Common::DataArrayChunk
+    <
+      std::uint32_t
+      , ChunkIdentifiers::WDLChunks::MWID
+    > _map_object_filename_offsets;
+
+    Common::DataArrayChunk
+    <
+      WDT::DataStructures::MapObjectPlacement
+      , ChunkIdentifiers::WDLChunks::MODF
+    > _map_object_placements;
+
+    std::vector<std::optional<LowResTile>> _tiles;
+
+    // read state, valid only while parsing
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> _read_tile_offsets; ///> Sorted (file offset, tile) pairs.
+    std::uint32_t _read_last_tile = Common::WorldConstants::MAX_TILES_PER_MAP;
+
+  private:
+    static constexpr
+    Common::Traits::AutoIOTrait
+    <
+      Common::Traits::TraitEntry<&WDL::_version>
+      , Common::Traits::TraitEntry<&WDL::_map_object_filenames>
+      , Common::Traits::TraitEntry<&WDL::_map_object_filename_offsets>
+      , Common::Traits::TraitEntry<&WDL::_map_object_placements>
+    > _auto_trait {};
+  };
+}
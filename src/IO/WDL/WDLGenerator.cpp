@@ -0,0 +1,118 @@
+#include <IO/WDL/WDLGenerator.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+using namespace IO::WDL;
+using namespace IO::Common;
+
+namespace
+{
+  std::int16_t QuantizeHeight(float height)
+  {
+    long const rounded = std::lround(height);
+    return static_cast<std::int16_t>(std::clamp<long>(rounded, std::numeric_limits<std::int16_t>::min()
+                                                      , std::numeric_limits<std::int16_t>::max()));
+  }
+}
+
+WDLGenerator::WDLGenerator(WDL& wdl)
+: _wdl(wdl)
+{
+}
+
+void WDLGenerator::MarkTileDirty(Common::DataStructures::TileIndex tile_index)
+{
+  RequireF(CCodeZones::FILE_IO, tile_index.x < 64 && tile_index.y < 64, "Tile index out of bounds.");
+  _dirty_tiles.set(tile_index.y * 64u + tile_index.x);
+}
+
+std::size_t WDLGenerator::Generate(TerrainLoader const& loader, unsigned n_threads)
+{
+  std::vector<std::uint32_t> dirty_tiles;
+  dirty_tiles.reserve(_dirty_tiles.count());
+
+  for (std::uint32_t i = 0; i < _dirty_tiles.size(); ++i)
+  {
+    if (_dirty_tiles[i])
+      dirty_tiles.push_back(i);
+  }
+
+  LogDebugF(LCodeZones::FILE_IO, "Generating WDL data for %d tiles.", dirty_tiles.size());
+
+  std::atomic<std::size_t> n_generated = 0;
+
+  Utils::Misc::ParallelFor(dirty_tiles.size(), [&](std::size_t i)
+  {
+    Common::DataStructures::TileIndex const tile_index {static_cast<std::uint16_t>(dirty_tiles[i] % 64)
+                                                        , static_cast<std::uint16_t>(dirty_tiles[i] / 64)};
+
+    // terrain is too large to be kept on the stack of a worker thread
+    auto terrain = std::make_unique<ADT::TileTerrain>();
+
+    if (!loader(tile_index, *terrain))
+    {
+      _wdl.RemoveTile(tile_index);
+      return;
+    }
+
+    BuildLowResTile(*terrain, _wdl.AddTile(tile_index));
+    ++n_generated;
+  }, n_threads);
+
+  for (std::uint32_t tile : dirty_tiles)
+    _dirty_tiles.reset(tile);
+
+  return n_generated;
+}
+
+void WDLGenerator::BuildLowResTile(ADT::TileTerrain const& terrain, LowResTile& tile)
+{
+  constexpr unsigned n_outer = WorldConstants::N_VERTS_TILE_LOWRES_ROW_OUTER;
+  constexpr unsigned n_inner = WorldConstants::N_VERTS_TILE_LOWRES_ROW_INNER;
+  constexpr unsigned chunk_row_stride = WorldConstants::N_VERTS_CHUNK_ROW_OUTER + WorldConstants::N_VERTS_CHUNK_ROW_INNER;
+
+  // outer grid: chunk corners. The last row and column are taken from the far edge of the last chunk.
+  for (unsigned y = 0; y < n_outer; ++y)
+  {
+    unsigned const chunk_y = std::min(y, n_inner - 1);
+    unsigned const vertex_row = y == n_inner ? WorldConstants::N_VERTS_CHUNK_ROW_OUTER - 1 : 0;
+
+    for (unsigned x = 0; x < n_outer; ++x)
+    {
+      unsigned const chunk_x = std::min(x, n_inner - 1);
+      unsigned const vertex_col = x == n_inner ? WorldConstants::N_VERTS_CHUNK_ROW_OUTER - 1 : 0;
+
+      ADT::ChunkTerrain const& chunk = terrain[chunk_y * n_inner + chunk_x];
+      float const height = chunk.header.position.z + chunk.heightmap[vertex_row * chunk_row_stride + vertex_col];
+
+      tile.heightmap.outer[y * n_outer + x] = QuantizeHeight(height);
+    }
+  }
+
+  // inner grid: chunk centers, which match the central outer vertex of a chunk.
+  constexpr unsigned center_vertex = (WorldConstants::N_VERTS_CHUNK_ROW_OUTER / 2) * chunk_row_stride
+    + WorldConstants::N_VERTS_CHUNK_ROW_OUTER / 2;
+
+  tile.holes.rows.fill(0);
+
+  for (unsigned y = 0; y < n_inner; ++y)
+  {
+    for (unsigned x = 0; x < n_inner; ++x)
+    {
+      ADT::ChunkTerrain const& chunk = terrain[y * n_inner + x];
+      tile.heightmap.inner[y * n_inner + x] = QuantizeHeight(chunk.header.position.z + chunk.heightmap[center_vertex]);
+
+      if (ADT::ChunkHoleMask(chunk.header) == std::numeric_limits<std::uint64_t>::max())
+        tile.holes.rows[y] |= static_cast<std::uint16_t>(1u << x);
+    }
+  }
+}
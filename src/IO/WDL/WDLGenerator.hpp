@@ -0,0 +1,69 @@
+#pragma once
+#include <IO/Common.hpp>
+#include <IO/CommonDataStructures.hpp>
+#include <IO/WorldConstants.hpp>
+#include <IO/ADT/Root/TileTerrain.hpp>
+#include <IO/WDL/WDL.hpp>
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <functional>
+
+namespace IO::WDL
+{
+  /**
+   * Produces WDL low resolution heightmaps (MARE) and hole masks (MAHO) from ADT terrain.
+   * Only tiles marked dirty are regenerated, which allows to keep WDL in sync with edited ADTs cheaply.
+   */
+  class WDLGenerator
+  {
+  public:
+    /**
+     * Loads terrain of a tile. Invoked concurrently from worker threads, must be thread-safe.
+     * Must match signature: bool(Common::DataStructures::TileIndex tile_index, ADT::TileTerrain& terrain).
+     * ADT::ExtractTileTerrain() fills terrain from a root ADT.
+     * Returns false if tile does not exist, in which case it is removed from WDL.
+     */
+    using TerrainLoader = std::function<bool(Common::DataStructures::TileIndex, ADT::TileTerrain&)>;
+
+    explicit WDLGenerator(WDL& wdl);
+
+    /**
+     * Marks a tile for regeneration, e.g. after its root ADT was changed.
+     * @param tile_index Tile coordinates on WDT grid.
+     */
+    void MarkTileDirty(Common::DataStructures::TileIndex tile_index);
+
+    /**
+     * Marks every tile of the map for regeneration.
+     */
+    void MarkAllTilesDirty() { _dirty_tiles.set(); };
+
+    [[nodiscard]]
+    std::size_t NumDirtyTiles() const { return _dirty_tiles.count(); };
+
+    /**
+     * Regenerates all dirty tiles in parallel and clears their dirty state.
+     * If loader throws, the exception is propagated and dirty state is left intact.
+     * @param loader Terrain loader callback.
+     * @param n_threads Number of worker threads. 0 means hardware concurrency.
+     * @return Number of tiles regenerated (present tiles only).
+     */
+    std::size_t Generate(TerrainLoader const& loader, unsigned n_threads = 0);
+
+    /**
+     * Downsamples terrain of a tile into low resolution representation.
+     * Outer grid samples chunk corners, inner grid samples chunk centers. Chunks fully covered by holes
+     * are marked in the hole mask, as partial holes cannot be represented in low resolution.
+     * @param terrain Terrain of a tile.
+     * @param tile Low resolution tile to write the result to.
+     */
+    static void BuildLowResTile(ADT::TileTerrain const& terrain, LowResTile& tile);
+
+  private:
+    WDL& _wdl;
+    std::bitset<Common::WorldConstants::MAX_TILES_PER_MAP> _dirty_tiles;
+  };
+}
+
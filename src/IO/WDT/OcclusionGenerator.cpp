@@ -0,0 +1,331 @@
+#include <IO/WDT/OcclusionGenerator.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <Utils/Misc/SIMD.hpp>
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <memory>
+
+using namespace IO::WDT;
+using namespace IO::Common;
+using IO::Common::DataStructures::CAaBox;
+using IO::Common::DataStructures::TileIndex;
+
+namespace
+{
+  constexpr unsigned N_OUTER = 17;
+  constexpr unsigned N_INNER = 16;
+  constexpr unsigned CHUNK_ROW_STRIDE = WorldConstants::N_VERTS_CHUNK_ROW_OUTER + WorldConstants::N_VERTS_CHUNK_ROW_INNER;
+
+  // quads of a chunk quarter, in the (y * 8 + x) hole mask layout
+  constexpr std::uint64_t QUARTER_QUADS = 0x0F0F0F0Full;
+
+  std::uint16_t QuantizeHeight(float height)
+  {
+    if (!std::isfinite(height))
+      return static_cast<std::uint16_t>(std::numeric_limits<std::int16_t>::min());
+
+    // rounded up, occluders are built from maximum heights
+    double const rounded = std::ceil(height);
+    return static_cast<std::uint16_t>(static_cast<std::int16_t>(
+      std::clamp<double>(rounded, std::numeric_limits<std::int16_t>::min(), std::numeric_limits<std::int16_t>::max())));
+  }
+
+  /**
+   * Maximum absolute height of each quarter of a chunk (x + y * 2 order). Quarters made of holes only
+   * get negative infinity.
+   */
+  std::array<float, 4> QuarterMaxima(IO::ADT::ChunkTerrain const& chunk)
+  {
+    std::uint64_t const holes = IO::ADT::ChunkHoleMask(chunk.header);
+    std::array<float, 4> maxima {};
+
+    for (unsigned quarter = 0; quarter < 4; ++quarter)
+    {
+      unsigned const qx = quarter % 2;
+      unsigned const qy = quarter / 2;
+      std::uint64_t const quads = QUARTER_QUADS << (qy * 32 + qx * 4);
+
+      if ((holes & quads) == quads)
+      {
+        maxima[quarter] = -std::numeric_limits<float>::infinity();
+        continue;
+      }
+
+      float max_height = -std::numeric_limits<float>::infinity();
+
+      for (unsigned row = 0; row < 5; ++row)
+      {
+        float const* outer = chunk.heightmap.data() + (qy * 4 + row) * CHUNK_ROW_STRIDE + qx * 4;
+
+        for (unsigned i = 0; i < 5; ++i)
+          max_height = std::max(max_height, outer[i]);
+      }
+
+      for (unsigned row = 0; row < 4; ++row)
+      {
+        float const* inner = chunk.heightmap.data() + (qy * 4 + row) * CHUNK_ROW_STRIDE
+          + WorldConstants::N_VERTS_CHUNK_ROW_OUTER + qx * 4;
+
+        for (unsigned i = 0; i < 4; ++i)
+          max_height = std::max(max_height, inner[i]);
+      }
+
+      maxima[quarter] = chunk.header.position.z + max_height;
+    }
+
+    return maxima;
+  }
+
+#if defined(UTILS_SIMD)
+  /**
+   * Same result as QuarterMaxima(), up to the sign of zero maxima which quantization does not see.
+   *
+   * Rows of a quarter are four columns wide, plus the outer column shared with the next quarter, so a lane holds
+   * one column: the rows of both quarters of a half are reduced vertically at once, then across lanes.
+   * Maxima start at negative infinity and take the accumulator as the operand returned for NaN,
+   * so NaN heights are skipped like std::max() does.
+   */
+  std::array<float, 4> QuarterMaximaSIMD(IO::ADT::ChunkTerrain const& chunk)
+  {
+    std::uint64_t const holes = IO::ADT::ChunkHoleMask(chunk.header);
+    float const* heights = chunk.heightmap.data();
+    std::array<float, 4> maxima {};
+
+    for (unsigned qy = 0; qy < 2; ++qy)
+    {
+      float last_column = -std::numeric_limits<float>::infinity();
+
+#if defined(UTILS_SIMD_SSE2)
+      __m128 left = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+      __m128 right = left;
+
+      for (unsigned row = 0; row < 5; ++row)
+      {
+        float const* outer = heights + (qy * 4 + row) * CHUNK_ROW_STRIDE;
+        left = _mm_max_ps(_mm_loadu_ps(outer), left);
+        right = _mm_max_ps(_mm_loadu_ps(outer + 4), right);
+        last_column = std::max(last_column, outer[8]);
+      }
+
+      // column 4 is shared by both quarters and is the first lane of the right half
+      float const shared_column = _mm_cvtss_f32(right);
+
+      for (unsigned row = 0; row < 4; ++row)
+      {
+        float const* inner = heights + (qy * 4 + row) * CHUNK_ROW_STRIDE + WorldConstants::N_VERTS_CHUNK_ROW_OUTER;
+        left = _mm_max_ps(_mm_loadu_ps(inner), left);
+        right = _mm_max_ps(_mm_loadu_ps(inner + 4), right);
+      }
+
+      auto reduce = [](__m128 v)
+      {
+        v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+        v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtss_f32(v);
+      };
+#else
+      float32x4_t left = vdupq_n_f32(-std::numeric_limits<float>::infinity());
+      float32x4_t right = left;
+
+      // vmaxq_f32() propagates NaN, the IEEE maxNum variant returns the other operand
+      for (unsigned row = 0; row < 5; ++row)
+      {
+        float const* outer = heights + (qy * 4 + row) * CHUNK_ROW_STRIDE;
+        left = vmaxnmq_f32(left, vld1q_f32(outer));
+        right = vmaxnmq_f32(right, vld1q_f32(outer + 4));
+        last_column = std::max(last_column, outer[8]);
+      }
+
+      // column 4 is shared by both quarters and is the first lane of the right half
+      float const shared_column = vgetq_lane_f32(right, 0);
+
+      for (unsigned row = 0; row < 4; ++row)
+      {
+        float const* inner = heights + (qy * 4 + row) * CHUNK_ROW_STRIDE + WorldConstants::N_VERTS_CHUNK_ROW_OUTER;
+        left = vmaxnmq_f32(left, vld1q_f32(inner));
+        right = vmaxnmq_f32(right, vld1q_f32(inner + 4));
+      }
+
+      auto reduce = [](float32x4_t v) { return vmaxvq_f32(v); };
+#endif
+
+      maxima[qy * 2] = std::max(reduce(left), shared_column);
+      maxima[qy * 2 + 1] = std::max(reduce(right), last_column);
+    }
+
+    for (unsigned quarter = 0; quarter < 4; ++quarter)
+    {
+      std::uint64_t const quads = QUARTER_QUADS << ((quarter / 2) * 32 + (quarter % 2) * 4);
+
+      maxima[quarter] = (holes & quads) == quads ? -std::numeric_limits<float>::infinity()
+                                                 : chunk.header.position.z + maxima[quarter];
+    }
+
+    return maxima;
+  }
+#endif
+
+  bool Covers(CAaBox const& box, float x_min, float x_max, float z_min, float z_max)
+  {
+    return box.min.x <= x_min && box.max.x >= x_max && box.min.z <= z_min && box.max.z >= z_max;
+  }
+}
+
+OcclusionGenerator::OcclusionGenerator(WDTOcclusion& occlusion)
+: _occlusion(occlusion)
+{
+}
+
+void OcclusionGenerator::MarkTileDirty(TileIndex tile_index)
+{
+  RequireF(CCodeZones::FILE_IO, tile_index.x < 64 && tile_index.y < 64, "Tile index out of bounds.");
+  _dirty_tiles.set(tile_index.y * 64u + tile_index.x);
+}
+
+std::size_t OcclusionGenerator::Generate(TerrainLoader const& terrain_loader
+                                         , MapObjectBoundsLoader const& bounds_loader
+                                         , unsigned n_threads)
+{
+  std::vector<std::uint32_t> dirty_tiles;
+  dirty_tiles.reserve(_dirty_tiles.count());
+
+  for (std::uint32_t i = 0; i < _dirty_tiles.size(); ++i)
+  {
+    if (_dirty_tiles[i])
+      dirty_tiles.push_back(i);
+  }
+
+  LogDebugF(LCodeZones::FILE_IO, "Generating occlusion data for %d tiles.", dirty_tiles.size());
+
+  // MAOI / MAOH are packed arrays, so heightmaps are collected first and applied on this thread
+  std::vector<std::unique_ptr<DataStructures::MapAreaOcclusionHeightmap>> heightmaps (dirty_tiles.size());
+
+  Utils::Misc::ParallelFor(dirty_tiles.size(), [&](std::size_t i)
+  {
+    TileIndex const tile_index {static_cast<std::uint16_t>(dirty_tiles[i] % 64)
+                                , static_cast<std::uint16_t>(dirty_tiles[i] / 64)};
+
+    // terrain is too large to be kept on the stack of a worker thread
+    auto terrain = std::make_unique<ADT::TileTerrain>();
+
+    if (!terrain_loader(tile_index, *terrain))
+      return;
+
+    std::vector<CAaBox> bounds;
+
+    if (bounds_loader)
+      bounds_loader(tile_index, bounds);
+
+    heightmaps[i] = std::make_unique<DataStructures::MapAreaOcclusionHeightmap>();
+    BuildTileHeightmap(tile_index, *terrain, bounds, *heightmaps[i]);
+  }, n_threads);
+
+  std::size_t n_generated = 0;
+
+  for (std::size_t i = 0; i < dirty_tiles.size(); ++i)
+  {
+    TileIndex const tile_index {static_cast<std::uint16_t>(dirty_tiles[i] % 64)
+                                , static_cast<std::uint16_t>(dirty_tiles[i] / 64)};
+
+    if (heightmaps[i])
+    {
+      _occlusion.AddTile(tile_index) = *heightmaps[i];
+      ++n_generated;
+    }
+    else
+    {
+      _occlusion.RemoveTile(tile_index);
+    }
+
+    _dirty_tiles.reset(dirty_tiles[i]);
+  }
+
+  return n_generated;
+}
+
+void OcclusionGenerator::BuildTileHeightmap(TileIndex tile_index
+                                            , ADT::TileTerrain const& terrain
+                                            , std::vector<CAaBox> const& map_object_bounds
+                                            , DataStructures::MapAreaOcclusionHeightmap& heightmap)
+{
+  std::array<std::array<float, 4>, WorldConstants::CHUNKS_PER_TILE> quarter_maxima;
+
+  auto quarter_maxima_of = &QuarterMaxima;
+
+#if defined(UTILS_SIMD)
+  if (Utils::Misc::SIMD::IsEnabled())
+    quarter_maxima_of = &QuarterMaximaSIMD;
+#endif
+
+  for (std::size_t i = 0; i < WorldConstants::CHUNKS_PER_TILE; ++i)
+    quarter_maxima[i] = quarter_maxima_of(terrain[i]);
+
+  std::array<float, N_OUTER * N_OUTER> outer;
+  std::array<float, N_INNER * N_INNER> inner;
+
+  // corners: quarters of up to four chunks touching the corner
+  for (unsigned y = 0; y < N_OUTER; ++y)
+  {
+    for (unsigned x = 0; x < N_OUTER; ++x)
+    {
+      float max_height = -std::numeric_limits<float>::infinity();
+
+      for (unsigned chunk_y = y ? y - 1 : 0; chunk_y <= std::min(y, N_INNER - 1); ++chunk_y)
+      {
+        for (unsigned chunk_x = x ? x - 1 : 0; chunk_x <= std::min(x, N_INNER - 1); ++chunk_x)
+        {
+          unsigned const quarter = (chunk_x < x ? 1 : 0) + (chunk_y < y ? 2 : 0);
+          max_height = std::max(max_height, quarter_maxima[chunk_y * N_INNER + chunk_x][quarter]);
+        }
+      }
+
+      outer[y * N_OUTER + x] = max_height;
+    }
+  }
+
+  // centers: whole chunk
+  for (std::size_t i = 0; i < WorldConstants::CHUNKS_PER_TILE; ++i)
+    inner[i] = *std::max_element(quarter_maxima[i].begin(), quarter_maxima[i].end());
+
+  float const tile_x = tile_index.x * WorldConstants::TILE_SIZE;
+  float const tile_z = tile_index.y * WorldConstants::TILE_SIZE;
+
+  for (CAaBox const& box : map_object_bounds)
+  {
+    for (unsigned y = 0; y < N_OUTER; ++y)
+    {
+      for (unsigned x = 0; x < N_OUTER; ++x)
+      {
+        float const x_min = tile_x + std::max(x - 0.5f, 0.f) * WorldConstants::CHUNK_SIZE;
+        float const x_max = tile_x + std::min(x + 0.5f, float(N_INNER)) * WorldConstants::CHUNK_SIZE;
+        float const z_min = tile_z + std::max(y - 0.5f, 0.f) * WorldConstants::CHUNK_SIZE;
+        float const z_max = tile_z + std::min(y + 0.5f, float(N_INNER)) * WorldConstants::CHUNK_SIZE;
+
+        if (Covers(box, x_min, x_max, z_min, z_max))
+          outer[y * N_OUTER + x] = std::max(outer[y * N_OUTER + x], box.max.y);
+      }
+    }
+
+    for (unsigned y = 0; y < N_INNER; ++y)
+    {
+      for (unsigned x = 0; x < N_INNER; ++x)
+      {
+        float const x_min = tile_x + x * WorldConstants::CHUNK_SIZE;
+        float const z_min = tile_z + y * WorldConstants::CHUNK_SIZE;
+
+        if (Covers(box, x_min, x_min + WorldConstants::CHUNK_SIZE, z_min, z_min + WorldConstants::CHUNK_SIZE))
+          inner[y * N_INNER + x] = std::max(inner[y * N_INNER + x], box.max.y);
+      }
+    }
+  }
+
+  auto out = heightmap.interleaved_heightmap.begin();
+  out = std::transform(outer.begin(), outer.end(), out, QuantizeHeight);
+  std::transform(inner.begin(), inner.end(), out, QuantizeHeight);
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <IO/Common.hpp>
+#include <IO/CommonDataStructures.hpp>
+#include <IO/WorldConstants.hpp>
+#include <IO/ADT/Root/TileTerrain.hpp>
+#include <IO/WDT/WDTOcclusion.hpp>
+
+#include <bitset>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace IO::WDT
+{
+  /**
+   * Produces occlusion heightmaps (MAOH) and their index (MAOI) from ADT terrain.
+   * Only tiles marked dirty are regenerated, which allows to keep occlusion data in sync with edited ADTs cheaply.
+   */
+  class OcclusionGenerator
+  {
+  public:
+    /**
+     * Loads terrain of a tile. Invoked concurrently from worker threads, must be thread-safe.
+     * Must match signature: bool(Common::DataStructures::TileIndex tile_index, ADT::TileTerrain& terrain).
+     * ADT::ExtractTileTerrain() fills terrain from a root ADT.
+     * Returns false if tile does not exist, in which case it is removed from occlusion data.
+     */
+    using TerrainLoader = std::function<bool(Common::DataStructures::TileIndex, ADT::TileTerrain&)>;
+
+    /**
+     * Loads bounding boxes of map objects (WMOs) placed on a tile, e.g. MODF extents.
+     * Invoked concurrently from worker threads, must be thread-safe.
+     * Must match signature: void(Common::DataStructures::TileIndex tile_index
+     *                            , std::vector<Common::DataStructures::CAaBox>& bounds).
+     */
+    using MapObjectBoundsLoader = std::function<void(Common::DataStructures::TileIndex
+                                                     , std::vector<Common::DataStructures::CAaBox>&)>;
+
+    explicit OcclusionGenerator(WDTOcclusion& occlusion);
+
+    /**
+     * Marks a tile for regeneration, e.g. after its root ADT was changed.
+     * @param tile_index Tile coordinates on WDT grid.
+     */
+    void MarkTileDirty(Common::DataStructures::TileIndex tile_index);
+
+    /**
+     * Marks every tile of the map for regeneration.
+     */
+    void MarkAllTilesDirty() { _dirty_tiles.set(); };
+
+    [[nodiscard]]
+    std::size_t NumDirtyTiles() const { return _dirty_tiles.count(); };
+
+    /**
+     * Regenerates all dirty tiles in parallel and clears their dirty state.
+     * If a loader throws, the exception is propagated, and occlusion data and dirty state are left intact.
+     * @param terrain_loader Terrain loader callback.
+     * @param bounds_loader Optional map object bounds loader callback.
+     * @param n_threads Number of worker threads. 0 means hardware concurrency.
+     * @return Number of tiles regenerated (present tiles only).
+     */
+    std::size_t Generate(TerrainLoader const& terrain_loader
+                         , MapObjectBoundsLoader const& bounds_loader = nullptr
+                         , unsigned n_threads = 0);
+
+    /**
+     * Computes the occlusion heightmap of a tile. Layout matches WDL MARE: 17x17 chunk corner samples
+     * followed by 16x16 chunk center samples. Center samples hold the maximum terrain height of their chunk,
+     * corner samples the maximum of the chunk quarters around the corner. Quarters made of holes only
+     * are ignored. Samples whose whole area lies within the horizontal footprint of a map object box are raised
+     * to the top of the box.
+     * @param tile_index Tile coordinates on WDT grid.
+     * @param terrain Terrain of a tile.
+     * @param map_object_bounds Bounding boxes of map objects, in placement coordinates (y is up).
+     * @param heightmap Heightmap to write the result to.
+     */
+    static void BuildTileHeightmap(Common::DataStructures::TileIndex tile_index
+                                   , ADT::TileTerrain const& terrain
+                                   , std::vector<Common::DataStructures::CAaBox> const& map_object_bounds
+                                   , DataStructures::MapAreaOcclusionHeightmap& heightmap);
+
+  private:
+    WDTOcclusion& _occlusion;
+    std::bitset<Common::WorldConstants::MAX_TILES_PER_MAP> _dirty_tiles;
+  };
+}
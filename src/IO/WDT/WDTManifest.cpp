@@ -0,0 +1,272 @@
+#include <IO/WDT/WDTManifest.hpp>
+#include <IO/ADT/DataStructures.hpp>
+#include <IO/ADT/ChunkIdentifiers.hpp>
+#include <IO/Storage/ClientStorage.hpp>
+#include <IO/Storage/FileKey.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <Utils/PathUtils.hpp>
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <mutex>
+
+using namespace IO::WDT;
+using namespace IO::Common;
+
+namespace
+{
+  // number of FileDataID components per tile in MAID
+  constexpr std::size_t N_TILE_COMPONENTS = sizeof(IO::WDT::DataStructures::MapAreaID) / sizeof(std::uint32_t);
+
+  // component indices matching the layout of DataStructures::MapAreaID
+  constexpr std::size_t ROOT_ADT_COMPONENT = 0;
+  constexpr std::size_t TEX0_ADT_COMPONENT = 3;
+
+  /**
+   * Builds game format filepaths of all tile components in the order of DataStructures::MapAreaID fields.
+   */
+  std::array<std::string, N_TILE_COMPONENTS> TileComponentFilepaths(std::string const& map_name
+                                                                    , std::uint16_t x
+                                                                    , std::uint16_t y)
+  {
+    std::string const tile_name = map_name + "_" + std::to_string(x) + "_" + std::to_string(y);
+    std::string const map_dir = "world/maps/" + map_name + "/";
+    std::string const map_texture_dir = "world/maptextures/" + map_name + "/";
+
+    char minimap_name[16];
+    std::snprintf(minimap_name, sizeof(minimap_name), "map%02u_%02u.blp", x, y);
+
+    return
+    {
+      Utils::PathUtils::NormalizeFilepathGame(map_dir + tile_name + ".adt"),
+      Utils::PathUtils::NormalizeFilepathGame(map_dir + tile_name + "_obj0.adt"),
+      Utils::PathUtils::NormalizeFilepathGame(map_dir + tile_name + "_obj1.adt"),
+      Utils::PathUtils::NormalizeFilepathGame(map_dir + tile_name + "_tex0.adt"),
+      Utils::PathUtils::NormalizeFilepathGame(map_dir + tile_name + "_lod.adt"),
+      Utils::PathUtils::NormalizeFilepathGame(map_texture_dir + tile_name + ".blp"),
+      Utils::PathUtils::NormalizeFilepathGame(map_texture_dir + tile_name + "_n.blp"),
+      Utils::PathUtils::NormalizeFilepathGame("world/minimaps/" + map_name + "/" + minimap_name)
+    };
+  }
+
+  /**
+   * Determines if alpha layers of a chunk are stored in highres (8-bit) format.
+   * Compressed layers are always highres, uncompressed ones are identified by their size in MCAL.
+   */
+  bool IsHighresAlpha(std::array<IO::ADT::DataStructures::SMLayer, WorldConstants::CHUNK_MAX_TEXTURE_LAYERS> const& layers
+                      , std::size_t n_layers
+                      , std::uint32_t alpha_size)
+  {
+    for (std::size_t i = 1; i < n_layers; ++i)
+    {
+      if (!layers[i].flags.use_alpha_map)
+        continue;
+
+      if (layers[i].flags.alpha_map_compressed)
+        return true;
+
+      std::uint32_t const end = i + 1 < n_layers ? layers[i + 1].offsetInMCAL : alpha_size;
+
+      if (end > layers[i].offsetInMCAL && end - layers[i].offsetInMCAL == WorldConstants::N_BYTES_PER_HIGHRES_ALPHA)
+        return true;
+    }
+
+    return false;
+  }
+
+  /**
+   * Reads MCLY content at the current position of the buffer.
+   * @return Number of layers read.
+   */
+  std::size_t ReadLayers(ByteBuffer const& buf
+                         , std::uint32_t size
+                         , std::array<IO::ADT::DataStructures::SMLayer, WorldConstants::CHUNK_MAX_TEXTURE_LAYERS>& layers)
+  {
+    std::size_t const n_layers = std::min<std::size_t>(size / sizeof(IO::ADT::DataStructures::SMLayer), layers.size());
+    buf.Read(layers.begin(), layers.begin() + n_layers);
+    return n_layers;
+  }
+
+  /**
+   * Invokes callback for every chunk in range [begin, end) of the buffer, skipping chunk data in between.
+   * Callback must match signature void(ChunkHeader const& chunk_header, std::size_t chunk_pos).
+   * Buffer position at the moment of invocation is the beginning of chunk data.
+   */
+  template<typename Callback>
+  void ForEachChunk(ByteBuffer const& buf, std::size_t begin, std::size_t end, Callback&& callback)
+  {
+    std::size_t pos = begin;
+
+    while (pos + sizeof(ChunkHeader) <= end)
+    {
+      buf.Seek(pos);
+      ChunkHeader const chunk_header = buf.Read<ChunkHeader>();
+      std::size_t const data_pos = pos + sizeof(ChunkHeader);
+
+      if (data_pos + chunk_header.size > end) [[unlikely]]
+      {
+        LogError("Chunk %s at offset %d exceeds its parent bounds. Scanning stopped."
+                 , FourCCToStr(chunk_header.fourcc).c_str(), pos);
+        return;
+      }
+
+      callback(chunk_header, pos);
+      pos = data_pos + chunk_header.size;
+    }
+  }
+}
+
+MapManifest MapManifest::Scan(Storage::ClientStorage& storage, std::string const& map_name, unsigned n_threads)
+{
+  LogDebugF(LCodeZones::FILE_IO, "Scanning tiles of map \"%s\".", map_name.c_str());
+
+  std::vector<std::string> filepaths;
+  filepaths.reserve(WorldConstants::MAX_TILES_PER_MAP * N_TILE_COMPONENTS);
+
+  for (std::uint16_t y = 0; y < 64; ++y)
+  {
+    for (std::uint16_t x = 0; x < 64; ++x)
+    {
+      auto tile_filepaths = TileComponentFilepaths(map_name, x, y);
+      std::move(tile_filepaths.begin(), tile_filepaths.end(), std::back_inserter(filepaths));
+    }
+  }
+
+  std::vector<std::uint32_t> file_data_ids = storage.Listfile().GetFileDataIDsForFilepaths(filepaths);
+
+  // MPQ-based clients: tiles created in the project directory are unknown to the listfile until first access.
+  if (storage.ClientVersion() < ClientVersion::WOD)
+  {
+    for (std::size_t i = 0; i < file_data_ids.size(); ++i)
+    {
+      std::size_t const component = i % N_TILE_COMPONENTS;
+
+      if (file_data_ids[i] || (component != ROOT_ADT_COMPONENT && component != TEX0_ADT_COMPONENT))
+        continue;
+
+      // the layer index covers the project directory and every overlay, and honors whiteouts
+      if (storage.FindLayer(filepaths[i]) != Storage::ClientStorage::NO_LAYER)
+        file_data_ids[i] = storage.Listfile().GetOrAddFileDataID(filepaths[i]);
+    }
+  }
+
+  MapManifest manifest;
+  ClientVersion const client_version = storage.ClientVersion();
+
+  // client loaders and listfile are not thread-safe, only file parsing is done concurrently.
+  std::mutex storage_mutex;
+
+  auto read_file = [&](std::uint32_t file_data_id, ByteBuffer& buf) -> bool
+  {
+    std::lock_guard lock {storage_mutex};
+    return Storage::FileKey{storage, file_data_id}.Read(buf) == Storage::FileKey::FileReadStatus::SUCCESS;
+  };
+
+  Utils::Misc::ParallelFor(WorldConstants::MAX_TILES_PER_MAP, [&](std::size_t i)
+  {
+    TileManifest& tile = manifest._tiles[i];
+    std::memcpy(&tile.file_data_ids, &file_data_ids[i * N_TILE_COMPONENTS], sizeof(tile.file_data_ids));
+
+    if (!tile.file_data_ids.root_adt)
+      return;
+
+    ByteBuffer root_buf;
+
+    if (!read_file(tile.file_data_ids.root_adt, root_buf))
+    {
+      tile.file_data_ids = {};
+      return;
+    }
+
+    tile.exists = true;
+    ScanRootADT(root_buf, client_version, tile);
+
+    if (client_version >= ClientVersion::CATA && tile.file_data_ids.tex0_adt)
+    {
+      ByteBuffer tex_buf;
+
+      if (read_file(tile.file_data_ids.tex0_adt, tex_buf))
+        ScanTexADT(tex_buf, tile);
+    }
+  }, n_threads);
+
+  return manifest;
+}
+
+void MapManifest::ScanRootADT(ByteBuffer const& buf, ClientVersion client_version, TileManifest& tile)
+{
+  ForEachChunk(buf, 0, buf.Size(), [&](ChunkHeader const& chunk_header, std::size_t chunk_pos)
+  {
+    if (chunk_header.fourcc != ADT::ChunkIdentifiers::ADTRootChunks::MCNK
+        || chunk_header.size < sizeof(ADT::DataStructures::SMChunk))
+      return;
+
+    ADT::DataStructures::SMChunk const mcnk_header = buf.Read<ADT::DataStructures::SMChunk>();
+    tile.has_vertex_color |= static_cast<bool>(mcnk_header.flags.has_mccv);
+
+    // since Cata texture layers are stored in tex0
+    if (client_version >= ClientVersion::CATA || tile.uses_highres_alpha || mcnk_header.nLayers < 2
+        || !mcnk_header.ofsLayer || !mcnk_header.ofsAlpha)
+      return;
+
+    std::size_t const chunk_end = chunk_pos + sizeof(ChunkHeader) + chunk_header.size;
+    std::size_t const layers_pos = chunk_pos + mcnk_header.ofsLayer;
+    std::size_t const alpha_pos = chunk_pos + mcnk_header.ofsAlpha;
+
+    if (layers_pos + sizeof(ChunkHeader) > chunk_end || alpha_pos + sizeof(ChunkHeader) > chunk_end) [[unlikely]]
+      return;
+
+    std::array<ADT::DataStructures::SMLayer, WorldConstants::CHUNK_MAX_TEXTURE_LAYERS> layers {};
+
+    buf.Seek(layers_pos);
+    ChunkHeader const layers_header = buf.Read<ChunkHeader>();
+    std::size_t const n_layers = ReadLayers(buf, layers_header.size, layers);
+
+    buf.Seek(alpha_pos);
+    ChunkHeader const alpha_header = buf.Read<ChunkHeader>();
+
+    tile.uses_highres_alpha = IsHighresAlpha(layers, n_layers, alpha_header.size);
+  });
+}
+
+void MapManifest::ScanTexADT(ByteBuffer const& buf, TileManifest& tile)
+{
+  ForEachChunk(buf, 0, buf.Size(), [&](ChunkHeader const& chunk_header, std::size_t chunk_pos)
+  {
+    switch (chunk_header.fourcc)
+    {
+      case ADT::ChunkIdentifiers::ADTTexChunks::MTXP:
+        tile.uses_height_texturing |= chunk_header.size > 0;
+        return;
+      case ADT::ChunkIdentifiers::ADTTexChunks::MCNK:
+        break;
+      default:
+        return;
+    }
+
+    if (tile.uses_highres_alpha)
+      return;
+
+    std::array<ADT::DataStructures::SMLayer, WorldConstants::CHUNK_MAX_TEXTURE_LAYERS> layers {};
+    std::size_t n_layers = 0;
+    std::uint32_t alpha_size = 0;
+
+    std::size_t const data_pos = chunk_pos + sizeof(ChunkHeader);
+
+    ForEachChunk(buf, data_pos, data_pos + chunk_header.size
+                 , [&](ChunkHeader const& subchunk_header, std::size_t)
+    {
+      if (subchunk_header.fourcc == ADT::ChunkIdentifiers::ADTTexMCNKSubchunks::MCLY)
+        n_layers = ReadLayers(buf, subchunk_header.size, layers);
+      else if (subchunk_header.fourcc == ADT::ChunkIdentifiers::ADTTexMCNKSubchunks::MCAL)
+        alpha_size = subchunk_header.size;
+    });
+
+    tile.uses_highres_alpha = IsHighresAlpha(layers, n_layers, alpha_size);
+  });
+}
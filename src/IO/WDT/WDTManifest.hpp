@@ -0,0 +1,93 @@
+#pragma once
+#include <IO/Common.hpp>
+#include <IO/CommonDataStructures.hpp>
+#include <IO/WorldConstants.hpp>
+#include <IO/WDT/DataStructures.hpp>
+#include <IO/WDT/WDTRoot.hpp>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace IO::Storage
+{
+  class ClientStorage;
+}
+
+namespace IO::WDT
+{
+  /**
+   * Summary of the content of one map tile relevant to WDT root.
+   */
+  struct TileManifest
+  {
+    bool exists = false; ///> Root ADT of the tile exists.
+    bool has_vertex_color = false; ///> At least one chunk uses MCCV.
+    bool uses_highres_alpha = false; ///> At least one alpha layer is stored in 8-bit (highres) format.
+    bool uses_height_texturing = false; ///> Texture ADT provides height texturing parameters (MTXP).
+    DataStructures::MapAreaID file_data_ids {}; ///> FileDataIDs of tile components. 0 if component does not exist.
+  };
+
+  /**
+   * Describes actual content of all tiles of a map. Used to bring WDT root (MAIN, MAID, MPHD) in sync
+   * with ADTs after tiles were added, removed or edited.
+   */
+  class MapManifest
+  {
+  public:
+    /**
+     * Scans all tiles of a map in parallel. Only the chunks required to fill TileManifest are inspected,
+     * the rest of the file is skipped over by chunk headers. Component FileDataIDs of all tiles are resolved
+     * with one batched listfile lookup.
+     * @param storage Client storage.
+     * @param map_name Map directory name (e.g. "Azeroth").
+     * @param n_threads Number of worker threads. 0 means hardware concurrency.
+     * @return Manifest of the map.
+     */
+    [[nodiscard]]
+    static MapManifest Scan(Storage::ClientStorage& storage, std::string const& map_name, unsigned n_threads = 0);
+
+    /**
+     * Rewrites MAIN tile flags, MAID (BfA+) and MPHD flags of WDT root to match the manifest.
+     * Flags not derived from tile content are preserved.
+     * @tparam client_version Version of the client.
+     * @param wdt WDT root to update.
+     * @return Number of tiles whose presence has changed.
+     */
+    template<Common::ClientVersion client_version>
+    std::size_t Apply(WDTRoot<client_version>& wdt) const;
+
+    [[nodiscard]]
+    TileManifest& Tile(Common::DataStructures::TileIndex tile_index) { return _tiles[tile_index.y * 64 + tile_index.x]; };
+
+    [[nodiscard]]
+    TileManifest const& Tile(Common::DataStructures::TileIndex tile_index) const
+    {
+      return _tiles[tile_index.y * 64 + tile_index.x];
+    };
+
+    [[nodiscard]]
+    std::array<TileManifest, Common::WorldConstants::MAX_TILES_PER_MAP> const& Tiles() const { return _tiles; };
+
+    /**
+     * Scans root ADT content. Exposed for reuse with files not coming from ClientStorage.
+     * @param buf Buffer containing root ADT.
+     * @param client_version Version of the client.
+     * @param tile Manifest to update.
+     */
+    static void ScanRootADT(Common::ByteBuffer const& buf, Common::ClientVersion client_version, TileManifest& tile);
+
+    /**
+     * Scans texture ADT (tex0) content (Cata+).
+     * @param buf Buffer containing texture ADT.
+     * @param tile Manifest to update.
+     */
+    static void ScanTexADT(Common::ByteBuffer const& buf, TileManifest& tile);
+
+  private:
+    std::array<TileManifest, Common::WorldConstants::MAX_TILES_PER_MAP> _tiles {};
+  };
+}
+
+#include <IO/WDT/WDTManifest.inl>
@@ -0,0 +1,80 @@
+#pragma once
+#include <IO/WDT/WDTManifest.hpp>
+#include <Utils/Meta/Future.hpp>
+
+#include <algorithm>
+
+namespace IO::WDT
+{
+  template<Common::ClientVersion client_version>
+  std::size_t MapManifest::Apply(WDTRoot<client_version>& wdt) const
+  {
+    using HeaderFlags = DataStructures::MapHeaderFlags<client_version>;
+    using AreaFlags = DataStructures::MapAreaInfoFlags<client_version>;
+
+    auto& header = wdt.MapHeader();
+
+    if (!header.IsInitialized())
+      header.Initialize(DataStructures::MapHeader<client_version>{});
+
+    auto& area_index = wdt.MapAreaIndex();
+
+    if (!area_index.IsInitialized())
+      area_index.Initialize(DataStructures::MapAreaInfo<client_version>{}, Common::WorldConstants::MAX_TILES_PER_MAP);
+
+    std::size_t n_changed = 0;
+
+    for (auto&& [i, tile] : future::enumerate(_tiles))
+    {
+      auto& flags = area_index[i].flags;
+      bool const existed = static_cast<std::uint32_t>(flags) & AreaFlags::TileExists;
+
+      if (existed != tile.exists)
+        ++n_changed;
+
+      flags.SetFlag(AreaFlags::TileExists, tile.exists);
+    }
+
+    auto any_of_tiles = [this](auto&& predicate)
+    {
+      return std::any_of(_tiles.begin(), _tiles.end(), [&](TileManifest const& tile)
+      {
+        return tile.exists && predicate(tile);
+      });
+    };
+
+    if constexpr (requires { HeaderFlags::SupportsVertexColor; })
+    {
+      header.data.flags.SetFlag(HeaderFlags::SupportsVertexColor
+                                , any_of_tiles([](TileManifest const& tile) { return tile.has_vertex_color; }));
+    }
+
+    if constexpr (requires { HeaderFlags::UseHighresAlphamap; })
+    {
+      header.data.flags.SetFlag(HeaderFlags::UseHighresAlphamap
+                                , any_of_tiles([](TileManifest const& tile) { return tile.uses_highres_alpha; }));
+    }
+
+    if constexpr (requires { HeaderFlags::SupportsHeightTextureBlending; })
+    {
+      header.data.flags.SetFlag(HeaderFlags::SupportsHeightTextureBlending
+                                , any_of_tiles([](TileManifest const& tile) { return tile.uses_height_texturing; }));
+    }
+
+    if constexpr (client_version >= Common::ClientVersion::BFA)
+    {
+      auto& file_data_ids = wdt.MapAreaFileDataIDs();
+
+      if (!file_data_ids.IsInitialized())
+        file_data_ids.Initialize(DataStructures::MapAreaID{}, Common::WorldConstants::MAX_TILES_PER_MAP);
+
+      for (auto&& [i, tile] : future::enumerate(_tiles))
+        file_data_ids[i] = tile.exists ? tile.file_data_ids : DataStructures::MapAreaID{};
+
+      header.data.flags.SetFlag(HeaderFlags::LodADTByFileDataID
+                                , any_of_tiles([](TileManifest const& tile) { return tile.file_data_ids.root_adt; }));
+    }
+
+    return n_changed;
+  }
+}
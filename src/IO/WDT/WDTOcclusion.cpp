@@ -0,0 +1,104 @@
+#include <IO/WDT/WDTOcclusion.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+using namespace IO::WDT;
+using namespace IO::WDT::DataStructures;
+using namespace IO::Common;
+
+WDTOcclusion::WDTOcclusion()
+{
+  _version.Initialize(18);
+}
+
+WDTOcclusion::WDTOcclusion(Common::ByteBuffer const& buf)
+{
+  Read(buf);
+}
+
+std::size_t WDTOcclusion::FindTile(Common::DataStructures::TileIndex tile_index) const
+{
+  RequireF(CCodeZones::FILE_IO, tile_index.x < 64 && tile_index.y < 64, "Tile index out of bounds.");
+
+  for (std::size_t i = 0; i < _occlusion_index.Size(); ++i)
+  {
+    auto const& entry = _occlusion_index[i];
+
+    if (entry.tile_index.x == tile_index.x && entry.tile_index.y == tile_index.y)
+      return i;
+  }
+
+  return _occlusion_index.Size();
+}
+
+bool WDTOcclusion::HasTile(Common::DataStructures::TileIndex tile_index) const
+{
+  return FindTile(tile_index) < _occlusion_index.Size();
+}
+
+MapAreaOcclusionHeightmap& WDTOcclusion::Tile(Common::DataStructures::TileIndex tile_index)
+{
+  std::size_t const pos = FindTile(tile_index);
+  RequireF(CCodeZones::FILE_IO, pos < _occlusion_index.Size(), "Requested tile (%d, %d) is not present."
+           , tile_index.x, tile_index.y);
+
+  std::size_t const heightmap_index = _occlusion_index[pos].offset / sizeof(MapAreaOcclusionHeightmap);
+  EnsureF(CCodeZones::FILE_IO, heightmap_index < _occlusion_heightmap.Size(), "MAOI entry points past MAOH.");
+
+  return _occlusion_heightmap[heightmap_index];
+}
+
+MapAreaOcclusionHeightmap const& WDTOcclusion::Tile(Common::DataStructures::TileIndex tile_index) const
+{
+  std::size_t const pos = FindTile(tile_index);
+  RequireF(CCodeZones::FILE_IO, pos < _occlusion_index.Size(), "Requested tile (%d, %d) is not present."
+           , tile_index.x, tile_index.y);
+
+  std::size_t const heightmap_index = _occlusion_index[pos].offset / sizeof(MapAreaOcclusionHeightmap);
+  EnsureF(CCodeZones::FILE_IO, heightmap_index < _occlusion_heightmap.Size(), "MAOI entry points past MAOH.");
+
+  return _occlusion_heightmap[heightmap_index];
+}
+
+MapAreaOcclusionHeightmap& WDTOcclusion::AddTile(Common::DataStructures::TileIndex tile_index)
+{
+  if (HasTile(tile_index))
+    return Tile(tile_index);
+
+  if (!_occlusion_index.IsInitialized())
+    _occlusion_index.Initialize();
+
+  if (!_occlusion_heightmap.IsInitialized())
+    _occlusion_heightmap.Initialize();
+
+  auto& entry = _occlusion_index.Add();
+  entry.tile_index = tile_index;
+  entry.offset = static_cast<std::uint32_t>(_occlusion_heightmap.Size() * sizeof(MapAreaOcclusionHeightmap));
+  entry.size = sizeof(MapAreaOcclusionHeightmap);
+
+  auto& heightmap = _occlusion_heightmap.Add();
+  heightmap.interleaved_heightmap.fill(0);
+
+  return heightmap;
+}
+
+void WDTOcclusion::RemoveTile(Common::DataStructures::TileIndex tile_index)
+{
+  std::size_t const pos = FindTile(tile_index);
+
+  if (pos == _occlusion_index.Size())
+    return;
+
+  std::uint32_t const offset = _occlusion_index[pos].offset;
+  std::size_t const heightmap_index = offset / sizeof(MapAreaOcclusionHeightmap);
+  EnsureF(CCodeZones::FILE_IO, heightmap_index < _occlusion_heightmap.Size(), "MAOI entry points past MAOH.");
+
+  _occlusion_heightmap.Remove(heightmap_index);
+  _occlusion_index.Remove(pos);
+
+  for (auto& entry : _occlusion_index)
+  {
+    if (entry.offset > offset)
+      entry.offset -= sizeof(MapAreaOcclusionHeightmap);
+  }
+}
@@ -2,16 +2,65 @@
 #include <IO/Common.hpp>
 #include <IO/CommonTraits.hpp>
 #include <IO/CommonChunkIdentifiers.hpp>
+#include <IO/CommonDataStructures.hpp>
 #include <IO/WDT/ChunkIdentifiers.hpp>
 #include <IO/WDT/DataStructures.hpp>
 
 namespace IO::WDT
 {
+  /**
+   * WDT occlusion file (_occ.wdt). Holds per-tile occlusion heightmaps (MAOH) addressed by an index (MAOI).
+   */
   class WDTOcclusion : public Common::Traits::AutoIOTraitInterface<WDTOcclusion, Common::Traits::TraitType::File>
   {
     AutoIOTraitInterfaceUser;
 
+  public:
+    WDTOcclusion();
+    explicit WDTOcclusion(Common::ByteBuffer const& buf);
+
+    /**
+     * Checks if an occlusion heightmap is present for a tile.
+     * @param tile_index Tile coordinates on WDT grid.
+     * @return True if tile is present.
+     */
+    [[nodiscard]]
+    bool HasTile(Common::DataStructures::TileIndex tile_index) const;
+
+    /**
+     * Returns occlusion heightmap of a tile. Tile must be present.
+     * @param tile_index Tile coordinates on WDT grid.
+     * @return Reference to heightmap. Invalidated by adding or removing tiles.
+     */
+    [[nodiscard]]
+    DataStructures::MapAreaOcclusionHeightmap& Tile(Common::DataStructures::TileIndex tile_index);
+
+    [[nodiscard]]
+    DataStructures::MapAreaOcclusionHeightmap const& Tile(Common::DataStructures::TileIndex tile_index) const;
+
+    /**
+     * Adds a tile with zero heightmap, or returns an existing one. Not thread-safe.
+     * @param tile_index Tile coordinates on WDT grid.
+     * @return Reference to heightmap. Invalidated by adding or removing tiles.
+     */
+    DataStructures::MapAreaOcclusionHeightmap& AddTile(Common::DataStructures::TileIndex tile_index);
+
+    /**
+     * Removes a tile and updates offsets of the following ones. No-op if tile is not present. Not thread-safe.
+     * @param tile_index Tile coordinates on WDT grid.
+     */
+    void RemoveTile(Common::DataStructures::TileIndex tile_index);
+
+    [[nodiscard]]
+    std::size_t NumTiles() const { return _occlusion_index.Size(); };
+
   private:
+    /**
+     * @return Position of a tile in MAOI, or MAOI size if tile is not present.
+     */
+    [[nodiscard]]
+    std::size_t FindTile(Common::DataStructures::TileIndex tile_index) const;
+
     Common::DataChunk
     <
       std::uint32_t
@@ -40,4 +89,4 @@ namespace IO::WDT
     > _auto_trait {};
 
   };
-}
\ No newline at end of file
+}
@@ -6,6 +6,7 @@
 #include <IO/CommonChunkIdentifiers.hpp>
 #include <IO/WDT/DataStructures.hpp>
 #include <IO/WDT/ChunkIdentifiers.hpp>
+#include <Utils/Misc/ForceInline.hpp>
 
 namespace IO::WDT
 {
@@ -73,6 +74,11 @@ namespace IO::WDT
         Common::Traits::TraitEntry<&WDTFiledataIDBasedComponent::_map_area_filedataid_index>
         , Common::Traits::TraitEntry<&WDTFiledataIDBasedComponent::_global_map_object_placement>
       > _auto_trait {};
+
+    // getters
+    public:
+      [[nodiscard]] FORCEINLINE auto& MapAreaFileDataIDs() { return _map_area_filedataid_index; };
+      [[nodiscard]] FORCEINLINE auto const& MapAreaFileDataIDs() const { return _map_area_filedataid_index; };
     };
 
   }
@@ -134,5 +140,13 @@ namespace IO::WDT
       , Common::Traits::TraitEntry<&WDTRoot::_map_header>
       , Common::Traits::TraitEntry<&WDTRoot::_map_area_index>
     > _auto_trait {};
+
+  // getters
+  public:
+    [[nodiscard]] FORCEINLINE auto& MapHeader() { return _map_header; };
+    [[nodiscard]] FORCEINLINE auto const& MapHeader() const { return _map_header; };
+
+    [[nodiscard]] FORCEINLINE auto& MapAreaIndex() { return _map_area_index; };
+    [[nodiscard]] FORCEINLINE auto const& MapAreaIndex() const { return _map_area_index; };
   };
 }
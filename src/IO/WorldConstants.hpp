@@ -107,6 +107,18 @@ namespace IO::Common::WorldConstants
    // Number of pixels per shadowmap (ADT::MCNK::MCSH)
    constexpr unsigned N_PIXELS_PER_SHADOWMAP = SHADOWMAP_DIM * SHADOWMAP_DIM;
 
+   // Number of vertices per outer row of a low resolution tile heightmap (WDL::MARE, WDT::MAOH).
+   constexpr unsigned N_VERTS_TILE_LOWRES_ROW_OUTER = 17;
+
+   // Number of vertices per inner row of a low resolution tile heightmap (WDL::MARE, WDT::MAOH).
+   constexpr unsigned N_VERTS_TILE_LOWRES_ROW_INNER = 16;
+
+   /**
+    * Number of height points in WDL::MARE.
+    */
+   constexpr unsigned MAP_AREA_LOWRES_HEIGHTMAP_SIZE = N_VERTS_TILE_LOWRES_ROW_OUTER * N_VERTS_TILE_LOWRES_ROW_OUTER
+       + N_VERTS_TILE_LOWRES_ROW_INNER * N_VERTS_TILE_LOWRES_ROW_INNER;
+
    /**
     * Number of height points in WDT::MAOH.
     */
@@ -231,6 +231,13 @@ namespace Utils::Meta::Templates
 
     VersionedEnum& operator=(ValueType other) { _data = other; return *this; };
 
+    /**
+     * Sets or clears bits of a flag. Only applicable to integral value types.
+     * @param flag Flag bits.
+     * @param state True to set, false to clear.
+     */
+    void SetFlag(ValueType flag, bool state) { _data = state ? (_data | flag) : (_data & ~flag); };
+
     template<auto other_client_version>
     [[nodiscard]]
     bool operator==(VersionedEnum<other_client_version, ValueType> const& other) const
@@ -0,0 +1,19 @@
+#pragma once
+#include <cstddef>
+
+namespace Utils::Misc
+{
+  /**
+   * Invokes callback for every index in range [0, n_items), distributing the work across a set of worker threads.
+   * Items are claimed dynamically one by one, so callbacks of uneven cost (e.g. missing tiles) balance out.
+   * The first exception thrown by any callback is rethrown on the calling thread after all workers finish.
+   * @tparam Callback Callable matching signature void(std::size_t index).
+   * @param n_items Number of items to process.
+   * @param callback Callback to invoke for each item. Must be safe to call concurrently for distinct indices.
+   * @param n_threads Number of worker threads. 0 means std::thread::hardware_concurrency().
+   */
+  template<typename Callback>
+  void ParallelFor(std::size_t n_items, Callback&& callback, unsigned n_threads = 0);
+}
+
+#include <Utils/Misc/ParallelFor.inl>
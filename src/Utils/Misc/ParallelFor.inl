@@ -0,0 +1,73 @@
+#pragma once
+#include <Utils/Misc/ParallelFor.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Utils::Misc
+{
+  template<typename Callback>
+  void ParallelFor(std::size_t n_items, Callback&& callback, unsigned n_threads)
+  {
+    if (!n_items)
+      return;
+
+    if (!n_threads)
+      n_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    n_threads = static_cast<unsigned>(std::min<std::size_t>(n_threads, n_items));
+
+    // no point in spawning threads for a single worker
+    if (n_threads == 1)
+    {
+      for (std::size_t i = 0; i < n_items; ++i)
+        callback(i);
+
+      return;
+    }
+
+    std::atomic<std::size_t> next_item = 0;
+    std::exception_ptr first_exception = nullptr;
+    std::mutex exception_mutex;
+
+    auto worker = [&]()
+    {
+      for (std::size_t i = next_item++; i < n_items; i = next_item++)
+      {
+        try
+        {
+          callback(i);
+        }
+        catch (...)
+        {
+          std::lock_guard lock {exception_mutex};
+
+          if (!first_exception)
+            first_exception = std::current_exception();
+
+          // drain remaining work so that other workers stop early
+          next_item = n_items;
+          return;
+        }
+      }
+    };
+
+    {
+      std::vector<std::jthread> workers;
+      workers.reserve(n_threads - 1);
+
+      for (unsigned i = 0; i < n_threads - 1; ++i)
+        workers.emplace_back(worker);
+
+      // calling thread participates as well
+      worker();
+    }
+
+    if (first_exception)
+      std::rethrow_exception(first_exception);
+  }
+}
@@ -0,0 +1,24 @@
+#include <Utils/Misc/SIMD.hpp>
+
+#include <atomic>
+
+namespace
+{
+#if defined(UTILS_SIMD)
+  std::atomic<bool> enabled {true};
+#else
+  std::atomic<bool> enabled {false};
+#endif
+}
+
+bool Utils::Misc::SIMD::IsEnabled()
+{
+  return enabled.load(std::memory_order_relaxed);
+}
+
+void Utils::Misc::SIMD::SetEnabled([[maybe_unused]] bool enable)
+{
+#if defined(UTILS_SIMD)
+  enabled.store(enable, std::memory_order_relaxed);
+#endif
+}
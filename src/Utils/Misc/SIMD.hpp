@@ -0,0 +1,35 @@
+#pragma once
+
+/**
+ * SSE2 and NEON are part of the base instruction set of x86-64 and AArch64, so kernels limited to them need no
+ * runtime detection. Defines UTILS_SIMD_SSE2 or UTILS_SIMD_NEON with the matching intrinsics header, and UTILS_SIMD
+ * if either is available.
+ */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define UTILS_SIMD_SSE2
+#  include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define UTILS_SIMD_NEON
+#  include <arm_neon.h>
+#endif
+
+#if defined(UTILS_SIMD_SSE2) || defined(UTILS_SIMD_NEON)
+#  define UTILS_SIMD
+#endif
+
+namespace Utils::Misc::SIMD
+{
+  /**
+   * @return True if kernels with an SSE2/NEON path use it, false if they use their scalar path.
+   * Defaults to true where UTILS_SIMD is defined. Both paths produce the same results.
+   */
+  [[nodiscard]]
+  bool IsEnabled();
+
+  /**
+   * Selects the SSE2/NEON or scalar path of kernels, e.g. to compare them. Enabling has no effect without UTILS_SIMD.
+   * Geometry batch kernels have their own selection, see IO::Common::Geometry::SetInstructionSet().
+   * Calls already running keep the previous path.
+   */
+  void SetEnabled(bool enabled);
+}
@@ -0,0 +1,129 @@
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <IO/ADT/Tex/AlphamapConverter.hpp>
+#include "SIMDTestHelpers.hpp"
+
+#include <array>
+#include <cstdint>
+#include <random>
+
+#if defined(_MSC_VER) & !defined(__INTEL_COMPILER)
+  #pragma warning(push)
+  #pragma warning(disable : 4267)
+  #pragma warning(disable : 4996)
+
+  #include <backward.hpp>
+
+  #pragma warning(pop)
+#else
+  #include <backward.hpp>
+#endif
+
+using namespace IO;
+using namespace IO::ADT;
+using namespace IO::Common;
+
+namespace
+{
+  constexpr std::size_t N_RANDOM_MAPS = 64;
+
+  using LowresAlpha = std::array<std::uint8_t, WorldConstants::N_BYTES_PER_LOWRES_ALPHA>;
+
+  std::mt19937 rng {20241019};
+
+  /**
+   * Nibbles expand to n * 17, requantization rounds to the nearest nibble, and fixing alpha duplicates the last row
+   * and column.
+   */
+  void TestKnownValues()
+  {
+    LowresAlpha lowres {};
+
+    for (std::size_t i = 0; i < lowres.size(); ++i)
+      lowres[i] = static_cast<std::uint8_t>(i * 7);
+
+    Alphamap alphamap;
+    AlphamapConverter::UnpackLowres(lowres, false, alphamap);
+
+    for (std::size_t i = 0; i < lowres.size(); ++i)
+    {
+      Ensure(alphamap[i * 2] == (lowres[i] & 0x0F) * 17 && alphamap[i * 2 + 1] == (lowres[i] >> 4) * 17
+             , "Unpacked nibble differs.");
+    }
+
+    LowresAlpha packed {};
+    AlphamapConverter::PackLowres(alphamap, packed);
+    Ensure(packed == lowres, "Lowres alpha did not survive a round trip.");
+
+    // 8 and 25 are the last values rounding down, 9 and 26 the first rounding up
+    alphamap.fill(0);
+    alphamap[0] = 8;
+    alphamap[1] = 9;
+    alphamap[2] = 25;
+    alphamap[3] = 26;
+    alphamap[4] = 255;
+    AlphamapConverter::PackLowres(alphamap, packed);
+    Ensure(packed[0] == 0x10 && packed[1] == 0x21 && packed[2] == 0x0F, "Requantized nibble differs.");
+
+    AlphamapConverter::UnpackLowres(lowres, true, alphamap);
+
+    constexpr std::size_t DIM = WorldConstants::ALPHAMAP_DIM;
+
+    for (std::size_t i = 0; i < DIM; ++i)
+    {
+      Ensure(alphamap[i * DIM + DIM - 1] == alphamap[i * DIM + DIM - 2], "Last column was not fixed.");
+      Ensure(alphamap[(DIM - 1) * DIM + i] == alphamap[(DIM - 2) * DIM + i], "Last row was not fixed.");
+    }
+  }
+
+  /**
+   * Both paths convert every byte value and random data the same way.
+   */
+  void TestRandomData()
+  {
+    std::uniform_int_distribution<unsigned> byte {0, 255};
+
+    for (std::size_t n = 0; n <= N_RANDOM_MAPS; ++n)
+    {
+      LowresAlpha lowres;
+      Alphamap alphamap;
+
+      for (std::size_t i = 0; i < alphamap.size(); ++i)
+      {
+        // the first map enumerates all byte values in every position
+        alphamap[i] = static_cast<std::uint8_t>(n ? byte(rng) : i + i / 256);
+
+        if (i < lowres.size())
+          lowres[i] = static_cast<std::uint8_t>(n ? byte(rng) : i + i / 256);
+      }
+
+      for (bool const fix_alpha : {false, true})
+      {
+        SIMDTestHelpers::EnsureSamePaths([&]
+        {
+          Alphamap unpacked;
+          AlphamapConverter::UnpackLowres(lowres, fix_alpha, unpacked);
+          return unpacked;
+        }, "Vectorized unpacking differs from the scalar one.");
+      }
+
+      SIMDTestHelpers::EnsureSamePaths([&]
+      {
+        LowresAlpha packed;
+        AlphamapConverter::PackLowres(alphamap, packed);
+        return packed;
+      }, "Vectorized packing differs from the scalar one.");
+    }
+  }
+}
+
+int main()
+{
+  backward::SignalHandling sh;
+  Validation::Log::InitLoggers();
+
+  SIMDTestHelpers::ForEachPath(&TestKnownValues);
+  TestRandomData();
+
+  return 0;
+}
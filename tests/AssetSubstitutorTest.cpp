@@ -0,0 +1,243 @@
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <IO/ByteBuffer.hpp>
+#include <IO/ADT/AssetSubstitutor.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#if defined(_MSC_VER) & !defined(__INTEL_COMPILER)
+  #pragma warning(push)
+  #pragma warning(disable : 4267)
+  #pragma warning(disable : 4996)
+
+  #include <backward.hpp>
+
+  #pragma warning(pop)
+#else
+  #include <backward.hpp>
+#endif
+
+using namespace IO;
+using namespace IO::ADT;
+using namespace IO::Common;
+using namespace IO::Common::DataStructures;
+
+namespace
+{
+  AssetReference const GRASS {"tileset/grass.blp", 0};
+  AssetReference const OLD_GRASS {"tileset/old_grass.blp", 0};
+  AssetReference const DIRT {"tileset/dirt.blp", 0};
+  AssetReference const SAND {"tileset/sand.blp", 0};
+  AssetReference const UNUSED {"tileset/unused.blp", 0};
+
+  constexpr TileIndex SUBSTITUTED_TILE {20, 30};
+  constexpr TileIndex UNTOUCHED_TILE {21, 30};
+
+  std::mt19937 rng {20241019};
+
+  AssetSubstitutor Substitutor()
+  {
+    return AssetSubstitutor{{{AssetKind::TEXTURE, OLD_GRASS, GRASS}, {AssetKind::TEXTURE, DIRT, SAND}}};
+  }
+
+  Alphamap RandomAlphamap()
+  {
+    std::uniform_int_distribution<int> alpha {0, 255};
+    Alphamap alphamap;
+
+    for (std::uint8_t& pixel : alphamap)
+      pixel = static_cast<std::uint8_t>(alpha(rng));
+
+    return alphamap;
+  }
+
+  /**
+   * Grass everywhere. Chunk 0 blends old grass over it, chunk 1 blends grass and old grass over dirt.
+   * The last texture is not used by any layer.
+   */
+  TileTexturing Texturing()
+  {
+    TileTexturing texturing;
+    texturing.textures = {GRASS, OLD_GRASS, DIRT, UNUSED};
+    texturing.height_textures = {11, 12, 13, 14};
+
+    for (std::uint32_t i = 0; i < texturing.textures.size(); ++i)
+      texturing.texture_params.push_back({{}, static_cast<float>(i + 1), 1.f, 0});
+
+    for (ChunkTexturing& chunk : texturing.chunks)
+      chunk.layers = {{0, {}, 0, 0}};
+
+    texturing.chunks[0].layers = {{0, {}, 0, 0}, {1, {}, 0, 0}};
+    texturing.chunks[0].alphamaps = {RandomAlphamap()};
+
+    texturing.chunks[1].layers = {{2, {}, 0, 0}, {0, {}, 0, 0}, {1, {}, 0, 0}};
+    texturing.chunks[1].alphamaps = {RandomAlphamap(), RandomAlphamap()};
+
+    return texturing;
+  }
+
+  /**
+   * Old grass collapses into grass and the unused texture is dropped. Height textures and texture parameters
+   * follow the table, layers of the same texture are merged.
+   */
+  void TestTextureMerge()
+  {
+    TileTexturing texturing = Texturing();
+    TileTexturing const original = texturing;
+    TilePlacements placements;
+    std::vector<std::uint32_t> texture_remap;
+    SubstitutionStats stats;
+
+    std::uint8_t const scope = AssetSubstitutor::SCOPE_TEXTURES | AssetSubstitutor::SCOPE_PLACEMENTS;
+    std::uint8_t const modified = Substitutor().SubstituteTile(scope, texturing, placements, texture_remap, stats);
+
+    std::vector<AssetReference> const textures {GRASS, SAND};
+    std::vector<std::uint32_t> const remap {0, 0, 1, AssetSubstitutor::REMOVED_TEXTURE};
+
+    // the substituted dirt loses its height texture, the collapsed old grass takes the one of grass
+    std::vector<std::uint32_t> const height_textures {11, 0};
+
+    Ensure(modified == AssetSubstitutor::SCOPE_TEXTURES, "Modified scope is wrong.");
+    Ensure(texturing.textures == textures, "Texture table was not compacted.");
+    Ensure(texture_remap == remap, "Texture remap is wrong.");
+    Ensure(texturing.height_textures == height_textures, "Height textures were not compacted.");
+    Ensure(texturing.texture_params.size() == 2
+           && texturing.texture_params[0].heightScale == 1.f && texturing.texture_params[1].heightScale == 3.f
+           , "Texture parameters were not compacted.");
+
+    Ensure(stats.n_textures == 2 && stats.n_merged_layers == 2 && stats.n_removed_entries == 2
+           , "Substitution stats are wrong.");
+
+    // merged into the base layer, the layer is dropped
+    Ensure(texturing.chunks[0].layers.size() == 1 && texturing.chunks[0].layers[0].textureId == 0
+           && texturing.chunks[0].alphamaps.empty(), "Layer was not merged into the base layer.");
+
+    // merged into a blended layer, weights add up
+    ChunkTexturing const& chunk = texturing.chunks[1];
+    Ensure(chunk.layers.size() == 2 && chunk.layers[0].textureId == 1 && chunk.layers[1].textureId == 0
+           && chunk.alphamaps.size() == 1, "Layer was not merged into the blended layer.");
+
+    for (std::size_t pixel = 0; pixel < chunk.alphamaps[0].size(); ++pixel)
+    {
+      int const expected = std::min(original.chunks[1].alphamaps[0][pixel]
+                                    + original.chunks[1].alphamaps[1][pixel], 255);
+      Ensure(chunk.alphamaps[0][pixel] == expected, "Merged weights do not add up.");
+    }
+
+    Ensure(texturing.chunks[2].layers.size() == 1 && texturing.chunks[2].layers[0].textureId == 0
+           , "Untouched chunk changed.");
+  }
+
+  /**
+   * Tiles not providing height textures and texture parameters keep them empty.
+   */
+  void TestNoPerTextureData()
+  {
+    TileTexturing texturing = Texturing();
+    texturing.height_textures.clear();
+    texturing.texture_params.clear();
+
+    TilePlacements placements;
+    std::vector<std::uint32_t> texture_remap;
+    SubstitutionStats stats;
+
+    Substitutor().SubstituteTile(AssetSubstitutor::SCOPE_TEXTURES, texturing, placements, texture_remap, stats);
+
+    Ensure(texturing.textures.size() == 2 && texturing.height_textures.empty() && texturing.texture_params.empty()
+           , "Per-texture data was made up.");
+  }
+
+  /**
+   * Only the tile the index lists is loaded and handed back, the index then follows the substitution
+   * and survives a write and read.
+   */
+  void TestIndex()
+  {
+    TileTexturing const untouched = [] { TileTexturing texturing; texturing.textures = {GRASS}; return texturing; }();
+
+    auto const load = [&](TileIndex tile_index, TileTexturing& texturing)
+    {
+      if (tile_index.x == SUBSTITUTED_TILE.x && tile_index.y == SUBSTITUTED_TILE.y)
+        texturing = Texturing();
+      else if (tile_index.x == UNTOUCHED_TILE.x && tile_index.y == UNTOUCHED_TILE.y)
+        texturing = untouched;
+      else
+        return false;
+
+      return true;
+    };
+
+    AssetIndex::TileSet tiles;
+    tiles.set(SUBSTITUTED_TILE.y * 64 + SUBSTITUTED_TILE.x);
+    tiles.set(UNTOUCHED_TILE.y * 64 + UNTOUCHED_TILE.x);
+
+    AssetIndex index = AssetIndex::Build(tiles, [&](TileIndex tile_index, TileAssets& assets)
+    {
+      TileTexturing texturing;
+
+      if (!load(tile_index, texturing))
+        return false;
+
+      assets = TileAssets::Collect(texturing, {});
+      return true;
+    }, 2);
+
+    Ensure(index.Tiles(AssetKind::TEXTURE, GRASS) == tiles, "Index misses tiles.");
+
+    std::atomic<unsigned> n_loaded {0};
+    std::atomic<unsigned> n_consumed {0};
+
+    SubstitutionStats const stats = Substitutor().Substitute(index
+      , [&](TileIndex tile_index, std::uint8_t scope, TileTexturing& texturing, TilePlacements&)
+      {
+        Ensure(scope == AssetSubstitutor::SCOPE_TEXTURES, "Object ADT was requested.");
+        ++n_loaded;
+        return load(tile_index, texturing);
+      }
+      , [&](TileIndex tile_index, std::uint8_t scope, TileTexturing const& texturing, TilePlacements const&
+            , std::span<std::uint32_t const> texture_remap)
+      {
+        Ensure(tile_index.x == SUBSTITUTED_TILE.x && tile_index.y == SUBSTITUTED_TILE.y, "Wrong tile was modified.");
+        Ensure(scope == AssetSubstitutor::SCOPE_TEXTURES && texture_remap.size() == 4
+               && texturing.height_textures.size() == texturing.textures.size(), "Modified tile is inconsistent.");
+        ++n_consumed;
+      }, 2);
+
+    Ensure(n_loaded == 1 && n_consumed == 1 && stats.n_tiles == 1
+           , "Tiles not referencing substituted files were loaded.");
+
+    AssetIndex::TileSet substituted;
+    substituted.set(SUBSTITUTED_TILE.y * 64 + SUBSTITUTED_TILE.x);
+
+    Ensure(index.Tiles(AssetKind::TEXTURE, OLD_GRASS).none() && index.Tiles(AssetKind::TEXTURE, DIRT).none()
+           , "Index still lists substituted files.");
+    Ensure(index.Tiles(AssetKind::TEXTURE, SAND) == substituted && index.Tiles(AssetKind::TEXTURE, GRASS) == tiles
+           , "Index misses replacement files.");
+
+    ByteBuffer buf {};
+    index.Write(buf);
+    buf.Seek(0);
+
+    AssetIndex read;
+    read.Read(buf);
+
+    Ensure(read.Tiles(AssetKind::TEXTURE, SAND) == substituted && read.Tiles(AssetKind::TEXTURE, GRASS) == tiles
+           && read.Tiles(AssetKind::TEXTURE, UNUSED).none(), "Index did not survive a write and read.");
+  }
+}
+
+int main()
+{
+  backward::SignalHandling sh;
+  Validation::Log::InitLoggers();
+
+  TestTextureMerge();
+  TestNoPerTextureData();
+  TestIndex();
+
+  return 0;
+}
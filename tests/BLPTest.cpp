@@ -0,0 +1,322 @@
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <IO/ByteBuffer.hpp>
+#include <IO/Common.hpp>
+#include <IO/BLP/BLPEncoder.hpp>
+#include "SIMDTestHelpers.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#if defined(_MSC_VER) & !defined(__INTEL_COMPILER)
+  #pragma warning(push)
+  #pragma warning(disable : 4267)
+  #pragma warning(disable : 4996)
+
+  #include <backward.hpp>
+
+  #pragma warning(pop)
+#else
+  #include <backward.hpp>
+#endif
+
+using namespace IO;
+using namespace IO::BLP;
+using namespace IO::BLP::DataStructures;
+
+namespace
+{
+  constexpr std::uint32_t WIDTH = 37;
+  constexpr std::uint32_t HEIGHT = 21;
+  constexpr std::uint32_t N_LEVELS = 6; // 37x21, 18x10, 9x5, 4x2, 2x1, 1x1
+  constexpr std::size_t N_RANDOM_BLOCKS = 2000;
+
+  std::mt19937 rng {20241019};
+
+  /**
+   * Smooth color and alpha gradients, so that DXT error stays small.
+   */
+  Image Gradient()
+  {
+    Image image {WIDTH, HEIGHT, std::vector<std::uint8_t>(std::size_t(WIDTH) * HEIGHT * 4)};
+
+    for (std::uint32_t y = 0; y < HEIGHT; ++y)
+    {
+      for (std::uint32_t x = 0; x < WIDTH; ++x)
+      {
+        std::uint8_t* pixel = image.pixels.data() + (std::size_t(y) * WIDTH + x) * 4;
+        pixel[0] = static_cast<std::uint8_t>(x * 255 / (WIDTH - 1));
+        pixel[1] = static_cast<std::uint8_t>(y * 255 / (HEIGHT - 1));
+        pixel[2] = 128;
+        pixel[3] = static_cast<std::uint8_t>((x + y) * 255 / (WIDTH + HEIGHT - 2));
+      }
+    }
+
+    return image;
+  }
+
+  std::array<std::array<int, 3>, 4> ColorPalette(std::uint8_t const* block)
+  {
+    auto expand = [](unsigned value) -> std::array<int, 3>
+    {
+      unsigned const r = (value >> 11) & 31;
+      unsigned const g = (value >> 5) & 63;
+      unsigned const b = value & 31;
+      return {int(r << 3 | r >> 2), int(g << 2 | g >> 4), int(b << 3 | b >> 2)};
+    };
+
+    unsigned const color0 = block[0] | block[1] << 8;
+    unsigned const color1 = block[2] | block[3] << 8;
+    std::array<std::array<int, 3>, 4> palette {expand(color0), expand(color1)};
+
+    for (unsigned c = 0; c < 3; ++c)
+    {
+      if (color0 > color1)
+      {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+      }
+      else
+      {
+        palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+        palette[3][c] = 0;
+      }
+    }
+
+    return palette;
+  }
+
+  /**
+   * Decodes a DXT1, DXT3 or DXT5 level into RGBA8. DXT1 alpha is left at 255.
+   */
+  std::vector<std::uint8_t> DecodeLevel(std::uint8_t const* data, std::uint32_t width, std::uint32_t height, BLPFormat format)
+  {
+    std::vector<std::uint8_t> pixels (std::size_t(width) * height * 4, 255);
+    std::size_t const block_size = format == BLPFormat::DXT1 ? 8 : 16;
+
+    for (std::uint32_t block_y = 0; block_y < (height + 3) / 4; ++block_y)
+    {
+      for (std::uint32_t block_x = 0; block_x < (width + 3) / 4; ++block_x, data += block_size)
+      {
+        std::uint8_t const* color = format == BLPFormat::DXT1 ? data : data + 8;
+        auto const palette = ColorPalette(color);
+        std::uint32_t const indices = color[4] | color[5] << 8 | color[6] << 16 | std::uint32_t(color[7]) << 24;
+
+        std::array<int, 8> alpha_palette {data[0], data[1]};
+
+        for (int k = 1; k < 7; ++k)
+          alpha_palette[k + 1] = ((7 - k) * data[0] + k * data[1] + 3) / 7;
+
+        std::uint64_t alpha_indices = 0;
+
+        for (unsigned i = 0; i < 6; ++i)
+          alpha_indices |= std::uint64_t(data[2 + i]) << (i * 8);
+
+        for (unsigned i = 0; i < 16; ++i)
+        {
+          std::uint32_t const x = block_x * 4 + i % 4;
+          std::uint32_t const y = block_y * 4 + i / 4;
+
+          if (x >= width || y >= height)
+            continue;
+
+          std::uint8_t* pixel = pixels.data() + (std::size_t(y) * width + x) * 4;
+          auto const& entry = palette[(indices >> (i * 2)) & 3];
+
+          for (unsigned c = 0; c < 3; ++c)
+            pixel[c] = static_cast<std::uint8_t>(entry[c]);
+
+          if (format == BLPFormat::DXT3)
+            pixel[3] = static_cast<std::uint8_t>(((data[i / 2] >> ((i % 2) * 4)) & 15) * 17);
+          else if (format == BLPFormat::DXT5)
+            pixel[3] = static_cast<std::uint8_t>(alpha_palette[(alpha_indices >> (i * 3)) & 7]);
+        }
+      }
+    }
+
+    return pixels;
+  }
+
+  int MaxError(std::vector<std::uint8_t> const& lhs, std::vector<std::uint8_t> const& rhs, unsigned channel)
+  {
+    int max_error = 0;
+
+    for (std::size_t i = channel; i < lhs.size(); i += 4)
+      max_error = std::max(max_error, std::abs(lhs[i] - rhs[i]));
+
+    return max_error;
+  }
+
+  BLP2Header ReadHeader(Common::ByteBuffer const& buf)
+  {
+    Ensure(buf.Size() >= sizeof(BLP2Header), "File is smaller than its header.");
+
+    BLP2Header header;
+    std::memcpy(&header, buf.Data(), sizeof(BLP2Header));
+    return header;
+  }
+
+  void TestRoundTrip(BLPFormat format, CompressionQuality quality)
+  {
+    Image const image = Gradient();
+    EncodeSettings const settings {format, quality, MipFilter::KAISER, true};
+
+    Common::ByteBuffer buf {};
+    BLPEncoder::Encode(image, settings, buf);
+
+    constexpr std::uint32_t magic = Common::FourCC<"BLP2", Common::FourCCEndian::Big>;
+
+    BLP2Header const header = ReadHeader(buf);
+    Ensure(header.magic == magic && header.type == 1
+           && header.has_mips && header.width == WIDTH && header.height == HEIGHT, "Header differs.");
+    Ensure((format == BLPFormat::UNCOMPRESSED) == (header.color_encoding == BLPColorEncoding::ARGB8888)
+           && header.alpha_depth == (format == BLPFormat::DXT1 ? 0 : 8), "Pixel format differs.");
+
+    // levels follow each other without gaps, down to 1x1
+    std::uint32_t offset = sizeof(BLP2Header);
+    std::uint32_t width = WIDTH;
+    std::uint32_t height = HEIGHT;
+
+    for (std::uint32_t level = 0; level < BLP_MAX_MIP_LEVELS; ++level)
+    {
+      if (level >= N_LEVELS)
+      {
+        Ensure(!header.mip_offsets[level] && !header.mip_sizes[level], "Unexpected mip level.");
+        continue;
+      }
+
+      std::uint32_t const expected_size = format == BLPFormat::UNCOMPRESSED ? width * height * 4
+        : ((width + 3) / 4) * ((height + 3) / 4) * (format == BLPFormat::DXT1 ? 8 : 16);
+
+      Ensure(header.mip_offsets[level] == offset && header.mip_sizes[level] == expected_size
+             , "Mip level layout differs.");
+
+      offset += expected_size;
+      width = std::max(width / 2, 1u);
+      height = std::max(height / 2, 1u);
+    }
+
+    Ensure(offset == buf.Size(), "File size differs from its levels.");
+
+    auto const level0 = reinterpret_cast<std::uint8_t const*>(buf.Data() + header.mip_offsets[0]);
+
+    if (format == BLPFormat::UNCOMPRESSED)
+    {
+      for (std::size_t i = 0; i < image.pixels.size(); i += 4)
+      {
+        Ensure(level0[i] == image.pixels[i + 2] && level0[i + 1] == image.pixels[i + 1]
+               && level0[i + 2] == image.pixels[i] && level0[i + 3] == image.pixels[i + 3]
+               , "Uncompressed pixel differs.");
+      }
+
+      return;
+    }
+
+    std::vector<std::uint8_t> const decoded = DecodeLevel(level0, WIDTH, HEIGHT, format);
+
+    // a 4x4 block of the gradient spans about 21 red and 38 green levels, quantized to 4 colors of 5:6:5
+    int const color_tolerance = quality == CompressionQuality::FAST ? 24 : 16;
+
+    for (unsigned c = 0; c < 3; ++c)
+      Ensure(MaxError(decoded, image.pixels, c) <= color_tolerance, "Decoded color differs too much.");
+
+    if (format == BLPFormat::DXT3)
+      Ensure(MaxError(decoded, image.pixels, 3) <= 8, "Decoded explicit alpha differs too much.");
+    else if (format == BLPFormat::DXT5)
+      Ensure(MaxError(decoded, image.pixels, 3) <= 4, "Decoded interpolated alpha differs too much.");
+  }
+
+  /**
+   * Colors exactly representable in 5:6:5 survive compression unchanged.
+   */
+  void TestSolidColor()
+  {
+    Image image {8, 8, std::vector<std::uint8_t>(8 * 8 * 4)};
+
+    for (std::size_t i = 0; i < image.pixels.size(); i += 4)
+    {
+      image.pixels[i] = 255;
+      image.pixels[i + 1] = 0;
+      image.pixels[i + 2] = 255;
+      image.pixels[i + 3] = 255;
+    }
+
+    for (CompressionQuality quality : {CompressionQuality::FAST, CompressionQuality::NORMAL, CompressionQuality::HIGH})
+    {
+      Common::ByteBuffer buf {};
+      BLPEncoder::Encode(image, {BLPFormat::DXT1, quality, MipFilter::BOX, false}, buf);
+
+      BLP2Header const header = ReadHeader(buf);
+      Ensure(!header.has_mips && header.mip_sizes[0] == 4 * 8 && !header.mip_offsets[1], "Unexpected mip levels.");
+
+      auto const level0 = reinterpret_cast<std::uint8_t const*>(buf.Data() + header.mip_offsets[0]);
+      Ensure(DecodeLevel(level0, 8, 8, BLPFormat::DXT1) == image.pixels, "Solid color was not preserved.");
+    }
+  }
+
+  /**
+   * Both paths compress random blocks to the same bytes.
+   */
+  void TestRandomBlocks()
+  {
+    std::uniform_int_distribution<unsigned> byte {0, 255};
+
+    for (std::size_t n = 0; n < N_RANDOM_BLOCKS; ++n)
+    {
+      BlockCompressor::Block block;
+
+      // random noise, two-color blocks and narrow ranges, which exercise ties and equal endpoints
+      unsigned const kind = n % 3;
+      std::array<std::uint8_t, 8> const colors {static_cast<std::uint8_t>(byte(rng)), static_cast<std::uint8_t>(byte(rng))
+                                                , static_cast<std::uint8_t>(byte(rng)), static_cast<std::uint8_t>(byte(rng))
+                                                , static_cast<std::uint8_t>(byte(rng)), static_cast<std::uint8_t>(byte(rng))
+                                                , static_cast<std::uint8_t>(byte(rng)), static_cast<std::uint8_t>(byte(rng))};
+
+      for (std::size_t i = 0; i < block.size(); ++i)
+      {
+        if (kind == 0)
+          block[i] = static_cast<std::uint8_t>(byte(rng));
+        else if (kind == 1)
+          block[i] = colors[(byte(rng) % 2) * 4 + i % 4];
+        else
+          block[i] = static_cast<std::uint8_t>(colors[i % 4] / 2 + byte(rng) % 3);
+      }
+
+      for (CompressionQuality quality : {CompressionQuality::FAST, CompressionQuality::NORMAL, CompressionQuality::HIGH})
+      {
+        SIMDTestHelpers::EnsureSamePaths([&]
+        {
+          std::array<std::uint8_t, 8> compressed;
+          BlockCompressor::CompressColor(block, quality, compressed.data());
+          return compressed;
+        }, "Vectorized block differs from the scalar one.");
+      }
+    }
+  }
+}
+
+int main()
+{
+  backward::SignalHandling sh;
+  Validation::Log::InitLoggers();
+
+  TestRandomBlocks();
+
+  SIMDTestHelpers::ForEachPath([]
+  {
+    TestSolidColor();
+
+    for (BLPFormat format : {BLPFormat::DXT1, BLPFormat::DXT3, BLPFormat::DXT5, BLPFormat::UNCOMPRESSED})
+    {
+      for (CompressionQuality quality : {CompressionQuality::FAST, CompressionQuality::NORMAL, CompressionQuality::HIGH})
+        TestRoundTrip(format, quality);
+    }
+  });
+
+  return 0;
+}
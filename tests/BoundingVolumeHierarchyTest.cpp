@@ -0,0 +1,184 @@
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <IO/Collision/BoundingVolumeHierarchy.hpp>
+
+#include "SIMDTestHelpers.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER) & !defined(__INTEL_COMPILER)
+  #pragma warning(push)
+  #pragma warning(disable : 4267)
+  #pragma warning(disable : 4996)
+
+  #include <backward.hpp>
+
+  #pragma warning(pop)
+#else
+  #include <backward.hpp>
+#endif
+
+using namespace IO;
+using namespace IO::Collision;
+using namespace IO::Common::DataStructures;
+
+namespace
+{
+  std::mt19937 rng {20241019};
+
+  /**
+   * Boxes snapped to a coarse grid, so that rays along grid lines start on and graze slab planes.
+   */
+  std::vector<CAaBox> RandomBoxes(std::size_t n_boxes)
+  {
+    std::uniform_int_distribution<int> position {-50, 50};
+    std::uniform_int_distribution<int> extent {0, 8};
+    std::vector<CAaBox> boxes (n_boxes);
+
+    for (CAaBox& box : boxes)
+    {
+      C3Vector const min {static_cast<float>(position(rng)), static_cast<float>(position(rng))
+                          , static_cast<float>(position(rng))};
+      C3Vector const max {min.x + static_cast<float>(extent(rng)), min.y + static_cast<float>(extent(rng))
+                          , min.z + static_cast<float>(extent(rng))};
+      box = {min, max};
+    }
+
+    return boxes;
+  }
+
+  /**
+   * Random rays. With axis_aligned, a third of them run along an axis from grid points, so their inverse
+   * direction has infinities and their slab distances can be NaN.
+   */
+  std::vector<std::pair<C3Vector, C3Vector>> RandomRays(std::size_t n_rays, bool axis_aligned)
+  {
+    std::uniform_real_distribution<float> position {-60.f, 60.f};
+    std::uniform_real_distribution<float> direction {-1.f, 1.f};
+    std::uniform_int_distribution<int> grid {-50, 50};
+    std::uniform_int_distribution<int> axis {0, 2};
+    std::vector<std::pair<C3Vector, C3Vector>> rays (n_rays);
+
+    for (std::size_t i = 0; i < n_rays; ++i)
+    {
+      if (!axis_aligned || i % 3)
+      {
+        rays[i].first = {position(rng), position(rng), position(rng)};
+        rays[i].second = {direction(rng), direction(rng), direction(rng)};
+        continue;
+      }
+
+      rays[i].first = {static_cast<float>(grid(rng)), static_cast<float>(grid(rng)), static_cast<float>(grid(rng))};
+
+      int const along = axis(rng);
+      float const sign = i % 2 ? -1.f : 1.f;
+      rays[i].second = {along == 0 ? sign : 0.f, along == 1 ? sign : 0.f, along == 2 ? sign : 0.f};
+    }
+
+    return rays;
+  }
+
+  /**
+   * Visits primitives in the same order and finds the same closest hits with the scalar and the SSE2/NEON
+   * test of both children of a node.
+   */
+  void TestSamePaths()
+  {
+    std::vector<CAaBox> const boxes = RandomBoxes(500);
+    BoundingVolumeHierarchy const bvh {boxes};
+    auto const rays = RandomRays(600, true);
+
+    SIMDTestHelpers::EnsureSamePaths([&]
+    {
+      std::vector<std::uint32_t> visited;
+
+      for (auto const& [origin, direction] : rays)
+      {
+        bvh.QueryRay(origin, direction, 0.f, std::numeric_limits<float>::max()
+                     , [&](std::uint32_t primitive, float t_max)
+        {
+          visited.push_back(primitive);
+          return t_max;
+        });
+      }
+
+      return visited;
+    }, "Traversal differs between the scalar and the vectorized path.");
+
+    SIMDTestHelpers::EnsureSamePaths([&]
+    {
+      std::vector<std::pair<std::uint32_t, float>> hits;
+
+      for (auto const& [origin, direction] : rays)
+      {
+        std::uint32_t closest = std::numeric_limits<std::uint32_t>::max();
+        float closest_t = 200.f;
+
+        bvh.QueryRay(origin, direction, 0.f, 200.f, [&](std::uint32_t primitive, float t_max)
+        {
+          float const t = details::RayBoxEntry(boxes[primitive], origin
+                                               , {1.f / direction.x, 1.f / direction.y, 1.f / direction.z}
+                                               , 0.f, t_max);
+          if (t >= t_max)
+            return t_max;
+
+          closest = primitive;
+          closest_t = t;
+          return t;
+        });
+
+        hits.emplace_back(closest, closest_t);
+      }
+
+      return hits;
+    }, "Closest hits differ between the scalar and the vectorized path.");
+  }
+
+  /**
+   * The closest hit matches testing every box, for rays not grazing box faces.
+   */
+  void TestClosestHit()
+  {
+    std::vector<CAaBox> const boxes = RandomBoxes(300);
+    BoundingVolumeHierarchy const bvh {boxes};
+
+    SIMDTestHelpers::ForEachPath([&]
+    {
+      for (auto const& [origin, direction] : RandomRays(200, false))
+      {
+        C3Vector const inv_direction {1.f / direction.x, 1.f / direction.y, 1.f / direction.z};
+        float closest = std::numeric_limits<float>::infinity();
+
+        for (CAaBox const& box : boxes)
+          closest = std::min(closest, details::RayBoxEntry(box, origin, inv_direction, 0.f, 500.f));
+
+        float found = 500.f;
+
+        bvh.QueryRay(origin, direction, 0.f, 500.f, [&](std::uint32_t primitive, float t_max)
+        {
+          float const t = details::RayBoxEntry(boxes[primitive], origin, inv_direction, 0.f, t_max);
+          return t < t_max ? (found = t) : t_max;
+        });
+
+        Ensure(closest == std::numeric_limits<float>::infinity() ? found == 500.f : found == closest
+               , "Closest hit was missed.");
+      }
+    });
+  }
+}
+
+int main()
+{
+  backward::SignalHandling sh;
+  Validation::Log::InitLoggers();
+
+  TestSamePaths();
+  TestClosestHit();
+
+  return 0;
+}
@@ -0,0 +1,253 @@
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <IO/ADT/ChangeFeed.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#if defined(_MSC_VER) & !defined(__INTEL_COMPILER)
+  #pragma warning(push)
+  #pragma warning(disable : 4267)
+  #pragma warning(disable : 4996)
+
+  #include <backward.hpp>
+
+  #pragma warning(pop)
+#else
+  #include <backward.hpp>
+#endif
+
+using namespace IO;
+using namespace IO::ADT;
+using namespace IO::Common;
+using namespace IO::Common::DataStructures;
+
+namespace
+{
+  constexpr TileIndex TILE {32, 40};
+  constexpr TileIndex OTHER_TILE {33, 39};
+
+  std::mt19937 rng {20241019};
+
+  bool SameRecord(ChangeRecord const& record, TileIndex tile, std::uint16_t chunk, ChangeField field
+                  , std::uint32_t begin, std::uint32_t end)
+  {
+    return record.tile.x == tile.x && record.tile.y == tile.y && record.chunk == chunk && record.field == field
+      && record.begin == begin && record.end == end;
+  }
+
+  /**
+   * Overlapping and adjacent ranges merge, so do ranges within the gap. Records come sorted by tile,
+   * chunk and field.
+   */
+  void TestCoalescing()
+  {
+    ChangeFeed feed {2};
+
+    feed.Record(TILE, 5, ChangeField::HEIGHTS, 10, 20);
+    feed.Record(TILE, 5, ChangeField::HEIGHTS, 0, 4);
+    feed.Record(TILE, 5, ChangeField::HEIGHTS, 15, 25);
+    feed.Record(TILE, 5, ChangeField::HEIGHTS, 27, 30);
+    feed.Record(TILE, 5, ChangeField::HEIGHTS, 33, 34);
+    feed.Record(TILE, 5, ChangeField::HEIGHTS, 40, 40);
+    feed.Record(TILE, 5, ChangeField::NORMALS, 0, 1);
+    feed.Record(TILE, 2, ChangeField::HEIGHTS, 7, 8);
+    feed.Record(OTHER_TILE, TILE_LEVEL_CHANGE, ChangeField::TEXTURES, 1, 2);
+
+    std::vector<ChangeRecord> changes = feed.Flush();
+
+    // [15, 25) overlaps [10, 20), [27, 30) is two indices away, [33, 34) three, [40, 40) is empty
+    Ensure(changes.size() == 6, "Ranges were not coalesced.");
+    Ensure(SameRecord(changes[0], OTHER_TILE, TILE_LEVEL_CHANGE, ChangeField::TEXTURES, 1, 2)
+           && SameRecord(changes[1], TILE, 2, ChangeField::HEIGHTS, 7, 8)
+           && SameRecord(changes[2], TILE, 5, ChangeField::HEIGHTS, 0, 4)
+           && SameRecord(changes[3], TILE, 5, ChangeField::HEIGHTS, 10, 30)
+           && SameRecord(changes[4], TILE, 5, ChangeField::HEIGHTS, 33, 34)
+           && SameRecord(changes[5], TILE, 5, ChangeField::NORMALS, 0, 1), "Coalesced records are wrong.");
+
+    Ensure(feed.Flush().empty(), "Flush did not clear the pending changes.");
+
+    // without a gap, only touching ranges merge
+    ChangeFeed exact;
+    exact.Record(TILE, 0, ChangeField::HOLES, 0, 2);
+    exact.Record(TILE, 0, ChangeField::HOLES, 2, 3);
+    exact.Record(TILE, 0, ChangeField::HOLES, 4, 5);
+
+    changes = exact.Flush();
+    Ensure(changes.size() == 2 && SameRecord(changes[0], TILE, 0, ChangeField::HOLES, 0, 3)
+           , "Touching ranges were not merged.");
+
+    exact.Record(TILE, 0, ChangeField::HOLES, 0, 1);
+    exact.Discard();
+    Ensure(exact.Flush().empty(), "Discarded changes were delivered.");
+  }
+
+  /**
+   * Every subscriber receives each non-empty batch once, unsubscribed ones receive nothing.
+   */
+  void TestSubscribers()
+  {
+    ChangeFeed feed;
+    std::size_t n_first = 0;
+    std::size_t n_second = 0;
+
+    std::size_t const first = feed.Subscribe([&](std::span<ChangeRecord const> changes) { n_first += changes.size(); });
+    feed.Subscribe([&](std::span<ChangeRecord const> changes) { n_second += changes.size(); });
+
+    feed.Flush();
+    feed.Record(TILE, 0, ChangeField::SHADOWS, 0, 1);
+    feed.Record(TILE, 1, ChangeField::SHADOWS, 0, 1);
+    feed.Flush();
+
+    Ensure(n_first == 2 && n_second == 2, "Subscribers did not receive the batch.");
+
+    feed.Unsubscribe(first);
+    feed.Record(TILE, 0, ChangeField::SHADOWS, 0, 1);
+    feed.Flush();
+
+    Ensure(n_first == 2 && n_second == 3, "Unsubscribed subscriber received a batch.");
+  }
+
+  std::unique_ptr<RegionTile> RandomTile()
+  {
+    auto tile = std::make_unique<RegionTile>();
+    std::uniform_real_distribution<float> height {-40.f, 40.f};
+
+    for (unsigned i = 0; i < WorldConstants::CHUNKS_PER_TILE; ++i)
+    {
+      tile->terrain[i].header = {};
+      tile->terrain[i].normals.fill({{0, 0, 127}});
+      tile->terrain[i].vertex_colors.fill({127, 127, 127, 127});
+      tile->texturing.chunks[i].layers = {{0, {}, 0, 0}};
+
+      for (float& vertex : tile->terrain[i].heightmap)
+        vertex = height(rng);
+    }
+
+    tile->texturing.textures = {{"tileset/grass.blp", 0}};
+    tile->placements.models = {{"world/tree.m2", 0}};
+    tile->placements.model_placements.resize(4);
+
+    for (std::size_t i = 0; i < tile->placements.model_placements.size(); ++i)
+      tile->placements.model_placements[i].unique_id = static_cast<std::uint32_t>(i + 1);
+
+    return tile;
+  }
+
+  /**
+   * Liquid over the given quads of a chunk, at a height.
+   */
+  void AddLiquid(MH2O& liquids, std::uint16_t chunk, std::uint64_t quads, float level)
+  {
+    LiquidVertexValues values;
+    values.heights.fill(level);
+    values.has_depth = true;
+
+    LiquidFiller::MergeQuads(liquids.chunks()[chunk], 2, quads, values, false);
+  }
+
+  /**
+   * Diffing detached tile data yields the runs of changed indices, per chunk and field.
+   */
+  void TestDiff()
+  {
+    auto const before = RandomTile();
+    AddLiquid(before->liquids, 3, 0xFF, 10.f);
+
+    auto after = std::make_unique<RegionTile>(*before);
+
+    ChangeFeed feed;
+    feed.DiffTile(TILE, *before, *after);
+    Ensure(feed.Flush().empty(), "Unchanged tile reported changes.");
+
+    after->terrain[7].heightmap[3] += 1.f;
+    after->terrain[7].heightmap[4] += 1.f;
+    after->terrain[7].heightmap[100] += 1.f;
+    after->terrain[9].header.holes_low_res = 1;
+    after->texturing.chunks[0].shadowmap.set(5 * WorldConstants::SHADOWMAP_DIM + 1);
+    after->texturing.textures.push_back({"tileset/dirt.blp", 0});
+    after->placements.model_placements.erase(after->placements.model_placements.begin() + 2);
+    AddLiquid(after->liquids, 3, 0xF00, 10.f);
+
+    feed.DiffTile(TILE, *before, *after);
+    std::vector<ChangeRecord> const changes = feed.Flush();
+
+    std::vector<ChangeRecord> const expected
+    {
+      {TILE, 0, ChangeField::SHADOWS, 5, 6},
+      {TILE, 3, ChangeField::LIQUIDS, 8, 12},
+      {TILE, 7, ChangeField::HEIGHTS, 3, 5},
+      {TILE, 7, ChangeField::HEIGHTS, 100, 101},
+      {TILE, 9, ChangeField::CHUNK_HEADER, 0, 1},
+      {TILE, 9, ChangeField::HOLES, 0, 2},
+      {TILE, 9, ChangeField::HOLES, 8, 10},
+      {TILE, TILE_LEVEL_CHANGE, ChangeField::TEXTURES, 1, 2},
+      {TILE, TILE_LEVEL_CHANGE, ChangeField::MODEL_PLACEMENTS, 2, 4}
+    };
+
+    Ensure(changes.size() == expected.size(), "Diff reported wrong number of changes.");
+
+    for (std::size_t i = 0; i < expected.size(); ++i)
+    {
+      ChangeRecord const& change = expected[i];
+      Ensure(SameRecord(changes[i], change.tile, change.chunk, change.field, change.begin, change.end)
+             , "Diff reported a wrong change.");
+    }
+  }
+
+  /**
+   * Tracked callbacks diff consumed tiles against their loaded state, tiles loaded and not consumed
+   * report nothing.
+   */
+  void TestTracking()
+  {
+    auto const stored = RandomTile();
+    ChangeFeed feed;
+    std::size_t n_consumed = 0;
+
+    ChangeFeed::TrackedTiles const tracked = feed.TrackTiles(
+      [&](TileIndex, RegionTile& tile) { tile = *stored; return true; },
+      [&](TileIndex, RegionTile const&) { ++n_consumed; });
+
+    RegionTile tile;
+    Ensure(tracked.loader(TILE, tile) && tracked.loader(OTHER_TILE, tile), "Tracked loader failed.");
+
+    tile.terrain[12].heightmap[0] += 1.f;
+    tracked.consumer(OTHER_TILE, tile);
+
+    std::vector<ChangeRecord> changes = feed.Flush();
+    Ensure(n_consumed == 1 && changes.size() == 1
+           && SameRecord(changes[0], OTHER_TILE, 12, ChangeField::HEIGHTS, 0, 1), "Consumed tile was not diffed.");
+
+    MH2O stored_liquids;
+    AddLiquid(stored_liquids, 0, 1, 5.f);
+
+    ChangeFeed::TrackedLiquids const tracked_liquids = feed.TrackLiquids(
+      [&](TileIndex, MH2O& liquids) { liquids = stored_liquids; },
+      [](TileIndex, MH2O const&) {});
+
+    MH2O liquids;
+    tracked_liquids.loader(TILE, liquids);
+    LiquidFiller::RemoveQuads(liquids.chunks()[0], 1);
+    tracked_liquids.consumer(TILE, liquids);
+
+    changes = feed.Flush();
+    Ensure(changes.size() == 1 && SameRecord(changes[0], TILE, 0, ChangeField::LIQUIDS, 0, 1)
+           , "Consumed liquids were not diffed.");
+  }
+}
+
+int main()
+{
+  backward::SignalHandling sh;
+  Validation::Log::InitLoggers();
+
+  TestCoalescing();
+  TestSubscribers();
+  TestDiff();
+  TestTracking();
+
+  return 0;
+}
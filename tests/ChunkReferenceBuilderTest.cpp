@@ -0,0 +1,199 @@
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <IO/Common.hpp>
+#include <IO/ADT/ChunkIdentifiers.hpp>
+#include <IO/ADT/Obj/ChunkReferenceBuilder.hpp>
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#if defined(_MSC_VER) & !defined(__INTEL_COMPILER)
+  #pragma warning(push)
+  #pragma warning(disable : 4267)
+  #pragma warning(disable : 4996)
+
+  #include <backward.hpp>
+
+  #pragma warning(pop)
+#else
+  #include <backward.hpp>
+#endif
+
+using namespace IO;
+using namespace IO::ADT;
+using namespace IO::Common;
+using namespace IO::Common::DataStructures;
+
+namespace
+{
+  constexpr TileIndex TILE {30, 40};
+
+  constexpr float ORIGIN_X = 30.f * WorldConstants::TILE_SIZE;
+  constexpr float ORIGIN_Z = 40.f * WorldConstants::TILE_SIZE;
+  constexpr float CHUNK = WorldConstants::CHUNK_SIZE;
+
+  /**
+   * The parts of an obj0 ADT the rebuilder works on, in the chunk types ADTObj stores them in.
+   */
+  struct ADTObj0
+  {
+    struct Chunk
+    {
+      DataArrayChunk<std::uint32_t, ADT::ChunkIdentifiers::ADTObj0MCNKSubchunks::MCRD> model_references;
+      DataArrayChunk<std::uint32_t, ADT::ChunkIdentifiers::ADTObj0MCNKSubchunks::MCRW> map_object_references;
+
+      auto& ModelReferences() { return model_references; }
+      auto& MapObjectReferences() { return map_object_references; }
+    };
+
+    DataArrayChunk<ADT::DataStructures::MDDF, ADT::ChunkIdentifiers::ADTObj0Chunks::MDDF> model_placements;
+    DataArrayChunk<ADT::DataStructures::MODF, ADT::ChunkIdentifiers::ADTObj0Chunks::MODF> map_object_placements;
+    std::array<Chunk, WorldConstants::CHUNKS_PER_TILE> chunks;
+
+    auto const& ModelPlacements() const { return model_placements; }
+    auto const& MapObjectPlacements() const { return map_object_placements; }
+    auto& Chunks() { return chunks; }
+  };
+
+  /**
+   * Box spanning chunk columns [x0, x1] and rows [y0, y1] of TILE, not touching their borders.
+   */
+  CAaBox ChunkBox(float x0, float x1, float y0, float y1)
+  {
+    return {{ORIGIN_X + (x0 + 0.1f) * CHUNK, 0.f, ORIGIN_Z + (y0 + 0.1f) * CHUNK}
+            , {ORIGIN_X + (x1 + 0.9f) * CHUNK, 10.f, ORIGIN_Z + (y1 + 0.9f) * CHUNK}};
+  }
+
+  /**
+   * A model inside one chunk, a model crossing into the western neighbour, an invalid box and a map object
+   * crossing into the south-eastern neighbours.
+   */
+  TilePlacementExtents Extents()
+  {
+    TilePlacementExtents extents;
+    extents.models = {ChunkBox(2, 2, 3, 3), ChunkBox(-1, 1, 0, 0), {{1.f, 0.f, 1.f}, {0.f, 0.f, 0.f}}};
+    extents.map_objects = {ChunkBox(15, 16, 15, 16)};
+    return extents;
+  }
+
+  /**
+   * Each placement is referenced by every chunk its box overlaps, parts outside the tile are ignored.
+   */
+  void TestBuild()
+  {
+    ChunkReferences references;
+    references.model_references[100] = {7};
+
+    ChunkReferenceBuilder::Build(TILE, Extents(), references);
+
+    std::map<std::size_t, std::vector<std::uint32_t>> const expected_models {{0, {1}}, {1, {1}}, {3 * 16 + 2, {0}}};
+    std::map<std::size_t, std::vector<std::uint32_t>> const expected_map_objects {{255, {0}}};
+
+    for (std::size_t i = 0; i < WorldConstants::CHUNKS_PER_TILE; ++i)
+    {
+      auto const model_it = expected_models.find(i);
+      auto const map_object_it = expected_map_objects.find(i);
+
+      Ensure(references.model_references[i]
+             == (model_it == expected_models.end() ? std::vector<std::uint32_t>{} : model_it->second)
+             , "Wrong model references.");
+      Ensure(references.map_object_references[i]
+             == (map_object_it == expected_map_objects.end() ? std::vector<std::uint32_t>{} : map_object_it->second)
+             , "Wrong map object references.");
+    }
+  }
+
+  /**
+   * Placements are listed once per neighbour tile they overlap, models first.
+   */
+  void TestBorderCrossings()
+  {
+    std::vector<BorderCrossing> const crossings = ChunkReferenceBuilder::FindBorderCrossings(TILE, Extents());
+
+    Ensure(crossings.size() == 4, "Wrong number of border crossings.");
+    Ensure(crossings[0].tile.x == 29 && crossings[0].tile.y == 40 && crossings[0].index == 1
+           && !crossings[0].is_map_object, "Model crossing was missed.");
+
+    std::array<TileIndex, 3> const map_object_tiles {TileIndex{31, 40}, TileIndex{30, 41}, TileIndex{31, 41}};
+
+    for (std::size_t i = 0; i < map_object_tiles.size(); ++i)
+    {
+      BorderCrossing const& crossing = crossings[i + 1];
+      Ensure(crossing.tile.x == map_object_tiles[i].x && crossing.tile.y == map_object_tiles[i].y
+             && crossing.index == 0 && crossing.is_map_object, "Map object crossing was missed.");
+    }
+  }
+
+  /**
+   * Absent tiles are skipped, present ones are handed to the consumer.
+   */
+  void TestBuildTiles()
+  {
+    std::mutex mutex;
+    std::map<std::uint16_t, ChunkReferences> built;
+
+    std::size_t const n_built = ChunkReferenceBuilder::BuildTiles({TILE, {31, 40}}
+      , [](TileIndex tile_index, TilePlacementExtents& extents)
+      {
+        if (tile_index.x != TILE.x)
+          return false;
+
+        extents = Extents();
+        return true;
+      }
+      , [&](TileIndex tile_index, ChunkReferences const& references)
+      {
+        std::lock_guard const lock {mutex};
+        built[tile_index.x] = references;
+      });
+
+    Ensure(n_built == 1 && built.size() == 1 && built.contains(TILE.x), "Wrong tiles were built.");
+    Ensure(built[TILE.x].model_references[1] == std::vector<std::uint32_t>{1}, "Built tile has wrong references.");
+  }
+
+  /**
+   * Model extents are the scaled bounding radius around the placement, references are written to the chunks.
+   */
+  void TestApplyToADT()
+  {
+    ADT::DataStructures::MDDF model {};
+    model.position = {ORIGIN_X + 2.5f * CHUNK, 0.f, ORIGIN_Z + 3.5f * CHUNK};
+    model.scale = 2048;
+
+    CAaBox const box = ChunkReferenceBuilder::ModelPlacementExtents(model, 3.f);
+    Ensure(box.min.y == -6.f && box.max.y == 6.f, "Model radius was not scaled.");
+
+    ADT::DataStructures::MODF map_object {};
+    map_object.extents = ChunkBox(0, 0, 15, 15);
+
+    ADTObj0 adt;
+    adt.model_placements.Initialize(std::vector<ADT::DataStructures::MDDF>{model});
+    adt.map_object_placements.Initialize(std::vector<ADT::DataStructures::MODF>{map_object});
+
+    TilePlacementExtents extents;
+    ChunkReferenceBuilder::ExtractPlacementExtents(adt, [](ADT::DataStructures::MDDF const&) { return 3.f; }, extents);
+
+    ChunkReferences references;
+    ChunkReferenceBuilder::Build(TILE, extents, references);
+    ChunkReferenceBuilder::ApplyReferences(adt, references);
+
+    Ensure(adt.Chunks()[3 * 16 + 2].ModelReferences().Size() == 1 && !adt.Chunks()[0].ModelReferences().Size()
+           && adt.Chunks()[15 * 16].MapObjectReferences().Size() == 1, "References were not written to the chunks.");
+  }
+}
+
+int main()
+{
+  backward::SignalHandling sh;
+  Validation::Log::InitLoggers();
+
+  TestBuild();
+  TestBorderCrossings();
+  TestBuildTiles();
+  TestApplyToADT();
+
+  return 0;
+}
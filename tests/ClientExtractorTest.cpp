@@ -0,0 +1,184 @@
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <IO/ByteBuffer.hpp>
+#include <IO/Storage/ClientExtractor.hpp>
+#include <IO/Storage/ClientStorage.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#if defined(_MSC_VER) & !defined(__INTEL_COMPILER)
+  #pragma warning(push)
+  #pragma warning(disable : 4267)
+  #pragma warning(disable : 4996)
+
+  #include <backward.hpp>
+
+  #pragma warning(pop)
+#else
+  #include <backward.hpp>
+#endif
+
+using namespace IO;
+using namespace IO::Storage;
+namespace fs = std::filesystem;
+
+namespace
+{
+  constexpr std::string_view LISTFILE = "WORLD\\TEST\\A.TXT\r\nWORLD\\TEST\\B.TXT\r\nWORLD\\OTHER\\C.TXT\r\n";
+
+  fs::path const ROOT = fs::temp_directory_path() / "wowlib_client_extractor_test";
+  fs::path const PROJECT = ROOT / "project";
+  fs::path const OUTPUT = ROOT / "output";
+  fs::path const MANIFEST = OUTPUT / ClientExtractor::MANIFEST_FILENAME;
+
+  void PlaceFile(fs::path const& path, std::string_view content)
+  {
+    fs::create_directories(path.parent_path());
+    std::ofstream strm {path, std::ios::binary | std::ios::trunc};
+    strm.write(content.data(), static_cast<std::streamsize>(content.size()));
+  }
+
+  std::string Content(fs::path const& path)
+  {
+    std::ifstream strm {path, std::ios::binary};
+    return {std::istreambuf_iterator<char>(strm), std::istreambuf_iterator<char>()};
+  }
+
+  std::size_t NumLines(fs::path const& path)
+  {
+    std::string const content = Content(path);
+    return static_cast<std::size_t>(std::count(content.begin(), content.end(), '\n'));
+  }
+
+  /**
+   * Storage without a client, serving the files placed in its project directory.
+   */
+  std::unique_ptr<ClientStorage> OpenStorage()
+  {
+    Common::ByteBuffer listfile {};
+    listfile.Write(LISTFILE.data(), LISTFILE.size());
+    listfile.Seek(0);
+
+    return std::make_unique<ClientStorage>(PROJECT.string(), Common::ClientVersion::WOTLK, listfile);
+  }
+
+  ExtractionStats Extract(ExtractionSettings const& settings = {})
+  {
+    auto storage = OpenStorage();
+    ClientExtractor extractor {*storage};
+    return extractor.Extract(OUTPUT.string(), settings);
+  }
+
+  void Reset()
+  {
+    fs::remove_all(ROOT);
+    PlaceFile(PROJECT / "WORLD/TEST/A.TXT", "first a");
+    PlaceFile(PROJECT / "WORLD/TEST/B.TXT", "first b");
+    PlaceFile(PROJECT / "WORLD/OTHER/C.TXT", "first c");
+  }
+
+  /**
+   * The filter selects files by prefix and extension, regardless of case and separators.
+   */
+  void TestFilter()
+  {
+    ExtractionFilter const filter {{"world/Test/"}, {".txt"}};
+
+    Ensure(filter.Matches("WORLD\\TEST\\A.TXT") && !filter.Matches("WORLD\\OTHER\\C.TXT")
+           && !filter.Matches("WORLD\\TEST\\A.BLP"), "Filter selects wrong files.");
+
+    Reset();
+
+    ExtractionSettings settings;
+    settings.filter = filter;
+
+    ExtractionStats const stats = Extract(settings);
+
+    Ensure(stats.n_written == 2 && fs::exists(OUTPUT / "world/test/a.txt") && !fs::exists(OUTPUT / "world/other/c.txt")
+           , "Filtered extraction wrote wrong files.");
+  }
+
+  /**
+   * A second run writes nothing, an interrupted run resumes, copies changed on disk and client updates are
+   * written again.
+   */
+  void TestResume()
+  {
+    Reset();
+
+    ExtractionStats stats = Extract();
+    Ensure(stats.n_written == 3 && stats.n_failed == 0 && Content(OUTPUT / "world/test/a.txt") == "first a"
+           , "Files were not extracted.");
+    Ensure(NumLines(MANIFEST) == 3, "Manifest does not record every file.");
+
+    stats = Extract();
+    Ensure(stats.n_written == 0 && stats.n_unchanged == 3, "Unchanged files were written again.");
+    Ensure(NumLines(MANIFEST) == 3, "Manifest was not compacted.");
+
+    // interrupted before the last file was written and recorded
+    fs::remove(OUTPUT / "world/other/c.txt");
+    PlaceFile(MANIFEST, "7;0;world/test/a.txt\n");
+
+    stats = Extract();
+    Ensure(stats.n_written == 1 && stats.n_unchanged == 2 && fs::exists(OUTPUT / "world/other/c.txt")
+           , "Interrupted extraction did not resume.");
+    Ensure(NumLines(MANIFEST) == 3, "Manifest was not rebuilt.");
+
+    // same size, different content
+    PlaceFile(OUTPUT / "world/test/b.txt", "local b");
+
+    stats = Extract();
+    Ensure(stats.n_written == 1 && Content(OUTPUT / "world/test/b.txt") == "first b"
+           , "Extracted copy modified on disk was not restored.");
+
+    PlaceFile(PROJECT / "WORLD/TEST/A.TXT", "updated a");
+
+    stats = Extract();
+    Ensure(stats.n_written == 1 && Content(OUTPUT / "world/test/a.txt") == "updated a"
+           , "Client update was not extracted.");
+    Ensure(NumLines(MANIFEST) == 3, "Manifest grows with every run.");
+  }
+
+  /**
+   * Trusting the manifest skips recorded files whose copy has the recorded size without reading them,
+   * missing client updates.
+   */
+  void TestTrustManifest()
+  {
+    Reset();
+    Extract();
+
+    PlaceFile(PROJECT / "WORLD/TEST/A.TXT", "second a");
+    PlaceFile(PROJECT / "WORLD/TEST/B.TXT", "second b");
+    fs::remove(OUTPUT / "world/test/b.txt");
+
+    ExtractionSettings settings;
+    settings.trust_manifest = true;
+
+    ExtractionStats const stats = Extract(settings);
+
+    Ensure(stats.n_trusted == 2 && stats.n_written == 1 && Content(OUTPUT / "world/test/a.txt") == "first a"
+           && Content(OUTPUT / "world/test/b.txt") == "second b", "Recorded files were not trusted.");
+    Ensure(NumLines(MANIFEST) == 3, "Manifest was not compacted.");
+  }
+}
+
+int main()
+{
+  backward::SignalHandling sh;
+  Validation::Log::InitLoggers();
+
+  TestFilter();
+  TestResume();
+  TestTrustManifest();
+
+  fs::remove_all(ROOT);
+
+  return 0;
+}
@@ -0,0 +1,201 @@
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <IO/ByteBuffer.hpp>
+#include <IO/Storage/ClientStorage.hpp>
+#include <IO/Storage/FileKey.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#if defined(_MSC_VER) & !defined(__INTEL_COMPILER)
+  #pragma warning(push)
+  #pragma warning(disable : 4267)
+  #pragma warning(disable : 4996)
+
+  #include <backward.hpp>
+
+  #pragma warning(pop)
+#else
+  #include <backward.hpp>
+#endif
+
+using namespace IO;
+using namespace IO::Storage;
+namespace fs = std::filesystem;
+
+namespace
+{
+  // layer 0 holds A, B and C, layer 1 overrides A and hides B
+  constexpr std::string_view FILE_A = "WORLD/TEST/A.TXT";
+  constexpr std::string_view FILE_B = "WORLD/TEST/B.TXT";
+  constexpr std::string_view FILE_C = "WORLD/TEST/C.TXT";
+  constexpr std::string_view FILE_NEW = "WORLD/TEST/NEW.TXT";
+
+  fs::path const ROOT = fs::temp_directory_path() / "wowlib_client_storage_test";
+
+  void PlaceFile(fs::path const& path, std::string_view content)
+  {
+    fs::create_directories(path.parent_path());
+    std::ofstream strm {path, std::ios::binary | std::ios::trunc};
+    strm.write(content.data(), static_cast<std::streamsize>(content.size()));
+  }
+
+  /**
+   * @return Content of the file as read through the storage, empty if it is not found.
+   */
+  std::string ReadContent(ClientStorage& storage, std::string_view filepath)
+  {
+    Common::ByteBuffer buf {};
+    FileKey const key {storage, std::string(filepath), FileKey::FilePathCorrectionPolicy::CORRECT};
+
+    if (key.Read(buf) != FileKey::FileReadStatus::SUCCESS)
+      return {};
+
+    return {buf.Data(), buf.Size()};
+  }
+
+  void WriteContent(ClientStorage& storage, std::string_view filepath, std::string_view content)
+  {
+    Common::ByteBuffer buf {};
+    buf.Write(content.data(), content.size());
+
+    FileKey const key {storage, std::string(filepath), FileKey::FilePathCorrectionPolicy::CORRECT};
+    Ensure(key.Write(buf) == FileKey::FileWriteStatus::SUCCESS, "Writing a file failed.");
+  }
+
+  void RemoveContent(ClientStorage& storage, std::string_view filepath)
+  {
+    FileKey const key {storage, std::string(filepath), FileKey::FilePathCorrectionPolicy::CORRECT};
+    Ensure(key.Remove() == FileKey::FileWriteStatus::SUCCESS, "Removing a file failed.");
+  }
+
+  fs::path WhiteoutOf(fs::path const& layer, std::string_view filepath)
+  {
+    fs::path const path = layer / filepath;
+    return path.parent_path() / (".wh." + path.filename().string());
+  }
+
+  /**
+   * Storage over a project directory and one overlay directory, with files placed before it is opened.
+   */
+  std::unique_ptr<ClientStorage> OpenStorage()
+  {
+    fs::remove_all(ROOT);
+
+    PlaceFile(ROOT / "project" / FILE_A, "project a");
+    PlaceFile(ROOT / "project" / FILE_B, "project b");
+    PlaceFile(ROOT / "project" / FILE_C, "project c");
+    PlaceFile(ROOT / "overlay" / FILE_A, "overlay a");
+    PlaceFile(WhiteoutOf(ROOT / "overlay", FILE_B), "");
+
+    auto storage = std::make_unique<ClientStorage>((ROOT / "project").string(), Common::ClientVersion::WOTLK
+                                                   , Common::ByteBuffer{});
+    Ensure(storage->AddLayer((ROOT / "overlay").string()) == 1, "Overlay is not the second layer.");
+
+    return storage;
+  }
+
+  /**
+   * Files are read from the top-most layer holding them, whiteouts hide the files below them.
+   */
+  void TestPrecedence()
+  {
+    auto storage = OpenStorage();
+
+    Ensure(ReadContent(*storage, FILE_A) == "overlay a" && storage->FindLayer(std::string(FILE_A)) == 1
+           , "Overlay does not take precedence.");
+    Ensure(ReadContent(*storage, FILE_B).empty() && storage->FindLayer(std::string(FILE_B)) == ClientStorage::NO_LAYER
+           , "Whiteout does not hide the file below it.");
+    Ensure(ReadContent(*storage, FILE_C) == "project c" && storage->FindLayer(std::string(FILE_C)) == 0
+           , "File of a lower layer is not visible.");
+
+    // lookups are case-insensitive
+    Ensure(storage->FindLayer("world\\test\\a.txt") == 1, "Lookup depends on case.");
+
+    // the index only picks up outside changes on refresh
+    fs::remove(WhiteoutOf(ROOT / "overlay", FILE_B));
+    Ensure(ReadContent(*storage, FILE_B).empty(), "Index changed without a refresh.");
+
+    storage->RefreshLayers();
+    Ensure(ReadContent(*storage, FILE_B) == "project b", "Refresh did not pick up the removed whiteout.");
+  }
+
+  /**
+   * Writes go to the selected layer and lift whiteouts of it.
+   */
+  void TestWriteLayer()
+  {
+    auto storage = OpenStorage();
+
+    Ensure(storage->WriteLayer() == 0, "Project directory is not the default write layer.");
+    WriteContent(*storage, FILE_C, "written c");
+
+    Ensure(ReadContent(*storage, FILE_C) == "written c" && storage->FindLayer(std::string(FILE_C)) == 0
+           , "Write did not go to the project directory.");
+
+    // the overlay still wins over files written below it
+    WriteContent(*storage, FILE_A, "written a");
+    Ensure(ReadContent(*storage, FILE_A) == "overlay a", "Write below the overlay became visible.");
+
+    storage->SetWriteLayer(1);
+    WriteContent(*storage, FILE_NEW, "new");
+
+    Ensure(storage->FindLayer(std::string(FILE_NEW)) == 1 && fs::exists(ROOT / "overlay" / FILE_NEW)
+           , "Write did not go to the selected layer.");
+
+    WriteContent(*storage, FILE_B, "written b");
+
+    Ensure(ReadContent(*storage, FILE_B) == "written b" && !fs::exists(WhiteoutOf(ROOT / "overlay", FILE_B))
+           , "Write did not lift the whiteout.");
+  }
+
+  /**
+   * Removing a file still visible from below places a whiteout, removing the last copy does not.
+   */
+  void TestRemove()
+  {
+    auto storage = OpenStorage();
+    storage->SetWriteLayer(1);
+
+    RemoveContent(*storage, FILE_A);
+
+    Ensure(ReadContent(*storage, FILE_A).empty() && storage->FindLayer(std::string(FILE_A)) == ClientStorage::NO_LAYER
+           , "Removed file is still visible.");
+    Ensure(!fs::exists(ROOT / "overlay" / FILE_A) && fs::exists(WhiteoutOf(ROOT / "overlay", FILE_A))
+           , "Removal did not replace the file by a whiteout.");
+
+    // removing a file the layer does not hold hides the lower one too
+    RemoveContent(*storage, FILE_C);
+    Ensure(ReadContent(*storage, FILE_C).empty() && fs::exists(ROOT / "project" / FILE_C)
+           , "Removal did not hide the file of the lower layer.");
+
+    // nothing below holds the new file, so no whiteout is needed
+    WriteContent(*storage, FILE_NEW, "new");
+    RemoveContent(*storage, FILE_NEW);
+
+    Ensure(ReadContent(*storage, FILE_NEW).empty() && !fs::exists(WhiteoutOf(ROOT / "overlay", FILE_NEW))
+           , "Removing the last copy of a file left a whiteout.");
+
+    // the index agrees with the file system
+    storage->RefreshLayers();
+    Ensure(ReadContent(*storage, FILE_A).empty() && ReadContent(*storage, FILE_C).empty()
+           && ReadContent(*storage, FILE_B).empty(), "Index differs from the file system.");
+  }
+}
+
+int main()
+{
+  backward::SignalHandling sh;
+  Validation::Log::InitLoggers();
+
+  TestPrecedence();
+  TestWriteLayer();
+  TestRemove();
+
+  fs::remove_all(ROOT);
+
+  return 0;
+}
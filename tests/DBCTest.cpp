@@ -0,0 +1,170 @@
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <IO/ByteBuffer.hpp>
+#include <IO/DBC/DBCTable.hpp>
+#include <IO/DBC/Records.hpp>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#if defined(_MSC_VER) & !defined(__INTEL_COMPILER)
+  #pragma warning(push)
+  #pragma warning(disable : 4267)
+  #pragma warning(disable : 4996)
+
+  #include <backward.hpp>
+
+  #pragma warning(pop)
+#else
+  #include <backward.hpp>
+#endif
+
+using namespace IO;
+using namespace IO::DBC;
+using namespace IO::DBC::DataStructures;
+
+namespace
+{
+  constexpr std::uint32_t N_FIELDS = 3;
+  constexpr std::uint32_t BUILD = 15595;
+  constexpr std::uint32_t LOCALE = 8;
+
+  template<typename T>
+  void Append(std::vector<char>& out, T const& value)
+  {
+    auto bytes = reinterpret_cast<char const*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+  }
+
+  LightSkyboxRec Skybox(DBCTableWriter& writer, std::uint32_t id, std::string_view name, std::uint32_t flags)
+  {
+    LightSkyboxRec record = LightSkyboxRec::New();
+    record.id = id;
+    record.name = writer.AddString(name);
+    record.flags = flags;
+    return record;
+  }
+
+  bool SameBytes(Common::ByteBuffer const& lhs, Common::ByteBuffer const& rhs)
+  {
+    return lhs.Size() == rhs.Size() && !std::memcmp(lhs.Data(), rhs.Data(), lhs.Size());
+  }
+
+  /**
+   * WDB2 table with the extended header and ID index, which the writer does not produce.
+   */
+  Common::ByteBuffer ExtendedWDB2()
+  {
+    constexpr std::string_view strings {"\0sky/a.m2\0", 10};
+    std::array<LightSkyboxRec, 2> const records {LightSkyboxRec {1, {1}, 0}, LightSkyboxRec {3, {0}, 4}};
+
+    std::vector<char> out;
+    Append(out, DB2Header {Common::FourCC<"WDB2", Common::FourCCEndian::Big>
+                           , static_cast<std::uint32_t>(records.size()), N_FIELDS, sizeof(LightSkyboxRec)
+                           , static_cast<std::uint32_t>(strings.size()), 0x1234, BUILD, 0});
+    Append(out, DB2ExtendedHeader {1, 3, LOCALE, 0});
+
+    // ID index and string lengths of IDs 1..3
+    for (std::uint32_t row : {0u, 0u, 1u})
+      Append(out, row);
+
+    for (std::uint16_t length : {std::uint16_t(0), std::uint16_t(0), std::uint16_t(0)})
+      Append(out, length);
+
+    for (LightSkyboxRec const& record : records)
+      Append(out, record);
+
+    out.insert(out.end(), strings.begin(), strings.end());
+
+    Common::ByteBuffer buf {};
+    buf.Write(out.begin(), out.end());
+    return buf;
+  }
+}
+
+int main()
+{
+  backward::SignalHandling sh;
+  Validation::Log::InitLoggers();
+
+  // WDBC built from scratch
+  Common::ByteBuffer buf {};
+  {
+    DBCTableWriter writer {DBCFormat::WDBC, N_FIELDS, sizeof(LightSkyboxRec)};
+    writer.AddRecord(Skybox(writer, 5, "environments/stars/deathskybox.m2", 2));
+    writer.AddRecord(Skybox(writer, 9, "", 0));
+    writer.AddRecord(Skybox(writer, 7, "environments/stars/deathskybox.m2", 1));
+    writer.Write(buf);
+  }
+
+  DBCTable table {buf};
+  Ensure(table.Format() == DBCFormat::WDBC && table.NumRecords() == 3 && table.NumFields() == N_FIELDS
+         && table.RecordSize() == sizeof(LightSkyboxRec), "WDBC header was not read back.");
+
+  Ensure(table.Record<LightSkyboxRec>(0).id == 5 && table.Record<LightSkyboxRec>(2).flags == 1, "Records differ.");
+  Ensure(table.Records<LightSkyboxRec>().size() == 3, "Unexpected number of records.");
+  Ensure(table.String(table.Record<LightSkyboxRec>(0).name) == "environments/stars/deathskybox.m2"
+         && table.String(table.Record<LightSkyboxRec>(1).name).empty(), "Strings differ.");
+  Ensure(table.Record<LightSkyboxRec>(0).name.offset == table.Record<LightSkyboxRec>(2).name.offset
+         , "Identical strings were not deduplicated.");
+
+  Ensure(table.Row(9) == 1 && table.Row(6) == DBCTable::NO_ROW, "Row lookup by ID failed.");
+  Ensure(table.Find<LightSkyboxRec>(7) && table.Find<LightSkyboxRec>(7)->flags == 1 && !table.Find<LightSkyboxRec>(8)
+         , "Record lookup by ID failed.");
+
+  // an unchanged copy writes the same bytes
+  {
+    Common::ByteBuffer copy {};
+    DBCTableWriter {table}.Write(copy);
+    Ensure(SameBytes(copy, buf), "Copied table was not written identically.");
+  }
+
+  // patching keeps offsets of existing strings
+  {
+    DBCTableWriter writer {table};
+    writer.Record<LightSkyboxRec>(1).name = writer.AddString("environments/stars/nexusraid.m2");
+    writer.RemoveRecord(0);
+    writer.AddRecord(Skybox(writer, 100000, "environments/stars/deathskybox.m2", 3));
+
+    Common::ByteBuffer patched_buf {};
+    writer.Write(patched_buf);
+    DBCTable patched {patched_buf};
+
+    Ensure(patched.NumRecords() == 3 && patched.Row(5) == DBCTable::NO_ROW, "Removed record is still present.");
+    Ensure(patched.String(patched.Find<LightSkyboxRec>(9)->name) == "environments/stars/nexusraid.m2"
+           , "Patched string differs.");
+    Ensure(patched.Find<LightSkyboxRec>(7)->name.offset == table.Find<LightSkyboxRec>(7)->name.offset
+           , "Existing string moved.");
+
+    // widely spread IDs use the sparse index
+    Ensure(patched.Row(100000) == 2 && patched.Find<LightSkyboxRec>(100000)->flags == 3
+           && patched.Row(99999) == DBCTable::NO_ROW, "Sparse lookup by ID failed.");
+  }
+
+  // WDB2 with the extended header, the ID index is skipped on read and not written back
+  {
+    Common::ByteBuffer const db2_buf = ExtendedWDB2();
+    DBCTable db2 {db2_buf};
+
+    Ensure(db2.Format() == DBCFormat::WDB2 && db2.Build() == BUILD && db2.Locale() == LOCALE
+           && db2.TableHash() == 0x1234, "WDB2 header was not read back.");
+    Ensure(db2.NumRecords() == 2 && db2.String(db2.Find<LightSkyboxRec>(1)->name) == "sky/a.m2"
+           && db2.Find<LightSkyboxRec>(3)->flags == 4, "WDB2 records differ.");
+
+    Common::ByteBuffer written {};
+    DBCTableWriter {db2}.Write(written);
+    DBCTable reread {written};
+
+    Ensure(written.Size() == db2_buf.Size() - 3 * (sizeof(std::uint32_t) + sizeof(std::uint16_t))
+           , "ID index was written back.");
+    Ensure(reread.Build() == BUILD && reread.Locale() == LOCALE && reread.TableHash() == 0x1234
+           , "WDB2 header was not written back.");
+    Ensure(!std::memcmp(reread.RawRecord(0), db2.RawRecord(0), 2 * sizeof(LightSkyboxRec))
+           && reread.String(reread.Record<LightSkyboxRec>(0).name) == "sky/a.m2", "WDB2 records were not written back.");
+  }
+
+  return 0;
+}
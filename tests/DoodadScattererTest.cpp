@@ -0,0 +1,267 @@
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <IO/WorldConstants.hpp>
+#include <IO/ADT/DoodadScatterer.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER) & !defined(__INTEL_COMPILER)
+  #pragma warning(push)
+  #pragma warning(disable : 4267)
+  #pragma warning(disable : 4996)
+
+  #include <backward.hpp>
+
+  #pragma warning(pop)
+#else
+  #include <backward.hpp>
+#endif
+
+using namespace IO;
+using namespace IO::ADT;
+using namespace IO::Common;
+using namespace IO::Common::DataStructures;
+
+namespace
+{
+  constexpr std::array<TileIndex, 4> TILES {TileIndex {20, 20}, TileIndex {21, 20}, TileIndex {20, 21}
+                                            , TileIndex {21, 21}};
+
+  constexpr std::uint32_t FIRST_UNIQUE_ID = 1000000;
+  constexpr std::uint32_t PLACEMENTS_PER_TILE = 4096;
+  constexpr float MIN_DISTANCE = 8.f;
+  constexpr float CLEARANCE = 10.f;
+
+  using Key = std::pair<unsigned, unsigned>;
+  using Placements = std::map<Key, std::vector<ADT::DataStructures::MDDF>>;
+
+  Key KeyOf(TileIndex tile)
+  {
+    return {tile.x, tile.y};
+  }
+
+  std::bitset<WorldConstants::MAX_TILES_PER_MAP> MapTiles()
+  {
+    std::bitset<WorldConstants::MAX_TILES_PER_MAP> tiles;
+
+    for (TileIndex tile : TILES)
+      tiles.set(tile.y * 64 + tile.x);
+
+    return tiles;
+  }
+
+  ScatterParams Params()
+  {
+    ScatterRule rule;
+    rule.texture = {"Tileset\\Grass.blp", 0};
+    rule.model = {"world/bush.m2", 0};
+    rule.min_distance = MIN_DISTANCE;
+    rule.density = 0.5f;
+    rule.bounding_radius = CLEARANCE;
+
+    ScatterParams params;
+    params.rules = {rule};
+    params.seed = 42;
+    params.first_unique_id = FIRST_UNIQUE_ID;
+    params.max_placements_per_tile = PLACEMENTS_PER_TILE;
+    return params;
+  }
+
+  /**
+   * Flat grass tiles with the given existing model placements.
+   */
+  DoodadScatterer::TileLoader Loader(Placements const& existing)
+  {
+    return [&existing](TileIndex tile_index, DoodadTile& tile)
+    {
+      for (unsigned chunk = 0; chunk < WorldConstants::CHUNKS_PER_TILE; ++chunk)
+      {
+        tile.terrain[chunk].header = {};
+        tile.terrain[chunk].heightmap.fill(0.f);
+        tile.terrain[chunk].normals.fill({{0, 0, 127}});
+        tile.texturing.chunks[chunk].layers = {{0, {}, 0, 0}};
+      }
+
+      tile.texturing.textures = {{"tileset/grass.blp", 0}};
+
+      if (auto it = existing.find(KeyOf(tile_index)); it != existing.end())
+        tile.placements.model_placements = it->second;
+
+      return true;
+    };
+  }
+
+  Placements ScatterTiles(std::vector<TileIndex> const& order, Placements const& existing = {})
+  {
+    Placements result;
+    ScatterStats stats;
+
+    for (TileIndex tile_index : order)
+    {
+      auto tile = std::make_unique<DoodadTile>();
+      Loader(existing)(tile_index, *tile);
+      DoodadScatterer::ScatterTile(tile_index, Params(), *tile, stats);
+      result[KeyOf(tile_index)] = tile->placements.model_placements;
+    }
+
+    return result;
+  }
+
+  Placements Scatter(unsigned n_threads, Placements const& existing = {}, bool load_neighbours = false)
+  {
+    Placements result;
+    std::mutex mutex;
+
+    DoodadScatterer::PlacementLoader placement_loader;
+
+    if (load_neighbours)
+    {
+      placement_loader = [&existing](TileIndex tile_index, TilePlacements& placements)
+      {
+        if (auto it = existing.find(KeyOf(tile_index)); it != existing.end())
+          placements.model_placements = it->second;
+
+        return true;
+      };
+    }
+
+    DoodadScatterer::Scatter(MapTiles(), Params(), Loader(existing), [&](TileIndex tile_index, DoodadTile const& tile)
+    {
+      std::lock_guard lock(mutex);
+      result[KeyOf(tile_index)] = tile.placements.model_placements;
+    }, placement_loader, n_threads);
+
+    return result;
+  }
+
+  bool Same(Placements const& lhs, Placements const& rhs)
+  {
+    return lhs.size() == rhs.size() && std::all_of(lhs.begin(), lhs.end(), [&](auto const& tile)
+    {
+      auto it = rhs.find(tile.first);
+      return it != rhs.end() && it->second.size() == tile.second.size()
+        && (tile.second.empty() || !std::memcmp(it->second.data(), tile.second.data()
+                                                , tile.second.size() * sizeof(ADT::DataStructures::MDDF)));
+    });
+  }
+
+  float Distance(C3Vector const& lhs, float x, float z)
+  {
+    return std::hypot(lhs.x - x, lhs.z - z);
+  }
+}
+
+int main()
+{
+  backward::SignalHandling sh;
+  Validation::Log::InitLoggers();
+
+  std::vector<TileIndex> order {TILES.begin(), TILES.end()};
+  Placements const expected = ScatterTiles(order);
+
+  // placements do not depend on the order tiles are scattered in, nor on the number of threads
+  {
+    std::reverse(order.begin(), order.end());
+    Ensure(Same(ScatterTiles(order), expected), "Placements depend on tile order.");
+    Ensure(Same(Scatter(1), expected) && Same(Scatter(4), expected), "Placements depend on the number of threads.");
+  }
+
+  // placements keep their distance across tile borders, and unique IDs come from the range of their tile
+  {
+    std::vector<ADT::DataStructures::MDDF> all;
+    std::set<std::uint32_t> unique_ids;
+
+    for (auto const& [tile, placements] : expected)
+    {
+      std::uint32_t const first_id = FIRST_UNIQUE_ID + (tile.second * 64 + tile.first) * PLACEMENTS_PER_TILE;
+
+      for (auto const& placement : placements)
+      {
+        Ensure(placement.unique_id >= first_id && placement.unique_id < first_id + PLACEMENTS_PER_TILE
+               , "Unique ID is outside of the range of its tile.");
+        unique_ids.insert(placement.unique_id);
+        all.push_back(placement);
+      }
+    }
+
+    Ensure(all.size() > 100 && unique_ids.size() == all.size(), "Unique IDs are not unique.");
+
+    for (std::size_t i = 0; i < all.size(); ++i)
+    {
+      for (std::size_t j = i + 1; j < all.size(); ++j)
+      {
+        Ensure(Distance(all[i].position, all[j].position.x, all[j].position.z) >= MIN_DISTANCE
+               , "Placements are closer than the minimum distance.");
+      }
+    }
+  }
+
+  Key const tile_a = KeyOf(TILES[0]);
+  Key const tile_b = KeyOf(TILES[1]);
+
+  // the placement of A closest to the border with B, and an existing model of B right across the border
+  auto const& placements_a = expected.at(tile_a);
+  auto const border = std::max_element(placements_a.begin(), placements_a.end(), [](auto const& lhs, auto const& rhs)
+  {
+    return lhs.position.x < rhs.position.x;
+  });
+
+  float const border_x = TILES[1].x * WorldConstants::TILE_SIZE;
+  Ensure(border_x - border->position.x < CLEARANCE - 1.f, "No placement of A is close to B.");
+
+  ADT::DataStructures::MDDF obstacle {};
+  obstacle.position = {border_x + 0.5f, 0.f, border->position.z};
+  obstacle.unique_id = 1;
+  obstacle.scale = 1024;
+
+  Placements existing;
+  existing[tile_b] = {obstacle};
+
+  // without neighbour placements, A does not know about the model of B
+  {
+    Placements const unaware = Scatter(0, existing);
+    Ensure(unaware.at(tile_a).size() == placements_a.size(), "Placements of A changed without neighbour placements.");
+  }
+
+  {
+    Placements const aware = Scatter(0, existing, true);
+
+    for (auto const& placement : aware.at(tile_a))
+    {
+      Ensure(Distance(placement.position, obstacle.position.x, obstacle.position.z) >= CLEARANCE
+             , "Placement of A is too close to an existing placement of B.");
+    }
+
+    Ensure(aware.at(tile_a).size() < placements_a.size(), "Neighbour placement did not block anything.");
+    Ensure(Same(Scatter(4, existing, true), aware), "Placements with neighbours depend on the number of threads.");
+  }
+
+  // unique IDs taken within the range of a tile are skipped
+  {
+    std::uint32_t const first_id = FIRST_UNIQUE_ID + (TILES[0].y * 64 + TILES[0].x) * PLACEMENTS_PER_TILE;
+
+    ADT::DataStructures::MDDF taken {};
+    taken.position = {-1000.f, 0.f, -1000.f};
+    taken.unique_id = first_id + 1;
+    taken.scale = 1024;
+
+    Placements const rescattered = ScatterTiles({TILES[0]}, {{tile_a, {taken}}});
+    auto const& placements = rescattered.at(tile_a);
+
+    Ensure(placements.size() == placements_a.size() + 1 && placements[1].unique_id == first_id
+           && placements[2].unique_id == first_id + 2, "Taken unique ID was not skipped.");
+  }
+
+  return 0;
+}
@@ -0,0 +1,332 @@
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <IO/CommonGeometry.hpp>
+#include <Utils/Misc/SIMD.hpp>
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#if defined(_MSC_VER) & !defined(__INTEL_COMPILER)
+  #pragma warning(push)
+  #pragma warning(disable : 4267)
+  #pragma warning(disable : 4996)
+
+  #include <backward.hpp>
+
+  #pragma warning(pop)
+#else
+  #include <backward.hpp>
+#endif
+
+using namespace IO::Common;
+using namespace IO::Common::DataStructures;
+
+namespace
+{
+  // lengths around the 4 and 8 lane blocks, so that every tail length is covered
+  constexpr std::array<std::size_t, 14> LENGTHS {0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 64, 257};
+
+  constexpr std::array<float, 12> EDGE_VALUES {std::numeric_limits<float>::quiet_NaN()
+                                               , 0.f, -0.f
+                                               , std::numeric_limits<float>::infinity()
+                                               , -std::numeric_limits<float>::infinity()
+                                               , std::numeric_limits<float>::denorm_min()
+                                               , std::numeric_limits<float>::max()
+                                               , -std::numeric_limits<float>::max()
+                                               , WorldConstants::TILE_SIZE
+                                               , 64.f * WorldConstants::TILE_SIZE
+                                               , 17.f * WorldConstants::TILE_SIZE + 3.f * WorldConstants::CHUNK_SIZE
+                                               , -1.f};
+
+  std::mt19937 rng {20240917};
+
+  /**
+   * Random coordinate, an edge value one time in four.
+   */
+  float Value()
+  {
+    if (std::uniform_int_distribution<unsigned>{0, 3}(rng) == 0)
+      return EDGE_VALUES[std::uniform_int_distribution<std::size_t>{0, EDGE_VALUES.size() - 1}(rng)];
+
+    return std::uniform_real_distribution<float>{-2000.f, 36000.f}(rng);
+  }
+
+  C3Vector Vector()
+  {
+    return {Value(), Value(), Value()};
+  }
+
+  /**
+   * Same bits, or both NaN. NaN payloads depend on operand order, which compilers may swap.
+   */
+  bool Same(float a, float b)
+  {
+    return std::bit_cast<std::uint32_t>(a) == std::bit_cast<std::uint32_t>(b) || (std::isnan(a) && std::isnan(b));
+  }
+
+  bool Same(C3Vector const& a, C3Vector const& b)
+  {
+    return Same(a.x, b.x) && Same(a.y, b.y) && Same(a.z, b.z);
+  }
+
+  bool Same(CAaBox const& a, CAaBox const& b)
+  {
+    return Same(a.min, b.min) && Same(a.max, b.max);
+  }
+
+  Geometry::Matrix34 Matrix(bool with_edges)
+  {
+    Geometry::Matrix34 matrix {};
+
+    for (float& entry : matrix)
+      entry = with_edges ? Value() : std::uniform_real_distribution<float>{-2.f, 2.f}(rng);
+
+    return matrix;
+  }
+
+  Geometry::Frustum RandomFrustum(bool with_edges)
+  {
+    Geometry::Frustum frustum {};
+
+    for (Geometry::Plane& plane : frustum)
+    {
+      std::uniform_real_distribution<float> component {-1.f, 1.f};
+      plane.normal = {component(rng), component(rng), component(rng)};
+      plane.distance = std::uniform_real_distribution<float>{-20000.f, 20000.f}(rng);
+
+      if (with_edges)
+        plane.normal.y = EDGE_VALUES[std::uniform_int_distribution<std::size_t>{1, 2}(rng)];
+    }
+
+    return frustum;
+  }
+
+  void TestKernels(std::size_t n, bool with_edges)
+  {
+    std::vector<C3Vector> points(n);
+    std::vector<CAaBox> boxes(n);
+    std::vector<CAaSphere> spheres(n);
+
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      points[i] = Vector();
+      boxes[i] = {Vector(), Vector()};
+      spheres[i] = {Vector(), std::abs(Value())};
+    }
+
+    Geometry::Matrix34 const matrix = Matrix(with_edges);
+    Geometry::Frustum const frustum = RandomFrustum(with_edges);
+    CAaBox const clip {Vector(), Vector()};
+
+    // transforms, also in place
+    {
+      std::vector<C3Vector> out(n);
+      Geometry::TransformPoints(matrix, points, out);
+
+      std::vector<C3Vector> in_place = points;
+      Geometry::TransformPoints(matrix, in_place, in_place);
+
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        C3Vector const expected = Geometry::TransformPoint(matrix, points[i]);
+        Ensure(Same(out[i], expected), "TransformPoints differs from TransformPoint.");
+        Ensure(Same(in_place[i], expected), "TransformPoints in place differs from TransformPoint.");
+      }
+    }
+
+    {
+      std::vector<CAaBox> out(n);
+      Geometry::TransformBoxes(matrix, boxes, out);
+
+      std::vector<CAaBox> in_place = boxes;
+      Geometry::TransformBoxes(matrix, in_place, in_place);
+
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        CAaBox const expected = Geometry::TransformBox(matrix, boxes[i]);
+        Ensure(Same(out[i], expected), "TransformBoxes differs from TransformBox.");
+        Ensure(Same(in_place[i], expected), "TransformBoxes in place differs from TransformBox.");
+      }
+    }
+
+    // box operations
+    {
+      CAaBox expected = Geometry::EMPTY_BOX;
+
+      for (CAaBox const& box : boxes)
+        expected = Geometry::MergeBox(expected, box);
+
+      Ensure(Same(Geometry::MergeBoxes(boxes), expected), "MergeBoxes differs from MergeBox.");
+    }
+
+    {
+      std::vector<CAaBox> out(n);
+      Geometry::IntersectBoxes(clip, boxes, out);
+
+      std::vector<CAaBox> in_place = boxes;
+      Geometry::IntersectBoxes(clip, in_place, in_place);
+
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        CAaBox const expected = Geometry::IntersectBox(clip, boxes[i]);
+        Ensure(Same(out[i], expected), "IntersectBoxes differs from IntersectBox.");
+        Ensure(Same(in_place[i], expected), "IntersectBoxes in place differs from IntersectBox.");
+      }
+    }
+
+    {
+      std::vector<std::uint8_t> out(n);
+      std::size_t const n_inside = Geometry::ContainsPoints(clip, points, out);
+      std::size_t expected_inside = 0;
+
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        bool const expected = Geometry::Contains(clip, points[i]);
+        expected_inside += expected;
+        Ensure(out[i] == expected, "ContainsPoints differs from Contains.");
+      }
+
+      Ensure(n_inside == expected_inside, "ContainsPoints miscounted points inside.");
+    }
+
+    // frustum classification
+    {
+      std::vector<Geometry::Containment> out(n);
+      std::size_t const n_visible = Geometry::ClassifyBoxes(frustum, boxes, out);
+      std::size_t expected_visible = 0;
+
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        Geometry::Containment const expected = Geometry::Classify(frustum, boxes[i]);
+        expected_visible += expected != Geometry::Containment::OUTSIDE;
+        Ensure(out[i] == expected, "ClassifyBoxes differs from Classify.");
+      }
+
+      Ensure(n_visible == expected_visible, "ClassifyBoxes miscounted visible boxes.");
+    }
+
+    {
+      std::vector<Geometry::Containment> out(n);
+      std::size_t const n_visible = Geometry::ClassifySpheres(frustum, spheres, out);
+      std::size_t expected_visible = 0;
+
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        Geometry::Containment const expected = Geometry::Classify(frustum, spheres[i]);
+        expected_visible += expected != Geometry::Containment::OUTSIDE;
+        Ensure(out[i] == expected, "ClassifySpheres differs from Classify.");
+      }
+
+      Ensure(n_visible == expected_visible, "ClassifySpheres miscounted visible spheres.");
+    }
+
+    // coordinate conversions and lookups
+    {
+      std::vector<C3Vector> world(n);
+      std::vector<C3Vector> placement(n);
+      Geometry::PlacementToWorld(points, world);
+      Geometry::WorldToPlacement(world, placement);
+
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        Ensure(Same(world[i], Geometry::PlacementToWorld(points[i])), "PlacementToWorld differs.");
+        Ensure(Same(placement[i], Geometry::WorldToPlacement(world[i])), "WorldToPlacement differs.");
+      }
+    }
+
+    {
+      std::vector<TileIndex> tiles(n);
+      std::vector<std::uint16_t> chunks(n);
+      Geometry::TileIndicesAt(points, tiles);
+      Geometry::ChunkIndicesAt(points, chunks);
+
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        TileIndex const expected = Geometry::TileIndexAt(points[i]);
+        Ensure(tiles[i].x == expected.x && tiles[i].y == expected.y, "TileIndicesAt differs from TileIndexAt.");
+        Ensure(chunks[i] == Geometry::ChunkIndexAt(points[i]), "ChunkIndicesAt differs from ChunkIndexAt.");
+      }
+    }
+
+    {
+      CRange expected {std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity()};
+
+      for (C3Vector const& point : points)
+      {
+        expected.min = std::min(expected.min, point.y);
+        expected.max = std::max(expected.max, point.y);
+      }
+
+      CRange const range = Geometry::HeightRange(points);
+      Ensure(Same(range.min, expected.min) && Same(range.max, expected.max), "HeightRange differs from a scan.");
+    }
+  }
+
+  /**
+   * Heights whose extremes are zeros of both signs, in an order lanes would reduce differently.
+   */
+  void TestZeroSigns()
+  {
+    std::vector<C3Vector> points(9, C3Vector {0.f, 1.f, 0.f});
+    points[1].y = -0.f;
+    points[4].y = 0.f;
+
+    CRange range = Geometry::HeightRange(points);
+    Ensure(std::signbit(range.min) && range.min == 0.f, "HeightRange lost the sign of the first zero.");
+
+    for (C3Vector& point : points)
+      point.y = -point.y;
+
+    points[1].y = 0.f;
+    points[4].y = -0.f;
+
+    range = Geometry::HeightRange(points);
+    Ensure(!std::signbit(range.max) && range.max == 0.f, "HeightRange lost the sign of the first zero.");
+  }
+}
+
+int main()
+{
+  backward::SignalHandling sh;
+  Validation::Log::InitLoggers();
+
+  Geometry::InstructionSet const best = Geometry::ActiveInstructionSet();
+  Ensure(Geometry::IsSupported(best) && Geometry::IsSupported(Geometry::InstructionSet::SCALAR)
+         , "Active instruction set is not supported.");
+
+  bool const simd_enabled = Utils::Misc::SIMD::IsEnabled();
+
+  constexpr std::array<Geometry::InstructionSet, 5> INSTRUCTION_SETS {Geometry::InstructionSet::SCALAR
+                                                                      , Geometry::InstructionSet::SSE2
+                                                                      , Geometry::InstructionSet::SSE41
+                                                                      , Geometry::InstructionSet::AVX2
+                                                                      , Geometry::InstructionSet::NEON};
+
+  for (Geometry::InstructionSet const instruction_set : INSTRUCTION_SETS)
+  {
+    if (!Geometry::IsSupported(instruction_set))
+      continue;
+
+    Geometry::SetInstructionSet(instruction_set);
+    Ensure(Geometry::ActiveInstructionSet() == instruction_set, "Instruction set was not selected.");
+    Ensure(Utils::Misc::SIMD::IsEnabled() == simd_enabled
+           , "Selecting an instruction set for batch kernels changed the path of other kernels.");
+
+    for (std::size_t const n : LENGTHS)
+    {
+      TestKernels(n, false);
+      TestKernels(n, true);
+    }
+
+    TestZeroSigns();
+  }
+
+  Geometry::SetInstructionSet(best);
+
+  return 0;
+}
@@ -0,0 +1,147 @@
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <IO/ByteBuffer.hpp>
+#include <IO/Storage/ListfileManager.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER) & !defined(__INTEL_COMPILER)
+  #pragma warning(push)
+  #pragma warning(disable : 4267)
+  #pragma warning(disable : 4996)
+
+  #include <backward.hpp>
+
+  #pragma warning(pop)
+#else
+  #include <backward.hpp>
+#endif
+
+using namespace IO;
+using namespace IO::Storage;
+
+namespace
+{
+  std::mt19937 rng {20241019};
+
+  std::string TexturePath(std::size_t i)
+  {
+    return "WORLD\\MAPTEXTURES\\TEST\\T" + std::to_string(i) + ".BLP";
+  }
+
+  ListfileManager OpenListfile(std::vector<std::string> const& filepaths)
+  {
+    Common::ByteBuffer buf {};
+
+    for (std::string const& filepath : filepaths)
+    {
+      buf.Write(filepath.data(), filepath.size());
+      buf.Write("\r\n", 2);
+    }
+
+    buf.Seek(0);
+    return ListfileManager {buf};
+  }
+
+  /**
+   * Two paths whose internal FileDataIDs collide before probing, found by brute force.
+   */
+  std::pair<std::string, std::string> CollidingPaths()
+  {
+    std::unordered_map<std::uint32_t, std::size_t> seen;
+
+    for (std::size_t i = 0;; ++i)
+    {
+      auto const [it, is_new] = seen.try_emplace(ListfileManager::InternalFileDataID(TexturePath(i)), i);
+
+      if (!is_new)
+        return {TexturePath(it->second), TexturePath(i)};
+    }
+  }
+
+  /**
+   * IDs do not depend on the order of listfile entries, duplicates, or the order paths are added in at runtime.
+   */
+  void TestDeterminism()
+  {
+    std::vector<std::string> listed;
+    std::vector<std::string> added;
+
+    for (std::size_t i = 0; i < 300; ++i)
+      (i % 3 ? listed : added).push_back(TexturePath(i));
+
+    std::vector<std::string> shuffled = listed;
+    std::shuffle(shuffled.begin(), shuffled.end(), rng);
+    shuffled.insert(shuffled.end(), listed.begin(), listed.begin() + 50);
+
+    ListfileManager first = OpenListfile(listed);
+    ListfileManager second = OpenListfile(shuffled);
+
+    for (std::string const& filepath : listed)
+    {
+      std::uint32_t const file_data_id = first.GetFileDatIDForFilepath(filepath);
+
+      Ensure(file_data_id && file_data_id == second.GetFileDatIDForFilepath(filepath)
+             , "Listfile entry got a different ID.");
+      Ensure(file_data_id == ListfileManager::InternalFileDataID(filepath), "ID is not the hash of the path.");
+    }
+
+    std::vector<std::uint32_t> first_ids;
+
+    for (std::string const& filepath : added)
+      first_ids.push_back(first.GetOrAddFileDataID(filepath));
+
+    std::reverse(added.begin(), added.end());
+    std::reverse(first_ids.begin(), first_ids.end());
+
+    for (std::size_t i = 0; i < added.size(); ++i)
+      Ensure(second.GetOrAddFileDataID(added[i]) == first_ids[i], "Added path got a different ID.");
+  }
+
+  /**
+   * Colliding listfile entries probe in sorted path order, runtime paths probe past listfile entries regardless
+   * of when they are added, and take over IDs generated before their path was known.
+   */
+  void TestProbing()
+  {
+    auto const [a, b] = CollidingPaths();
+    auto const [low, high] = std::minmax(a, b);
+    std::uint32_t const hash = ListfileManager::InternalFileDataID(a);
+
+    ListfileManager both = OpenListfile({high, low});
+    Ensure(both.GetFileDatIDForFilepath(low) == hash && both.GetFileDatIDForFilepath(high) == hash + 1
+           , "Colliding listfile entries were not probed in path order.");
+
+    ListfileManager listed_low = OpenListfile({low});
+    ListfileManager listed_high = OpenListfile({high});
+    Ensure(listed_low.GetOrAddFileDataID(high) == hash + 1 && listed_high.GetOrAddFileDataID(low) == hash + 1
+           , "Added path did not probe past the listfile entry.");
+
+    // only paths colliding with each other at runtime depend on the order they are added in
+    ListfileManager runtime = OpenListfile({});
+    Ensure(runtime.GetOrAddFileDataID(high) == hash && runtime.GetOrAddFileDataID(low) == hash + 1
+           , "Added paths did not probe past each other.");
+
+    ListfileManager referenced = OpenListfile({});
+    std::string const generated = referenced.GetOrGenerateFilepath(hash);
+    Ensure(referenced.GetOrAddFileDataID(low) == hash && referenced.GetOrGenerateFilepath(hash) == low
+           && generated != low, "Added path did not take over the generated one.");
+  }
+}
+
+int main()
+{
+  backward::SignalHandling sh;
+  Validation::Log::InitLoggers();
+
+  TestDeterminism();
+  TestProbing();
+
+  return 0;
+}
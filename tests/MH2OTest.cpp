@@ -0,0 +1,256 @@
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <IO/ADT/Root/MH2O.hpp>
+#include <IO/ADT/Root/LiquidFiller.hpp>
+
+#include <cstdint>
+#include <variant>
+
+#if defined(_MSC_VER) & !defined(__INTEL_COMPILER)
+  #pragma warning(push)
+  #pragma warning(disable : 4267)
+  #pragma warning(disable : 4996)
+
+  #include <backward.hpp>
+
+  #pragma warning(pop)
+#else
+  #include <backward.hpp>
+#endif
+
+using namespace IO;
+using namespace IO::ADT;
+
+namespace
+{
+  using LVF = LiquidLayer::LiquidVertexFormat;
+
+  /**
+   * Only vertices of the smallest rectangle around existing quads are stored, the others must stay zero.
+   */
+  bool IsInsideStoredRect(std::bitset<64> const& exists_map, unsigned vertex)
+  {
+    unsigned min_x = 8, min_y = 8, max_x = 0, max_y = 0;
+
+    for (unsigned i = 0; i < 64; ++i)
+    {
+      if (!exists_map[i])
+        continue;
+
+      min_x = std::min(min_x, i % 8);
+      min_y = std::min(min_y, i / 8);
+      max_x = std::max(max_x, i % 8);
+      max_y = std::max(max_y, i / 8);
+    }
+
+    unsigned const x = vertex % 9;
+    unsigned const y = vertex / 9;
+    return x >= min_x && x <= max_x + 1 && y >= min_y && y <= max_y + 1;
+  }
+
+  LiquidLayer MakeLayer(LVF format, std::uint64_t exists_map, unsigned seed)
+  {
+    LiquidLayer layer {};
+    layer.liquid_type = static_cast<std::uint16_t>(seed % 20 + 1);
+    layer.liquid_vertex_format = format;
+    layer.min_height_level = -10.f - static_cast<float>(seed);
+    layer.max_height_level = 25.f + static_cast<float>(seed);
+    layer.exists_map = exists_map;
+    layer.has_vertex_data = true;
+
+    auto const height = [&](unsigned i) { return IsInsideStoredRect(layer.exists_map, i) ? 0.25f * (i + seed) : 0.f; };
+    auto const depth = [&](unsigned i) { return IsInsideStoredRect(layer.exists_map, i) ? static_cast<char>(i * 3 + seed) : 0; };
+    auto const uv = [&](unsigned i)
+    {
+      return IsInsideStoredRect(layer.exists_map, i)
+        ? DataStructures::MH20UVMapEntry{static_cast<std::uint16_t>(i * 8), static_cast<std::uint16_t>(seed * 8 + i)}
+        : DataStructures::MH20UVMapEntry{0, 0};
+    };
+
+    switch (format)
+    {
+      case LVF::HEIGHT_DEPTH:
+      {
+        auto& data = layer.vertex_data.emplace<DataStructures::MH2OHeightDepth>();
+        for (unsigned i = 0; i < 81; ++i) { data.heightmap[i] = height(i); data.depthmap[i] = depth(i); }
+        break;
+      }
+      case LVF::HEIGHT_TEXCOORD:
+      {
+        auto& data = layer.vertex_data.emplace<DataStructures::MH2OHeightTexCoord>();
+        for (unsigned i = 0; i < 81; ++i) { data.heightmap[i] = height(i); data.uvmap[i] = uv(i); }
+        break;
+      }
+      case LVF::DEPTH:
+      {
+        auto& data = layer.vertex_data.emplace<DataStructures::MH2ODepth>();
+        for (unsigned i = 0; i < 81; ++i) { data.depthmap[i] = depth(i); }
+        break;
+      }
+      case LVF::HEIGHT_DEPTH_TEXCOORD:
+      {
+        auto& data = layer.vertex_data.emplace<DataStructures::MH2OHeightDepthTexCoord>();
+        for (unsigned i = 0; i < 81; ++i) { data.heightmap[i] = height(i); data.uvmap[i] = uv(i); data.depthmap[i] = depth(i); }
+        break;
+      }
+    }
+
+    return layer;
+  }
+
+  bool UVEqual(auto const& a, auto const& b)
+  {
+    return std::equal(a.begin(), a.end(), b.begin(), [](auto const& l, auto const& r) { return l.x == r.x && l.y == r.y; });
+  }
+
+  bool VertexDataEqual(LiquidLayer const& a, LiquidLayer const& b)
+  {
+    if (a.vertex_data.index() != b.vertex_data.index())
+      return false;
+
+    switch (a.liquid_vertex_format)
+    {
+      case LVF::HEIGHT_DEPTH:
+      {
+        auto const& l = std::get<DataStructures::MH2OHeightDepth>(a.vertex_data);
+        auto const& r = std::get<DataStructures::MH2OHeightDepth>(b.vertex_data);
+        return l.heightmap == r.heightmap && l.depthmap == r.depthmap;
+      }
+      case LVF::HEIGHT_TEXCOORD:
+      {
+        auto const& l = std::get<DataStructures::MH2OHeightTexCoord>(a.vertex_data);
+        auto const& r = std::get<DataStructures::MH2OHeightTexCoord>(b.vertex_data);
+        return l.heightmap == r.heightmap && UVEqual(l.uvmap, r.uvmap);
+      }
+      case LVF::DEPTH:
+      {
+        return std::get<DataStructures::MH2ODepth>(a.vertex_data).depthmap
+          == std::get<DataStructures::MH2ODepth>(b.vertex_data).depthmap;
+      }
+      case LVF::HEIGHT_DEPTH_TEXCOORD:
+      {
+        auto const& l = std::get<DataStructures::MH2OHeightDepthTexCoord>(a.vertex_data);
+        auto const& r = std::get<DataStructures::MH2OHeightDepthTexCoord>(b.vertex_data);
+        return l.heightmap == r.heightmap && l.depthmap == r.depthmap && UVEqual(l.uvmap, r.uvmap);
+      }
+    }
+
+    return false;
+  }
+}
+
+int main()
+{
+  backward::SignalHandling sh;
+  Validation::Log::InitLoggers();
+
+  MH2O mh2o {};
+  mh2o.Initialize();
+
+  // full chunk, without exists bitmap
+  mh2o.chunks()[0].Layers().push_back(MakeLayer(LVF::HEIGHT_DEPTH, ~std::uint64_t{0}, 1));
+
+  // sparse quads in a rectangle not touching the chunk corner
+  mh2o.chunks()[5].Layers().push_back(MakeLayer(LVF::HEIGHT_DEPTH_TEXCOORD, 0x0000'0010'2040'0000, 2));
+  mh2o.chunks()[5].AddAttributes(0x0000'0010'2040'0000, 0x0000'0000'0040'0000);
+
+  // single quad in the last row and column
+  mh2o.chunks()[17].Layers().push_back(MakeLayer(LVF::DEPTH, std::uint64_t{1} << 63, 3));
+
+  // two layers, one without vertex data
+  mh2o.chunks()[255].Layers().push_back(MakeLayer(LVF::HEIGHT_TEXCOORD, 0x00FF'00FF'00FF'00FF, 4));
+  LiquidLayer& flat = mh2o.chunks()[255].Layers().emplace_back(MakeLayer(LVF::HEIGHT_DEPTH, 0x0303'0000'0000'0000, 5));
+  flat.has_vertex_data = false;
+
+  Common::ByteBuffer buf {};
+  mh2o.Write(buf);
+  buf.Seek(0);
+
+  auto const header = buf.Read<Common::ChunkHeader>();
+  Ensure(header.size + sizeof(Common::ChunkHeader) == buf.Size(), "Chunk size does not match written data.");
+
+  MH2O read_mh2o {};
+  read_mh2o.Read(buf, header.size);
+
+  for (std::size_t i = 0; i < mh2o.chunks().size(); ++i)
+  {
+    LiquidChunk const& expected = mh2o.chunks()[i];
+    LiquidChunk const& chunk = read_mh2o.chunks()[i];
+
+    Ensure(chunk.Layers().size() == expected.Layers().size(), "Layer count changed in round-trip.");
+    Ensure(chunk.Attributes().has_value() == expected.Attributes().has_value(), "Attributes lost in round-trip.");
+
+    if (expected.Attributes())
+    {
+      Ensure(chunk.Attributes()->fishable == expected.Attributes()->fishable
+             && chunk.Attributes()->deep == expected.Attributes()->deep, "Attributes changed in round-trip.");
+    }
+
+    for (std::size_t j = 0; j < expected.Layers().size(); ++j)
+    {
+      LiquidLayer const& expected_layer = expected.Layers()[j];
+      LiquidLayer const& layer = chunk.Layers()[j];
+
+      Ensure(layer.liquid_type == expected_layer.liquid_type
+             && layer.liquid_vertex_format == expected_layer.liquid_vertex_format
+             && layer.min_height_level == expected_layer.min_height_level
+             && layer.max_height_level == expected_layer.max_height_level, "Layer header changed in round-trip.");
+      Ensure(layer.exists_map == expected_layer.exists_map, "Exists map changed in round-trip.");
+      Ensure(layer.has_vertex_data == expected_layer.has_vertex_data, "Vertex data presence changed in round-trip.");
+      Ensure(!layer.has_vertex_data || VertexDataEqual(layer, expected_layer), "Vertex data changed in round-trip.");
+    }
+  }
+
+  // LVF 3 stores heights, then texture coordinates, then depths, each over the stored rectangle
+  {
+    buf.Seek(sizeof(Common::ChunkHeader) + 5 * sizeof(DataStructures::SMLiquidChunk));
+    auto const chunk_header = buf.Read<DataStructures::SMLiquidChunk>();
+
+    buf.Seek(sizeof(Common::ChunkHeader) + chunk_header.offset_instances);
+    auto const instance = buf.Read<DataStructures::SMLiquidInstance>();
+
+    auto const& expected = std::get<DataStructures::MH2OHeightDepthTexCoord>(mh2o.chunks()[5].Layers()[0].vertex_data);
+    unsigned const first_vertex = instance.y_offset * 9u + instance.x_offset;
+    std::size_t const n_vertices = (instance.width + 1u) * (instance.height + 1u);
+
+    buf.Seek(sizeof(Common::ChunkHeader) + instance.offset_vertex_data);
+    Ensure(buf.Read<float>() == expected.heightmap[first_vertex], "LVF 3 does not start with heights.");
+
+    buf.Seek(sizeof(Common::ChunkHeader) + instance.offset_vertex_data + n_vertices * sizeof(float));
+    auto const uv = buf.Read<DataStructures::MH20UVMapEntry>();
+    Ensure(uv.x == expected.uvmap[first_vertex].x && uv.y == expected.uvmap[first_vertex].y
+           , "LVF 3 texture coordinates do not follow heights.");
+
+    buf.Seek(sizeof(Common::ChunkHeader) + instance.offset_vertex_data
+             + n_vertices * (sizeof(float) + sizeof(DataStructures::MH20UVMapEntry)));
+    Ensure(buf.Read<char>() == expected.depthmap[first_vertex], "LVF 3 depths do not follow texture coordinates.");
+  }
+
+  // writing again must reproduce the same chunk
+  Common::ByteBuffer buf_again {};
+  read_mh2o.Write(buf_again);
+  Ensure(buf_again.Size() == buf.Size()
+         && std::equal(buf.Data(), buf.Data() + buf.Size(), buf_again.Data()), "Second write differs from the first.");
+
+  // removing quads shrinks the height range of the layer to the remaining ones
+  {
+    LiquidChunk chunk;
+    LiquidVertexValues values;
+
+    for (unsigned vertex = 0; vertex < values.heights.size(); ++vertex)
+      values.heights[vertex] = vertex < 9 ? 10.f : 2.f;
+
+    // quad 0 touches the high first vertex row, quad 63 only low vertices
+    LiquidFiller::MergeQuads(chunk, 1, std::uint64_t{1} | std::uint64_t{1} << 63, values, false);
+    Ensure(chunk.Layers().size() == 1 && chunk.Layers()[0].max_height_level == 10.f, "Merged height range is wrong.");
+
+    LiquidFiller::RemoveQuads(chunk, 1);
+    Ensure(chunk.Layers()[0].min_height_level == 2.f && chunk.Layers()[0].max_height_level == 2.f
+           , "Height range did not shrink with removed quads.");
+
+    LiquidFiller::RemoveQuads(chunk, std::uint64_t{1} << 63);
+    Ensure(chunk.Layers().empty(), "Layer without quads was not dropped.");
+  }
+
+  return 0;
+}
@@ -0,0 +1,202 @@
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <IO/ByteBuffer.hpp>
+#include <IO/Collision/MapObjectLocator.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+#if defined(_MSC_VER) & !defined(__INTEL_COMPILER)
+  #pragma warning(push)
+  #pragma warning(disable : 4267)
+  #pragma warning(disable : 4996)
+
+  #include <backward.hpp>
+
+  #pragma warning(pop)
+#else
+  #include <backward.hpp>
+#endif
+
+using namespace IO;
+using namespace IO::Collision;
+using namespace IO::Common::DataStructures;
+
+namespace
+{
+  constexpr std::uint32_t ROOT_ID = 77;
+  constexpr std::uint32_t UNIQUE_ID = 555;
+  constexpr std::uint16_t NAME_SET = 2;
+  constexpr C3Vector MODEL_UP {0.f, 0.f, 1.f};
+
+  using Groups = std::vector<std::uint32_t>;
+
+  /**
+   * Horizontal quad at height z, two triangles.
+   */
+  void AddQuad(CollisionMesh& mesh, float x0, float y0, float x1, float y1, float z)
+  {
+    auto const base = static_cast<std::uint32_t>(mesh.vertices.size());
+    mesh.vertices.insert(mesh.vertices.end(), {{x0, y0, z}, {x1, y0, z}, {x1, y1, z}, {x0, y1, z}});
+
+    for (std::uint32_t index : {0u, 1u, 2u, 0u, 2u, 3u})
+      mesh.indices.push_back(base + index);
+  }
+
+  /**
+   * Three rooms in a row along x, z-up: an interior hall (0), an exterior courtyard (1) and an interior
+   * tower (2). Each wall between them has a door, near y = 5 between 0 and 1, near y = 17 between 1 and 2,
+   * so the hall and the tower can only see each other from right in front of the hall door.
+   */
+  MapObjectDefinition Definition()
+  {
+    MapObjectDefinition definition;
+    definition.root_id = ROOT_ID;
+
+    definition.groups = {{{{0.f, 0.f, 0.f}, {10.f, 10.f, 8.f}}, GROUP_INTERIOR, 100, 0, 1}
+                         , {{{10.f, 0.f, 0.f}, {20.f, 20.f, 8.f}}, GROUP_EXTERIOR, 101, 1, 2}
+                         , {{{20.f, 0.f, 0.f}, {30.f, 20.f, 8.f}}, GROUP_INTERIOR, 102, 3, 1}};
+
+    // interiors have a floor and a ceiling, the courtyard only a floor
+    definition.meshes.resize(3);
+    AddQuad(definition.meshes[0], 0.f, 0.f, 10.f, 10.f, 0.f);
+    AddQuad(definition.meshes[0], 0.f, 0.f, 10.f, 10.f, 4.f);
+    AddQuad(definition.meshes[1], 10.f, 0.f, 20.f, 20.f, 0.f);
+    AddQuad(definition.meshes[2], 20.f, 0.f, 30.f, 20.f, 0.f);
+    AddQuad(definition.meshes[2], 20.f, 0.f, 30.f, 20.f, 4.f);
+
+    definition.portals = {{{{10.f, 4.f, 0.f}, {10.f, 6.f, 0.f}, {10.f, 6.f, 3.f}, {10.f, 4.f, 3.f}}, {1.f, 0.f, 0.f}}
+                          , {{{20.f, 16.f, 0.f}, {20.f, 18.f, 0.f}, {20.f, 18.f, 3.f}, {20.f, 16.f, 3.f}}
+                             , {1.f, 0.f, 0.f}}};
+
+    definition.portal_refs = {{0, 1, -1, 0}, {0, 0, 1, 0}, {1, 2, -1, 0}, {1, 1, 1, 0}};
+    return definition;
+  }
+
+  void TestModel(MapObjectModel const& model)
+  {
+    float floor_distance = 0.f;
+    Ensure(model.LocateGroup({5.f, 5.f, 2.f}, MODEL_UP, floor_distance) == 0 && std::abs(floor_distance - 2.f) < 1e-4f
+           , "Point in the hall was not located.");
+    Ensure(model.LocateGroup({5.f, 5.f, 6.f}, MODEL_UP, floor_distance) == MapObjectModel::NO_GROUP
+           , "Point above the roof of the hall is inside.");
+    Ensure(model.LocateGroup({15.f, 5.f, 6.f}, MODEL_UP, floor_distance) == 1
+           , "Exterior group requires a ceiling.");
+    Ensure(model.LocateGroup({25.f, 5.f, 1.f}, MODEL_UP, floor_distance) == 2, "Point in the tower was not located.");
+    Ensure(model.LocateGroup({40.f, 5.f, 1.f}, MODEL_UP, floor_distance) == MapObjectModel::NO_GROUP
+           , "Point outside of all groups is inside.");
+
+    // the tower door is only in view through the hall door from close by
+    Groups const courtyard {0, 1};
+    Groups const all {0, 1, 2};
+    Groups const tower {1, 2};
+
+    Ensure(model.VisibleGroups(0, {5.f, 5.f, 2.f}) == courtyard, "Tower is visible from the back of the hall.");
+    Ensure(model.VisibleGroups(0, {9.5f, 5.f, 2.f}) == all, "Tower is not visible from the hall door.");
+    Ensure(model.VisibleGroups(1, {15.f, 17.f, 2.f}) == all, "Courtyard does not see both doors.");
+    Ensure(model.VisibleGroups(2, {25.f, 17.f, 2.f}) == tower, "Hall is visible from the back of the tower.");
+
+    // portals are not looked through backwards
+    Ensure(model.VisibleGroups(2, {15.f, 17.f, 2.f}) == Groups {2}, "Portal was looked through from behind.");
+  }
+}
+
+int main()
+{
+  backward::SignalHandling sh;
+  Validation::Log::InitLoggers();
+
+  auto const model = std::make_shared<MapObjectModel const>(Definition());
+  Ensure(model->RootId() == ROOT_ID && model->Groups().size() == 3, "Model was not built.");
+  TestModel(*model);
+
+  // cached models answer the same
+  auto cached = std::make_shared<MapObjectModel>();
+  {
+    Common::ByteBuffer buf {};
+    model->Write(buf);
+    buf.Seek(0);
+    cached->Read(buf);
+  }
+
+  TestModel(*cached);
+
+  // one placement by path, one by FileDataID of a file without a model
+  ADT::TilePlacements placements;
+  placements.map_objects = {{"world/wmo/hall.wmo", 0}};
+
+  ADT::DataStructures::MODF placement {};
+  placement.unique_id = UNIQUE_ID;
+  placement.position = {1000.f, 50.f, 2000.f};
+  placement.rotation = {0.f, 37.f, 0.f};
+  placement.nameSet = NAME_SET;
+
+  ADT::DataStructures::MODF missing = placement;
+  missing.name_id = 123456;
+  missing.flags.use_filedata_id = 1;
+  missing.unique_id = UNIQUE_ID + 1;
+
+  placements.map_object_placements = {placement, missing};
+
+  std::vector<ADT::AssetReference> requested;
+  MapObjectLocator const locator {placements, [&](ADT::AssetReference const& asset)
+  {
+    requested.push_back(asset);
+    return asset.path == "world/wmo/hall.wmo" ? cached : nullptr;
+  }};
+
+  Ensure(locator.NumInstances() == 1 && locator.NumModels() == 1, "Unexpected number of instances.");
+  Ensure(requested.size() == 2 && requested[0] == placements.map_objects[0]
+         && requested[1] == ADT::AssetReference({}, 123456), "Model provider did not get the files of the placements.");
+
+  Transform const to_world = TileCollision::PlacementTransform(placement.position, placement.rotation, 1.f);
+
+  auto world = [&](float x, float y, float z)
+  {
+    return to_world.TransformPoint({x, y, z});
+  };
+
+  {
+    MapObjectLocation const location = locator.Locate(world(5.f, 5.f, 2.f));
+    Ensure(location.inside && location.group == 0 && location.group_id == 100 && location.root_id == ROOT_ID
+           && location.unique_id == UNIQUE_ID && location.name_set == NAME_SET && location.IsIndoor()
+           , "Position in the hall was not located.");
+    Ensure(std::abs(location.floor_distance - 2.f) < 1e-3f, "Floor distance is not in placement units.");
+  }
+
+  {
+    MapObjectLocation const location = locator.Locate(world(15.f, 5.f, 2.f));
+    Ensure(location.inside && location.group == 1 && !location.IsIndoor(), "Courtyard is indoor.");
+    Ensure(!locator.Locate(world(5.f, 5.f, 6.f)).inside, "Position on the roof is inside.");
+  }
+
+  Ensure(locator.VisibleGroups(world(9.5f, 5.f, 2.f)) == Groups({0, 1, 2}), "Visible groups differ.");
+  Ensure(locator.VisibleGroups(world(500.f, 5.f, 2.f)).empty(), "Groups are visible from outside.");
+
+  // within the placement through portals, to the outside through an exterior group
+  Ensure(locator.IsVisible(world(9.5f, 5.f, 2.f), world(25.f, 17.f, 2.f)), "Tower is not visible from the hall door.");
+  Ensure(!locator.IsVisible(world(5.f, 5.f, 2.f), world(25.f, 17.f, 2.f)), "Tower is visible through a wall.");
+  Ensure(locator.IsVisible(world(5.f, 5.f, 2.f), world(500.f, 500.f, 2.f)), "Outside is not visible from the hall.");
+  Ensure(locator.IsVisible(world(25.f, 5.f, 2.f), world(500.f, 500.f, 2.f)), "Outside is not visible from the tower.");
+
+  // batched queries match single ones
+  std::vector<C3Vector> positions;
+
+  for (int i = 0; i < 5000; ++i)
+    positions.push_back(world(static_cast<float>(i % 40) * 0.8f, static_cast<float>(i / 40 % 25) * 0.8f
+                              , 1.f + static_cast<float>(i % 3) * 2.5f));
+
+  std::vector<MapObjectLocation> const locations = locator.Locate(positions, 4);
+
+  for (std::size_t i = 0; i < positions.size(); ++i)
+  {
+    MapObjectLocation const location = locator.Locate(positions[i]);
+    Ensure(locations[i].inside == location.inside && locations[i].group == location.group
+           , "Batched location differs.");
+  }
+
+  return 0;
+}
@@ -0,0 +1,120 @@
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <IO/Common.hpp>
+#include <IO/ADT/ChunkIdentifiers.hpp>
+#include <IO/ADT/Obj/ModelPlacementSorter.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER) & !defined(__INTEL_COMPILER)
+  #pragma warning(push)
+  #pragma warning(disable : 4267)
+  #pragma warning(disable : 4996)
+
+  #include <backward.hpp>
+
+  #pragma warning(pop)
+#else
+  #include <backward.hpp>
+#endif
+
+using namespace IO;
+using namespace IO::ADT;
+using namespace IO::Common;
+
+namespace
+{
+  /**
+   * The parts of an obj0 ADT SortTile() works on, in the chunk types ADTObj stores them in.
+   */
+  struct ADTObj0
+  {
+    struct Chunk
+    {
+      DataArrayChunk<std::uint32_t, ADT::ChunkIdentifiers::ADTObj0MCNKSubchunks::MCRD> model_references;
+
+      auto& ModelReferences() { return model_references; }
+    };
+
+    DataArrayChunk<ADT::DataStructures::MDDF, ADT::ChunkIdentifiers::ADTObj0Chunks::MDDF> model_placements;
+    std::array<Chunk, WorldConstants::CHUNKS_PER_TILE> chunks;
+
+    auto& ModelPlacements() { return model_placements; }
+    auto& Chunks() { return chunks; }
+  };
+
+  // bounding radius of each model at scale 1.0, by MDDF name_id
+  constexpr std::array<float, 3> MODEL_RADII {2.f, 50.f, 10.f};
+
+  /**
+   * Equal radii keep their order.
+   */
+  void TestSortOrder()
+  {
+    std::vector<std::uint32_t> const order = ModelPlacementSorter::SortOrder({1.f, 3.f, 1.f, 3.f, 0.5f});
+    std::vector<std::uint32_t> const expected {1, 3, 0, 2, 4};
+
+    Ensure(order == expected, "Placements are not sorted by radius, largest first.");
+
+    std::vector<std::uint32_t> const inverse = ModelPlacementSorter::InvertOrder(order);
+    std::vector<std::uint32_t> const expected_inverse {2, 0, 3, 1, 4};
+
+    Ensure(inverse == expected_inverse, "Order was not inverted.");
+  }
+
+  /**
+   * Placements are ordered by scaled radius and chunk references follow them.
+   */
+  void TestSortTile()
+  {
+    ADTObj0 adt;
+
+    // scaled radii 2, 50, 10, 25, 8
+    std::vector<ADT::DataStructures::MDDF> placements (5);
+    std::array<std::uint32_t, 5> const name_ids {0, 1, 2, 1, 0};
+    std::array<std::uint16_t, 5> const scales {1024, 1024, 1024, 512, 4096};
+
+    for (std::size_t i = 0; i < placements.size(); ++i)
+    {
+      placements[i].name_id = name_ids[i];
+      placements[i].unique_id = static_cast<std::uint32_t>(i + 1);
+      placements[i].scale = scales[i];
+    }
+
+    adt.ModelPlacements().Initialize(placements);
+    adt.Chunks()[0].ModelReferences().Initialize(std::vector<std::uint32_t>{0, 2, 3});
+    adt.Chunks()[1].ModelReferences().Initialize(std::vector<std::uint32_t>{1, 4});
+
+    auto const radius = [](ADT::DataStructures::MDDF const& placement) { return MODEL_RADII[placement.name_id]; };
+
+    Ensure(ModelPlacementSorter::SortTile(adt, radius), "Unsorted tile was reported as sorted.");
+
+    std::array<std::uint32_t, 5> const unique_ids {2, 4, 3, 5, 1};
+
+    for (std::size_t i = 0; i < unique_ids.size(); ++i)
+      Ensure(adt.ModelPlacements()[i].unique_id == unique_ids[i], "Placements are not sorted by scaled radius.");
+
+    std::vector<std::uint32_t> const chunk_0 (adt.Chunks()[0].ModelReferences().begin()
+                                              , adt.Chunks()[0].ModelReferences().end());
+    std::vector<std::uint32_t> const chunk_1 (adt.Chunks()[1].ModelReferences().begin()
+                                              , adt.Chunks()[1].ModelReferences().end());
+    std::vector<std::uint32_t> const expected_0 {1, 2, 4};
+    std::vector<std::uint32_t> const expected_1 {0, 3};
+
+    Ensure(chunk_0 == expected_0 && chunk_1 == expected_1, "Chunk references were not remapped.");
+    Ensure(!ModelPlacementSorter::SortTile(adt, radius), "Sorted tile was reordered.");
+  }
+}
+
+int main()
+{
+  backward::SignalHandling sh;
+  Validation::Log::InitLoggers();
+
+  TestSortOrder();
+  TestSortTile();
+
+  return 0;
+}
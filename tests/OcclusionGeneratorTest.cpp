@@ -0,0 +1,136 @@
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <IO/WDT/OcclusionGenerator.hpp>
+#include "SIMDTestHelpers.hpp"
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+#if defined(_MSC_VER) & !defined(__INTEL_COMPILER)
+  #pragma warning(push)
+  #pragma warning(disable : 4267)
+  #pragma warning(disable : 4996)
+
+  #include <backward.hpp>
+
+  #pragma warning(pop)
+#else
+  #include <backward.hpp>
+#endif
+
+using namespace IO;
+using namespace IO::WDT;
+using namespace IO::Common;
+using namespace IO::Common::DataStructures;
+
+namespace
+{
+  constexpr TileIndex TILE {30, 31};
+  constexpr std::size_t N_RANDOM_TILES = 16;
+
+  constexpr std::array<float, 6> EDGE_HEIGHTS {std::numeric_limits<float>::quiet_NaN()
+                                               , 0.f, -0.f
+                                               , std::numeric_limits<float>::infinity()
+                                               , -std::numeric_limits<float>::infinity()
+                                               , 40000.f};
+
+  std::mt19937 rng {20241019};
+
+  std::unique_ptr<ADT::TileTerrain> RandomTerrain()
+  {
+    auto terrain = std::make_unique<ADT::TileTerrain>();
+    std::uniform_int_distribution<unsigned> edge {0, 15};
+
+    for (ADT::ChunkTerrain& chunk : *terrain)
+    {
+      chunk.header = {};
+      chunk.header.position.z = std::uniform_real_distribution<float>{-500.f, 500.f}(rng);
+
+      // mostly low resolution holes, sometimes whole quarters of high resolution ones
+      if (edge(rng) < 4)
+      {
+        chunk.header.flags.high_res_holes = 1;
+        chunk.header.holes_high_res = std::uniform_int_distribution<std::uint64_t>{}(rng) | 0x0F0F0F0Full;
+      }
+      else
+      {
+        chunk.header.holes_low_res = static_cast<std::uint16_t>(std::uniform_int_distribution<unsigned>{0, 0xFFFF}(rng));
+      }
+
+      for (float& height : chunk.heightmap)
+      {
+        unsigned const pick = edge(rng);
+        height = pick < EDGE_HEIGHTS.size() ? EDGE_HEIGHTS[pick]
+                                            : std::uniform_real_distribution<float>{-100.f, 100.f}(rng);
+      }
+    }
+
+    return terrain;
+  }
+
+  WDT::DataStructures::MapAreaOcclusionHeightmap Build(ADT::TileTerrain const& terrain, std::vector<CAaBox> const& bounds)
+  {
+    WDT::DataStructures::MapAreaOcclusionHeightmap heightmap {};
+    OcclusionGenerator::BuildTileHeightmap(TILE, terrain, bounds, heightmap);
+    return heightmap;
+  }
+
+  /**
+   * Flat tile at height 10 with a peak of 100 in the last outer vertex of chunk (2, 3).
+   */
+  void TestKnownHeights()
+  {
+    auto terrain = std::make_unique<ADT::TileTerrain>();
+
+    for (ADT::ChunkTerrain& chunk : *terrain)
+    {
+      chunk.header = {};
+      chunk.header.position.z = 10.f;
+      chunk.heightmap.fill(0.f);
+    }
+
+    (*terrain)[3 * 16 + 2].heightmap[WorldConstants::CHUNK_BUF_SIZE - 1 - 8] = 90.f;
+
+    float const tile_x = TILE.x * WorldConstants::TILE_SIZE;
+    float const tile_z = TILE.y * WorldConstants::TILE_SIZE;
+
+    // covers chunk (10, 10) with a margin, but no whole area of a corner sample
+    std::vector<CAaBox> const bounds {{{tile_x + 10.f * WorldConstants::CHUNK_SIZE - 1.f, 0.f
+                                        , tile_z + 10.f * WorldConstants::CHUNK_SIZE - 1.f}
+                                       , {tile_x + 11.f * WorldConstants::CHUNK_SIZE + 1.f, 250.5f
+                                          , tile_z + 11.f * WorldConstants::CHUNK_SIZE + 1.f}}};
+
+    WDT::DataStructures::MapAreaOcclusionHeightmap const heightmap = Build(*terrain, bounds);
+    auto const& samples = heightmap.interleaved_heightmap;
+
+    // the peak is the bottom-left corner of the chunk: corner (2, 4), touching quarters of chunks (1..2, 3..4)
+    Ensure(samples[4 * 17 + 2] == 100 && samples[4 * 17 + 3] == 10 && samples[3 * 17 + 2] == 10
+           , "Corner samples differ.");
+    Ensure(samples[17 * 17 + 3 * 16 + 2] == 100 && samples[17 * 17 + 3 * 16 + 3] == 10, "Center samples differ.");
+    Ensure(samples[17 * 17 + 10 * 16 + 10] == 251 && samples[17 * 17 + 10 * 16 + 11] == 10
+           , "Map object did not raise the covered sample only.");
+  }
+}
+
+int main()
+{
+  backward::SignalHandling sh;
+  Validation::Log::InitLoggers();
+
+  SIMDTestHelpers::ForEachPath(&TestKnownHeights);
+
+  // quarter maxima of heights with NaN, infinities and zeros of both signs
+  for (std::size_t i = 0; i < N_RANDOM_TILES; ++i)
+  {
+    std::unique_ptr<ADT::TileTerrain> const terrain = RandomTerrain();
+
+    SIMDTestHelpers::EnsureSamePaths([&] { return Build(*terrain, {}).interleaved_heightmap; }
+                                     , "Vectorized heightmap differs from the scalar one.");
+  }
+
+  return 0;
+}
@@ -0,0 +1,198 @@
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <IO/WorldConstants.hpp>
+#include <IO/ADT/Obj/PlacementStore.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(_MSC_VER) & !defined(__INTEL_COMPILER)
+  #pragma warning(push)
+  #pragma warning(disable : 4267)
+  #pragma warning(disable : 4996)
+
+  #include <backward.hpp>
+
+  #pragma warning(pop)
+#else
+  #include <backward.hpp>
+#endif
+
+using namespace IO;
+using namespace IO::ADT;
+using namespace IO::Common::DataStructures;
+
+namespace
+{
+  constexpr TileIndex TILE_A {10, 10};
+  constexpr TileIndex TILE_B {11, 10};
+  constexpr std::uint32_t MODEL_FDID = 123456;
+
+  C3Vector TileCenter(TileIndex tile)
+  {
+    return {(tile.x + 0.5f) * Common::WorldConstants::TILE_SIZE, 50.f, (tile.y + 0.5f) * Common::WorldConstants::TILE_SIZE};
+  }
+
+  ADT::DataStructures::MDDF Model(std::uint32_t name_id, std::uint32_t unique_id, C3Vector const& position, bool by_fdid)
+  {
+    ADT::DataStructures::MDDF placement {};
+    placement.name_id = name_id;
+    placement.unique_id = unique_id;
+    placement.position = position;
+    placement.rotation = {0.f, 30.f, 0.f};
+    placement.scale = 1024;
+    placement.flags.use_filedata_id = by_fdid;
+    return placement;
+  }
+
+  ADT::DataStructures::MODF MapObject(std::uint32_t name_id, std::uint32_t unique_id, C3Vector const& position)
+  {
+    ADT::DataStructures::MODF placement {};
+    placement.name_id = name_id;
+    placement.unique_id = unique_id;
+    placement.position = position;
+    placement.extents = {{position.x - 1.f, position.y - 1.f, position.z - 1.f}
+                         , {position.x + 1.f, position.y + 1.f, position.z + 1.f}};
+    placement.doodadSet = 2;
+    placement.nameSet = 1;
+    placement.scale = 1024;
+    return placement;
+  }
+
+  template<typename T>
+  bool SameBytes(std::vector<T> const& lhs, std::vector<T> const& rhs)
+  {
+    return lhs.size() == rhs.size() && (lhs.empty() || !std::memcmp(lhs.data(), rhs.data(), lhs.size() * sizeof(T)));
+  }
+}
+
+int main()
+{
+  backward::SignalHandling sh;
+  Validation::Log::InitLoggers();
+
+  std::vector<AssetReference> requested;
+
+  PlacementStore store {[&](bool, AssetReference const& asset)
+  {
+    requested.push_back(asset);
+    return CAaBox {{-2.f, -2.f, 0.f}, {2.f, 2.f, 4.f}};
+  }};
+
+  C3Vector const center_a = TileCenter(TILE_A);
+  C3Vector const center_b = TileCenter(TILE_B);
+
+  TilePlacements tile_a;
+  tile_a.models = {{"world/a.m2", 0}, {"world/b.m2", 0}};
+  tile_a.map_objects = {{"world/x.wmo", 0}};
+  tile_a.model_placements = {Model(0, 1, center_a, false)
+                             , Model(1, 2, {center_a.x + 10.f, center_a.y, center_a.z}, false)
+                             , Model(MODEL_FDID, 3, {center_a.x, center_a.y, center_a.z + 10.f}, true)};
+  tile_a.map_object_placements = {MapObject(0, 4, {center_a.x - 10.f, center_a.y, center_a.z})};
+
+  TilePlacements tile_b;
+  tile_b.models = {{"world/c.m2", 0}};
+  tile_b.model_placements = {Model(0, 5, center_b, false)};
+
+  store.AddTile(TILE_A, tile_a);
+  store.AddTile(TILE_B, tile_b);
+
+  Ensure(store.Models().Size() == 4 && store.MapObjects().Size() == 1, "Unexpected number of rows.");
+  Ensure(requested.size() == 5, "Bounds were not requested for every placement.");
+  Ensure(requested[2] == AssetReference({}, MODEL_FDID), "Bounds provider did not get the FileDataID.");
+  Ensure(requested[3] == AssetReference("world/x.wmo", 0), "Bounds provider did not get the map object file.");
+
+  // untouched placements come back as they were read
+  {
+    TilePlacements extracted;
+    extracted.models = tile_a.models;
+    extracted.map_objects = tile_a.map_objects;
+    store.ExtractTile(TILE_A, extracted);
+
+    Ensure(SameBytes(extracted.model_placements, tile_a.model_placements), "Untouched models changed.");
+    Ensure(SameBytes(extracted.map_object_placements, tile_a.map_object_placements), "Untouched map objects changed.");
+    Ensure(extracted.models == tile_a.models && extracted.map_objects == tile_a.map_objects, "Tables changed.");
+  }
+
+  // move b.m2, the FileDataID model and the map object into tile B, rows listed twice move once
+  PlacementSelection selection;
+  selection.models = {2, 1, 2, 1};
+  selection.map_objects = {0};
+
+  std::vector<TileIndex> const changed = store.Translate(selection, {Common::WorldConstants::TILE_SIZE, 0.f, 0.f});
+
+  Ensure(changed.size() == 2, "Unexpected number of changed tiles.");
+  Ensure(changed[0].x == TILE_A.x && changed[0].y == TILE_A.y, "Previous owner is not reported.");
+  Ensure(changed[1].x == TILE_B.x && changed[1].y == TILE_B.y, "New owner is not reported.");
+
+  {
+    TilePlacements extracted;
+    extracted.models = tile_a.models;
+    extracted.map_objects = tile_a.map_objects;
+    store.ExtractTile(TILE_A, extracted);
+
+    Ensure(extracted.model_placements.size() == 1 && extracted.map_object_placements.empty()
+           , "Moved placements are still owned by their previous tile.");
+    Ensure(extracted.ModelAsset(extracted.model_placements[0]) == tile_a.models[0], "Remaining model lost its file.");
+  }
+
+  {
+    TilePlacements extracted;
+    extracted.models = tile_b.models;
+    extracted.map_objects = tile_b.map_objects;
+    store.ExtractTile(TILE_B, extracted);
+
+    Ensure(extracted.model_placements.size() == 3 && extracted.map_object_placements.size() == 1
+           , "Moved placements are not owned by their new tile.");
+
+    // files known by path are appended to the tables of the new tile, existing entries keep their index
+    Ensure(extracted.models.size() == 2 && extracted.models[0] == tile_b.models[0]
+           && extracted.models[1] == tile_a.models[1], "Model table was not remapped.");
+    Ensure(extracted.map_objects.size() == 1 && extracted.map_objects[0] == tile_a.map_objects[0]
+           , "Map object table was not remapped.");
+
+    // rows keep load order, so placements moved from tile A come first
+    auto const& models = extracted.model_placements;
+    Ensure(models[0].unique_id == 2 && !models[0].flags.use_filedata_id
+           && extracted.ModelAsset(models[0]) == tile_a.models[1], "Moved model references the wrong file.");
+    Ensure(models[1].unique_id == 3 && models[1].flags.use_filedata_id && models[1].name_id == MODEL_FDID
+           , "Moved FileDataID model was remapped.");
+    Ensure(models[2].unique_id == 5 && models[2].name_id == 0, "Resident model changed.");
+    Ensure(models[0].position.x == center_a.x + 10.f + Common::WorldConstants::TILE_SIZE, "Model was not moved.");
+    Ensure(models[1].position.x == center_a.x + Common::WorldConstants::TILE_SIZE
+           && models[1].position.z == center_a.z + 10.f, "Model listed twice was not moved once.");
+
+    auto const& map_object = extracted.map_object_placements[0];
+    Ensure(map_object.unique_id == 4 && extracted.MapObjectAsset(map_object) == tile_a.map_objects[0]
+           , "Moved map object references the wrong file.");
+    Ensure(map_object.doodadSet == 2 && map_object.nameSet == 1, "Map object sets changed.");
+    Ensure(map_object.extents.min.x < map_object.position.x && map_object.position.x < map_object.extents.max.x
+           , "Map object extents were not recomputed.");
+  }
+
+  // a.m2 sits 10 units along x from the pivot, a quarter turn brings it 10 units along -z, scaling doubles that
+  {
+    PlacementSelection const a_twice {{0, 0}, {}};
+    C3Vector const pivot {center_a.x - 10.f, 0.f, center_a.z};
+    PlacementColumns const& models = store.Models();
+
+    store.Rotate(a_twice, pivot, 90.f);
+    Ensure(std::abs(models.position_x[0] - pivot.x) < 0.01f && std::abs(models.position_z[0] - (pivot.z - 10.f)) < 0.01f
+           && models.position_y[0] == center_a.y, "Model was not rotated around the pivot.");
+    Ensure(models.rotation_y[0] == 120.f, "Yaw was not rotated once.");
+
+    store.Scale(a_twice, pivot, 2.f);
+    Ensure(std::abs(models.position_z[0] - (pivot.z - 20.f)) < 0.01f && models.position_y[0] == center_a.y * 2.f
+           , "Model was not scaled relatively to the pivot.");
+    Ensure(models.scale[0] == 2048, "Scale was not applied once.");
+    Ensure(models.tile_x[0] == TILE_A.x && models.tile_y[0] == TILE_A.y, "Model changed its owner.");
+  }
+
+  store.RemoveTile(TILE_B);
+  Ensure(store.Models().Size() == 1 && store.MapObjects().Size() == 0, "Tile was not removed.");
+  Ensure(store.Models().asset[0] == tile_a.models[0], "Remaining row lost its file.");
+
+  return 0;
+}
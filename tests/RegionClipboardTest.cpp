@@ -0,0 +1,221 @@
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <IO/ADT/RegionClipboard.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <utility>
+
+#if defined(_MSC_VER) & !defined(__INTEL_COMPILER)
+  #pragma warning(push)
+  #pragma warning(disable : 4267)
+  #pragma warning(disable : 4996)
+
+  #include <backward.hpp>
+
+  #pragma warning(pop)
+#else
+  #include <backward.hpp>
+#endif
+
+using namespace IO;
+using namespace IO::ADT;
+using namespace IO::Common;
+using namespace IO::Common::DataStructures;
+
+namespace
+{
+  constexpr std::uint32_t N_QUADS_TILE_ROW = 128;
+  constexpr float QUAD_SIZE = WorldConstants::CHUNK_SIZE / 8;
+
+  constexpr TileIndex SOURCE_TILE {30, 30};
+  constexpr TileIndex DESTINATION_TILE {31, 30};
+
+  constexpr std::uint32_t FIRST_UNIQUE_ID = 1000000;
+  constexpr std::uint32_t PLACEMENTS_PER_TILE = 4;
+  constexpr std::size_t N_MODELS = 3;
+
+  // the region crosses chunk borders, is pasted off the chunk grid and at an odd height
+  constexpr QuadRegion REGION {SOURCE_TILE.x * N_QUADS_TILE_ROW + 13, SOURCE_TILE.y * N_QUADS_TILE_ROW + 5, 21, 18};
+  constexpr float HEIGHT_OFFSET = 3.7f;
+
+  using Key = std::pair<unsigned, unsigned>;
+  using Map = std::map<Key, std::unique_ptr<RegionTile>>;
+
+  std::mt19937 rng {20241019};
+
+  Key KeyOf(TileIndex tile)
+  {
+    return {tile.x, tile.y};
+  }
+
+  /**
+   * Two tiles of random terrain. The source tile has models inside the region, the destination tile already
+   * uses the first unique ID of its range.
+   */
+  Map RandomMap()
+  {
+    Map map;
+    std::uniform_real_distribution<float> height {-40.f, 40.f};
+
+    for (TileIndex tile_index : {SOURCE_TILE, DESTINATION_TILE})
+    {
+      auto tile = std::make_unique<RegionTile>();
+
+      for (unsigned i = 0; i < WorldConstants::CHUNKS_PER_TILE; ++i)
+      {
+        tile->terrain[i].header = {};
+        tile->terrain[i].header.position.z = height(rng) * 10.f;
+        tile->terrain[i].normals.fill({{0, 0, 127}});
+        tile->texturing.chunks[i].layers = {{0, {}, 0, 0}};
+
+        for (float& vertex : tile->terrain[i].heightmap)
+          vertex = height(rng);
+      }
+
+      tile->texturing.textures = {{"tileset/grass.blp", 0}};
+      tile->placements.models = {{"world/tree.m2", 0}};
+      map[KeyOf(tile_index)] = std::move(tile);
+    }
+
+    for (std::size_t i = 0; i < N_MODELS; ++i)
+    {
+      ADT::DataStructures::MDDF placement {};
+      placement.unique_id = static_cast<std::uint32_t>(i + 1);
+      placement.position = {(REGION.x + 2 + i * 5) * QUAD_SIZE, 10.f, (REGION.y + 3 + i * 4) * QUAD_SIZE};
+      placement.scale = 1024;
+      map[KeyOf(SOURCE_TILE)]->placements.model_placements.push_back(placement);
+    }
+
+    ADT::DataStructures::MDDF taken {};
+    taken.unique_id = FIRST_UNIQUE_ID + (DESTINATION_TILE.y * 64 + DESTINATION_TILE.x) * PLACEMENTS_PER_TILE;
+    taken.position = {(DESTINATION_TILE.x * N_QUADS_TILE_ROW + 100) * QUAD_SIZE, 0.f
+                      , (DESTINATION_TILE.y * N_QUADS_TILE_ROW + 100) * QUAD_SIZE};
+    map[KeyOf(DESTINATION_TILE)]->placements.model_placements.push_back(taken);
+
+    return map;
+  }
+
+  RegionClipboard::TileLoader Loader(Map const& map)
+  {
+    return [&map](TileIndex tile_index, RegionTile& tile)
+    {
+      auto it = map.find(KeyOf(tile_index));
+
+      if (it == map.end())
+        return false;
+
+      tile = *it->second;
+      return true;
+    };
+  }
+
+  /**
+   * Copies the region and pastes it into the destination tile, storing the modified tiles in the map.
+   */
+  void CopyPaste(Map& map)
+  {
+    RegionClipboard const clipboard = RegionClipboard::Copy(REGION, Loader(map), 2);
+
+    PasteParams params;
+    params.x = DESTINATION_TILE.x * N_QUADS_TILE_ROW + 40;
+    params.y = DESTINATION_TILE.y * N_QUADS_TILE_ROW + 70;
+    params.height_offset = HEIGHT_OFFSET;
+    params.first_unique_id = FIRST_UNIQUE_ID;
+    params.max_placements_per_tile = PLACEMENTS_PER_TILE;
+
+    std::mutex mutex;
+    std::size_t const n_tiles = clipboard.Paste(params, Loader(map), [&](TileIndex tile_index, RegionTile const& tile)
+    {
+      std::lock_guard lock(mutex);
+      *map[KeyOf(tile_index)] = tile;
+    }, 2);
+
+    Ensure(n_tiles == 1, "Region was not pasted into its destination tile only.");
+  }
+
+  /**
+   * Absolute terrain height of a map-wide quad grid vertex.
+   */
+  float HeightAt(Map const& map, TileIndex tile_index, std::uint32_t x, std::uint32_t y)
+  {
+    ChunkTerrain const& chunk = map.at(KeyOf(tile_index))->terrain[(y % N_QUADS_TILE_ROW / 8) * 16
+                                                                   + x % N_QUADS_TILE_ROW / 8];
+    return chunk.header.position.z + chunk.heightmap[(y % 8) * 17 + x % 8];
+  }
+
+  /**
+   * Pasted heights are the copied ones raised by the height offset, the rest of the destination is untouched.
+   */
+  void TestHeights()
+  {
+    Map map = RandomMap();
+    RegionTile const original = *map[KeyOf(DESTINATION_TILE)];
+    CopyPaste(map);
+
+    std::uint32_t const x = DESTINATION_TILE.x * N_QUADS_TILE_ROW + 40;
+    std::uint32_t const y = DESTINATION_TILE.y * N_QUADS_TILE_ROW + 70;
+
+    for (std::uint32_t row = 0; row <= REGION.height; ++row)
+    {
+      for (std::uint32_t column = 0; column <= REGION.width; ++column)
+      {
+        float const expected = HeightAt(map, SOURCE_TILE, REGION.x + column, REGION.y + row) + HEIGHT_OFFSET;
+        Ensure(std::abs(HeightAt(map, DESTINATION_TILE, x + column, y + row) - expected) < 0.001f
+               , "Pasted height differs from the copied one.");
+      }
+    }
+
+    Ensure(map[KeyOf(DESTINATION_TILE)]->terrain[0].heightmap == original.terrain[0].heightmap
+           , "Terrain outside of the pasted region changed.");
+  }
+
+  /**
+   * Pasting twice assigns unique IDs from the range of the destination tile, skipping the taken ones, and drops
+   * placements once the range is exhausted.
+   */
+  void TestUniqueIDs()
+  {
+    Map map = RandomMap();
+    CopyPaste(map);
+
+    std::uint32_t const first_id = FIRST_UNIQUE_ID
+      + (DESTINATION_TILE.y * 64 + DESTINATION_TILE.x) * PLACEMENTS_PER_TILE;
+    auto const& pasted = map[KeyOf(DESTINATION_TILE)]->placements.model_placements;
+
+    Ensure(pasted.size() == N_MODELS + 1, "Models were not pasted.");
+
+    for (std::size_t i = 1; i < pasted.size(); ++i)
+      Ensure(pasted[i].unique_id == first_id + i, "Pasted model did not get the next free unique ID.");
+
+    // the range of four IDs has none left for the second paste
+    CopyPaste(map);
+    Ensure(pasted.size() == N_MODELS + 1, "Models beyond the range of unique IDs were not dropped.");
+
+    map[KeyOf(DESTINATION_TILE)]->placements.model_placements.resize(2);
+    CopyPaste(map);
+
+    std::set<std::uint32_t> unique_ids;
+
+    for (auto const& placement : pasted)
+      unique_ids.insert(placement.unique_id);
+
+    Ensure(pasted.size() == N_MODELS + 1 && unique_ids.size() == pasted.size(), "Pasted unique IDs collide.");
+  }
+}
+
+int main()
+{
+  backward::SignalHandling sh;
+  Validation::Log::InitLoggers();
+
+  TestHeights();
+  TestUniqueIDs();
+
+  return 0;
+}
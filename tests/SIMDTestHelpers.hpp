@@ -0,0 +1,47 @@
+#pragma once
+#include <Utils/Misc/SIMD.hpp>
+#include <Validation/Contracts.hpp>
+
+/**
+ * Helpers for testing kernels that have an SSE2/NEON path next to their scalar one.
+ */
+namespace SIMDTestHelpers
+{
+  /**
+   * Invokes callback with the scalar path selected, then with the vectorized one. Restores the selection after.
+   * Without UTILS_SIMD both invocations run the scalar path.
+   */
+  template<typename Callback>
+  void ForEachPath(Callback&& callback)
+  {
+    bool const enabled = Utils::Misc::SIMD::IsEnabled();
+
+    for (bool const simd : {false, true})
+    {
+      Utils::Misc::SIMD::SetEnabled(simd);
+      callback();
+    }
+
+    Utils::Misc::SIMD::SetEnabled(enabled);
+  }
+
+  /**
+   * Ensures run() returns equal results with the scalar and the vectorized path.
+   * @tparam Run Callable matching signature T(), T must be equality comparable.
+   * @param message Message of the failed contract, naming what differs.
+   */
+  template<typename Run>
+  void EnsureSamePaths(Run&& run, char const* message)
+  {
+    bool const enabled = Utils::Misc::SIMD::IsEnabled();
+
+    Utils::Misc::SIMD::SetEnabled(false);
+    auto const expected = run();
+
+    Utils::Misc::SIMD::SetEnabled(true);
+    auto const actual = run();
+
+    Utils::Misc::SIMD::SetEnabled(enabled);
+    Ensure(actual == expected, message);
+  }
+}
@@ -0,0 +1,278 @@
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <IO/WorldConstants.hpp>
+#include <IO/ADT/SeamStitcher.hpp>
+#include "SIMDTestHelpers.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER) & !defined(__INTEL_COMPILER)
+  #pragma warning(push)
+  #pragma warning(disable : 4267)
+  #pragma warning(disable : 4996)
+
+  #include <backward.hpp>
+
+  #pragma warning(pop)
+#else
+  #include <backward.hpp>
+#endif
+
+using namespace IO;
+using namespace IO::ADT;
+using namespace IO::Common;
+using namespace IO::Common::DataStructures;
+
+namespace
+{
+  // A and B share a vertical tile border, A and C a horizontal one, all three share a corner
+  constexpr TileIndex TILE_A {10, 10};
+  constexpr TileIndex TILE_B {11, 10};
+  constexpr TileIndex TILE_C {10, 11};
+
+  constexpr unsigned N_CHUNKS = 16;
+  constexpr unsigned ROW_STRIDE = WorldConstants::N_VERTS_CHUNK_ROW_OUTER + WorldConstants::N_VERTS_CHUNK_ROW_INNER;
+  constexpr unsigned ALPHA_DIM = WorldConstants::ALPHAMAP_DIM;
+
+  // vertices along one tile border, including both corners
+  constexpr std::size_t N_BORDER_VERTICES = N_CHUNKS * 8 + 1;
+
+  constexpr float HEIGHT_B = 2.f;
+  constexpr std::uint8_t ALPHA_B = 200;
+
+  struct Tile
+  {
+    TileTerrain terrain;
+    TileTexturing texturing;
+  };
+
+  using Tiles = std::map<std::pair<unsigned, unsigned>, std::unique_ptr<Tile>>;
+
+  bool Is(TileIndex lhs, TileIndex rhs)
+  {
+    return lhs.x == rhs.x && lhs.y == rhs.y;
+  }
+
+  std::bitset<WorldConstants::MAX_TILES_PER_MAP> MapTiles()
+  {
+    std::bitset<WorldConstants::MAX_TILES_PER_MAP> tiles;
+
+    for (TileIndex tile : {TILE_A, TILE_B, TILE_C})
+      tiles.set(tile.y * 64 + tile.x);
+
+    return tiles;
+  }
+
+  /**
+   * Flat tiles, B is raised and C has red vertex colors. Every chunk blends two textures,
+   * B is mostly the second one. With random_alpha, alpha of B is noise instead.
+   */
+  SeamStitcher::TileLoader Loader(bool random_alpha)
+  {
+    return [random_alpha](TileIndex tile, TileTerrain& terrain, TileTexturing& texturing)
+    {
+      std::mt19937 rng {static_cast<unsigned>(tile.y * 64 + tile.x)};
+      texturing.textures = {{"tileset/grass.blp", 0}, {"tileset/dirt.blp", 0}};
+
+      for (unsigned chunk = 0; chunk < WorldConstants::CHUNKS_PER_TILE; ++chunk)
+      {
+        ChunkTerrain& chunk_terrain = terrain[chunk];
+        chunk_terrain.header = {};
+        chunk_terrain.header.position.z = Is(tile, TILE_B) ? HEIGHT_B : 0.f;
+        chunk_terrain.heightmap.fill(0.f);
+        chunk_terrain.normals.fill(SeamStitcher::EncodeNormal({0.f, 1.f, 0.f}));
+        chunk_terrain.vertex_colors.fill({0x7F, 0x7F, static_cast<std::uint8_t>(Is(tile, TILE_C) ? 0xFF : 0x7F), 0x7F});
+
+        ChunkTexturing& chunk_texturing = texturing.chunks[chunk];
+        chunk_texturing.layers = {{0, {}, 0, 0}, {1, {}, 0, 0}};
+        chunk_texturing.alphamaps.resize(1);
+
+        for (std::uint8_t& alpha : chunk_texturing.alphamaps[0])
+        {
+          alpha = !Is(tile, TILE_B) ? 10
+                                    : random_alpha ? static_cast<std::uint8_t>(std::uniform_int_distribution<unsigned>{0, 255}(rng))
+                                                   : ALPHA_B;
+        }
+      }
+
+      return true;
+    };
+  }
+
+  SeamReport Stitch(SeamSettings const& settings, Tiles& consumed, bool random_alpha = false)
+  {
+    std::mutex mutex;
+
+    return SeamStitcher::Stitch(MapTiles(), Loader(random_alpha)
+                                , [&](TileIndex tile, TileTerrain const& terrain, TileTexturing const& texturing)
+    {
+      auto copy = std::make_unique<Tile>();
+      copy->terrain = terrain;
+      copy->texturing = texturing;
+
+      std::lock_guard lock(mutex);
+      consumed[{tile.x, tile.y}] = std::move(copy);
+    }, settings);
+  }
+
+  float Height(Tile const& tile, unsigned chunk_x, unsigned chunk_y, unsigned vertex)
+  {
+    ChunkTerrain const& chunk = tile.terrain[chunk_y * N_CHUNKS + chunk_x];
+    return chunk.header.position.z + chunk.heightmap[vertex];
+  }
+
+  /**
+   * Heights of vertices of A and B along their border.
+   */
+  bool SeamHeightsAre(Tiles const& tiles, float height)
+  {
+    Tile const& a = *tiles.at({TILE_A.x, TILE_A.y});
+    Tile const& b = *tiles.at({TILE_B.x, TILE_B.y});
+
+    bool same = true;
+
+    for (unsigned chunk_y = 0; chunk_y < N_CHUNKS; ++chunk_y)
+    {
+      // the last vertex is the corner shared with C
+      for (unsigned row = 0; row < (chunk_y + 1 < N_CHUNKS ? 9u : 8u); ++row)
+      {
+        same = same && Height(a, N_CHUNKS - 1, chunk_y, row * ROW_STRIDE + 8) == height
+          && Height(b, 0, chunk_y, row * ROW_STRIDE) == height;
+      }
+    }
+
+    return same;
+  }
+
+  void TestRepair()
+  {
+    SeamSettings settings;
+    settings.recompute_normals = true;
+
+    Tiles tiles;
+    SeamReport const report = Stitch(settings, tiles);
+
+    // each shared vertex and facing pixel pair counts once, the corner of all three tiles included
+    Ensure(report.n_height_mismatches == N_BORDER_VERTICES && report.max_height_error == HEIGHT_B
+           , "Height mismatches along the border of A and B were not found.");
+    Ensure(report.n_color_mismatches == N_BORDER_VERTICES, "Color mismatches along the border of A and C were not found.");
+    // the repaired corner pixel of A then differs from the facing pixel of C
+    Ensure(report.n_alpha_mismatches == N_CHUNKS * ALPHA_DIM + 1 && !report.n_layer_mismatches
+           , "Alpha mismatches along the border of A and B were not found.");
+    Ensure(!report.n_normal_mismatches && report.n_recomputed_normals, "Normals around the seam were not recomputed.");
+
+    Ensure(report.modified_tiles.size() == 3 && tiles.size() == 3, "Modified tiles were not consumed.");
+    Ensure(SeamHeightsAre(tiles, HEIGHT_B / 2.f), "Seam heights were not averaged.");
+
+    Tile const& a = *tiles.at({TILE_A.x, TILE_A.y});
+    Tile const& b = *tiles.at({TILE_B.x, TILE_B.y});
+    Tile const& c = *tiles.at({TILE_C.x, TILE_C.y});
+
+    // heights off the seam are untouched
+    Ensure(Height(a, N_CHUNKS - 1, 0, 7) == 0.f && Height(b, 0, 0, 1) == HEIGHT_B, "Heights off the seam changed.");
+
+    // both sides of the seam get identical normals, tilted away from the raised tile
+    auto const& normal_a = a.terrain[N_CHUNKS - 1].normals[ROW_STRIDE * 4 + 8];
+    auto const& normal_b = b.terrain[0].normals[ROW_STRIDE * 4];
+    Ensure(std::equal(normal_a.normal, normal_a.normal + 3, normal_b.normal), "Normals across the seam differ.");
+    Ensure(!std::equal(normal_a.normal, normal_a.normal + 3, SeamStitcher::EncodeNormal({0.f, 1.f, 0.f}).normal)
+           , "Normal on the seam was not recomputed.");
+
+    auto const& color_a = a.terrain[(N_CHUNKS - 1) * N_CHUNKS].vertex_colors[8 * ROW_STRIDE + 3];
+    auto const& color_c = c.terrain[0].vertex_colors[3];
+    Ensure(color_a.red == 0xBF && color_c.red == 0xBF && color_a.green == 0x7F, "Seam colors were not averaged.");
+
+    std::uint8_t const alpha_a = a.texturing.chunks[N_CHUNKS - 1].alphamaps[0][5 * ALPHA_DIM + ALPHA_DIM - 1];
+    std::uint8_t const alpha_b = b.texturing.chunks[0].alphamaps[0][5 * ALPHA_DIM];
+    Ensure(alpha_a == (10 + ALPHA_B + 1) / 2 && alpha_b == alpha_a, "Facing alpha pixels were not averaged.");
+    Ensure(a.texturing.chunks[N_CHUNKS - 1].alphamaps[0][5 * ALPHA_DIM + ALPHA_DIM - 2] == 10
+           , "Alpha off the seam changed.");
+  }
+
+  void TestValidateOnly()
+  {
+    SeamSettings settings;
+    settings.policy = SeamRepairPolicy::VALIDATE_ONLY;
+
+    Tiles tiles;
+    SeamReport const report = Stitch(settings, tiles);
+
+    Ensure(report.n_height_mismatches == N_BORDER_VERTICES && report.n_color_mismatches == N_BORDER_VERTICES
+           && report.n_alpha_mismatches == N_CHUNKS * ALPHA_DIM, "Validation found different mismatches.");
+    Ensure(report.modified_tiles.empty() && tiles.empty() && !report.n_recomputed_normals
+           , "Validation modified tiles.");
+  }
+
+  void TestAuthoritative()
+  {
+    SeamSettings settings;
+    settings.policy = SeamRepairPolicy::AUTHORITATIVE;
+    settings.authoritative_tiles.set(TILE_B.y * 64 + TILE_B.x);
+
+    Tiles tiles;
+    Stitch(settings, tiles);
+
+    Ensure(SeamHeightsAre(tiles, HEIGHT_B), "Seam heights were not taken from the authoritative tile.");
+
+    std::uint8_t const alpha_a = tiles.at({TILE_A.x, TILE_A.y})->texturing.chunks[N_CHUNKS - 1].alphamaps[0][ALPHA_DIM - 1];
+    Ensure(alpha_a == ALPHA_B, "Alpha was not taken from the authoritative tile.");
+  }
+
+  /**
+   * Alpha noise is compared and repaired the same way by both paths, including tolerances flagging every pixel or
+   * none. Differences of bytes are at most 255, negative tolerances reject any alpha and 255 or more accept any.
+   */
+  void TestAlphaTolerances()
+  {
+    for (int const tolerance : {-1, 0, 1, 64, 254, 255, 1000})
+    {
+      SeamSettings settings;
+      settings.alpha_tolerance = tolerance;
+
+      SIMDTestHelpers::EnsureSamePaths([&]
+      {
+        Tiles tiles;
+        SeamReport const report = Stitch(settings, tiles, true);
+
+        Ensure(tolerance >= 0 || report.n_alpha_mismatches > 0, "Negative alpha tolerance accepted noise.");
+        Ensure(tolerance < 255 || report.n_alpha_mismatches == 0, "Alpha tolerance of a whole byte rejected noise.");
+
+        std::vector<std::vector<Alphamap>> alphamaps;
+
+        for (auto const& [index, tile] : tiles)
+        {
+          for (ChunkTexturing const& chunk : tile->texturing.chunks)
+            alphamaps.push_back(chunk.alphamaps);
+        }
+
+        return std::make_pair(report.n_alpha_mismatches, alphamaps);
+      }, "Vectorized alpha comparison differs from the scalar one.");
+    }
+  }
+}
+
+int main()
+{
+  backward::SignalHandling sh;
+  Validation::Log::InitLoggers();
+
+  SIMDTestHelpers::ForEachPath([]
+  {
+    TestRepair();
+    TestValidateOnly();
+    TestAuthoritative();
+  });
+
+  TestAlphaTolerances();
+
+  return 0;
+}
@@ -0,0 +1,144 @@
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <IO/ADT/Root/TerrainMesh.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER) & !defined(__INTEL_COMPILER)
+  #pragma warning(push)
+  #pragma warning(disable : 4267)
+  #pragma warning(disable : 4996)
+
+  #include <backward.hpp>
+
+  #pragma warning(pop)
+#else
+  #include <backward.hpp>
+#endif
+
+using namespace IO;
+using namespace IO::ADT;
+using namespace IO::Common;
+using namespace IO::Common::DataStructures;
+
+namespace
+{
+  constexpr unsigned N_QUADS_TILE_ROW = 128;
+
+  /**
+   * Rolling hills with fine ripples, a function of the map-wide quad position so that tiles match on borders.
+   */
+  float Height(float x, float y)
+  {
+    return 30.f * std::sin(x / 37.f) * std::cos(y / 23.f) + 4.f * std::sin(x / 5.3f + y / 7.1f);
+  }
+
+  void FillTerrain(TileIndex tile_index, TileTerrain& terrain, bool flat)
+  {
+    for (unsigned i = 0; i < WorldConstants::CHUNKS_PER_TILE; ++i)
+    {
+      ChunkTerrain& chunk = terrain[i];
+      chunk.header = {};
+      chunk.normals.fill({{0, 0, 127}});
+
+      float const chunk_x = static_cast<float>(tile_index.x * N_QUADS_TILE_ROW + (i % 16) * 8);
+      float const chunk_y = static_cast<float>(tile_index.y * N_QUADS_TILE_ROW + (i / 16) * 8);
+
+      for (unsigned row = 0, vertex = 0; row < 17; ++row)
+      {
+        // inner vertices sit at quad centers
+        bool const is_inner = row % 2;
+        float const offset = is_inner ? 0.5f : 0.f;
+
+        for (unsigned column = 0; column < (is_inner ? 8u : 9u); ++column, ++vertex)
+        {
+          chunk.heightmap[vertex] = flat ? 12.f : Height(chunk_x + static_cast<float>(column) + offset
+                                                         , chunk_y + static_cast<float>(row / 2) + offset);
+        }
+      }
+    }
+  }
+
+  /**
+   * A flat tile collapses into the two root triangles.
+   */
+  void TestFlatTile()
+  {
+    auto terrain = std::make_unique<TileTerrain>();
+    FillTerrain({30, 30}, *terrain, true);
+
+    TerrainMesh mesh;
+    TerrainMeshBuilder::BuildTile({30, 30}, *terrain, 0.f, mesh);
+
+    Ensure(mesh.vertices.size() == 4 && mesh.indices.size() == 6, "Flat tile was not simplified.");
+    Ensure(std::all_of(mesh.vertices.begin(), mesh.vertices.end(), [](C3Vector const& v) { return v.y == 12.f; })
+           , "Flat tile changed height.");
+  }
+
+  /**
+   * Every edge of the region mesh is shared by two triangles, except for edges on the outer border of the region.
+   * Edges used once inside the region are T-junctions, which show as cracks.
+   */
+  void TestRegionWithoutCracks()
+  {
+    std::vector<TileIndex> const tiles {{30, 30}, {31, 30}, {30, 31}, {31, 31}};
+
+    TerrainMesh const mesh = TerrainMeshBuilder::BuildRegion(tiles, [](TileIndex tile_index, TileTerrain& terrain)
+    {
+      FillTerrain(tile_index, terrain, false);
+      return true;
+    }, 0.5f, 2);
+
+    Ensure(mesh.indices.size() % 3 == 0 && mesh.normals.size() == mesh.vertices.size(), "Mesh is malformed.");
+
+    auto const [min_x, max_x] = std::minmax_element(mesh.vertices.begin(), mesh.vertices.end()
+                                                    , [](C3Vector const& a, C3Vector const& b) { return a.x < b.x; });
+    auto const [min_z, max_z] = std::minmax_element(mesh.vertices.begin(), mesh.vertices.end()
+                                                    , [](C3Vector const& a, C3Vector const& b) { return a.z < b.z; });
+
+    auto const is_outer = [&](C3Vector const& a, C3Vector const& b)
+    {
+      return (a.x == min_x->x && b.x == min_x->x) || (a.x == max_x->x && b.x == max_x->x)
+        || (a.z == min_z->z && b.z == min_z->z) || (a.z == max_z->z && b.z == max_z->z);
+    };
+
+    std::map<std::pair<std::uint32_t, std::uint32_t>, unsigned> edges;
+
+    for (std::size_t i = 0; i < mesh.indices.size(); i += 3)
+    {
+      for (std::size_t corner = 0; corner < 3; ++corner)
+      {
+        std::uint32_t const a = mesh.indices[i + corner];
+        std::uint32_t const b = mesh.indices[i + (corner + 1) % 3];
+        ++edges[std::minmax(a, b)];
+      }
+    }
+
+    for (auto const& [edge, n_triangles] : edges)
+    {
+      Ensure(n_triangles <= 2, "Edge is shared by more than two triangles.");
+      Ensure(n_triangles == 2 || is_outer(mesh.vertices[edge.first], mesh.vertices[edge.second])
+             , "Mesh has a T-junction inside the region.");
+    }
+
+    // simplification still happened
+    Ensure(mesh.vertices.size() < tiles.size() * (145 * 256) / 2, "Region was not simplified.");
+  }
+}
+
+int main()
+{
+  backward::SignalHandling sh;
+  Validation::Log::InitLoggers();
+
+  TestFlatTile();
+  TestRegionWithoutCracks();
+
+  return 0;
+}
@@ -0,0 +1,174 @@
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <IO/ADT/Root/TerrainRaycaster.hpp>
+#include "SIMDTestHelpers.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER) & !defined(__INTEL_COMPILER)
+  #pragma warning(push)
+  #pragma warning(disable : 4267)
+  #pragma warning(disable : 4996)
+
+  #include <backward.hpp>
+
+  #pragma warning(pop)
+#else
+  #include <backward.hpp>
+#endif
+
+using namespace IO;
+using namespace IO::ADT;
+using namespace IO::Common;
+using namespace IO::Common::DataStructures;
+
+namespace
+{
+  constexpr TileIndex TILE {30, 31};
+  constexpr std::size_t N_RANDOM_TILES = 4;
+  constexpr std::size_t N_RANDOM_SEGMENTS = 4000;
+
+  std::mt19937 rng {20241019};
+
+  /**
+   * Terrain with random heights, flat patches where triangles share a plane, and random holes.
+   */
+  std::unique_ptr<TileTerrain> RandomTerrain()
+  {
+    auto terrain = std::make_unique<TileTerrain>();
+    std::uniform_int_distribution<unsigned> pick {0, 15};
+
+    for (ChunkTerrain& chunk : *terrain)
+    {
+      chunk.header = {};
+      chunk.header.position.z = std::uniform_real_distribution<float>{-50.f, 50.f}(rng);
+      chunk.header.holes_low_res = pick(rng) < 4
+        ? static_cast<std::uint16_t>(std::uniform_int_distribution<unsigned>{0, 0xFFFF}(rng)) : 0;
+
+      for (float& height : chunk.heightmap)
+        height = pick(rng) < 4 ? 0.f : std::uniform_real_distribution<float>{-20.f, 20.f}(rng);
+    }
+
+    return terrain;
+  }
+
+  TerrainRaycaster MakeRaycaster(TileTerrain const& terrain)
+  {
+    return TerrainRaycaster {[&terrain](TileIndex tile_index, TileTerrain& out)
+    {
+      if (tile_index.x != TILE.x || tile_index.y != TILE.y)
+        return false;
+
+      out = terrain;
+      return true;
+    }};
+  }
+
+  /**
+   * Flat tile at height 10: vertical segments hit at 10, segments above it see each other, holes let segments through.
+   */
+  void TestFlatTerrain()
+  {
+    auto terrain = std::make_unique<TileTerrain>();
+
+    for (ChunkTerrain& chunk : *terrain)
+    {
+      chunk.header = {};
+      chunk.header.position.z = 10.f;
+      chunk.heightmap.fill(0.f);
+    }
+
+    // whole chunk (5, 5) is a hole
+    (*terrain)[5 * 16 + 5].header.holes_low_res = 0xFFFF;
+
+    TerrainRaycaster raycaster = MakeRaycaster(*terrain);
+
+    float const x = TILE.x * WorldConstants::TILE_SIZE + 2.3f * WorldConstants::CHUNK_SIZE;
+    float const z = TILE.y * WorldConstants::TILE_SIZE + 7.6f * WorldConstants::CHUNK_SIZE;
+    float const hole_x = TILE.x * WorldConstants::TILE_SIZE + 5.5f * WorldConstants::CHUNK_SIZE;
+    float const hole_z = TILE.y * WorldConstants::TILE_SIZE + 5.5f * WorldConstants::CHUNK_SIZE;
+
+    std::vector<TerrainSegment> const segments {{{x, 50.f, z}, {x, -30.f, z}}
+                                                , {{x, 20.f, z}, {x + 100.f, 20.f, z + 100.f}}
+                                                , {{hole_x, 50.f, hole_z}, {hole_x, -30.f, hole_z}}};
+
+    std::vector<TerrainHit> const hits = raycaster.Raycast(segments, 2);
+
+    Ensure(hits[0].hit && hits[0].t == 0.5f && hits[0].position.y == 10.f, "Vertical segment missed flat terrain.");
+    Ensure(!hits[1].hit, "Segment above terrain hit it.");
+    Ensure(!hits[2].hit, "Segment through a hole hit terrain.");
+
+    std::vector<bool> const visible = raycaster.LineOfSight(segments, 2);
+    Ensure(!visible[0] && visible[1] && visible[2], "Line of sight differs from raycast.");
+  }
+
+  /**
+   * Random segments over random terrain both hit and miss, the same way with either path.
+   */
+  void TestRandomSegments()
+  {
+    float const tile_x = TILE.x * WorldConstants::TILE_SIZE;
+    float const tile_z = TILE.y * WorldConstants::TILE_SIZE;
+    std::uniform_real_distribution<float> horizontal {-20.f, WorldConstants::TILE_SIZE + 20.f};
+    std::uniform_real_distribution<float> vertical {-100.f, 100.f};
+
+    for (std::size_t n = 0; n < N_RANDOM_TILES; ++n)
+    {
+      std::unique_ptr<TileTerrain> const terrain = RandomTerrain();
+      std::vector<TerrainSegment> segments(N_RANDOM_SEGMENTS);
+
+      for (std::size_t i = 0; i < segments.size(); ++i)
+      {
+        C3Vector const from {tile_x + horizontal(rng), vertical(rng), tile_z + horizontal(rng)};
+
+        // also vertical and axis-aligned segments, whose directions have zero components
+        switch (i % 4)
+        {
+          case 0:
+            segments[i] = {from, {from.x, vertical(rng), from.z}};
+            break;
+          case 1:
+            segments[i] = {from, {tile_x + horizontal(rng), from.y, from.z}};
+            break;
+          default:
+            segments[i] = {from, {tile_x + horizontal(rng), vertical(rng), tile_z + horizontal(rng)}};
+            break;
+        }
+      }
+
+      std::size_t n_hits = 0;
+
+      SIMDTestHelpers::EnsureSamePaths([&]
+      {
+        std::vector<std::pair<bool, float>> result;
+        n_hits = 0;
+
+        for (TerrainHit const& hit : MakeRaycaster(*terrain).Raycast(segments, 2))
+        {
+          result.emplace_back(hit.hit, hit.t);
+          n_hits += hit.hit;
+        }
+
+        return result;
+      }, "Vectorized raycast differs from the scalar one.");
+
+      Ensure(n_hits > 0 && n_hits < segments.size(), "Random segments do not exercise both hits and misses.");
+    }
+  }
+}
+
+int main()
+{
+  backward::SignalHandling sh;
+  Validation::Log::InitLoggers();
+
+  SIMDTestHelpers::ForEachPath(&TestFlatTerrain);
+  TestRandomSegments();
+
+  return 0;
+}
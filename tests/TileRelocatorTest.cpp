@@ -0,0 +1,164 @@
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <IO/Common.hpp>
+#include <IO/ADT/ChunkIdentifiers.hpp>
+#include <IO/ADT/TileRelocator.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#if defined(_MSC_VER) & !defined(__INTEL_COMPILER)
+  #pragma warning(push)
+  #pragma warning(disable : 4267)
+  #pragma warning(disable : 4996)
+
+  #include <backward.hpp>
+
+  #pragma warning(pop)
+#else
+  #include <backward.hpp>
+#endif
+
+using namespace IO;
+using namespace IO::ADT;
+using namespace IO::Common;
+using namespace IO::Common::DataStructures;
+
+namespace
+{
+  constexpr float TILE = WorldConstants::TILE_SIZE;
+
+  // offsets are computed in single precision from tile coordinates
+  constexpr float TOLERANCE = 0.01f;
+
+  /**
+   * The parts of an obj0 ADT RelocateObj0() works on, in the chunk types ADTObj stores them in.
+   */
+  struct ADTObj0
+  {
+    DataArrayChunk<ADT::DataStructures::MDDF, ADT::ChunkIdentifiers::ADTObj0Chunks::MDDF> model_placements;
+    DataArrayChunk<ADT::DataStructures::MODF, ADT::ChunkIdentifiers::ADTObj0Chunks::MODF> map_object_placements;
+
+    auto& ModelPlacements() { return model_placements; }
+    auto& MapObjectPlacements() { return map_object_placements; }
+  };
+
+  bool Near(C3Vector const& a, C3Vector const& b)
+  {
+    return std::abs(a.x - b.x) < TOLERANCE && std::abs(a.y - b.y) < TOLERANCE && std::abs(a.z - b.z) < TOLERANCE;
+  }
+
+  /**
+   * World position of the first chunk of a tile, as stored in MCNK: axes swapped and mirrored around the map center.
+   */
+  C3Vector ChunkWorldPosition(TileIndex tile, float height)
+  {
+    return {(32.f - static_cast<float>(tile.y)) * TILE, (32.f - static_cast<float>(tile.x)) * TILE, height};
+  }
+
+  /**
+   * Chunk positions end up where the target tile keeps its chunks, in both coordinate systems.
+   */
+  void TestChunks()
+  {
+    TileRelocator const relocator {{{30, 40}, {32, 39}, 0}};
+    C3Vector const placement_offset {2.f * TILE, 0.f, -TILE};
+
+    Ensure(Near(relocator.PlacementOffset(), placement_offset), "Wrong placement offset.");
+
+    ADT::DataStructures::SMChunk header {};
+    header.position = ChunkWorldPosition({30, 40}, 50.f);
+
+    std::array<ADT::DataStructures::MCSE, 1> emitters {};
+    emitters[0].position = ChunkWorldPosition({30, 40}, 20.f);
+
+    relocator.RelocateChunk(header, emitters);
+
+    Ensure(Near(header.position, ChunkWorldPosition({32, 39}, 50.f)), "Chunk was not moved to the target tile.");
+    Ensure(Near(emitters[0].position, ChunkWorldPosition({32, 39}, 20.f)), "Sound emitter was not moved.");
+  }
+
+  /**
+   * Placements, their extents and blend meshes move along, unique IDs and their references are offset.
+   */
+  void TestPlacements()
+  {
+    TileRelocator const relocator {{{10, 10}, {11, 12}, 1000}};
+
+    ADTObj0 adt;
+
+    ADT::DataStructures::MDDF model {};
+    model.unique_id = 5;
+    model.position = {10.f * TILE + 3.f, 7.f, 10.f * TILE + 4.f};
+    adt.model_placements.Initialize(std::vector<ADT::DataStructures::MDDF>{model});
+
+    ADT::DataStructures::MODF map_object {};
+    map_object.unique_id = 6;
+    map_object.position = {10.f * TILE + 30.f, 0.f, 10.f * TILE + 40.f};
+    map_object.extents = {{10.f * TILE, -5.f, 10.f * TILE}, {10.f * TILE + 60.f, 5.f, 10.f * TILE + 80.f}};
+    adt.map_object_placements.Initialize(std::vector<ADT::DataStructures::MODF>{map_object});
+
+    relocator.RelocateObj0(adt);
+
+    ADT::DataStructures::MDDF const& moved_model = adt.ModelPlacements()[0];
+    ADT::DataStructures::MODF const& moved_map_object = adt.MapObjectPlacements()[0];
+
+    C3Vector const model_position {11.f * TILE + 3.f, 7.f, 12.f * TILE + 4.f};
+    C3Vector const map_object_position {11.f * TILE + 30.f, 0.f, 12.f * TILE + 40.f};
+    CAaBox const map_object_extents {{11.f * TILE, -5.f, 12.f * TILE}, {11.f * TILE + 60.f, 5.f, 12.f * TILE + 80.f}};
+
+    Ensure(moved_model.unique_id == 1005 && moved_map_object.unique_id == 1006, "Unique IDs were not offset.");
+    Ensure(Near(moved_model.position, model_position) && Near(moved_map_object.position, map_object_position)
+           && Near(moved_map_object.extents.min, map_object_extents.min)
+           && Near(moved_map_object.extents.max, map_object_extents.max), "Placements were not moved.");
+
+    std::array<ADT::DataStructures::MBMH, 1> headers {};
+    std::array<ADT::DataStructures::MBBB, 1> boxes {};
+    std::array<ADT::DataStructures::MBNV, 1> vertices {};
+    headers[0].mapObjectID = 6;
+    boxes[0].mapObjectID = 6;
+    boxes[0].bounding = {ChunkWorldPosition({10, 10}, 0.f), ChunkWorldPosition({10, 10}, 10.f)};
+    vertices[0].pos = ChunkWorldPosition({10, 10}, 3.f);
+
+    relocator.RelocateBlendMeshes(headers, boxes, vertices);
+
+    Ensure(headers[0].mapObjectID == 1006 && boxes[0].mapObjectID == 1006, "Blend meshes lost their map object.");
+    Ensure(Near(boxes[0].bounding.max, ChunkWorldPosition({11, 12}, 10.f))
+           && Near(vertices[0].pos, ChunkWorldPosition({11, 12}, 3.f)), "Blend meshes were not moved.");
+  }
+
+  /**
+   * Every relocation of a batch gets its own relocator, absent source tiles are not counted.
+   */
+  void TestRelocateTiles()
+  {
+    std::vector<TileRelocation> const relocations {{{1, 1}, {2, 2}, 0}, {{3, 3}, {3, 3}, 0}, {{5, 1}, {6, 1}, 0}};
+
+    std::mutex mutex;
+    std::vector<TileRelocation> visited;
+
+    std::size_t const n_relocated = TileRelocator::RelocateTiles(relocations, [&](TileRelocator const& relocator)
+    {
+      std::lock_guard const lock {mutex};
+      visited.push_back(relocator.Relocation());
+      return relocator.Relocation().from.x != 3;
+    });
+
+    Ensure(n_relocated == 2 && visited.size() == 3, "Wrong number of tiles relocated.");
+  }
+}
+
+int main()
+{
+  backward::SignalHandling sh;
+  Validation::Log::InitLoggers();
+
+  TestChunks();
+  TestPlacements();
+  TestRelocateTiles();
+
+  return 0;
+}
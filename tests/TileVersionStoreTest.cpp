@@ -0,0 +1,168 @@
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <IO/ADT/TileVersionStore.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <utility>
+
+#if defined(_MSC_VER) & !defined(__INTEL_COMPILER)
+  #pragma warning(push)
+  #pragma warning(disable : 4267)
+  #pragma warning(disable : 4996)
+
+  #include <backward.hpp>
+
+  #pragma warning(pop)
+#else
+  #include <backward.hpp>
+#endif
+
+using namespace IO;
+using namespace IO::ADT;
+using namespace IO::Common::DataStructures;
+
+namespace
+{
+  constexpr TileIndex TILE {32, 48};
+  constexpr std::size_t EDITED_CHUNK = 17;
+  constexpr int N_COMMITS = 200;
+
+  std::unique_ptr<RegionTile> MakeTile()
+  {
+    auto tile = std::make_unique<RegionTile>();
+
+    for (std::size_t i = 0; i < Common::WorldConstants::CHUNKS_PER_TILE; ++i)
+    {
+      tile->terrain[i].header.position.z = static_cast<float>(i);
+      tile->terrain[i].heightmap.fill(1.f);
+    }
+
+    tile->texturing.textures = {{"tileset/grass.blp", 0}};
+    tile->placements.models = {{"world/tree.m2", 0}};
+    return tile;
+  }
+}
+
+int main()
+{
+  backward::SignalHandling sh;
+  Validation::Log::InitLoggers();
+
+  TileVersionStore store;
+  Ensure(!store.Acquire(TILE), "Tile is loaded before Load().");
+
+  std::unique_ptr<RegionTile> const tile = MakeTile();
+  store.Load(TILE, *tile);
+
+  TileSnapshotHandle const original = store.Acquire(TILE);
+  Ensure(original && original->Version() == 0, "Loaded tile is not version 0.");
+
+  // edits are invisible to readers until committed, and never reach older snapshots
+  {
+    TileTransaction transaction = store.Begin(TILE);
+    transaction.EditChunk(EDITED_CHUNK).terrain.heightmap[0] = 5.f;
+    transaction.EditTextures().push_back({"tileset/dirt.blp", 0});
+
+    Ensure(transaction.IsModified(), "Edited transaction is not modified.");
+    Ensure(original->Chunk(EDITED_CHUNK).terrain.heightmap[0] == 1.f, "Edit leaked into the base version.");
+    Ensure(store.Acquire(TILE) == original, "Uncommitted edit was published.");
+
+    TileSnapshotHandle const committed = store.Commit(std::move(transaction));
+    Ensure(committed && committed->Version() == 1, "Commit did not publish version 1.");
+    Ensure(store.Acquire(TILE) == committed, "Committed version is not the latest.");
+
+    Ensure(committed->Chunk(EDITED_CHUNK).terrain.heightmap[0] == 5.f, "Committed edit is missing.");
+    Ensure(committed->Textures().size() == 2, "Committed texture is missing.");
+    Ensure(original->Chunk(EDITED_CHUNK).terrain.heightmap[0] == 1.f, "Commit changed the previous version.");
+    Ensure(original->Textures().size() == 1, "Commit changed textures of the previous version.");
+
+    // only the edited chunk is copied
+    Ensure(!committed->SharesChunk(*original, EDITED_CHUNK), "Edited chunk is shared.");
+    Ensure(committed->SharesChunk(*original, EDITED_CHUNK + 1), "Unchanged chunk was copied.");
+    Ensure(&committed->Placements() == &original->Placements(), "Unchanged placements were copied.");
+  }
+
+  // the second of two writers starting from the same version conflicts
+  {
+    TileTransaction first = store.Begin(TILE);
+    TileTransaction second = store.Begin(TILE);
+    first.EditPlacements().models.push_back({"world/rock.m2", 0});
+    second.EditChunk(0).terrain.heightmap[0] = 7.f;
+
+    TileSnapshotHandle const winner = store.Commit(std::move(first));
+    Ensure(winner && winner->Version() == 2, "First commit failed.");
+    Ensure(!store.Commit(std::move(second)), "Conflicting commit succeeded.");
+    Ensure(store.Acquire(TILE)->Chunk(0).terrain.heightmap[0] == 1.f, "Conflicting commit was published.");
+
+    // unmodified transactions publish nothing
+    Ensure(store.Commit(store.Begin(TILE)) == winner, "Empty commit published a version.");
+  }
+
+  // readers always see a consistent version while a writer keeps committing
+  {
+    std::atomic<bool> done = false;
+    std::atomic<bool> consistent = true;
+
+    std::thread reader {[&]
+    {
+      while (!done)
+      {
+        TileSnapshotHandle const snapshot = store.Acquire(TILE);
+        float const value = static_cast<float>(snapshot->Version());
+
+        // every commit writes its version to both ends of the tile
+        if (snapshot->Version() > 2)
+          consistent = consistent && snapshot->Chunk(0).terrain.heightmap[1] == value
+            && snapshot->Chunk(Common::WorldConstants::CHUNKS_PER_TILE - 1).terrain.heightmap[1] == value;
+      }
+    }};
+
+    for (int i = 0; i < N_COMMITS; ++i)
+    {
+      TileTransaction transaction = store.Begin(TILE);
+      float const value = static_cast<float>(transaction.Base()->Version() + 1);
+      transaction.EditChunk(0).terrain.heightmap[1] = value;
+      transaction.EditChunk(Common::WorldConstants::CHUNKS_PER_TILE - 1).terrain.heightmap[1] = value;
+      Ensure(store.Commit(std::move(transaction)) != nullptr, "Single writer commit failed.");
+    }
+
+    done = true;
+    reader.join();
+    Ensure(consistent, "Reader saw a partially committed version.");
+  }
+
+  // moving a transaction hands its edits over, the moved-from one keeps no pointers to them
+  {
+    TileTransaction source = store.Begin(TILE);
+    source.EditChunk(EDITED_CHUNK).terrain.heightmap[2] = 9.f;
+    source.EditPlacements().models.push_back({"world/stone.m2", 0});
+
+    TileTransaction moved = std::move(source);
+    Ensure(!source.IsModified() && !source.Base(), "Moved-from transaction still holds edits.");
+    Ensure(moved.IsModified() && moved.Chunk(EDITED_CHUNK).terrain.heightmap[2] == 9.f, "Edits were not moved.");
+
+    TileTransaction assigned = store.Begin(TILE);
+    assigned = std::move(moved);
+    Ensure(!moved.IsModified() && assigned.IsModified(), "Move assignment did not hand edits over.");
+
+    TileSnapshotHandle const committed = store.Commit(std::move(assigned));
+    Ensure(committed && committed->Placements().models.size() == 3, "Moved edits were not committed.");
+  }
+
+  // snapshots outlive the tile
+  store.Unload(TILE);
+  Ensure(!store.Acquire(TILE), "Tile was not unloaded.");
+  Ensure(original->Chunk(EDITED_CHUNK).terrain.heightmap[0] == 1.f && original->Textures().size() == 1
+         , "Snapshot changed after unload.");
+
+  auto const extracted = std::make_unique<RegionTile>();
+  original->Extract(*extracted);
+  Ensure(extracted->texturing.textures == tile->texturing.textures && extracted->placements.models == tile->placements.models
+         && extracted->terrain[EDITED_CHUNK].header.position.z == static_cast<float>(EDITED_CHUNK)
+         , "Extracted version differs from the loaded tile.");
+
+  return 0;
+}
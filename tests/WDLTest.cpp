@@ -0,0 +1,84 @@
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <IO/WDL/WDL.hpp>
+
+#include <array>
+#include <cstdint>
+
+#if defined(_MSC_VER) & !defined(__INTEL_COMPILER)
+  #pragma warning(push)
+  #pragma warning(disable : 4267)
+  #pragma warning(disable : 4996)
+
+  #include <backward.hpp>
+
+  #pragma warning(pop)
+#else
+  #include <backward.hpp>
+#endif
+
+using namespace IO;
+using namespace IO::Common::DataStructures;
+
+namespace
+{
+  constexpr std::array<TileIndex, 4> TILES {TileIndex{0, 0}, TileIndex{31, 17}, TileIndex{5, 63}, TileIndex{63, 63}};
+
+  void FillTile(WDL::LowResTile& tile, std::uint32_t seed)
+  {
+    for (std::size_t i = 0; i < tile.heightmap.outer.size(); ++i)
+      tile.heightmap.outer[i] = static_cast<std::int16_t>((i * 37 + seed * 101) % 4000) - 2000;
+
+    for (std::size_t i = 0; i < tile.heightmap.inner.size(); ++i)
+      tile.heightmap.inner[i] = static_cast<std::int16_t>((i * 53 + seed * 7) % 3000) - 1500;
+
+    for (std::size_t row = 0; row < tile.holes.rows.size(); ++row)
+      tile.holes.rows[row] = static_cast<std::uint16_t>((row * 0x1111 + seed) & 0xFFFF);
+  }
+}
+
+int main()
+{
+  backward::SignalHandling sh;
+  Validation::Log::InitLoggers();
+
+  WDL::WDL wdl {};
+
+  for (std::uint32_t i = 0; i < TILES.size(); ++i)
+    FillTile(wdl.AddTile(TILES[i]), i);
+
+  Ensure(wdl.NumTiles() == TILES.size(), "Unexpected number of tiles after adding.");
+
+  Common::ByteBuffer buf {};
+  wdl.Write(buf);
+  buf.Seek(0);
+
+  WDL::WDL read_wdl {buf};
+
+  Ensure(read_wdl.NumTiles() == TILES.size(), "Tile count changed in round-trip.");
+  Ensure(!read_wdl.HasTile({1, 0}) && !read_wdl.HasTile({63, 62}), "Absent tile appeared in round-trip.");
+
+  for (std::uint32_t i = 0; i < TILES.size(); ++i)
+  {
+    WDL::LowResTile expected {};
+    FillTile(expected, i);
+
+    Ensure(read_wdl.HasTile(TILES[i]), "Tile lost in round-trip.");
+
+    WDL::LowResTile const& tile = read_wdl.Tile(TILES[i]);
+    Ensure(tile.heightmap.outer == expected.heightmap.outer, "Outer heights changed in round-trip.");
+    Ensure(tile.heightmap.inner == expected.heightmap.inner, "Inner heights changed in round-trip.");
+    Ensure(tile.holes.rows == expected.holes.rows, "Holes changed in round-trip.");
+  }
+
+  // writing again must reproduce the same file
+  Common::ByteBuffer buf_again {};
+  read_wdl.Write(buf_again);
+  Ensure(buf_again.Size() == buf.Size()
+         && std::equal(buf.Data(), buf.Data() + buf.Size(), buf_again.Data()), "Second write differs from the first.");
+
+  read_wdl.RemoveTile(TILES[0]);
+  Ensure(!read_wdl.HasTile(TILES[0]) && read_wdl.NumTiles() == TILES.size() - 1, "Tile removal failed.");
+
+  return 0;
+}
@@ -0,0 +1,161 @@
+#include <Validation/Log.hpp>
+#include <Validation/Contracts.hpp>
+#include <IO/ByteBuffer.hpp>
+#include <IO/ADT/ChunkIdentifiers.hpp>
+#include <IO/ADT/DataStructures.hpp>
+#include <IO/WDT/WDTManifest.hpp>
+
+#include <array>
+#include <cstdint>
+
+#if defined(_MSC_VER) & !defined(__INTEL_COMPILER)
+  #pragma warning(push)
+  #pragma warning(disable : 4267)
+  #pragma warning(disable : 4996)
+
+  #include <backward.hpp>
+
+  #pragma warning(pop)
+#else
+  #include <backward.hpp>
+#endif
+
+using namespace IO;
+using namespace IO::Common;
+using namespace IO::WDT;
+
+namespace
+{
+  using ADT::DataStructures::SMChunk;
+  using ADT::DataStructures::SMLayer;
+
+  void WriteChunkHeader(ByteBuffer& buf, std::uint32_t fourcc, std::size_t size)
+  {
+    buf.Write(ChunkHeader {fourcc, static_cast<std::uint32_t>(size)});
+  }
+
+  /**
+   * Two layers, the second one blended by an alpha map.
+   */
+  std::array<SMLayer, 2> Layers(bool compressed)
+  {
+    std::array<SMLayer, 2> layers {};
+    layers[1].textureId = 1;
+    layers[1].flags.use_alpha_map = 1;
+    layers[1].flags.alpha_map_compressed = compressed;
+    return layers;
+  }
+
+  /**
+   * Pre-Cata root ADT with an untextured chunk followed by a chunk with layers stored in its MCLY/MCAL.
+   */
+  ByteBuffer RootADT(bool has_vertex_color, std::size_t alpha_size)
+  {
+    ByteBuffer buf {};
+    WriteChunkHeader(buf, ADT::ChunkIdentifiers::ADTCommonChunks::MVER, sizeof(std::uint32_t));
+    buf.Write(std::uint32_t {18});
+
+    WriteChunkHeader(buf, ADT::ChunkIdentifiers::ADTRootChunks::MCNK, sizeof(SMChunk));
+    buf.Write(SMChunk {});
+
+    std::array<SMLayer, 2> const layers = Layers(false);
+    std::size_t const layers_offset = sizeof(ChunkHeader) + sizeof(SMChunk);
+    std::size_t const alpha_offset = layers_offset + sizeof(ChunkHeader) + sizeof(layers);
+
+    SMChunk header {};
+    header.flags.has_mccv = has_vertex_color;
+    header.nLayers = static_cast<std::uint32_t>(layers.size());
+    header.ofsLayer = static_cast<std::uint32_t>(layers_offset);
+    header.ofsAlpha = static_cast<std::uint32_t>(alpha_offset);
+    header.sizeAlpha = static_cast<std::uint32_t>(alpha_size);
+
+    // offsets count from the chunk header
+    WriteChunkHeader(buf, ADT::ChunkIdentifiers::ADTRootChunks::MCNK, alpha_offset + alpha_size);
+    buf.Write(header);
+    WriteChunkHeader(buf, ADT::ChunkIdentifiers::ADTTexMCNKSubchunks::MCLY, sizeof(layers));
+    buf.Write(layers.begin(), layers.end());
+    WriteChunkHeader(buf, ADT::ChunkIdentifiers::ADTTexMCNKSubchunks::MCAL, alpha_size);
+    buf.WriteFill(std::uint8_t {0xFF}, alpha_size);
+
+    buf.Seek(0);
+    return buf;
+  }
+
+  /**
+   * Texture ADT with one chunk, optionally with height texturing parameters.
+   */
+  ByteBuffer TexADT(bool has_height_texturing, bool compressed, std::size_t alpha_size)
+  {
+    ByteBuffer buf {};
+    WriteChunkHeader(buf, ADT::ChunkIdentifiers::ADTCommonChunks::MVER, sizeof(std::uint32_t));
+    buf.Write(std::uint32_t {18});
+
+    if (has_height_texturing)
+    {
+      std::array<std::uint32_t, 4> const params {0, 0, 0, 0};
+      WriteChunkHeader(buf, ADT::ChunkIdentifiers::ADTTexChunks::MTXP, sizeof(params));
+      buf.Write(params.begin(), params.end());
+    }
+
+    std::array<SMLayer, 2> const layers = Layers(compressed);
+
+    WriteChunkHeader(buf, ADT::ChunkIdentifiers::ADTTexChunks::MCNK
+                     , 2 * sizeof(ChunkHeader) + sizeof(layers) + alpha_size);
+    WriteChunkHeader(buf, ADT::ChunkIdentifiers::ADTTexMCNKSubchunks::MCLY, sizeof(layers));
+    buf.Write(layers.begin(), layers.end());
+    WriteChunkHeader(buf, ADT::ChunkIdentifiers::ADTTexMCNKSubchunks::MCAL, alpha_size);
+    buf.WriteFill(std::uint8_t {0xFF}, alpha_size);
+
+    buf.Seek(0);
+    return buf;
+  }
+
+  /**
+   * Vertex colors are flagged by any chunk, alpha format follows the size of the uncompressed layer.
+   * Since Cata, layers of root ADT chunks are not inspected.
+   */
+  void TestScanRootADT()
+  {
+    TileManifest lowres;
+    MapManifest::ScanRootADT(RootADT(false, WorldConstants::N_BYTES_PER_LOWRES_ALPHA), ClientVersion::WOTLK, lowres);
+    Ensure(!lowres.has_vertex_color && !lowres.uses_highres_alpha, "Lowres tile reported highres content.");
+
+    TileManifest highres;
+    MapManifest::ScanRootADT(RootADT(true, WorldConstants::N_BYTES_PER_HIGHRES_ALPHA), ClientVersion::WOTLK, highres);
+    Ensure(highres.has_vertex_color && highres.uses_highres_alpha, "Vertex colors or highres alpha were missed.");
+
+    TileManifest cata;
+    MapManifest::ScanRootADT(RootADT(true, WorldConstants::N_BYTES_PER_HIGHRES_ALPHA), ClientVersion::CATA, cata);
+    Ensure(cata.has_vertex_color && !cata.uses_highres_alpha, "Root ADT layers were inspected since Cata.");
+  }
+
+  /**
+   * Height texturing follows MTXP, compressed layers are always highres.
+   */
+  void TestScanTexADT()
+  {
+    TileManifest lowres;
+    MapManifest::ScanTexADT(TexADT(false, false, WorldConstants::N_BYTES_PER_LOWRES_ALPHA), lowres);
+    Ensure(!lowres.uses_height_texturing && !lowres.uses_highres_alpha, "Lowres tile reported highres content.");
+
+    TileManifest uncompressed;
+    MapManifest::ScanTexADT(TexADT(true, false, WorldConstants::N_BYTES_PER_HIGHRES_ALPHA), uncompressed);
+    Ensure(uncompressed.uses_height_texturing && uncompressed.uses_highres_alpha
+           , "Height texturing or highres alpha were missed.");
+
+    TileManifest compressed;
+    MapManifest::ScanTexADT(TexADT(false, true, 100), compressed);
+    Ensure(compressed.uses_highres_alpha, "Compressed alpha was not reported as highres.");
+  }
+}
+
+int main()
+{
+  backward::SignalHandling sh;
+  Validation::Log::InitLoggers();
+
+  TestScanRootADT();
+  TestScanTexADT();
+
+  return 0;
+}